@@ -79,6 +79,11 @@ extern "C" {
 # define U_CELL_CFG_GREETING_CALLBACK_MAX_LEN_BYTES 64
 #endif
 
+/** The maximum length of a state snapshot, as returned by
+ * uCellCfgGetStateSnapshot().
+ */
+#define U_CELL_CFG_STATE_SNAPSHOT_MAX_LENGTH_BYTES 128
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -536,6 +541,57 @@ int32_t uCellCfgGetGnssProfile(uDeviceHandle_t cellHandle, char *pServerName,
 int64_t uCellCfgSetTime(uDeviceHandle_t cellHandle, int64_t timeLocal,
                         int32_t timeZoneSeconds);
 
+/** Get a snapshot of the state of the cellular module: its
+ * identity (IMEI and firmware version) plus those of its settings
+ * that are expensive to read at every power-on, i.e. the MNO profile,
+ * the GNSS profile, the RAT(s) and the band masks.  The snapshot is a
+ * compact binary blob, versioned and protected by a CRC, which the
+ * application may store in non-volatile memory and hand back with
+ * uCellCfgSetStateSnapshot() after its next start-up, avoiding the
+ * time and power cost of reading those settings from the module
+ * again.  Any settings not already known will be read from the
+ * module by this function, hence the module must be powered on.
+ *
+ * @param cellHandle  the handle of the cellular instance.
+ * @param[out] pBuffer a place to put the snapshot; cannot be NULL.
+ * @param size        the amount of storage at pBuffer;
+ *                    #U_CELL_CFG_STATE_SNAPSHOT_MAX_LENGTH_BYTES
+ *                    will always be sufficient.
+ * @return            on success the length of the snapshot written
+ *                    to pBuffer, else negative error code.
+ */
+int32_t uCellCfgGetStateSnapshot(uDeviceHandle_t cellHandle,
+                                 char *pBuffer, size_t size);
+
+/** Give a snapshot of the state of the cellular module, previously
+ * obtained with uCellCfgGetStateSnapshot(), back to this code.  The
+ * snapshot takes effect at the next power-on, or reboot, of the module
+ * and then only if the IMEI and firmware version in the snapshot match
+ * those read from the module; in that case the MNO profile and GNSS
+ * profile will not be read from, or written to, the module during
+ * power-on and uCellCfgGetMnoProfile(), uCellCfgGetRat(),
+ * uCellCfgGetRatRank() and uCellCfgGetBandMask() will answer from the
+ * snapshot.  The snapshot is discarded if the module does not match.
+ *
+ * Settings changed through this API (e.g. with uCellCfgSetRat()) are
+ * always written to the module and are read back from it afterwards;
+ * settings changed behind this API's back (e.g. by sending AT commands
+ * directly) will not be noticed, in which case a snapshot should not
+ * be used.
+ *
+ * @param cellHandle the handle of the cellular instance.
+ * @param[in] pBuffer the snapshot; cannot be NULL.
+ * @param size       the length of the snapshot at pBuffer, as
+ *                   returned by uCellCfgGetStateSnapshot().
+ * @return           zero on success else negative error code;
+ *                   #U_ERROR_COMMON_NOT_SUPPORTED will be returned
+ *                   if the snapshot was made by a different version
+ *                   of this code and #U_ERROR_COMMON_BAD_DATA if the
+ *                   snapshot is corrupt.
+ */
+int32_t uCellCfgSetStateSnapshot(uDeviceHandle_t cellHandle,
+                                 const char *pBuffer, size_t size);
+
 #ifdef __cplusplus
 }
 #endif
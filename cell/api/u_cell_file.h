@@ -48,10 +48,66 @@ extern "C" {
  */
 #define U_CELL_FILE_NAME_MAX_LENGTH 248
 
+#ifndef U_CELL_FILE_STREAM_CHUNK_LENGTH_BYTES
+/** The size of the buffer, allocated for the duration of a call to
+ * uCellFileReadStream() or uCellFileWriteStream(), through which file
+ * data is passed to or from the callback; this is the most data that
+ * will be passed to or requested from the callback at any one time.
+ */
+# define U_CELL_FILE_STREAM_CHUNK_LENGTH_BYTES 256
+#endif
+
+#ifndef U_CELL_FILE_STREAM_BLOCK_LENGTH_BYTES
+/** The default amount of file data that uCellFileReadStream() and
+ * uCellFileWriteStream() transfer with each AT command; the larger
+ * this is the fewer AT round-trips are required, at the expense of
+ * the cellular API being locked for longer at a time.
+ */
+# define U_CELL_FILE_STREAM_BLOCK_LENGTH_BYTES (1024 * 8)
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** Callback that receives the data read by uCellFileReadStream().
+ *
+ * @param cellHandle         the handle of the cellular instance.
+ * @param[in] pData          the file data.
+ * @param size               the number of bytes at pData, never more
+ *                           than #U_CELL_FILE_STREAM_CHUNK_LENGTH_BYTES.
+ * @param offset             the offset of pData from the start of the
+ *                           file.
+ * @param[in] pCallbackParam the pCallbackParam that was passed to
+ *                           uCellFileReadStream().
+ * @return                   true to continue reading, false to stop.
+ */
+typedef bool (*uCellFileReadStreamCallback_t)(uDeviceHandle_t cellHandle,
+                                              const char *pData,
+                                              size_t size,
+                                              size_t offset,
+                                              void *pCallbackParam);
+
+/** Callback that provides the data written by uCellFileWriteStream().
+ *
+ * @param cellHandle         the handle of the cellular instance.
+ * @param[out] pBuffer       a place to put the file data.
+ * @param size               the number of bytes of file data that
+ *                           must be written to pBuffer, never more
+ *                           than #U_CELL_FILE_STREAM_CHUNK_LENGTH_BYTES.
+ * @param offset             the offset of pBuffer from the start of
+ *                           the data being written.
+ * @param[in] pCallbackParam the pCallbackParam that was passed to
+ *                           uCellFileWriteStream().
+ * @return                   size on success, any other value will
+ *                           stop the write.
+ */
+typedef int32_t (*uCellFileWriteStreamCallback_t)(uDeviceHandle_t cellHandle,
+                                                  char *pBuffer,
+                                                  size_t size,
+                                                  size_t offset,
+                                                  void *pCallbackParam);
+
 /* ----------------------------------------------------------------
  * FUNCTIONS:  WORKAROUND FOR LINKER ISSUE
  * -------------------------------------------------------------- */
@@ -162,6 +218,96 @@ int32_t uCellFileBlockRead(uDeviceHandle_t cellHandle,
                            size_t offset,
                            size_t dataSize);
 
+/** Read a file from the file system, passing the contents to a
+ * callback as they arrive from the module rather than into a buffer
+ * supplied by the caller, so that large files may be read with
+ * little memory.  The file is read from the module in blocks of
+ * readAheadSize bytes, each one AT command, and each block is passed
+ * to the callback in chunks of up to
+ * #U_CELL_FILE_STREAM_CHUNK_LENGTH_BYTES as it is received; the
+ * cellular API is only locked for the duration of a block, so other
+ * cellular API calls may be made between blocks.  If a tag has been
+ * set with uCellFileSetTag() then, since block reads are not
+ * supported with tags, the whole file is read with a single AT
+ * command and readAheadSize is ignored.
+ *
+ * IMPORTANT: the callback is called with the cellular API locked and
+ * so must not call back into the cellular API; it should also return
+ * promptly since, while it is running, data from the module is
+ * being buffered by the AT client.  In order to avoid character loss
+ * it is recommended that flow control lines are connected on the
+ * interface to the module.
+ *
+ * @param cellHandle         the handle of the cellular instance.
+ * @param[in] pFileName      a pointer to the name of the file to
+ *                           read. File name cannot contain these
+ *                           characters: / * : % | " < > ?.
+ * @param offset             the offset in bytes from the beginning of
+ *                           the file at which to start reading.
+ * @param readAheadSize      the amount of the file to request from
+ *                           the module with each AT command; use zero
+ *                           for #U_CELL_FILE_STREAM_BLOCK_LENGTH_BYTES.
+ * @param pCallback          the callback that will receive the data,
+ *                           cannot be NULL.
+ * @param[in] pCallbackParam a parameter that will be passed to
+ *                           pCallback; may be NULL.
+ * @return                   on success the number of bytes passed to
+ *                           pCallback, else negative error code.
+ */
+int32_t uCellFileReadStream(uDeviceHandle_t cellHandle,
+                            const char *pFileName,
+                            size_t offset,
+                            size_t readAheadSize,
+                            uCellFileReadStreamCallback_t pCallback,
+                            void *pCallbackParam);
+
+/** Write to a file on the file system, obtaining the data from a
+ * callback rather than from a buffer supplied by the caller, so
+ * that large files may be written with little memory.  As with
+ * uCellFileWrite(), if the file already exists the data will be
+ * appended to it.  The data is written in blocks of blockSize bytes,
+ * each one AT command, the data for each block being requested from
+ * the callback in chunks of up to
+ * #U_CELL_FILE_STREAM_CHUNK_LENGTH_BYTES; the cellular API is only
+ * locked for the duration of a block, so other cellular API calls may
+ * be made between blocks.
+ *
+ * If the callback stops the write at the start of a block nothing
+ * more is written to the file.  If it stops the write part way
+ * through a block then, since the module must be sent the amount of
+ * data it was promised at the start of the block, the remainder of
+ * that block is written to the file as zeroes; the file should be
+ * deleted in this case.
+ *
+ * IMPORTANT: the callback is called with the cellular API locked and
+ * so must not call back into the cellular API.  In order to avoid
+ * character loss it is recommended that flow control lines are
+ * connected on the interface to the module.
+ *
+ * @param cellHandle         the handle of the cellular instance.
+ * @param[in] pFileName      a pointer to the name of the file to
+ *                           write. File name cannot contain these
+ *                           characters: / * : % | " < > ?.
+ * @param size               the number of bytes to write.
+ * @param blockSize          the amount of data to write to the
+ *                           module with each AT command; use zero
+ *                           for #U_CELL_FILE_STREAM_BLOCK_LENGTH_BYTES.
+ * @param pCallback          the callback that will provide the data,
+ *                           cannot be NULL.
+ * @param[in] pCallbackParam a parameter that will be passed to
+ *                           pCallback; may be NULL.
+ * @return                   on success the number of bytes written,
+ *                           else negative error code;
+ *                           #U_ERROR_COMMON_CANCELLED is returned if
+ *                           the callback stopped the write.
+ */
+int32_t uCellFileWriteStream(uDeviceHandle_t cellHandle,
+                             const char *pFileName,
+                             size_t size,
+                             size_t blockSize,
+                             uCellFileWriteStreamCallback_t pCallback,
+                             void *pCallbackParam);
+
 /** Read size of file on the file system. If the file does not exists,
  * error will be return.
  *
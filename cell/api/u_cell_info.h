@@ -78,6 +78,44 @@ extern "C" {
  */
 int32_t uCellInfoRefreshRadioParameters(uDeviceHandle_t cellHandle);
 
+/** As uCellInfoRefreshRadioParameters() but asynchronous: the AT
+ * commands are queued, using uAtClientCommandAsync(), and this
+ * function returns immediately; the commands are then performed
+ * back-to-back by the AT client's own task, while the calling task
+ * gets on with something else, and pCallback is called when they
+ * are complete.  At that point uCellInfoGetRsrpDbm() etc. will
+ * return the refreshed values; until then they continue to return
+ * the values from the previous refresh.  If the refresh fails the
+ * stored radio parameters are cleared, as they would be by
+ * uCellInfoRefreshRadioParameters().
+ *
+ * pCallback is called from the task of the AT client, without the
+ * cellular API locked, so it may call uCellInfoGetRsrpDbm() etc.
+ * but it should not call anything that may take a long time,
+ * since that will hold up any other commands queued on the AT
+ * client.
+ *
+ * @param cellHandle         the handle of the cellular instance.
+ * @param[in] pCallback      the function to call when the refresh
+ *                           is complete, the parameters being the
+ *                           handle of the cellular instance, the
+ *                           outcome (zero on success, else negative
+ *                           error code) and pCallbackParam; cannot
+ *                           be NULL.
+ * @param[in] pCallbackParam a parameter that will be passed to
+ *                           pCallback; may be NULL.
+ * @return                   zero if the refresh has been queued,
+ *                           in which case pCallback will be called,
+ *                           else negative error code, e.g.
+ *                           #U_CELL_ERROR_NOT_REGISTERED, in which
+ *                           case pCallback will not be called.
+ */
+int32_t uCellInfoRefreshRadioParametersAsync(uDeviceHandle_t cellHandle,
+                                             void (*pCallback) (uDeviceHandle_t,
+                                                                int32_t,
+                                                                void *),
+                                             void *pCallbackParam);
+
 /** Get the RSSI that pertained after the last call to
  * uCellInfoRefreshRadioParameters().  Note that RSSI may not
  * be available unless the module has successfully registered
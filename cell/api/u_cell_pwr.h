@@ -179,6 +179,13 @@ extern "C" {
 # define U_CELL_PWR_UART_POWER_SAVING_DTR_HYSTERESIS_MS 20
 #endif
 
+#ifndef U_CELL_PWR_STARTUP_REPORT_MAX_COMMANDS
+/** The maximum number of configuration commands for which timing
+ * is recorded in a #uCellPwrStartupReport_t.
+ */
+# define U_CELL_PWR_STARTUP_REPORT_MAX_COMMANDS 16
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -243,6 +250,50 @@ typedef enum {
     U_CELL_PWR_3GPP_POWER_SAVING_STATE_MAX_NUM
 } uCellPwr3gppPowerSavingState_t;
 
+/** The timing of one of the commands sent to the cellular module
+ * while configuring it at power-on, part of #uCellPwrStartupReport_t.
+ */
+typedef struct {
+    const char *pCommand; /**< the command, without the "AT" prefix. */
+    bool skipped;         /**< true if the command was not sent because
+                               the module was read back as already being
+                               configured that way. */
+    int32_t lineIndex;    /**< the index of the AT command line the command
+                               was sent in, counting from zero; commands
+                               with the same line index were concatenated
+                               into a single AT command line.  -1 if the
+                               command was skipped. */
+    int32_t durationMs;   /**< how long the AT command line containing
+                               the command took, including any retries;
+                               zero if the command was skipped. */
+} uCellPwrStartupCommand_t;
+
+/** A report on how long the last power-on of the cellular module
+ * took, as returned by uCellPwrGetStartupReport(), so that time
+ * to ready can be measured.
+ */
+typedef struct {
+    int32_t aliveMs;      /**< the time from the start of power-on
+                               until the module responded at the AT
+                               interface. */
+    int32_t configureMs;  /**< the time taken to configure the module
+                               once it had responded. */
+    int32_t readyMs;      /**< the total time from the start of
+                               power-on until the module was ready. */
+    size_t numCommands;   /**< the number of configuration commands
+                               that applied to this module. */
+    size_t numCommandsSkipped; /**< the number of those commands that
+                                    did not need to be sent. */
+    size_t numLines;      /**< the number of AT command lines used to
+                               send the configuration commands; less
+                               than numCommands - numCommandsSkipped if
+                               commands were concatenated. */
+    /** the timing of each command, the first numCommands of which
+     * (up to #U_CELL_PWR_STARTUP_REPORT_MAX_COMMANDS) are valid.
+     */
+    uCellPwrStartupCommand_t command[U_CELL_PWR_STARTUP_REPORT_MAX_COMMANDS];
+} uCellPwrStartupReport_t;
+
 /* ----------------------------------------------------------------
  * FUNCTIONS
  * -------------------------------------------------------------- */
@@ -325,6 +376,26 @@ int32_t uCellPwrOn(uDeviceHandle_t cellHandle,
                    const char *pSimPinCode,
                    bool (*pKeepGoingCallback) (uDeviceHandle_t));
 
+/** Get a report on the timing of the last power-on of the
+ * cellular module, whether through uCellPwrOn(), uCellPwrReboot(),
+ * uCellPwrResetHard() or a wake-up from deep sleep.  The configuration
+ * commands sent to the module at power-on are compiled into a
+ * batch: where the module supports it, commands are concatenated
+ * into as few AT command lines as possible and settings that
+ * the module keeps in non-volatile memory are read back first
+ * and not sent again if they are already correct; the report
+ * shows the effect of this.
+ *
+ * @param cellHandle     the handle of the cellular instance.
+ * @param[out] pReport   a place to put the report; cannot be NULL.
+ * @return               zero on success or negative error code
+ *                       on failure; #U_ERROR_COMMON_NOT_FOUND is
+ *                       returned if the module has not yet been
+ *                       powered on or the last power-on failed.
+ */
+int32_t uCellPwrGetStartupReport(uDeviceHandle_t cellHandle,
+                                 uCellPwrStartupReport_t *pReport);
+
 /** Power the cellular module off.
  *
  * @param cellHandle             the handle of the cellular instance.
@@ -141,6 +141,10 @@ static void removeCellInstance(uCellPrivateInstance_t *pInstance)
             uCellPrivateSleepRemoveContext(pInstance);
             // Free any FOTA context
             uPortFree(pInstance->pFotaContext);
+            // Free any start-up report
+            uPortFree(pInstance->pStartupReport);
+            // Free any state snapshot that was never applied
+            uPortFree(pInstance->pStatePending);
             // Free any HTTP context
             uCellPrivateHttpRemoveContext(pInstance);
             // Free any CMUX context
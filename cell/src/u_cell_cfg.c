@@ -53,6 +53,7 @@
 #include "u_cell.h"         // Order is
 #include "u_cell_net.h"     // important here
 #include "u_cell_private.h" // don't change it
+#include "u_cell_state_private.h"
 #include "u_cell_cfg.h"
 
 /* ----------------------------------------------------------------
@@ -712,33 +713,60 @@ static int32_t setRatRankSaraU2(uCellPrivateInstance_t *pInstance,
  * STATIC FUNCTIONS: SARA-R4/R5/R6 RAT SETTING/GETTING BEHAVIOUR
  * -------------------------------------------------------------- */
 
+// Get the radio access technologies that are being used by the
+// cellular module, in rank order, SARA-R4/R5/R6 style, from the
+// cached state if possible, else from the module, updating the
+// cached state.
+// Note: gUCellPrivateMutex should be locked before this is called.
+static int32_t getRatsSaraRx(uCellPrivateInstance_t *pInstance,
+                             uCellNetRat_t *pRats)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    uAtClientHandle_t atHandle = pInstance->atHandle;
+    int32_t rat;
+
+    if (pInstance->state.validBitMap & U_CELL_PRIVATE_STATE_RAT) {
+        for (size_t x = 0; x < U_CELL_PRIVATE_MAX_NUM_SIMULTANEOUS_RATS; x++) {
+            pRats[x] = (uCellNetRat_t) pInstance->state.rat[x];
+        }
+    } else {
+        // Assume there are no RATs
+        for (size_t x = 0; x < U_CELL_PRIVATE_MAX_NUM_SIMULTANEOUS_RATS; x++) {
+            pRats[x] = U_CELL_NET_RAT_UNKNOWN_OR_NOT_USED;
+        }
+        // Get the RAT from the module
+        uAtClientLock(atHandle);
+        uAtClientCommandStart(atHandle, "AT+URAT?");
+        uAtClientCommandStop(atHandle);
+        uAtClientResponseStart(atHandle, "+URAT:");
+        // Read up to N integers representing the RATs
+        for (size_t x = 0; x < pInstance->pModule->maxNumSimultaneousRats; x++) {
+            rat = uAtClientReadInt(atHandle);
+            pRats[x] = uCellPrivateModuleRatToCellRat(pInstance->pModule->moduleType, rat);
+        }
+        uAtClientResponseStop(atHandle);
+        errorCode = uAtClientUnlock(atHandle);
+        if (errorCode == 0) {
+            for (size_t x = 0; x < U_CELL_PRIVATE_MAX_NUM_SIMULTANEOUS_RATS; x++) {
+                pInstance->state.rat[x] = (int8_t) pRats[x];
+            }
+            pInstance->state.validBitMap |= U_CELL_PRIVATE_STATE_RAT;
+        }
+    }
+
+    return errorCode;
+}
+
 // Get the radio access technology that is being used by
 // the cellular module at the given rank, SARA-R4/R5/R6 style.
 // Note: gUCellPrivateMutex should be locked before this is called.
-static uCellNetRat_t getRatSaraRx(const uCellPrivateInstance_t *pInstance,
+static uCellNetRat_t getRatSaraRx(uCellPrivateInstance_t *pInstance,
                                   int32_t rank)
 {
     int32_t errorOrRat = (int32_t) U_CELL_ERROR_AT;
-    uAtClientHandle_t atHandle = pInstance->atHandle;
-    int32_t rat;
     uCellNetRat_t rats[U_CELL_PRIVATE_MAX_NUM_SIMULTANEOUS_RATS];
 
-    // Assume there are no RATs
-    for (size_t x = 0; x < sizeof(rats) / sizeof(rats[0]); x++) {
-        rats[x] = U_CELL_NET_RAT_UNKNOWN_OR_NOT_USED;
-    }
-    // Get the RAT from the module
-    uAtClientLock(atHandle);
-    uAtClientCommandStart(atHandle, "AT+URAT?");
-    uAtClientCommandStop(atHandle);
-    uAtClientResponseStart(atHandle, "+URAT:");
-    // Read up to N integers representing the RATs
-    for (size_t x = 0; x < pInstance->pModule->maxNumSimultaneousRats; x++) {
-        rat = uAtClientReadInt(atHandle);
-        rats[x] = uCellPrivateModuleRatToCellRat(pInstance->pModule->moduleType, rat);
-    }
-    uAtClientResponseStop(atHandle);
-    if (uAtClientUnlock(atHandle) == 0) {
+    if (getRatsSaraRx(pInstance, rats) == 0) {
         errorOrRat = (int32_t) rats[rank];
     }
     uPortLog("U_CELL_CFG: RATs are:\n");
@@ -752,28 +780,20 @@ static uCellNetRat_t getRatSaraRx(const uCellPrivateInstance_t *pInstance,
 
 // Get the rank at which the given RAT is being used, SARA-R4/R5/R6 style.
 // Note: gUCellPrivateMutex should be locked before this is called.
-static int32_t getRatRankSaraRx(const uCellPrivateInstance_t *pInstance,
+static int32_t getRatRankSaraRx(uCellPrivateInstance_t *pInstance,
                                 uCellNetRat_t rat)
 {
     int32_t errorCodeOrRank = (int32_t) U_CELL_ERROR_AT;
-    uAtClientHandle_t atHandle = pInstance->atHandle;
-    int32_t y;
+    uCellNetRat_t rats[U_CELL_PRIVATE_MAX_NUM_SIMULTANEOUS_RATS];
 
-    // Get the RATs from the module
-    uAtClientLock(atHandle);
-    uAtClientCommandStart(atHandle, "AT+URAT?");
-    uAtClientCommandStop(atHandle);
-    uAtClientResponseStart(atHandle, "+URAT:");
-    // Read up to N integers representing the RATs
-    for (size_t x = 0; (errorCodeOrRank < 0) &&
-         (x < pInstance->pModule->maxNumSimultaneousRats); x++) {
-        y = uAtClientReadInt(atHandle);
-        if (rat == uCellPrivateModuleRatToCellRat(pInstance->pModule->moduleType, y)) {
-            errorCodeOrRank = (int32_t) x;
+    if (getRatsSaraRx(pInstance, rats) == 0) {
+        for (size_t x = 0; (errorCodeOrRank < 0) &&
+             (x < pInstance->pModule->maxNumSimultaneousRats); x++) {
+            if (rat == rats[x]) {
+                errorCodeOrRank = (int32_t) x;
+            }
         }
     }
-    uAtClientResponseStop(atHandle);
-    uAtClientUnlock(atHandle);
 
     return errorCodeOrRank;
 }
@@ -885,6 +905,52 @@ static int32_t setRatRankSaraRx(uCellPrivateInstance_t *pInstance,
     return errorCode;
 }
 
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: BAND MASK GETTING BEHAVIOUR
+ * -------------------------------------------------------------- */
+
+// Get the raw numbers returned by AT+UBANDMASK?, which may be
+// up to U_CELL_PRIVATE_STATE_BAND_MASK_RAW_MAX_NUM of them,
+// from the cached state if possible, else from the module,
+// updating the cached state; see uCellCfgGetBandMask() for how
+// they are interpreted.  The number of numbers is returned.
+// Note: gUCellPrivateMutex should be locked before this is called.
+static int32_t getBandMaskRaw(uCellPrivateInstance_t *pInstance,
+                              uint64_t *pNumbers)
+{
+    int32_t count = 0;
+    uAtClientHandle_t atHandle = pInstance->atHandle;
+    bool success = true;
+
+    if (pInstance->state.validBitMap & U_CELL_PRIVATE_STATE_BAND_MASK) {
+        count = (int32_t) pInstance->state.bandMaskRawCount;
+        for (int32_t x = 0; x < count; x++) {
+            *(pNumbers + x) = pInstance->state.bandMaskRaw[x];
+        }
+    } else {
+        uAtClientLock(atHandle);
+        uAtClientCommandStart(atHandle, "AT+UBANDMASK?");
+        uAtClientCommandStop(atHandle);
+        uAtClientResponseStart(atHandle, "+UBANDMASK:");
+        for (size_t x = 0; (x < U_CELL_PRIVATE_STATE_BAND_MASK_RAW_MAX_NUM) && success; x++) {
+            success = (uAtClientReadUint64(atHandle, pNumbers + x) == 0);
+            if (success) {
+                count++;
+            }
+        }
+        uAtClientResponseStop(atHandle);
+        if ((uAtClientUnlock(atHandle) == 0) && (count >= 2)) {
+            for (int32_t x = 0; x < count; x++) {
+                pInstance->state.bandMaskRaw[x] = *(pNumbers + x);
+            }
+            pInstance->state.bandMaskRawCount = (size_t) count;
+            pInstance->state.validBitMap |= U_CELL_PRIVATE_STATE_BAND_MASK;
+        }
+    }
+
+    return count;
+}
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS: GREETING MESSAGE RELATED
  * -------------------------------------------------------------- */
@@ -1204,6 +1270,9 @@ int32_t uCellCfgSetBandMask(uDeviceHandle_t cellHandle,
                     uAtClientCommandStopReadResponse(atHandle);
                     errorCode = uAtClientUnlock(atHandle);
                 }
+                // Whatever the outcome, the cached band masks can no
+                // longer be trusted
+                pInstance->state.validBitMap &= (uint8_t) ~U_CELL_PRIVATE_STATE_BAND_MASK;
                 if (errorCode == 0) {
                     pInstance->rebootIsRequired = true;
                 }
@@ -1228,10 +1297,9 @@ int32_t uCellCfgGetBandMask(uDeviceHandle_t cellHandle,
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     uCellPrivateInstance_t *pInstance;
     uAtClientHandle_t atHandle;
-    uint64_t i[6];
+    uint64_t i[U_CELL_PRIVATE_STATE_BAND_MASK_RAW_MAX_NUM];
     uint64_t masks[2][2];
     int32_t rats[2];
-    bool success = true;
     int32_t count = 0;
     int32_t bandNumber;
 
@@ -1329,12 +1397,8 @@ int32_t uCellCfgGetBandMask(uDeviceHandle_t cellHandle,
                     }
                 }
             } else {
-                // Everything else uses the AT+UBANDMASK command
-                uAtClientLock(atHandle);
-                uAtClientCommandStart(atHandle, "AT+UBANDMASK?");
-                uAtClientCommandStop(atHandle);
-                uAtClientResponseStart(atHandle, "+UBANDMASK:");
-                // The AT response here can be any one of the following:
+                // Everything else uses the AT+UBANDMASK command;
+                // the AT response here can be any one of the following:
                 //    0        1             2             3           4                 5
                 // <rat_a>,<bandmask_a0>
                 // <rat_a>,<bandmask_a0>,<bandmask_a1>
@@ -1361,14 +1425,7 @@ int32_t uCellCfgGetBandMask(uDeviceHandle_t cellHandle,
                 //      <bandmask_b1>.
 
                 // Read all the numbers in
-                for (size_t x = 0; (x < sizeof(i) / sizeof(i[0])) && success; x++) {
-                    success = (uAtClientReadUint64(atHandle, &(i[x])) == 0);
-                    if (success) {
-                        count++;
-                    }
-                }
-                uAtClientResponseStop(atHandle);
-                uAtClientUnlock(atHandle);
+                count = getBandMaskRaw(pInstance, i);
 
                 // Point i, nice and simple, <rat_a> and <bandmask_a0>.
                 if (count >= 2) {
@@ -1469,6 +1526,8 @@ int32_t uCellCfgSetRat(uDeviceHandle_t cellHandle,
                     // Do the mode change
                     errorCode = setRatSaraRx(pInstance, rat);
                 }
+                // Whatever the outcome, the cached RATs can no longer be trusted
+                pInstance->state.validBitMap &= (uint8_t) ~U_CELL_PRIVATE_STATE_RAT;
                 if (errorCode == 0) {
                     pInstance->rebootIsRequired = true;
                 }
@@ -1515,6 +1574,8 @@ int32_t uCellCfgSetRatRank(uDeviceHandle_t cellHandle,
                 } else {
                     errorCode = setRatRankSaraRx(pInstance, rat, rank);
                 }
+                // Whatever the outcome, the cached RATs can no longer be trusted
+                pInstance->state.validBitMap &= (uint8_t) ~U_CELL_PRIVATE_STATE_RAT;
                 if (errorCode == 0) {
                     pInstance->rebootIsRequired = true;
                 }
@@ -1629,6 +1690,12 @@ int32_t uCellCfgSetMnoProfile(uDeviceHandle_t cellHandle,
                 uAtClientWriteInt(atHandle, mnoProfile);
                 uAtClientCommandStopReadResponse(atHandle);
                 errorCode = uAtClientUnlock(atHandle);
+                // Whatever the outcome, the cached MNO profile, and
+                // the RATs and band masks it implies, can no longer
+                // be trusted
+                pInstance->state.validBitMap &= (uint8_t) ~(U_CELL_PRIVATE_STATE_MNO_PROFILE |
+                                                            U_CELL_PRIVATE_STATE_RAT |
+                                                            U_CELL_PRIVATE_STATE_BAND_MASK);
                 if (errorCode == 0) {
                     pInstance->rebootIsRequired = true;
                     uPortLog("U_CELL_CFG: MNO profile set to %d.\n",
@@ -1664,14 +1731,23 @@ int32_t uCellCfgGetMnoProfile(uDeviceHandle_t cellHandle)
         pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCodeOrMnoProfile = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
-            atHandle = pInstance->atHandle;
-            uAtClientLock(atHandle);
-            uAtClientCommandStart(atHandle, "AT+UMNOPROF?");
-            uAtClientCommandStop(atHandle);
-            uAtClientResponseStart(atHandle, "+UMNOPROF:");
-            mnoProfile = uAtClientReadInt(atHandle);
-            uAtClientResponseStop(atHandle);
-            errorCodeOrMnoProfile = uAtClientUnlock(atHandle);
+            if (pInstance->state.validBitMap & U_CELL_PRIVATE_STATE_MNO_PROFILE) {
+                mnoProfile = pInstance->state.mnoProfile;
+                errorCodeOrMnoProfile = (int32_t) U_ERROR_COMMON_SUCCESS;
+            } else {
+                atHandle = pInstance->atHandle;
+                uAtClientLock(atHandle);
+                uAtClientCommandStart(atHandle, "AT+UMNOPROF?");
+                uAtClientCommandStop(atHandle);
+                uAtClientResponseStart(atHandle, "+UMNOPROF:");
+                mnoProfile = uAtClientReadInt(atHandle);
+                uAtClientResponseStop(atHandle);
+                errorCodeOrMnoProfile = uAtClientUnlock(atHandle);
+                if ((errorCodeOrMnoProfile == 0) && (mnoProfile >= 0)) {
+                    pInstance->state.mnoProfile = mnoProfile;
+                    pInstance->state.validBitMap |= U_CELL_PRIVATE_STATE_MNO_PROFILE;
+                }
+            }
             if ((errorCodeOrMnoProfile == 0) && (mnoProfile >= 0)) {
                 uPortLog("U_CELL_CFG: MNO profile is %d.\n", mnoProfile);
                 errorCodeOrMnoProfile = mnoProfile;
@@ -1856,6 +1932,9 @@ int32_t uCellCfgFactoryReset(uDeviceHandle_t cellHandle, int32_t fsRestoreType,
             uAtClientCommandStopReadResponse(atHandle);
             // Unlock mutex after using AT client.
             errorCode = uAtClientUnlock(atHandle);
+            // Whatever the outcome, nothing we have cached about the
+            // settings of the module can be trusted any longer
+            pInstance->state.validBitMap &= U_CELL_PRIVATE_STATE_IDENTITY;
             if (errorCode == 0) {
                 pInstance->rebootIsRequired = true;
             }
@@ -2131,6 +2210,7 @@ int32_t uCellCfgSetGnssProfile(uDeviceHandle_t cellHandle, int32_t profileBitMap
         pInstance = pUCellPrivateGetInstance(cellHandle);
         if (pInstance != NULL) {
             errorCode = uCellPrivateSetGnssProfile(pInstance, profileBitMap, pServerName);
+            pInstance->state.validBitMap &= (uint8_t) ~U_CELL_PRIVATE_STATE_GNSS_PROFILE;
         }
 
         U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
@@ -2154,6 +2234,10 @@ int32_t uCellCfgGetGnssProfile(uDeviceHandle_t cellHandle, char *pServerName,
         pInstance = pUCellPrivateGetInstance(cellHandle);
         if (pInstance != NULL) {
             errorCodeOrBitMap = uCellPrivateGetGnssProfile(pInstance, pServerName, sizeBytes);
+            if (errorCodeOrBitMap >= 0) {
+                pInstance->state.gnssProfileBitMap = errorCodeOrBitMap;
+                pInstance->state.validBitMap |= U_CELL_PRIVATE_STATE_GNSS_PROFILE;
+            }
         }
 
         U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
@@ -2205,4 +2289,97 @@ int64_t uCellCfgSetTime(uDeviceHandle_t cellHandle, int64_t timeLocal,
     return errorCode;
 }
 
+// Get a snapshot of the state of the cellular module.
+int32_t uCellCfgGetStateSnapshot(uDeviceHandle_t cellHandle,
+                                 char *pBuffer, size_t size)
+{
+    int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+    uCellNetRat_t rats[U_CELL_PRIVATE_MAX_NUM_SIMULTANEOUS_RATS];
+    uint64_t numbers[U_CELL_PRIVATE_STATE_BAND_MASK_RAW_MAX_NUM];
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((pInstance != NULL) && (pBuffer != NULL)) {
+            // Fill in anything we don't yet know; the MNO profile
+            // and GNSS profile are always populated at power-on
+            if ((pInstance->state.validBitMap & U_CELL_PRIVATE_STATE_IDENTITY) !=
+                U_CELL_PRIVATE_STATE_IDENTITY) {
+                uCellPrivateStateGetIdentity(pInstance, &(pInstance->state));
+            }
+            if (pInstance->pModule->moduleType != U_CELL_MODULE_TYPE_SARA_U201) {
+                getRatsSaraRx(pInstance, rats);
+                if (pInstance->pModule->moduleType != U_CELL_MODULE_TYPE_LENA_R8) {
+                    getBandMaskRaw(pInstance, numbers);
+                }
+            }
+            errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+            if ((pInstance->state.validBitMap & U_CELL_PRIVATE_STATE_IDENTITY) ==
+                U_CELL_PRIVATE_STATE_IDENTITY) {
+                errorCodeOrSize = uCellStatePrivateEncode(&(pInstance->state),
+                                                          pBuffer, size);
+                if (errorCodeOrSize >= 0) {
+                    uPortLog("U_CELL_CFG: state snapshot is %d byte(s), contents"
+                             " 0x%02x.\n", (int) errorCodeOrSize,
+                             pInstance->state.validBitMap);
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return errorCodeOrSize;
+}
+
+// Give a snapshot of the state of the cellular module back.
+int32_t uCellCfgSetStateSnapshot(uDeviceHandle_t cellHandle,
+                                 const char *pBuffer, size_t size)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+    uCellPrivateState_t state;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((pInstance != NULL) && (pBuffer != NULL)) {
+            errorCode = uCellStatePrivateDecode(pBuffer, size, &state);
+            if ((errorCode == 0) &&
+                ((state.validBitMap & U_CELL_PRIVATE_STATE_IDENTITY) !=
+                 U_CELL_PRIVATE_STATE_IDENTITY)) {
+                // Can't be checked against the module, no use to us
+                errorCode = (int32_t) U_ERROR_COMMON_BAD_DATA;
+            }
+            if (errorCode == 0) {
+                errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                if (pInstance->pStatePending == NULL) {
+                    pInstance->pStatePending = (uCellPrivateState_t *) pUPortMalloc(sizeof(state));
+                }
+                if (pInstance->pStatePending != NULL) {
+                    // Keep it until the next power-on, where it is checked
+                    *(pInstance->pStatePending) = state;
+                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                    uPortLog("U_CELL_CFG: state snapshot will be applied at"
+                             " the next power-on.\n");
+                }
+            } else {
+                uPortLog("U_CELL_CFG: state snapshot rejected (%d).\n",
+                         (int) errorCode);
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return errorCode;
+}
+
 // End of file
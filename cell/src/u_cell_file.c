@@ -39,12 +39,34 @@
 #include "u_error_common.h"
 #include "u_port.h"
 #include "u_port_os.h"
+#include "u_port_heap.h"
 #include "u_at_client.h"
 #include "u_cell_module_type.h"
 #include "u_cell_net.h"
 #include "u_cell_file.h"
 #include "u_cell_private.h"
 
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The state of a uCellFileReadStream() or uCellFileWriteStream()
+ * operation, carried from one block to the next.
+ */
+typedef struct {
+    uDeviceHandle_t cellHandle;
+    const char *pFileName;
+    uCellFileReadStreamCallback_t pReadCallback;
+    uCellFileWriteStreamCallback_t pWriteCallback;
+    void *pCallbackParam;
+    char *pBuffer; /**< #U_CELL_FILE_STREAM_CHUNK_LENGTH_BYTES long. */
+    size_t offset; /**< for a read the offset into the file of the
+                        next byte to be passed to the callback, for a
+                        write the number of bytes obtained from the
+                        callback so far. */
+    bool stop;     /**< set when the callback asks to stop. */
+} uCellFileStream_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -58,6 +80,220 @@ static uCellPrivateFileListContainer_t *gpFileList = NULL;
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Get the size of a file; gUCellPrivateMutex must be locked.
+static int32_t fileSize(const uCellPrivateInstance_t *pInstance,
+                        const char *pFileName)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+    uAtClientHandle_t atHandle = pInstance->atHandle;
+    int32_t size;
+
+    // Do the ULSTFILE thang with the AT interface
+    uAtClientLock(atHandle);
+    uAtClientCommandStart(atHandle, "AT+ULSTFILE=");
+    // Write get file size op_code
+    uAtClientWriteInt(atHandle, 2);
+    // Write file name
+    uAtClientWriteString(atHandle, pFileName, true);
+    if (pInstance->pFileSystemTag != NULL) {
+        // Write tag
+        uAtClientWriteString(atHandle, pInstance->pFileSystemTag, true);
+    }
+    uAtClientCommandStop(atHandle);
+    // Grab the response
+    uAtClientResponseStart(atHandle, "+ULSTFILE:");
+    // Read file size
+    size = uAtClientReadInt(atHandle);
+    uAtClientResponseStop(atHandle);
+    if (uAtClientUnlock(atHandle) == 0) {
+        errorCode = size;
+    }
+
+    return errorCode;
+}
+
+// Read size bytes of a file, starting at pStream->offset, with
+// AT+URDBLOCK or, if size is zero, read the whole file with
+// AT+URDFILE, discarding what comes before pStream->offset;
+// either way the data is passed to the read callback in chunks as
+// it arrives.  Returns the number of bytes of file data that the
+// module sent, which is the number of bytes that pStream->offset
+// will have moved on by unless the callback asked to stop.
+// gUCellPrivateMutex must be locked.
+static int32_t readStreamBlock(const uCellPrivateInstance_t *pInstance,
+                               uCellFileStream_t *pStream,
+                               size_t size)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+    uAtClientHandle_t atHandle = pInstance->atHandle;
+    // SARA-R4 only puts \n before the
+    // response, not \r\n as it should
+    bool isSaraR4 = U_CELL_PRIVATE_MODULE_IS_SARA_R4(pInstance->pModule->moduleType);
+    const char *pPrefix = isSaraR4 ? "\n+URDBLOCK:" : "+URDBLOCK:";
+    int32_t indicatedReadSize;
+    size_t length = 0;
+    size_t thisLength;
+    size_t skip = 0;
+
+    uAtClientLock(atHandle);
+    if (size > 0) {
+        uAtClientCommandStart(atHandle, "AT+URDBLOCK=");
+        // Write file name
+        uAtClientWriteString(atHandle, pStream->pFileName, true);
+        // Write offset in bytes from the beginning of the file
+        uAtClientWriteInt(atHandle, (int32_t) pStream->offset);
+        // Write size of data to be read from file
+        uAtClientWriteInt(atHandle, (int32_t) size);
+    } else {
+        pPrefix = isSaraR4 ? "\n+URDFILE:" : "+URDFILE:";
+        uAtClientCommandStart(atHandle, "AT+URDFILE=");
+        // Write file name
+        uAtClientWriteString(atHandle, pStream->pFileName, true);
+        if (pInstance->pFileSystemTag != NULL) {
+            // Write tag
+            uAtClientWriteString(atHandle, pInstance->pFileSystemTag, true);
+        }
+        skip = pStream->offset;
+    }
+    uAtClientCommandStop(atHandle);
+    // Grab the response
+    uAtClientResponseStart(atHandle, pPrefix);
+    // Skip the file name
+    uAtClientSkipParameters(atHandle, 1);
+    // Read the size
+    indicatedReadSize = uAtClientReadInt(atHandle);
+    if (indicatedReadSize > 0) {
+        length = (size_t) (unsigned) indicatedReadSize;
+    }
+    // Don't stop for anything!
+    uAtClientIgnoreStopTag(atHandle);
+    // Get the leading quote mark out of the way
+    uAtClientReadBytes(atHandle, NULL, 1, true);
+    // Pour away anything before the offset
+    if (skip > length) {
+        skip = length;
+    }
+    if (skip > 0) {
+        uAtClientReadBytes(atHandle, NULL, skip, true);
+        length -= skip;
+    }
+    // Now pass the rest to the callback as it arrives
+    while ((length > 0) && !pStream->stop && (uAtClientErrorGet(atHandle) == 0)) {
+        thisLength = length;
+        if (thisLength > U_CELL_FILE_STREAM_CHUNK_LENGTH_BYTES) {
+            thisLength = U_CELL_FILE_STREAM_CHUNK_LENGTH_BYTES;
+        }
+        if (uAtClientReadBytes(atHandle, pStream->pBuffer,
+                               thisLength, true) == (int32_t) thisLength) {
+            pStream->stop = !pStream->pReadCallback(pStream->cellHandle,
+                                                    pStream->pBuffer,
+                                                    thisLength,
+                                                    pStream->offset,
+                                                    pStream->pCallbackParam);
+            pStream->offset += thisLength;
+            length -= thisLength;
+        }
+    }
+    if ((length > 0) && (uAtClientErrorGet(atHandle) == 0)) {
+        //...and if we've been told to stop, the rest is poured away to NULL
+        uAtClientReadBytes(atHandle, NULL, length, true);
+    }
+    // Make sure to wait for the stop tag before
+    // we finish
+    uAtClientRestoreStopTag(atHandle);
+    uAtClientResponseStop(atHandle);
+    if (uAtClientUnlock(atHandle) == 0) {
+        errorCode = indicatedReadSize;
+    }
+
+    return errorCode;
+}
+
+// Write size bytes to a file with AT+UDWNFILE, obtaining the data
+// from the write callback in chunks.  The first chunk is obtained
+// before the AT command is sent so that, if the callback asks to
+// stop at that point, nothing is written; if it asks to stop after
+// that, the remainder of the block is written as zeroes.  Returns
+// the number of bytes written to the module.
+// gUCellPrivateMutex must be locked.
+static int32_t writeStreamBlock(const uCellPrivateInstance_t *pInstance,
+                                uCellFileStream_t *pStream,
+                                size_t size)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_CANCELLED;
+    uAtClientHandle_t atHandle = pInstance->atHandle;
+    size_t bytesWritten = 0;
+    size_t thisLength;
+
+    thisLength = size;
+    if (thisLength > U_CELL_FILE_STREAM_CHUNK_LENGTH_BYTES) {
+        thisLength = U_CELL_FILE_STREAM_CHUNK_LENGTH_BYTES;
+    }
+    pStream->stop = (pStream->pWriteCallback(pStream->cellHandle,
+                                             pStream->pBuffer,
+                                             thisLength,
+                                             pStream->offset,
+                                             pStream->pCallbackParam) != (int32_t) thisLength);
+    if (!pStream->stop) {
+        pStream->offset += thisLength;
+        errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+        // Do the UDWNFILE thang with the AT interface
+        uAtClientLock(atHandle);
+        uAtClientCommandStart(atHandle, "AT+UDWNFILE=");
+        // Write file name
+        uAtClientWriteString(atHandle, pStream->pFileName, true);
+        // Write size of data to be written into the file
+        uAtClientWriteInt(atHandle, (int32_t) size);
+        if (pInstance->pFileSystemTag != NULL) {
+            // Write tag
+            uAtClientWriteString(atHandle, pInstance->pFileSystemTag, true);
+        }
+        uAtClientCommandStop(atHandle);
+        // Wait for the prompt
+        if (uAtClientWaitCharacter(atHandle, '>') == 0) {
+            // Allow plenty of time for this to complete
+            uAtClientTimeoutSet(atHandle, 10000);
+            uPortTaskBlock(50);
+            while ((bytesWritten < size) && (uAtClientErrorGet(atHandle) == 0)) {
+                bytesWritten += uAtClientWriteBytes(atHandle, pStream->pBuffer,
+                                                    thisLength, true);
+                thisLength = size - bytesWritten;
+                if (thisLength > U_CELL_FILE_STREAM_CHUNK_LENGTH_BYTES) {
+                    thisLength = U_CELL_FILE_STREAM_CHUNK_LENGTH_BYTES;
+                }
+                if ((thisLength > 0) && !pStream->stop) {
+                    pStream->stop = (pStream->pWriteCallback(pStream->cellHandle,
+                                                             pStream->pBuffer,
+                                                             thisLength,
+                                                             pStream->offset,
+                                                             pStream->pCallbackParam) != (int32_t) thisLength);
+                    if (pStream->stop) {
+                        // The module is expecting the rest of the
+                        // block so give it zeroes
+                        memset(pStream->pBuffer, 0, U_CELL_FILE_STREAM_CHUNK_LENGTH_BYTES);
+                    } else {
+                        pStream->offset += thisLength;
+                    }
+                }
+            }
+            // Restore at client timeout to default
+            uAtClientTimeoutSet(atHandle, U_AT_CLIENT_DEFAULT_TIMEOUT_MS);
+            // Grab the response
+            uAtClientCommandStopReadResponse(atHandle);
+            if (uAtClientUnlock(atHandle) == 0) {
+                errorCode = (int32_t) bytesWritten;
+            }
+        } else {
+            // Best to tidy whatever might have arrived instead
+            // of the prompt before exiting
+            uAtClientResponseStop(atHandle);
+            uAtClientUnlock(atHandle);
+        }
+    }
+
+    return errorCode;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: WORKAROUND FOR LINKER ISSUE
  * -------------------------------------------------------------- */
@@ -349,14 +585,164 @@ int32_t uCellFileBlockRead(uDeviceHandle_t cellHandle,
     return errorCode;
 }
 
+// Read a file, passing the contents to a callback as they arrive.
+int32_t uCellFileReadStream(uDeviceHandle_t cellHandle,
+                            const char *pFileName,
+                            size_t offset,
+                            size_t readAheadSize,
+                            uCellFileReadStreamCallback_t pCallback,
+                            void *pCallbackParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+    uCellFileStream_t stream = {0};
+    int32_t size = -1;
+    size_t length;
+    bool done = false;
+
+    if (gUCellPrivateMutex != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        // Check parameters
+        if ((pFileName != NULL) && (strlen(pFileName) <= U_CELL_FILE_NAME_MAX_LENGTH) &&
+            (pCallback != NULL)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            stream.pBuffer = (char *) pUPortMalloc(U_CELL_FILE_STREAM_CHUNK_LENGTH_BYTES);
+            if (stream.pBuffer != NULL) {
+                stream.cellHandle = cellHandle;
+                stream.pFileName = pFileName;
+                stream.pReadCallback = pCallback;
+                stream.pCallbackParam = pCallbackParam;
+                stream.offset = offset;
+                if (readAheadSize == 0) {
+                    readAheadSize = U_CELL_FILE_STREAM_BLOCK_LENGTH_BYTES;
+                }
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                // Lock the API afresh for each block so that other
+                // cellular API calls may get in between blocks
+                while (!done && (errorCode >= 0)) {
+
+                    U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+                    pInstance = pUCellPrivateGetInstance(cellHandle);
+                    errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+                    if (pInstance != NULL) {
+                        if (pInstance->pFileSystemTag != NULL) {
+                            // Block reads are not supported with
+                            // tags, just have to read the lot
+                            errorCode = readStreamBlock(pInstance, &stream, 0);
+                            done = true;
+                        } else if (size < 0) {
+                            // Need to know when to stop
+                            errorCode = fileSize(pInstance, pFileName);
+                            size = errorCode;
+                        } else if (stream.offset >= (size_t) size) {
+                            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                            done = true;
+                        } else {
+                            length = (size_t) size - stream.offset;
+                            if (length > readAheadSize) {
+                                length = readAheadSize;
+                            }
+                            errorCode = readStreamBlock(pInstance, &stream, length);
+                            if ((errorCode >= 0) && ((size_t) errorCode < length)) {
+                                // The file must have been shortened
+                                done = true;
+                            }
+                        }
+                    }
+
+                    U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+
+                    done = done || stream.stop;
+                }
+                if (errorCode >= 0) {
+                    errorCode = 0;
+                    if (stream.offset > offset) {
+                        errorCode = (int32_t) (stream.offset - offset);
+                    }
+                }
+                uPortFree(stream.pBuffer);
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Write a file, obtaining the contents from a callback.
+int32_t uCellFileWriteStream(uDeviceHandle_t cellHandle,
+                             const char *pFileName,
+                             size_t size,
+                             size_t blockSize,
+                             uCellFileWriteStreamCallback_t pCallback,
+                             void *pCallbackParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+    uCellFileStream_t stream = {0};
+    size_t bytesWritten = 0;
+    size_t length;
+
+    if (gUCellPrivateMutex != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        // Check parameters
+        if ((pFileName != NULL) && (strlen(pFileName) <= U_CELL_FILE_NAME_MAX_LENGTH) &&
+            (pCallback != NULL)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            stream.pBuffer = (char *) pUPortMalloc(U_CELL_FILE_STREAM_CHUNK_LENGTH_BYTES);
+            if (stream.pBuffer != NULL) {
+                stream.cellHandle = cellHandle;
+                stream.pFileName = pFileName;
+                stream.pWriteCallback = pCallback;
+                stream.pCallbackParam = pCallbackParam;
+                if (blockSize == 0) {
+                    blockSize = U_CELL_FILE_STREAM_BLOCK_LENGTH_BYTES;
+                }
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                // Lock the API afresh for each block so that other
+                // cellular API calls may get in between blocks
+                while ((bytesWritten < size) && !stream.stop && (errorCode >= 0)) {
+
+                    U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+                    pInstance = pUCellPrivateGetInstance(cellHandle);
+                    errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+                    if (pInstance != NULL) {
+                        length = size - bytesWritten;
+                        if (length > blockSize) {
+                            length = blockSize;
+                        }
+                        errorCode = writeStreamBlock(pInstance, &stream, length);
+                        if (errorCode >= 0) {
+                            bytesWritten += (size_t) errorCode;
+                            if ((size_t) errorCode < length) {
+                                errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+                            }
+                        }
+                    }
+
+                    U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+                }
+                if (errorCode >= 0) {
+                    errorCode = (int32_t) bytesWritten;
+                    if (stream.stop) {
+                        errorCode = (int32_t) U_ERROR_COMMON_CANCELLED;
+                    }
+                }
+                uPortFree(stream.pBuffer);
+            }
+        }
+    }
+
+    return errorCode;
+}
+
 // Read file size.
 int32_t uCellFileSize(uDeviceHandle_t cellHandle,
                       const char *pFileName)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     uCellPrivateInstance_t *pInstance;
-    uAtClientHandle_t atHandle;
-    int32_t size = 0;
 
     if (gUCellPrivateMutex != NULL) {
 
@@ -367,28 +753,7 @@ int32_t uCellFileSize(uDeviceHandle_t cellHandle,
         // Check parameters
         if ((pInstance != NULL) && (pFileName != NULL) &&
             (strlen(pFileName) <= U_CELL_FILE_NAME_MAX_LENGTH)) {
-            errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
-            atHandle = pInstance->atHandle;
-            // Do the ULSTFILE thang with the AT interface
-            uAtClientLock(atHandle);
-            uAtClientCommandStart(atHandle, "AT+ULSTFILE=");
-            // Write get file size op_code
-            uAtClientWriteInt(atHandle, 2);
-            // Write file name
-            uAtClientWriteString(atHandle, pFileName, true);
-            if (pInstance->pFileSystemTag != NULL) {
-                // Write tag
-                uAtClientWriteString(atHandle, pInstance->pFileSystemTag, true);
-            }
-            uAtClientCommandStop(atHandle);
-            // Grab the response
-            uAtClientResponseStart(atHandle, "+ULSTFILE:");
-            // Read file size
-            size = uAtClientReadInt(atHandle);
-            uAtClientResponseStop(atHandle);
-            if (uAtClientUnlock(atHandle) == 0) {
-                errorCode = size;
-            }
+            errorCode = fileSize(pInstance, pFileName);
         }
 
         U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
@@ -34,7 +34,7 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
-#include "string.h"    // strlen()
+#include "string.h"    // strlen(), memcpy()
 #include "time.h"      // struct tm
 #include "ctype.h"     // isdigit()
 
@@ -47,6 +47,7 @@
 #include "u_port_clib_mktime64.h"
 #include "u_port_debug.h"
 #include "u_port_os.h"
+#include "u_port_heap.h"
 #include "u_port_uart.h"
 
 #include "u_at_client.h"
@@ -64,10 +65,40 @@
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+#ifndef U_CELL_INFO_UCGED_DELAY_MS
+/** How long to wait between AT+CSQ and AT+UCGED when refreshing
+ * the radio parameters: don't want to overtask the module if a
+ * refresh is being called repeatedly.
+ */
+# define U_CELL_INFO_UCGED_DELAY_MS 500
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** A function that sends an AT command and fills in the
+ * uCellPrivateRadioParameters_t pointed to by pParam from the
+ * response; the AT client must be locked before it is called.
+ */
+typedef void (*uCellInfoRadioParamsFunction_t)(uAtClientHandle_t atHandle,
+                                               void *pParam);
+
+/** Context for uCellInfoRefreshRadioParametersAsync().
+ */
+typedef struct {
+    uDeviceHandle_t cellHandle;
+    uCellPrivateRadioParameters_t radioParameters; /**< where the
+                                                        results are put
+                                                        until they are
+                                                        complete. */
+    int32_t cellIdLogicalAtStart;
+    uCellInfoRadioParamsFunction_t pUcged; /**< NULL if there is no
+                                                AT+UCGED to do. */
+    void (*pCallback) (uDeviceHandle_t, int32_t, void *);
+    void *pCallbackParam;
+} uCellInfoRefreshAsync_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -179,15 +210,14 @@ static int32_t getSinr(const char *pStr, int32_t divisor)
     return sinrDb;
 }
 
-// Fill in the radio parameters the AT+CSQ way
-static int32_t getRadioParamsCsq(uAtClientHandle_t atHandle,
-                                 uCellPrivateRadioParameters_t *pRadioParameters)
+// Fill in the radio parameters the AT+CSQ way; the AT client
+// must be locked before this is called.
+static void radioParamsCsq(uAtClientHandle_t atHandle, void *pParam)
 {
-    int32_t errorCode;
+    uCellPrivateRadioParameters_t *pRadioParameters = (uCellPrivateRadioParameters_t *) pParam;
     int32_t x;
     int32_t y;
 
-    uAtClientLock(atHandle);
     uAtClientCommandStart(atHandle, "AT+CSQ");
     uAtClientCommandStop(atHandle);
     uAtClientResponseStart(atHandle, "+CSQ:");
@@ -197,22 +227,20 @@ static int32_t getRadioParamsCsq(uAtClientHandle_t atHandle,
         y = -1;
     }
     uAtClientResponseStop(atHandle);
-    errorCode = uAtClientUnlock(atHandle);
 
-    if (errorCode == 0) {
+    if (uAtClientErrorGet(atHandle) == 0) {
         if ((x >= 0) && (x <= 31)) {
             pRadioParameters->rssiDbm =  -(113 - (x * 2));
         }
         pRadioParameters->rxQual = y;
     }
-
-    return errorCode;
 }
 
-// Fill in the radio parameters the AT+UCGED=2 way, SARA-R5 flavour
-static int32_t getRadioParamsUcged2SaraR5(uAtClientHandle_t atHandle,
-                                          uCellPrivateRadioParameters_t *pRadioParameters)
+// Fill in the radio parameters the AT+UCGED=2 way, SARA-R5 flavour;
+// the AT client must be locked before this is called.
+static void radioParamsUcged2SaraR5(uAtClientHandle_t atHandle, void *pParam)
 {
+    uCellPrivateRadioParameters_t *pRadioParameters = (uCellPrivateRadioParameters_t *) pParam;
     int32_t x;
     char buffer[10]; // More than enough room for an SNIR reading, e.g. 13.75,
     // with a terminator, and enough for an 8-digit cell ID
@@ -223,7 +251,6 @@ static int32_t getRadioParamsUcged2SaraR5(uAtClientHandle_t atHandle,
     // e.g.
     // 6,4,001,01
     // 2525,5,50,50,e8fe,1a2d001,1,d60814d1,8001,01,28,31,13.75,3,1,10,28,-50,-6,0,255,255,0
-    uAtClientLock(atHandle);
     uAtClientCommandStart(atHandle, "AT+UCGED?");
     uAtClientCommandStop(atHandle);
     // The line with just "+UCGED: 2" on it
@@ -264,19 +291,17 @@ static int32_t getRadioParamsUcged2SaraR5(uAtClientHandle_t atHandle,
         pRadioParameters->snrDb = getSinr(buffer, 1);
     }
     uAtClientResponseStop(atHandle);
-
-    return uAtClientUnlock(atHandle);
 }
 
-// Fill in the radio parameters the AT+UCGED=2 way, SARA-R422 flavour
-static int32_t getRadioParamsUcged2SaraR422(uAtClientHandle_t atHandle,
-                                            uCellPrivateRadioParameters_t *pRadioParameters)
+// Fill in the radio parameters the AT+UCGED=2 way, SARA-R422 flavour;
+// the AT client must be locked before this is called.
+static void radioParamsUcged2SaraR422(uAtClientHandle_t atHandle, void *pParam)
 {
+    uCellPrivateRadioParameters_t *pRadioParameters = (uCellPrivateRadioParameters_t *) pParam;
     int32_t x;
     int32_t y;
     char buffer[U_CELL_PRIVATE_CELL_ID_LOGICAL_SIZE + 1]; // +1 for terminator
 
-    uAtClientLock(atHandle);
     uAtClientCommandStart(atHandle, "AT+UCGED?");
     uAtClientCommandStop(atHandle);
     // The line with just "+UCGED: 2" on it
@@ -360,14 +385,13 @@ static int32_t getRadioParamsUcged2SaraR422(uAtClientHandle_t atHandle,
     }
 
     uAtClientResponseStop(atHandle);
-
-    return uAtClientUnlock(atHandle);
 }
 
-// Fill in the radio parameters the AT+UCGED=2 way, LARA-R6 flavour
-static int32_t getRadioParamsUcged2LaraR6(uAtClientHandle_t atHandle,
-                                          uCellPrivateRadioParameters_t *pRadioParameters)
+// Fill in the radio parameters the AT+UCGED=2 way, LARA-R6 flavour;
+// the AT client must be locked before this is called.
+static void radioParamsUcged2LaraR6(uAtClientHandle_t atHandle, void *pParam)
 {
+    uCellPrivateRadioParameters_t *pRadioParameters = (uCellPrivateRadioParameters_t *) pParam;
     int32_t rat;
     int32_t skipParameters = 2;
     int32_t x;
@@ -403,7 +427,6 @@ static int32_t getRadioParamsUcged2LaraR6(uAtClientHandle_t atHandle,
     // e.g.
     // 4,0,001,01
     // 2525,5,25,50,2b67,69f6bc7,111,00000000,ffff,ff,67,19,0.00,255,255,255,67,11,255,0,255,255,0,0
-    uAtClientLock(atHandle);
     uAtClientCommandStart(atHandle, "AT+UCGED?");
     uAtClientCommandStop(atHandle);
     // The line with just "+UCGED: 2" on it
@@ -490,8 +513,6 @@ static int32_t getRadioParamsUcged2LaraR6(uAtClientHandle_t atHandle,
             break;
     }
     uAtClientResponseStop(atHandle);
-
-    return uAtClientUnlock(atHandle);
 }
 
 // Turn a string such as "-104.20", i.e. a signed
@@ -516,13 +537,13 @@ static int32_t strToInt32(const char *pString)
     return value;
 }
 
-// Fill in the radio parameters the AT+UCGED=5 way
-static int32_t getRadioParamsUcged5(uAtClientHandle_t atHandle,
-                                    uCellPrivateRadioParameters_t *pRadioParameters)
+// Fill in the radio parameters the AT+UCGED=5 way; the AT client
+// must be locked before this is called.
+static void radioParamsUcged5(uAtClientHandle_t atHandle, void *pParam)
 {
+    uCellPrivateRadioParameters_t *pRadioParameters = (uCellPrivateRadioParameters_t *) pParam;
     char buffer[16];
 
-    uAtClientLock(atHandle);
     uAtClientCommandStart(atHandle, "AT+UCGED?");
     uAtClientCommandStop(atHandle);
     uAtClientResponseStart(atHandle, "+RSRP:");
@@ -538,9 +559,79 @@ static int32_t getRadioParamsUcged5(uAtClientHandle_t atHandle,
         pRadioParameters->rsrqDb = strToInt32(buffer);
     }
     uAtClientResponseStop(atHandle);
+}
+
+// Perform one of the radioParamsXxx() functions above synchronously.
+static int32_t getRadioParams(uAtClientHandle_t atHandle,
+                              uCellInfoRadioParamsFunction_t pFunction,
+                              uCellPrivateRadioParameters_t *pRadioParameters)
+{
+    uAtClientLock(atHandle);
+    pFunction(atHandle, (void *) pRadioParameters);
     return uAtClientUnlock(atHandle);
 }
 
+// Return the function that fills in the radio parameters the
+// AT+UCGED way for the given instance, NULL if there is none.
+static uCellInfoRadioParamsFunction_t pRadioParamsUcged(const uCellPrivateInstance_t *pInstance)
+{
+    uCellInfoRadioParamsFunction_t pFunction = NULL;
+
+    // Note that none of the mechanisms below are supported by
+    // LENA-R8: if you can't get it with AT+CSQ then you can't get it
+    if (U_CELL_PRIVATE_HAS(pInstance->pModule, U_CELL_PRIVATE_FEATURE_UCGED)) {
+        // Note that AT+UCGED is used rather than AT+CESQ
+        // as, in my experience, it is more reliable in
+        // reporting answers.
+        if (U_CELL_PRIVATE_HAS(pInstance->pModule, U_CELL_PRIVATE_FEATURE_UCGED5)) {
+            // SARA-R4 (except 422) only supports UCGED=5, and it only
+            // supports it in EUTRAN mode; if not in EUTRAN mode
+            // AT+CSQ is all we can get
+            if (U_CELL_PRIVATE_RAT_IS_EUTRAN(uCellPrivateGetActiveRat(pInstance))) {
+                pFunction = radioParamsUcged5;
+            }
+        } else {
+            // The AT+UCGED=2 formats are module-specific
+            switch (pInstance->pModule->moduleType) {
+                case U_CELL_MODULE_TYPE_SARA_R5:
+                    pFunction = radioParamsUcged2SaraR5;
+                    break;
+                case U_CELL_MODULE_TYPE_SARA_R422:
+                    pFunction = radioParamsUcged2SaraR422;
+                    break;
+                case U_CELL_MODULE_TYPE_LARA_R6:
+                    pFunction = radioParamsUcged2LaraR6;
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    return pFunction;
+}
+
+// Print the outcome of a refresh of the radio parameters.
+static void printRadioParameters(int32_t errorCode,
+                                 const uCellPrivateRadioParameters_t *pRadioParameters)
+{
+    if (errorCode == 0) {
+        uPortLog("U_CELL_INFO: radio parameters refreshed:\n");
+        uPortLog("             RSSI:             %d dBm\n", pRadioParameters->rssiDbm);
+        uPortLog("             RSRP:             %d dBm\n", pRadioParameters->rsrpDbm);
+        uPortLog("             RSRQ:             %d dB\n", pRadioParameters->rsrqDb);
+        uPortLog("             RxQual:           %d\n", pRadioParameters->rxQual);
+        uPortLog("             logical cell ID:  0x%08x\n", pRadioParameters->cellIdLogical);
+        uPortLog("             physical cell ID: %d\n", pRadioParameters->cellIdPhysical);
+        uPortLog("             EARFCN:           %d\n", pRadioParameters->earfcn);
+        if (pRadioParameters->snrDb != 0x7FFFFFFF) {
+            uPortLog("             SNR:              %d\n", pRadioParameters->snrDb);
+        }
+    } else {
+        uPortLog("U_CELL_INFO: unable to refresh radio parameters.\n");
+    }
+}
+
 // Get the time and time-zone offset.
 static int64_t getTimeAndTimeZone(uAtClientHandle_t atHandle,
                                   int32_t *pTimeZoneSeconds)
@@ -660,6 +751,97 @@ int32_t getCellId(uDeviceHandle_t cellHandle, bool logicalNotPhysical)
     return errorCodeOrValue;
 }
 
+// Called when uCellInfoRefreshRadioParametersAsync() has finished,
+// successfully or otherwise: store the result, call the user's
+// callback and free the context.
+static void refreshAsyncComplete(uCellInfoRefreshAsync_t *pContext,
+                                 int32_t errorCode)
+{
+    uCellPrivateInstance_t *pInstance;
+    uCellPrivateRadioParameters_t *pRadioParameters;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(pContext->cellHandle);
+        if (pInstance != NULL) {
+            pRadioParameters = &(pInstance->radioParameters);
+            if (errorCode == 0) {
+                if (pContext->radioParameters.cellIdLogical == pContext->cellIdLogicalAtStart) {
+                    // The refresh didn't read the logical cell ID, keep
+                    // whatever may have arrived (e.g. in a +CEREG URC)
+                    // while it was in progress
+                    pContext->radioParameters.cellIdLogical = pRadioParameters->cellIdLogical;
+                }
+                *pRadioParameters = pContext->radioParameters;
+            } else {
+                uCellPrivateClearRadioParameters(pRadioParameters, true);
+            }
+            printRadioParameters(errorCode, pRadioParameters);
+        } else if (errorCode == 0) {
+            // The instance has gone
+            errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+
+    } else if (errorCode == 0) {
+        errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    }
+
+    pContext->pCallback(pContext->cellHandle, errorCode, pContext->pCallbackParam);
+    uPortFree(pContext);
+}
+
+// Asynchronous AT command functions for uCellInfoRefreshRadioParametersAsync().
+static void refreshAsyncCsq(uAtClientHandle_t atHandle, void *pParam)
+{
+    radioParamsCsq(atHandle, (void *) & (((uCellInfoRefreshAsync_t *) pParam)->radioParameters));
+}
+
+static void refreshAsyncUcged(uAtClientHandle_t atHandle, void *pParam)
+{
+    uCellInfoRefreshAsync_t *pContext = (uCellInfoRefreshAsync_t *) pParam;
+
+    pContext->pUcged(atHandle, (void *) & (pContext->radioParameters));
+}
+
+// Completion callback for refreshAsyncUcged().
+static void refreshAsyncUcgedDone(uAtClientHandle_t atHandle,
+                                  int32_t errorCode, void *pParam)
+{
+    (void) atHandle;
+
+    refreshAsyncComplete((uCellInfoRefreshAsync_t *) pParam, errorCode);
+}
+
+// Completion callback for refreshAsyncCsq(): queue the AT+UCGED
+// part, if there is one, in the same way as
+// uCellInfoRefreshRadioParameters() would perform it.
+static void refreshAsyncCsqDone(uAtClientHandle_t atHandle,
+                                int32_t errorCode, void *pParam)
+{
+    uCellInfoRefreshAsync_t *pContext = (uCellInfoRefreshAsync_t *) pParam;
+
+    if ((errorCode != (int32_t) U_ERROR_COMMON_CANCELLED) &&
+        (pContext->pUcged != NULL)) {
+        // This blocks the task of the AT client rather than the
+        // caller of uCellInfoRefreshRadioParametersAsync()
+        uPortTaskBlock(U_CELL_INFO_UCGED_DELAY_MS);
+        errorCode = uAtClientCommandAsync(atHandle, refreshAsyncUcged,
+                                          refreshAsyncUcgedDone, pParam);
+        if (errorCode == 0) {
+            // refreshAsyncUcgedDone() will complete things
+            pContext = NULL;
+        }
+    }
+
+    if (pContext != NULL) {
+        refreshAsyncComplete(pContext, errorCode);
+    }
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -671,7 +853,7 @@ int32_t uCellInfoRefreshRadioParameters(uDeviceHandle_t cellHandle)
     uCellPrivateInstance_t *pInstance;
     uCellPrivateRadioParameters_t *pRadioParameters;
     uAtClientHandle_t atHandle;
-    uCellNetRat_t rat;
+    uCellInfoRadioParamsFunction_t pUcged;
 
     if (gUCellPrivateMutex != NULL) {
 
@@ -690,63 +872,76 @@ int32_t uCellInfoRefreshRadioParameters(uDeviceHandle_t cellHandle)
                 // AT+CSQ works in all cases though it sometimes
                 // doesn't return a reading.  Collect what we can
                 // with it
-                errorCode = getRadioParamsCsq(atHandle, pRadioParameters);
-                // Note that none of the mechanisms below are supported by
-                // LENA-R8: if you can't get it with AT+CSQ then you can't get it
-                if (U_CELL_PRIVATE_HAS(pInstance->pModule, U_CELL_PRIVATE_FEATURE_UCGED)) {
-                    // Note that AT+UCGED is used next rather than AT+CESQ
-                    // as, in my experience, it is more reliable in
-                    // reporting answers.
+                errorCode = getRadioParams(atHandle, radioParamsCsq, pRadioParameters);
+                pUcged = pRadioParamsUcged(pInstance);
+                if (pUcged != NULL) {
                     // Allow a little sleepy-byes here, don't want to overtask
                     // the module if this is being called repeatedly
-                    uPortTaskBlock(500);
-                    if (U_CELL_PRIVATE_HAS(pInstance->pModule, U_CELL_PRIVATE_FEATURE_UCGED5)) {
-                        // SARA-R4 (except 422) only supports UCGED=5, and it only
-                        // supports it in EUTRAN mode
-                        rat = uCellPrivateGetActiveRat(pInstance);
-                        if (U_CELL_PRIVATE_RAT_IS_EUTRAN(rat)) {
-                            errorCode = getRadioParamsUcged5(atHandle, pRadioParameters);
-                        } else {
-                            // Can't use AT+UCGED, that's all we can get
-                            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
-                        }
-                    } else {
-                        // The AT+UCGED=2 formats are module-specific
-                        switch (pInstance->pModule->moduleType) {
-                            case U_CELL_MODULE_TYPE_SARA_R5:
-                                errorCode = getRadioParamsUcged2SaraR5(atHandle, pRadioParameters);
-                                break;
-                            case U_CELL_MODULE_TYPE_SARA_R422:
-                                errorCode = getRadioParamsUcged2SaraR422(atHandle, pRadioParameters);
-                                break;
-                            case U_CELL_MODULE_TYPE_LARA_R6:
-                                errorCode = getRadioParamsUcged2LaraR6(atHandle, pRadioParameters);
-                                break;
-                            default:
-                                break;
-                        }
-                    }
+                    uPortTaskBlock(U_CELL_INFO_UCGED_DELAY_MS);
+                    errorCode = getRadioParams(atHandle, pUcged, pRadioParameters);
                 }
             }
 
-            if (errorCode == 0) {
-                uPortLog("U_CELL_INFO: radio parameters refreshed:\n");
-                uPortLog("             RSSI:             %d dBm\n", pRadioParameters->rssiDbm);
-                uPortLog("             RSRP:             %d dBm\n", pRadioParameters->rsrpDbm);
-                uPortLog("             RSRQ:             %d dB\n", pRadioParameters->rsrqDb);
-                uPortLog("             RxQual:           %d\n", pRadioParameters->rxQual);
-                uPortLog("             logical cell ID:  0x%08x\n", pRadioParameters->cellIdLogical);
-                uPortLog("             physical cell ID: %d\n", pRadioParameters->cellIdPhysical);
-                uPortLog("             EARFCN:           %d\n", pRadioParameters->earfcn);
-                if (pRadioParameters->snrDb != 0x7FFFFFFF) {
-                    uPortLog("             SNR:              %d\n", pRadioParameters->snrDb);
+            printRadioParameters(errorCode, pRadioParameters);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Refresh the RF status values asynchronously.
+int32_t uCellInfoRefreshRadioParametersAsync(uDeviceHandle_t cellHandle,
+                                             void (*pCallback) (uDeviceHandle_t,
+                                                                int32_t,
+                                                                void *),
+                                             void *pCallbackParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+    uCellInfoRefreshAsync_t *pContext = NULL;
+    uAtClientHandle_t atHandle = NULL;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((pInstance != NULL) && (pCallback != NULL)) {
+            errorCode = (int32_t) U_CELL_ERROR_NOT_REGISTERED;
+            if (uCellPrivateIsRegistered(pInstance)) {
+                errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                pContext = (uCellInfoRefreshAsync_t *) pUPortMalloc(sizeof(*pContext));
+                if (pContext != NULL) {
+                    pContext->cellHandle = cellHandle;
+                    pContext->radioParameters = pInstance->radioParameters;
+                    uCellPrivateClearRadioParameters(&(pContext->radioParameters), true);
+                    pContext->cellIdLogicalAtStart = pContext->radioParameters.cellIdLogical;
+                    pContext->pUcged = pRadioParamsUcged(pInstance);
+                    pContext->pCallback = pCallback;
+                    pContext->pCallbackParam = pCallbackParam;
+                    atHandle = pInstance->atHandle;
+                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
                 }
             } else {
-                uPortLog("U_CELL_INFO: unable to refresh radio parameters.\n");
+                uCellPrivateClearRadioParameters(&(pInstance->radioParameters), true);
             }
         }
 
         U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+
+        if (pContext != NULL) {
+            // Queue the command outside the cellular API lock since
+            // refreshAsyncComplete(), which the AT client task may be
+            // running in order to make room on the queue, takes it
+            errorCode = uAtClientCommandAsync(atHandle, refreshAsyncCsq,
+                                              refreshAsyncCsqDone, pContext);
+            if (errorCode != 0) {
+                uPortFree(pContext);
+            }
+        }
     }
 
     return errorCode;
@@ -1031,7 +1226,17 @@ int32_t uCellInfoGetImei(uDeviceHandle_t cellHandle,
         pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pImei != NULL)) {
-            errorCode = uCellPrivateGetImei(pInstance, pImei);
+            if (pInstance->state.validBitMap & U_CELL_PRIVATE_STATE_IMEI) {
+                // Known already, no need to ask
+                memcpy(pImei, pInstance->state.imei, U_CELL_INFO_IMEI_SIZE);
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            } else {
+                errorCode = uCellPrivateGetImei(pInstance, pImei);
+                if (errorCode == 0) {
+                    memcpy(pInstance->state.imei, pImei, U_CELL_INFO_IMEI_SIZE);
+                    pInstance->state.validBitMap |= U_CELL_PRIVATE_STATE_IMEI;
+                }
+            }
             if (errorCode == 0) {
                 uPortLog("U_CELL_INFO: IMEI is %.*s.\n",
                          U_CELL_INFO_IMEI_SIZE, pImei);
@@ -1176,9 +1381,28 @@ int32_t uCellInfoGetFirmwareVersionStr(uDeviceHandle_t cellHandle,
         pInstance = pUCellPrivateGetInstance(cellHandle);
         errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pStr != NULL) && (size > 0)) {
-            // Use ATI9 instead of AT+CGMR as it contains more information
-            errorCodeOrSize = getString(pInstance->atHandle, "ATI9",
-                                        pStr, size);
+            if (pInstance->state.validBitMap & U_CELL_PRIVATE_STATE_FIRMWARE_VERSION) {
+                // Known already, no need to ask
+                errorCodeOrSize = (int32_t) strlen(pInstance->state.firmwareVersion);
+                if (errorCodeOrSize > (int32_t) size - 1) {
+                    errorCodeOrSize = (int32_t) size - 1;
+                }
+                memcpy(pStr, pInstance->state.firmwareVersion, errorCodeOrSize);
+                *(pStr + errorCodeOrSize) = 0;
+            } else {
+                errorCodeOrSize = uCellPrivateGetFirmwareVersionStr(pInstance, pStr, size);
+                // Only remember it if it cannot have been truncated
+                if ((errorCodeOrSize >= 0) && (errorCodeOrSize < (int32_t) size - 1) &&
+                    (errorCodeOrSize < (int32_t) sizeof(pInstance->state.firmwareVersion) - 1)) {
+                    memcpy(pInstance->state.firmwareVersion, pStr, errorCodeOrSize + 1);
+                    pInstance->state.validBitMap |= U_CELL_PRIVATE_STATE_FIRMWARE_VERSION;
+                }
+            }
+            if (errorCodeOrSize >= 0) {
+                uPortLog("U_CELL_INFO: firmware version is \"%s\".\n", pStr);
+            } else {
+                uPortLog("U_CELL_INFO: unable to read firmware version.\n");
+            }
         }
 
         U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
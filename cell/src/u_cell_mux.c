@@ -1261,6 +1261,9 @@ static void cmuxDecode(uCellMuxPrivateContext_t *pContext, uint32_t eventBitMap)
     uCellMuxPrivateChannelContext_t *pChannelContext;
     uCellMuxPrivateTraffic_t *pTraffic;
     U_RING_BUFFER_PARSER_f parserList[] = {uCellMuxPrivateParseCmux, NULL};
+    // A CMUX frame can only start with a frame marker, so only try the
+    // parser at those
+    const char syncByte = (char) U_CELL_MUX_PRIVATE_FRAME_MARKER;
     size_t offset;
     bool stalled = false;
     size_t bufferLength;
@@ -1277,9 +1280,10 @@ static void cmuxDecode(uCellMuxPrivateContext_t *pContext, uint32_t eventBitMap)
             parserContext.address = U_CELL_MUX_PRIVATE_ADDRESS_ANY;
             // Initial decode, which does NOT copy-out the information field
             // because we don't know if we have enough room in the buffers
-            errorCodeOrLength = uRingBufferParseHandle(&(pContext->ringBuffer),
-                                                       pContext->readHandle,
-                                                       parserList, &parserContext);
+            errorCodeOrLength = uRingBufferParseHandleSync(&(pContext->ringBuffer),
+                                                           pContext->readHandle,
+                                                           parserList, &syncByte, 1,
+                                                           &parserContext);
             if (errorCodeOrLength > 0) {
                 discardLength = 0;
                 pDeviceSerial = pUCellMuxPrivateGetDeviceSerial(pContext, parserContext.address);
@@ -1321,9 +1325,10 @@ static void cmuxDecode(uCellMuxPrivateContext_t *pContext, uint32_t eventBitMap)
                                     if ((discardLength == 0) || pTraffic->discardOnOverflow) {
                                         // Re-parse the buffer to actually get the information field
                                         parserContext.pInformation = pContext->scratch;
-                                        uRingBufferParseHandle(&(pContext->ringBuffer),
-                                                               pContext->readHandle,
-                                                               parserList, &parserContext);
+                                        uRingBufferParseHandleSync(&(pContext->ringBuffer),
+                                                                   pContext->readHandle,
+                                                                   parserList, &syncByte, 1,
+                                                                   &parserContext);
                                         if (parserContext.informationLengthBytes > bufferLength) {
                                             parserContext.informationLengthBytes = bufferLength;
                                         }
@@ -1579,9 +1584,12 @@ int32_t uCellMuxEnable(uDeviceHandle_t cellHandle)
                                                                          U_CELL_MUX_CALLBACK_TASK_PRIORITY,
                                                                          U_CELL_MUX_CALLBACK_QUEUE_LENGTH);
                         if (pContext->eventQueueHandle >= 0) {
-                            if (uRingBufferCreateWithReadHandle(&(pContext->ringBuffer),
-                                                                pContext->linearBuffer,
-                                                                sizeof(pContext->linearBuffer), 1) == 0) {
+                            // The ring buffer is only ever added to and
+                            // read from by the callback of the underlying
+                            // stream, so it need not lock in the data path
+                            if (uRingBufferCreateWithReadHandleLockFree(&(pContext->ringBuffer),
+                                                                        pContext->linearBuffer,
+                                                                        sizeof(pContext->linearBuffer), 1) == 0) {
                                 uRingBufferSetReadRequiresHandle(&(pContext->ringBuffer), true);
                                 pContext->readHandle = uRingBufferTakeReadHandle(&(pContext->ringBuffer));
                             } else {
@@ -33,7 +33,7 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
-#include "string.h"    // memcpy()
+#include "string.h"    // memcpy(), memmove()
 
 #include "u_compiler.h" // U_INLINE
 
@@ -66,10 +66,6 @@
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
-/** The CMUX frame boundary marker.
- */
-#define U_CELL_MUX_PRIVATE_FRAME_MARKER 0xf9
-
 /** Mask for the location of the command/response bit.
  */
 #define U_CELL_MUX_PRIVATE_COMMAND_RESPONSE_BIT_MASK 0x02
@@ -210,6 +206,45 @@ U_INLINE static bool getByte(uParseHandle_t parseHandle,
     return success;
 }
 
+// Get the data remaining as up to two contiguous spans: if parseHandle
+// is NULL then the rest of the pContext buffer is the single span, else
+// the ring-buffer will be used as the source.
+U_INLINE static size_t getSpans(uParseHandle_t parseHandle,
+                                uCellMuxPrivateParserContext_t *pContext,
+                                uRingBufferSpan_t *pSpans)
+{
+    size_t numSpans = 0;
+
+    if (parseHandle == NULL) {
+        if (pContext->bufferIndex < pContext->bufferSize) {
+            pSpans->pData = pContext->pBuffer + pContext->bufferIndex;
+            pSpans->length = pContext->bufferSize - pContext->bufferIndex;
+            numSpans = 1;
+        }
+    } else {
+        numSpans = uRingBufferGetSpansUnprotected(parseHandle, pSpans);
+    }
+
+    return numSpans;
+}
+
+// Move the parse position on: if parseHandle is NULL then
+// pContext->bufferIndex will be advanced, else the ring-buffer
+// parse position will be moved on.
+U_INLINE static void skip(uParseHandle_t parseHandle,
+                          uCellMuxPrivateParserContext_t *pContext,
+                          size_t length)
+{
+    if (parseHandle == NULL) {
+        if (length > pContext->bufferSize - pContext->bufferIndex) {
+            length = pContext->bufferSize - pContext->bufferIndex;
+        }
+        pContext->bufferIndex += length;
+    } else {
+        uRingBufferSkipUnprotected(parseHandle, length);
+    }
+}
+
 // Get the discard size: if parseHandle is non-NULL then the ring
 // buffer function will be called, else this will return 0 because
 // that is always the right answer for the linear buffer case.
@@ -353,15 +388,34 @@ int32_t uCellMuxPrivateParseCmux(uParseHandle_t parseHandle, void *pUserParam)
     if (bytesAvailable(parseHandle, pContextParser) < (size_t) informationLengthBytes + 2) {
         return U_ERROR_COMMON_TIMEOUT;
     }
-    for (size_t y = 0; y < informationLengthBytes; y++) {
-        getByte(parseHandle, pContextParser, &x);
-        if ((pContextParser->pInformation != NULL) && (y < pContextParser->informationLengthBytes)) {
-            *(pContextParser->pInformation + y) = (char) x;
+    // Copy out the I-field, and include it in the FCS if required,
+    // a contiguous span at a time
+    uRingBufferSpan_t span[2];
+    size_t numSpans = getSpans(parseHandle, pContextParser, span);
+    size_t y = 0;
+    for (size_t z = 0; (z < numSpans) && (y < informationLengthBytes); z++) {
+        const uint8_t *pData = (const uint8_t *) span[z].pData;
+        size_t length = span[z].length;
+        if (length > informationLengthBytes - y) {
+            length = informationLengthBytes - y;
         }
         if (type != U_CELL_MUX_PRIVATE_FRAME_TYPE_UIH) {
-            fcs = gFcsTable[fcs ^ x];
+            for (size_t w = 0; w < length; w++) {
+                fcs = gFcsTable[fcs ^ pData[w]];
+            }
+        }
+        // Do the copy after the FCS, and with memmove(), since
+        // pInformation is permitted to overlap the source buffer
+        if ((pContextParser->pInformation != NULL) && (y < pContextParser->informationLengthBytes)) {
+            size_t copyLength = length;
+            if (copyLength > pContextParser->informationLengthBytes - y) {
+                copyLength = pContextParser->informationLengthBytes - y;
+            }
+            memmove(pContextParser->pInformation + y, pData, copyLength);
         }
+        y += length;
     }
+    skip(parseHandle, pContextParser, informationLengthBytes);
     getByte(parseHandle, pContextParser, &x);
     // 0xCF is the reversed order of 11110011
     if (gFcsTable[fcs ^ x] != 0xCF) {
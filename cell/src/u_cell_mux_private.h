@@ -64,6 +64,10 @@ extern "C" {
 # define U_CELL_MUX_PRIVATE_VIRTUAL_SERIAL_BUFFER_LENGTH_BYTES (U_CELL_MUX_PRIVATE_INFORMATION_LENGTH_MAX_BYTES * 4)
 #endif
 
+/** The CMUX frame boundary marker.
+ */
+#define U_CELL_MUX_PRIVATE_FRAME_MARKER 0xf9
+
 /** The maximum overhead, on top of the information field length, for
  * a CMUX frame, consisting of 1 byte each for the opening and closing
  * flags, 1 byte for the address, 1 byte for control, up to 2 bytes
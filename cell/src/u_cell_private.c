@@ -116,7 +116,8 @@ const uCellPrivateModule_t gUCellPrivateModuleList[] = {
          // CMUX is supported here but we do not test it hence it is not marked as supported
          (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_UCGED)                         |
          (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_AUTHENTICATION_MODE_AUTOMATIC) |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_HTTP) /* features */
+         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_HTTP)                          |
+         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_AT_COMMAND_CONCATENATION) /* features */
         ),
         6, /* Default CMUX channel for GNSS */
         15 /* AT+CFUN reboot command */
@@ -145,7 +146,8 @@ const uCellPrivateModule_t gUCellPrivateModuleList[] = {
          (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_CMUX)                    |
          (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_LWM2M)                   |
          (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_UCGED)                   |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_HTTP) /* features */
+         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_HTTP)                    |
+         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_AT_COMMAND_CONCATENATION) /* features */
         ),
         3, /* Default CMUX channel for GNSS */
         15 /* AT+CFUN reboot command */
@@ -179,7 +181,8 @@ const uCellPrivateModule_t gUCellPrivateModuleList[] = {
          (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_CMUX)                                |
          (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_LWM2M)                               |
          (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_UCGED)                               |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_HTTP) /* features */
+         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_HTTP)                                |
+         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_AT_COMMAND_CONCATENATION) /* features */
         ),
         3, /* Default CMUX channel for GNSS */
         15 /* AT+CFUN reboot command */
@@ -203,7 +206,8 @@ const uCellPrivateModule_t gUCellPrivateModuleList[] = {
          (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_UART_POWER_SAVING)                   |
          (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_CMUX)                                |
          (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_UCGED)                               |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_HTTP) /* features */
+         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_HTTP)                                |
+         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_AT_COMMAND_CONCATENATION) /* features */
         ),
         3, /* Default CMUX channel for GNSS */
         15 /* AT+CFUN reboot command */
@@ -252,7 +256,8 @@ const uCellPrivateModule_t gUCellPrivateModuleList[] = {
          (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_AUTHENTICATION_MODE_AUTOMATIC)       |
          (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_LWM2M)                               |
          (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_UCGED)                               |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_HTTP) /* features */
+         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_HTTP)                                |
+         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_AT_COMMAND_CONCATENATION) /* features */
         ),
         4, /* Default CMUX channel for GNSS */
         16 /* AT+CFUN reboot command */
@@ -279,7 +284,8 @@ const uCellPrivateModule_t gUCellPrivateModuleList[] = {
          (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_CMUX)                                |
          (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_LWM2M)                               |
          (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_UCGED)                               |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_HTTP) /* features */
+         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_HTTP)                                |
+         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_AT_COMMAND_CONCATENATION) /* features */
         ),
         3, /* Default CMUX channel for GNSS */
         15 /* AT+CFUN reboot command */
@@ -323,7 +329,8 @@ const uCellPrivateModule_t gUCellPrivateModuleList[] = {
          (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SNR_REPORTED)                          |
          (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_LWM2M)                                 |
          (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_UCGED)                                 |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_HTTP) /* features */
+         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_HTTP)                                  |
+         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_AT_COMMAND_CONCATENATION) /* features */
         ),
         3, /* Default CMUX channel for GNSS */
         15 /* AT+CFUN reboot command */
@@ -356,7 +363,8 @@ const uCellPrivateModule_t gUCellPrivateModuleList[] = {
          (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_SNR_REPORTED)                        |
          (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_LWM2M)                               |
          (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_UCGED)                               |
-         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_HTTP) /* features */
+         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_HTTP)                                |
+         (1ULL << (int32_t) U_CELL_PRIVATE_FEATURE_AT_COMMAND_CONCATENATION) /* features */
         ),
         3, /* Default CMUX channel for GNSS */
         15 /* AT+CFUN reboot command */
@@ -902,6 +910,56 @@ int32_t uCellPrivateGetImei(const uCellPrivateInstance_t *pInstance,
     return errorCode;
 }
 
+// Get the firmware version string of the module.
+int32_t uCellPrivateGetFirmwareVersionStr(const uCellPrivateInstance_t *pInstance,
+                                          char *pStr, size_t size)
+{
+    int32_t errorCodeOrSize;
+    uAtClientHandle_t atHandle = pInstance->atHandle;
+    int32_t bytesRead;
+    char delimiter;
+
+    uAtClientLock(atHandle);
+    // Use ATI9 instead of AT+CGMR as it contains more information
+    uAtClientCommandStart(atHandle, "ATI9");
+    uAtClientCommandStop(atHandle);
+    // Don't want characters in the string being interpreted
+    // as delimiters
+    delimiter = uAtClientDelimiterGet(atHandle);
+    uAtClientDelimiterSet(atHandle, '\x00');
+    uAtClientResponseStart(atHandle, NULL);
+    bytesRead = uAtClientReadString(atHandle, pStr, size, false);
+    uAtClientResponseStop(atHandle);
+    // Restore the delimiter
+    uAtClientDelimiterSet(atHandle, delimiter);
+    errorCodeOrSize = uAtClientUnlock(atHandle);
+    if ((bytesRead >= 0) && (errorCodeOrSize == 0)) {
+        errorCodeOrSize = bytesRead;
+    } else {
+        errorCodeOrSize = (int32_t) U_CELL_ERROR_AT;
+    }
+
+    return errorCodeOrSize;
+}
+
+// Read the identity of the module into a state structure.
+void uCellPrivateStateGetIdentity(const uCellPrivateInstance_t *pInstance,
+                                  uCellPrivateState_t *pState)
+{
+    int32_t x;
+
+    pState->validBitMap &= (uint8_t) ~U_CELL_PRIVATE_STATE_IDENTITY;
+    if (uCellPrivateGetImei(pInstance, pState->imei) == 0) {
+        pState->validBitMap |= U_CELL_PRIVATE_STATE_IMEI;
+    }
+    x = uCellPrivateGetFirmwareVersionStr(pInstance, pState->firmwareVersion,
+                                          sizeof(pState->firmwareVersion));
+    // If the string filled the buffer it may have been truncated
+    if ((x >= 0) && (x < (int32_t) sizeof(pState->firmwareVersion) - 1)) {
+        pState->validBitMap |= U_CELL_PRIVATE_STATE_FIRMWARE_VERSION;
+    }
+}
+
 // Get whether the given instance is registered with the network.
 // Needs to be in the packet switched domain, circuit switched is
 // no use for this API.
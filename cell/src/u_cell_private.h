@@ -40,6 +40,41 @@ extern "C" {
  */
 #define U_CELL_PRIVATE_MAX_NUM_SIMULTANEOUS_RATS 3
 
+/** The length of the IMEI stored in #uCellPrivateState_t; the
+ * same as U_CELL_INFO_IMEI_SIZE, repeated here to avoid a
+ * dependency on u_cell_info.h.
+ */
+#define U_CELL_PRIVATE_STATE_IMEI_LENGTH_BYTES 15
+
+#ifndef U_CELL_PRIVATE_STATE_FIRMWARE_VERSION_MAX_LENGTH_BYTES
+/** The maximum length of the firmware version string (as returned
+ * by ATI9) that can be stored in #uCellPrivateState_t, including
+ * room for a null terminator; a module with a longer firmware
+ * version string simply won't have its state cached.
+ */
+# define U_CELL_PRIVATE_STATE_FIRMWARE_VERSION_MAX_LENGTH_BYTES 32
+#endif
+
+/** The number of raw numbers that can be returned by AT+UBANDMASK?,
+ * see uCellCfgGetBandMask() for the details.
+ */
+#define U_CELL_PRIVATE_STATE_BAND_MASK_RAW_MAX_NUM 6
+
+/** Bits for the validBitMap field of #uCellPrivateState_t.
+ */
+#define U_CELL_PRIVATE_STATE_IMEI             0x01
+#define U_CELL_PRIVATE_STATE_FIRMWARE_VERSION 0x02
+#define U_CELL_PRIVATE_STATE_MNO_PROFILE      0x04
+#define U_CELL_PRIVATE_STATE_GNSS_PROFILE     0x08
+#define U_CELL_PRIVATE_STATE_RAT              0x10
+#define U_CELL_PRIVATE_STATE_BAND_MASK        0x20
+
+/** The bits of the validBitMap field of #uCellPrivateState_t
+ * that identify the module which the state belongs to.
+ */
+#define U_CELL_PRIVATE_STATE_IDENTITY (U_CELL_PRIVATE_STATE_IMEI | \
+                                       U_CELL_PRIVATE_STATE_FIRMWARE_VERSION)
+
 #ifndef U_CELL_PRIVATE_AT_CFUN_OFF_RESPONSE_TIME_SECONDS
 /** The amount of time to allow to transition to
  * AT+CFUN=0, AT+CFUN=4, AT+CFUN=15 or AT+CFUN=16
@@ -242,7 +277,8 @@ typedef enum {
     U_CELL_PRIVATE_FEATURE_AUTHENTICATION_MODE_AUTOMATIC,
     U_CELL_PRIVATE_FEATURE_LWM2M,
     U_CELL_PRIVATE_FEATURE_UCGED,
-    U_CELL_PRIVATE_FEATURE_HTTP
+    U_CELL_PRIVATE_FEATURE_HTTP,
+    U_CELL_PRIVATE_FEATURE_AT_COMMAND_CONCATENATION
 } uCellPrivateFeature_t;
 
 /** The characteristics that may differ between cellular modules.
@@ -414,6 +450,25 @@ typedef struct uCellPrivateFileListContainer_t {
     struct uCellPrivateFileListContainer_t *pNext;
 } uCellPrivateFileListContainer_t;
 
+/** Cached module state: values that are expensive to read from
+ * the module at every power-on and which do not change unless we
+ * change them.  The state is only valid for the module whose IMEI
+ * and firmware version it contains; it may be saved and restored by
+ * the application with uCellCfgGetStateSnapshot() and
+ * uCellCfgSetStateSnapshot().
+ */
+typedef struct {
+    uint8_t validBitMap; /**< A bit-map of U_CELL_PRIVATE_STATE_xxx,
+                              indicating which fields are valid. */
+    char imei[U_CELL_PRIVATE_STATE_IMEI_LENGTH_BYTES]; /**< NOT null terminated. */
+    char firmwareVersion[U_CELL_PRIVATE_STATE_FIRMWARE_VERSION_MAX_LENGTH_BYTES]; /**< As returned by ATI9, null terminated. */
+    int32_t mnoProfile; /**< As returned by AT+UMNOPROF?. */
+    int32_t gnssProfileBitMap; /**< As returned by AT+UGPRF?. */
+    int8_t rat[U_CELL_PRIVATE_MAX_NUM_SIMULTANEOUS_RATS]; /**< uCellNetRat_t values, in rank order. */
+    uint64_t bandMaskRaw[U_CELL_PRIVATE_STATE_BAND_MASK_RAW_MAX_NUM]; /**< The numbers returned by AT+UBANDMASK?. */
+    size_t bandMaskRawCount; /**< The number of valid entries in bandMaskRaw. */
+} uCellPrivateState_t;
+
 /** Definition of a cellular instance.
  */
 typedef struct uCellPrivateInstance_t {
@@ -485,6 +540,14 @@ typedef struct uCellPrivateInstance_t {
     void *pCellTimeContext;  /**< Hook for CellTime context. */
     void *pCellTimeCellSyncContext;   /**< Hook for CellTime cell synchronisation context. */
     void *pFenceContext; /**< Storage for a uGeofenceContext_t. */
+    void *pStartupReport; /**< Storage for a uCellPwrStartupReport_t, lodged
+                               here as a void * to avoid spreading its
+                               types all over. */
+    uCellPrivateState_t state; /**< Cached module state, checked against
+                                    the module at each power-on. */
+    uCellPrivateState_t *pStatePending; /**< A state snapshot given to us by
+                                             the application, to be checked
+                                             at the next power-on. */
     struct uCellPrivateInstance_t *pNext;
 } uCellPrivateInstance_t;
 
@@ -641,6 +704,39 @@ int32_t uCellPrivateGetImsi(const uCellPrivateInstance_t *pInstance,
 int32_t uCellPrivateGetImei(const uCellPrivateInstance_t *pInstance,
                             char *pImei);
 
+/** Get the firmware version string of the module, as returned
+ * by ATI9; this always asks the module, it does not use the
+ * cached state.
+ *
+ * Note: gUCellPrivateMutex should be locked before this is called.
+ *
+ * @param pInstance  a pointer to the cellular instance.
+ * @param pStr       a pointer to size bytes of storage into which
+ *                   the firmware version string will be copied;
+ *                   a null terminator will be added.
+ * @param size       the number of bytes available at pStr,
+ *                   including room for a null terminator.
+ * @return           on success, the number of characters copied into
+ *                   pStr NOT including the terminator (as strlen()
+ *                   would return), on failure negative error code.
+ */
+int32_t uCellPrivateGetFirmwareVersionStr(const uCellPrivateInstance_t *pInstance,
+                                          char *pStr, size_t size);
+
+/** Read the identity of the module, i.e. the IMEI and the firmware
+ * version string, into the given state structure; always asks the
+ * module.  Only the identity fields are written; the corresponding
+ * bits of validBitMap are set if the read succeeded and cleared if
+ * it did not.
+ *
+ * Note: gUCellPrivateMutex should be locked before this is called.
+ *
+ * @param pInstance  a pointer to the cellular instance.
+ * @param pState     a pointer to the state to write to.
+ */
+void uCellPrivateStateGetIdentity(const uCellPrivateInstance_t *pInstance,
+                                  uCellPrivateState_t *pState);
+
 /** Get whether the given instance is registered with the network.
  *
  * Note: gUCellPrivateMutex should be locked before this is called.
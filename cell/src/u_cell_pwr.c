@@ -33,7 +33,7 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
-#include "string.h"    // strlen()
+#include "string.h"    // strlen(), strcmp(), memcmp(), memset()
 
 #include "u_cfg_sw.h"
 
@@ -74,6 +74,16 @@
  */
 #define U_CELL_PWR_CONFIGURATION_COMMAND_TRIES 3
 
+#ifndef U_CELL_PWR_CONFIGURATION_LINE_MAX_LENGTH_BYTES
+/** The maximum length of an AT command line, including the "AT"
+ * prefix but not the terminator, into which configuration commands
+ * are concatenated if the module supports it.  Modules will accept
+ * far longer lines than this, it is kept short since the line is
+ * assembled on the stack.
+ */
+# define U_CELL_PWR_CONFIGURATION_LINE_MAX_LENGTH_BYTES 64
+#endif
+
 /** The UART power saving duration in GSM frames, needed for the
  * UART power saving AT command.
  */
@@ -102,6 +112,22 @@ typedef enum {
     U_CELL_PWR_PSV_MODE_DATA_SARA_R4_LENA_R8 = 4 /**< Module wakes up on TXD line activity, SARA-R4/LENA-R8 version. */
 } uCellPwrPsvMode_t;
 
+/** A configuration command: an entry in the table that
+ * moduleConfigure() compiles into a batch.
+ */
+typedef struct {
+    const char *pCommand;       /**< the command without the "AT"
+                                     prefix, e.g. "+CMEE=2". */
+    const char *pQuery;         /**< for a setting that the module keeps
+                                     in non-volatile memory, a command,
+                                     again without the "AT" prefix, that
+                                     reads it back, else NULL. */
+    const char *pQueryPrefix;   /**< the prefix of the response to pQuery. */
+    const char *pQueryResponse; /**< the parameters of the response to
+                                     pQuery that mean the setting is
+                                     already correct, comma separated. */
+} uCellPwrConfigCommand_t;
+
 /** All the parameters for a wake-up-from-deep sleep callback.
  */
 typedef struct {
@@ -127,10 +153,13 @@ typedef struct {
  * VARIABLES
  * -------------------------------------------------------------- */
 
-/** Table of AT commands to send to all cellular module types
- * during configuration.
+/** Table of configuration commands to send to all cellular module
+ * types; these are compiled into a batch by moduleConfigure() so
+ * the "AT" prefix is omitted.  The order is the order in which the
+ * commands are sent.
  */
-static const char *const gpConfigCommand[] = {"ATE0",      // Echo off
+static const uCellPwrConfigCommand_t gConfigCommand[] = {
+    {"E0", NULL, NULL, NULL}, // Echo off
 #ifdef U_CFG_CELL_ENABLE_NUMERIC_ERROR
 // With this compilation flag defined numeric errors will be
 // returned and so uAtClientDeviceErrorGet() will be able
@@ -138,28 +167,52 @@ static const char *const gpConfigCommand[] = {"ATE0",      // Echo off
 // IMPORTANT: this switch is simply for customer convenience,
 // no ubxlib code should set it or depend on the value
 // of deviceError.code.
-                                              "AT+CMEE=1", // Extended errors on, numeric format
+    {"+CMEE=1", NULL, NULL, NULL}, // Extended errors on, numeric format
 #else
 // The normal case: errors are reported by the module as
 // verbose text, most useful when debugging normally with
 // AT interface prints shown, uAtClientPrintAtSet() set
 // to true.
-                                              "AT+CMEE=2", // Extended errors on, verbose/text format
+    {"+CMEE=2", NULL, NULL, NULL}, // Extended errors on, verbose/text format
 #endif
 #ifdef U_CFG_1V8_SIM_WORKAROUND
 // This can be used to tell a SARA-R422 module that a 1.8V
 // SIM which does NOT include 1.8V in its answer-to-reset
 // really is a good 1.8V SIM.
-                                              "AT+UDCONF=92,1,1",
+    {"+UDCONF=92,1,1", "+UDCONF=92", "+UDCONF:", "92,1,1"},
 #endif
 // SARA-R5xxx-01B remembers whether sockets are in hex mode or
 // not so reset that here in order that all modules behave the
 // same way
-                                              "AT+UDCONF=1,0",
-                                              "ATI9",      // Firmware version
-                                              "AT&C1",     // DCD circuit (109) changes with the carrier
-                                              "AT&D0"      // Ignore changes to DTR
-                                             };
+    {"+UDCONF=1,0", "+UDCONF=1", "+UDCONF:", "1,0"},
+    {"&C1", NULL, NULL, NULL}, // DCD circuit (109) changes with the carrier
+    {"&D0", NULL, NULL, NULL}  // Ignore changes to DTR
+};
+
+/** Configuration command to read the firmware version, only
+ * added to the batch when stateCheck() is not going to read it
+ * anyway; it is there so that the version appears in the AT
+ * interface prints.
+ */
+static const uCellPwrConfigCommand_t gConfigCommandFirmwareVersion = {"I9", NULL, NULL, NULL};
+
+/** Configuration command to set the UCGED mode on SARA-R4 and
+ * LARA-R6 modules that support mode 5.
+ */
+static const uCellPwrConfigCommand_t gConfigCommandUcged5 = {"+UCGED=5", NULL, NULL, NULL};
+
+/** Configuration command to set the UCGED mode on SARA-R4 and
+ * LARA-R6 modules that only support mode 2.
+ */
+static const uCellPwrConfigCommand_t gConfigCommandUcged2 = {"+UCGED=2", NULL, NULL, NULL};
+
+/** Configuration command to switch flow control on.
+ */
+static const uCellPwrConfigCommand_t gConfigCommandFlowControlOn = {"&K3", NULL, NULL, NULL};
+
+/** Configuration command to switch flow control off.
+ */
+static const uCellPwrConfigCommand_t gConfigCommandFlowControlOff = {"&K0", NULL, NULL, NULL};
 
 /** Array to convert the RAT emited by AT+CEDRXS to one of our RATs.
  */
@@ -918,52 +971,336 @@ static bool moduleConfigureOne(uAtClientHandle_t atHandle,
     return success;
 }
 
-// Configure the cellular module.
+// Append a configuration command to an AT command line of length
+// *pLength, adding the ';' separator that must follow an extended
+// (i.e. "+") command, pPrevious being the last command added or
+// NULL if this is the first; returns false if there is no room.
+static bool lineAppend(char *pLine, size_t *pLength,
+                       const char *pCommand, const char *pPrevious)
+{
+    bool success = false;
+    size_t length = *pLength;
+    size_t commandLength = strlen(pCommand);
+    bool separate = (pPrevious != NULL) && (*pPrevious == '+');
+
+    if (length + commandLength + (separate ? 1 : 0) <=
+        U_CELL_PWR_CONFIGURATION_LINE_MAX_LENGTH_BYTES) {
+        if (separate) {
+            *(pLine + length) = ';';
+            length++;
+        }
+        memcpy(pLine + length, pCommand, commandLength);
+        length += commandLength;
+        *(pLine + length) = 0;
+        *pLength = length;
+        success = true;
+    }
+
+    return success;
+}
+
+// Read the parameters of a response and check if they are
+// the comma-separated parameters at pExpected.
+static bool responseMatches(uAtClientHandle_t atHandle,
+                            const char *pExpected)
+{
+    bool matches = true;
+    char buffer[8]; // Enough for any single parameter we check
+    const char *pEnd;
+    size_t length;
+
+    while (matches && (pExpected != NULL)) {
+        pEnd = strchr(pExpected, ',');
+        length = (pEnd != NULL) ? (size_t) (pEnd - pExpected) : strlen(pExpected);
+        matches = (uAtClientReadString(atHandle, buffer, sizeof(buffer),
+                                       false) == (int32_t) length) &&
+                  (memcmp(buffer, pExpected, length) == 0);
+        pExpected = (pEnd != NULL) ? pEnd + 1 : NULL;
+    }
+
+    return matches;
+}
+
+// Read back those settings in a batch of configuration commands
+// that the module keeps in non-volatile memory, returning a bit-map
+// of the commands that need not be sent since the setting is
+// already correct; the point is not to write to non-volatile
+// memory in the module, which takes time and wears it, when there
+// is no need.
+static uint32_t moduleConfigureReadBack(const uCellPrivateInstance_t *pInstance,
+                                        const uCellPwrConfigCommand_t *const *ppBatch,
+                                        size_t numCommands)
+{
+    uint32_t skipBitMap = 0;
+    uint32_t lineBitMap;
+    uint32_t matchBitMap;
+    uAtClientHandle_t atHandle = pInstance->atHandle;
+    bool concatenate = U_CELL_PRIVATE_HAS(pInstance->pModule,
+                                          U_CELL_PRIVATE_FEATURE_AT_COMMAND_CONCATENATION);
+    char line[U_CELL_PWR_CONFIGURATION_LINE_MAX_LENGTH_BYTES + 1] = "AT";
+    const char *pPrevious;
+    size_t length;
+    size_t x = 0;
+
+    while (x < numCommands) {
+        // Put as many queries as we can into one AT command line
+        length = 2;
+        pPrevious = NULL;
+        lineBitMap = 0;
+        for (; x < numCommands; x++) {
+            if (ppBatch[x]->pQuery != NULL) {
+                if (((pPrevious != NULL) && !concatenate) ||
+                    !lineAppend(line, &length, ppBatch[x]->pQuery, pPrevious)) {
+                    break;
+                }
+                pPrevious = ppBatch[x]->pQuery;
+                lineBitMap |= 1UL << x;
+            }
+        }
+        if (lineBitMap == 0) {
+            // Either there are no more queries or one won't fit
+            // into a line at all: either way, we're done
+            break;
+        }
+        // The responses arrive in the order of the queries
+        matchBitMap = 0;
+        uAtClientLock(atHandle);
+        uAtClientCommandStart(atHandle, line);
+        uAtClientCommandStop(atHandle);
+        for (size_t y = 0; y < numCommands; y++) {
+            if (((lineBitMap & (1UL << y)) != 0) &&
+                (uAtClientResponseStart(atHandle, ppBatch[y]->pQueryPrefix) == 0) &&
+                responseMatches(atHandle, ppBatch[y]->pQueryResponse)) {
+                matchBitMap |= 1UL << y;
+            }
+        }
+        uAtClientResponseStop(atHandle);
+        if (uAtClientUnlock(atHandle) == 0) {
+            // Only believe the answers if the whole line worked
+            skipBitMap |= matchBitMap;
+        }
+    }
+
+    return skipBitMap;
+}
+
+// Send a batch of configuration commands to the module, skipping
+// those that are already correct and, if the module supports it,
+// concatenating the rest into as few AT command lines as possible,
+// recording what happened in pReport if it is not NULL.  There may
+// be no more than 32 commands in a batch.
+static bool moduleConfigureBatch(const uCellPrivateInstance_t *pInstance,
+                                 const uCellPwrConfigCommand_t *const *ppBatch,
+                                 size_t numCommands,
+                                 uCellPwrStartupReport_t *pReport)
+{
+    bool success = true;
+    uAtClientHandle_t atHandle = pInstance->atHandle;
+    bool concatenate = U_CELL_PRIVATE_HAS(pInstance->pModule,
+                                          U_CELL_PRIVATE_FEATURE_AT_COMMAND_CONCATENATION);
+    uint32_t skipBitMap = moduleConfigureReadBack(pInstance, ppBatch, numCommands);
+    uint32_t lineBitMap;
+    char line[U_CELL_PWR_CONFIGURATION_LINE_MAX_LENGTH_BYTES + 1] = "AT";
+    const char *pPrevious;
+    size_t length;
+    size_t numInLine;
+    int32_t lineIndex = 0;
+    int32_t startTimeMs;
+    size_t x = 0;
+
+    if (pReport != NULL) {
+        pReport->numCommands = numCommands;
+        for (size_t y = 0; (y < numCommands) &&
+             (y < U_CELL_PWR_STARTUP_REPORT_MAX_COMMANDS); y++) {
+            pReport->command[y].pCommand = ppBatch[y]->pCommand;
+            pReport->command[y].skipped = ((skipBitMap & (1UL << y)) != 0);
+            pReport->command[y].lineIndex = -1;
+            pReport->command[y].durationMs = 0;
+            if (pReport->command[y].skipped) {
+                pReport->numCommandsSkipped++;
+            }
+        }
+    }
+
+    while (success && (x < numCommands)) {
+        // Put as many commands as we can into one AT command line
+        length = 2;
+        pPrevious = NULL;
+        lineBitMap = 0;
+        numInLine = 0;
+        for (; x < numCommands; x++) {
+            if ((skipBitMap & (1UL << x)) == 0) {
+                if (((pPrevious != NULL) && !concatenate) ||
+                    !lineAppend(line, &length, ppBatch[x]->pCommand, pPrevious)) {
+                    break;
+                }
+                pPrevious = ppBatch[x]->pCommand;
+                lineBitMap |= 1UL << x;
+                numInLine++;
+            }
+        }
+        if (numInLine == 0) {
+            // Nothing more to send, or a command that won't
+            // fit into a line at all, which is a failure
+            success = (x >= numCommands);
+            break;
+        }
+        startTimeMs = (int32_t) uPortGetTickTimeMs();
+        if (numInLine == 1) {
+            success = moduleConfigureOne(atHandle, line,
+                                         U_CELL_PWR_CONFIGURATION_COMMAND_TRIES);
+        } else {
+            success = moduleConfigureOne(atHandle, line, 1);
+            // If one command in a concatenated line fails the module
+            // abandons the rest of the line, so fall back to sending
+            // the commands of the line one at a time, with retries
+            if (!success) {
+                success = true;
+                for (size_t y = 0; success && (y < numCommands); y++) {
+                    if ((lineBitMap & (1UL << y)) != 0) {
+                        length = 2;
+                        lineAppend(line, &length, ppBatch[y]->pCommand, NULL);
+                        success = moduleConfigureOne(atHandle, line,
+                                                     U_CELL_PWR_CONFIGURATION_COMMAND_TRIES);
+                    }
+                }
+            }
+        }
+        if (pReport != NULL) {
+            for (size_t y = 0; (y < numCommands) &&
+                 (y < U_CELL_PWR_STARTUP_REPORT_MAX_COMMANDS); y++) {
+                if ((lineBitMap & (1UL << y)) != 0) {
+                    pReport->command[y].lineIndex = lineIndex;
+                    pReport->command[y].durationMs = (int32_t) uPortGetTickTimeMs() - startTimeMs;
+                }
+            }
+            pReport->numLines++;
+        }
+        lineIndex++;
+    }
+
+    return success;
+}
+
+// Get the state that stateCheck() will check: a state snapshot
+// handed to us by the application or, failing that, the cached
+// state; NULL if that has no identity to check against.
+static const uCellPrivateState_t *pStateCandidate(const uCellPrivateInstance_t *pInstance)
+{
+    const uCellPrivateState_t *pCandidate = pInstance->pStatePending;
+
+    if (pCandidate == NULL) {
+        pCandidate = &(pInstance->state);
+    }
+    if ((pCandidate->validBitMap & U_CELL_PRIVATE_STATE_IDENTITY) !=
+        U_CELL_PRIVATE_STATE_IDENTITY) {
+        pCandidate = NULL;
+    }
+
+    return pCandidate;
+}
+
+// Check the cached state of the module, or a state snapshot
+// handed to us by the application, against the identity of the
+// module: if they match the state is kept, else it is discarded.
+// If there is nothing to check against the identity is not read
+// here, uCellCfgGetStateSnapshot() reads it when it is needed.
+static void stateCheck(uCellPrivateInstance_t *pInstance)
+{
+    uCellPrivateState_t identity;
+    const uCellPrivateState_t *pCandidate = pStateCandidate(pInstance);
+
+    memset(&identity, 0, sizeof(identity));
+    if (pCandidate != NULL) {
+        uCellPrivateStateGetIdentity(pInstance, &identity);
+    }
+    if ((pCandidate != NULL) &&
+        ((identity.validBitMap & U_CELL_PRIVATE_STATE_IDENTITY) == U_CELL_PRIVATE_STATE_IDENTITY) &&
+        (memcmp(identity.imei, pCandidate->imei, sizeof(identity.imei)) == 0) &&
+        (strcmp(identity.firmwareVersion, pCandidate->firmwareVersion) == 0)) {
+        if (pCandidate != &(pInstance->state)) {
+            pInstance->state = *pCandidate;
+        }
+        uPortLog("U_CELL_PWR: module state is known (0x%02x).\n",
+                 pInstance->state.validBitMap);
+    } else {
+        if (pCandidate != NULL) {
+            uPortLog("U_CELL_PWR: module identity does not match that"
+                     " of the stored state, discarding it.\n");
+        }
+        pInstance->state = identity;
+    }
+    // A state snapshot is only ever checked once
+    uPortFree(pInstance->pStatePending);
+    pInstance->pStatePending = NULL;
+}
+
+// Configure the cellular module; startTimeMs is the tick time
+// at which power-on began, used only for the start-up report.
 static int32_t moduleConfigure(uCellPrivateInstance_t *pInstance,
-                               bool andRadioOff, bool returningFromSleep)
+                               bool andRadioOff, bool returningFromSleep,
+                               int32_t startTimeMs)
 {
     int32_t errorCode = (int32_t) U_CELL_ERROR_NOT_CONFIGURED;
     bool success = true;
     uAtClientHandle_t atHandle = pInstance->atHandle;
     uAtClientStreamHandle_t stream = U_AT_CLIENT_STREAM_HANDLE_DEFAULTS;
     uCellPwrPsvMode_t uartPowerSavingMode = U_CELL_PWR_PSV_MODE_DISABLED; // Assume no UART power saving
+    // +3 for the firmware version, UCGED and flow control commands
+    const uCellPwrConfigCommand_t *pBatch[(sizeof(gConfigCommand) / sizeof(gConfigCommand[0])) + 3];
+    size_t numCommands = 0;
+    uCellPwrStartupReport_t *pReport;
+    int32_t configureStartTimeMs = (int32_t) uPortGetTickTimeMs();
     char buffer[20]; // Enough room for AT+UPSV=2,1300
     char *pServerNameGnss;
     int32_t y;
 
-    // First send all the commands that everyone gets
-    for (size_t x = 0;
-         (x < sizeof(gpConfigCommand) / sizeof(gpConfigCommand[0])) &&
-         success; x++) {
-        success = moduleConfigureOne(atHandle, gpConfigCommand[x],
-                                     U_CELL_PWR_CONFIGURATION_COMMAND_TRIES);
+    // Start a fresh start-up report
+    if (pInstance->pStartupReport == NULL) {
+        pInstance->pStartupReport = pUPortMalloc(sizeof(uCellPwrStartupReport_t));
+    }
+    pReport = (uCellPwrStartupReport_t *) pInstance->pStartupReport;
+    if (pReport != NULL) {
+        memset(pReport, 0, sizeof(*pReport));
+        pReport->aliveMs = configureStartTimeMs - startTimeMs;
+        pReport->readyMs = -1;
+    }
+
+    // Compile the batch of configuration commands, starting
+    // with those that everyone gets
+    for (size_t x = 0; x < sizeof(gConfigCommand) / sizeof(gConfigCommand[0]); x++) {
+        pBatch[numCommands] = &(gConfigCommand[x]);
+        numCommands++;
+    }
+    if (pStateCandidate(pInstance) == NULL) {
+        // stateCheck() won't be sending ATI9 so do it here
+        pBatch[numCommands] = &gConfigCommandFirmwareVersion;
+        numCommands++;
     }
 
-    if (success &&
-        U_CELL_PRIVATE_HAS(pInstance->pModule, U_CELL_PRIVATE_FEATURE_UCGED) &&
+    if (U_CELL_PRIVATE_HAS(pInstance->pModule, U_CELL_PRIVATE_FEATURE_UCGED) &&
         (U_CELL_PRIVATE_MODULE_IS_SARA_R4(pInstance->pModule->moduleType) ||
          (pInstance->pModule->moduleType == U_CELL_MODULE_TYPE_LARA_R6))) {
         // SARA-R4 and LARA-R6 only: switch on the right UCGED mode
         // (SARA-R5 and SARA-U201 have a single mode and require no setting)
         if (U_CELL_PRIVATE_HAS(pInstance->pModule, U_CELL_PRIVATE_FEATURE_UCGED5)) {
-            success = moduleConfigureOne(atHandle, "AT+UCGED=5",
-                                         U_CELL_PWR_CONFIGURATION_COMMAND_TRIES);
+            pBatch[numCommands] = &gConfigCommandUcged5;
         } else {
-            success = moduleConfigureOne(atHandle, "AT+UCGED=2",
-                                         U_CELL_PWR_CONFIGURATION_COMMAND_TRIES);
+            pBatch[numCommands] = &gConfigCommandUcged2;
         }
+        numCommands++;
     }
 
     uAtClientStreamGetExt(atHandle, &stream);
-    if (success && (stream.type == U_AT_CLIENT_STREAM_TYPE_UART)) {
+    if (stream.type == U_AT_CLIENT_STREAM_TYPE_UART) {
         // Get the UART stream handle and set the flow
         // control and power saving mode correctly for it
         // TODO: check if AT&K3 requires both directions
         // of flow control to be on or just one of them
         if (uPortUartIsRtsFlowControlEnabled(stream.handle.int32) &&
             uPortUartIsCtsFlowControlEnabled(stream.handle.int32)) {
-            success = moduleConfigureOne(atHandle, "AT&K3",
-                                         U_CELL_PWR_CONFIGURATION_COMMAND_TRIES);
+            pBatch[numCommands] = &gConfigCommandFlowControlOn;
+            numCommands++;
             if (uAtClientWakeUpHandlerIsSet(atHandle)) {
                 // The RTS/CTS handshaking lines are being used
                 // for flow control by the UART HW.  This complicates
@@ -986,8 +1323,8 @@ static int32_t moduleConfigure(uCellPrivateInstance_t *pInstance,
                 }
             }
         } else {
-            success = moduleConfigureOne(atHandle, "AT&K0",
-                                         U_CELL_PWR_CONFIGURATION_COMMAND_TRIES);
+            pBatch[numCommands] = &gConfigCommandFlowControlOff;
+            numCommands++;
             // RTS/CTS handshaking is not used by the UART HW, we
             // can use the wake-up on TX line feature without any
             // complications
@@ -999,6 +1336,9 @@ static int32_t moduleConfigure(uCellPrivateInstance_t *pInstance,
         }
     }
 
+    // Send the batch
+    success = moduleConfigureBatch(pInstance, pBatch, numCommands, pReport);
+
     if (success && uAtClientWakeUpHandlerIsSet(atHandle) &&
         (pInstance->pinDtrPowerSaving >= 0) &&
         U_CELL_PRIVATE_HAS(pInstance->pModule,
@@ -1099,17 +1439,26 @@ static int32_t moduleConfigure(uCellPrivateInstance_t *pInstance,
     }
 
     if (success) {
+        // Find out if what we know of the module's state still holds
+        stateCheck(pInstance);
         pInstance->mnoProfile = -1;
         if (U_CELL_PRIVATE_HAS(pInstance->pModule,
                                U_CELL_PRIVATE_FEATURE_MNO_PROFILE)) {
-            // Retrieve and store the current MNO profile
-            uAtClientLock(atHandle);
-            uAtClientCommandStart(atHandle, "AT+UMNOPROF?");
-            uAtClientCommandStop(atHandle);
-            uAtClientResponseStart(atHandle, "+UMNOPROF:");
-            pInstance->mnoProfile = uAtClientReadInt(atHandle);
-            uAtClientResponseStop(atHandle);
-            uAtClientUnlock(atHandle);
+            if (pInstance->state.validBitMap & U_CELL_PRIVATE_STATE_MNO_PROFILE) {
+                pInstance->mnoProfile = pInstance->state.mnoProfile;
+            } else {
+                // Retrieve and store the current MNO profile
+                uAtClientLock(atHandle);
+                uAtClientCommandStart(atHandle, "AT+UMNOPROF?");
+                uAtClientCommandStop(atHandle);
+                uAtClientResponseStart(atHandle, "+UMNOPROF:");
+                pInstance->mnoProfile = uAtClientReadInt(atHandle);
+                uAtClientResponseStop(atHandle);
+                if ((uAtClientUnlock(atHandle) == 0) && (pInstance->mnoProfile >= 0)) {
+                    pInstance->state.mnoProfile = pInstance->mnoProfile;
+                    pInstance->state.validBitMap |= U_CELL_PRIVATE_STATE_MNO_PROFILE;
+                }
+            }
         }
         // The module may have a GNSS module inside it or
         // connected via it, in which case, if we are to use
@@ -1120,17 +1469,28 @@ static int32_t moduleConfigure(uCellPrivateInstance_t *pInstance,
         // GNSS chip is switched off, so it is best to do it
         // now.  Don't fail on the outcome here in case this
         // is not supported for some reason (in which case
-        // we won't be able to use GNSS via cellular)
-        pServerNameGnss = (char *) pUPortMalloc(U_CELL_CFG_GNSS_SERVER_NAME_MAX_LEN_BYTES);
-        if (pServerNameGnss != NULL) {
-            y = uCellPrivateGetGnssProfile(pInstance, pServerNameGnss,
-                                           U_CELL_CFG_GNSS_SERVER_NAME_MAX_LEN_BYTES);
-            if ((y >= 0) && ((y & U_CELL_CFG_GNSS_PROFILE_MUX) == 0)) {
-                y |= U_CELL_CFG_GNSS_PROFILE_MUX;
-                uCellPrivateSetGnssProfile(pInstance, y, pServerNameGnss);
+        // we won't be able to use GNSS via cellular).  No need
+        // to do any of this if we already know it is done
+        if (((pInstance->state.validBitMap & U_CELL_PRIVATE_STATE_GNSS_PROFILE) == 0) ||
+            ((pInstance->state.gnssProfileBitMap & U_CELL_CFG_GNSS_PROFILE_MUX) == 0)) {
+            pServerNameGnss = (char *) pUPortMalloc(U_CELL_CFG_GNSS_SERVER_NAME_MAX_LEN_BYTES);
+            if (pServerNameGnss != NULL) {
+                y = uCellPrivateGetGnssProfile(pInstance, pServerNameGnss,
+                                               U_CELL_CFG_GNSS_SERVER_NAME_MAX_LEN_BYTES);
+                if ((y >= 0) && ((y & U_CELL_CFG_GNSS_PROFILE_MUX) == 0)) {
+                    if (uCellPrivateSetGnssProfile(pInstance, y | U_CELL_CFG_GNSS_PROFILE_MUX,
+                                                   pServerNameGnss) == 0) {
+                        y |= U_CELL_CFG_GNSS_PROFILE_MUX;
+                    }
+                }
+                pInstance->state.validBitMap &= (uint8_t) ~U_CELL_PRIVATE_STATE_GNSS_PROFILE;
+                if (y >= 0) {
+                    pInstance->state.gnssProfileBitMap = y;
+                    pInstance->state.validBitMap |= U_CELL_PRIVATE_STATE_GNSS_PROFILE;
+                }
+                // Free memory
+                uPortFree(pServerNameGnss);
             }
-            // Free memory
-            uPortFree(pServerNameGnss);
         }
         if (andRadioOff) {
             // Switch the radio off until commanded to connect
@@ -1153,6 +1513,18 @@ static int32_t moduleConfigure(uCellPrivateInstance_t *pInstance,
         }
     }
 
+    if (pReport != NULL) {
+        pReport->configureMs = (int32_t) uPortGetTickTimeMs() - configureStartTimeMs;
+        if (errorCode == 0) {
+            pReport->readyMs = pReport->aliveMs + pReport->configureMs;
+            uPortLog("U_CELL_PWR: ready %d ms after power-on, configuration"
+                     " took %d ms (%d command(s) in %d line(s), %d already set).\n",
+                     (int) pReport->readyMs, (int) pReport->configureMs,
+                     (int) pReport->numCommands, (int) pReport->numLines,
+                     (int) pReport->numCommandsSkipped);
+        }
+    }
+
     return errorCode;
 }
 
@@ -1287,6 +1659,7 @@ int32_t uCellPwrPrivateOn(uCellPrivateInstance_t *pInstance,
     uDeviceHandle_t cellHandle = pInstance->cellHandle;
     uCellPrivateSleep_t *pSleepContext = pInstance->pSleepContext;
     uCellPwrDeepSleepWakeUpCallback_t *pCallback;
+    int32_t startTimeMs = (int32_t) uPortGetTickTimeMs();
 
     // We're powering on: set the sleep state to unknown, when
     // we configure the module we will set the sleep state up
@@ -1319,7 +1692,7 @@ int32_t uCellPwrPrivateOn(uCellPrivateInstance_t *pInstance,
         // already registered
         errorCode = moduleConfigure(pInstance,
                                     !uCellPrivateIsRegistered(pInstance),
-                                    asleepAtStart);
+                                    asleepAtStart, startTimeMs);
         if (errorCode != 0) {
             // I have seen situations where the module responds
             // initially and then fails configuration.  If that is
@@ -1379,7 +1752,7 @@ int32_t uCellPwrPrivateOn(uCellPrivateInstance_t *pInstance,
                 // the registration status)
                 errorCode = moduleConfigure(pInstance,
                                             !uCellPrivateIsRegistered(pInstance),
-                                            asleepAtStart);
+                                            asleepAtStart, startTimeMs);
                 if (errorCode != 0) {
                     // If the module fails configuration, power it
                     // off and try again
@@ -1788,6 +2161,35 @@ int32_t uCellPwrOn(uDeviceHandle_t cellHandle, const char *pSimPinCode,
     return errorCode;
 }
 
+// Get the timing of the last power-on.
+int32_t uCellPwrGetStartupReport(uDeviceHandle_t cellHandle,
+                                 uCellPwrStartupReport_t *pReport)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+    const uCellPwrStartupReport_t *pStartupReport;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((pInstance != NULL) && (pReport != NULL)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+            pStartupReport = (const uCellPwrStartupReport_t *) pInstance->pStartupReport;
+            if ((pStartupReport != NULL) && (pStartupReport->readyMs >= 0)) {
+                *pReport = *pStartupReport;
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return errorCode;
+}
+
 // Power the cellular module off.
 int32_t uCellPwrOff(uDeviceHandle_t cellHandle,
                     bool (*pKeepGoingCallback) (uDeviceHandle_t))
@@ -1911,6 +2313,7 @@ int32_t uCellPwrReboot(uDeviceHandle_t cellHandle,
     uCellPrivateInstance_t *pInstance;
     uAtClientHandle_t atHandle;
     bool success = false;
+    int32_t startTimeMs = (int32_t) uPortGetTickTimeMs();
 
     if (gUCellPrivateMutex != NULL) {
 
@@ -1963,7 +2366,7 @@ int32_t uCellPwrReboot(uDeviceHandle_t cellHandle,
                         // Sleep is no longer available
                         pInstance->deepSleepState = U_CELL_PRIVATE_DEEP_SLEEP_STATE_UNAVAILABLE;
                         // Configure the module
-                        errorCode = moduleConfigure(pInstance, true, false);
+                        errorCode = moduleConfigure(pInstance, true, false, startTimeMs);
                     }
                     if (errorCode == 0) {
                         success = true;
@@ -2028,6 +2431,7 @@ int32_t uCellPwrResetHard(uDeviceHandle_t cellHandle, int32_t pinReset)
     int32_t platformError;
     uPortGpioConfig_t gpioConfig;
     int64_t startTime;
+    int32_t startTimeMs = (int32_t) uPortGetTickTimeMs();
     int32_t resetHoldMilliseconds;
     int32_t pinResetToggleToState = (pinReset & U_CELL_PIN_INVERTED) ?
                                     !U_CELL_RESET_PIN_TOGGLE_TO_STATE : U_CELL_RESET_PIN_TOGGLE_TO_STATE;
@@ -2103,7 +2507,7 @@ int32_t uCellPwrResetHard(uDeviceHandle_t cellHandle, int32_t pinReset)
                     if (errorCode == 0) {
                         pInstance->deepSleepState = U_CELL_PRIVATE_DEEP_SLEEP_STATE_UNKNOWN;
                         // Configure the module
-                        errorCode = moduleConfigure(pInstance, true, false);
+                        errorCode = moduleConfigure(pInstance, true, false, startTimeMs);
                     }
                 } else {
                     uPortLog("U_CELL_PWR: uPortGpioConfig() for RESET pin %d"
@@ -99,6 +99,15 @@
 #define U_CELL_SOCK_SARA_R422_DNS_DELAY_MILLISECONDS 500
 #endif
 
+#ifndef U_CELL_SOCK_HEX_CHUNK_LENGTH_BYTES
+/** When sending in hex mode the data is hex-coded into a buffer
+ * on the stack, this many bytes of data (twice this many hex
+ * characters) at a time, rather than all at once into a buffer
+ * taken from the heap.
+ */
+# define U_CELL_SOCK_HEX_CHUNK_LENGTH_BYTES 64
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -200,6 +209,33 @@ static void doUsoer(uAtClientHandle_t atHandle)
     uAtClientUnlock(atHandle);
 }
 
+// Write data as a quoted hex string, as an AT command parameter,
+// hex-coding it in chunks on the stack; the opening quote goes
+// out with the first chunk and the closing quote with the last.
+static void writeHexQuoted(uAtClientHandle_t atHandle, const char *pData,
+                           size_t dataSizeBytes)
+{
+    char hexBuffer[U_CELL_SOCK_HEX_CHUNK_LENGTH_BYTES * 2];
+    uAtClientIoVec_t ioVec[] = {{"\"", 1}, {hexBuffer, 0}, {"\"", 1}};
+    size_t thisSize;
+    bool first = true;
+
+    do {
+        thisSize = dataSizeBytes;
+        if (thisSize > U_CELL_SOCK_HEX_CHUNK_LENGTH_BYTES) {
+            thisSize = U_CELL_SOCK_HEX_CHUNK_LENGTH_BYTES;
+        }
+        ioVec[1].lengthBytes = uBinToHex(pData, thisSize, hexBuffer);
+        pData += thisSize;
+        dataSizeBytes -= thisSize;
+        // Only the first chunk is preceded by a delimiter
+        uAtClientWriteBytesV(atHandle, first ? ioVec : ioVec + 1,
+                             (first ? 2 : 1) + ((dataSizeBytes == 0) ? 1 : 0),
+                             !first);
+        first = false;
+    } while (dataSizeBytes > 0);
+}
+
 // Create a socket entry in the list.
 static uCellSockSocket_t *pSockCreate(int32_t sockHandle,
                                       uDeviceHandle_t cellHandle,
@@ -1245,9 +1281,7 @@ int32_t uCellSockSendTo(uDeviceHandle_t cellHandle,
     char *pRemoteIpAddress;
     size_t dataLengthMax = U_CELL_SOCK_MAX_SEGMENT_SIZE_BYTES;
     int32_t sentSize = 0;
-    size_t x;
     bool written = false;
-    char *pHexBuffer = NULL;
 
     // Find the instance
     pInstance = pUCellPrivateGetInstance(cellHandle);
@@ -1267,62 +1301,50 @@ int32_t uCellSockSendTo(uDeviceHandle_t cellHandle,
                     if (pRemoteIpAddress != NULL) {
                         negErrnoLocalOrSize = -U_SOCK_EMSGSIZE;
                         if (dataSizeBytes <= dataLengthMax) {
+                            negErrnoLocalOrSize = -U_SOCK_EIO;
+                            uAtClientLock(atHandle);
+                            uAtClientCommandStart(atHandle, "AT+USOST=");
+                            // Write module socket handle
+                            uAtClientWriteInt(atHandle, pSocket->sockHandleModule);
+                            // Write IP address
+                            uAtClientWriteString(atHandle, pRemoteIpAddress, true);
+                            // Write port number
+                            uAtClientWriteInt(atHandle, pRemoteAddress->port);
+                            // Number of bytes to follow
+                            uAtClientWriteInt(atHandle, (int32_t) dataSizeBytes);
                             if (pInstance->socketsHexMode) {
-                                negErrnoLocalOrSize = -U_SOCK_ENOMEM;
-                                pHexBuffer = (char *) pUPortMalloc(dataSizeBytes * 2 + 1);  // +1 for terminator
-                                if (pHexBuffer != NULL) {
-                                    // Make the hex-coded null terminated string
-                                    x = uBinToHex((const char *) pData, dataSizeBytes, pHexBuffer);
-                                    *(pHexBuffer + x) = 0;
-                                }
-                            }
-                            if (!pInstance->socketsHexMode || (pHexBuffer != NULL)) {
-                                negErrnoLocalOrSize = -U_SOCK_EIO;
-                                uAtClientLock(atHandle);
-                                uAtClientCommandStart(atHandle, "AT+USOST=");
-                                // Write module socket handle
-                                uAtClientWriteInt(atHandle, pSocket->sockHandleModule);
-                                // Write IP address
-                                uAtClientWriteString(atHandle, pRemoteIpAddress, true);
-                                // Write port number
-                                uAtClientWriteInt(atHandle, pRemoteAddress->port);
-                                // Number of bytes to follow
-                                uAtClientWriteInt(atHandle, (int32_t) dataSizeBytes);
-                                if (pHexBuffer) {
-                                    // Send the hex mode data as a string
-                                    uAtClientWriteString(atHandle, pHexBuffer, true);
-                                    uAtClientCommandStop(atHandle);
-                                    // Free the buffer
-                                    uPortFree(pHexBuffer);
+                                // Send the hex mode data as a quoted string
+                                writeHexQuoted(atHandle, (const char *) pData,
+                                               dataSizeBytes);
+                                uAtClientCommandStop(atHandle);
+                                written = true;
+                            } else {
+                                // Not in hex mode, wait for the prompt
+                                uAtClientCommandStop(atHandle);
+                                if (uAtClientWaitCharacter(atHandle, '@') == 0) {
+                                    // Wait for it...
+                                    uPortTaskBlock(50);
+                                    // Send the binary data
+                                    uAtClientWriteBytes(atHandle, (const char *) pData,
+                                                        dataSizeBytes, true);
                                     written = true;
-                                } else {
-                                    // Not in hex mode, wait for the prompt
-                                    uAtClientCommandStop(atHandle);
-                                    if (uAtClientWaitCharacter(atHandle, '@') == 0) {
-                                        // Wait for it...
-                                        uPortTaskBlock(50);
-                                        // Send the binary data
-                                        uAtClientWriteBytes(atHandle, (const char *) pData,
-                                                            dataSizeBytes, true);
-                                        written = true;
-                                    }
                                 }
-                                if (written) {
-                                    // Grab the response
-                                    uAtClientResponseStart(atHandle, "+USOST:");
-                                    // Skip the socket ID
-                                    uAtClientSkipParameters(atHandle, 1);
-                                    // Bytes sent
-                                    sentSize = uAtClientReadInt(atHandle);
-                                    uAtClientResponseStop(atHandle);
-                                    if ((uAtClientUnlock(atHandle) == 0) &&
-                                        (sentSize >= 0)) {
-                                        // All is good, probably
-                                        negErrnoLocalOrSize = sentSize;
-                                    }
-                                } else {
-                                    uAtClientUnlock(atHandle);
+                            }
+                            if (written) {
+                                // Grab the response
+                                uAtClientResponseStart(atHandle, "+USOST:");
+                                // Skip the socket ID
+                                uAtClientSkipParameters(atHandle, 1);
+                                // Bytes sent
+                                sentSize = uAtClientReadInt(atHandle);
+                                uAtClientResponseStop(atHandle);
+                                if ((uAtClientUnlock(atHandle) == 0) &&
+                                    (sentSize >= 0)) {
+                                    // All is good, probably
+                                    negErrnoLocalOrSize = sentSize;
                                 }
+                            } else {
+                                uAtClientUnlock(atHandle);
                             }
                         }
                     }
@@ -1546,7 +1568,6 @@ int32_t uCellSockWrite(uDeviceHandle_t cellHandle,
     int32_t thisSendSize = U_CELL_SOCK_MAX_SEGMENT_SIZE_BYTES;
     size_t x = 0;
     bool written = true;
-    char *pHexBuffer = NULL;
 
     // Find the instance
     pInstance = pUCellPrivateGetInstance(cellHandle);
@@ -1554,107 +1575,97 @@ int32_t uCellSockWrite(uDeviceHandle_t cellHandle,
         atHandle = pInstance->atHandle;
         if (pInstance->socketsHexMode) {
             thisSendSize /= 2;
-            negErrnoLocalOrSize = -U_SOCK_ENOMEM;
-            pHexBuffer = (char *)pUPortMalloc(thisSendSize * 2 + 1); // +1 for terminator
         }
         // Find the entry
         if (sockHandle >= 0) {
             pSocket = pFindBySockHandle(sockHandle);
             if (pSocket != NULL) {
-                if (!pInstance->socketsHexMode || (pHexBuffer != NULL)) {
-                    negErrnoLocalOrSize = U_SOCK_ENONE;
-                    x = 0;
-                    while ((leftToSendSize > 0) &&
-                           (negErrnoLocalOrSize == U_SOCK_ENONE) &&
-                           (x < U_CELL_SOCK_TCP_RETRY_LIMIT) &&
-                           written) {
-                        if (leftToSendSize < thisSendSize) {
-                            thisSendSize = leftToSendSize;
-                        }
-                        uAtClientLock(atHandle);
-                        uAtClientCommandStart(atHandle, "AT+USOWR=");
-                        // Write module socket handle
-                        uAtClientWriteInt(atHandle, pSocket->sockHandleModule);
-                        // Number of bytes to follow
-                        uAtClientWriteInt(atHandle, (int32_t) thisSendSize);
-                        written = false;
-                        if (pHexBuffer) {
-                            // Make the hex-coded null terminated string
-                            uBinToHex((const char *) pData + dataOffset,
-                                      thisSendSize, pHexBuffer);
-                            pHexBuffer[thisSendSize * 2] = 0;
-                            // Send the hex mode data as a string
-                            //lint -e(679) Suppress suspicious truncation
-                            uAtClientWriteString(atHandle, pHexBuffer, true);
-                            uAtClientCommandStop(atHandle);
+                negErrnoLocalOrSize = U_SOCK_ENONE;
+                x = 0;
+                while ((leftToSendSize > 0) &&
+                       (negErrnoLocalOrSize == U_SOCK_ENONE) &&
+                       (x < U_CELL_SOCK_TCP_RETRY_LIMIT) &&
+                       written) {
+                    if (leftToSendSize < thisSendSize) {
+                        thisSendSize = leftToSendSize;
+                    }
+                    uAtClientLock(atHandle);
+                    uAtClientCommandStart(atHandle, "AT+USOWR=");
+                    // Write module socket handle
+                    uAtClientWriteInt(atHandle, pSocket->sockHandleModule);
+                    // Number of bytes to follow
+                    uAtClientWriteInt(atHandle, (int32_t) thisSendSize);
+                    written = false;
+                    if (pInstance->socketsHexMode) {
+                        // Send the hex mode data as a quoted string
+                        writeHexQuoted(atHandle, (const char *) pData + dataOffset,
+                                       thisSendSize);
+                        uAtClientCommandStop(atHandle);
+                        written = true;
+                    } else {
+                        uAtClientCommandStop(atHandle);
+                        // Wait for the prompt
+                        if (uAtClientWaitCharacter(atHandle, '@') == 0) {
+                            // Wait for it...
+                            uPortTaskBlock(50);
+                            // Go!
+                            uAtClientWriteBytes(atHandle,
+                                                (const char *) pData + dataOffset,
+                                                thisSendSize, true);
                             written = true;
+                        }
+                    }
+                    if (written) {
+                        // Grab the response
+                        if ((pInstance->pModule->moduleType != U_CELL_MODULE_TYPE_LENA_R8) ||
+                            (pSocket->protocol != U_SOCK_PROTOCOL_UDP)) {
+                            uAtClientResponseStart(atHandle, "+USOWR:");
                         } else {
-                            uAtClientCommandStop(atHandle);
-                            // Wait for the prompt
-                            if (uAtClientWaitCharacter(atHandle, '@') == 0) {
-                                // Wait for it...
-                                uPortTaskBlock(50);
-                                // Go!
-                                uAtClientWriteBytes(atHandle,
-                                                    (const char *) pData + dataOffset,
-                                                    thisSendSize, true);
-                                written = true;
-                            }
+                            // Just to keep us on our toes, LENA-R8 prefixes
+                            // the information response for a socket-write to
+                            // a UDP socket with +USOST instead of +USOWR
+                            uAtClientResponseStart(atHandle, "+USOST:");
                         }
-                        if (written) {
-                            // Grab the response
-                            if ((pInstance->pModule->moduleType != U_CELL_MODULE_TYPE_LENA_R8) ||
-                                (pSocket->protocol != U_SOCK_PROTOCOL_UDP)) {
-                                uAtClientResponseStart(atHandle, "+USOWR:");
-                            } else {
-                                // Just to keep us on our toes, LENA-R8 prefixes
-                                // the information response for a socket-write to
-                                // a UDP socket with +USOST instead of +USOWR
-                                uAtClientResponseStart(atHandle, "+USOST:");
-                            }
-                            // Skip the socket ID
-                            uAtClientSkipParameters(atHandle, 1);
-                            // Bytes sent
-                            sentSize = uAtClientReadInt(atHandle);
-                            uAtClientResponseStop(atHandle);
-                            // Note: the sentSize check below is because we have seen cases
-                            // where the module returns just "OK", missing out the "+USOWR: x"
-                            // response; what to do when this happens?  The AT unlock check
-                            // will pass because it has been sent an "OK", but has the data
-                            // been sent or was the OK for a previous "AT" and we have somehow
-                            // or other become unsynchronised with the module? Gonna assume
-                            // the worst, that the data has not been sent.
-                            if (sentSize < 0) {
-                                sentSize = 0;
-                            }
-                            if (uAtClientUnlock(atHandle) == 0) {
-                                dataOffset += sentSize;
-                                leftToSendSize -= sentSize;
-                                // Technically, it should be OK to
-                                // send fewer bytes than asked for,
-                                // however if this happens a lot we'll
-                                // get stuck, which isn't desirable,
-                                // so use the loop counter to avoid that
-                                if (sentSize < thisSendSize) {
-                                    x++;
-                                }
-                            } else {
-                                negErrnoLocalOrSize = -U_SOCK_EIO;
-                                // Got an AT interface error, see
-                                // what the module's socket error
-                                // number has to say for debug purposes
-                                doUsoer(atHandle);
+                        // Skip the socket ID
+                        uAtClientSkipParameters(atHandle, 1);
+                        // Bytes sent
+                        sentSize = uAtClientReadInt(atHandle);
+                        uAtClientResponseStop(atHandle);
+                        // Note: the sentSize check below is because we have seen cases
+                        // where the module returns just "OK", missing out the "+USOWR: x"
+                        // response; what to do when this happens?  The AT unlock check
+                        // will pass because it has been sent an "OK", but has the data
+                        // been sent or was the OK for a previous "AT" and we have somehow
+                        // or other become unsynchronised with the module? Gonna assume
+                        // the worst, that the data has not been sent.
+                        if (sentSize < 0) {
+                            sentSize = 0;
+                        }
+                        if (uAtClientUnlock(atHandle) == 0) {
+                            dataOffset += sentSize;
+                            leftToSendSize -= sentSize;
+                            // Technically, it should be OK to
+                            // send fewer bytes than asked for,
+                            // however if this happens a lot we'll
+                            // get stuck, which isn't desirable,
+                            // so use the loop counter to avoid that
+                            if (sentSize < thisSendSize) {
+                                x++;
                             }
                         } else {
                             negErrnoLocalOrSize = -U_SOCK_EIO;
-                            uAtClientUnlock(atHandle);
+                            // Got an AT interface error, see
+                            // what the module's socket error
+                            // number has to say for debug purposes
+                            doUsoer(atHandle);
                         }
+                    } else {
+                        negErrnoLocalOrSize = -U_SOCK_EIO;
+                        uAtClientUnlock(atHandle);
                     }
                 }
             }
         }
-        // Free the buffer
-        uPortFree(pHexBuffer);
     }
 
     if (negErrnoLocalOrSize == U_SOCK_ENONE) {
@@ -0,0 +1,267 @@
+/*
+ * Copyright 2019-2023 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Implementation of the encode/decode functions for the
+ * cellular module state snapshot.  These functions are called by the
+ * u_cell_cfg.h API functions, they are not intended for use externally.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memcpy(), memset(), strlen()
+
+#include "u_cfg_sw.h"
+#include "u_error_common.h"
+
+#include "u_port_os.h"     // Required by u_cell_private.h
+
+#include "u_at_client.h"
+
+#include "u_cell_module_type.h"
+#include "u_cell_file.h"
+#include "u_cell.h"         // Order is
+#include "u_cell_net.h"     // important here
+#include "u_cell_private.h" // don't change it
+
+#include "u_cell_state_private.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** All of the bits that may legitimately be set in the validBitMap
+ * field of #uCellPrivateState_t.
+ */
+#define U_CELL_STATE_PRIVATE_VALID_BIT_MAP_ALL (U_CELL_PRIVATE_STATE_IMEI             | \
+                                                U_CELL_PRIVATE_STATE_FIRMWARE_VERSION | \
+                                                U_CELL_PRIVATE_STATE_MNO_PROFILE      | \
+                                                U_CELL_PRIVATE_STATE_GNSS_PROFILE     | \
+                                                U_CELL_PRIVATE_STATE_RAT              | \
+                                                U_CELL_PRIVATE_STATE_BAND_MASK)
+
+/** The length of the CRC on the end of a snapshot.
+ */
+#define U_CELL_STATE_PRIVATE_CRC_LENGTH_BYTES 4
+
+/** The (reflected) polynomial of the CRC32 on the end of a snapshot,
+ * that of IEEE 802.3.
+ */
+#define U_CELL_STATE_PRIVATE_CRC_POLYNOMIAL 0xEDB88320UL
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Write a little-endian number of the given length.
+static uint8_t *writeLittleEndian(uint8_t *pOutput, uint64_t value,
+                                  size_t length)
+{
+    for (size_t x = 0; x < length; x++) {
+        *pOutput = (uint8_t) (value >> (x * 8));
+        pOutput++;
+    }
+
+    return pOutput;
+}
+
+// Read a little-endian number of the given length.
+static uint64_t readLittleEndian(const uint8_t *pInput, size_t length)
+{
+    uint64_t value = 0;
+
+    for (size_t x = 0; x < length; x++) {
+        value |= ((uint64_t) *pInput) << (x * 8);
+        pInput++;
+    }
+
+    return value;
+}
+
+// Compute the CRC32 of a snapshot; done a bit at a time rather than
+// with a table since a snapshot is small and is only checked at
+// start-up.
+static uint32_t crc32(const char *pBuffer, size_t size)
+{
+    uint32_t crc = 0xFFFFFFFFUL;
+
+    for (size_t x = 0; x < size; x++) {
+        crc ^= (uint8_t) *pBuffer;
+        pBuffer++;
+        for (size_t y = 0; y < 8; y++) {
+            crc = (crc >> 1) ^ ((crc & 1) ? U_CELL_STATE_PRIVATE_CRC_POLYNOMIAL : 0);
+        }
+    }
+
+    return ~crc;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Encode a cellular module state.
+int32_t uCellStatePrivateEncode(const uCellPrivateState_t *pState,
+                                char *pBuffer, size_t size)
+{
+    int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uint8_t *pOutput = (uint8_t *) pBuffer;
+    size_t firmwareVersionLength = 0;
+    size_t bandMaskRawCount;
+    size_t length;
+
+    if ((pState != NULL) && (pBuffer != NULL)) {
+        // Not using strlen() here as firmwareVersion might not
+        // be terminated if it is not valid
+        while ((firmwareVersionLength < sizeof(pState->firmwareVersion) - 1) &&
+               (pState->firmwareVersion[firmwareVersionLength] != 0)) {
+            firmwareVersionLength++;
+        }
+        bandMaskRawCount = pState->bandMaskRawCount;
+        if (bandMaskRawCount > sizeof(pState->bandMaskRaw) / sizeof(pState->bandMaskRaw[0])) {
+            bandMaskRawCount = sizeof(pState->bandMaskRaw) / sizeof(pState->bandMaskRaw[0]);
+        }
+        length = 2 + 1 + 1 + sizeof(pState->imei) + 1 + firmwareVersionLength +
+                 4 + 4 + 1 + sizeof(pState->rat) + 1 + (bandMaskRawCount * 8) +
+                 U_CELL_STATE_PRIVATE_CRC_LENGTH_BYTES;
+        errorCodeOrSize = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        if (size >= length) {
+            pOutput = writeLittleEndian(pOutput, U_CELL_STATE_PRIVATE_MAGIC, 2);
+            *pOutput = U_CELL_STATE_PRIVATE_VERSION;
+            pOutput++;
+            *pOutput = pState->validBitMap & U_CELL_STATE_PRIVATE_VALID_BIT_MAP_ALL;
+            pOutput++;
+            memcpy(pOutput, pState->imei, sizeof(pState->imei));
+            pOutput += sizeof(pState->imei);
+            *pOutput = (uint8_t) firmwareVersionLength;
+            pOutput++;
+            memcpy(pOutput, pState->firmwareVersion, firmwareVersionLength);
+            pOutput += firmwareVersionLength;
+            pOutput = writeLittleEndian(pOutput, (uint32_t) pState->mnoProfile, 4);
+            pOutput = writeLittleEndian(pOutput, (uint32_t) pState->gnssProfileBitMap, 4);
+            *pOutput = (uint8_t) sizeof(pState->rat);
+            pOutput++;
+            for (size_t x = 0; x < sizeof(pState->rat); x++) {
+                *pOutput = (uint8_t) pState->rat[x];
+                pOutput++;
+            }
+            *pOutput = (uint8_t) bandMaskRawCount;
+            pOutput++;
+            for (size_t x = 0; x < bandMaskRawCount; x++) {
+                pOutput = writeLittleEndian(pOutput, pState->bandMaskRaw[x], 8);
+            }
+            pOutput = writeLittleEndian(pOutput,
+                                        crc32(pBuffer, ((char *) pOutput) - pBuffer),
+                                        U_CELL_STATE_PRIVATE_CRC_LENGTH_BYTES);
+            errorCodeOrSize = ((char *) pOutput) - pBuffer;
+        }
+    }
+
+    return errorCodeOrSize;
+}
+
+// Decode a cellular module state.
+int32_t uCellStatePrivateDecode(const char *pBuffer, size_t size,
+                                uCellPrivateState_t *pState)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    const uint8_t *pInput = (const uint8_t *) pBuffer;
+    const uint8_t *pEnd;
+    uCellPrivateState_t state;
+    size_t length;
+
+    if ((pBuffer != NULL) && (pState != NULL)) {
+        errorCode = (int32_t) U_ERROR_COMMON_BAD_DATA;
+        memset(&state, 0, sizeof(state));
+        // Everything up to and including the firmware version
+        // length must be present, plus the CRC
+        if ((size >= 2 + 1 + 1 + sizeof(state.imei) + 1 + U_CELL_STATE_PRIVATE_CRC_LENGTH_BYTES) &&
+            (readLittleEndian(pInput, 2) == U_CELL_STATE_PRIVATE_MAGIC)) {
+            pEnd = pInput + size - U_CELL_STATE_PRIVATE_CRC_LENGTH_BYTES;
+            pInput += 2;
+            if (*pInput != U_CELL_STATE_PRIVATE_VERSION) {
+                errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            } else if (readLittleEndian(pEnd, U_CELL_STATE_PRIVATE_CRC_LENGTH_BYTES) ==
+                       crc32(pBuffer, ((const char *) pEnd) - pBuffer)) {
+                pInput++;
+                state.validBitMap = *pInput;
+                pInput++;
+                memcpy(state.imei, pInput, sizeof(state.imei));
+                pInput += sizeof(state.imei);
+                length = *pInput;
+                pInput++;
+                // From here on check that each thing fits before reading it
+                if ((length < sizeof(state.firmwareVersion)) &&
+                    (pInput + length + 4 + 4 + 1 <= pEnd)) {
+                    memcpy(state.firmwareVersion, pInput, length);
+                    pInput += length;
+                    state.mnoProfile = (int32_t) (uint32_t) readLittleEndian(pInput, 4);
+                    pInput += 4;
+                    state.gnssProfileBitMap = (int32_t) (uint32_t) readLittleEndian(pInput, 4);
+                    pInput += 4;
+                    length = *pInput;
+                    pInput++;
+                    if ((length <= sizeof(state.rat)) && (pInput + length + 1 <= pEnd)) {
+                        for (size_t x = 0; x < sizeof(state.rat); x++) {
+                            state.rat[x] = (int8_t) U_CELL_NET_RAT_UNKNOWN_OR_NOT_USED;
+                            if (x < length) {
+                                state.rat[x] = (int8_t) *pInput;
+                                pInput++;
+                            }
+                        }
+                        length = *pInput;
+                        pInput++;
+                        // The snapshot must end exactly where the band masks do
+                        if ((length <= sizeof(state.bandMaskRaw) / sizeof(state.bandMaskRaw[0])) &&
+                            (pInput + (length * 8) == pEnd) &&
+                            ((state.validBitMap & ~U_CELL_STATE_PRIVATE_VALID_BIT_MAP_ALL) == 0)) {
+                            state.bandMaskRawCount = length;
+                            for (size_t x = 0; x < length; x++) {
+                                state.bandMaskRaw[x] = readLittleEndian(pInput, 8);
+                                pInput += 8;
+                            }
+                            *pState = state;
+                            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// End of file
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2019-2023 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_CELL_STATE_PRIVATE_H_
+#define _U_CELL_STATE_PRIVATE_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** @file
+ * @brief This header file defines functions that encode and decode
+ * the cached state of a cellular module, #uCellPrivateState_t, to
+ * and from the compact binary snapshot that is handed to the
+ * application by uCellCfgGetStateSnapshot() and handed back to
+ * us with uCellCfgSetStateSnapshot().  These functions are called
+ * only inside cellular, they are not intended for external use.
+ *
+ * The snapshot is little-endian and is laid out as follows:
+ *
+ * - 2 bytes: #U_CELL_STATE_PRIVATE_MAGIC,
+ * - 1 byte: #U_CELL_STATE_PRIVATE_VERSION,
+ * - 1 byte: the validBitMap field of #uCellPrivateState_t,
+ * - 15 bytes: the IMEI,
+ * - 1 byte: the length of the firmware version string, N,
+ * - N bytes: the firmware version string, no terminator,
+ * - 4 bytes: the MNO profile,
+ * - 4 bytes: the GNSS profile bit-map,
+ * - 1 byte: the number of RATs, R,
+ * - R bytes: the RATs, in rank order,
+ * - 1 byte: the number of raw band mask numbers, B,
+ * - B * 8 bytes: the raw band mask numbers,
+ * - 4 bytes: CRC32 (IEEE 802.3) of all that precedes it.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The magic number at the start of an encoded state snapshot,
+ * "uS" in ASCII.
+ */
+#define U_CELL_STATE_PRIVATE_MAGIC 0x5375
+
+/** The version of the encoded state snapshot; increment this
+ * if the layout or the meaning of any of the contents changes,
+ * a snapshot of a different version will be rejected.
+ */
+#define U_CELL_STATE_PRIVATE_VERSION 2
+
+/** The maximum length of an encoded state snapshot.
+ */
+#define U_CELL_STATE_PRIVATE_ENCODED_MAX_LENGTH_BYTES (2 + 1 + 1 +                                                \
+                                                       U_CELL_PRIVATE_STATE_IMEI_LENGTH_BYTES +                   \
+                                                       1 + U_CELL_PRIVATE_STATE_FIRMWARE_VERSION_MAX_LENGTH_BYTES \
+                                                       - 1 + 4 + 4 +                                              \
+                                                       1 + U_CELL_PRIVATE_MAX_NUM_SIMULTANEOUS_RATS +             \
+                                                       1 + (U_CELL_PRIVATE_STATE_BAND_MASK_RAW_MAX_NUM * 8) +     \
+                                                       4)
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Encode a cellular module state into a snapshot.
+ *
+ * @param[in] pState  the state to encode; cannot be NULL.
+ * @param[out] pBuffer a place to put the encoded snapshot; cannot
+ *                    be NULL.
+ * @param size        the amount of storage at pBuffer;
+ *                    #U_CELL_STATE_PRIVATE_ENCODED_MAX_LENGTH_BYTES
+ *                    will always be sufficient.
+ * @return            on success the number of bytes written to
+ *                    pBuffer, else negative error code.
+ */
+int32_t uCellStatePrivateEncode(const uCellPrivateState_t *pState,
+                                char *pBuffer, size_t size);
+
+/** Decode a snapshot into a cellular module state, checking
+ * the magic number, version, length and CRC as it goes.
+ *
+ * @param[in] pBuffer the snapshot; cannot be NULL.
+ * @param size        the number of bytes at pBuffer, which must be
+ *                    exactly the length of the snapshot.
+ * @param[out] pState a place to put the decoded state; cannot be
+ *                    NULL.  The contents will only be changed on
+ *                    success.
+ * @return            zero on success else negative error code:
+ *                    #U_ERROR_COMMON_NOT_SUPPORTED if the snapshot
+ *                    is of a different version,
+ *                    #U_ERROR_COMMON_BAD_DATA if it is otherwise
+ *                    invalid.
+ */
+int32_t uCellStatePrivateDecode(const char *pBuffer, size_t size,
+                                uCellPrivateState_t *pState);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _U_CELL_STATE_PRIVATE_H_
+
+// End of file
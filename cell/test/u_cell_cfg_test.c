@@ -39,7 +39,7 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
-#include "string.h"    // memset()
+#include "string.h"    // memset(), memcmp()
 
 #include "u_cfg_sw.h"
 #include "u_cfg_os_platform_specific.h"
@@ -1190,6 +1190,63 @@ U_PORT_TEST_FUNCTION("[cellCfg]", "cellCfgTime")
     U_PORT_TEST_ASSERT(resourceCount <= 0);
 }
 
+/** Test getting and setting a state snapshot.
+ */
+U_PORT_TEST_FUNCTION("[cellCfg]", "cellCfgStateSnapshot")
+{
+    uDeviceHandle_t cellHandle;
+    char snapshot[U_CELL_CFG_STATE_SNAPSHOT_MAX_LENGTH_BYTES];
+    char buffer[U_CELL_CFG_STATE_SNAPSHOT_MAX_LENGTH_BYTES];
+    int32_t length;
+    int32_t mnoProfile;
+    int32_t resourceCount;
+
+    // In case a previous test failed
+    uCellTestPrivateCleanup(&gHandles);
+
+    // Obtain the initial resource count
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    // Do the standard preamble
+    U_PORT_TEST_ASSERT(uCellTestPrivatePreamble(U_CFG_TEST_CELL_MODULE_TYPE,
+                                                &gHandles, true) == 0);
+    cellHandle = gHandles.cellHandle;
+
+    U_TEST_PRINT_LINE("getting state snapshot...");
+    U_PORT_TEST_ASSERT(uCellCfgGetStateSnapshot(cellHandle, NULL, sizeof(snapshot)) < 0);
+    U_PORT_TEST_ASSERT(uCellCfgGetStateSnapshot(cellHandle, snapshot, 1) < 0);
+    length = uCellCfgGetStateSnapshot(cellHandle, snapshot, sizeof(snapshot));
+    U_TEST_PRINT_LINE("state snapshot is %d byte(s).", length);
+    U_PORT_TEST_ASSERT(length > 0);
+    U_PORT_TEST_ASSERT(length <= (int32_t) sizeof(snapshot));
+    mnoProfile = uCellCfgGetMnoProfile(cellHandle);
+
+    // A corrupt snapshot should be rejected
+    memcpy(buffer, snapshot, length);
+    buffer[length - 1] ^= 0xFF;
+    U_PORT_TEST_ASSERT(uCellCfgSetStateSnapshot(cellHandle, buffer, length) < 0);
+    U_PORT_TEST_ASSERT(uCellCfgSetStateSnapshot(cellHandle, snapshot, length - 1) < 0);
+
+    // Hand the real one back, reboot and it should be applied
+    U_PORT_TEST_ASSERT(uCellCfgSetStateSnapshot(cellHandle, snapshot, length) == 0);
+    U_TEST_PRINT_LINE("rebooting cellular...");
+    U_PORT_TEST_ASSERT(uCellPwrReboot(cellHandle, NULL) == 0);
+    U_PORT_TEST_ASSERT(uCellCfgGetMnoProfile(cellHandle) == mnoProfile);
+    memset(buffer, 0, sizeof(buffer));
+    U_PORT_TEST_ASSERT(uCellCfgGetStateSnapshot(cellHandle, buffer, sizeof(buffer)) == length);
+    U_PORT_TEST_ASSERT(memcmp(buffer, snapshot, length) == 0);
+
+    // Do the standard postamble, leaving the module on for the next
+    // test to speed things up
+    uCellTestPrivatePostamble(&gHandles, false);
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
 /** Clean-up to be run at the end of this round of tests, just
  * in case there were test failures which would have resulted
  * in the deinitialisation being skipped.
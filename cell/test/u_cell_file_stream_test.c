@@ -0,0 +1,510 @@
+/*
+ * Copyright 2019-2023 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Tests for the streaming functions of the cellular file system
+ * API.  No cellular module is used in this set of tests: the file
+ * system of the module is simulated on the other end of a pair of
+ * UARTs (U_CFG_TEST_UART_A and U_CFG_TEST_UART_B) that are connected
+ * together.
+ * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
+ * naming rules that must be followed when using the U_PORT_TEST_FUNCTION()
+ * macro.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stdlib.h"    // strtol()
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "stdio.h"     // snprintf()
+#include "string.h"    // memset(), memcpy(), strncmp()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port_clib_platform_specific.h" /* Integer stdio, must be included
+                                              before the other port files if
+                                              any print or scan function is used. */
+#include "u_port.h"
+#include "u_port_debug.h"
+#include "u_port_os.h"
+#include "u_port_heap.h"
+
+#include "u_test_util_resource_check.h"
+
+#include "u_at_client.h"
+
+#include "u_cell_module_type.h"
+#include "u_cell.h"
+#include "u_cell_file.h"
+#include "u_cell_net.h"     // Required by u_cell_test_private.h
+
+#include "u_cell_test_private.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_CELL_FILE_STREAM_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+/** The name of the file in the simulated file system.
+ */
+#define U_CELL_FILE_STREAM_TEST_FILE_NAME "stream"
+
+#ifndef U_CELL_FILE_STREAM_TEST_FILE_LENGTH_BYTES
+/** The size of the file in the simulated file system.
+ */
+# define U_CELL_FILE_STREAM_TEST_FILE_LENGTH_BYTES (1024 * 16)
+#endif
+
+#ifndef U_CELL_FILE_STREAM_TEST_BLOCK_READ_LENGTH_BYTES
+/** The size of block to read with uCellFileBlockRead() when
+ * measuring its throughput for comparison.
+ */
+# define U_CELL_FILE_STREAM_TEST_BLOCK_READ_LENGTH_BYTES 512
+#endif
+
+/** The size of the UART buffer on the cellular side: this is made
+ * large enough to hold a whole file, so that a response from the
+ * simulated file system can never be held up by a full receive
+ * buffer, since a UART write that is blocked by flow control may
+ * also hold up the UART read on some platforms.
+ */
+#define U_CELL_FILE_STREAM_TEST_UART_BUFFER_LENGTH_BYTES (U_CELL_FILE_STREAM_TEST_FILE_LENGTH_BYTES + \
+                                                          U_CELL_UART_BUFFER_LENGTH_BYTES)
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The state of the simulated file system.
+ */
+typedef struct {
+    char *pFile;               /**< U_CELL_FILE_STREAM_TEST_FILE_LENGTH_BYTES long. */
+    size_t fileLength;
+    size_t numCommands;
+} uCellFileStreamTestModule_t;
+
+/** Context for the callbacks.
+ */
+typedef struct {
+    size_t offset;
+    size_t bytesToStop;        /**< stop after this many bytes, zero
+                                    for never. */
+    size_t count;
+    size_t maxChunkLength;
+    bool error;
+} uCellFileStreamTestContext_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The simulated module.
+ */
+static uCellTestPrivateSim_t gSim = U_CELL_TEST_PRIVATE_SIM_DEFAULTS;
+
+/** The file system of the simulated module.
+ */
+static uCellFileStreamTestModule_t gModule = {0};
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+
+// The byte that should be at the given offset in the file.
+static char patternByte(size_t offset)
+{
+    return (char) ((offset * 7) % 251);
+}
+
+// Check a command parameter against the file name and move past it,
+// returning NULL if it does not match.
+static const char *moduleCheckFileName(const char *pParam)
+{
+    const char *pName = "\"" U_CELL_FILE_STREAM_TEST_FILE_NAME "\"";
+
+    if (strncmp(pParam, pName, strlen(pName)) == 0) {
+        pParam += strlen(pName);
+    } else {
+        pParam = NULL;
+    }
+
+    return pParam;
+}
+
+// Send a +URDBLOCK or +URDFILE response.
+static void moduleSendRead(const char *pPrefix, size_t offset, size_t length)
+{
+    char buffer[64];
+    int32_t x;
+
+    if (offset > gModule.fileLength) {
+        offset = gModule.fileLength;
+    }
+    if (length > gModule.fileLength - offset) {
+        length = gModule.fileLength - offset;
+    }
+    x = snprintf(buffer, sizeof(buffer), "\r\n%s \"%s\",%d,\"", pPrefix,
+                 U_CELL_FILE_STREAM_TEST_FILE_NAME, (int) length);
+    uCellTestPrivateSimSend(&gSim, buffer, x);
+    uCellTestPrivateSimSend(&gSim, gModule.pFile + offset, length);
+    uCellTestPrivateSimSendString(&gSim, "\"\r\n\r\nOK\r\n");
+}
+
+// Handle an AT command line received by the simulated module.
+static void moduleCommand(uCellTestPrivateSim_t *pSim, const char *pLine)
+{
+    char buffer[64];
+    const char *pParam;
+    char *pEnd;
+    int32_t x;
+    size_t offset;
+    size_t length;
+    bool ok = false;
+
+    gModule.numCommands++;
+    if (strncmp(pLine, "AT+ULSTFILE=2,", 14) == 0) {
+        // File size
+        if (moduleCheckFileName(pLine + 14) != NULL) {
+            x = snprintf(buffer, sizeof(buffer), "\r\n+ULSTFILE: %d\r\n\r\nOK\r\n",
+                         (int) gModule.fileLength);
+            uCellTestPrivateSimSend(pSim, buffer, x);
+            ok = true;
+        }
+    } else if (strncmp(pLine, "AT+URDBLOCK=", 12) == 0) {
+        // Block read, no tag allowed
+        pParam = moduleCheckFileName(pLine + 12);
+        if ((pParam != NULL) && (*pParam == ',')) {
+            offset = strtol(pParam + 1, &pEnd, 10);
+            if (*pEnd == ',') {
+                length = strtol(pEnd + 1, &pEnd, 10);
+                if ((*pEnd == 0) && (offset < gModule.fileLength)) {
+                    moduleSendRead("+URDBLOCK:", offset, length);
+                    ok = true;
+                }
+            }
+        }
+    } else if (strncmp(pLine, "AT+URDFILE=", 11) == 0) {
+        // Whole file read, tag allowed
+        if (moduleCheckFileName(pLine + 11) != NULL) {
+            moduleSendRead("+URDFILE:", 0, gModule.fileLength);
+            ok = true;
+        }
+    } else if (strncmp(pLine, "AT+UDWNFILE=", 12) == 0) {
+        // Write, tag allowed
+        pParam = moduleCheckFileName(pLine + 12);
+        if ((pParam != NULL) && (*pParam == ',')) {
+            length = strtol(pParam + 1, &pEnd, 10);
+            if ((length > 0) &&
+                (gModule.fileLength + length <= U_CELL_FILE_STREAM_TEST_FILE_LENGTH_BYTES)) {
+                pSim->rawLength = length;
+                uCellTestPrivateSimSendString(pSim, ">");
+                ok = true;
+            }
+        }
+    }
+    if (!ok) {
+        uCellTestPrivateSimSendString(pSim, "\r\nERROR\r\n");
+    }
+}
+
+// Handle the data of an AT+UDWNFILE received by the simulated module.
+static void moduleDownload(uCellTestPrivateSim_t *pSim, const char *pData,
+                           size_t length)
+{
+    memcpy(gModule.pFile + gModule.fileLength, pData, length);
+    gModule.fileLength += length;
+    if (pSim->rawLength == 0) {
+        uCellTestPrivateSimSendString(pSim, "\r\nOK\r\n");
+    }
+}
+
+// Read callback: checks the data against the pattern.
+static bool readCallback(uDeviceHandle_t cellHandle, const char *pData,
+                         size_t size, size_t offset, void *pCallbackParam)
+{
+    uCellFileStreamTestContext_t *pContext = (uCellFileStreamTestContext_t *) pCallbackParam;
+    bool keepGoing = true;
+
+    (void) cellHandle;
+
+    if (offset != pContext->offset) {
+        pContext->error = true;
+    }
+    for (size_t x = 0; x < size; x++) {
+        if (*(pData + x) != patternByte(offset + x)) {
+            pContext->error = true;
+        }
+    }
+    if (size > pContext->maxChunkLength) {
+        pContext->maxChunkLength = size;
+    }
+    pContext->offset += size;
+    pContext->count++;
+    if ((pContext->bytesToStop > 0) && (pContext->offset >= pContext->bytesToStop)) {
+        keepGoing = false;
+    }
+
+    return keepGoing;
+}
+
+// Write callback: provides data from the pattern.
+static int32_t writeCallback(uDeviceHandle_t cellHandle, char *pBuffer,
+                             size_t size, size_t offset, void *pCallbackParam)
+{
+    uCellFileStreamTestContext_t *pContext = (uCellFileStreamTestContext_t *) pCallbackParam;
+    int32_t sizeOrError = (int32_t) size;
+
+    (void) cellHandle;
+
+    if (offset != pContext->offset) {
+        pContext->error = true;
+    }
+    if ((pContext->bytesToStop > 0) && (offset >= pContext->bytesToStop)) {
+        sizeOrError = -1;
+    } else {
+        for (size_t x = 0; x < size; x++) {
+            *(pBuffer + x) = patternByte(offset + x);
+        }
+        pContext->offset += size;
+    }
+    pContext->count++;
+
+    return sizeOrError;
+}
+
+// Print the throughput of a transfer.
+static void printRate(const char *pName, size_t length, int32_t durationMs,
+                      size_t numCommands)
+{
+    if (durationMs <= 0) {
+        durationMs = 1;
+    }
+    U_TEST_PRINT_LINE("%s: %d byte(s) with %d AT command(s) in %d ms, %d KB/s.",
+                      pName, length, numCommands, durationMs,
+                      (int32_t) ((length * 1000) / ((size_t) durationMs * 1024)));
+}
+
+#endif // #if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+/** Read and write a file in the simulated file system with the
+ * streaming functions, comparing the throughput of reading with
+ * that of uCellFileBlockRead().
+ */
+U_PORT_TEST_FUNCTION("[cellFileStream]", "cellFileStreamBasic")
+{
+    uDeviceHandle_t cellHandle;
+    uCellFileStreamTestContext_t context;
+    char *pBuffer;
+    int32_t resourceCount;
+    int32_t startTimeMs;
+    int32_t x;
+    size_t offset;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+
+    // Obtain the initial resource count
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    memset(&gModule, 0, sizeof(gModule));
+    gModule.pFile = (char *) pUPortMalloc(U_CELL_FILE_STREAM_TEST_FILE_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(gModule.pFile != NULL);
+    for (size_t y = 0; y < U_CELL_FILE_STREAM_TEST_FILE_LENGTH_BYTES; y++) {
+        *(gModule.pFile + y) = patternByte(y);
+    }
+    gModule.fileLength = U_CELL_FILE_STREAM_TEST_FILE_LENGTH_BYTES;
+    pBuffer = (char *) pUPortMalloc(U_CELL_FILE_STREAM_TEST_BLOCK_READ_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(pBuffer != NULL);
+
+    U_PORT_TEST_ASSERT(uCellTestPrivateSimOpen(&gSim,
+                                               U_CELL_FILE_STREAM_TEST_UART_BUFFER_LENGTH_BYTES,
+                                               moduleCommand, moduleDownload) == 0);
+    cellHandle = gSim.cellHandle;
+
+    // First, for comparison, read the file with the block API
+    U_TEST_PRINT_LINE("reading %d byte file in %d byte blocks with uCellFileBlockRead()...",
+                      U_CELL_FILE_STREAM_TEST_FILE_LENGTH_BYTES,
+                      U_CELL_FILE_STREAM_TEST_BLOCK_READ_LENGTH_BYTES);
+    gModule.numCommands = 0;
+    startTimeMs = uPortGetTickTimeMs();
+    for (offset = 0; offset < U_CELL_FILE_STREAM_TEST_FILE_LENGTH_BYTES; offset += x) {
+        x = uCellFileBlockRead(cellHandle, U_CELL_FILE_STREAM_TEST_FILE_NAME, pBuffer, offset,
+                               U_CELL_FILE_STREAM_TEST_BLOCK_READ_LENGTH_BYTES);
+        U_PORT_TEST_ASSERT(x > 0);
+        for (int32_t y = 0; y < x; y++) {
+            U_PORT_TEST_ASSERT(*(pBuffer + y) == patternByte(offset + y));
+        }
+    }
+    printRate("uCellFileBlockRead()", offset, uPortGetTickTimeMs() - startTimeMs,
+              gModule.numCommands);
+    U_PORT_TEST_ASSERT(offset == U_CELL_FILE_STREAM_TEST_FILE_LENGTH_BYTES);
+
+    // Now read it with the streaming API, default read-ahead
+    U_TEST_PRINT_LINE("reading %d byte file with uCellFileReadStream()...",
+                      U_CELL_FILE_STREAM_TEST_FILE_LENGTH_BYTES);
+    memset(&context, 0, sizeof(context));
+    gModule.numCommands = 0;
+    startTimeMs = uPortGetTickTimeMs();
+    x = uCellFileReadStream(cellHandle, U_CELL_FILE_STREAM_TEST_FILE_NAME, 0, 0,
+                            readCallback, &context);
+    printRate("uCellFileReadStream()", context.offset, uPortGetTickTimeMs() - startTimeMs,
+              gModule.numCommands);
+    U_PORT_TEST_ASSERT(x == U_CELL_FILE_STREAM_TEST_FILE_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(context.offset == U_CELL_FILE_STREAM_TEST_FILE_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(context.maxChunkLength <= U_CELL_FILE_STREAM_CHUNK_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(!context.error);
+
+    // Read from an offset with a read-ahead that doesn't divide
+    // the file evenly
+    offset = 1001;
+    memset(&context, 0, sizeof(context));
+    context.offset = offset;
+    gModule.numCommands = 0;
+    x = uCellFileReadStream(cellHandle, U_CELL_FILE_STREAM_TEST_FILE_NAME, offset, 3000,
+                            readCallback, &context);
+    U_TEST_PRINT_LINE("read %d byte(s) from offset %d with %d AT command(s).",
+                      x, offset, gModule.numCommands);
+    U_PORT_TEST_ASSERT(x == U_CELL_FILE_STREAM_TEST_FILE_LENGTH_BYTES - offset);
+    U_PORT_TEST_ASSERT(context.offset == U_CELL_FILE_STREAM_TEST_FILE_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(!context.error);
+
+    // Stop part way through a block
+    memset(&context, 0, sizeof(context));
+    context.bytesToStop = U_CELL_FILE_STREAM_CHUNK_LENGTH_BYTES + 1;
+    x = uCellFileReadStream(cellHandle, U_CELL_FILE_STREAM_TEST_FILE_NAME, 0, 0,
+                            readCallback, &context);
+    U_TEST_PRINT_LINE("stopped after %d byte(s).", x);
+    U_PORT_TEST_ASSERT(x == (int32_t) context.offset);
+    U_PORT_TEST_ASSERT(x < U_CELL_FILE_STREAM_TEST_FILE_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(!context.error);
+    // Make sure that the AT interface is still in step
+    U_PORT_TEST_ASSERT(uCellFileSize(cellHandle,
+                                     U_CELL_FILE_STREAM_TEST_FILE_NAME) == U_CELL_FILE_STREAM_TEST_FILE_LENGTH_BYTES);
+
+    // With a tag, which means a whole file read
+    U_PORT_TEST_ASSERT(uCellFileSetTag(cellHandle, "USER") == 0);
+    offset = 10;
+    memset(&context, 0, sizeof(context));
+    context.offset = offset;
+    gModule.numCommands = 0;
+    x = uCellFileReadStream(cellHandle, U_CELL_FILE_STREAM_TEST_FILE_NAME, offset, 0,
+                            readCallback, &context);
+    U_TEST_PRINT_LINE("read %d byte(s) from offset %d with a tag with %d AT command(s).",
+                      x, offset, gModule.numCommands);
+    U_PORT_TEST_ASSERT(x == U_CELL_FILE_STREAM_TEST_FILE_LENGTH_BYTES - offset);
+    U_PORT_TEST_ASSERT(gModule.numCommands == 1);
+    U_PORT_TEST_ASSERT(!context.error);
+    U_PORT_TEST_ASSERT(uCellFileSetTag(cellHandle, NULL) == 0);
+
+    // Now write the file afresh with the streaming API
+    U_TEST_PRINT_LINE("writing %d byte file with uCellFileWriteStream()...",
+                      U_CELL_FILE_STREAM_TEST_FILE_LENGTH_BYTES);
+    gModule.fileLength = 0;
+    memset(gModule.pFile, 0, U_CELL_FILE_STREAM_TEST_FILE_LENGTH_BYTES);
+    memset(&context, 0, sizeof(context));
+    gModule.numCommands = 0;
+    startTimeMs = uPortGetTickTimeMs();
+    x = uCellFileWriteStream(cellHandle, U_CELL_FILE_STREAM_TEST_FILE_NAME,
+                             U_CELL_FILE_STREAM_TEST_FILE_LENGTH_BYTES, 0,
+                             writeCallback, &context);
+    printRate("uCellFileWriteStream()", gModule.fileLength,
+              uPortGetTickTimeMs() - startTimeMs, gModule.numCommands);
+    U_PORT_TEST_ASSERT(x == U_CELL_FILE_STREAM_TEST_FILE_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(gModule.fileLength == U_CELL_FILE_STREAM_TEST_FILE_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(!context.error);
+    for (size_t y = 0; y < U_CELL_FILE_STREAM_TEST_FILE_LENGTH_BYTES; y++) {
+        U_PORT_TEST_ASSERT(*(gModule.pFile + y) == patternByte(y));
+    }
+
+    // Write again but stop at a block boundary: nothing
+    // should be written after that
+    gModule.fileLength = 0;
+    memset(&context, 0, sizeof(context));
+    context.bytesToStop = 2000;
+    x = uCellFileWriteStream(cellHandle, U_CELL_FILE_STREAM_TEST_FILE_NAME,
+                             U_CELL_FILE_STREAM_TEST_FILE_LENGTH_BYTES, 1000,
+                             writeCallback, &context);
+    U_TEST_PRINT_LINE("write stopped with %d, %d byte(s) written.", x, gModule.fileLength);
+    U_PORT_TEST_ASSERT(x == (int32_t) U_ERROR_COMMON_CANCELLED);
+    U_PORT_TEST_ASSERT(gModule.fileLength == 2000);
+    U_PORT_TEST_ASSERT(!context.error);
+    // Make sure that the AT interface is still in step
+    U_PORT_TEST_ASSERT(uCellFileSize(cellHandle, U_CELL_FILE_STREAM_TEST_FILE_NAME) == 2000);
+
+    uCellTestPrivateSimClose(&gSim);
+
+    uPortFree(pBuffer);
+    uPortFree(gModule.pFile);
+    gModule.pFile = NULL;
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+#endif
+
+/** Clean-up to be run at the end of this round of tests, just
+ * in case there were test failures which would have resulted
+ * in the deinitialisation being skipped.
+ */
+U_PORT_TEST_FUNCTION("[cellFileStream]", "cellFileStreamCleanUp")
+{
+    uCellTestPrivateSimClose(&gSim);
+    uPortFree(gModule.pFile);
+    gModule.pFile = NULL;
+    uPortDeinit();
+    // Printed for information: asserting happens in the postamble
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+}
+
+// End of file
@@ -0,0 +1,328 @@
+/*
+ * Copyright 2019-2023 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Tests for the batch of configuration commands that is sent
+ * to a cellular module at power-on.  No cellular module is used in
+ * this set of tests: the module is simulated on the other end of a
+ * pair of UARTs (U_CFG_TEST_UART_A and U_CFG_TEST_UART_B) that are
+ * connected together.
+ * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
+ * naming rules that must be followed when using the U_PORT_TEST_FUNCTION()
+ * macro.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "stdio.h"     // snprintf()
+#include "string.h"    // memset(), strcmp(), strstr(), strncpy()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port_clib_platform_specific.h" /* Integer stdio, must be included
+                                              before the other port files if
+                                              any print or scan function is used. */
+#include "u_port.h"
+#include "u_port_debug.h"
+#include "u_port_os.h"
+
+#include "u_test_util_resource_check.h"
+
+#include "u_at_client.h"
+
+#include "u_cell_module_type.h"
+#include "u_cell.h"
+#include "u_cell_net.h"     // Required by u_cell_pwr.h
+#include "u_cell_pwr.h"
+
+#include "u_cell_test_private.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_CELL_PWR_CONFIG_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+/** The number of received lines that the simulated module keeps
+ * a record of.
+ */
+#define U_CELL_PWR_CONFIG_TEST_MAX_NUM_LINES 32
+
+/** The configuration command that the simulated module keeps in
+ * "non-volatile memory" and so can be read back.
+ */
+#define U_CELL_PWR_CONFIG_TEST_NV_COMMAND "+UDCONF=1,0"
+
+/** The configuration command that the simulated module rejects
+ * when it is concatenated with others, if told to.
+ */
+#define U_CELL_PWR_CONFIG_TEST_FUSSY_COMMAND "&C1"
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The state of the simulated module.
+ */
+typedef struct {
+    char log[U_CELL_PWR_CONFIG_TEST_MAX_NUM_LINES][U_CELL_TEST_PRIVATE_SIM_LINE_LENGTH_BYTES];
+    size_t numLines;        /**< the number of lines received, which
+                                 may be more than are in log[]. */
+    int32_t hexMode;        /**< the setting of AT+UDCONF=1. */
+    bool fussy;             /**< if true, any line which contains
+                                 U_CELL_PWR_CONFIG_TEST_FUSSY_COMMAND
+                                 along with other commands is rejected. */
+} uCellPwrConfigTestModule_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The simulated module.
+ */
+static uCellTestPrivateSim_t gSim = U_CELL_TEST_PRIVATE_SIM_DEFAULTS;
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+/** The state of the simulated module.
+ */
+static uCellPwrConfigTestModule_t gModule = {0};
+#endif
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+
+// Handle an AT command line received by the simulated module:
+// everything is OK except where noted.
+static void moduleCommand(uCellTestPrivateSim_t *pSim, const char *pLine)
+{
+    char buffer[64];
+
+    if (gModule.numLines < U_CELL_PWR_CONFIG_TEST_MAX_NUM_LINES) {
+        strncpy(gModule.log[gModule.numLines], pLine,
+                sizeof(gModule.log[gModule.numLines]) - 1);
+    }
+    gModule.numLines++;
+    if (gModule.fussy && (strstr(pLine, U_CELL_PWR_CONFIG_TEST_FUSSY_COMMAND) != NULL) &&
+        (strcmp(pLine, "AT" U_CELL_PWR_CONFIG_TEST_FUSSY_COMMAND) != 0)) {
+        uCellTestPrivateSimSendString(pSim, "\r\nERROR\r\n");
+    } else if (strcmp(pLine, "AT+UDCONF=1") == 0) {
+        snprintf(buffer, sizeof(buffer), "\r\n+UDCONF: 1,%d\r\n\r\nOK\r\n",
+                 (int) gModule.hexMode);
+        uCellTestPrivateSimSendString(pSim, buffer);
+    } else if (strcmp(pLine, "AT+UMNOPROF?") == 0) {
+        uCellTestPrivateSimSendString(pSim, "\r\n+UMNOPROF: 100\r\n\r\nOK\r\n");
+    } else {
+        if (strstr(pLine, U_CELL_PWR_CONFIG_TEST_NV_COMMAND) != NULL) {
+            gModule.hexMode = 0;
+        }
+        uCellTestPrivateSimSendString(pSim, "\r\nOK\r\n");
+    }
+}
+
+// Reset the record of what the simulated module has received.
+static void moduleLogReset()
+{
+    memset(gModule.log, 0, sizeof(gModule.log));
+    gModule.numLines = 0;
+}
+
+// Return the number of lines received by the simulated module
+// that are exactly pLine or, if exact is false, contain pLine.
+static size_t moduleLogCount(const char *pLine, bool exact)
+{
+    size_t count = 0;
+
+    for (size_t x = 0; (x < gModule.numLines) &&
+         (x < U_CELL_PWR_CONFIG_TEST_MAX_NUM_LINES); x++) {
+        if ((exact && (strcmp(gModule.log[x], pLine) == 0)) ||
+            (!exact && (strstr(gModule.log[x], pLine) != NULL))) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+// Find a command in a start-up report, returning NULL if
+// it is not there.
+static const uCellPwrStartupCommand_t *pReportFind(const uCellPwrStartupReport_t *pReport,
+                                                   const char *pCommand)
+{
+    const uCellPwrStartupCommand_t *pFound = NULL;
+
+    for (size_t x = 0; (pFound == NULL) && (x < pReport->numCommands) &&
+         (x < U_CELL_PWR_STARTUP_REPORT_MAX_COMMANDS); x++) {
+        if (strcmp(pReport->command[x].pCommand, pCommand) == 0) {
+            pFound = &(pReport->command[x]);
+        }
+    }
+
+    return pFound;
+}
+
+// Power the simulated module on and print what happened.
+static int32_t powerOn(uDeviceHandle_t cellHandle, uCellPwrStartupReport_t *pReport)
+{
+    int32_t errorCode;
+
+    moduleLogReset();
+    errorCode = uCellPwrOn(cellHandle, NULL, NULL);
+    U_TEST_PRINT_LINE("uCellPwrOn() returned %d, the module received %d line(s):",
+                      errorCode, gModule.numLines);
+    for (size_t x = 0; (x < gModule.numLines) &&
+         (x < U_CELL_PWR_CONFIG_TEST_MAX_NUM_LINES); x++) {
+        U_TEST_PRINT_LINE("  \"%s\".", gModule.log[x]);
+    }
+    if (errorCode == 0) {
+        errorCode = uCellPwrGetStartupReport(cellHandle, pReport);
+        U_TEST_PRINT_LINE("%d configuration command(s) in %d line(s), %d skipped.",
+                          pReport->numCommands, pReport->numLines,
+                          pReport->numCommandsSkipped);
+    }
+
+    return errorCode;
+}
+
+#endif // #if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+/** Power a simulated module on and check that the configuration
+ * commands are concatenated, that a setting the module already has
+ * is read back and not sent again, and that a concatenated line
+ * which the module rejects is sent again one command at a time.
+ */
+U_PORT_TEST_FUNCTION("[cellPwrConfig]", "cellPwrConfigBatch")
+{
+    uDeviceHandle_t cellHandle;
+    uCellPwrStartupReport_t report;
+    const uCellPwrStartupCommand_t *pCommand;
+    int32_t resourceCount;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+
+    // Obtain the initial resource count
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    memset(&gModule, 0, sizeof(gModule));
+    gModule.hexMode = 1;
+
+    // The simulated module is a SARA-R5, which supports AT
+    // command concatenation
+    U_PORT_TEST_ASSERT(uCellTestPrivateSimOpen(&gSim, 0, moduleCommand, NULL) == 0);
+    cellHandle = gSim.cellHandle;
+
+    // First power-on: the non-volatile setting is not yet correct
+    // so it should be read back, found wanting, and sent, with
+    // the configuration commands concatenated
+    U_TEST_PRINT_LINE("powering on with the setting not yet made...");
+    memset(&report, 0, sizeof(report));
+    U_PORT_TEST_ASSERT(powerOn(cellHandle, &report) == 0);
+    U_PORT_TEST_ASSERT(report.numCommands > 1);
+    U_PORT_TEST_ASSERT(report.numCommandsSkipped == 0);
+    U_PORT_TEST_ASSERT(report.numLines < report.numCommands);
+    pCommand = pReportFind(&report, U_CELL_PWR_CONFIG_TEST_NV_COMMAND);
+    U_PORT_TEST_ASSERT(pCommand != NULL);
+    U_PORT_TEST_ASSERT(!pCommand->skipped);
+    U_PORT_TEST_ASSERT(pCommand->lineIndex >= 0);
+    U_PORT_TEST_ASSERT(moduleLogCount("AT+UDCONF=1", true) == 1);
+    U_PORT_TEST_ASSERT(moduleLogCount(U_CELL_PWR_CONFIG_TEST_NV_COMMAND, false) == 1);
+    U_PORT_TEST_ASSERT(moduleLogCount("AT" U_CELL_PWR_CONFIG_TEST_NV_COMMAND, true) == 0);
+    U_PORT_TEST_ASSERT(gModule.hexMode == 0);
+
+    // Second power-on: the setting is now correct and so
+    // should not be sent
+    U_TEST_PRINT_LINE("powering on with the setting already made...");
+    memset(&report, 0, sizeof(report));
+    U_PORT_TEST_ASSERT(powerOn(cellHandle, &report) == 0);
+    U_PORT_TEST_ASSERT(report.numCommandsSkipped == 1);
+    pCommand = pReportFind(&report, U_CELL_PWR_CONFIG_TEST_NV_COMMAND);
+    U_PORT_TEST_ASSERT(pCommand != NULL);
+    U_PORT_TEST_ASSERT(pCommand->skipped);
+    U_PORT_TEST_ASSERT(pCommand->lineIndex == -1);
+    U_PORT_TEST_ASSERT(moduleLogCount("AT+UDCONF=1", true) == 1);
+    U_PORT_TEST_ASSERT(moduleLogCount(U_CELL_PWR_CONFIG_TEST_NV_COMMAND, false) == 0);
+
+    // Third power-on: the module rejects a concatenated line,
+    // so the commands of that line should be sent one at a time
+    U_TEST_PRINT_LINE("powering on with a module that rejects a concatenated line...");
+    gModule.hexMode = 1;
+    gModule.fussy = true;
+    memset(&report, 0, sizeof(report));
+    U_PORT_TEST_ASSERT(powerOn(cellHandle, &report) == 0);
+    U_PORT_TEST_ASSERT(report.numCommandsSkipped == 0);
+    U_PORT_TEST_ASSERT(moduleLogCount("AT" U_CELL_PWR_CONFIG_TEST_FUSSY_COMMAND, true) == 1);
+    U_PORT_TEST_ASSERT(moduleLogCount("AT" U_CELL_PWR_CONFIG_TEST_NV_COMMAND, true) == 1);
+    U_PORT_TEST_ASSERT(gModule.hexMode == 0);
+
+    uCellTestPrivateSimClose(&gSim);
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+#endif
+
+/** Clean-up to be run at the end of this round of tests, just
+ * in case there were test failures which would have resulted
+ * in the deinitialisation being skipped.
+ */
+U_PORT_TEST_FUNCTION("[cellPwrConfig]", "cellPwrConfigCleanUp")
+{
+    uCellTestPrivateSimClose(&gSim);
+    uPortDeinit();
+    // Printed for information: asserting happens in the postamble
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+}
+
+// End of file
@@ -786,6 +786,8 @@ U_PORT_TEST_FUNCTION("[cellPwr]", "cellPwr")
 U_PORT_TEST_FUNCTION("[cellPwr]", "cellPwrReboot")
 {
     int32_t resourceCount;
+    uCellPwrStartupReport_t report;
+    size_t numSent = 0;
 
     // In case a previous test failed
     uCellTestPrivateCleanup(&gHandles);
@@ -803,6 +805,36 @@ U_PORT_TEST_FUNCTION("[cellPwr]", "cellPwrReboot")
     // change bandmask and RAT.
     U_TEST_PRINT_LINE("rebooting cellular...");
     U_PORT_TEST_ASSERT(uCellPwrReboot(gHandles.cellHandle, NULL) == 0);
+
+    // Check the start-up report for the reboot
+    U_PORT_TEST_ASSERT(uCellPwrGetStartupReport(gHandles.cellHandle, NULL) < 0);
+    U_PORT_TEST_ASSERT(uCellPwrGetStartupReport(gHandles.cellHandle, &report) == 0);
+    U_TEST_PRINT_LINE("ready in %d ms, configuration took %d ms.",
+                      (int) report.readyMs, (int) report.configureMs);
+    U_PORT_TEST_ASSERT(report.aliveMs >= 0);
+    U_PORT_TEST_ASSERT(report.configureMs >= 0);
+    U_PORT_TEST_ASSERT(report.readyMs == report.aliveMs + report.configureMs);
+    U_PORT_TEST_ASSERT(report.numCommands > 0);
+    U_PORT_TEST_ASSERT(report.numCommands <= U_CELL_PWR_STARTUP_REPORT_MAX_COMMANDS);
+    U_PORT_TEST_ASSERT(report.numCommandsSkipped < report.numCommands);
+    for (size_t x = 0; x < report.numCommands; x++) {
+        U_PORT_TEST_ASSERT(report.command[x].pCommand != NULL);
+        if (report.command[x].skipped) {
+            U_TEST_PRINT_LINE("\"%s\" already set.", report.command[x].pCommand);
+            U_PORT_TEST_ASSERT(report.command[x].lineIndex < 0);
+        } else {
+            U_TEST_PRINT_LINE("\"%s\" sent in line %d, which took %d ms.",
+                              report.command[x].pCommand,
+                              (int) report.command[x].lineIndex,
+                              (int) report.command[x].durationMs);
+            U_PORT_TEST_ASSERT(report.command[x].lineIndex >= 0);
+            U_PORT_TEST_ASSERT(report.command[x].lineIndex < (int32_t) report.numLines);
+            U_PORT_TEST_ASSERT(report.command[x].durationMs >= 0);
+            numSent++;
+        }
+    }
+    U_PORT_TEST_ASSERT(report.numLines > 0);
+    U_PORT_TEST_ASSERT(report.numLines <= numSent);
 #ifdef U_CELL_TEST_MUX_ALWAYS
     U_PORT_TEST_ASSERT(uCellMuxEnable(gHandles.cellHandle) == 0);
 #endif
@@ -0,0 +1,462 @@
+/*
+ * Copyright 2019-2023 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Tests for the way the sockets API keeps track of the
+ * sockets of a cellular module: the table of sockets by descriptor,
+ * the index of sockets by network handle and socket handle and the
+ * pool of allocated socket containers.  No cellular module is used
+ * in this set of tests: the module is simulated on the other end of
+ * a pair of UARTs (U_CFG_TEST_UART_A and U_CFG_TEST_UART_B) that are
+ * connected together.
+ * Note that the pool of allocated socket containers is only used
+ * if U_SOCK_NUM_STATIC_SOCKETS is less than U_SOCK_MAX_NUM_SOCKETS.
+ * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
+ * naming rules that must be followed when using the U_PORT_TEST_FUNCTION()
+ * macro.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "stdlib.h"    // atoi()
+#include "stdio.h"     // snprintf()
+#include "string.h"    // memset(), strncmp()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port_clib_platform_specific.h" /* Integer stdio, must be included
+                                              before the other port files if
+                                              any print or scan function is used. */
+#include "u_port.h"
+#include "u_port_debug.h"
+#include "u_port_os.h"
+#include "u_port_heap.h"
+
+#include "u_test_util_resource_check.h"
+
+#include "u_at_client.h"
+
+#include "u_sock.h"
+#include "u_sock_private.h" // For U_SOCK_NUM_STATIC_SOCKETS
+
+#include "u_cell_module_type.h"
+#include "u_cell.h"
+#include "u_cell_sock.h"
+#include "u_cell_net.h"     // Required by u_cell_test_private.h
+
+#include "u_cell_test_private.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_CELL_SOCK_CONTAINER_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+/** The number of sockets to open: as many as both the sockets API
+ * and the cellular socket layer allow.
+ */
+#if U_SOCK_MAX_NUM_SOCKETS < U_CELL_SOCK_MAX_NUM_SOCKETS
+# define U_CELL_SOCK_CONTAINER_TEST_NUM_SOCKETS U_SOCK_MAX_NUM_SOCKETS
+#else
+# define U_CELL_SOCK_CONTAINER_TEST_NUM_SOCKETS U_CELL_SOCK_MAX_NUM_SOCKETS
+#endif
+
+/** How long to wait for a data callback to be called.
+ */
+#define U_CELL_SOCK_CONTAINER_TEST_CALLBACK_WAIT_MS 1000
+
+/** How long to wait to be sure that a data callback has NOT been
+ * called and, after a close, for the cellular socket layer to
+ * free the socket.
+ */
+#define U_CELL_SOCK_CONTAINER_TEST_SETTLE_MS 200
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The state of the simulated module.
+ */
+typedef struct {
+    bool socketInUse[U_CELL_SOCK_MAX_NUM_SOCKETS];
+    int32_t lastSocketId;  /**< the module socket ID returned by the
+                                last successful AT+USOCR. */
+} uCellSockContainerTestModule_t;
+
+/** A socket opened by the test.
+ */
+typedef struct {
+    uSockDescriptor_t descriptor; /**< -1 if the socket is closed. */
+    int32_t moduleSocketId;
+    int32_t dataCallbackCount;
+} uCellSockContainerTestSocket_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The simulated module.
+ */
+static uCellTestPrivateSim_t gSim = U_CELL_TEST_PRIVATE_SIM_DEFAULTS;
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+/** The state of the simulated module.
+ */
+static uCellSockContainerTestModule_t gModule = {0};
+
+/** The sockets opened by the test.
+ */
+static uCellSockContainerTestSocket_t gSocket[U_CELL_SOCK_CONTAINER_TEST_NUM_SOCKETS];
+#endif
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+
+// Handle an AT command line received by the simulated module:
+// sockets are created, using the highest free socket ID so that
+// the IDs re-used do not follow the descriptors re-used, and
+// closed, everything else is OK.
+static void moduleCommand(uCellTestPrivateSim_t *pSim, const char *pLine)
+{
+    char buffer[64];
+    int32_t socketId = -1;
+
+    if (strncmp(pLine, "AT+USOCR=", 9) == 0) {
+        for (int32_t x = (int32_t) (sizeof(gModule.socketInUse) /
+                                    sizeof(gModule.socketInUse[0])) - 1;
+             (socketId < 0) && (x >= 0); x--) {
+            if (!gModule.socketInUse[x]) {
+                socketId = x;
+            }
+        }
+        if (socketId >= 0) {
+            gModule.socketInUse[socketId] = true;
+            gModule.lastSocketId = socketId;
+            snprintf(buffer, sizeof(buffer), "\r\n+USOCR: %d\r\n\r\nOK\r\n",
+                     (int) socketId);
+            uCellTestPrivateSimSendString(pSim, buffer);
+        } else {
+            uCellTestPrivateSimSendString(pSim, "\r\nERROR\r\n");
+        }
+    } else if (strncmp(pLine, "AT+USOCL=", 9) == 0) {
+        socketId = atoi(pLine + 9);
+        if ((socketId >= 0) &&
+            (socketId < (int32_t) (sizeof(gModule.socketInUse) / sizeof(gModule.socketInUse[0])))) {
+            gModule.socketInUse[socketId] = false;
+        }
+        uCellTestPrivateSimSendString(pSim, "\r\nOK\r\n");
+    } else {
+        uCellTestPrivateSimSendString(pSim, "\r\nOK\r\n");
+    }
+}
+
+// Have the simulated module indicate that data has arrived
+// on the given module socket.
+static void moduleSendData(int32_t socketId)
+{
+    char buffer[32];
+
+    snprintf(buffer, sizeof(buffer), "\r\n+UUSORF: %d,1\r\n", (int) socketId);
+    uCellTestPrivateSimSendString(&gSim, buffer);
+}
+
+// Data callback for a socket, parameter is a pointer to the
+// uCellSockContainerTestSocket_t of the socket.
+static void dataCallback(void *pParameter)
+{
+    ((uCellSockContainerTestSocket_t *) pParameter)->dataCallbackCount++;
+}
+
+// Return the total number of data callbacks that have been called.
+static int32_t dataCallbackCountTotal()
+{
+    int32_t count = 0;
+
+    for (size_t x = 0; x < sizeof(gSocket) / sizeof(gSocket[0]); x++) {
+        count += gSocket[x].dataCallbackCount;
+    }
+
+    return count;
+}
+
+// Return the number of outstanding heap allocations once the
+// AT client and UART tasks, which may allocate and free
+// memory as they go, have settled.
+static int32_t heapAllocCountSettled()
+{
+    int32_t count = -1;
+    int32_t countPrevious;
+
+    do {
+        countPrevious = count;
+        uPortTaskBlock(U_CELL_SOCK_CONTAINER_TEST_SETTLE_MS);
+        count = uPortHeapAllocCount();
+    } while (count != countPrevious);
+
+    return count;
+}
+
+// Open a socket, returning the descriptor; the module socket ID
+// and data callback are also set.
+static uSockDescriptor_t socketOpen(uDeviceHandle_t cellHandle,
+                                    uCellSockContainerTestSocket_t *pSocket)
+{
+    memset(pSocket, 0, sizeof(*pSocket));
+    pSocket->moduleSocketId = -1;
+    pSocket->descriptor = uSockCreate(cellHandle, U_SOCK_TYPE_DGRAM,
+                                      U_SOCK_PROTOCOL_UDP);
+    if (pSocket->descriptor >= 0) {
+        pSocket->moduleSocketId = gModule.lastSocketId;
+        uSockRegisterCallbackData(pSocket->descriptor, dataCallback, pSocket);
+    }
+    U_TEST_PRINT_LINE("opened descriptor %d, module socket %d.",
+                      pSocket->descriptor, pSocket->moduleSocketId);
+
+    return pSocket->descriptor;
+}
+
+// Close a socket.
+static int32_t socketClose(uCellSockContainerTestSocket_t *pSocket)
+{
+    int32_t errorCode = uSockClose(pSocket->descriptor);
+
+    U_TEST_PRINT_LINE("closed descriptor %d, module socket %d.",
+                      pSocket->descriptor, pSocket->moduleSocketId);
+    pSocket->descriptor = -1;
+
+    return errorCode;
+}
+
+// Check that the descriptors of all of the open sockets are
+// different and that data arriving at the module for each of them,
+// done in reverse order, calls the data callback of that socket
+// and no other; this requires both the lookup by descriptor
+// (uSockRegisterCallbackData()) and the lookup by network handle
+// and socket handle (the data callback from the cellular socket
+// layer) to find the right container.
+static bool checkSockets()
+{
+    bool success = true;
+
+    for (size_t x = 0; x < sizeof(gSocket) / sizeof(gSocket[0]); x++) {
+        for (size_t y = x + 1; y < sizeof(gSocket) / sizeof(gSocket[0]); y++) {
+            if ((gSocket[x].descriptor >= 0) &&
+                (gSocket[x].descriptor == gSocket[y].descriptor)) {
+                U_TEST_PRINT_LINE("descriptor %d is used twice.", gSocket[x].descriptor);
+                success = false;
+            }
+        }
+    }
+
+    for (int32_t x = (int32_t) (sizeof(gSocket) / sizeof(gSocket[0])) - 1;
+         success && (x >= 0); x--) {
+        if (gSocket[x].descriptor >= 0) {
+            for (size_t y = 0; y < sizeof(gSocket) / sizeof(gSocket[0]); y++) {
+                gSocket[y].dataCallbackCount = 0;
+            }
+            moduleSendData(gSocket[x].moduleSocketId);
+            for (int32_t y = 0; (gSocket[x].dataCallbackCount == 0) &&
+                 (y < U_CELL_SOCK_CONTAINER_TEST_CALLBACK_WAIT_MS); y += 10) {
+                uPortTaskBlock(10);
+            }
+            uPortTaskBlock(U_CELL_SOCK_CONTAINER_TEST_SETTLE_MS);
+            if ((gSocket[x].dataCallbackCount != 1) || (dataCallbackCountTotal() != 1)) {
+                U_TEST_PRINT_LINE("data on module socket %d called the callback of"
+                                  " descriptor %d %d time(s), callbacks called %d"
+                                  " time(s) in total.", gSocket[x].moduleSocketId,
+                                  gSocket[x].descriptor, gSocket[x].dataCallbackCount,
+                                  dataCallbackCountTotal());
+                success = false;
+            }
+        }
+    }
+
+    return success;
+}
+
+#endif // #if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+/** Open as many sockets on a simulated module as are allowed,
+ * close and re-open them out of order, and check that the
+ * containers are found correctly by descriptor and by network
+ * handle and socket handle and that allocated containers are
+ * re-used rather than allocated again.
+ */
+U_PORT_TEST_FUNCTION("[cellSockContainer]", "cellSockContainerBasic")
+{
+    uDeviceHandle_t cellHandle;
+    int32_t heapAllocCount;
+    int32_t numAllocated;
+    int32_t numAllocatedExpected = 0;
+    // Closed out of order, leaving the first socket open throughout
+    const size_t closeOrder[] = {3, 1, 5, 6, 2, 4};
+    int32_t resourceCount;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+
+    // Obtain the initial resource count
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    memset(&gModule, 0, sizeof(gModule));
+    memset(gSocket, 0, sizeof(gSocket));
+
+    U_PORT_TEST_ASSERT(uCellTestPrivateSimOpen(&gSim, 0, moduleCommand, NULL) == 0);
+    cellHandle = gSim.cellHandle;
+
+    // Open the first socket, which also initialises the sockets
+    // API, and then count the allocations made when opening the
+    // rest: any beyond U_SOCK_NUM_STATIC_SOCKETS must be allocated
+    U_TEST_PRINT_LINE("opening %d sockets, %d of which are static.",
+                      U_CELL_SOCK_CONTAINER_TEST_NUM_SOCKETS, U_SOCK_NUM_STATIC_SOCKETS);
+    U_PORT_TEST_ASSERT(socketOpen(cellHandle, &(gSocket[0])) >= 0);
+    heapAllocCount = heapAllocCountSettled();
+    for (size_t x = 1; x < sizeof(gSocket) / sizeof(gSocket[0]); x++) {
+        U_PORT_TEST_ASSERT(socketOpen(cellHandle, &(gSocket[x])) >= 0);
+        if (x >= U_SOCK_NUM_STATIC_SOCKETS) {
+            numAllocatedExpected++;
+        }
+    }
+    numAllocated = heapAllocCountSettled() - heapAllocCount;
+    U_TEST_PRINT_LINE("%d container(s) were allocated.", numAllocated);
+    U_PORT_TEST_ASSERT(numAllocated == numAllocatedExpected);
+    U_PORT_TEST_ASSERT(checkSockets());
+
+    // Close some of the sockets out of order: they should
+    // no longer be found by descriptor, or by socket handle
+    // when data arrives for them
+    U_TEST_PRINT_LINE("closing half of the sockets out of order...");
+    for (size_t x = 0; x < sizeof(gSocket) / sizeof(gSocket[0]); x++) {
+        gSocket[x].dataCallbackCount = 0;
+    }
+    for (size_t x = 0; x < sizeof(closeOrder) / sizeof(closeOrder[0]); x += 2) {
+        if (closeOrder[x] < sizeof(gSocket) / sizeof(gSocket[0])) {
+            uCellSockContainerTestSocket_t *pSocket = &(gSocket[closeOrder[x]]);
+            uSockDescriptor_t descriptor = pSocket->descriptor;
+            U_PORT_TEST_ASSERT(socketClose(pSocket) == 0);
+            U_PORT_TEST_ASSERT(uSockClose(descriptor) < 0);
+            moduleSendData(pSocket->moduleSocketId);
+        }
+    }
+    uPortTaskBlock(U_CELL_SOCK_CONTAINER_TEST_SETTLE_MS);
+    U_PORT_TEST_ASSERT(dataCallbackCountTotal() == 0);
+    U_PORT_TEST_ASSERT(checkSockets());
+
+    // Re-open them in a different order: the closed containers
+    // should be re-used without allocating any more
+    U_TEST_PRINT_LINE("re-opening them...");
+    heapAllocCount = heapAllocCountSettled();
+    for (int32_t x = (int32_t) (sizeof(gSocket) / sizeof(gSocket[0])) - 1; x >= 0; x--) {
+        if (gSocket[x].descriptor < 0) {
+            U_PORT_TEST_ASSERT(socketOpen(cellHandle, &(gSocket[x])) >= 0);
+        }
+    }
+    U_PORT_TEST_ASSERT(heapAllocCountSettled() == heapAllocCount);
+    U_PORT_TEST_ASSERT(checkSockets());
+
+    // Close all but the first socket, out of order, and clean up:
+    // since a socket is still open the allocated containers should
+    // go to the pool rather than being freed
+    U_TEST_PRINT_LINE("closing all but one of the sockets out of order and cleaning up...");
+    for (size_t x = 0; x < sizeof(closeOrder) / sizeof(closeOrder[0]); x++) {
+        if (closeOrder[x] < sizeof(gSocket) / sizeof(gSocket[0])) {
+            U_PORT_TEST_ASSERT(socketClose(&(gSocket[closeOrder[x]])) == 0);
+        }
+    }
+    uPortTaskBlock(U_CELL_SOCK_CONTAINER_TEST_SETTLE_MS);
+    uSockCleanUp();
+    U_PORT_TEST_ASSERT(heapAllocCountSettled() == heapAllocCount);
+    U_PORT_TEST_ASSERT(checkSockets());
+
+    // Re-open them: the containers should come from the pool
+    U_TEST_PRINT_LINE("re-opening them...");
+    for (size_t x = 1; x < sizeof(gSocket) / sizeof(gSocket[0]); x++) {
+        U_PORT_TEST_ASSERT(socketOpen(cellHandle, &(gSocket[x])) >= 0);
+    }
+    U_PORT_TEST_ASSERT(heapAllocCountSettled() == heapAllocCount);
+    U_PORT_TEST_ASSERT(checkSockets());
+
+    // Close everything and clean up: this time the pool
+    // should be freed
+    U_TEST_PRINT_LINE("closing all of the sockets and cleaning up...");
+    for (size_t x = 0; x < sizeof(gSocket) / sizeof(gSocket[0]); x++) {
+        U_PORT_TEST_ASSERT(socketClose(&(gSocket[x])) == 0);
+    }
+    uPortTaskBlock(U_CELL_SOCK_CONTAINER_TEST_SETTLE_MS);
+    uSockCleanUp();
+    U_PORT_TEST_ASSERT(heapAllocCountSettled() <= heapAllocCount - numAllocated);
+
+    uSockDeinit();
+    uCellTestPrivateSimClose(&gSim);
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+#endif
+
+/** Clean-up to be run at the end of this round of tests, just
+ * in case there were test failures which would have resulted
+ * in the deinitialisation being skipped.
+ */
+U_PORT_TEST_FUNCTION("[cellSockContainer]", "cellSockContainerCleanUp")
+{
+    uSockDeinit();
+    uCellTestPrivateSimClose(&gSim);
+    uPortDeinit();
+    // Printed for information: asserting happens in the postamble
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+}
+
+// End of file
@@ -0,0 +1,248 @@
+/*
+ * Copyright 2019-2023 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Tests for the internal cellular state snapshot encode/decode
+ * functions.  No cellular module is required to run this set of tests,
+ * all testing is back to back.
+ * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
+ * naming rules that must be followed when using the U_PORT_TEST_FUNCTION()
+ * macro.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memcmp()/memset()/strcmp()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_test_util_resource_check.h"
+
+#include "u_at_client.h"
+
+#include "u_port.h"
+#include "u_port_os.h"
+#include "u_port_heap.h"
+#include "u_port_debug.h"
+
+#include "u_cell_module_type.h"
+#include "u_cell.h"
+#include "u_cell_file.h"
+#include "u_cell_net.h"     // Required by u_cell_private.h
+#include "u_cell_private.h"
+
+#include "u_cell_cfg.h"     // U_CELL_CFG_STATE_SNAPSHOT_MAX_LENGTH_BYTES
+#include "u_cell_state_private.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The base string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX_BASE "U_CELL_STATE_PRIVATE_TEST"
+
+/** The string to put at the start of all prints from this test
+ * that do not require an iteration on the end.
+ */
+#define U_TEST_PREFIX U_TEST_PREFIX_BASE ": "
+
+/** Print a whole line, with terminator, prefixed for this test
+ * file, no iteration version.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Populate a state with a full set of plausible values.
+static void populateState(uCellPrivateState_t *pState, size_t bandMaskRawCount)
+{
+    memset(pState, 0, sizeof(*pState));
+    pState->validBitMap = U_CELL_PRIVATE_STATE_IMEI |
+                          U_CELL_PRIVATE_STATE_FIRMWARE_VERSION |
+                          U_CELL_PRIVATE_STATE_MNO_PROFILE |
+                          U_CELL_PRIVATE_STATE_GNSS_PROFILE |
+                          U_CELL_PRIVATE_STATE_RAT;
+    memcpy(pState->imei, "358201234567890", sizeof(pState->imei));
+    // Make the firmware version as long as it can possibly be
+    memset(pState->firmwareVersion, 'x', sizeof(pState->firmwareVersion) - 1);
+    memcpy(pState->firmwareVersion, "03.15,A00.01", 12);
+    pState->mnoProfile = 100;
+    pState->gnssProfileBitMap = U_CELL_CFG_GNSS_PROFILE_MUX | U_CELL_CFG_GNSS_PROFILE_IP;
+    pState->rat[0] = (int8_t) U_CELL_NET_RAT_CATM1;
+    pState->rat[1] = (int8_t) U_CELL_NET_RAT_NB1;
+    if (bandMaskRawCount > 0) {
+        pState->validBitMap |= U_CELL_PRIVATE_STATE_BAND_MASK;
+        for (size_t x = 0; x < bandMaskRawCount; x++) {
+            // Make sure that the top and bottom bytes are populated
+            pState->bandMaskRaw[x] = 0x8000000000000001ULL + x;
+        }
+        pState->bandMaskRawCount = bandMaskRawCount;
+    }
+}
+
+// Check that two states are the same.
+static bool stateIsEqual(const uCellPrivateState_t *pA,
+                         const uCellPrivateState_t *pB)
+{
+    bool isEqual = (pA->validBitMap == pB->validBitMap) &&
+                   (memcmp(pA->imei, pB->imei, sizeof(pA->imei)) == 0) &&
+                   (strcmp(pA->firmwareVersion, pB->firmwareVersion) == 0) &&
+                   (pA->mnoProfile == pB->mnoProfile) &&
+                   (pA->gnssProfileBitMap == pB->gnssProfileBitMap) &&
+                   (memcmp(pA->rat, pB->rat, sizeof(pA->rat)) == 0) &&
+                   (pA->bandMaskRawCount == pB->bandMaskRawCount);
+
+    for (size_t x = 0; isEqual && (x < pA->bandMaskRawCount); x++) {
+        isEqual = (pA->bandMaskRaw[x] == pB->bandMaskRaw[x]);
+    }
+
+    return isEqual;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Test the state snapshot encode/decode functions back-to-back.
+ *
+ * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
+ * naming rules that must be followed when using the
+ * U_PORT_TEST_FUNCTION() macro.
+ */
+U_PORT_TEST_FUNCTION("[cellStatePrivate]", "cellStatePrivateRoundTrip")
+{
+    int32_t resourceCount;
+    uCellPrivateState_t state;
+    uCellPrivateState_t decodedState;
+    char buffer[U_CELL_CFG_STATE_SNAPSHOT_MAX_LENGTH_BYTES];
+    int32_t length;
+    int32_t x;
+
+    // Obtain the initial resource count
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    // The public maximum length must be enough for the worst case
+    U_PORT_TEST_ASSERT(U_CELL_STATE_PRIVATE_ENCODED_MAX_LENGTH_BYTES <=
+                       U_CELL_CFG_STATE_SNAPSHOT_MAX_LENGTH_BYTES);
+
+    // Round-trip all possible numbers of band mask entries,
+    // including the maximum, which gives the longest snapshot
+    for (size_t y = 0; y <= U_CELL_PRIVATE_STATE_BAND_MASK_RAW_MAX_NUM; y++) {
+        populateState(&state, y);
+        length = uCellStatePrivateEncode(&state, buffer, sizeof(buffer));
+        U_TEST_PRINT_LINE("%d band mask number(s) encode to %d byte(s).",
+                          y, length);
+        U_PORT_TEST_ASSERT(length > 0);
+        U_PORT_TEST_ASSERT(length <= U_CELL_STATE_PRIVATE_ENCODED_MAX_LENGTH_BYTES);
+        memset(&decodedState, 0xFF, sizeof(decodedState));
+        U_PORT_TEST_ASSERT(uCellStatePrivateDecode(buffer, length, &decodedState) == 0);
+        U_PORT_TEST_ASSERT(stateIsEqual(&state, &decodedState));
+    }
+    U_PORT_TEST_ASSERT(length == U_CELL_STATE_PRIVATE_ENCODED_MAX_LENGTH_BYTES);
+
+    // An empty state should also make the journey
+    memset(&state, 0, sizeof(state));
+    length = uCellStatePrivateEncode(&state, buffer, sizeof(buffer));
+    U_PORT_TEST_ASSERT(length > 0);
+    U_PORT_TEST_ASSERT(uCellStatePrivateDecode(buffer, length, &decodedState) == 0);
+    U_PORT_TEST_ASSERT(stateIsEqual(&state, &decodedState));
+
+    // Encoding into a buffer that is too small should fail, and
+    // without writing off the end
+    populateState(&state, 2);
+    length = uCellStatePrivateEncode(&state, buffer, sizeof(buffer));
+    U_PORT_TEST_ASSERT(length > 0);
+    memset(buffer, 0, sizeof(buffer));
+    U_PORT_TEST_ASSERT(uCellStatePrivateEncode(&state, buffer, length - 1) < 0);
+    for (size_t y = 0; y < sizeof(buffer); y++) {
+        U_PORT_TEST_ASSERT(buffer[y] == 0);
+    }
+    U_PORT_TEST_ASSERT(uCellStatePrivateEncode(&state, buffer, length) == length);
+
+    // Corrupting any single byte should cause decoding to fail
+    // and leave the output untouched
+    for (int32_t y = 0; y < length; y++) {
+        buffer[y] ^= 0x5a;
+        memset(&decodedState, 0, sizeof(decodedState));
+        x = uCellStatePrivateDecode(buffer, length, &decodedState);
+        if (x == 0) {
+            U_TEST_PRINT_LINE("corrupting byte %d was not detected.", y);
+        }
+        U_PORT_TEST_ASSERT(x < 0);
+        U_PORT_TEST_ASSERT(decodedState.validBitMap == 0);
+        buffer[y] ^= 0x5a;
+    }
+    U_PORT_TEST_ASSERT(uCellStatePrivateDecode(buffer, length, &decodedState) == 0);
+
+    // A snapshot of a different version should be rejected
+    // as such, even though its CRC is wrong
+    buffer[2]++;
+    U_PORT_TEST_ASSERT(uCellStatePrivateDecode(buffer, length,
+                                               &decodedState) == (int32_t) U_ERROR_COMMON_NOT_SUPPORTED);
+    buffer[2]--;
+
+    // Truncated or over-long snapshots should be rejected
+    for (int32_t y = 0; y < length; y++) {
+        U_PORT_TEST_ASSERT(uCellStatePrivateDecode(buffer, y, &decodedState) < 0);
+    }
+    U_PORT_TEST_ASSERT(uCellStatePrivateDecode(buffer, length + 1, &decodedState) < 0);
+
+    // NULL parameters
+    U_PORT_TEST_ASSERT(uCellStatePrivateEncode(NULL, buffer, sizeof(buffer)) < 0);
+    U_PORT_TEST_ASSERT(uCellStatePrivateEncode(&state, NULL, sizeof(buffer)) < 0);
+    U_PORT_TEST_ASSERT(uCellStatePrivateDecode(NULL, length, &decodedState) < 0);
+    U_PORT_TEST_ASSERT(uCellStatePrivateDecode(buffer, length, NULL) < 0);
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+    // Printed for information: asserting happens in the postamble
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+}
+
+// End of file
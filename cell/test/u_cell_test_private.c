@@ -31,10 +31,12 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
-#include "string.h"    // memset()
+#include "string.h"    // memset(), strlen()
 
 #include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
 #include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
 
 #include "u_error_common.h"
 
@@ -45,6 +47,8 @@
 
 #include "u_at_client.h"
 
+#include "u_device.h"
+
 #include "u_cell_module_type.h"
 #include "u_cell.h"
 #include "u_cell_file.h"
@@ -117,6 +121,46 @@ static const char *const pRatStr[] = {"unknown or not used",
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Callback for data arriving at a simulated module: assembles
+// lines and passes them to the command callback, or passes data
+// to the raw callback while rawLength is non-zero.
+static void simUartCallback(int32_t uartHandle, uint32_t eventBitmask,
+                            void *pParameters)
+{
+    uCellTestPrivateSim_t *pSim = (uCellTestPrivateSim_t *) pParameters;
+    char buffer[64];
+    int32_t length;
+    size_t x;
+
+    if ((eventBitmask & U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED) != 0) {
+        do {
+            length = uPortUartRead(uartHandle, buffer, sizeof(buffer));
+            for (x = 0; (length > 0) && (x < (size_t) length); x++) {
+                if ((pSim->rawLength > 0) && (pSim->pRawCallback != NULL)) {
+                    // Pass on as much as is wanted in one go
+                    size_t rawLength = (size_t) length - x;
+                    if (rawLength > pSim->rawLength) {
+                        rawLength = pSim->rawLength;
+                    }
+                    pSim->rawLength -= rawLength;
+                    pSim->pRawCallback(pSim, buffer + x, rawLength);
+                    x += rawLength - 1;
+                } else if (buffer[x] == '\r') {
+                    pSim->line[pSim->lineLength] = 0;
+                    if (pSim->lineLength > 0) {
+                        pSim->pCommandCallback(pSim, pSim->line);
+                    }
+                    pSim->lineLength = 0;
+                } else if ((buffer[x] != '\n') &&
+                           (pSim->lineLength < sizeof(pSim->line) - 1)) {
+                    pSim->line[pSim->lineLength] = buffer[x];
+                    pSim->lineLength++;
+                }
+            }
+        } while (length > 0);
+    }
+}
+
 // Set the given context.
 static void contextSet(uDeviceHandle_t cellHandle,
                        int32_t contextId,
@@ -275,10 +319,11 @@ int32_t uCellTestPrivatePreamble(uCellModuleType_t moduleType,
                     // This is fixed with an AT+UDCONF=92,1,1 command which
                     // can be sent with uCellCfgSetUdconf() however unfortunately we
                     // can't send it here since even power on will have failed because
-                    // of the CME ERRORs: you will need to just hack "AT+UDCONF=92,1,1"
-                    // into the gpConfigCommand[] list in u_cell_pwr.c, just after "ATI9",
-                    // and then make sure you reboot afterwards to write the setting to
-                    // non-volatile memory.  Once this is done the hack can be removed.
+                    // of the CME ERRORs: you will need to build with
+                    // U_CFG_1V8_SIM_WORKAROUND defined, which adds "+UDCONF=92,1,1"
+                    // to the gConfigCommand[] table in u_cell_pwr.c, and then make sure
+                    // you reboot afterwards to write the setting to non-volatile memory.
+                    // Once this is done the workaround can be removed.
 
                     // Give the module time to read its SIM before we continue
                     // or it might refuse to answer some commands (e.g. AT+URAT?)
@@ -579,4 +624,117 @@ int32_t uCellTestPrivateLwm2mDisable(uDeviceHandle_t cellHandle)
     return errorCode;
 }
 
+// Open a simulated module.
+int32_t uCellTestPrivateSimOpen(uCellTestPrivateSim_t *pSim,
+                                size_t uartABufferLength,
+                                void (*pCommandCallback)(uCellTestPrivateSim_t *,
+                                                         const char *),
+                                void (*pRawCallback)(uCellTestPrivateSim_t *,
+                                                     const char *, size_t))
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((pSim != NULL) && (pCommandCallback != NULL)) {
+        pSim->atClientHandle = NULL;
+        pSim->cellHandle = NULL;
+        pSim->lineLength = 0;
+        pSim->rawLength = 0;
+        pSim->pCommandCallback = pCommandCallback;
+        pSim->pRawCallback = pRawCallback;
+        if (uartABufferLength == 0) {
+            uartABufferLength = U_CELL_UART_BUFFER_LENGTH_BYTES;
+        }
+        errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+#ifdef U_CFG_TEST_UART_PREFIX
+        uPortUartPrefix(U_PORT_STRINGIFY_QUOTED(U_CFG_TEST_UART_PREFIX));
+#endif
+        pSim->uartAHandle = uPortUartOpen(U_CFG_TEST_UART_A,
+                                          U_CFG_TEST_BAUD_RATE,
+                                          NULL,
+                                          uartABufferLength,
+                                          U_CFG_TEST_PIN_UART_A_TXD,
+                                          U_CFG_TEST_PIN_UART_A_RXD,
+                                          U_CFG_TEST_PIN_UART_A_CTS,
+                                          U_CFG_TEST_PIN_UART_A_RTS);
+#ifdef U_CFG_TEST_UART_PREFIX
+        uPortUartPrefix(U_PORT_STRINGIFY_QUOTED(U_CFG_TEST_UART_PREFIX));
+#endif
+        pSim->uartBHandle = uPortUartOpen(U_CFG_TEST_UART_B,
+                                          U_CFG_TEST_BAUD_RATE,
+                                          NULL,
+                                          U_CELL_UART_BUFFER_LENGTH_BYTES,
+                                          U_CFG_TEST_PIN_UART_B_TXD,
+                                          U_CFG_TEST_PIN_UART_B_RXD,
+                                          U_CFG_TEST_PIN_UART_B_CTS,
+                                          U_CFG_TEST_PIN_UART_B_RTS);
+        if ((pSim->uartAHandle >= 0) && (pSim->uartBHandle >= 0) &&
+            (uPortUartEventCallbackSet(pSim->uartBHandle,
+                                       U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED,
+                                       simUartCallback, pSim,
+                                       U_AT_CLIENT_URC_TASK_STACK_SIZE_BYTES,
+                                       U_AT_CLIENT_URC_TASK_PRIORITY) == 0)) {
+            // The sockets API, for one, initialises all of the
+            // underlying layers, so everything must be initialised,
+            // hence uDeviceInit()
+            errorCode = uDeviceInit();
+            if (errorCode == 0) {
+                errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                pSim->atClientHandle = uAtClientAdd(pSim->uartAHandle,
+                                                    U_AT_CLIENT_STREAM_TYPE_UART,
+                                                    NULL, U_CELL_AT_BUFFER_LENGTH_BYTES);
+                if (pSim->atClientHandle != NULL) {
+                    errorCode = uCellAdd(U_CELL_MODULE_TYPE_SARA_R5, pSim->atClientHandle,
+                                         -1, -1, -1, false, &(pSim->cellHandle));
+                }
+            }
+        }
+        if (errorCode != 0) {
+            U_TEST_PRINT_LINE("unable to open simulated module (%d).", errorCode);
+            uCellTestPrivateSimClose(pSim);
+        }
+    }
+
+    return errorCode;
+}
+
+// Close a simulated module.
+void uCellTestPrivateSimClose(uCellTestPrivateSim_t *pSim)
+{
+    // Let uDeviceDeinit() remove the cell handle and AT client
+    uDeviceDeinit();
+    pSim->cellHandle = NULL;
+    pSim->atClientHandle = NULL;
+    if (pSim->uartBHandle >= 0) {
+        uPortUartClose(pSim->uartBHandle);
+    }
+    pSim->uartBHandle = -1;
+    if (pSim->uartAHandle >= 0) {
+        uPortUartClose(pSim->uartAHandle);
+    }
+    pSim->uartAHandle = -1;
+}
+
+// Send data from a simulated module.
+void uCellTestPrivateSimSend(uCellTestPrivateSim_t *pSim,
+                             const char *pData, size_t length)
+{
+    int32_t x;
+
+    while (length > 0) {
+        x = uPortUartWrite(pSim->uartBHandle, pData, length);
+        if (x < 0) {
+            break;
+        }
+        pData += x;
+        length -= x;
+    }
+}
+
+// Send a string from a simulated module.
+void uCellTestPrivateSimSendString(uCellTestPrivateSim_t *pSim,
+                                   const char *pString)
+{
+    uCellTestPrivateSimSend(pSim, pString, strlen(pString));
+}
+
 // End of file
@@ -41,6 +41,19 @@ extern "C" {
 // which it might not be if U_CFG_TEST_CELL_MODULE_TYPE is not defined.
 #define U_CELL_TEST_PRIVATE_DEFAULTS {-1, NULL, NULL}
 
+#ifndef U_CELL_TEST_PRIVATE_SIM_LINE_LENGTH_BYTES
+/** The size of the buffer for a line received by a simulated
+ * module, see uCellTestPrivateSim_t.
+ */
+# define U_CELL_TEST_PRIVATE_SIM_LINE_LENGTH_BYTES 128
+#endif
+
+/** Default values for uCellTestPrivateSim_t.
+ */
+//lint -esym(755, U_CELL_TEST_PRIVATE_SIM_DEFAULTS) Suppress not referenced,
+// which it might not be if U_CFG_TEST_UART_A/B are not defined.
+#define U_CELL_TEST_PRIVATE_SIM_DEFAULTS {-1, -1, NULL, NULL, {0}, 0, 0, NULL, NULL}
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -53,6 +66,29 @@ typedef struct {
     uDeviceHandle_t cellHandle;  /**< The device handle returned by uCellAdd(). */
 } uCellTestPrivate_t;
 
+/** A cellular module simulated on the far end of a pair of UARTs
+ * (U_CFG_TEST_UART_A and U_CFG_TEST_UART_B) that are connected
+ * together, for tests which need no real module: lines received
+ * by the simulated module are passed to pCommandCallback, which
+ * sends the responses with uCellTestPrivateSimSend().  Should
+ * pCommandCallback set rawLength, that many of the bytes that
+ * follow are passed to pRawCallback instead, rawLength having
+ * been reduced accordingly before the call.
+ */
+typedef struct uCellTestPrivateSim_t {
+    int32_t uartAHandle; /**< the cellular side. */
+    int32_t uartBHandle; /**< the simulated module side. */
+    uAtClientHandle_t atClientHandle;
+    uDeviceHandle_t cellHandle;
+    char line[U_CELL_TEST_PRIVATE_SIM_LINE_LENGTH_BYTES];
+    size_t lineLength;
+    size_t rawLength;
+    void (*pCommandCallback)(struct uCellTestPrivateSim_t *pSim,
+                             const char *pLine);
+    void (*pRawCallback)(struct uCellTestPrivateSim_t *pSim,
+                         const char *pData, size_t length);
+} uCellTestPrivateSim_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -145,6 +181,75 @@ uCellNetRat_t uCellTestPrivateInitRatGet(uint32_t supportedRatsBitmap);
  */
 int32_t uCellTestPrivateLwm2mDisable(uDeviceHandle_t cellHandle);
 
+/** Open a simulated module: opens the UARTs, initialises all of
+ * the device APIs with uDeviceInit() and adds a SARA-R5 cellular
+ * instance, which supports everything, on UART A.  uPortInit()
+ * must have been called.
+ *
+ * @param pSim               a pointer to the simulated module, which
+ *                           must have been initialised with
+ *                           #U_CELL_TEST_PRIVATE_SIM_DEFAULTS.
+ * @param uartABufferLength  the size of the UART buffer on the
+ *                           cellular side, zero for the default of
+ *                           U_CELL_UART_BUFFER_LENGTH_BYTES.
+ * @param pCommandCallback   the function to handle each line received
+ *                           by the simulated module, may not be NULL.
+ * @param pRawCallback       the function to handle raw data, may be
+ *                           NULL if rawLength is never set.
+ * @return                   zero on success else negative error code.
+ */
+//lint -esym(759, uCellTestPrivateSimOpen) Suppress the "can be
+//lint -esym(765, uCellTestPrivateSimOpen) made static" etc. which
+//lint -esym(714, uCellTestPrivateSimOpen) will occur if
+//                                         U_CFG_TEST_UART_A/B are
+//                                         not defined
+int32_t uCellTestPrivateSimOpen(uCellTestPrivateSim_t *pSim,
+                                size_t uartABufferLength,
+                                void (*pCommandCallback)(uCellTestPrivateSim_t *,
+                                                         const char *),
+                                void (*pRawCallback)(uCellTestPrivateSim_t *,
+                                                     const char *, size_t));
+
+/** Close a simulated module, calling uDeviceDeinit() and closing
+ * the UARTs; safe to call more than once and on a simulated module
+ * that was never opened, hence may be used in a clean-up test.
+ *
+ * @param pSim a pointer to the simulated module.
+ */
+//lint -esym(759, uCellTestPrivateSimClose) Suppress the "can be
+//lint -esym(765, uCellTestPrivateSimClose) made static" etc. which
+//lint -esym(714, uCellTestPrivateSimClose) will occur if
+//                                          U_CFG_TEST_UART_A/B are
+//                                          not defined
+void uCellTestPrivateSimClose(uCellTestPrivateSim_t *pSim);
+
+/** Send data from a simulated module to the cellular side.
+ *
+ * @param pSim    a pointer to the simulated module.
+ * @param pData   the data to send.
+ * @param length  the number of bytes at pData.
+ */
+//lint -esym(759, uCellTestPrivateSimSend) Suppress the "can be
+//lint -esym(765, uCellTestPrivateSimSend) made static" etc. which
+//lint -esym(714, uCellTestPrivateSimSend) will occur if
+//                                         U_CFG_TEST_UART_A/B are
+//                                         not defined
+void uCellTestPrivateSimSend(uCellTestPrivateSim_t *pSim,
+                             const char *pData, size_t length);
+
+/** Send a string from a simulated module to the cellular side.
+ *
+ * @param pSim     a pointer to the simulated module.
+ * @param pString  the null-terminated string to send.
+ */
+//lint -esym(759, uCellTestPrivateSimSendString) Suppress the "can be
+//lint -esym(765, uCellTestPrivateSimSendString) made static" etc. which
+//lint -esym(714, uCellTestPrivateSimSendString) will occur if
+//                                               U_CFG_TEST_UART_A/B
+//                                               are not defined
+void uCellTestPrivateSimSendString(uCellTestPrivateSim_t *pSim,
+                                   const char *pString);
+
 #ifdef __cplusplus
 }
 #endif
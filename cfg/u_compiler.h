@@ -125,6 +125,19 @@
 #define U_ATOMIC_GET(pPtr) __atomic_load_n(pPtr, __ATOMIC_SEQ_CST)
 #endif
 
+/** U_ATOMIC_SET: set the value of a variable atomically.
+ */
+#ifdef _MSC_VER
+/** Microsoft Visual C++ definition; stores (of volatiles) are
+ * atomic on x86_64.
+ */
+# define U_ATOMIC_SET(pPtr, value) *(pPtr) = (value)
+#else
+/** Default (GCC) definition.
+ */
+#define U_ATOMIC_SET(pPtr, value) __atomic_store_n(pPtr, value, __ATOMIC_SEQ_CST)
+#endif
+
 /** U_ATOMIC_INCREMENT: increment a variable atomically and return
  * its new value.
  */
@@ -355,6 +355,28 @@ extern "C" {
 # define U_AT_CLIENT_STREAM_READ_RETRY_DELAY_MS 10
 #endif
 
+#ifndef U_AT_CLIENT_LATENCY_HISTOGRAM_NUM_BUCKETS
+/** The number of buckets in the histogram of AT command latency,
+ * the time from the end of sending an AT command to the end of
+ * its response, see uAtClientLatencyHistogramGet().  Bucket zero
+ * counts latencies of less than 1 ms, bucket 1 1 ms, bucket 2
+ * 2 to 3 ms, bucket 3 4 to 7 ms, etc., the last bucket catching
+ * everything longer.
+ */
+# define U_AT_CLIENT_LATENCY_HISTOGRAM_NUM_BUCKETS 12
+#endif
+
+#ifndef U_AT_CLIENT_LATENCY_HISTOGRAM_NUM_COMMANDS
+/** The number of different AT commands, e.g. "AT+CSQ" or
+ * "AT+COPS", for which an AT client keeps a histogram of latency of
+ * its own, see uAtClientLatencyHistogramGet(); each costs
+ * #U_AT_CLIENT_LATENCY_HISTOGRAM_NUM_BUCKETS + 1 words in every AT
+ * client instance.  Commands beyond this number are counted only in
+ * the histogram of all commands.
+ */
+# define U_AT_CLIENT_LATENCY_HISTOGRAM_NUM_COMMANDS 8
+#endif
+
 #ifndef U_AT_CLIENT_URC_TASK_STACK_SIZE_BYTES
 /** The stack size for the URC task.  This is chosen to
  * work for all platforms, the governing factor being ESP32,
@@ -401,6 +423,29 @@ extern "C" {
 # define U_AT_CLIENT_CALLBACK_TASK_PRIORITY U_CFG_OS_APP_TASK_PRIORITY
 #endif
 
+#ifndef U_AT_CLIENT_ASYNC_TASK_STACK_SIZE_BYTES
+/** The stack size for the task, one per AT client, in which
+ * commands queued with uAtClientCommandAsync() are performed
+ * and their completion callbacks called.
+ */
+# define U_AT_CLIENT_ASYNC_TASK_STACK_SIZE_BYTES 2304
+#endif
+
+#ifndef U_AT_CLIENT_ASYNC_TASK_PRIORITY
+/** The priority of the task in which commands queued with
+ * uAtClientCommandAsync() are performed; this is the same as
+ * that of the callback task for the same reason.
+ */
+# define U_AT_CLIENT_ASYNC_TASK_PRIORITY U_CFG_OS_APP_TASK_PRIORITY
+#endif
+
+#ifndef U_AT_CLIENT_ASYNC_QUEUE_LENGTH
+/** The number of commands that may be waiting to be performed
+ * by uAtClientCommandAsync() on any one AT client.
+ */
+# define U_AT_CLIENT_ASYNC_QUEUE_LENGTH 10
+#endif
+
 #ifndef U_AT_CLIENT_MAX_NUM
 /** The maximum number of AT handlers that can be active at any
  * one time.
@@ -465,6 +510,13 @@ typedef struct {
     int32_t code;
 } uAtClientDeviceError_t;
 
+/** A block of data to be written by uAtClientWriteBytesV().
+ */
+typedef struct {
+    const char *pData;   /**< the bytes to be written. */
+    size_t lengthBytes;  /**< the number of bytes at pData. */
+} uAtClientIoVec_t;
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: INITIALISATION AND CONFIGURATION
  * -------------------------------------------------------------- */
@@ -703,7 +755,10 @@ int32_t uAtClientReadRetryDelayGet(const uAtClientHandle_t atHandle);
  * complete chunk of incoming data is available to parse,
  * avoiding "stutter".  This needs to be very short;
  * the default if this is not called is
- * #U_AT_CLIENT_STREAM_READ_RETRY_DELAY_MS.
+ * #U_AT_CLIENT_STREAM_READ_RETRY_DELAY_MS.  Where the
+ * stream has a data-received event the AT client waits
+ * for that event instead and this delay is only used
+ * when reading from within a URC handler.
  *
  * @param atHandle         the handle of the AT client.
  * @param readRetryDelayMs the read retry delay in
@@ -712,6 +767,45 @@ int32_t uAtClientReadRetryDelayGet(const uAtClientHandle_t atHandle);
 void uAtClientReadRetryDelaySet(uAtClientHandle_t atHandle,
                                 int32_t readRetryDelayMs);
 
+/** Get the histogram of AT command latency, the time from the end
+ * of sending an AT command to the end of its response, counted
+ * for every AT command that completes without error; see
+ * #U_AT_CLIENT_LATENCY_HISTOGRAM_NUM_BUCKETS for the meaning of
+ * each bucket.  A histogram is kept for all AT commands together
+ * and for each of the first
+ * #U_AT_CLIENT_LATENCY_HISTOGRAM_NUM_COMMANDS different AT commands
+ * sent, since the latency of, for instance, "AT+CSQ" has little in
+ * common with that of "AT+COPS=0"; an AT command is identified
+ * by the command string passed to uAtClientCommandStart() up to
+ * any "=" or "?", so "AT+COPS=0" and "AT+COPS?" are counted
+ * together as "AT+COPS".
+ *
+ * @param atHandle    the handle of the AT client.
+ * @param pCommand    the AT command to get the histogram for, e.g.
+ *                    "AT+COPS"; anything from "=" or "?" onwards
+ *                    is ignored.  Use NULL to get the histogram
+ *                    of all AT commands.  An AT command that has
+ *                    not been counted has a histogram of all zeroes.
+ * @param pHistogram  a place to put the histogram; cannot be NULL.
+ * @param numBuckets  the number of entries at pHistogram; if this
+ *                    is larger than
+ *                    #U_AT_CLIENT_LATENCY_HISTOGRAM_NUM_BUCKETS
+ *                    only that many will be written.
+ * @return            the number of entries written to pHistogram,
+ *                    else negative error code.
+ */
+int32_t uAtClientLatencyHistogramGet(const uAtClientHandle_t atHandle,
+                                     const char *pCommand,
+                                     uint32_t *pHistogram,
+                                     size_t numBuckets);
+
+/** Reset the histograms of AT command latency to all zeroes and
+ * forget the AT commands that have been counted.
+ *
+ * @param atHandle  the handle of the AT client.
+ */
+void uAtClientLatencyHistogramReset(uAtClientHandle_t atHandle);
+
 /** Set a callback that will be called when there has been
  * one or more consecutive AT command timeouts.  The callback
  * is called internally by the AT client using
@@ -919,6 +1013,30 @@ size_t uAtClientWriteBytes(uAtClientHandle_t atHandle,
                            size_t lengthBytes,
                            bool standalone);
 
+/** Write a number of separate blocks of bytes to the AT interface
+ * as if they were one contiguous block, e.g. an opening quote, a
+ * payload and a closing quote, without the caller having to copy
+ * them together.  This behaves exactly as uAtClientWriteBytes()
+ * called for each block in turn except that, where the AT client
+ * is on a UART and there is no transmit intercept function (e.g.
+ * no CMUX), the blocks are given to the UART in one go with
+ * uPortUartWriteV().
+ *
+ * @param atHandle     the handle of the AT client.
+ * @param[in] pIoVec   an array of the blocks of bytes to be
+ *                     written; blocks of zero length are
+ *                     ignored.
+ * @param count        the number of entries in pIoVec.
+ * @param standalone   as for uAtClientWriteBytes(); if this is
+ *                     false a delimiter is inserted, if required,
+ *                     before the first block only.
+ * @return             the total number of bytes written.
+ */
+size_t uAtClientWriteBytesV(uAtClientHandle_t atHandle,
+                            const uAtClientIoVec_t *pIoVec,
+                            size_t count,
+                            bool standalone);
+
 
 /** Write a part of a string argument to AT command sequence.
  * Used after uAtClientCommandStart() has been called to
@@ -1437,6 +1555,73 @@ int32_t uAtClientCallback(uAtClientHandle_t atHandle,
  */
 int32_t uAtClientCallbackStackMinFree();
 
+/** Queue an AT command sequence to be performed asynchronously.
+ * Each AT client has its own task, started the first time this
+ * function is called, which performs the queued commands one after
+ * the other, in the order they were queued: for each one it calls
+ * uAtClientLock(), then pCommand, which should send the command(s)
+ * and read the response(s) exactly as it would between
+ * uAtClientLock() and uAtClientUnlock() in synchronous code, then
+ * uAtClientUnlock() and then pDone with the value returned by
+ * uAtClientUnlock().  The caller does not wait for any of this.
+ *
+ * pCommand is called with the AT client locked and so must not
+ * lock any other mutex (e.g. that of the API using this AT client)
+ * that might be held by a task which is waiting for this AT
+ * client; pDone is called with the AT client unlocked, does not
+ * have that restriction and may call this function again, e.g. to
+ * chain a further command, though if the queue is full at that
+ * point an error will be returned rather than the task blocking on
+ * itself.
+ *
+ * If the AT client is removed, or uAtClientIgnoreAsync() is called,
+ * before a queued command has been performed then pCommand is
+ * not called for it but pDone still is, with
+ * #U_ERROR_COMMON_CANCELLED, so that anything behind pParam may
+ * be freed; atHandle must not be used in that case.  uAtClientRemove()
+ * waits for this to happen, and for any command that is in progress
+ * to complete, hence neither pCommand nor pDone may remove the AT
+ * client, whether directly with uAtClientRemove() or indirectly
+ * (e.g. by calling uCellRemove() or uCellDeinit() for a cellular
+ * instance that uses this AT client): if they do the task will wait
+ * on itself for ever, which is caught with an assert.  Should you
+ * need to remove the AT client as a result of a completion, pass
+ * the job to another task, e.g. with uAtClientCallback().
+ *
+ * @param atHandle       the handle of the AT client.
+ * @param[in] pCommand   the function that performs the command and
+ *                       parses the response, called with the AT
+ *                       handle and pParam; cannot be NULL.
+ * @param[in] pDone      the function to call when the command has
+ *                       been performed, called with the AT handle,
+ *                       the error code returned by uAtClientUnlock()
+ *                       (or #U_ERROR_COMMON_CANCELLED) and pParam;
+ *                       may be NULL.
+ * @param[in] pParam     a parameter to pass to pCommand and pDone,
+ *                       may be NULL.
+ * @return               zero on success else negative error code;
+ *                       if an error is returned neither pCommand
+ *                       nor pDone will be called.
+ */
+int32_t uAtClientCommandAsync(uAtClientHandle_t atHandle,
+                              void (*pCommand) (uAtClientHandle_t, void *),
+                              void (*pDone) (uAtClientHandle_t, int32_t, void *),
+                              void *pParam);
+
+/** Get the stack high watermark for the task of the given AT
+ * client which performs commands queued with uAtClientCommandAsync().
+ * If this gets close to zero you either need to do less in your
+ * command or completion functions or you need to increase
+ * #U_AT_CLIENT_ASYNC_TASK_STACK_SIZE_BYTES.
+ *
+ * @param atHandle  the handle of the AT client.
+ * @return          the minimum amount of free stack during the
+ *                  lifetime of the task in bytes, else negative
+ *                  error code (e.g. if uAtClientCommandAsync()
+ *                  has not yet been called for this AT client).
+ */
+int32_t uAtClientCommandAsyncStackMinFree(uAtClientHandle_t atHandle);
+
 /** It should NOT normally be necessary to use this, URCs should
  * be handled with the uAtClientSetUrcHandler() function since they
  * arrive asynchronously.  However, there are cases (e.g. in
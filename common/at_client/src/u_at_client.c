@@ -231,6 +231,53 @@
  */
 #define U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient)    uPortMutexUnlock(_mutex);  }
 
+#ifndef U_AT_CLIENT_URC_INDEX_NUM_BUCKETS
+/** The number of buckets in the index that is used to look up
+ * URC handlers by prefix; each bucket costs one pointer in every
+ * AT client instance.  Prefixes are hashed on their first
+ * #U_AT_CLIENT_URC_INDEX_KEY_LENGTH characters so that, when
+ * a line arrives, only the handlers whose prefixes share those
+ * characters need to be compared with it.
+ */
+# define U_AT_CLIENT_URC_INDEX_NUM_BUCKETS 16
+#endif
+
+#ifndef U_AT_CLIENT_URC_INDEX_KEY_LENGTH
+/** The number of characters at the start of a URC prefix which
+ * are hashed to select a bucket in the URC index; prefixes shorter
+ * than this are kept in a separate bucket of their own that is
+ * always searched.  Since almost all URCs begin with "+" and many
+ * with "+UU", this needs to be long enough to get past those.
+ */
+# define U_AT_CLIENT_URC_INDEX_KEY_LENGTH 5
+#endif
+
+#ifndef U_AT_CLIENT_WRITE_V_MAX_NUM
+/** The maximum number of blocks that uAtClientWriteBytesV() will
+ * pass to uPortUartWriteV() in one go; the array of blocks is
+ * converted on the stack so this should be kept modest.
+ */
+# define U_AT_CLIENT_WRITE_V_MAX_NUM 8
+#endif
+
+#ifndef U_AT_CLIENT_STREAM_READ_EVENT_DRIVEN
+/** Set this to 0 to have the AT client always block for the read
+ * retry delay (see uAtClientReadRetryDelaySet()) when there is
+ * nothing to read from the stream, rather than waiting for the
+ * data-received event of the stream.
+ */
+# define U_AT_CLIENT_STREAM_READ_EVENT_DRIVEN 1
+#endif
+
+#ifndef U_AT_CLIENT_STREAM_READ_EVENT_WAIT_MAX_MS
+/** When waiting for the data-received event of a stream, the
+ * longest to wait before looking at the stream again anyway,
+ * a safety net against a stream which does not deliver an
+ * event for every arrival of data; value in milliseconds.
+ */
+# define U_AT_CLIENT_STREAM_READ_EVENT_WAIT_MAX_MS 50
+#endif
+
 #ifndef U_AT_CLIENT_ACTIVITY_PIN_HYSTERESIS_INTERVAL_MS
 /** When performing hysteresis of the activity pin, the interval to use for each
  * wait step; value in milliseconds.
@@ -327,6 +374,11 @@ typedef struct uAtClientUrc_t {
     size_t prefixLength;       /** The length of pPrefix. */
     void (*pHandler) (uAtClientHandle_t, void *); /** The handler to call if pPrefix is matched. */
     void *pHandlerParam;       /** The parameter to pass to pHandler. */
+    size_t order;              /** Incremented for each URC handler added, used
+                                   to preserve the order of pUrcList when
+                                   picking between matches in different
+                                   buckets of the URC index. */
+    struct uAtClientUrc_t *pNextInBucket; /** The next entry in the same URC index bucket. */
     struct uAtClientUrc_t *pNext;
 } uAtClientUrc_t;
 
@@ -386,6 +438,16 @@ typedef struct {
     int32_t atClientMagicNumber;
 } uAtClientCallback_t;
 
+/** A command queued by uAtClientCommandAsync().
+ */
+typedef struct {
+    void (*pCommand) (uAtClientHandle_t, void *);
+    void (*pDone) (uAtClientHandle_t, int32_t, void *);
+    uAtClientHandle_t atHandle;
+    void *pParam;
+    int32_t atClientMagicNumber;
+} uAtClientAsync_t;
+
 /** Struct defining a wake-up handler.
  */
 typedef struct {
@@ -409,6 +471,13 @@ typedef struct {
     int32_t hysteresisMs;
 } uAtClientActivityPin_t;
 
+/** The histogram of latency of one AT command.
+ */
+typedef struct {
+    uint32_t commandHash; /** The hash of the AT command, see commandHash(). */
+    uint32_t histogram[U_AT_CLIENT_LATENCY_HISTOGRAM_NUM_BUCKETS]; /** Its latencies. */
+} uAtClientLatencyCommand_t;
+
 /** Struct defining a stack of mutexes.
  */
 typedef struct {
@@ -432,6 +501,17 @@ typedef struct uAtClientInstance_t {
     int32_t atTimeoutSavedMs; /** The saved AT timeout in milliseconds. */
     int32_t atUrcTimeoutMs; /** The AT timeout that will be used when in a URC. */
     int32_t atStreamReadRetryDelayMs; /**< The delay before re-reading the UART to avoid stutter. */
+    uPortSemaphoreHandle_t dataEventSemaphore; /** Given on every data-received event of
+                                                   the stream, NULL if there is none. */
+    int32_t commandStopTimeMs; /** The time the last command was sent. */
+    bool latencyPending; /** True if the response to the last command sent has
+                             not yet been added to latencyHistogram. */
+    uint32_t latencyHistogram[U_AT_CLIENT_LATENCY_HISTOGRAM_NUM_BUCKETS]; /** Command
+                                                                              latencies. */
+    uint32_t latencyCommandHash; /** The hash of the last command sent, see commandHash(). */
+    /** Command latencies for each of the first few different commands sent. */
+    uAtClientLatencyCommand_t latencyCommand[U_AT_CLIENT_LATENCY_HISTOGRAM_NUM_COMMANDS];
+    size_t latencyNumCommands; /** The number of entries of latencyCommand in use. */
     int32_t numConsecutiveAtTimeouts; /** The number of consecutive AT timeouts. */
     /** Callback to call if numConsecutiveAtTimeouts > 0. */
     void (*pConsecutiveTimeoutsCallback) (uAtClientHandle_t, int32_t *);
@@ -443,6 +523,12 @@ typedef struct uAtClientInstance_t {
     uAtClientTag_t stopTag; /** The stop tag for the current scope. */
     uAtClientUrc_t *pUrcList; /** Linked-list anchor for URC handlers. */
     uAtClientUrc_t *pUrcRead;  /** Pointer used when reading the URC handlers. */
+    /** Index of the entries in pUrcList by the hash of their prefix, the
+        last bucket being for prefixes shorter than
+        #U_AT_CLIENT_URC_INDEX_KEY_LENGTH; within a bucket the entries are
+        in the same order as they are in pUrcList. */
+    uAtClientUrc_t *pUrcIndex[U_AT_CLIENT_URC_INDEX_NUM_BUCKETS + 1];
+    size_t urcOrderNext; /** The order value to give the next URC handler added. */
     int32_t lastResponseStopMs; /** The time the last response ended in milliseconds. */
     int32_t lockTimeMs; /** The time when the stream was locked. */
     int32_t lastTxTimeMs; /** The time when the last transmit activity was carried out, set to -1 initially. */
@@ -468,6 +554,10 @@ typedef struct uAtClientInstance_t {
                                    as its fourth parameter. */
     uAtClientWakeUp_t *pWakeUp; /** Pointer to a wake-up handler structure. */
     uAtClientActivityPin_t *pActivityPin; /** Pointer to an activity pin structure. */
+    int32_t asyncEventQueueHandle; /** The event queue of uAtClientCommandAsync(), -1 if not open. */
+    uPortMutexHandle_t asyncMutex; /** Mutex to protect the async fields. */
+    size_t asyncPending; /** The number of commands queued by uAtClientCommandAsync() and not yet done. */
+    bool asyncClosing; /** Set when the AT client is being removed. */
     struct uAtClientInstance_t *pNext;
 } uAtClientInstance_t;
 
@@ -833,6 +923,62 @@ static void removeAtClientInstance(const uAtClientInstance_t *pClient)
     }
 }
 
+// Return the FNV-1a hash of the given characters.
+static uint32_t fnv1aHash(const char *pString, size_t length)
+{
+    uint32_t hash = 2166136261U;
+
+    for (size_t x = 0; x < length; x++) {
+        hash ^= (uint8_t) *(pString + x);
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+// Return the bucket in the URC index for the given string, which
+// may be a URC prefix or the start of the receive buffer.
+static size_t urcIndexBucket(const char *pString, size_t length)
+{
+    size_t bucket = U_AT_CLIENT_URC_INDEX_NUM_BUCKETS;
+
+    if (length >= U_AT_CLIENT_URC_INDEX_KEY_LENGTH) {
+        bucket = fnv1aHash(pString, U_AT_CLIENT_URC_INDEX_KEY_LENGTH) %
+                 U_AT_CLIENT_URC_INDEX_NUM_BUCKETS;
+    }
+
+    return bucket;
+}
+
+// Add a URC handler to the URC index; this is a push to the
+// front of the bucket, mirroring what is done to pUrcList.
+// urcPermittedMutex should be locked before this is called.
+static void urcIndexAdd(uAtClientInstance_t *pClient, uAtClientUrc_t *pUrc)
+{
+    uAtClientUrc_t **ppBucket = &(pClient->pUrcIndex[urcIndexBucket(pUrc->pPrefix,
+                                                                     pUrc->prefixLength)]);
+
+    pUrc->order = pClient->urcOrderNext;
+    pClient->urcOrderNext++;
+    pUrc->pNextInBucket = *ppBucket;
+    *ppBucket = pUrc;
+}
+
+// Remove a URC handler from the URC index.
+// urcPermittedMutex should be locked before this is called.
+static void urcIndexRemove(uAtClientInstance_t *pClient, const uAtClientUrc_t *pUrc)
+{
+    uAtClientUrc_t **ppCurrent = &(pClient->pUrcIndex[urcIndexBucket(pUrc->pPrefix,
+                                                                      pUrc->prefixLength)]);
+
+    while ((*ppCurrent != NULL) && (*ppCurrent != pUrc)) {
+        ppCurrent = &((*ppCurrent)->pNextInBucket);
+    }
+    if (*ppCurrent != NULL) {
+        *ppCurrent = pUrc->pNextInBucket;
+    }
+}
+
 // Remove an AT client.
 // gMutex should be locked before this is called.
 static void removeClient(uAtClientInstance_t *pClient)
@@ -846,6 +992,31 @@ static void removeClient(uAtClientInstance_t *pClient)
               // This just to unlock the mutex if the try succeeded
               (uPortMutexUnlock(pClient->pWakeUp->inWakeUpHandlerMutex) == 0)));
 
+    // Must not be in the task of uAtClientCommandAsync(), e.g. in
+    // a pDone callback, since below we wait for that task to finish
+    // the command it is running, which would be never
+    U_ASSERT((pClient->asyncEventQueueHandle < 0) ||
+             !uPortEventQueueIsTask(pClient->asyncEventQueueHandle));
+
+    // Let any asynchronous commands run out: the one in progress,
+    // if there is one, will complete and the rest will be
+    // cancelled; this must be done before the stream is locked
+    // since the command in progress will need it
+    uPortMutexLock(pClient->asyncMutex);
+    pClient->asyncClosing = true;
+    while (pClient->asyncPending > 0) {
+        uPortMutexUnlock(pClient->asyncMutex);
+        uPortTaskBlock(10);
+        uPortMutexLock(pClient->asyncMutex);
+    }
+    if (pClient->asyncEventQueueHandle >= 0) {
+        // This doesn't wait for the task to exit, which is
+        // fine since it has nothing more to do with us
+        uPortEventQueueClose(pClient->asyncEventQueueHandle);
+    }
+    uPortMutexUnlock(pClient->asyncMutex);
+    uPortMutexDelete(pClient->asyncMutex);
+
     // Avoid pulling the rug out from under a URC
     U_PORT_MUTEX_LOCK(pClient->urcPermittedMutex);
 
@@ -878,12 +1049,18 @@ static void removeClient(uAtClientInstance_t *pClient)
             break;
     }
 
+    // With the event handler gone nothing can give this now
+    if (pClient->dataEventSemaphore != NULL) {
+        uPortSemaphoreDelete(pClient->dataEventSemaphore);
+    }
+
     // Free any URC handlers it had.
     while (pClient->pUrcList != NULL) {
         pUrc = pClient->pUrcList;
         pClient->pUrcList = pUrc->pNext;
         uPortFree(pUrc);
     }
+    memset(pClient->pUrcIndex, 0, sizeof(pClient->pUrcIndex));
 
     // Remove any activity pin
     uPortFree(pClient->pActivityPin);
@@ -1353,9 +1530,89 @@ static void bufferRewind(const uAtClientInstance_t *pClient)
     }
 }
 
+// Return the latency histogram bucket for the given latency: bucket
+// zero is for less than 1 ms, bucket 1 for 1 ms, bucket 2 for
+// 2 to 3 ms, bucket 3 for 4 to 7 ms, etc., the last bucket catching
+// everything longer.
+static size_t latencyBucket(int32_t latencyMs)
+{
+    size_t bucket = 0;
+
+    while ((latencyMs > 0) &&
+           (bucket < U_AT_CLIENT_LATENCY_HISTOGRAM_NUM_BUCKETS - 1)) {
+        latencyMs >>= 1;
+        bucket++;
+    }
+
+    return bucket;
+}
+
+// Return the hash that identifies an AT command for the latency
+// histogram: that of the command string up to any "=" or "?", so
+// that "AT+COPS=0" and "AT+COPS?" are both "AT+COPS".
+static uint32_t commandHash(const char *pCommand)
+{
+    size_t length = 0;
+
+    if (pCommand != NULL) {
+        length = strcspn(pCommand, "=?");
+    }
+
+    return fnv1aHash(pCommand, length);
+}
+
+// Return the latency histogram of the AT command with the given hash,
+// adding it if it is new and there is room, else NULL.
+static uint32_t *pLatencyCommandHistogram(uAtClientInstance_t *pClient,
+                                          uint32_t commandHash, bool add)
+{
+    uint32_t *pHistogram = NULL;
+    uAtClientLatencyCommand_t *pLatencyCommand;
+
+    for (size_t x = 0; (pHistogram == NULL) && (x < pClient->latencyNumCommands); x++) {
+        pLatencyCommand = &(pClient->latencyCommand[x]);
+        if (pLatencyCommand->commandHash == commandHash) {
+            pHistogram = pLatencyCommand->histogram;
+        }
+    }
+    if ((pHistogram == NULL) && add &&
+        (pClient->latencyNumCommands < U_AT_CLIENT_LATENCY_HISTOGRAM_NUM_COMMANDS)) {
+        pLatencyCommand = &(pClient->latencyCommand[pClient->latencyNumCommands]);
+        pLatencyCommand->commandHash = commandHash;
+        memset(pLatencyCommand->histogram, 0, sizeof(pLatencyCommand->histogram));
+        pHistogram = pLatencyCommand->histogram;
+        pClient->latencyNumCommands++;
+    }
+
+    return pHistogram;
+}
+
+// Wait for data to arrive on the stream: if there is a data-received
+// event to wait on, and we're not in the callback that the event would
+// be delivered to, wait for the event, up to the AT timeout, else just
+// block for the read retry delay.
+static void streamWait(uAtClientInstance_t *pClient,
+                       bool eventIsCallback, int32_t atTimeoutMs)
+{
+    int32_t waitMs;
+
+    if ((pClient->dataEventSemaphore != NULL) && !eventIsCallback) {
+        waitMs = pollTimeRemaining(atTimeoutMs, pClient->lockTimeMs);
+        if (waitMs > U_AT_CLIENT_STREAM_READ_EVENT_WAIT_MAX_MS) {
+            waitMs = U_AT_CLIENT_STREAM_READ_EVENT_WAIT_MAX_MS;
+        }
+        if (waitMs > 0) {
+            uPortSemaphoreTryTake(pClient->dataEventSemaphore, waitMs);
+        }
+    } else {
+        uPortTaskBlock(pClient->atStreamReadRetryDelayMs);
+    }
+}
+
 // Read from the UART/serial interface in nice coherent lines.
 static int32_t serialReadNoStutter(uAtClientInstance_t *pClient,
                                    uAtClientBlockState_t blockState,
+                                   bool eventIsCallback,
                                    int32_t atTimeoutMs)
 {
     int32_t readLength = 0;
@@ -1387,19 +1644,26 @@ static int32_t serialReadNoStutter(uAtClientInstance_t *pClient,
             pBuffer += thisReadLength;
             bufferSize -= thisReadLength;
             if (blockState == U_AT_CLIENT_BLOCK_STATE_NOTHING_RECEIVED) {
-                // Got something: now wait for more
-                blockState = U_AT_CLIENT_BLOCK_STATE_WAIT_FOR_MORE;
-                uPortTaskBlock(pClient->atStreamReadRetryDelayMs);
+                if ((pClient->dataEventSemaphore != NULL) && !eventIsCallback) {
+                    // Got something and, since the data-received event
+                    // will wake us up promptly should the caller need
+                    // more, there is no need to hang around for it
+                    blockState = U_AT_CLIENT_BLOCK_STATE_DO_NOT_BLOCK;
+                } else {
+                    // Got something: now wait for more
+                    blockState = U_AT_CLIENT_BLOCK_STATE_WAIT_FOR_MORE;
+                    uPortTaskBlock(pClient->atStreamReadRetryDelayMs);
+                }
             }
         } else {
             if (blockState == U_AT_CLIENT_BLOCK_STATE_WAIT_FOR_MORE) {
                 // We were waiting for more but we have received nothing
                 // so stop blocking now
                 blockState = U_AT_CLIENT_BLOCK_STATE_DO_NOT_BLOCK;
-            } else {
-                uPortTaskBlock(pClient->atStreamReadRetryDelayMs);
+            } else if ((blockState == U_AT_CLIENT_BLOCK_STATE_NOTHING_RECEIVED) ||
+                       (pClient->dataEventSemaphore == NULL) || eventIsCallback) {
+                streamWait(pClient, eventIsCallback, atTimeoutMs);
             }
-
         }
     } while ((bufferSize > 0) &&
              (blockState != U_AT_CLIENT_BLOCK_STATE_DO_NOT_BLOCK) &&
@@ -1523,7 +1787,8 @@ static bool bufferFill(uAtClientInstance_t *pClient,
             case U_AT_CLIENT_STREAM_TYPE_UART:
             //fall-through
             case U_AT_CLIENT_STREAM_TYPE_VIRTUAL_SERIAL:
-                readLength = serialReadNoStutter(pClient, blockState, atTimeoutMs);
+                readLength = serialReadNoStutter(pClient, blockState,
+                                                 eventIsCallback, atTimeoutMs);
                 break;
             case U_AT_CLIENT_STREAM_TYPE_EDM:
                 readLength = uShortRangeEdmStreamAtRead(pClient->stream.handle.int32,
@@ -1673,7 +1938,14 @@ static bool bufferFill(uAtClientInstance_t *pClient,
         }
 
         LOG_BUFFER_FILL(14);
-        uPortTaskBlock(pClient->atStreamReadRetryDelayMs);
+        if ((pClient->dataEventSemaphore == NULL) || eventIsCallback) {
+            uPortTaskBlock(pClient->atStreamReadRetryDelayMs);
+        } else if ((readLength == 0) && blocking &&
+                   (pClient->stream.type == U_AT_CLIENT_STREAM_TYPE_EDM)) {
+            // Serial streams will already have waited for
+            // data in serialReadNoStutter(), EDM waits here
+            streamWait(pClient, eventIsCallback, atTimeoutMs);
+        }
     } while ((readLength == 0) &&
              (pollTimeRemaining(atTimeoutMs, pClient->lockTimeMs) > 0));
 
@@ -1893,49 +2165,83 @@ static void informationResponseStop(uAtClientInstance_t *pClient)
     }
 }
 
-// Iterate through URCs and check if one of them matches the current
-// contents of the receive buffer. If a URC is matched, set the
-// scope to information response and, after the URC's handler has
-// returned, finish off the information response scope by consuming
-// up to CR/LF.
+// Return the first URC handler in a bucket of the URC index whose
+// prefix is at the start of the receive buffer, without consuming it.
+static uAtClientUrc_t *pUrcIndexFind(uAtClientUrc_t *pBucket,
+                                     const char *pData, size_t length)
+{
+    uAtClientUrc_t *pFound = NULL;
+
+    for (uAtClientUrc_t *pUrc = pBucket;
+         (pFound == NULL) && (pUrc != NULL);
+         pUrc = pUrc->pNextInBucket) {
+        if ((length >= pUrc->prefixLength) &&
+            (memcmp(pData, pUrc->pPrefix, pUrc->prefixLength) == 0)) {
+            pFound = pUrc;
+        }
+    }
+
+    return pFound;
+}
+
+// Check if one of the URC handlers matches the current contents of
+// the receive buffer. If a URC is matched, set the scope to
+// information response and, after the URC's handler has returned,
+// finish off the information response scope by consuming up to CR/LF.
+// Rather than iterating through all of pUrcList, only the bucket of
+// the URC index that the start of the receive buffer hashes to and
+// the bucket of short prefixes are searched; if both produce a match
+// then the one nearest the front of pUrcList wins, as it would if
+// pUrcList were searched in order.
 static bool bufferMatchOneUrc(uAtClientInstance_t *pClient)
 {
-    size_t prefixLength = 0;
+    uAtClientReceiveBuffer_t *pReceiveBuffer = pClient->pReceiveBuffer;
+    const char *pData;
+    size_t length;
+    uAtClientUrc_t *pUrc;
+    uAtClientUrc_t *pUrcShort;
     bool found = false;
     int32_t now;
     uErrorCode_t savedError;
 
     bufferRewind(pClient);
 
-    for (uAtClientUrc_t *pUrc = pClient->pUrcList;
-         !found && (pUrc != NULL);
-         pUrc = pUrc->pNext) {
-        prefixLength = pUrc->prefixLength;
-        if (pClient->pReceiveBuffer->length >= prefixLength) {
-            // Do the check ignoring nulls at the start in case
-            // a URC is emitted near power-on which can suffer from
-            // such nulls
-            if (bufferMatch(pClient, pUrc->pPrefix, prefixLength, true)) {
-                setScope(pClient, U_AT_CLIENT_SCOPE_INFORMATION);
-                now = uPortGetTickTimeMs();
-                // Before heading off into URCness, save
-                // the current error state and reset
-                // it so that the URC doesn't suffer the error
-                savedError = pClient->error;
-                pClient->error = U_ERROR_COMMON_SUCCESS;
-                if (processAsync(pClient->magicNumber) && pUrc->pHandler) {
-                    pUrc->pHandler(pClient, pUrc->pHandlerParam);
-                }
-                informationResponseStop(pClient);
-                // Put the error state back again
-                pClient->error = savedError;
-                // Put the error state back again
-                // Add the amount of time spent in the URC
-                // world to the start time
-                pClient->lockTimeMs += uPortGetTickTimeMs() - now;
-                found = true;
-            }
+    pData = U_AT_CLIENT_DATA_BUFFER_PTR(pReceiveBuffer) + pReceiveBuffer->readIndex;
+    length = pReceiveBuffer->length - pReceiveBuffer->readIndex;
+    pUrc = NULL;
+    if (length >= U_AT_CLIENT_URC_INDEX_KEY_LENGTH) {
+        pUrc = pUrcIndexFind(pClient->pUrcIndex[urcIndexBucket(pData, length)],
+                             pData, length);
+    }
+    pUrcShort = pUrcIndexFind(pClient->pUrcIndex[U_AT_CLIENT_URC_INDEX_NUM_BUCKETS],
+                              pData, length);
+    if ((pUrc == NULL) ||
+        ((pUrcShort != NULL) && (pUrcShort->order > pUrc->order))) {
+        pUrc = pUrcShort;
+    }
+
+    // Do the check ignoring nulls at the start in case
+    // a URC is emitted near power-on which can suffer from
+    // such nulls; this also consumes the prefix
+    if ((pUrc != NULL) &&
+        bufferMatch(pClient, pUrc->pPrefix, pUrc->prefixLength, true)) {
+        setScope(pClient, U_AT_CLIENT_SCOPE_INFORMATION);
+        now = uPortGetTickTimeMs();
+        // Before heading off into URCness, save
+        // the current error state and reset
+        // it so that the URC doesn't suffer the error
+        savedError = pClient->error;
+        pClient->error = U_ERROR_COMMON_SUCCESS;
+        if (processAsync(pClient->magicNumber) && pUrc->pHandler) {
+            pUrc->pHandler(pClient, pUrc->pHandlerParam);
         }
+        informationResponseStop(pClient);
+        // Put the error state back again
+        pClient->error = savedError;
+        // Add the amount of time spent in the URC
+        // world to the start time
+        pClient->lockTimeMs += uPortGetTickTimeMs() - now;
+        found = true;
     }
 
     return found;
@@ -2209,7 +2515,8 @@ static bool processResponse(uAtClientInstance_t *pClient,
     return prefixMatched;
 }
 
-// Write data to the stream.
+// Call the wake-up handler, if there is one and the inactivity
+// timeout has expired, before data is written to the stream.
 //
 // Design note concerning the wake-up handler
 // process below; first the needs:
@@ -2233,6 +2540,79 @@ static bool processResponse(uAtClientInstance_t *pClient,
 // not match then it _also_ blocks on inWakeUpHandlerMutex
 // before proceeding, hence holding off processing until
 // the wake-up process has completed.
+static void wakeUpIfRequired(uAtClientInstance_t *pClient)
+{
+    int32_t savedLockTimeMs;
+    int32_t wakeUpDurationMs = 0;
+    uAtClientScope_t savedScope;
+    uAtClientTag_t savedStopTag;
+    bool savedDelimiterRequired;
+    uAtClientDeviceError_t savedDeviceError;
+
+    if ((pClient->pWakeUp != NULL) && (pClient->lastTxTimeMs >= 0) &&
+        (uPortGetTickTimeMs() - pClient->lastTxTimeMs > pClient->pWakeUp->inactivityTimeoutMs) &&
+        (uPortMutexTryLock(pClient->pWakeUp->inWakeUpHandlerMutex, 0) == 0)) {
+        // We have a wake-up handler, the inactivity timeout
+        // has expired and we've managed to lock the wake-up
+        // handler mutex (if we aren't able to lock the wake-up
+        // handler mutex  then we must already be in the wake-up
+        // handler, having recursed, so can just continue); now
+        // we need to call the wake-up handler function.
+        // Set wakeUpTask to the current task handle so
+        // that any future calls can be locked against the
+        // separate pWakeUp->mutex if they come from the task
+        // we're in at the moment, the one dealing with the wake-up
+        uPortTaskGetHandle(&(pClient->pWakeUp->wakeUpTask));
+        // The pClient->mutex will have been locked on the way
+        // into here by U_AT_CLIENT_LOCK_CLIENT_MUTEX.
+        // Remember the lock time and measure how long
+        // waking-up takes in order to correct for it
+        savedLockTimeMs = pClient->lockTimeMs;
+        wakeUpDurationMs = uPortGetTickTimeMs();
+        // Remember the dynamic things that the
+        // wake-up handler might overwrite
+        savedScope = pClient->scope;
+        savedStopTag = pClient->stopTag;
+        savedDelimiterRequired = pClient->delimiterRequired;
+        savedDeviceError = pClient->deviceError;
+        // Reset the scope, stopTag and delimiterRequired
+        pClient->scope = U_AT_CLIENT_SCOPE_NONE;
+        pClient->stopTag.pTagDef = &gNoStopTag;
+        pClient->stopTag.found = false;
+        pClient->delimiterRequired = false;
+        // Now actually call the wake-up callback which may recurse
+        // back into here
+        if (pClient->pWakeUp->pHandler((uAtClientHandle_t) pClient,
+                                       pClient->pWakeUp->pParam) != 0) {
+            setError(pClient, U_ERROR_COMMON_DEVICE_ERROR);
+        }
+        // At this point all of the calls back into here
+        // performed as part of the wake-up process will have
+        // been completed; there may have been calls from other
+        // tasks but they will have been blocked on the normal
+        // mutex before reaching here.
+        // We can now set the wakeUpTask back to NULL and all
+        // blocking will be on the normal mutex again
+        pClient->pWakeUp->wakeUpTask = NULL;
+        // Put all the saved things back
+        pClient->scope = savedScope;
+        pClient->stopTag = savedStopTag;
+        pClient->delimiterRequired = savedDelimiterRequired;
+        pClient->deviceError = savedDeviceError;
+        // Set the adjusted lock time, allowing for potential
+        // wrap in uPortGetTickTimeMs()
+        wakeUpDurationMs = uPortGetTickTimeMs() - wakeUpDurationMs;
+        if (wakeUpDurationMs > 0) {
+            pClient->lockTimeMs = savedLockTimeMs + wakeUpDurationMs;
+        } else {
+            pClient->lockTimeMs = uPortGetTickTimeMs();
+        }
+        // We are no longer in the wake-up handler
+        uPortMutexUnlock(pClient->pWakeUp->inWakeUpHandlerMutex);
+    }
+}
+
+// Write data to the stream.
 static size_t write(uAtClientInstance_t *pClient,
                     const char *pData, size_t length,
                     bool andFlush)
@@ -2249,78 +2629,12 @@ static size_t write(uAtClientInstance_t *pClient,
     // the ORing with andFlush below is confusing it?
     // codechecker_suppress [cppcheck-pointerOutOfBoundsCond] "pDataStart + length is not out of bounds"
     const char *pDataEnd = pDataStart + length;
-    int32_t savedLockTimeMs;
-    int32_t wakeUpDurationMs = 0;
-    uAtClientScope_t savedScope;
-    uAtClientTag_t savedStopTag;
-    bool savedDelimiterRequired;
-    uAtClientDeviceError_t savedDeviceError;
     uDeviceSerial_t *pDeviceSerial;
 
     while (((pData < pDataEnd) || andFlush) &&
            (pClient->error == U_ERROR_COMMON_SUCCESS)) {
         lengthToWrite = length - (pData - pDataStart);
-        if ((pClient->pWakeUp != NULL) && (pClient->lastTxTimeMs >= 0) &&
-            (uPortGetTickTimeMs() - pClient->lastTxTimeMs > pClient->pWakeUp->inactivityTimeoutMs) &&
-            (uPortMutexTryLock(pClient->pWakeUp->inWakeUpHandlerMutex, 0) == 0)) {
-            // We have a wake-up handler, the inactivity timeout
-            // has expired and we've managed to lock the wake-up
-            // handler mutex (if we aren't able to lock the wake-up
-            // handler mutex  then we must already be in the wake-up
-            // handler, having recursed, so can just continue); now
-            // we need to call the wake-up handler function.
-            // Set wakeUpTask to the current task handle so
-            // that any future calls can be locked against the
-            // separate pWakeUp->mutex if they come from the task
-            // we're in at the moment, the one dealing with the wake-up
-            uPortTaskGetHandle(&(pClient->pWakeUp->wakeUpTask));
-            // The pClient->mutex will have been locked on the way
-            // into here by U_AT_CLIENT_LOCK_CLIENT_MUTEX.
-            // Remember the lock time and measure how long
-            // waking-up takes in order to correct for it
-            savedLockTimeMs = pClient->lockTimeMs;
-            wakeUpDurationMs = uPortGetTickTimeMs();
-            // Remember the dynamic things that the
-            // wake-up handler might overwrite
-            savedScope = pClient->scope;
-            savedStopTag = pClient->stopTag;
-            savedDelimiterRequired = pClient->delimiterRequired;
-            savedDeviceError = pClient->deviceError;
-            // Reset the scope, stopTag and delimiterRequired
-            pClient->scope = U_AT_CLIENT_SCOPE_NONE;
-            pClient->stopTag.pTagDef = &gNoStopTag;
-            pClient->stopTag.found = false;
-            pClient->delimiterRequired = false;
-            // Now actually call the wake-up callback which may recurse
-            // back into here
-            if (pClient->pWakeUp->pHandler((uAtClientHandle_t) pClient,
-                                           pClient->pWakeUp->pParam) != 0) {
-                setError(pClient, U_ERROR_COMMON_DEVICE_ERROR);
-            }
-            // At this point all of the calls back into here
-            // performed as part of the wake-up process will have
-            // been completed; there may have been calls from other
-            // tasks but they will have been blocked on the normal
-            // mutex before reaching here.
-            // We can now set the wakeUpTask back to NULL and all
-            // blocking will be on the normal mutex again
-            pClient->pWakeUp->wakeUpTask = NULL;
-            // Put all the saved things back
-            pClient->scope = savedScope;
-            pClient->stopTag = savedStopTag;
-            pClient->delimiterRequired = savedDelimiterRequired;
-            pClient->deviceError = savedDeviceError;
-            // Set the adjusted lock time, allowing for potential
-            // wrap in uPortGetTickTimeMs()
-            wakeUpDurationMs = uPortGetTickTimeMs() - wakeUpDurationMs;
-            if (wakeUpDurationMs > 0) {
-                pClient->lockTimeMs = savedLockTimeMs + wakeUpDurationMs;
-            } else {
-                pClient->lockTimeMs = uPortGetTickTimeMs();
-            }
-            // We are no longer in the wake-up handler
-            uPortMutexUnlock(pClient->pWakeUp->inWakeUpHandlerMutex);
-        }
+        wakeUpIfRequired(pClient);
 
         if (pClient->error == U_ERROR_COMMON_SUCCESS) {
             if (pClient->pInterceptTx != NULL) {
@@ -2391,6 +2705,78 @@ static size_t write(uAtClientInstance_t *pClient,
     return length;
 }
 
+// Write a number of blocks of data to the stream; where the stream
+// is a UART and there is no transmit intercept function this is
+// done with a single call to uPortUartWriteV() per
+// U_AT_CLIENT_WRITE_V_MAX_NUM blocks, otherwise it is just the same
+// as calling write() for each block.
+// Returns the total number of bytes written.
+static size_t writeV(uAtClientInstance_t *pClient,
+                     const uAtClientIoVec_t *pIoVec, size_t count,
+                     bool andFlush)
+{
+    uPortUartIoVec_t uartIoVec[U_AT_CLIENT_WRITE_V_MAX_NUM];
+    size_t thisCount;
+    int32_t thisLengthWritten;
+    size_t lengthDone;
+    size_t length = 0;
+
+    if ((pClient->stream.type == U_AT_CLIENT_STREAM_TYPE_UART) &&
+        (pClient->pInterceptTx == NULL)) {
+        while ((count > 0) && (pClient->error == U_ERROR_COMMON_SUCCESS)) {
+            thisCount = count;
+            if (thisCount > U_AT_CLIENT_WRITE_V_MAX_NUM) {
+                thisCount = U_AT_CLIENT_WRITE_V_MAX_NUM;
+            }
+            for (size_t x = 0; x < thisCount; x++) {
+                uartIoVec[x].pBuffer = (pIoVec + x)->pData;
+                uartIoVec[x].sizeBytes = (pIoVec + x)->lengthBytes;
+            }
+            wakeUpIfRequired(pClient);
+            if (pClient->error == U_ERROR_COMMON_SUCCESS) {
+                thisLengthWritten = uPortUartWriteV(pClient->stream.handle.int32,
+                                                    uartIoVec, thisCount);
+                if (thisLengthWritten >= 0) {
+                    pClient->lastTxTimeMs = uPortGetTickTimeMs();
+                    // Print what was written and, should the write
+                    // have been short, let write() do the rest
+                    for (size_t x = 0; (x < thisCount) &&
+                         (pClient->error == U_ERROR_COMMON_SUCCESS); x++) {
+                        lengthDone = (pIoVec + x)->lengthBytes;
+                        if (lengthDone > (size_t) thisLengthWritten) {
+                            lengthDone = (size_t) thisLengthWritten;
+                        }
+                        thisLengthWritten -= (int32_t) lengthDone;
+                        printAt(pClient, (pIoVec + x)->pData, lengthDone, true);
+                        length += lengthDone;
+                        if (lengthDone < (pIoVec + x)->lengthBytes) {
+                            length += write(pClient, (pIoVec + x)->pData + lengthDone,
+                                            (pIoVec + x)->lengthBytes - lengthDone,
+                                            false);
+                        }
+                    }
+                } else {
+                    setError(pClient, U_ERROR_COMMON_DEVICE_ERROR);
+                }
+            }
+            pIoVec += thisCount;
+            count -= thisCount;
+        }
+    } else {
+        for (size_t x = 0; (x < count) &&
+             (pClient->error == U_ERROR_COMMON_SUCCESS); x++) {
+            length += write(pClient, (pIoVec + x)->pData, (pIoVec + x)->lengthBytes,
+                            andFlush && (x == count - 1));
+        }
+    }
+
+    if (pClient->error != U_ERROR_COMMON_SUCCESS) {
+        length = 0;
+    }
+
+    return length;
+}
+
 // Do common checks before sending parameters
 // and also deal with the need for a delimiter.
 static bool writeCheckAndDelimit(uAtClientInstance_t *pClient)
@@ -2614,6 +3000,11 @@ static void urcCallback(const uAtClientStreamHandle_t *pStream,
           (pStream->handle.pDeviceSerial == pClient->stream.handle.pDeviceSerial)) ||
          ((pStream->type != U_AT_CLIENT_STREAM_TYPE_VIRTUAL_SERIAL) &&
           (pStream->handle.int32 == pClient->stream.handle.int32)))) {
+        if ((eventBitmask & U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED) &&
+            (pClient->dataEventSemaphore != NULL)) {
+            // Wake up anyone waiting for data in streamWait()
+            uPortSemaphoreGive(pClient->dataEventSemaphore);
+        }
         if (uPortMutexTryLock(pClient->urcPermittedMutex, 0) == 0) {
             if (pClient->pUrcHijackInt32 != NULL) {
                 // We've been hijacked, deprecated style, do that thing
@@ -2761,6 +3152,37 @@ static void eventQueueCallback(void *pParameters, size_t paramLength)
     }
 }
 
+// Event handler for the queue of uAtClientCommandAsync().
+// Note: since asyncPending counts this command, removeClient()
+// will wait for it and hence pClient remains valid throughout.
+static void asyncEventQueueCallback(void *pParameters, size_t paramLength)
+{
+    uAtClientAsync_t *pAsync = (uAtClientAsync_t *) pParameters;
+    uAtClientInstance_t *pClient;
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_CANCELLED;
+    bool closing;
+
+    (void) paramLength;
+
+    if (pAsync != NULL) {
+        pClient = (uAtClientInstance_t *) pAsync->atHandle;
+        U_PORT_MUTEX_LOCK(pClient->asyncMutex);
+        closing = pClient->asyncClosing;
+        U_PORT_MUTEX_UNLOCK(pClient->asyncMutex);
+        if (!closing && processAsync(pAsync->atClientMagicNumber)) {
+            uAtClientLock(pAsync->atHandle);
+            pAsync->pCommand(pAsync->atHandle, pAsync->pParam);
+            errorCode = uAtClientUnlock(pAsync->atHandle);
+        }
+        if (pAsync->pDone != NULL) {
+            pAsync->pDone(pAsync->atHandle, errorCode, pAsync->pParam);
+        }
+        U_PORT_MUTEX_LOCK(pClient->asyncMutex);
+        pClient->asyncPending--;
+        U_PORT_MUTEX_UNLOCK(pClient->asyncMutex);
+    }
+}
+
 // Add an AT client.
 static uAtClientHandle_t clientAdd(const uAtClientStreamHandle_t *pStream,
                                    void *pReceiveBuffer,
@@ -2798,7 +3220,8 @@ static uAtClientHandle_t clientAdd(const uAtClientStreamHandle_t *pStream,
                     // Create the mutexes
                     if ((uPortMutexCreate(&(pClient->mutex)) == 0) &&
                         (uPortMutexCreate(&(pClient->streamMutex)) == 0) &&
-                        (uPortMutexCreate(&(pClient->urcPermittedMutex)) == 0)) {
+                        (uPortMutexCreate(&(pClient->urcPermittedMutex)) == 0) &&
+                        (uPortMutexCreate(&(pClient->asyncMutex)) == 0)) {
                         // Set all the non-zero initial values before we set
                         // the event handlers which might call us
                         pClient->newSendNextTime = true;
@@ -2807,6 +3230,13 @@ static uAtClientHandle_t clientAdd(const uAtClientStreamHandle_t *pStream,
                         pClient->atTimeoutSavedMs = -1;
                         pClient->atUrcTimeoutMs = U_AT_CLIENT_URC_TIMEOUT_MS;
                         pClient->atStreamReadRetryDelayMs = U_AT_CLIENT_STREAM_READ_RETRY_DELAY_MS;
+#if U_AT_CLIENT_STREAM_READ_EVENT_DRIVEN
+                        // If this fails we just fall back to
+                        // waiting for the read retry delay
+                        if (uPortSemaphoreCreate(&(pClient->dataEventSemaphore), 0, 1) != 0) {
+                            pClient->dataEventSemaphore = NULL;
+                        }
+#endif
                         pClient->delimiter = U_AT_CLIENT_DEFAULT_DELIMITER;
                         mutexStackInit(&(pClient->lockedStreamMutexStack));
                         pClient->delayMs = U_AT_CLIENT_DEFAULT_DELAY_MS;
@@ -2814,6 +3244,7 @@ static uAtClientHandle_t clientAdd(const uAtClientStreamHandle_t *pStream,
                         // This will also set stopTag
                         setScope(pClient, U_AT_CLIENT_SCOPE_NONE);
                         pClient->lastTxTimeMs = -1;
+                        pClient->asyncEventQueueHandle = -1;
                         pClient->urcMaxStringLength = U_AT_CLIENT_INITIAL_URC_LENGTH;
                         pClient->maxRespLength = U_AT_CLIENT_MAX_LENGTH_INFORMATION_RESPONSE_PREFIX;
                         // Set up the buffer and its protection markers
@@ -2860,6 +3291,12 @@ static uAtClientHandle_t clientAdd(const uAtClientStreamHandle_t *pStream,
 
                 if (errorCode != 0) {
                     // Clean up on failure
+                    if (pClient->dataEventSemaphore != NULL) {
+                        uPortSemaphoreDelete(pClient->dataEventSemaphore);
+                    }
+                    if (pClient->asyncMutex != NULL) {
+                        uPortMutexDelete(pClient->asyncMutex);
+                    }
                     if (pClient->urcPermittedMutex != NULL) {
                         uPortMutexDelete(pClient->urcPermittedMutex);
                     }
@@ -3183,6 +3620,57 @@ void uAtClientReadRetryDelaySet(uAtClientHandle_t atHandle,
     }
 }
 
+// Get the command latency histogram.
+int32_t uAtClientLatencyHistogramGet(const uAtClientHandle_t atHandle,
+                                     const char *pCommand,
+                                     uint32_t *pHistogram,
+                                     size_t numBuckets)
+{
+    int32_t errorCodeOrNumBuckets = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+    const uint32_t *pSource;
+
+    if ((pClient != NULL) && (pHistogram != NULL)) {
+        if (numBuckets > U_AT_CLIENT_LATENCY_HISTOGRAM_NUM_BUCKETS) {
+            numBuckets = U_AT_CLIENT_LATENCY_HISTOGRAM_NUM_BUCKETS;
+        }
+
+        U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+        pSource = pClient->latencyHistogram;
+        if (pCommand != NULL) {
+            pSource = pLatencyCommandHistogram(pClient, commandHash(pCommand), false);
+        }
+        if (pSource != NULL) {
+            memcpy(pHistogram, pSource, numBuckets * sizeof(pHistogram[0]));
+        } else {
+            memset(pHistogram, 0, numBuckets * sizeof(pHistogram[0]));
+        }
+
+        U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+
+        errorCodeOrNumBuckets = (int32_t) numBuckets;
+    }
+
+    return errorCodeOrNumBuckets;
+}
+
+// Reset the command latency histograms.
+void uAtClientLatencyHistogramReset(uAtClientHandle_t atHandle)
+{
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+
+    if (pClient != NULL) {
+
+        U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+        memset(pClient->latencyHistogram, 0, sizeof(pClient->latencyHistogram));
+        pClient->latencyNumCommands = 0;
+
+        U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+    }
+}
+
 // Set a callback to be called on consecutive AT timeouts.
 void uAtClientTimeoutCallbackSet(uAtClientHandle_t atHandle,
                                  void (*pCallback) (uAtClientHandle_t,
@@ -3394,6 +3882,7 @@ void uAtClientCommandStart(uAtClientHandle_t atHandle,
 
         // Send the command, no delimiter at first
         pClient->delimiterRequired = false;
+        pClient->latencyCommandHash = commandHash(pCommand);
         // Note: allow pCommand to be NULL here only
         // because that is useful during testing
         if (pCommand != NULL) {
@@ -3499,6 +3988,32 @@ size_t uAtClientWriteBytes(uAtClientHandle_t atHandle,
     return writeLength;
 }
 
+// Write a number of blocks of bytes.
+size_t uAtClientWriteBytesV(uAtClientHandle_t atHandle,
+                            const uAtClientIoVec_t *pIoVec,
+                            size_t count,
+                            bool standalone)
+{
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+    size_t writeLength = 0;
+
+    U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+    // Do write check and delimit if required, else
+    // just check for errors
+    if ((pIoVec != NULL) &&
+        (standalone || writeCheckAndDelimit(pClient)) &&
+        (pClient->error == U_ERROR_COMMON_SUCCESS)) {
+        // writeV() will set device error if there's a problem
+        // If this is a standalone write, do a flush also
+        writeLength = writeV(pClient, pIoVec, count, standalone);
+    }
+
+    U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+
+    return writeLength;
+}
+
 void uAtClientWritePartialString(uAtClientHandle_t atHandle,
                                  bool isFirst,
                                  const char *pParam)
@@ -3540,6 +4055,9 @@ void uAtClientCommandStop(uAtClientHandle_t atHandle)
         write(pClient, U_AT_CLIENT_COMMAND_DELIMITER,
               U_AT_CLIENT_COMMAND_DELIMITER_LENGTH_BYTES,
               true);
+        // Start the clock for the latency histogram
+        pClient->commandStopTimeMs = uPortGetTickTimeMs();
+        pClient->latencyPending = true;
     }
 
     U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
@@ -3774,6 +4292,8 @@ int32_t uAtClientReadHexData(uAtClientHandle_t atHandle,
 void uAtClientResponseStop(uAtClientHandle_t atHandle)
 {
     uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+    size_t bucket;
+    uint32_t *pHistogram;
 
     U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
 
@@ -3788,6 +4308,16 @@ void uAtClientResponseStop(uAtClientHandle_t atHandle)
 
     pClient->lastResponseStopMs = uPortGetTickTimeMs();
 
+    if (pClient->latencyPending && (pClient->error == U_ERROR_COMMON_SUCCESS)) {
+        bucket = latencyBucket(pClient->lastResponseStopMs - pClient->commandStopTimeMs);
+        pClient->latencyHistogram[bucket]++;
+        pHistogram = pLatencyCommandHistogram(pClient, pClient->latencyCommandHash, true);
+        if (pHistogram != NULL) {
+            pHistogram[bucket]++;
+        }
+    }
+    pClient->latencyPending = false;
+
     U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
 }
 
@@ -4052,6 +4582,7 @@ int32_t uAtClientSetUrcHandler(uAtClientHandle_t atHandle,
 
         pUrc->pNext = pClient->pUrcList;
         pClient->pUrcList = pUrc;
+        urcIndexAdd(pClient, pUrc);
 
         U_PORT_MUTEX_UNLOCK(pClient->urcPermittedMutex);
     }
@@ -4083,6 +4614,7 @@ void uAtClientRemoveUrcHandler(uAtClientHandle_t atHandle,
             } else {
                 pClient->pUrcList = pCurrent->pNext;
             }
+            urcIndexRemove(pClient, pCurrent);
 
             U_PORT_MUTEX_UNLOCK(pClient->urcPermittedMutex);
 
@@ -4216,6 +4748,91 @@ int32_t uAtClientCallbackStackMinFree()
     return sizeOrErrorCode;
 }
 
+// Queue a command to be performed asynchronously.
+int32_t uAtClientCommandAsync(uAtClientHandle_t atHandle,
+                              void (*pCommand) (uAtClientHandle_t, void *),
+                              void (*pDone) (uAtClientHandle_t, int32_t, void *),
+                              void *pParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+    uAtClientAsync_t async = {0}; // Keep Valgrind happy
+    int32_t eventQueueHandle = -1;
+
+    if ((pClient != NULL) && (pCommand != NULL)) {
+
+        U_PORT_MUTEX_LOCK(pClient->asyncMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_CANCELLED;
+        if (!pClient->asyncClosing) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            if (pClient->asyncEventQueueHandle < 0) {
+                errorCode = uPortEventQueueOpen(asyncEventQueueCallback,
+                                                "atAsync", sizeof(uAtClientAsync_t),
+                                                U_AT_CLIENT_ASYNC_TASK_STACK_SIZE_BYTES,
+                                                U_AT_CLIENT_ASYNC_TASK_PRIORITY,
+                                                U_AT_CLIENT_ASYNC_QUEUE_LENGTH);
+                if (errorCode >= 0) {
+                    pClient->asyncEventQueueHandle = errorCode;
+                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                }
+            }
+            if (errorCode == 0) {
+                eventQueueHandle = pClient->asyncEventQueueHandle;
+                // Count the command now, so that the AT client
+                // can't be removed from under us while we send it
+                pClient->asyncPending++;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(pClient->asyncMutex);
+
+        if (eventQueueHandle >= 0) {
+            // Send outside the lock since this may block if the
+            // queue is full, but not if we are the task at the
+            // end of the queue, which would never unblock
+            if (uPortEventQueueIsTask(eventQueueHandle) &&
+                (uPortEventQueueGetFree(eventQueueHandle) == 0)) {
+                errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            } else {
+                async.pCommand = pCommand;
+                async.pDone = pDone;
+                async.atHandle = atHandle;
+                async.pParam = pParam;
+                async.atClientMagicNumber = pClient->magicNumber;
+                errorCode = uPortEventQueueSend(eventQueueHandle, &async, sizeof(async));
+            }
+            if (errorCode != 0) {
+                U_PORT_MUTEX_LOCK(pClient->asyncMutex);
+                pClient->asyncPending--;
+                U_PORT_MUTEX_UNLOCK(pClient->asyncMutex);
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Get the stack high watermark for the asynchronous command task.
+int32_t uAtClientCommandAsyncStackMinFree(uAtClientHandle_t atHandle)
+{
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+
+    if (pClient != NULL) {
+
+        U_PORT_MUTEX_LOCK(pClient->asyncMutex);
+
+        if (pClient->asyncEventQueueHandle >= 0) {
+            sizeOrErrorCode = uPortEventQueueStackMinFree(pClient->asyncEventQueueHandle);
+        }
+
+        U_PORT_MUTEX_UNLOCK(pClient->asyncMutex);
+    }
+
+    return sizeOrErrorCode;
+}
+
 // Handle a URC "in-line".
 int32_t uAtClientUrcDirect(uAtClientHandle_t atHandle,
                            const char *pPrefix,
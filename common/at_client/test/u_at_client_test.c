@@ -57,6 +57,8 @@
 
 #include "u_test_util_resource_check.h"
 
+#include "u_interface.h"
+
 #include "u_at_client.h"
 #include "u_at_client_test.h"
 #include "u_at_client_test_data.h"
@@ -136,6 +138,46 @@
  * we need room for initial and trailing line endings. */
 #define U_AT_CLIENT_TEST_AT_BUFFER_LENGTH_BYTES (256 + 4 + U_AT_CLIENT_BUFFER_OVERHEAD_BYTES)
 
+/** The number of commands to queue in the asynchronous test.
+ */
+#define U_AT_CLIENT_TEST_ASYNC_NUM_COMMANDS 5
+
+/** The amount of data to write in the uAtClientWriteBytesV() test:
+ * several times the UART buffer length so that the receiving end,
+ * which reads slowly, holds the writer up.
+ */
+#define U_AT_CLIENT_TEST_WRITE_V_LENGTH_BYTES (U_CFG_TEST_UART_BUFFER_LENGTH_BYTES * 4)
+
+/** The most that the receiving end of the uAtClientWriteBytesV()
+ * test reads in one go.
+ */
+#define U_AT_CLIENT_TEST_WRITE_V_READ_LENGTH_BYTES 128
+
+/** How long to wait for everything to arrive in the
+ * uAtClientWriteBytesV() test.
+ */
+#define U_AT_CLIENT_TEST_WRITE_V_WAIT_MS 5000
+
+/** The number of URC handlers to register in the URC storm test,
+ * including the two that the storm is made of.
+ */
+#define U_AT_CLIENT_TEST_URC_STORM_NUM_HANDLERS 48
+
+/** The number of URCs in one replay of the URC storm.
+ */
+#define U_AT_CLIENT_TEST_URC_STORM_NUM_URCS 200
+
+/** The number of times the URC storm is replayed for each
+ * measurement in the URC storm test.
+ */
+#define U_AT_CLIENT_TEST_URC_STORM_NUM_REPLAYS 500
+
+/** The number of measurements of each kind that are added
+ * together in the URC storm test, done alternately so that
+ * a slow patch on the host doesn't favour one over the other.
+ */
+#define U_AT_CLIENT_TEST_URC_STORM_NUM_ROUNDS 4
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -152,6 +194,34 @@ typedef struct {
     int32_t responseLastError;
 } uAtClientTestCheckCommandResponse_t;
 
+/** Context for one command queued by uAtClientCommandAsync()
+ * during testing.
+ */
+typedef struct {
+    int32_t value;    /**< the value to send. */
+    int32_t valueRead;
+    int32_t errorCode;
+    size_t doneCount; /**< incremented each time pDone is called. */
+    size_t doneOrder; /**< the order in which pDone was called. */
+} uAtClientTestAsync_t;
+
+/** The receiving end of the uAtClientWriteBytesV() test.
+ */
+typedef struct {
+    char *pBuffer;
+    size_t size;
+    volatile size_t length;
+} uAtClientTestWriteV_t;
+
+/** Context for the virtual serial device that replays a stored
+ * stream of AT responses, see urcStormSerialInit().
+ */
+typedef struct {
+    const char *pData;
+    size_t length;
+    size_t readIndex;
+} uAtClientTestReplay_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -164,6 +234,10 @@ static int32_t gUartAHandle = -1;
  */
 static int32_t gUartBHandle = -1;
 
+/** The virtual serial device used to replay AT responses.
+ */
+static uDeviceSerial_t *gpReplaySerial = NULL;
+
 #if (U_CFG_TEST_UART_A >= 0)
 
 /** Store the last consecutive AT time-out call-back here.
@@ -180,6 +254,10 @@ static char gAtServerBuffer[1024];
  */
 static const char *gpInterceptTxDataLast = NULL;
 
+/** The number of times asyncDone() has been called.
+ */
+static volatile size_t gAsyncDoneCount = 0;
+
 # endif
 #endif
 
@@ -187,6 +265,200 @@ static const char *gpInterceptTxDataLast = NULL;
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Read function of the replaying virtual serial device.
+static int32_t replaySerialRead(struct uDeviceSerial_t *pDeviceSerial,
+                                void *pBuffer, size_t sizeBytes)
+{
+    uAtClientTestReplay_t *pReplay = (uAtClientTestReplay_t *)
+                                     pUInterfaceContext(pDeviceSerial);
+
+    if (sizeBytes > pReplay->length - pReplay->readIndex) {
+        sizeBytes = pReplay->length - pReplay->readIndex;
+    }
+    memcpy(pBuffer, pReplay->pData + pReplay->readIndex, sizeBytes);
+    pReplay->readIndex += sizeBytes;
+
+    return (int32_t) sizeBytes;
+}
+
+// Get-receive-size function of the replaying virtual serial device.
+static int32_t replaySerialGetReceiveSize(struct uDeviceSerial_t *pDeviceSerial)
+{
+    uAtClientTestReplay_t *pReplay = (uAtClientTestReplay_t *)
+                                     pUInterfaceContext(pDeviceSerial);
+
+    return (int32_t) (pReplay->length - pReplay->readIndex);
+}
+
+// Write function of the replaying virtual serial device: whatever
+// the AT client sends is thrown away.
+static int32_t replaySerialWrite(struct uDeviceSerial_t *pDeviceSerial,
+                                 const void *pBuffer, size_t sizeBytes)
+{
+    (void) pDeviceSerial;
+    (void) pBuffer;
+    return (int32_t) sizeBytes;
+}
+
+// Event callback set function of the replaying virtual serial
+// device: no events are ever raised, hence everything that is
+// replayed is handled in the thread of whoever has the AT client
+// locked, with nothing else going on.
+static int32_t replaySerialEventCallbackSet(struct uDeviceSerial_t *pDeviceSerial,
+                                            uint32_t filter,
+                                            void (*pFunction)(struct uDeviceSerial_t *,
+                                                              uint32_t,
+                                                              void *),
+                                            void *pParam,
+                                            size_t stackSizeBytes,
+                                            int32_t priority)
+{
+    (void) pDeviceSerial;
+    (void) filter;
+    (void) pFunction;
+    (void) pParam;
+    (void) stackSizeBytes;
+    (void) priority;
+    return 0;
+}
+
+// Populate the vector table of the replaying virtual serial device.
+static void replaySerialInit(struct uDeviceSerial_t *pDeviceSerial)
+{
+    uAtClientTestReplay_t *pReplay = (uAtClientTestReplay_t *)
+                                     pUInterfaceContext(pDeviceSerial);
+
+    pDeviceSerial->getReceiveSize = replaySerialGetReceiveSize;
+    pDeviceSerial->read = replaySerialRead;
+    pDeviceSerial->write = replaySerialWrite;
+    pDeviceSerial->eventCallbackSet = replaySerialEventCallbackSet;
+
+    pReplay->pData = NULL;
+    pReplay->length = 0;
+    pReplay->readIndex = 0;
+}
+
+// Replay pData, which must end with "OK", as the response to
+// the AT command pCommand; returns the AT client error code.
+static int32_t replay(uAtClientHandle_t atClientHandle, const char *pCommand,
+                      const char *pData, size_t length)
+{
+    uAtClientTestReplay_t *pReplay = (uAtClientTestReplay_t *)
+                                     pUInterfaceContext(gpReplaySerial);
+
+    pReplay->pData = pData;
+    pReplay->length = length;
+    pReplay->readIndex = 0;
+
+    uAtClientLock(atClientHandle);
+    uAtClientCommandStart(atClientHandle, pCommand);
+    uAtClientCommandStopReadResponse(atClientHandle);
+    return uAtClientUnlock(atClientHandle);
+}
+
+// URC handler that counts the URCs it is called for.
+static void urcCountHandler(uAtClientHandle_t atClientHandle, void *pParameters)
+{
+    (void) atClientHandle;
+    (*((size_t *) pParameters))++;
+}
+
+// Register the handlers of the URC storm test: the two that the
+// storm is made of first, so that they are furthest from the
+// front of the list, then the fillers, which never match.
+// Returns zero on success else negative error code.
+static int32_t urcStormHandlersSet(uAtClientHandle_t atClientHandle,
+                                   size_t *pCount, const char *pFillerFormat1,
+                                   const char *pFillerFormat2)
+{
+    int32_t errorCode;
+    char prefix[16];
+
+    errorCode = uAtClientSetUrcHandler(atClientHandle, "+UUSORD:",
+                                       urcCountHandler, pCount);
+    if (errorCode == 0) {
+        errorCode = uAtClientSetUrcHandler(atClientHandle, "+UUMQTTC:",
+                                           urcCountHandler, pCount);
+    }
+    for (size_t x = 0; (errorCode == 0) &&
+         (x < U_AT_CLIENT_TEST_URC_STORM_NUM_HANDLERS - 2); x++) {
+        snprintf(prefix, sizeof(prefix), (x & 1) ? pFillerFormat2 : pFillerFormat1,
+                 (int) x);
+        errorCode = uAtClientSetUrcHandler(atClientHandle, prefix,
+                                           urcCountHandler, pCount);
+    }
+
+    return errorCode;
+}
+
+// Remove the handlers registered by urcStormHandlersSet().
+static void urcStormHandlersRemove(uAtClientHandle_t atClientHandle,
+                                   const char *pFillerFormat1,
+                                   const char *pFillerFormat2)
+{
+    char prefix[16];
+
+    uAtClientRemoveUrcHandler(atClientHandle, "+UUSORD:");
+    uAtClientRemoveUrcHandler(atClientHandle, "+UUMQTTC:");
+    for (size_t x = 0; x < U_AT_CLIENT_TEST_URC_STORM_NUM_HANDLERS - 2; x++) {
+        snprintf(prefix, sizeof(prefix), (x & 1) ? pFillerFormat2 : pFillerFormat1,
+                 (int) x);
+        uAtClientRemoveUrcHandler(atClientHandle, prefix);
+    }
+}
+
+// Replay the URC storm U_AT_CLIENT_TEST_URC_STORM_NUM_REPLAYS times;
+// returns how long it took in milliseconds or negative error code
+// if a replay failed or not every URC was handled.
+static int32_t urcStormReplay(uAtClientHandle_t atClientHandle,
+                              const char *pStorm, size_t length,
+                              size_t *pCount)
+{
+    int32_t errorCodeOrTimeMs = 0;
+    int32_t startTimeMs = uPortGetTickTimeMs();
+
+    *pCount = 0;
+    for (size_t x = 0; (errorCodeOrTimeMs == 0) &&
+         (x < U_AT_CLIENT_TEST_URC_STORM_NUM_REPLAYS); x++) {
+        errorCodeOrTimeMs = replay(atClientHandle, "AT", pStorm, length);
+    }
+    if (errorCodeOrTimeMs == 0) {
+        errorCodeOrTimeMs = uPortGetTickTimeMs() - startTimeMs;
+        if (*pCount != U_AT_CLIENT_TEST_URC_STORM_NUM_URCS *
+            U_AT_CLIENT_TEST_URC_STORM_NUM_REPLAYS) {
+            U_TEST_PRINT_LINE("%d URC(s) handled, expected %d.", *pCount,
+                              U_AT_CLIENT_TEST_URC_STORM_NUM_URCS *
+                              U_AT_CLIENT_TEST_URC_STORM_NUM_REPLAYS);
+            errorCodeOrTimeMs = (int32_t) U_ERROR_COMMON_UNKNOWN;
+        }
+    }
+
+    return errorCodeOrTimeMs;
+}
+
+// Return the number of AT commands counted in the latency histogram
+// of the given AT command, NULL for all AT commands, or negative
+// error code.
+static int32_t latencyCount(uAtClientHandle_t atClientHandle, const char *pCommand)
+{
+    uint32_t histogram[U_AT_CLIENT_LATENCY_HISTOGRAM_NUM_BUCKETS];
+    int32_t errorCodeOrCount;
+
+    memset(histogram, 0xff, sizeof(histogram));
+    errorCodeOrCount = uAtClientLatencyHistogramGet(atClientHandle, pCommand, histogram,
+                                                    sizeof(histogram) / sizeof(histogram[0]));
+    if (errorCodeOrCount == sizeof(histogram) / sizeof(histogram[0])) {
+        errorCodeOrCount = 0;
+        for (size_t x = 0; x < sizeof(histogram) / sizeof(histogram[0]); x++) {
+            errorCodeOrCount += (int32_t) histogram[x];
+        }
+    } else if (errorCodeOrCount >= 0) {
+        errorCodeOrCount = (int32_t) U_ERROR_COMMON_UNKNOWN;
+    }
+
+    return errorCodeOrCount;
+}
+
 #if (U_CFG_TEST_UART_A >= 0)
 
 // AT consecutive timeout callback, used by some of the tests below
@@ -855,6 +1127,88 @@ static char *pInterceptRx(uAtClientHandle_t atHandle,
     return pData;
 }
 
+// Command function for uAtClientCommandAsync(): send a response,
+// which will be echoed back, and read it.
+static void asyncCommand(uAtClientHandle_t atHandle, void *pParam)
+{
+    uAtClientTestAsync_t *pAsync = (uAtClientTestAsync_t *) pParam;
+    char buffer[32];
+
+    snprintf(buffer, sizeof(buffer), "\r\n+ASYNC: %d\r\nOK\r\n", (int) pAsync->value);
+    uAtClientCommandStart(atHandle, buffer);
+    uAtClientCommandStop(atHandle);
+    uAtClientResponseStart(atHandle, "+ASYNC:");
+    pAsync->valueRead = uAtClientReadInt(atHandle);
+    uAtClientResponseStop(atHandle);
+}
+
+// The receiving end of the uAtClientWriteBytesV() test: collects
+// what arrives, a little at a time, so that the writer is held up.
+static void writeVServerCallback(int32_t uartHandle, uint32_t eventBitmask,
+                                 void *pParameters)
+{
+    uAtClientTestWriteV_t *pWriteV = (uAtClientTestWriteV_t *) pParameters;
+    size_t length;
+    int32_t sizeOrError;
+
+    if (eventBitmask & U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED) {
+        do {
+            length = pWriteV->size - pWriteV->length;
+            if (length > U_AT_CLIENT_TEST_WRITE_V_READ_LENGTH_BYTES) {
+                length = U_AT_CLIENT_TEST_WRITE_V_READ_LENGTH_BYTES;
+            }
+            sizeOrError = uPortUartRead(uartHandle, pWriteV->pBuffer + pWriteV->length,
+                                        length);
+            if (sizeOrError > 0) {
+                pWriteV->length += sizeOrError;
+                uPortTaskBlock(10);
+            }
+        } while (sizeOrError > 0);
+    }
+}
+
+// Wait for the receiving end of the uAtClientWriteBytesV() test to
+// have received pPrefix, pData and pPostfix and check that it has,
+// then reset it.
+static bool writeVCheck(uAtClientTestWriteV_t *pWriteV, const char *pPrefix,
+                        const char *pData, size_t length, const char *pPostfix)
+{
+    size_t lengthExpected = strlen(pPrefix) + length + strlen(pPostfix);
+    int32_t startTimeMs = uPortGetTickTimeMs();
+    bool success;
+
+    while ((pWriteV->length < lengthExpected) &&
+           (uPortGetTickTimeMs() - startTimeMs < U_AT_CLIENT_TEST_WRITE_V_WAIT_MS)) {
+        uPortTaskBlock(10);
+    }
+    // Make sure nothing more arrives
+    uPortTaskBlock(100);
+    U_TEST_PRINT_LINE("received %d byte(s) (expected %d) in %d ms.", pWriteV->length,
+                      lengthExpected, uPortGetTickTimeMs() - startTimeMs);
+    success = (pWriteV->length == lengthExpected) &&
+              (memcmp(pWriteV->pBuffer, pPrefix, strlen(pPrefix)) == 0) &&
+              (memcmp(pWriteV->pBuffer + strlen(pPrefix), pData, length) == 0) &&
+              (memcmp(pWriteV->pBuffer + strlen(pPrefix) + length, pPostfix,
+                      strlen(pPostfix)) == 0);
+    pWriteV->length = 0;
+
+    return success;
+}
+
+// Completion function for uAtClientCommandAsync().
+static void asyncDone(uAtClientHandle_t atHandle, int32_t errorCode,
+                      void *pParam)
+{
+    uAtClientTestAsync_t *pAsync = (uAtClientTestAsync_t *) pParam;
+
+    (void) atHandle;
+
+    pAsync->errorCode = errorCode;
+    pAsync->doneCount++;
+    pAsync->doneOrder = gAsyncDoneCount;
+    gAsyncDoneCount++;
+}
+
 # endif
 #endif
 
@@ -1046,6 +1400,256 @@ U_PORT_TEST_FUNCTION("[atClient]", "atClientInitialisation")
     uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
 }
 
+/** Check which URC handler is called when both a handler with a
+ * short prefix, which the URC index cannot hash, and one with a
+ * hashed prefix match a URC: it should be the one most recently
+ * set, as it would be if all of the handlers were searched in order.
+ */
+U_PORT_TEST_FUNCTION("[atClient]", "atClientUrcOrder")
+{
+    uAtClientHandle_t atClientHandle;
+    uAtClientStreamHandle_t stream = U_AT_CLIENT_STREAM_HANDLE_DEFAULTS;
+    const char urc[] = "\r\n+UUSORD: 0,1024\r\nOK\r\n";
+    size_t countShort = 0;
+    size_t countHashed = 0;
+    int32_t resourceCount;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+
+    gpReplaySerial = pUDeviceSerialCreate(replaySerialInit,
+                                          sizeof(uAtClientTestReplay_t));
+    U_PORT_TEST_ASSERT(gpReplaySerial != NULL);
+    stream.handle.pDeviceSerial = gpReplaySerial;
+    stream.type = U_AT_CLIENT_STREAM_TYPE_VIRTUAL_SERIAL;
+    atClientHandle = uAtClientAddExt(&stream, NULL, U_AT_CLIENT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atClientHandle != NULL);
+    uAtClientPrintAtSet(atClientHandle, false);
+
+    // Short prefix set first, hashed one second
+    U_PORT_TEST_ASSERT(uAtClientSetUrcHandler(atClientHandle, "+UU",
+                                              urcCountHandler, &countShort) == 0);
+    U_PORT_TEST_ASSERT(uAtClientSetUrcHandler(atClientHandle, "+UUSORD:",
+                                              urcCountHandler, &countHashed) == 0);
+    U_PORT_TEST_ASSERT(replay(atClientHandle, "AT", urc, sizeof(urc) - 1) == 0);
+    U_TEST_PRINT_LINE("short prefix set first: short %d, hashed %d.",
+                      countShort, countHashed);
+    U_PORT_TEST_ASSERT((countShort == 0) && (countHashed == 1));
+
+    // Set the short prefix again so that it is the most recent
+    countHashed = 0;
+    uAtClientRemoveUrcHandler(atClientHandle, "+UU");
+    U_PORT_TEST_ASSERT(uAtClientSetUrcHandler(atClientHandle, "+UU",
+                                              urcCountHandler, &countShort) == 0);
+    U_PORT_TEST_ASSERT(replay(atClientHandle, "AT", urc, sizeof(urc) - 1) == 0);
+    U_TEST_PRINT_LINE("short prefix set last: short %d, hashed %d.",
+                      countShort, countHashed);
+    U_PORT_TEST_ASSERT((countShort == 1) && (countHashed == 0));
+
+    // And the other way around again
+    countShort = 0;
+    uAtClientRemoveUrcHandler(atClientHandle, "+UUSORD:");
+    U_PORT_TEST_ASSERT(uAtClientSetUrcHandler(atClientHandle, "+UUSORD:",
+                                              urcCountHandler, &countHashed) == 0);
+    U_PORT_TEST_ASSERT(replay(atClientHandle, "AT", urc, sizeof(urc) - 1) == 0);
+    U_PORT_TEST_ASSERT((countShort == 0) && (countHashed == 1));
+
+    uAtClientDeinit();
+    uDeviceSerialDelete(gpReplaySerial);
+    gpReplaySerial = NULL;
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Replay a storm of +UUSORD/+UUMQTTC URCs with lots of URC handlers
+ * set, the two that match having been set first, and compare the
+ * time taken when the other handlers have prefixes that are spread
+ * across the URC index with that when they all start with the same
+ * five characters as one of the two, i.e. they land in the same
+ * bucket of the index and have to be searched one by one, as the
+ * whole list of handlers used to be; that is an underestimate of
+ * the cost of searching the whole list, since each of the two need
+ * only get past the half of the other handlers that share its
+ * bucket, not all of them.
+ */
+U_PORT_TEST_FUNCTION("[atClient]", "atClientUrcStorm")
+{
+    uAtClientHandle_t atClientHandle;
+    uAtClientStreamHandle_t stream = U_AT_CLIENT_STREAM_HANDLE_DEFAULTS;
+    char *pStorm;
+    size_t length = 0;
+    size_t count = 0;
+    int32_t x;
+    int32_t spreadTimeMs = 0;
+    int32_t sameBucketTimeMs = 0;
+    int32_t resourceCount;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+
+    // Make the storm, 20 bytes per URC is plenty
+    pStorm = (char *) pUPortMalloc((U_AT_CLIENT_TEST_URC_STORM_NUM_URCS * 20) + 8);
+    U_PORT_TEST_ASSERT(pStorm != NULL);
+    for (size_t y = 0; y < U_AT_CLIENT_TEST_URC_STORM_NUM_URCS; y++) {
+        if (y & 1) {
+            length += snprintf(pStorm + length, 20, "\r\n+UUMQTTC: %d,1\r\n",
+                               (int) (y % 10));
+        } else {
+            length += snprintf(pStorm + length, 20, "\r\n+UUSORD: %d,%d\r\n",
+                               (int) (y % 7), (int) y);
+        }
+    }
+    length += snprintf(pStorm + length, 8, "\r\nOK\r\n");
+
+    gpReplaySerial = pUDeviceSerialCreate(replaySerialInit,
+                                          sizeof(uAtClientTestReplay_t));
+    U_PORT_TEST_ASSERT(gpReplaySerial != NULL);
+    stream.handle.pDeviceSerial = gpReplaySerial;
+    stream.type = U_AT_CLIENT_STREAM_TYPE_VIRTUAL_SERIAL;
+    atClientHandle = uAtClientAddExt(&stream, NULL, U_AT_CLIENT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atClientHandle != NULL);
+    uAtClientPrintAtSet(atClientHandle, false);
+    // Nothing should get in the way of the URCs
+    uAtClientDelaySet(atClientHandle, 0);
+    uAtClientReadRetryDelaySet(atClientHandle, 0);
+
+    U_TEST_PRINT_LINE("replaying %d URC(s) %d times with %d URC handler(s) set...",
+                      U_AT_CLIENT_TEST_URC_STORM_NUM_URCS,
+                      U_AT_CLIENT_TEST_URC_STORM_NUM_REPLAYS,
+                      U_AT_CLIENT_TEST_URC_STORM_NUM_HANDLERS);
+    for (size_t y = 0; y < U_AT_CLIENT_TEST_URC_STORM_NUM_ROUNDS; y++) {
+        U_PORT_TEST_ASSERT(urcStormHandlersSet(atClientHandle, &count,
+                                               "+UX%02d:", "+UY%02d:") == 0);
+        x = urcStormReplay(atClientHandle, pStorm, length, &count);
+        U_PORT_TEST_ASSERT(x >= 0);
+        spreadTimeMs += x;
+        urcStormHandlersRemove(atClientHandle, "+UX%02d:", "+UY%02d:");
+
+        U_PORT_TEST_ASSERT(urcStormHandlersSet(atClientHandle, &count,
+                                               "+UUSO%02d:", "+UUMQ%02d:") == 0);
+        x = urcStormReplay(atClientHandle, pStorm, length, &count);
+        U_PORT_TEST_ASSERT(x >= 0);
+        sameBucketTimeMs += x;
+        urcStormHandlersRemove(atClientHandle, "+UUSO%02d:", "+UUMQ%02d:");
+    }
+
+    x = U_AT_CLIENT_TEST_URC_STORM_NUM_URCS * U_AT_CLIENT_TEST_URC_STORM_NUM_REPLAYS *
+        U_AT_CLIENT_TEST_URC_STORM_NUM_ROUNDS;
+    U_TEST_PRINT_LINE("%d URC(s) took %d ms (%d ns per URC) with the other"
+                      " handlers spread across the URC index.", x, spreadTimeMs,
+                      (int32_t) ((((int64_t) spreadTimeMs) * 1000000) / x));
+    U_TEST_PRINT_LINE("%d URC(s) took %d ms (%d ns per URC) with the other"
+                      " handlers in the same bucket.", x, sameBucketTimeMs,
+                      (int32_t) ((((int64_t) sameBucketTimeMs) * 1000000) / x));
+
+    uAtClientDeinit();
+    uDeviceSerialDelete(gpReplaySerial);
+    gpReplaySerial = NULL;
+    uPortFree(pStorm);
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Check that AT command latency is counted for each AT command,
+ * up to any "=" or "?", as well as for all AT commands together.
+ */
+U_PORT_TEST_FUNCTION("[atClient]", "atClientLatencyHistogram")
+{
+    uAtClientHandle_t atClientHandle;
+    uAtClientStreamHandle_t stream = U_AT_CLIENT_STREAM_HANDLE_DEFAULTS;
+    const char ok[] = "\r\nOK\r\n";
+    char command[16];
+    int32_t resourceCount;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+
+    gpReplaySerial = pUDeviceSerialCreate(replaySerialInit,
+                                          sizeof(uAtClientTestReplay_t));
+    U_PORT_TEST_ASSERT(gpReplaySerial != NULL);
+    stream.handle.pDeviceSerial = gpReplaySerial;
+    stream.type = U_AT_CLIENT_STREAM_TYPE_VIRTUAL_SERIAL;
+    atClientHandle = uAtClientAddExt(&stream, NULL, U_AT_CLIENT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atClientHandle != NULL);
+    uAtClientPrintAtSet(atClientHandle, false);
+    uAtClientDelaySet(atClientHandle, 0);
+
+    for (size_t x = 0; x < 3; x++) {
+        U_PORT_TEST_ASSERT(replay(atClientHandle, "AT+CSQ", ok, sizeof(ok) - 1) == 0);
+    }
+    U_PORT_TEST_ASSERT(replay(atClientHandle, "AT+COPS=0", ok, sizeof(ok) - 1) == 0);
+    U_PORT_TEST_ASSERT(replay(atClientHandle, "AT+COPS?", ok, sizeof(ok) - 1) == 0);
+    U_PORT_TEST_ASSERT(replay(atClientHandle, "AT+COPS?", ok, sizeof(ok) - 1) == 0);
+    U_PORT_TEST_ASSERT(latencyCount(atClientHandle, NULL) == 6);
+    U_PORT_TEST_ASSERT(latencyCount(atClientHandle, "AT+CSQ") == 3);
+    U_PORT_TEST_ASSERT(latencyCount(atClientHandle, "AT+COPS") == 3);
+    U_PORT_TEST_ASSERT(latencyCount(atClientHandle, "AT+COPS=2") == 3);
+    U_PORT_TEST_ASSERT(latencyCount(atClientHandle, "AT+CGMI") == 0);
+
+    // Fill up the rest of the AT commands that have a histogram
+    // of their own, and then one more, which is counted only
+    // with all of the AT commands
+    for (size_t x = 0; x < U_AT_CLIENT_LATENCY_HISTOGRAM_NUM_COMMANDS - 1; x++) {
+        snprintf(command, sizeof(command), "AT+X%d", (int) x);
+        U_PORT_TEST_ASSERT(replay(atClientHandle, command, ok, sizeof(ok) - 1) == 0);
+    }
+    U_PORT_TEST_ASSERT(latencyCount(atClientHandle, NULL) ==
+                       6 + U_AT_CLIENT_LATENCY_HISTOGRAM_NUM_COMMANDS - 1);
+    U_PORT_TEST_ASSERT(latencyCount(atClientHandle, "AT+X0") == 1);
+    snprintf(command, sizeof(command), "AT+X%d", U_AT_CLIENT_LATENCY_HISTOGRAM_NUM_COMMANDS - 3);
+    U_PORT_TEST_ASSERT(latencyCount(atClientHandle, command) == 1);
+    snprintf(command, sizeof(command), "AT+X%d", U_AT_CLIENT_LATENCY_HISTOGRAM_NUM_COMMANDS - 2);
+    U_PORT_TEST_ASSERT(latencyCount(atClientHandle, command) == 0);
+    U_PORT_TEST_ASSERT(latencyCount(atClientHandle, "AT+CSQ") == 3);
+
+    // Reset, after which there is room for new AT commands again
+    uAtClientLatencyHistogramReset(atClientHandle);
+    U_PORT_TEST_ASSERT(latencyCount(atClientHandle, NULL) == 0);
+    U_PORT_TEST_ASSERT(latencyCount(atClientHandle, "AT+CSQ") == 0);
+    U_PORT_TEST_ASSERT(replay(atClientHandle, command, ok, sizeof(ok) - 1) == 0);
+    U_PORT_TEST_ASSERT(latencyCount(atClientHandle, command) == 1);
+    U_PORT_TEST_ASSERT(latencyCount(atClientHandle, NULL) == 1);
+
+    uAtClientDeinit();
+    uDeviceSerialDelete(gpReplaySerial);
+    gpReplaySerial = NULL;
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
 #if (U_CFG_TEST_UART_A >= 0)
 /** Add an AT client then try getting and setting all of the
  * configuration items.  Requires one UART with no
@@ -1208,6 +1812,8 @@ U_PORT_TEST_FUNCTION("[atClient]", "atClientCommandSet1")
     char t = 'T';
     char r = 'R';
     bool restoreStopTag;
+    uint32_t latencyHistogram[U_AT_CLIENT_LATENCY_HISTOGRAM_NUM_BUCKETS];
+    uint32_t latencyCount = 0;
     int32_t resourceCount;
 
     memset(&checkCommandResponse, 0, sizeof(checkCommandResponse));
@@ -1526,6 +2132,20 @@ U_PORT_TEST_FUNCTION("[atClient]", "atClientCommandSet1")
                           checkUrc.lastError);
     }
 
+    // Print the AT command latencies, bucket n being for
+    // latencies up to (1 << n) - 1 milliseconds
+    y = uAtClientLatencyHistogramGet(atClientHandle, NULL, latencyHistogram,
+                                     sizeof(latencyHistogram) / sizeof(latencyHistogram[0]));
+    U_PORT_TEST_ASSERT(y == sizeof(latencyHistogram) / sizeof(latencyHistogram[0]));
+    U_TEST_PRINT_LINE("AT command latency histogram:");
+    for (size_t z = 0; z < sizeof(latencyHistogram) / sizeof(latencyHistogram[0]); z++) {
+        U_TEST_PRINT_LINE("  < %5d ms: %d.", 1 << z, latencyHistogram[z]);
+        latencyCount += latencyHistogram[z];
+    }
+    uAtClientLatencyHistogramReset(atClientHandle);
+    U_PORT_TEST_ASSERT(uAtClientLatencyHistogramGet(atClientHandle, NULL, latencyHistogram, 1) == 1);
+    U_PORT_TEST_ASSERT(latencyHistogram[0] == 0);
+
     // Check the stack extents for the URC and callbacks tasks
     checkStackExtents(atClientHandle);
 
@@ -1549,6 +2169,7 @@ U_PORT_TEST_FUNCTION("[atClient]", "atClientCommandSet1")
     U_PORT_TEST_ASSERT(checkUrc.count == U_AT_CLIENT_TEST_NUM_URCS_SET_1);
     U_PORT_TEST_ASSERT(checkUrc.passIndex == U_AT_CLIENT_TEST_NUM_URCS_SET_1);
     U_PORT_TEST_ASSERT(gConsecutiveTimeout == 0);
+    U_PORT_TEST_ASSERT(latencyCount > 0);
 
     // Check for resource leaks
     uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
@@ -1728,6 +2349,251 @@ U_PORT_TEST_FUNCTION("[atClient]", "atClientCommandSet2")
     U_PORT_TEST_ASSERT(resourceCount <= 0);
 }
 
+/** Test of uAtClientCommandAsync(): commands are queued without
+ * the caller waiting, are performed in order and are cancelled,
+ * with their completion callbacks still called, if the AT client
+ * is removed.
+ */
+U_PORT_TEST_FUNCTION("[atClient]", "atClientCommandAsync")
+{
+    uAtClientHandle_t atClientHandle;
+    uAtClientTestAsync_t async[U_AT_CLIENT_TEST_ASYNC_NUM_COMMANDS];
+    int32_t startTimeMs;
+    int32_t queueTimeMs;
+    int32_t stackMinFreeBytes;
+    size_t numCancelled = 0;
+    int32_t resourceCount;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    // Set up everything with the two UARTs
+    twoUartsPreamble();
+
+    // Echo back to the AT client what it sends
+    U_PORT_TEST_ASSERT(uPortUartEventCallbackSet(gUartBHandle,
+                                                 U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED,
+                                                 atEchoServerCallback, NULL,
+                                                 U_AT_CLIENT_URC_TASK_STACK_SIZE_BYTES,
+                                                 U_AT_CLIENT_URC_TASK_PRIORITY) == 0);
+
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+    atClientHandle = uAtClientAdd(gUartAHandle, U_AT_CLIENT_STREAM_TYPE_UART,
+                                  NULL, U_AT_CLIENT_TEST_AT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atClientHandle != NULL);
+    uAtClientTimeoutSet(atClientHandle, U_AT_CLIENT_TEST_AT_TIMEOUT_MS);
+
+    // Check parameters
+    U_PORT_TEST_ASSERT(uAtClientCommandAsync(NULL, asyncCommand, asyncDone, NULL) < 0);
+    U_PORT_TEST_ASSERT(uAtClientCommandAsync(atClientHandle, NULL, asyncDone, NULL) < 0);
+    // No task yet
+    U_PORT_TEST_ASSERT(uAtClientCommandAsyncStackMinFree(atClientHandle) < 0);
+
+    // Queue the commands: the caller should not have to wait for
+    // the round trips, each of which takes the echo server at
+    // least 100 ms
+    memset(async, 0, sizeof(async));
+    gAsyncDoneCount = 0;
+    startTimeMs = uPortGetTickTimeMs();
+    for (size_t x = 0; x < sizeof(async) / sizeof(async[0]); x++) {
+        async[x].value = (int32_t) x + 1;
+        async[x].errorCode = -1;
+        U_PORT_TEST_ASSERT(uAtClientCommandAsync(atClientHandle, asyncCommand,
+                                                 asyncDone, &(async[x])) == 0);
+    }
+    queueTimeMs = uPortGetTickTimeMs() - startTimeMs;
+    while ((gAsyncDoneCount < sizeof(async) / sizeof(async[0])) &&
+           (uPortGetTickTimeMs() - startTimeMs < U_AT_CLIENT_TEST_AT_TIMEOUT_MS *
+            U_AT_CLIENT_TEST_ASYNC_NUM_COMMANDS)) {
+        uPortTaskBlock(10);
+    }
+    U_TEST_PRINT_LINE("%d command(s) queued in %d ms, all done in %d ms.",
+                      sizeof(async) / sizeof(async[0]), queueTimeMs,
+                      uPortGetTickTimeMs() - startTimeMs);
+    U_PORT_TEST_ASSERT(gAsyncDoneCount == sizeof(async) / sizeof(async[0]));
+    U_PORT_TEST_ASSERT(queueTimeMs < 100);
+    for (size_t x = 0; x < sizeof(async) / sizeof(async[0]); x++) {
+        U_PORT_TEST_ASSERT(async[x].errorCode == 0);
+        U_PORT_TEST_ASSERT(async[x].valueRead == async[x].value);
+        U_PORT_TEST_ASSERT(async[x].doneCount == 1);
+        U_PORT_TEST_ASSERT(async[x].doneOrder == x);
+    }
+
+    stackMinFreeBytes = uAtClientCommandAsyncStackMinFree(atClientHandle);
+    if (stackMinFreeBytes != (int32_t) U_ERROR_COMMON_NOT_SUPPORTED) {
+        U_TEST_PRINT_LINE("asynchronous command task had min %d byte(s) stack"
+                          " free out of %d.", stackMinFreeBytes,
+                          U_AT_CLIENT_ASYNC_TASK_STACK_SIZE_BYTES);
+        U_PORT_TEST_ASSERT(stackMinFreeBytes > 0);
+    }
+
+    // Queue them again and remove the AT client straight away:
+    // every completion callback must still be called exactly once
+    memset(async, 0, sizeof(async));
+    gAsyncDoneCount = 0;
+    for (size_t x = 0; x < sizeof(async) / sizeof(async[0]); x++) {
+        async[x].value = (int32_t) x + 1;
+        async[x].errorCode = -1;
+        U_PORT_TEST_ASSERT(uAtClientCommandAsync(atClientHandle, asyncCommand,
+                                                 asyncDone, &(async[x])) == 0);
+    }
+    uAtClientRemove(atClientHandle);
+    U_PORT_TEST_ASSERT(gAsyncDoneCount == sizeof(async) / sizeof(async[0]));
+    for (size_t x = 0; x < sizeof(async) / sizeof(async[0]); x++) {
+        U_PORT_TEST_ASSERT(async[x].doneCount == 1);
+        if (async[x].errorCode == (int32_t) U_ERROR_COMMON_CANCELLED) {
+            numCancelled++;
+        } else {
+            U_PORT_TEST_ASSERT(async[x].errorCode == 0);
+            U_PORT_TEST_ASSERT(async[x].valueRead == async[x].value);
+        }
+    }
+    U_TEST_PRINT_LINE("%d of %d command(s) cancelled on removal.", numCancelled,
+                      sizeof(async) / sizeof(async[0]));
+    U_PORT_TEST_ASSERT(numCancelled > 0);
+
+    uAtClientDeinit();
+
+    uPortUartClose(gUartBHandle);
+    gUartBHandle = -1;
+    uPortUartClose(gUartAHandle);
+    gUartAHandle = -1;
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Test of uAtClientWriteBytesV(): several blocks, more than are
+ * passed to the UART in one go and including empty ones, adding up
+ * to more than the receiving end, which reads slowly, can buffer,
+ * so that a UART write which is bounded by its transmit buffer comes
+ * up short; written standalone, as part of an AT command and through
+ * a transmit intercept function, which takes the block-by-block path.
+ */
+U_PORT_TEST_FUNCTION("[atClient]", "atClientWriteBytesV")
+{
+    uAtClientHandle_t atClientHandle;
+    uAtClientTestWriteV_t writeV;
+    // Block lengths, the remainder goes in the last block
+    const size_t blockLength[] = {1, 0, 17, 256, 0, 3, U_CFG_TEST_UART_BUFFER_LENGTH_BYTES + 1,
+                                  2, 1, 100, 0
+                                 };
+    uAtClientIoVec_t ioVec[sizeof(blockLength) / sizeof(blockLength[0])];
+    char *pData;
+    size_t offset = 0;
+    char t = 'T';
+    int32_t resourceCount;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    pData = (char *) pUPortMalloc(U_AT_CLIENT_TEST_WRITE_V_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(pData != NULL);
+    for (size_t x = 0; x < U_AT_CLIENT_TEST_WRITE_V_LENGTH_BYTES; x++) {
+        *(pData + x) = (char) ('A' + (x % 26));
+    }
+    for (size_t x = 0; x < sizeof(ioVec) / sizeof(ioVec[0]); x++) {
+        ioVec[x].pData = pData + offset;
+        ioVec[x].lengthBytes = blockLength[x];
+        if (x == (sizeof(ioVec) / sizeof(ioVec[0])) - 1) {
+            ioVec[x].lengthBytes = U_AT_CLIENT_TEST_WRITE_V_LENGTH_BYTES - offset;
+        }
+        offset += ioVec[x].lengthBytes;
+    }
+    U_PORT_TEST_ASSERT(offset == U_AT_CLIENT_TEST_WRITE_V_LENGTH_BYTES);
+    // One empty block with no data at all
+    ioVec[1].pData = NULL;
+    memset(&writeV, 0, sizeof(writeV));
+    writeV.size = U_AT_CLIENT_TEST_WRITE_V_LENGTH_BYTES + 32;
+    writeV.pBuffer = (char *) pUPortMalloc(writeV.size);
+    U_PORT_TEST_ASSERT(writeV.pBuffer != NULL);
+
+    // Set up everything with the two UARTs
+    twoUartsPreamble();
+
+    U_PORT_TEST_ASSERT(uPortUartEventCallbackSet(gUartBHandle,
+                                                 U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED,
+                                                 writeVServerCallback, &writeV,
+                                                 U_AT_CLIENT_URC_TASK_STACK_SIZE_BYTES,
+                                                 U_AT_CLIENT_URC_TASK_PRIORITY) == 0);
+
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+    atClientHandle = uAtClientAdd(gUartAHandle, U_AT_CLIENT_STREAM_TYPE_UART,
+                                  NULL, U_AT_CLIENT_TEST_AT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atClientHandle != NULL);
+    uAtClientPrintAtSet(atClientHandle, false);
+
+    // Check parameters
+    uAtClientLock(atClientHandle);
+    U_PORT_TEST_ASSERT(uAtClientWriteBytesV(atClientHandle, NULL, 1, true) == 0);
+    U_PORT_TEST_ASSERT(uAtClientUnlock(atClientHandle) == 0);
+
+    U_TEST_PRINT_LINE("writing %d byte(s) in %d block(s), standalone...",
+                      U_AT_CLIENT_TEST_WRITE_V_LENGTH_BYTES, sizeof(ioVec) / sizeof(ioVec[0]));
+    uAtClientLock(atClientHandle);
+    U_PORT_TEST_ASSERT(uAtClientWriteBytesV(atClientHandle, ioVec,
+                                            sizeof(ioVec) / sizeof(ioVec[0]),
+                                            true) == U_AT_CLIENT_TEST_WRITE_V_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(uAtClientUnlock(atClientHandle) == 0);
+    U_PORT_TEST_ASSERT(writeVCheck(&writeV, "", pData, U_AT_CLIENT_TEST_WRITE_V_LENGTH_BYTES, ""));
+
+    // As a parameter of an AT command: there should be a
+    // delimiter before the first block and nowhere else
+    U_TEST_PRINT_LINE("writing them as an AT command parameter...");
+    uAtClientLock(atClientHandle);
+    uAtClientCommandStart(atClientHandle, "AT+WRITEV=");
+    uAtClientWriteInt(atClientHandle, 1);
+    U_PORT_TEST_ASSERT(uAtClientWriteBytesV(atClientHandle, ioVec,
+                                            sizeof(ioVec) / sizeof(ioVec[0]),
+                                            false) == U_AT_CLIENT_TEST_WRITE_V_LENGTH_BYTES);
+    uAtClientCommandStop(atClientHandle);
+    U_PORT_TEST_ASSERT(uAtClientUnlock(atClientHandle) == 0);
+    U_PORT_TEST_ASSERT(writeVCheck(&writeV, "AT+WRITEV=1,", pData,
+                                   U_AT_CLIENT_TEST_WRITE_V_LENGTH_BYTES,
+                                   U_AT_CLIENT_COMMAND_DELIMITER));
+
+    // Through a transmit intercept, which is not a UART write
+    U_TEST_PRINT_LINE("writing them through a transmit intercept...");
+    uAtClientLock(atClientHandle);
+    uAtClientStreamInterceptTx(atClientHandle, pInterceptTx, (void *) &t);
+    U_PORT_TEST_ASSERT(uAtClientWriteBytesV(atClientHandle, ioVec,
+                                            sizeof(ioVec) / sizeof(ioVec[0]),
+                                            true) == U_AT_CLIENT_TEST_WRITE_V_LENGTH_BYTES);
+    uAtClientStreamInterceptTx(atClientHandle, NULL, NULL);
+    U_PORT_TEST_ASSERT(uAtClientUnlock(atClientHandle) == 0);
+    U_PORT_TEST_ASSERT(writeVCheck(&writeV, "", pData, U_AT_CLIENT_TEST_WRITE_V_LENGTH_BYTES, ""));
+
+    uAtClientDeinit();
+
+    uPortUartClose(gUartBHandle);
+    gUartBHandle = -1;
+    uPortUartClose(gUartAHandle);
+    gUartAHandle = -1;
+
+    uPortFree(writeV.pBuffer);
+    uPortFree(pData);
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
 # endif
 #endif
 
@@ -1738,6 +2604,10 @@ U_PORT_TEST_FUNCTION("[atClient]", "atClientCommandSet2")
 U_PORT_TEST_FUNCTION("[atClient]", "atClientCleanUp")
 {
     uAtClientDeinit();
+    if (gpReplaySerial != NULL) {
+        uDeviceSerialDelete(gpReplaySerial);
+        gpReplaySerial = NULL;
+    }
     if (gUartAHandle >= 0) {
         uPortUartClose(gUartAHandle);
     }
@@ -130,6 +130,23 @@ extern "C" {
 # define U_GEOFENCE_SQUARE_EXTENT_CHECK_UNCERTAINTY_METRES 100
 #endif
 
+#ifndef U_GEOFENCE_FIXED_POINT_THRESHOLD_METRES
+/** Shapes no bigger than this, which are also small enough and far
+ * enough from a pole to be handled in flat X/Y space (see
+ * #U_GEOFENCE_WGS84_THRESHOLD_METRES), are given a local plane when
+ * their fence is first applied; positions near such a shape,
+ * with a radius of position small enough not to require WGS84,
+ * are then tested against it using integer arithmetic,
+ * which is much quicker than double-precision floating point on
+ * an MCU that has no double-precision FPU.  The outcome is the
+ * same as the flat X/Y calculation, distances agreeing to within
+ * a few millimetres or 0.1%, whichever is the larger.  Values
+ * above #U_GEOFENCE_WGS84_THRESHOLD_METRES have no further effect;
+ * set this to zero to always use floating point.
+ */
+# define U_GEOFENCE_FIXED_POINT_THRESHOLD_METRES 1000
+#endif
+
 #ifndef U_GEOFENCE_HORIZONTAL_SPEED_MILLIMETRES_PER_SECOND_MAX
 /** The maximum horizontal speed that anything is expected to
  * travel at in MILLIMETRES per second.
@@ -137,6 +154,51 @@ extern "C" {
 # define U_GEOFENCE_HORIZONTAL_SPEED_MILLIMETRES_PER_SECOND_MAX 500000LL
 #endif
 
+#ifndef U_GEOFENCE_INDEX_CELL_SIZE_DEGREES_FLOAT
+/** When geofences are applied to a device a spatial index is built
+ * over them so that, when a position arrives, fences that cannot
+ * possibly contain it are discarded without testing each of their
+ * shapes.  The index divides the earth into cells of this size,
+ * in degrees of latitude and longitude, at its finest level (see
+ * #U_GEOFENCE_INDEX_NUM_LEVELS); each shape is indexed at the finest
+ * level at which its square extent (see
+ * #U_GEOFENCE_SQUARE_EXTENT_CHECK_UNCERTAINTY_METRES) fits into a
+ * two by two block of cells, shapes too big for even the coarsest
+ * level cannot be indexed and their fence is always tested.  The
+ * default of 0.1 degrees is around 11 km at the equator.
+ */
+# define U_GEOFENCE_INDEX_CELL_SIZE_DEGREES_FLOAT 0.1
+#endif
+
+#ifndef U_GEOFENCE_INDEX_NUM_LEVELS
+/** The number of levels of cell size in the spatial index (see
+ * #U_GEOFENCE_INDEX_CELL_SIZE_DEGREES_FLOAT), each level having
+ * cells #U_GEOFENCE_INDEX_LEVEL_FACTOR times the size of those of
+ * the level below; with the defaults the cells are 0.1, 0.8, 6.4
+ * and 51.2 degrees.  A position is looked up once at each level.
+ */
+# define U_GEOFENCE_INDEX_NUM_LEVELS 4
+#endif
+
+#ifndef U_GEOFENCE_INDEX_LEVEL_FACTOR
+/** How many times larger the cells of the spatial index are at one
+ * level than at the level below, see #U_GEOFENCE_INDEX_NUM_LEVELS.
+ */
+# define U_GEOFENCE_INDEX_LEVEL_FACTOR 8
+#endif
+
+#ifndef U_GEOFENCE_INDEX_NUM_BUCKETS
+/** The number of buckets that the cells of the spatial index (see
+ * #U_GEOFENCE_INDEX_CELL_SIZE_DEGREES_FLOAT), at all levels, are
+ * hashed into.  The
+ * index costs one pointer per bucket for each device that has
+ * geofences applied, plus a linked-list entry for each bucket that
+ * each fence falls into.  More buckets mean fewer fences tested per
+ * position when many fences are applied.
+ */
+# define U_GEOFENCE_INDEX_NUM_BUCKETS 64
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -268,6 +330,18 @@ typedef void (uGeofenceCallback_t)(uDeviceHandle_t devHandle,
                                    int64_t distanceMillimetres,
                                    void *pCallbackParam);
 
+/** A position to be tested with uGeofenceTestBatch(); the fields
+ * have the same meaning as the parameters of the same name to
+ * uGeofenceTest().
+ */
+typedef struct {
+    int64_t latitudeX1e9;
+    int64_t longitudeX1e9;
+    int32_t altitudeMillimetres; /**< INT_MIN for a 2D position. */
+    int32_t radiusMillimetres; /**< -1 if not known. */
+    int32_t altitudeUncertaintyMillimetres; /**< -1 if not known. */
+} uGeofencePosition_t;
+
 /* ----------------------------------------------------------------
  * PRIVATE TYPES
  * -------------------------------------------------------------- */
@@ -560,6 +634,44 @@ bool uGeofenceTest(uGeofence_t *pFence, uGeofenceTestType_t testType,
                    int32_t radiusMillimetres,
                    int32_t altitudeUncertaintyMillimetres);
 
+/** Test a batch of positions against a geofence, e.g. when replaying
+ * a recorded track.  The outcome is exactly as if uGeofenceTest()
+ * had been called for each position in turn (so a transit test
+ * carries its memory from one position to the next) but the
+ * Geofence API is only entered, and its mutex only locked, once.
+ * As with uGeofenceTest(), no callbacks are called.
+ *
+ * @param[in] pFence                 a pointer to the geofence to test;
+ *                                   cannot be NULL.
+ * @param testType                   the type of test to perform.
+ * @param pessimisticNotOptimistic   as for uGeofenceTest().
+ * @param[in] pPositions             an array of numPositions positions
+ *                                   to test, latitude/longitude
+ *                                   multiplied by ten to the power nine,
+ *                                   as for uGeofenceTest(); cannot be NULL.
+ * @param numPositions               the number of entries in pPositions.
+ * @param[out] pTestIsMet            a pointer to an array of numPositions
+ *                                   entries where the outcome of the test
+ *                                   for each position, as would be returned
+ *                                   by uGeofenceTest(), will be written;
+ *                                   may be NULL.
+ * @param[out] pPositionState        a pointer to an array of numPositions
+ *                                   entries where the position state of
+ *                                   the fence after each position has been
+ *                                   tested, as would be returned by
+ *                                   uGeofenceTestGetPositionState(), will
+ *                                   be written; may be NULL.
+ * @return                           on success the number of positions
+ *                                   for which the test was met, else
+ *                                   negative error code.
+ */
+int32_t uGeofenceTestBatch(uGeofence_t *pFence, uGeofenceTestType_t testType,
+                           bool pessimisticNotOptimistic,
+                           const uGeofencePosition_t *pPositions,
+                           size_t numPositions,
+                           bool *pTestIsMet,
+                           uGeofencePositionState_t *pPositionState);
+
 /** When any function of the Geofence API is called it will ensure that
  * a mutex, used for thread-safety, has been created.  This mutex is
  * not intended to be free'd, ever.  However, if you are quite
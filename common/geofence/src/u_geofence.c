@@ -126,7 +126,29 @@
  *   under test,
  * - if shape under test is not eliminated and square extent of
  *   shape <= 1 km and radius of position <= 100 m then use less
- *   expensive, almost-trigonometry-less, "flat" X/Y maths.
+ *   expensive, almost-trigonometry-less, "flat" X/Y maths; once
+ *   the fence has been applied this is done in a local plane of
+ *   the shape, with its origin on the shape, entirely in integers.
+ *
+ * Since a device may have hundreds of geofences applied to it, a
+ * spatial index is also built when fences are applied: the earth is
+ * divided into cells, at several levels of cell size, hashed into
+ * buckets, and each bucket lists the fences with a shape whose square
+ * extent touches one of its cells, a shape being indexed at the level
+ * where its square extent fills no more than a two by two block of
+ * cells.  When the radius of position is small enough for square
+ * extent checks to be made, only the fences in the buckets that the
+ * position falls into at each level (plus any fences that cannot be
+ * indexed) are tested;
+ * every shape of the others would be eliminated by its square extent
+ * anyway, so the outcome for them is known to be "outside".
+ *
+ * Where the maximum horizontal speed of the device is known, the
+ * context also remembers, for each fence, a lower bound on the
+ * distance to the fence the last time the position was found, in
+ * full, to be outside it.  Until the device could have travelled
+ * that far, less the radius of position, the fence is known to be
+ * "outside" without being tested again.
  */
 
 #ifdef U_CFG_OVERRIDE
@@ -189,6 +211,53 @@
  */
 #define U_GEOFENCE_MAX_SQUARE_EXTENT_HALF_DIAGONAL_METRES 10000000LL
 
+/** The number of vertices that the array of vertices of a polygon
+ * is first allocated with; it is doubled in size as required and
+ * then trimmed to fit when the fence is first applied.
+ */
+#define U_GEOFENCE_POLYGON_NUM_VERTICES_INITIAL 4
+
+/** A margin, in degrees, added around the square extent of a shape
+ * when it is put into the spatial index, so that rounding can never
+ * place a position which is inside the square extent into a cell
+ * that the square extent was not indexed under.
+ */
+#define U_GEOFENCE_INDEX_MARGIN_DEGREES 0.000001
+
+/** The most cells of the spatial index that the square extent of
+ * a shape may cover at the level it is indexed at: a shape is
+ * indexed at the finest level at which it covers no more than this
+ * many, so that it lands in few buckets.
+ */
+#define U_GEOFENCE_INDEX_MAX_CELLS_PER_SHAPE 4
+
+/** The factor that a lower bound on the distance from a position to
+ * a fence is multiplied by before it is remembered, to allow for the
+ * difference between the spherical calculations used and reality:
+ * a degree of latitude at the equator is around 0.7% shorter than
+ * #U_GEOFENCE_METRES_PER_DEGREE_LATITUDE.
+ */
+#define U_GEOFENCE_DISTANCE_MIN_SAFETY_FACTOR 0.99
+
+/** The number of millimetres per degree along the longitudinal
+ * axis, for the local plane of a shape.
+ */
+#define U_GEOFENCE_MILLIMETRES_PER_DEGREE_LATITUDE (U_GEOFENCE_METRES_PER_DEGREE_LATITUDE * 1000LL)
+
+/** The furthest, in millimetres east or north, that a vertex of a
+ * shape or a position being tested may be from the origin of the
+ * local plane of the shape: this keeps all of the products in the
+ * local plane calculations within 64 bits.
+ */
+#define U_GEOFENCE_PLANE_LIMIT_MILLIMETRES (1LL << 24)
+
+/** The furthest, in degrees times ten to the power nine, that a
+ * position may be from the origin of the local plane of a shape
+ * for it to be worth converting into the plane at all; this keeps
+ * the conversion within 64 bits.
+ */
+#define U_GEOFENCE_PLANE_LIMIT_DEGREES_X1E9 10000000000LL
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -223,16 +292,70 @@ typedef struct {
     double radiusMetres;
 } uGeofenceCircle_t;
 
+/** Structure to hold a polygon: the vertices are held in a single
+ * contiguous array, rather than one allocation per vertex, so that
+ * the loops which test a position against each side of the polygon
+ * are a linear scan through memory.
+ */
+typedef struct {
+    uGeofenceCoordinates_t *pVertices; /**< an array of numVerticesAllocated
+                                            coordinates of which the
+                                            first numVertices are used. */
+    size_t numVertices;
+    size_t numVerticesAllocated;
+} uGeofencePolygon_t;
+
+/** Structure to hold a vertex of a polygon in the local plane of
+ * its shape, as an offset from the origin of the plane both in
+ * degrees times ten to the power nine, for the "point in polygon"
+ * test, which must give the same answer as the floating point one,
+ * and in millimetres, for distances.
+ */
+typedef struct {
+    int32_t latitudeX1e9;
+    int32_t longitudeX1e9;
+    int32_t yMillimetres;
+    int32_t xMillimetres;
+} uGeofencePlaneVertex_t;
+
+/** Structure to hold a position in the local plane of a shape,
+ * the fields as for #uGeofencePlaneVertex_t.
+ */
+typedef struct {
+    int64_t latitudeX1e9;
+    int64_t longitudeX1e9;
+    int64_t yMillimetres;
+    int64_t xMillimetres;
+} uGeofencePlanePosition_t;
+
+/** Structure to hold the local plane of a small shape, in which
+ * positions can be tested using integer arithmetic: the plane is
+ * flat, as for the X/Y calculations, with its origin at the centre
+ * of a circle or the first vertex of a polygon.
+ */
+typedef struct {
+    int64_t originLatitudeX1e9;
+    int64_t originLongitudeX1e9;
+    int32_t millimetresPerDegreeLongitude; /**< at the middle of the shape. */
+    int32_t radiusMillimetres; /**< circles only. */
+    uGeofencePlaneVertex_t *pVertices; /**< polygons only, an array of
+                                            the numVertices of the
+                                            polygon. */
+} uGeofencePlane_t;
+
 /** Structure to hold a shape.
  */
 typedef struct {
     uGeofenceShapeType_t type;
     union {
         uGeofenceCircle_t *pCircle;
-        uLinkedList_t *pPolygon; /**< a linked list containing uGeofenceCoordinates_t. */
+        uGeofencePolygon_t *pPolygon;
     } u;
     uGeofenceSquare_t squareExtent; /**< the square extent of the shape. */
     bool wgs84Required; /**< true if the shape is so big as to require WGS84 handling. */
+    uGeofencePlane_t *pPlane; /**< the local plane of the shape, NULL
+                                   if the shape is too big to have one
+                                   or its fence has not yet been applied. */
 } uGeofenceShape_t;
 
 #endif // U_CFG_GEOFENCE
@@ -287,21 +410,88 @@ static int32_t fenceNotInUse(uGeofence_t *pFence)
 }
 
 // Clear the map data contained in a polygon.
-static void fenceClearMapDataPolygon(uLinkedList_t **ppPolygon)
+static void fenceClearMapDataPolygon(uGeofencePolygon_t **ppPolygon)
 {
-    uLinkedList_t *pList;
-    uLinkedList_t *pListNext;
-    void *pVertex;
+    if ((ppPolygon != NULL) && (*ppPolygon != NULL)) {
+        uPortFree((*ppPolygon)->pVertices);
+        uPortFree(*ppPolygon);
+        *ppPolygon = NULL;
+    }
+}
 
-    if (ppPolygon != NULL) {
-        pList = *ppPolygon;
-        while (pList != NULL) {
-            pVertex = pList->p;
-            pListNext = pList->pNext;
-            uLinkedListRemove(ppPolygon, pVertex);
-            uPortFree(pVertex);
-            pList = pListNext;
+// Clear the local plane of a shape.
+static void fenceClearMapDataPlane(uGeofencePlane_t **ppPlane)
+{
+    if ((ppPlane != NULL) && (*ppPlane != NULL)) {
+        uPortFree((*ppPlane)->pVertices);
+        uPortFree(*ppPlane);
+        *ppPlane = NULL;
+    }
+}
+
+// Add a vertex to the end of a polygon, growing the array of
+// vertices if required; returns false if there is no memory.
+static bool polygonAddVertex(uGeofencePolygon_t *pPolygon,
+                             const uGeofenceCoordinates_t *pVertex)
+{
+    bool success = true;
+    size_t numVerticesAllocated;
+    uGeofenceCoordinates_t *pVertices;
+
+    if (pPolygon->numVertices >= pPolygon->numVerticesAllocated) {
+        numVerticesAllocated = pPolygon->numVerticesAllocated * 2;
+        if (numVerticesAllocated == 0) {
+            numVerticesAllocated = U_GEOFENCE_POLYGON_NUM_VERTICES_INITIAL;
+        }
+        pVertices = (uGeofenceCoordinates_t *) pUPortMalloc(numVerticesAllocated *
+                                                            sizeof(uGeofenceCoordinates_t));
+        success = (pVertices != NULL);
+        if (success) {
+            if (pPolygon->pVertices != NULL) {
+                memcpy(pVertices, pPolygon->pVertices,
+                       pPolygon->numVertices * sizeof(uGeofenceCoordinates_t));
+                uPortFree(pPolygon->pVertices);
+            }
+            pPolygon->pVertices = pVertices;
+            pPolygon->numVerticesAllocated = numVerticesAllocated;
+        }
+    }
+    if (success) {
+        pPolygon->pVertices[pPolygon->numVertices] = *pVertex;
+        pPolygon->numVertices++;
+    }
+
+    return success;
+}
+
+// Trim the vertex arrays of the polygons of a fence to fit; done when
+// the fence is first applied, since it can no longer be added to.
+static void fenceCompact(uGeofence_t *pFence)
+{
+    uLinkedList_t *pList = pFence->pShapes;
+    uGeofenceShape_t *pShape;
+    uGeofencePolygon_t *pPolygon;
+    uGeofenceCoordinates_t *pVertices;
+
+    while (pList != NULL) {
+        pShape = (uGeofenceShape_t *) pList->p;
+        if ((pShape != NULL) && (pShape->type == U_GEOFENCE_SHAPE_TYPE_POLYGON)) {
+            pPolygon = pShape->u.pPolygon;
+            if ((pPolygon->numVertices > 0) &&
+                (pPolygon->numVertices < pPolygon->numVerticesAllocated)) {
+                // If there's no memory for this we just keep what we have
+                pVertices = (uGeofenceCoordinates_t *) pUPortMalloc(pPolygon->numVertices *
+                                                                    sizeof(uGeofenceCoordinates_t));
+                if (pVertices != NULL) {
+                    memcpy(pVertices, pPolygon->pVertices,
+                           pPolygon->numVertices * sizeof(uGeofenceCoordinates_t));
+                    uPortFree(pPolygon->pVertices);
+                    pPolygon->pVertices = pVertices;
+                    pPolygon->numVerticesAllocated = pPolygon->numVertices;
+                }
+            }
         }
+        pList = pList->pNext;
     }
 }
 
@@ -328,6 +518,7 @@ static void fenceClearMapData(uGeofence_t *pFence)
                     default:
                         break;
                 }
+                fenceClearMapDataPlane(&(pShape->pPlane));
             }
             pListNext = pList->pNext;
             uLinkedListRemove(&(pFence->pShapes), pShape);
@@ -1001,7 +1192,7 @@ static void updateSquareExtentAndWgs84(uGeofenceShape_t *pShape)
             }
             break;
             case U_GEOFENCE_SHAPE_TYPE_POLYGON: {
-                uLinkedList_t *pList = pShape->u.pPolygon;
+                const uGeofencePolygon_t *pPolygon = pShape->u.pPolygon;
                 // Note: on the face of it, we could only work with the
                 // last vertex here, since all of the other vertices could
                 // already have been taken into account. However we need
@@ -1012,13 +1203,12 @@ static void updateSquareExtentAndWgs84(uGeofenceShape_t *pShape)
                 // is added.  It is not a huge overhead to do this when
                 // first adding a shape, much better than doing it on
                 // each position calculation
-                if (pList != NULL) {
-                    uGeofenceCoordinates_t *pVertex = (uGeofenceCoordinates_t *) pList->p;
+                if (pPolygon->numVertices > 0) {
+                    const uGeofenceCoordinates_t *pVertex = pPolygon->pVertices;
                     squareExtent.max = *pVertex;
                     squareExtent.min = *pVertex;
-                    pList = pList->pNext;
-                    while (pList != NULL) {
-                        pVertex = (uGeofenceCoordinates_t *) pList->p;
+                    for (size_t x = 1; x < pPolygon->numVertices; x++) {
+                        pVertex++;
                         if (pVertex->latitude > squareExtent.max.latitude) {
                             squareExtent.max.latitude = pVertex->latitude;
                         } else if (pVertex->latitude < squareExtent.min.latitude) {
@@ -1029,7 +1219,6 @@ static void updateSquareExtentAndWgs84(uGeofenceShape_t *pShape)
                         } else if (longitudeSubtract(squareExtent.min.longitude, pVertex->longitude) > 0) {
                             squareExtent.min.longitude = pVertex->longitude;
                         }
-                        pList = pList->pNext;
                     }
                 }
                 // Having done all that, work out the diagonal and decide if it is big enough
@@ -1070,6 +1259,579 @@ static void updateSquareExtentAndWgs84(uGeofenceShape_t *pShape)
 
 #endif // U_CFG_GEOFENCE
 
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: LOCAL PLANE
+ * -------------------------------------------------------------- */
+
+#ifdef U_CFG_GEOFENCE
+
+// The integer square root of a number, rounded down.
+static uint64_t squareRoot(uint64_t x)
+{
+    uint64_t root = 0;
+    uint64_t bit = 1ULL << 62;
+
+    while (bit > x) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (x >= root + bit) {
+            x -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return root;
+}
+
+// Convert a latitude or longitude in degrees back to degrees times
+// ten to the power nine, the form it was originally given in.
+static int64_t degreesToX1e9(double degrees)
+{
+    return (int64_t) ((degrees * 1000000000) + ((degrees < 0) ? -0.5 : 0.5));
+}
+
+// Convert a position into the local plane of a shape, returning
+// false if it is too far from the origin of the plane.
+static bool planeGetPosition(const uGeofencePlane_t *pPlane,
+                             int64_t latitudeX1e9, int64_t longitudeX1e9,
+                             uGeofencePlanePosition_t *pPosition)
+{
+    bool success = false;
+
+    pPosition->latitudeX1e9 = latitudeX1e9 - pPlane->originLatitudeX1e9;
+    pPosition->longitudeX1e9 = longitudeX1e9 - pPlane->originLongitudeX1e9;
+    // Take into account the wrap at 180, as longitudeSubtract() does
+    if (pPosition->longitudeX1e9 <= -U_GEOFENCE_LIMIT_LONGITUDE_DEGREES_X1E9) {
+        pPosition->longitudeX1e9 += U_GEOFENCE_LIMIT_LONGITUDE_DEGREES_X1E9 * 2;
+    } else if (pPosition->longitudeX1e9 >= U_GEOFENCE_LIMIT_LONGITUDE_DEGREES_X1E9) {
+        pPosition->longitudeX1e9 -= U_GEOFENCE_LIMIT_LONGITUDE_DEGREES_X1E9 * 2;
+    }
+    if ((pPosition->latitudeX1e9 <= U_GEOFENCE_PLANE_LIMIT_DEGREES_X1E9) &&
+        (pPosition->latitudeX1e9 >= -U_GEOFENCE_PLANE_LIMIT_DEGREES_X1E9) &&
+        (pPosition->longitudeX1e9 <= U_GEOFENCE_PLANE_LIMIT_DEGREES_X1E9) &&
+        (pPosition->longitudeX1e9 >= -U_GEOFENCE_PLANE_LIMIT_DEGREES_X1E9)) {
+        pPosition->yMillimetres = pPosition->latitudeX1e9 *
+                                  U_GEOFENCE_MILLIMETRES_PER_DEGREE_LATITUDE / 1000000000LL;
+        pPosition->xMillimetres = pPosition->longitudeX1e9 *
+                                  pPlane->millimetresPerDegreeLongitude / 1000000000LL;
+        success = (pPosition->yMillimetres <= U_GEOFENCE_PLANE_LIMIT_MILLIMETRES) &&
+                  (pPosition->yMillimetres >= -U_GEOFENCE_PLANE_LIMIT_MILLIMETRES) &&
+                  (pPosition->xMillimetres <= U_GEOFENCE_PLANE_LIMIT_MILLIMETRES) &&
+                  (pPosition->xMillimetres >= -U_GEOFENCE_PLANE_LIMIT_MILLIMETRES);
+    }
+
+    return success;
+}
+
+// The length of a line in the local plane, in millimetres; the
+// components must be no more than twice U_GEOFENCE_PLANE_LIMIT_MILLIMETRES.
+static int64_t planeLength(int64_t xMillimetres, int64_t yMillimetres)
+{
+    return (int64_t) squareRoot((uint64_t) ((xMillimetres * xMillimetres) +
+                                            (yMillimetres * yMillimetres)));
+}
+
+// Give a shape a local plane if it is small enough, replacing any
+// it had before.  If there is not enough memory the shape simply
+// has no local plane and floating point is used.
+static void planeCreate(uGeofenceShape_t *pShape)
+{
+    uGeofencePlane_t *pPlane;
+    const uGeofenceCircle_t *pCircle;
+    const uGeofencePolygon_t *pPolygon;
+    uGeofencePlanePosition_t position;
+    double latitudeMax;
+    double latitudeMin;
+    int64_t xMax = 0;
+    int64_t xMin = 0;
+    int64_t yMax = 0;
+    int64_t yMin = 0;
+    bool success = false;
+
+    fenceClearMapDataPlane(&(pShape->pPlane));
+    if (!pShape->wgs84Required && (U_GEOFENCE_FIXED_POINT_THRESHOLD_METRES > 0)) {
+        pPlane = (uGeofencePlane_t *) pUPortMalloc(sizeof(uGeofencePlane_t));
+        if (pPlane != NULL) {
+            memset(pPlane, 0, sizeof(*pPlane));
+            switch (pShape->type) {
+                case U_GEOFENCE_SHAPE_TYPE_CIRCLE:
+                    pCircle = pShape->u.pCircle;
+                    if (pCircle->radiusMetres * 2 <= U_GEOFENCE_FIXED_POINT_THRESHOLD_METRES) {
+                        pPlane->originLatitudeX1e9 = degreesToX1e9(pCircle->centre.latitude);
+                        pPlane->originLongitudeX1e9 = degreesToX1e9(pCircle->centre.longitude);
+                        pPlane->millimetresPerDegreeLongitude = (int32_t) (longitudeMetresPerDegree(
+                                                                               pCircle->centre.latitude) * 1000);
+                        pPlane->radiusMillimetres = (int32_t) ((pCircle->radiusMetres * 1000) + 0.5);
+                        success = true;
+                    }
+                    break;
+                case U_GEOFENCE_SHAPE_TYPE_POLYGON:
+                    pPolygon = pShape->u.pPolygon;
+                    if (pPolygon->numVertices > 0) {
+                        pPlane->pVertices = (uGeofencePlaneVertex_t *) pUPortMalloc(pPolygon->numVertices *
+                                                                                    sizeof(uGeofencePlaneVertex_t));
+                    }
+                    if (pPlane->pVertices != NULL) {
+                        // The scale of longitude is taken from the middle of the polygon
+                        latitudeMax = pPolygon->pVertices[0].latitude;
+                        latitudeMin = latitudeMax;
+                        for (size_t x = 1; x < pPolygon->numVertices; x++) {
+                            if (pPolygon->pVertices[x].latitude > latitudeMax) {
+                                latitudeMax = pPolygon->pVertices[x].latitude;
+                            } else if (pPolygon->pVertices[x].latitude < latitudeMin) {
+                                latitudeMin = pPolygon->pVertices[x].latitude;
+                            }
+                        }
+                        pPlane->originLatitudeX1e9 = degreesToX1e9(pPolygon->pVertices[0].latitude);
+                        pPlane->originLongitudeX1e9 = degreesToX1e9(pPolygon->pVertices[0].longitude);
+                        pPlane->millimetresPerDegreeLongitude = (int32_t) (longitudeMetresPerDegree(
+                                                                               (latitudeMax + latitudeMin) / 2) * 1000);
+                        success = true;
+                        for (size_t x = 0; success && (x < pPolygon->numVertices); x++) {
+                            success = planeGetPosition(pPlane,
+                                                       degreesToX1e9(pPolygon->pVertices[x].latitude),
+                                                       degreesToX1e9(pPolygon->pVertices[x].longitude),
+                                                       &position) &&
+                                      (position.latitudeX1e9 <= INT32_MAX) &&
+                                      (position.latitudeX1e9 >= INT32_MIN) &&
+                                      (position.longitudeX1e9 <= INT32_MAX) &&
+                                      (position.longitudeX1e9 >= INT32_MIN);
+                            if (success) {
+                                pPlane->pVertices[x].latitudeX1e9 = (int32_t) position.latitudeX1e9;
+                                pPlane->pVertices[x].longitudeX1e9 = (int32_t) position.longitudeX1e9;
+                                pPlane->pVertices[x].yMillimetres = (int32_t) position.yMillimetres;
+                                pPlane->pVertices[x].xMillimetres = (int32_t) position.xMillimetres;
+                                if (position.xMillimetres > xMax) {
+                                    xMax = position.xMillimetres;
+                                } else if (position.xMillimetres < xMin) {
+                                    xMin = position.xMillimetres;
+                                }
+                                if (position.yMillimetres > yMax) {
+                                    yMax = position.yMillimetres;
+                                } else if (position.yMillimetres < yMin) {
+                                    yMin = position.yMillimetres;
+                                }
+                            }
+                        }
+                        success = success && (planeLength(xMax - xMin, yMax - yMin) <=
+                                              U_GEOFENCE_FIXED_POINT_THRESHOLD_METRES * 1000LL);
+                    }
+                    break;
+                default:
+                    break;
+            }
+            if (success) {
+                pShape->pPlane = pPlane;
+            } else {
+                fenceClearMapDataPlane(&pPlane);
+            }
+        }
+    }
+}
+
+// Give all of the small shapes of a fence a local plane; done when
+// the fence is first applied, since it can no longer be changed.
+static void planeCreateAll(uGeofence_t *pFence)
+{
+    uLinkedList_t *pList = pFence->pShapes;
+
+    while (pList != NULL) {
+        if (pList->p != NULL) {
+            planeCreate((uGeofenceShape_t *) pList->p);
+        }
+        pList = pList->pNext;
+    }
+}
+
+#endif // U_CFG_GEOFENCE
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: SPATIAL INDEX
+ * -------------------------------------------------------------- */
+
+#ifdef U_CFG_GEOFENCE
+
+// Return the size of a cell of the spatial index at the given level.
+static double indexCellSizeDegrees(size_t level)
+{
+    double cellSizeDegrees = U_GEOFENCE_INDEX_CELL_SIZE_DEGREES_FLOAT;
+
+    for (size_t x = 0; x < level; x++) {
+        cellSizeDegrees *= U_GEOFENCE_INDEX_LEVEL_FACTOR;
+    }
+
+    return cellSizeDegrees;
+}
+
+// Return the number of spatial index cells around a line of latitude
+// at the given level.
+static int32_t indexNumCellsLongitude(size_t level)
+{
+    return (int32_t) ceil(360 / indexCellSizeDegrees(level));
+}
+
+// Return the latitude part of the spatial index cell that a latitude
+// falls into at the given level.
+static int32_t indexCellLatitude(double latitude, size_t level)
+{
+    if (latitude < -90) {
+        latitude = -90;
+    } else if (latitude > 90) {
+        latitude = 90;
+    }
+
+    return (int32_t) floor((latitude + 90) / indexCellSizeDegrees(level));
+}
+
+// Return the longitude part of the spatial index cell that a
+// longitude falls into at the given level, handling the wrap at 180.
+static int32_t indexCellLongitude(double longitude, size_t level)
+{
+    int32_t numCells = indexNumCellsLongitude(level);
+    int32_t cell = (int32_t) floor((longitude + 180) / indexCellSizeDegrees(level));
+
+    cell %= numCells;
+    if (cell < 0) {
+        cell += numCells;
+    }
+
+    return cell;
+}
+
+// Return the bucket that a spatial index cell hashes to.
+static size_t indexBucket(size_t level, int32_t cellLatitude, int32_t cellLongitude)
+{
+    uint32_t hash = (((uint32_t) cellLatitude) * 73856093UL) ^
+                    (((uint32_t) cellLongitude) * 19349663UL) ^
+                    (((uint32_t) level) * 83492791UL);
+
+    return hash % U_GEOFENCE_INDEX_NUM_BUCKETS;
+}
+
+// Work out the level of the spatial index that a shape should be
+// indexed at and the block of cells that its square extent covers
+// there, returning false if the shape cannot be indexed.
+static bool indexShapeCells(const uGeofenceShape_t *pShape,
+                            size_t *pLevel,
+                            int32_t *pCellLatitudeMin,
+                            int32_t *pNumCellsLatitude,
+                            int32_t *pCellLongitudeMin,
+                            int32_t *pNumCellsLongitude)
+{
+    bool indexable = false;
+    const uGeofenceSquare_t *pSquareExtent = &(pShape->squareExtent);
+    int32_t numCellsLongitude;
+    double widthDegrees;
+
+    if (pSquareExtent->max.latitude == pSquareExtent->max.latitude) { // NAN test
+        widthDegrees = pSquareExtent->max.longitude - pSquareExtent->min.longitude;
+        if (widthDegrees < 0) {
+            widthDegrees += 360;
+        }
+        // testSquareExtent() checks longitude relative to the maximum
+        // and minimum of the square extent: that only amounts to
+        // a simple range of longitude eastwards from the minimum
+        // to the maximum if the two are no more than 180 degrees apart
+        for (size_t level = 0; !indexable && (widthDegrees <= 180) &&
+             (level < U_GEOFENCE_INDEX_NUM_LEVELS); level++) {
+            numCellsLongitude = indexNumCellsLongitude(level);
+            *pLevel = level;
+            *pCellLatitudeMin = indexCellLatitude(pSquareExtent->min.latitude -
+                                                  U_GEOFENCE_INDEX_MARGIN_DEGREES, level);
+            *pNumCellsLatitude = indexCellLatitude(pSquareExtent->max.latitude +
+                                                   U_GEOFENCE_INDEX_MARGIN_DEGREES, level) -
+                                 *pCellLatitudeMin + 1;
+            *pCellLongitudeMin = indexCellLongitude(pSquareExtent->min.longitude -
+                                                    U_GEOFENCE_INDEX_MARGIN_DEGREES, level);
+            *pNumCellsLongitude = ((indexCellLongitude(pSquareExtent->max.longitude +
+                                                       U_GEOFENCE_INDEX_MARGIN_DEGREES, level) -
+                                    *pCellLongitudeMin + numCellsLongitude) % numCellsLongitude) + 1;
+            // A shape that fills a larger block of cells would land
+            // in many buckets, try the next level up
+            indexable = (*pNumCellsLatitude > 0) &&
+                        (*pNumCellsLatitude * *pNumCellsLongitude <= U_GEOFENCE_INDEX_MAX_CELLS_PER_SHAPE);
+        }
+    }
+
+    return indexable;
+}
+
+// Add a fence to a spatial index, returning false if there is not
+// enough memory, in which case the index should be free'd.
+static bool indexAddFence(uGeofenceIndex_t *pIndex, uGeofence_t *pFence)
+{
+    bool success = true;
+    bool indexable = (pFence->pShapes != NULL);
+    uint8_t bucketsAdded[(U_GEOFENCE_INDEX_NUM_BUCKETS + 7) / 8] = {0};
+    size_t level = 0;
+    int32_t numCellsLongitude;
+    int32_t cellLatitudeMin = 0;
+    int32_t numCellsLatitude = 0;
+    int32_t cellLongitudeMin = 0;
+    int32_t numCellsLongitudeShape = 0;
+    uLinkedList_t *pList;
+    size_t bucket;
+
+    // A fence can only be indexed if all of its shapes can be
+    pList = pFence->pShapes;
+    while (indexable && (pList != NULL)) {
+        indexable = indexShapeCells((const uGeofenceShape_t *) pList->p, &level,
+                                    &cellLatitudeMin, &numCellsLatitude,
+                                    &cellLongitudeMin, &numCellsLongitudeShape);
+        pList = pList->pNext;
+    }
+
+    if (indexable) {
+        // Add the fence, once, to each bucket that the cells covered
+        // by its shapes hash to
+        pList = pFence->pShapes;
+        while (success && (pList != NULL)) {
+            indexShapeCells((const uGeofenceShape_t *) pList->p, &level,
+                            &cellLatitudeMin, &numCellsLatitude,
+                            &cellLongitudeMin, &numCellsLongitudeShape);
+            numCellsLongitude = indexNumCellsLongitude(level);
+            for (int32_t y = 0; success && (y < numCellsLatitude); y++) {
+                for (int32_t x = 0; success && (x < numCellsLongitudeShape); x++) {
+                    bucket = indexBucket(level, cellLatitudeMin + y,
+                                         (cellLongitudeMin + x) % numCellsLongitude);
+                    if ((bucketsAdded[bucket / 8] & (1U << (bucket % 8))) == 0) {
+                        success = uLinkedListAdd(&(pIndex->pBucket[bucket]), (void *) pFence);
+                        bucketsAdded[bucket / 8] |= (uint8_t) (1U << (bucket % 8));
+                    }
+                }
+            }
+            pList = pList->pNext;
+        }
+    } else {
+        success = uLinkedListAdd(&(pIndex->pUnindexed), (void *) pFence);
+    }
+
+    return success;
+}
+
+// Remove a fence from a spatial index.
+static void indexRemoveFence(uGeofenceIndex_t *pIndex, const uGeofence_t *pFence)
+{
+    // A fence is either in the unindexed list or in the buckets, never both,
+    // and appears at most once in a bucket each time it is applied
+    if (!uLinkedListRemove(&(pIndex->pUnindexed), (void *) pFence)) {
+        for (size_t x = 0; x < sizeof(pIndex->pBucket) / sizeof(pIndex->pBucket[0]); x++) {
+            uLinkedListRemove(&(pIndex->pBucket[x]), (void *) pFence);
+        }
+    }
+}
+
+// Free the spatial index of a geofence context.
+static void indexFree(uGeofenceContext_t *pFenceContext)
+{
+    uGeofenceIndex_t *pIndex = pFenceContext->pIndex;
+
+    if (pIndex != NULL) {
+        for (size_t x = 0; x < sizeof(pIndex->pBucket) / sizeof(pIndex->pBucket[0]); x++) {
+            while (pIndex->pBucket[x] != NULL) {
+                uLinkedListRemove(&(pIndex->pBucket[x]), pIndex->pBucket[x]->p);
+            }
+        }
+        while (pIndex->pUnindexed != NULL) {
+            uLinkedListRemove(&(pIndex->pUnindexed), pIndex->pUnindexed->p);
+        }
+        uPortFree(pIndex);
+        pFenceContext->pIndex = NULL;
+    }
+}
+
+// Create the spatial index of a geofence context from all of the
+// fences in it; if there is not enough memory there is simply no
+// index and all fences will be tested.
+static void indexCreate(uGeofenceContext_t *pFenceContext)
+{
+    bool success = true;
+    uLinkedList_t *pList;
+
+    pFenceContext->pIndex = (uGeofenceIndex_t *) pUPortMalloc(sizeof(uGeofenceIndex_t));
+    if (pFenceContext->pIndex != NULL) {
+        memset(pFenceContext->pIndex, 0, sizeof(*pFenceContext->pIndex));
+        pList = pFenceContext->pFences;
+        while (success && (pList != NULL)) {
+            success = indexAddFence(pFenceContext->pIndex, (uGeofence_t *) pList->p);
+            pList = pList->pNext;
+        }
+        if (!success) {
+            indexFree(pFenceContext);
+        }
+    }
+}
+
+// Determine whether a position can be checked against the spatial
+// index, i.e. whether it is valid and certain enough for square
+// extent checks to be made, returning the bucket it falls into at
+// each level of the index in pBucket, which must point to
+// #U_GEOFENCE_INDEX_NUM_LEVELS entries.
+static bool indexBucketForPosition(int64_t latitudeX1e9,
+                                   int64_t longitudeX1e9,
+                                   int32_t radiusMillimetres,
+                                   size_t *pBucket)
+{
+    bool usable = false;
+    double latitude;
+    double longitude;
+
+    if ((latitudeX1e9 < U_GEOFENCE_LIMIT_LATITUDE_DEGREES_X1E9) &&
+        (latitudeX1e9 > -U_GEOFENCE_LIMIT_LATITUDE_DEGREES_X1E9) &&
+        (longitudeX1e9 < U_GEOFENCE_LIMIT_LONGITUDE_DEGREES_X1E9) &&
+        (longitudeX1e9 > -U_GEOFENCE_LIMIT_LONGITUDE_DEGREES_X1E9) &&
+        (radiusMillimetres >= 0) &&
+        (radiusMillimetres < U_GEOFENCE_SQUARE_EXTENT_CHECK_UNCERTAINTY_METRES * 1000)) {
+        // Must be calculated in the same way as testPosition() does it
+        latitude = ((double) latitudeX1e9) / 1000000000ULL;
+        longitude = ((double) longitudeX1e9) / 1000000000ULL;
+        for (size_t level = 0; level < U_GEOFENCE_INDEX_NUM_LEVELS; level++) {
+            *(pBucket + level) = indexBucket(level, indexCellLatitude(latitude, level),
+                                             indexCellLongitude(longitude, level));
+        }
+        usable = true;
+    }
+
+    return usable;
+}
+
+// Determine whether the next fence of a geofence context needs to be
+// tested, given pointers into the buckets that the position falls
+// into at each level, #U_GEOFENCE_INDEX_NUM_LEVELS of them, and the
+// unindexed list which, since they are all in the same order as the
+// fences of the context, are moved along as matches are found; a
+// fence with shapes indexed at more than one level may be at the
+// front of more than one of them.
+static bool indexIsCandidate(const uGeofence_t *pFence,
+                             const uLinkedList_t **ppBucket,
+                             const uLinkedList_t **ppUnindexed)
+{
+    bool isCandidate = false;
+
+    if ((*ppUnindexed != NULL) && ((*ppUnindexed)->p == pFence)) {
+        isCandidate = true;
+        *ppUnindexed = (*ppUnindexed)->pNext;
+    } else {
+        for (size_t level = 0; level < U_GEOFENCE_INDEX_NUM_LEVELS; level++) {
+            if ((*(ppBucket + level) != NULL) && ((*(ppBucket + level))->p == pFence)) {
+                isCandidate = true;
+                *(ppBucket + level) = (*(ppBucket + level))->pNext;
+            }
+        }
+    }
+
+    return isCandidate;
+}
+
+#endif // U_CFG_GEOFENCE
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: FENCE STATUS
+ * -------------------------------------------------------------- */
+
+#ifdef U_CFG_GEOFENCE
+
+// Add a status record for a fence that has just been added to the
+// end of the fences of a geofence context; if there is not enough
+// memory there is simply no record and the fence is always tested.
+static void statusAdd(uGeofenceContext_t *pFenceContext, const uGeofence_t *pFence)
+{
+    uGeofenceFenceStatus_t *pFenceStatus;
+
+    pFenceStatus = (uGeofenceFenceStatus_t *) pUPortMalloc(sizeof(uGeofenceFenceStatus_t));
+    if (pFenceStatus != NULL) {
+        memset(pFenceStatus, 0, sizeof(*pFenceStatus));
+        pFenceStatus->pFence = pFence;
+        if (!uLinkedListAdd(&(pFenceContext->pFenceStatus), (void *) pFenceStatus)) {
+            uPortFree(pFenceStatus);
+        }
+    }
+}
+
+// Remove the status record for a fence from a geofence context,
+// the first one since uLinkedListRemove() removes the first
+// instance of a fence from the fences of the context.
+static void statusRemove(uGeofenceContext_t *pFenceContext, const uGeofence_t *pFence)
+{
+    uLinkedList_t *pList = pFenceContext->pFenceStatus;
+    uGeofenceFenceStatus_t *pFenceStatus = NULL;
+
+    while ((pList != NULL) && (pFenceStatus == NULL)) {
+        if (((uGeofenceFenceStatus_t *) pList->p)->pFence == pFence) {
+            pFenceStatus = (uGeofenceFenceStatus_t *) pList->p;
+        }
+        pList = pList->pNext;
+    }
+    if (pFenceStatus != NULL) {
+        uLinkedListRemove(&(pFenceContext->pFenceStatus), (void *) pFenceStatus);
+        uPortFree(pFenceStatus);
+    }
+}
+
+// Free all of the status records of a geofence context.
+static void statusFree(uGeofenceContext_t *pFenceContext)
+{
+    uGeofenceFenceStatus_t *pFenceStatus;
+
+    while (pFenceContext->pFenceStatus != NULL) {
+        pFenceStatus = (uGeofenceFenceStatus_t *) pFenceContext->pFenceStatus->p;
+        uLinkedListRemove(&(pFenceContext->pFenceStatus), (void *) pFenceStatus);
+        uPortFree(pFenceStatus);
+    }
+}
+
+// Return the status record for the next fence of a geofence context,
+// or NULL if it hasn't got one, given a pointer into the status
+// records which, since they are in the same order as the fences of
+// the context, is moved along as matches are found.
+static uGeofenceFenceStatus_t *pStatusNext(const uGeofence_t *pFence,
+                                          const uLinkedList_t **ppStatus)
+{
+    uGeofenceFenceStatus_t *pFenceStatus = NULL;
+
+    if ((*ppStatus != NULL) &&
+        (((uGeofenceFenceStatus_t *) (*ppStatus)->p)->pFence == pFence)) {
+        pFenceStatus = (uGeofenceFenceStatus_t *) (*ppStatus)->p;
+        *ppStatus = (*ppStatus)->pNext;
+    }
+
+    return pFenceStatus;
+}
+
+// Determine whether a fence can be skipped, i.e. whether a device
+// that was last tested in full against the fence at a known lower
+// bound of distance from it cannot, at its maximum horizontal speed,
+// have got close enough since for the given radius of position to
+// reach any shape of the fence.
+static bool statusFenceIsOutOfReach(const uGeofenceFenceStatus_t *pFenceStatus,
+                                    int32_t maxHorizontalSpeedMillimetresPerSecond,
+                                    int32_t timeNowMs,
+                                    int32_t radiusMillimetres)
+{
+    bool outOfReach = false;
+    int64_t distanceTravelledMillimetres;
+
+    if ((pFenceStatus->distanceMillimetresMin > 0) &&
+        (maxHorizontalSpeedMillimetresPerSecond >= 0) &&
+        (radiusMillimetres >= 0) &&
+        // Guard against wrap
+        (timeNowMs >= pFenceStatus->timeMs)) {
+        // Divide by 1000 below to get per second, rounding up
+        distanceTravelledMillimetres = (((int64_t) (timeNowMs - pFenceStatus->timeMs)) *
+                                        maxHorizontalSpeedMillimetresPerSecond + 999) / 1000;
+        outOfReach = (distanceTravelledMillimetres + radiusMillimetres <
+                      pFenceStatus->distanceMillimetresMin);
+    }
+
+    return outOfReach;
+}
+
+#endif // U_CFG_GEOFENCE
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS: TEST RELATED
  * -------------------------------------------------------------- */
@@ -1253,6 +2015,63 @@ static uGeofencePositionState_t testSquareExtent(const uGeofenceSquare_t *pSquar
     return positionState;
 }
 
+// Return a lower bound on the distance in metres from a position,
+// which has been found to be outside the given square extent, to
+// anything inside that square extent; zero if there is no useful
+// bound.  The latitude gap is measured along a meridian, the
+// longitude gap as the distance to the nearest meridian bounding
+// the square extent, which is never less than the distance to
+// the great circle of that meridian.
+static double squareExtentDistanceMin(const uGeofenceSquare_t *pSquareExtent,
+                                      const uGeofenceCoordinates_t *pCoordinates)
+{
+    double distanceMetres = 0;
+    double widthDegrees;
+    double eastDegrees;
+    double westDegrees;
+    double gapDegrees = 0;
+    double distanceLongitudeMetres;
+
+    if (pSquareExtent->max.latitude == pSquareExtent->max.latitude) { // NAN test
+        if (pCoordinates->latitude > pSquareExtent->max.latitude) {
+            gapDegrees = pCoordinates->latitude - pSquareExtent->max.latitude;
+        } else if (pCoordinates->latitude < pSquareExtent->min.latitude) {
+            gapDegrees = pSquareExtent->min.latitude - pCoordinates->latitude;
+        }
+        distanceMetres = gapDegrees * U_GEOFENCE_METRES_PER_DEGREE_LATITUDE;
+        widthDegrees = pSquareExtent->max.longitude - pSquareExtent->min.longitude;
+        if (widthDegrees < 0) {
+            widthDegrees += 360;
+        }
+        // As in indexShapeCells(), the longitude range is only a
+        // simple one if it is no more than 180 degrees wide
+        if (widthDegrees <= 180) {
+            eastDegrees = pCoordinates->longitude - pSquareExtent->max.longitude;
+            if (eastDegrees < 0) {
+                eastDegrees += 360;
+            }
+            westDegrees = 360 - widthDegrees - eastDegrees;
+            gapDegrees = eastDegrees;
+            if (westDegrees < gapDegrees) {
+                gapDegrees = westDegrees;
+            }
+            if (gapDegrees > 0) {
+                if (gapDegrees > 90) {
+                    gapDegrees = 90;
+                }
+                distanceLongitudeMetres = asin(cos(degreesToRadians(pCoordinates->latitude)) *
+                                               sin(degreesToRadians(gapDegrees))) *
+                                          U_GEOFENCE_RADIUS_AT_EQUATOR_METERS;
+                if (distanceLongitudeMetres > distanceMetres) {
+                    distanceMetres = distanceLongitudeMetres;
+                }
+            }
+        }
+    }
+
+    return distanceMetres;
+}
+
 // Test if the previous distance and maximum speed of the position eliminates it.
 static uGeofencePositionState_t testSpeed(const uGeofenceDynamic_t *pPreviousDistance)
 {
@@ -1398,7 +2217,7 @@ static uGeofencePositionState_t testCircle(const uGeofenceCircle_t *pCircle,
 // 4: When all segments have been tested or skipped the states of
 //    "IS INSIDE" and "IS UNCERTAIN" are correct.
 //
-static uGeofencePositionState_t testPolygon(const uLinkedList_t *pPolygon,
+static uGeofencePositionState_t testPolygon(const uGeofencePolygon_t *pPolygon,
                                             bool wgs84Required,
                                             double metresPerDegreeLongitude,
                                             const uGeofenceCoordinates_t *pCoordinates,
@@ -1407,12 +2226,11 @@ static uGeofencePositionState_t testPolygon(const uLinkedList_t *pPolygon,
                                             bool *pUncertain)
 {
     uGeofencePositionState_t positionState = U_GEOFENCE_POSITION_STATE_NONE;
-    int32_t vertexCount = 0;
+    size_t numVertices = pPolygon->numVertices;
     bool isInside = false;
     bool exitNow = false;
     bool calculationFailure = false;
-    const uLinkedList_t *pTmp = pPolygon;
-    uGeofenceCoordinates_t *pSide[2] = {0};
+    const uGeofenceCoordinates_t *pSide[2] = {0};
     double cutLatitude = NAN;
     double distanceMetres;
     double distanceMinMetres = NAN;
@@ -1420,106 +2238,93 @@ static uGeofencePositionState_t testPolygon(const uLinkedList_t *pPolygon,
     *pDistanceMetres = NAN;
     *pUncertain = false;
 
-    // First count the number of vertices
-    while ((pTmp != NULL) && (pTmp->p != NULL)) {
-        vertexCount++;
-        pTmp = pTmp->pNext;
-    }
-    if (vertexCount >= 3) {
+    if (numVertices >= 3) {
         // Check all sides making sure to check the final
         // side which links back to the first vertex
-        while ((vertexCount >= 0) && !exitNow) {
-            if (pTmp == NULL) {
-                // This sets us up at the beginning and also
-                // at the end, to pick up the first vertexCount
-                // that ends the last side
-                pTmp = pPolygon;
-            }
-            pSide[0] = (uGeofenceCoordinates_t *) pTmp->p;
-            if (pSide[0] != NULL) {
-                // Now have a side which starts at pSide[1] and ends at pSide[0]
-                if ((pSide[0]->latitude == pCoordinates->latitude) &&
-                    (pSide[0]->longitude == pCoordinates->longitude)) {
-                    // Check 2 has been met, we're in
-                    isInside = true;
-                    if (uncertaintyMillimetres > 0) {
-                        // ...uncertainly
-                        *pUncertain = true;
-                    }
-                    exitNow = true;
-                } else {
-                    if (pSide[1] != NULL) {
-                        // These things are used multiple times below so set them out here
-                        double longitude1Delta = longitudeSubtract(pCoordinates->longitude, pSide[1]->longitude);
-                        double longitude0Delta = longitudeSubtract(pCoordinates->longitude, pSide[0]->longitude);
-                        bool sideIsBelow = (pSide[1]->latitude < pCoordinates->latitude) &&
-                                           (pSide[0]->latitude < pCoordinates->latitude);
-                        // Check 3.0
-                        if ((((longitude1Delta > 0) && (longitude0Delta > 0)) ||
-                             ((longitude1Delta < 0) && (longitude0Delta < 0))) || sideIsBelow) {
-                            // No intersection
+        for (size_t x = 0; (x <= numVertices) && !exitNow; x++) {
+            // The last time around we pick up the first
+            // vertex again, to end the last side
+            pSide[0] = &(pPolygon->pVertices[x < numVertices ? x : 0]);
+            // Now have a side which starts at pSide[1] and ends at pSide[0]
+            if ((pSide[0]->latitude == pCoordinates->latitude) &&
+                (pSide[0]->longitude == pCoordinates->longitude)) {
+                // Check 2 has been met, we're in
+                isInside = true;
+                if (uncertaintyMillimetres > 0) {
+                    // ...uncertainly
+                    *pUncertain = true;
+                }
+                exitNow = true;
+            } else {
+                if (pSide[1] != NULL) {
+                    // These things are used multiple times below so set them out here
+                    double longitude1Delta = longitudeSubtract(pCoordinates->longitude, pSide[1]->longitude);
+                    double longitude0Delta = longitudeSubtract(pCoordinates->longitude, pSide[0]->longitude);
+                    bool sideIsBelow = (pSide[1]->latitude < pCoordinates->latitude) &&
+                                       (pSide[0]->latitude < pCoordinates->latitude);
+                    // Check 3.0
+                    if ((((longitude1Delta > 0) && (longitude0Delta > 0)) ||
+                         ((longitude1Delta < 0) && (longitude0Delta < 0))) || sideIsBelow) {
+                        // No intersection
+                    } else {
+                        // Check 3.1
+                        bool vertex1Intersection = (pSide[1]->longitude == pCoordinates->longitude) &&
+                                                   (pSide[1]->latitude >= pCoordinates->latitude);
+                        bool vertex0Intersection = (pSide[0]->longitude == pCoordinates->longitude) &&
+                                                   (pSide[0]->latitude >= pCoordinates->latitude);
+                        if (vertex1Intersection || vertex0Intersection) {
+                            if ((vertex1Intersection && (longitude0Delta > 0)) ||
+                                (vertex0Intersection && (longitude1Delta > 0))) {
+                                // Flip
+                                isInside = !isInside;
+                            }
                         } else {
-                            // Check 3.1
-                            bool vertex1Intersection = (pSide[1]->longitude == pCoordinates->longitude) &&
-                                                       (pSide[1]->latitude >= pCoordinates->latitude);
-                            bool vertex0Intersection = (pSide[0]->longitude == pCoordinates->longitude) &&
-                                                       (pSide[0]->latitude >= pCoordinates->latitude);
-                            if (vertex1Intersection || vertex0Intersection) {
-                                if ((vertex1Intersection && (longitude0Delta > 0)) ||
-                                    (vertex0Intersection && (longitude1Delta > 0))) {
-                                    // Flip
-                                    isInside = !isInside;
-                                }
-                            } else {
-                                // Check 3.2
-                                double longitude1DeltaAbs = longitude1Delta;
-                                if (longitude1DeltaAbs < 0) {
-                                    longitude1DeltaAbs = -longitude1DeltaAbs;
-                                }
-                                double longitude0DeltaAbs = longitude0Delta;
-                                if (longitude0DeltaAbs < 0) {
-                                    longitude0DeltaAbs = -longitude0DeltaAbs;
-                                }
-                                if ((longitude1DeltaAbs + longitude0DeltaAbs <= 180)) {
-                                    // Check 3.3: need to do some calculations
-                                    calculationFailure = !latitudeOfIntersection(pSide[1], pSide[0],
-                                                                                 pCoordinates->longitude,
-                                                                                 wgs84Required,
-                                                                                 &cutLatitude);
-                                    if (calculationFailure) {
-                                        exitNow = true;
-                                    } else {
-                                        if (cutLatitude >= pCoordinates->latitude) {
-                                            // Flip
-                                            isInside = !isInside;
-                                        }
+                            // Check 3.2
+                            double longitude1DeltaAbs = longitude1Delta;
+                            if (longitude1DeltaAbs < 0) {
+                                longitude1DeltaAbs = -longitude1DeltaAbs;
+                            }
+                            double longitude0DeltaAbs = longitude0Delta;
+                            if (longitude0DeltaAbs < 0) {
+                                longitude0DeltaAbs = -longitude0DeltaAbs;
+                            }
+                            if ((longitude1DeltaAbs + longitude0DeltaAbs <= 180)) {
+                                // Check 3.3: need to do some calculations
+                                calculationFailure = !latitudeOfIntersection(pSide[1], pSide[0],
+                                                                             pCoordinates->longitude,
+                                                                             wgs84Required,
+                                                                             &cutLatitude);
+                                if (calculationFailure) {
+                                    exitNow = true;
+                                } else {
+                                    if (cutLatitude >= pCoordinates->latitude) {
+                                        // Flip
+                                        isInside = !isInside;
                                     }
                                 }
                             }
                         }
-                        // Check 3.4
-                        if (!*pUncertain && (uncertaintyMillimetres > 0)) {
-                            // Check if the shortest distance between the side
-                            // and our point is less than the uncertainty
-                            distanceMetres = distanceToSegment(pSide[1], pSide[0], pCoordinates,
-                                                               metresPerDegreeLongitude, wgs84Required);
-                            calculationFailure = (distanceMetres != distanceMetres);  // NAN test
-                            if (calculationFailure) {
-                                exitNow = true;
-                            } else {
-                                if ((distanceMinMetres != distanceMinMetres) || // NAN test
-                                    (distanceMetres < distanceMinMetres)) {
-                                    distanceMinMetres = distanceMetres;
-                                }
-                                *pUncertain = (uncertaintyMillimetres > distanceMetres * 1000);
+                    }
+                    // Check 3.4
+                    if (!*pUncertain && (uncertaintyMillimetres > 0)) {
+                        // Check if the shortest distance between the side
+                        // and our point is less than the uncertainty
+                        distanceMetres = distanceToSegment(pSide[1], pSide[0], pCoordinates,
+                                                           metresPerDegreeLongitude, wgs84Required);
+                        calculationFailure = (distanceMetres != distanceMetres);  // NAN test
+                        if (calculationFailure) {
+                            exitNow = true;
+                        } else {
+                            if ((distanceMinMetres != distanceMinMetres) || // NAN test
+                                (distanceMetres < distanceMinMetres)) {
+                                distanceMinMetres = distanceMetres;
                             }
+                            *pUncertain = (uncertaintyMillimetres > distanceMetres * 1000);
                         }
                     }
-                    pSide[1] = pSide[0];
                 }
+                pSide[1] = pSide[0];
             }
-            vertexCount--;
-            pTmp = pTmp->pNext;
         }
 
         if (!calculationFailure) {
@@ -1534,6 +2339,183 @@ static uGeofencePositionState_t testPolygon(const uLinkedList_t *pPolygon,
     return positionState;
 }
 
+// Test the state of a position with respect to a circle in the
+// local plane of the circle; as testCircle() but in integers.
+static uGeofencePositionState_t testCirclePlane(const uGeofencePlane_t *pPlane,
+                                                const uGeofencePlanePosition_t *pPosition,
+                                                int32_t uncertaintyMillimetres,
+                                                double *pDistanceMetres,
+                                                bool *pUncertain)
+{
+    uGeofencePositionState_t positionState = U_GEOFENCE_POSITION_STATE_INSIDE;
+    int64_t distanceMillimetres;
+
+    // Have the distance from our point to the edge of the circle,
+    // which will be negative if we are inside it.
+    distanceMillimetres = planeLength(pPosition->xMillimetres,
+                                      pPosition->yMillimetres) - pPlane->radiusMillimetres;
+    if (distanceMillimetres > 0) {
+        positionState = U_GEOFENCE_POSITION_STATE_OUTSIDE;
+    }
+
+    // Check if the uncertainty changes the outcome
+    if (distanceMillimetres < 0) {
+        distanceMillimetres = -distanceMillimetres;
+    }
+    *pDistanceMetres = ((double) distanceMillimetres) / 1000;
+    *pUncertain = (uncertaintyMillimetres >= distanceMillimetres);
+
+    return positionState;
+}
+
+// The shortest distance from a point to a line segment in the local
+// plane of a polygon, in millimetres; as distanceToSegment() for
+// the flat X/Y case but in integers.
+static int64_t distanceToSegmentPlane(const uGeofencePlaneVertex_t *pA,
+                                      const uGeofencePlaneVertex_t *pB,
+                                      const uGeofencePlanePosition_t *pPosition)
+{
+    int64_t distanceMillimetres;
+    int64_t xDeltaPoint = pPosition->xMillimetres - pA->xMillimetres;
+    int64_t yDeltaPoint = pPosition->yMillimetres - pA->yMillimetres;
+    int64_t xDeltaLine = ((int64_t) pB->xMillimetres) - pA->xMillimetres;
+    int64_t yDeltaLine = ((int64_t) pB->yMillimetres) - pA->yMillimetres;
+    // dot represents the proportion of the distance along the line
+    // that the "normal" projection of our point lands, times the
+    // length of the line squared
+    int64_t dot = (xDeltaPoint * xDeltaLine) + (yDeltaPoint * yDeltaLine);
+    int64_t lineLengthSquared = (xDeltaLine * xDeltaLine) + (yDeltaLine * yDeltaLine);
+    int64_t cross;
+
+    if ((dot <= 0) || (lineLengthSquared == 0)) {
+        // A is beyond our point, so use A
+        distanceMillimetres = planeLength(xDeltaPoint, yDeltaPoint);
+    } else if (dot >= lineLengthSquared) {
+        // B is beyond our point, so use B
+        distanceMillimetres = planeLength(pPosition->xMillimetres - pB->xMillimetres,
+                                          pPosition->yMillimetres - pB->yMillimetres);
+    } else {
+        // The distance to the normal is the cross product divided
+        // by the length of the line; the length is worked out to a
+        // 32nd of a millimetre so as not to lose precision for short
+        // lines, hence the cross product is multiplied by 32
+        cross = (xDeltaPoint * yDeltaLine) - (yDeltaPoint * xDeltaLine);
+        if (cross < 0) {
+            cross = -cross;
+        }
+        distanceMillimetres = (cross * 32) / (int64_t) squareRoot((uint64_t) lineLengthSquared * 1024);
+    }
+
+    return distanceMillimetres;
+}
+
+// Test the state of a position with respect to a polygon in the
+// local plane of the polygon; this is the algorithm of testPolygon(),
+// see the description there, in integers.  Since the plane is small,
+// check 3.2 does not apply and, since the latitudes and longitudes
+// are the ones the fence was given, the "point in polygon" part
+// gives the same answer as testPolygon() in flat X/Y space.
+static uGeofencePositionState_t testPolygonPlane(const uGeofencePlane_t *pPlane,
+                                                 size_t numVertices,
+                                                 const uGeofencePlanePosition_t *pPosition,
+                                                 int32_t uncertaintyMillimetres,
+                                                 double *pDistanceMetres,
+                                                 bool *pUncertain)
+{
+    uGeofencePositionState_t positionState = U_GEOFENCE_POSITION_STATE_NONE;
+    bool isInside = false;
+    bool exitNow = false;
+    const uGeofencePlaneVertex_t *pSide[2] = {0};
+    int64_t longitude1Delta;
+    int64_t longitude0Delta;
+    int64_t sideLongitudeDelta;
+    int64_t cutAbove;
+    bool sideIsBelow;
+    bool vertex1Intersection;
+    bool vertex0Intersection;
+    int64_t distanceMillimetres;
+    int64_t distanceMinMillimetres = -1;
+
+    *pDistanceMetres = NAN;
+    *pUncertain = false;
+
+    if (numVertices >= 3) {
+        for (size_t x = 0; (x <= numVertices) && !exitNow; x++) {
+            pSide[0] = &(pPlane->pVertices[x < numVertices ? x : 0]);
+            if ((pSide[0]->latitudeX1e9 == pPosition->latitudeX1e9) &&
+                (pSide[0]->longitudeX1e9 == pPosition->longitudeX1e9)) {
+                // Check 2 has been met, we're in
+                isInside = true;
+                if (uncertaintyMillimetres > 0) {
+                    // ...uncertainly
+                    *pUncertain = true;
+                }
+                exitNow = true;
+            } else {
+                if (pSide[1] != NULL) {
+                    longitude1Delta = pPosition->longitudeX1e9 - pSide[1]->longitudeX1e9;
+                    longitude0Delta = pPosition->longitudeX1e9 - pSide[0]->longitudeX1e9;
+                    sideIsBelow = (pSide[1]->latitudeX1e9 < pPosition->latitudeX1e9) &&
+                                  (pSide[0]->latitudeX1e9 < pPosition->latitudeX1e9);
+                    // Check 3.0
+                    if ((((longitude1Delta > 0) && (longitude0Delta > 0)) ||
+                         ((longitude1Delta < 0) && (longitude0Delta < 0))) || sideIsBelow) {
+                        // No intersection
+                    } else {
+                        // Check 3.1
+                        vertex1Intersection = (pSide[1]->longitudeX1e9 == pPosition->longitudeX1e9) &&
+                                              (pSide[1]->latitudeX1e9 >= pPosition->latitudeX1e9);
+                        vertex0Intersection = (pSide[0]->longitudeX1e9 == pPosition->longitudeX1e9) &&
+                                              (pSide[0]->latitudeX1e9 >= pPosition->latitudeX1e9);
+                        if (vertex1Intersection || vertex0Intersection) {
+                            if ((vertex1Intersection && (longitude0Delta > 0)) ||
+                                (vertex0Intersection && (longitude1Delta > 0))) {
+                                // Flip
+                                isInside = !isInside;
+                            }
+                        } else {
+                            // Check 3.3: the cut latitude is above or equal
+                            // to our point, as worked out by latitudeOfIntersection(),
+                            // but multiplied through by the longitude difference
+                            // of the side to avoid a division, which flips
+                            // the sense of the comparison if it is negative
+                            sideLongitudeDelta = ((int64_t) pSide[0]->longitudeX1e9) - pSide[1]->longitudeX1e9;
+                            cutAbove = ((pSide[1]->latitudeX1e9 - pPosition->latitudeX1e9) * sideLongitudeDelta) +
+                                       (longitude1Delta * (((int64_t) pSide[0]->latitudeX1e9) - pSide[1]->latitudeX1e9));
+                            if (((sideLongitudeDelta > 0) && (cutAbove >= 0)) ||
+                                ((sideLongitudeDelta < 0) && (cutAbove <= 0))) {
+                                // Flip
+                                isInside = !isInside;
+                            }
+                        }
+                    }
+                    // Check 3.4
+                    if (!*pUncertain && (uncertaintyMillimetres > 0)) {
+                        // Check if the shortest distance between the side
+                        // and our point is less than the uncertainty
+                        distanceMillimetres = distanceToSegmentPlane(pSide[1], pSide[0], pPosition);
+                        if ((distanceMinMillimetres < 0) || (distanceMillimetres < distanceMinMillimetres)) {
+                            distanceMinMillimetres = distanceMillimetres;
+                        }
+                        *pUncertain = (uncertaintyMillimetres > distanceMillimetres);
+                    }
+                }
+                pSide[1] = pSide[0];
+            }
+        }
+
+        if (distanceMinMillimetres >= 0) {
+            *pDistanceMetres = ((double) distanceMinMillimetres) / 1000;
+        }
+        positionState = U_GEOFENCE_POSITION_STATE_OUTSIDE;
+        if (isInside) {
+            positionState = U_GEOFENCE_POSITION_STATE_INSIDE;
+        }
+    }
+
+    return positionState;
+}
+
 // Check whether we need to carry on testing the next shape.
 static bool testKeepGoing(uGeofencePositionState_t positionState)
 {
@@ -1541,12 +2523,16 @@ static bool testKeepGoing(uGeofencePositionState_t positionState)
     return !(positionState == U_GEOFENCE_POSITION_STATE_INSIDE);
 }
 
-// Test a single position against a fence.
+// Test a single position against a fence.  If pDistanceMillimetresMin
+// is not NULL then, should the position be outside the fence, it is
+// populated with a lower bound on the horizontal distance from the
+// position to any shape of the fence, else zero.
 bool testPosition(const uGeofence_t *pFence,
                   uGeofenceTestType_t testType,
                   bool pessimisticNotOptimistic,
                   uGeofencePositionState_t *pPositionState,
                   uGeofenceDynamic_t *pDynamic,
+                  int64_t *pDistanceMillimetresMin,
                   int64_t latitudeX1e9,
                   int64_t longitudeX1e9,
                   int32_t altitudeMillimetres,
@@ -1564,7 +2550,14 @@ bool testPosition(const uGeofence_t *pFence,
     double metresPerDegreeLongitude;
     double distanceMetres;
     double distanceMinMetres = NAN;
+    double distanceLowerBoundMetres = NAN;
+    double shapeDistanceLowerBoundMetres;
+    bool usePlane;
+    uGeofencePlanePosition_t planePosition;
 
+    if (pDistanceMillimetresMin != NULL) {
+        *pDistanceMillimetresMin = 0;
+    }
     if ((pFence != NULL) && (latitudeX1e9 < U_GEOFENCE_LIMIT_LATITUDE_DEGREES_X1E9) &&
         (latitudeX1e9 > -U_GEOFENCE_LIMIT_LATITUDE_DEGREES_X1E9) &&
         (longitudeX1e9 < U_GEOFENCE_LIMIT_LONGITUDE_DEGREES_X1E9) &&
@@ -1594,10 +2587,16 @@ bool testPosition(const uGeofence_t *pFence,
                 pShape = (uGeofenceShape_t *) pList->p;
                 if (pShape != NULL) {
                     positionState = U_GEOFENCE_POSITION_STATE_NONE;
+                    shapeDistanceLowerBoundMetres = 0;
                     // Before we bother checking a shape in detail, see if
                     // we can eliminate it based on square extent or speed
                     if (radiusMillimetres < U_GEOFENCE_SQUARE_EXTENT_CHECK_UNCERTAINTY_METRES * 1000) {
                         positionState = testSquareExtent(&(pShape->squareExtent), &coordinates);
+                        if ((positionState == U_GEOFENCE_POSITION_STATE_OUTSIDE) &&
+                            (pDistanceMillimetresMin != NULL)) {
+                            shapeDistanceLowerBoundMetres = squareExtentDistanceMin(&(pShape->squareExtent),
+                                                                                    &coordinates);
+                        }
                     }
                     if ((positionState != U_GEOFENCE_POSITION_STATE_OUTSIDE) && (pDynamic != NULL)) {
                         positionState = testSpeed(pDynamic);
@@ -1605,24 +2604,46 @@ bool testPosition(const uGeofence_t *pFence,
                     if (positionState != U_GEOFENCE_POSITION_STATE_OUTSIDE) {
                         uncertain = false;
                         distanceMetres = NAN;
+                        // A small shape may be tested in its local plane,
+                        // provided the position is in range of it
+                        usePlane = !wgs84Required && (pShape->pPlane != NULL) &&
+                                   planeGetPosition(pShape->pPlane, latitudeX1e9,
+                                                    longitudeX1e9, &planePosition);
                         switch (pShape->type) {
                             case U_GEOFENCE_SHAPE_TYPE_CIRCLE:
-                                positionState = testCircle(pShape->u.pCircle,
-                                                           wgs84Required || pShape->wgs84Required,
-                                                           metresPerDegreeLongitude,
-                                                           &coordinates,
-                                                           radiusMillimetres,
-                                                           &distanceMetres,
-                                                           &uncertain);
+                                if (usePlane) {
+                                    positionState = testCirclePlane(pShape->pPlane,
+                                                                    &planePosition,
+                                                                    radiusMillimetres,
+                                                                    &distanceMetres,
+                                                                    &uncertain);
+                                } else {
+                                    positionState = testCircle(pShape->u.pCircle,
+                                                               wgs84Required || pShape->wgs84Required,
+                                                               metresPerDegreeLongitude,
+                                                               &coordinates,
+                                                               radiusMillimetres,
+                                                               &distanceMetres,
+                                                               &uncertain);
+                                }
                                 break;
                             case U_GEOFENCE_SHAPE_TYPE_POLYGON:
-                                positionState = testPolygon(pShape->u.pPolygon,
-                                                            wgs84Required || pShape->wgs84Required,
-                                                            metresPerDegreeLongitude,
-                                                            &coordinates,
-                                                            radiusMillimetres,
-                                                            &distanceMetres,
-                                                            &uncertain);
+                                if (usePlane) {
+                                    positionState = testPolygonPlane(pShape->pPlane,
+                                                                     pShape->u.pPolygon->numVertices,
+                                                                     &planePosition,
+                                                                     radiusMillimetres,
+                                                                     &distanceMetres,
+                                                                     &uncertain);
+                                } else {
+                                    positionState = testPolygon(pShape->u.pPolygon,
+                                                                wgs84Required || pShape->wgs84Required,
+                                                                metresPerDegreeLongitude,
+                                                                &coordinates,
+                                                                radiusMillimetres,
+                                                                &distanceMetres,
+                                                                &uncertain);
+                                }
                                 break;
                             default:
                                 break;
@@ -1641,11 +2662,24 @@ bool testPosition(const uGeofence_t *pFence,
                                                                       pessimisticNotOptimistic,
                                                                       positionState,
                                                                       previousPositionState);
+                        } else if (distanceMetres == distanceMetres) { // NAN test
+                            // Only a certain outcome has a complete distance
+                            shapeDistanceLowerBoundMetres = distanceMetres;
                         }
                     }
+                    if ((distanceLowerBoundMetres != distanceLowerBoundMetres) || // NAN test
+                        (shapeDistanceLowerBoundMetres < distanceLowerBoundMetres)) {
+                        distanceLowerBoundMetres = shapeDistanceLowerBoundMetres;
+                    }
                 }
                 pList = pList->pNext;
             }
+            if ((pDistanceMillimetresMin != NULL) &&
+                (positionState == U_GEOFENCE_POSITION_STATE_OUTSIDE) &&
+                (distanceLowerBoundMetres > 0)) {
+                *pDistanceMillimetresMin = (int64_t) (distanceLowerBoundMetres * 1000 *
+                                                      U_GEOFENCE_DISTANCE_MIN_SAFETY_FACTOR);
+            }
             if (pDynamic != NULL) {
                 pDynamic->lastStatus.distanceMillimetres = LLONG_MIN;
                 if (positionState == U_GEOFENCE_POSITION_STATE_INSIDE) {
@@ -1674,6 +2708,40 @@ bool testPosition(const uGeofence_t *pFence,
     return testIsMet;
 }
 
+// Test a single position against a fence on its own, as
+// uGeofenceTest() does, updating the position state and distance
+// that the fence keeps for itself; gMutex must be locked.
+static bool fenceTest(uGeofence_t *pFence,
+                      uGeofenceTestType_t testType,
+                      bool pessimisticNotOptimistic,
+                      int64_t latitudeX1e9,
+                      int64_t longitudeX1e9,
+                      int32_t altitudeMillimetres,
+                      int32_t radiusMillimetres,
+                      int32_t altitudeUncertaintyMillimetres)
+{
+    bool testIsMet;
+    uGeofencePositionState_t positionState = pFence->positionState;
+    uGeofenceDynamic_t dynamic = {0};
+
+    dynamic.lastStatus.distanceMillimetres = LLONG_MIN;
+    dynamic.maxHorizontalSpeedMillimetresPerSecond = -1;
+    testIsMet = testPosition(pFence, testType,
+                             pessimisticNotOptimistic,
+                             &positionState,
+                             &dynamic, NULL,
+                             latitudeX1e9, longitudeX1e9,
+                             altitudeMillimetres,
+                             radiusMillimetres,
+                             altitudeUncertaintyMillimetres);
+    if (positionState != U_GEOFENCE_POSITION_STATE_NONE) {
+        pFence->positionState = positionState;
+        pFence->distanceMinMillimetres = dynamic.lastStatus.distanceMillimetres;
+    }
+
+    return testIsMet;
+}
+
 #endif // U_CFG_GEOFENCE
 
 /* ----------------------------------------------------------------
@@ -1715,7 +2783,22 @@ int32_t uGeofenceApply(uGeofenceContext_t **ppFenceContext,
         errorCode = uGeofenceContextEnsure(ppFenceContext);
         if ((*ppFenceContext != NULL) &&
             uLinkedListAdd(&((*ppFenceContext)->pFences), (void *) pFence)) {
+            if (pFence->referenceCount == 0) {
+                // The fence can no longer be changed, so tidy it up
+                // and give its small shapes a local plane
+                fenceCompact(pFence);
+                planeCreateAll(pFence);
+            }
             pFence->referenceCount++;
+            // Keep the spatial index up to date; if there isn't one
+            // (e.g. because we ran out of memory last time) try to
+            // create it, failing which all fences are simply tested
+            if ((*ppFenceContext)->pIndex == NULL) {
+                indexCreate(*ppFenceContext);
+            } else if (!indexAddFence((*ppFenceContext)->pIndex, pFence)) {
+                indexFree(*ppFenceContext);
+            }
+            statusAdd(*ppFenceContext, pFence);
             errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
         } else {
             // Clean up on error
@@ -1749,9 +2832,19 @@ int32_t uGeofenceRemove(uGeofenceContext_t **ppFenceContext,
                     uLinkedListRemove(&((*ppFenceContext)->pFences), pList->p);
                     pList = pListNext;
                 }
+                indexFree(*ppFenceContext);
+                statusFree(*ppFenceContext);
             } else {
                 // Just the one
-                uLinkedListRemove(&((*ppFenceContext)->pFences), (void *) pFence);
+                if (uLinkedListRemove(&((*ppFenceContext)->pFences), (void *) pFence)) {
+                    if ((*ppFenceContext)->pIndex != NULL) {
+                        indexRemoveFence((*ppFenceContext)->pIndex, pFence);
+                    }
+                    statusRemove(*ppFenceContext, pFence);
+                }
+                if ((*ppFenceContext)->pFences == NULL) {
+                    indexFree(*ppFenceContext);
+                }
                 if (pFence->referenceCount > 0) {
                     pFence->referenceCount--;
                 }
@@ -1849,6 +2942,16 @@ uGeofencePositionState_t uGeofenceContextTest(uDeviceHandle_t devHandle,
     uGeofenceDynamic_t dynamicsMinDistance;
     uGeofenceTestType_t _testType;
     bool _pessimisticNotOptimistic;
+    bool useIndex = false;
+    size_t bucket[U_GEOFENCE_INDEX_NUM_LEVELS];
+    const uLinkedList_t *pIndexBucket[U_GEOFENCE_INDEX_NUM_LEVELS];
+    const uLinkedList_t *pIndexUnindexed = NULL;
+    bool isCandidate;
+    const uLinkedList_t *pStatusList = NULL;
+    uGeofenceFenceStatus_t *pFenceStatus;
+    int64_t distanceMillimetresMin;
+    int32_t timeNowMs = 0;
+    bool positionIsValid;
 
     if ((pFenceContext != NULL) && (pFenceContext->pFences != NULL)) {
         pList = pFenceContext->pFences;
@@ -1859,6 +2962,33 @@ uGeofencePositionState_t uGeofenceContextTest(uDeviceHandle_t devHandle,
             _pessimisticNotOptimistic = pessimisticNotOptimistic;
         }
         dynamicsMinDistance = pFenceContext->dynamic;
+        // If there is a spatial index, and the position is such that
+        // square extent checks can be made, then only the fences in
+        // the buckets the position falls into, plus those that could
+        // not be indexed, need to be tested in detail: every shape of
+        // every other fence would be eliminated by its square extent
+        if ((pFenceContext->pIndex != NULL) &&
+            indexBucketForPosition(latitudeX1e9, longitudeX1e9,
+                                   radiusMillimetres, bucket)) {
+            useIndex = true;
+            for (size_t level = 0; level < U_GEOFENCE_INDEX_NUM_LEVELS; level++) {
+                pIndexBucket[level] = pFenceContext->pIndex->pBucket[bucket[level]];
+            }
+            pIndexUnindexed = pFenceContext->pIndex->pUnindexed;
+        }
+        // If the maximum speed of the device is known, fences that it
+        // cannot have reached since they were last tested in full
+        // need not be tested again
+        positionIsValid = (latitudeX1e9 < U_GEOFENCE_LIMIT_LATITUDE_DEGREES_X1E9) &&
+                          (latitudeX1e9 > -U_GEOFENCE_LIMIT_LATITUDE_DEGREES_X1E9) &&
+                          (longitudeX1e9 < U_GEOFENCE_LIMIT_LONGITUDE_DEGREES_X1E9) &&
+                          (longitudeX1e9 > -U_GEOFENCE_LIMIT_LONGITUDE_DEGREES_X1E9) &&
+                          (radiusMillimetres >= 0);
+        if (positionIsValid &&
+            (pFenceContext->dynamic.maxHorizontalSpeedMillimetresPerSecond >= 0)) {
+            pStatusList = pFenceContext->pFenceStatus;
+            timeNowMs = uPortGetTickTimeMs();
+        }
         while (pList != NULL) {
             // Test against each fence and call the callback each
             // time, so that the callback gets to know whether the
@@ -1867,14 +2997,47 @@ uGeofencePositionState_t uGeofenceContextTest(uDeviceHandle_t devHandle,
             fencePositionState = pFenceContext->positionState;
             if (pFence != NULL) {
                 dynamic = dynamicsMinDistance;
-                testPosition(pFence, _testType,
-                             _pessimisticNotOptimistic,
-                             &fencePositionState,
-                             &dynamic,
-                             latitudeX1e9, longitudeX1e9,
-                             altitudeMillimetres,
-                             radiusMillimetres,
-                             altitudeUncertaintyMillimetres);
+                isCandidate = !useIndex || indexIsCandidate(pFence, pIndexBucket, &pIndexUnindexed);
+                pFenceStatus = pStatusNext(pFence, &pStatusList);
+                if ((pFenceStatus != NULL) &&
+                    statusFenceIsOutOfReach(pFenceStatus,
+                                            pFenceContext->dynamic.maxHorizontalSpeedMillimetresPerSecond,
+                                            timeNowMs, radiusMillimetres)) {
+                    // The outcome is known to be "outside" without
+                    // the distance having been calculated
+                    dynamic.lastStatus.distanceMillimetres = LLONG_MIN;
+                    fencePositionState = U_GEOFENCE_POSITION_STATE_OUTSIDE;
+                } else if (isCandidate) {
+                    distanceMillimetresMin = 0;
+                    testPosition(pFence, _testType,
+                                 _pessimisticNotOptimistic,
+                                 &fencePositionState,
+                                 &dynamic,
+                                 pFenceStatus != NULL ? &distanceMillimetresMin : NULL,
+                                 latitudeX1e9, longitudeX1e9,
+                                 altitudeMillimetres,
+                                 radiusMillimetres,
+                                 altitudeUncertaintyMillimetres);
+                    if (pFenceStatus != NULL) {
+                        pFenceStatus->distanceMillimetresMin = distanceMillimetresMin;
+                        pFenceStatus->timeMs = timeNowMs;
+                    }
+                } else {
+                    // The outcome is known to be "outside"; do to the
+                    // distance what testPosition() would have done,
+                    // which depends on whether it got past the altitude
+                    // check to the shapes
+                    if (testAltitude(pFence, altitudeMillimetres, _testType,
+                                     _pessimisticNotOptimistic, fencePositionState,
+                                     altitudeUncertaintyMillimetres) != U_GEOFENCE_POSITION_STATE_OUTSIDE) {
+                        dynamic.lastStatus.distanceMillimetres = LLONG_MIN;
+                    }
+                    fencePositionState = U_GEOFENCE_POSITION_STATE_OUTSIDE;
+                    if (pFenceStatus != NULL) {
+                        // No distance is known
+                        pFenceStatus->distanceMillimetresMin = 0;
+                    }
+                }
                 if (pFenceContext->positionState == U_GEOFENCE_POSITION_STATE_NONE) {
                     // If we've never updated the instance position state, do it now
                     pFenceContext->positionState = fencePositionState;
@@ -1901,7 +3064,7 @@ uGeofencePositionState_t uGeofenceContextTest(uDeviceHandle_t devHandle,
                 if ((dynamic.lastStatus.distanceMillimetres != LLONG_MIN) &&
                     (dynamic.lastStatus.distanceMillimetres < dynamicsMinDistance.lastStatus.distanceMillimetres)) {
                     dynamicsMinDistance.lastStatus.distanceMillimetres = dynamic.lastStatus.distanceMillimetres;
-                    dynamicsMinDistance.lastStatus.distanceMillimetres = uPortGetTickTimeMs();
+                    dynamicsMinDistance.lastStatus.timeMs = uPortGetTickTimeMs();
                 }
                 if ((pFenceContext->pCallback != NULL) && (devHandle != NULL)) {
                     pFenceContext->pCallback(devHandle, pFence, pFence->pNameStr,
@@ -1951,6 +3114,8 @@ void uGeofenceContextFree(uGeofenceContext_t **ppFenceContext)
             uLinkedListRemove(&((*ppFenceContext)->pFences), pList->p);
             pList = pListNext;
         }
+        indexFree(*ppFenceContext);
+        statusFree(*ppFenceContext);
         uPortFree(*ppFenceContext);
         *ppFenceContext = NULL;
     }
@@ -2111,8 +3276,8 @@ int32_t uGeofenceAddVertex(uGeofence_t *pFence,
 #ifdef U_CFG_GEOFENCE
     uLinkedList_t *pList;
     uGeofenceShape_t *pShape = NULL;
-    uGeofenceCoordinates_t *pVertex = NULL;
-    uLinkedList_t **ppPolygon = NULL;
+    uGeofenceCoordinates_t vertex;
+    uGeofencePolygon_t *pPolygon = NULL;
 
     errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
 
@@ -2139,50 +3304,49 @@ int32_t uGeofenceAddVertex(uGeofence_t *pFence,
                     }
                     pShape = (uGeofenceShape_t *) pList->p;
                     if ((pShape != NULL) && (pShape->type == U_GEOFENCE_SHAPE_TYPE_POLYGON)) {
-                        ppPolygon = &pShape->u.pPolygon;
+                        pPolygon = pShape->u.pPolygon;
                     }
                 }
-                if ((ppPolygon == NULL) || newPolygon) {
+                if ((pPolygon == NULL) || newPolygon) {
                     newPolygon = true;
-                    // Need a new shape: allocate one (don't populate it yet)
+                    pPolygon = NULL;
+                    // Need a new shape: allocate one, and its polygon
+                    // (don't populate them yet)
                     pShape = (uGeofenceShape_t *) pUPortMalloc(sizeof(*pShape));
                     if (pShape != NULL) {
                         memset(pShape, 0, sizeof(*pShape));
                         pShape->type = U_GEOFENCE_SHAPE_TYPE_POLYGON;
-                        ppPolygon = &(pShape->u.pPolygon);
-                    }
-                }
-                if (ppPolygon != NULL) {
-                    // Allocate and populate the vertex
-                    pVertex = pUPortMalloc(sizeof(uGeofenceCoordinates_t));
-                    if (pVertex != NULL) {
-                        pVertex->latitude = ((double) latitudeX1e9) / 1000000000ULL;
-                        pVertex->longitude = ((double) longitudeX1e9) / 1000000000ULL;
-                        // Add it to the list
-                        if (uLinkedListAdd(ppPolygon, pVertex)) {
-                            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
-                            // Update the square extent and set wgs84Required
-                            updateSquareExtentAndWgs84(pShape);
-                            if (newPolygon) {
-                                // If this is a new shape, add it to the list
-                                if (!uLinkedListAdd(&(pFence->pShapes), pShape)) {
-                                    errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
-                                    // Clean up on error
-                                    uLinkedListRemove(ppPolygon, pVertex);
-                                    uPortFree(pVertex);
-                                    uPortFree(pShape);
-                                }
-                            }
+                        pPolygon = (uGeofencePolygon_t *) pUPortMalloc(sizeof(*pPolygon));
+                        if (pPolygon != NULL) {
+                            memset(pPolygon, 0, sizeof(*pPolygon));
+                            pShape->u.pPolygon = pPolygon;
                         } else {
                             // Clean up on error
-                            uPortFree(pVertex);
-                            if (newPolygon) {
+                            uPortFree(pShape);
+                        }
+                    }
+                }
+                if (pPolygon != NULL) {
+                    // Populate the vertex and add it to the polygon
+                    vertex.latitude = ((double) latitudeX1e9) / 1000000000ULL;
+                    vertex.longitude = ((double) longitudeX1e9) / 1000000000ULL;
+                    if (polygonAddVertex(pPolygon, &vertex)) {
+                        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                        // Update the square extent and set wgs84Required
+                        updateSquareExtentAndWgs84(pShape);
+                        if (newPolygon) {
+                            // If this is a new shape, add it to the list
+                            if (!uLinkedListAdd(&(pFence->pShapes), pShape)) {
+                                errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                                // Clean up on error
+                                fenceClearMapDataPolygon(&(pShape->u.pPolygon));
                                 uPortFree(pShape);
                             }
                         }
                     } else {
                         // Clean up on error
                         if (newPolygon) {
+                            fenceClearMapDataPolygon(&(pShape->u.pPolygon));
                             uPortFree(pShape);
                         }
                     }
@@ -2309,8 +3473,6 @@ bool uGeofenceTest(uGeofence_t *pFence, uGeofenceTestType_t testType,
     bool testIsMet = false;
 
 #ifdef U_CFG_GEOFENCE
-    uGeofencePositionState_t positionState;
-    uGeofenceDynamic_t dynamic = {0};
     // Make sure that we are initialised
     init();
 
@@ -2318,21 +3480,10 @@ bool uGeofenceTest(uGeofence_t *pFence, uGeofenceTestType_t testType,
 
         U_PORT_MUTEX_LOCK(gMutex);
 
-        dynamic.lastStatus.distanceMillimetres = LLONG_MIN;
-        dynamic.maxHorizontalSpeedMillimetresPerSecond = -1;
-        positionState = pFence->positionState;
-        testIsMet = testPosition(pFence, testType,
-                                 pessimisticNotOptimistic,
-                                 &positionState,
-                                 &dynamic,
-                                 latitudeX1e9, longitudeX1e9,
-                                 altitudeMillimetres,
-                                 radiusMillimetres,
-                                 altitudeUncertaintyMillimetres);
-        if (positionState != U_GEOFENCE_POSITION_STATE_NONE) {
-            pFence->positionState = positionState;
-            pFence->distanceMinMillimetres = dynamic.lastStatus.distanceMillimetres;
-        }
+        testIsMet = fenceTest(pFence, testType, pessimisticNotOptimistic,
+                              latitudeX1e9, longitudeX1e9,
+                              altitudeMillimetres, radiusMillimetres,
+                              altitudeUncertaintyMillimetres);
 
         U_PORT_MUTEX_UNLOCK(gMutex);
     }
@@ -2350,6 +3501,68 @@ bool uGeofenceTest(uGeofence_t *pFence, uGeofenceTestType_t testType,
     return testIsMet;
 }
 
+// Test a batch of positions against a geofence.
+int32_t uGeofenceTestBatch(uGeofence_t *pFence, uGeofenceTestType_t testType,
+                           bool pessimisticNotOptimistic,
+                           const uGeofencePosition_t *pPositions,
+                           size_t numPositions,
+                           bool *pTestIsMet,
+                           uGeofencePositionState_t *pPositionState)
+{
+    int32_t errorCodeOrCount;
+
+#ifdef U_CFG_GEOFENCE
+    const uGeofencePosition_t *pPosition = pPositions;
+    bool testIsMet;
+
+    errorCodeOrCount = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+
+    // Make sure that we are initialised
+    init();
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        errorCodeOrCount = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((pFence != NULL) && ((pPositions != NULL) || (numPositions == 0))) {
+            errorCodeOrCount = 0;
+            for (size_t x = 0; x < numPositions; x++) {
+                testIsMet = fenceTest(pFence, testType, pessimisticNotOptimistic,
+                                      pPosition->latitudeX1e9,
+                                      pPosition->longitudeX1e9,
+                                      pPosition->altitudeMillimetres,
+                                      pPosition->radiusMillimetres,
+                                      pPosition->altitudeUncertaintyMillimetres);
+                if (testIsMet) {
+                    errorCodeOrCount++;
+                }
+                if (pTestIsMet != NULL) {
+                    pTestIsMet[x] = testIsMet;
+                }
+                if (pPositionState != NULL) {
+                    pPositionState[x] = pFence->positionState;
+                }
+                pPosition++;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+#else
+    errorCodeOrCount = (int32_t) U_ERROR_COMMON_NOT_COMPILED;
+    (void) pFence;
+    (void) testType;
+    (void) pessimisticNotOptimistic;
+    (void) pPositions;
+    (void) numPositions;
+    (void) pTestIsMet;
+    (void) pPositionState;
+#endif
+
+    return errorCodeOrCount;
+}
+
 // Free gMutex.
 void uGeofenceCleanUp()
 {
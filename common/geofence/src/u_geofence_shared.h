@@ -55,10 +55,51 @@ typedef struct {
     uGeofenceDynamicStatus_t lastStatus;
 } uGeofenceDynamic_t;
 
+/** A spatial index over the fences of a geofence context, built
+ * by uGeofenceApply() and used by uGeofenceContextTest() to discard
+ * quickly fences that a position cannot be inside.  The earth is
+ * divided into cells of #U_GEOFENCE_INDEX_CELL_SIZE_DEGREES_FLOAT,
+ * and larger at each of #U_GEOFENCE_INDEX_NUM_LEVELS levels, which
+ * are hashed into #U_GEOFENCE_INDEX_NUM_BUCKETS buckets; each
+ * bucket lists the fences that have a shape whose square extent
+ * touches a cell, at the level the shape is indexed at, hashing to
+ * that bucket.  Fences that cannot be
+ * indexed (e.g. because a shape is too big to have a square extent)
+ * are listed in pUnindexed and are always tested.  All of the lists
+ * are kept in the same order as pFences in #uGeofenceContext_t.
+ */
+typedef struct {
+    uLinkedList_t *pBucket[U_GEOFENCE_INDEX_NUM_BUCKETS]; /**< linked lists containing #uGeofence_t. */
+    uLinkedList_t *pUnindexed; /**< a linked list containing #uGeofence_t. */
+} uGeofenceIndex_t;
+
+/** What is remembered about a fence of a geofence context between
+ * one position and the next so that, provided the maximum horizontal
+ * speed in #uGeofenceDynamic_t is known, a fence which the device
+ * cannot have reached since the fence was last tested in full need
+ * not be tested again.
+ */
+typedef struct {
+    const uGeofence_t *pFence; /**< the fence that this refers to. */
+    int64_t distanceMillimetresMin; /**< a lower bound on the horizontal
+                                         distance from the position last
+                                         tested in full to any shape of
+                                         the fence; zero if not known. */
+    int32_t timeMs; /**< when that position was tested, populated from
+                         uPortGetTickTimeMs(). */
+} uGeofenceFenceStatus_t;
+
 /** Context for a geofence, may be associated with a device.
  */
 typedef struct {
     uLinkedList_t *pFences; /**< a linked list containing #uGeofence_t. */
+    uGeofenceIndex_t *pIndex; /**< spatial index over pFences, NULL if
+                                   there is none, in which case all
+                                   fences are tested. */
+    uLinkedList_t *pFenceStatus; /**< a linked list containing
+                                      #uGeofenceFenceStatus_t, at most
+                                      one for each entry in pFences
+                                      and in the same order. */
     uGeofencePositionState_t positionState;
     uGeofenceCallback_t *pCallback;
     void *pCallbackParam;
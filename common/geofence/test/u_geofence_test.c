@@ -116,6 +116,92 @@
 # define U_GEOFENCE_TEST_STAR_POINTS_PER_RAY 16
 #endif
 
+#ifndef U_GEOFENCE_TEST_INDEX_NUM_COPIES
+/** When testing the spatial index over the fences applied to a
+ * context, the number of copies of each fence of the test data to
+ * apply, spread evenly in longitude around the earth.
+ */
+# define U_GEOFENCE_TEST_INDEX_NUM_COPIES 60
+#endif
+
+#ifndef U_GEOFENCE_TEST_INDEX_SPARSE_ROWS
+/** When testing the spatial index over many small fences spread
+ * across the earth, the number of rows of fences in latitude.
+ */
+# define U_GEOFENCE_TEST_INDEX_SPARSE_ROWS 20
+#endif
+
+#ifndef U_GEOFENCE_TEST_INDEX_SPARSE_COLUMNS
+/** When testing the spatial index over many small fences spread
+ * across the earth, the number of columns of fences in longitude.
+ */
+# define U_GEOFENCE_TEST_INDEX_SPARSE_COLUMNS 50
+#endif
+
+#ifndef U_GEOFENCE_TEST_INDEX_SPARSE_RADIUS_MILLIMETRES
+/** When testing the spatial index over many small fences spread
+ * across the earth, the radius of each fence, a circle.
+ */
+# define U_GEOFENCE_TEST_INDEX_SPARSE_RADIUS_MILLIMETRES 1000000
+#endif
+
+#ifndef U_GEOFENCE_TEST_BATCH_REPEATS
+/** When testing the fixed-point path, the number of times to run
+ * each position, so that there is something to time.
+ */
+# define U_GEOFENCE_TEST_BATCH_REPEATS 20
+#endif
+
+#ifndef U_GEOFENCE_TEST_BATCH_MIN_TIME_MS
+/** When testing uGeofenceTestBatch(), each track is run point by
+ * point over and over until at least this long has passed, and
+ * then as a batch the same number of times, so that the tick
+ * resolution of uPortGetTickTimeMs() doesn't swamp the timings.
+ */
+# define U_GEOFENCE_TEST_BATCH_MIN_TIME_MS 20
+#endif
+
+#ifndef U_GEOFENCE_TEST_INCREMENTAL_NUM_FIXES
+/** When testing incremental evaluation of the fences applied to a
+ * context, the number of fixes to test at each position.
+ */
+# define U_GEOFENCE_TEST_INCREMENTAL_NUM_FIXES 10
+#endif
+
+#ifndef U_GEOFENCE_TEST_INCREMENTAL_MAX_SPEED_MILLIMETRES_PER_SECOND
+/** When testing incremental evaluation of the fences applied to a
+ * context, the maximum horizontal speed of the device.
+ */
+# define U_GEOFENCE_TEST_INCREMENTAL_MAX_SPEED_MILLIMETRES_PER_SECOND 50000
+#endif
+
+#ifndef U_GEOFENCE_TEST_FIXED_POINT_ERROR_MILLIMETRES
+/** The largest difference, in millimetres, allowed between a
+ * distance calculated in the local plane of a small shape and one
+ * calculated in floating point; a larger difference is allowed
+ * if it is no more than #U_GEOFENCE_TEST_FIXED_POINT_ERROR_PER_MILLE
+ * of the distance.
+ */
+# define U_GEOFENCE_TEST_FIXED_POINT_ERROR_MILLIMETRES 10
+#endif
+
+#ifndef U_GEOFENCE_TEST_FIXED_POINT_ERROR_PER_MILLE
+/** The largest difference, in parts per thousand of the distance,
+ * allowed between a distance calculated in the local plane of a
+ * small shape and one calculated in flat X/Y floating point.
+ */
+# define U_GEOFENCE_TEST_FIXED_POINT_ERROR_PER_MILLE 1
+#endif
+
+#ifndef U_GEOFENCE_TEST_FIXED_POINT_WGS84_ERROR_PER_MILLE
+/** The largest difference, in parts per thousand of the distance,
+ * allowed between a distance calculated in the local plane of a
+ * small shape and one calculated with WGS84 or, if that is not
+ * available, a spherical earth.
+ */
+# define U_GEOFENCE_TEST_FIXED_POINT_WGS84_ERROR_PER_MILLE 10
+#endif
+
 #ifdef _WIN32
 /** The radius of a spherical earth in metres.
  */
@@ -164,6 +250,16 @@ typedef struct {
  */
 static uGeofence_t *gpFence = NULL;
 
+/** A copy of gpFence that is applied to gpFixedPointFenceContext,
+ * and so has a local plane for each small shape, when testing the
+ * fixed-point path.
+ */
+static uGeofence_t *gpFenceFixedPoint = NULL;
+
+/** The context that gpFenceFixedPoint is applied to.
+ */
+static uGeofenceContext_t *gpFixedPointFenceContext = NULL;
+
 /** String to print for each test type.
  */
 static const char *gpTestTypeString[] = {"none", "in", "out", "transit"};
@@ -199,6 +295,33 @@ static const bool gPessimisticNotOptimistic[] = {
     true, false, true, false, true, false
 };
 
+/** The fences applied to the context when testing the spatial
+ * index, in the order they are in the context.
+ */
+static uGeofence_t **gpIndexFence = NULL;
+
+/** The number of entries in gpIndexFence.
+ */
+static size_t gIndexNumFences = 0;
+
+/** The context that the fences in gpIndexFence are applied to.
+ */
+static uGeofenceContext_t *gpIndexFenceContext = NULL;
+
+/** The position state reported to indexCallback() for each fence
+ * of gpIndexFence.
+ */
+static uGeofencePositionState_t *gpIndexPositionState = NULL;
+
+/** The number of times indexCallback() has been called.
+ */
+static size_t gIndexCallbackCount = 0;
+
+/** Set to true by indexCallback() if it is called for fences in
+ * an order other than that of gpIndexFence.
+ */
+static bool gIndexCallbackOutOfOrder = false;
+
 #ifdef _WIN32
 /** File handle, used for writing KML files on Windows.
  */
@@ -392,6 +515,518 @@ static void printTestPoint(const char *pPrefix,
              pTestPoint->outcomeBitMap & (1U << gTestParameters[parametersIndex]) ? "true" : "false");
 }
 
+// Shift a longitude from the test data for the given copy of a
+// fence when testing the spatial index.
+static int64_t indexShiftLongitudeX1e9(int64_t longitudeX1e9, size_t copy)
+{
+    longitudeX1e9 += (int64_t) copy * (360000000000LL / U_GEOFENCE_TEST_INDEX_NUM_COPIES);
+    while (longitudeX1e9 > U_GEOFENCE_TEST_LONGITUDE_MAX_X1E9) {
+        longitudeX1e9 -= 360000000000LL;
+    }
+    if (longitudeX1e9 < U_GEOFENCE_TEST_LONGITUDE_MIN_X1E9) {
+        longitudeX1e9 = U_GEOFENCE_TEST_LONGITUDE_MIN_X1E9;
+    }
+
+    return longitudeX1e9;
+}
+
+// Callback for uGeofenceContextTest() when testing the spatial index.
+static void indexCallback(uDeviceHandle_t devHandle,
+                          const void *pFence,
+                          const char *pNameStr,
+                          uGeofencePositionState_t positionState,
+                          int64_t latitudeX1e9,
+                          int64_t longitudeX1e9,
+                          int32_t altitudeMillimetres,
+                          int32_t radiusMillimetres,
+                          int32_t altitudeUncertaintyMillimetres,
+                          int64_t distanceMillimetres,
+                          void *pCallbackParam)
+{
+    (void) devHandle;
+    (void) pNameStr;
+    (void) latitudeX1e9;
+    (void) longitudeX1e9;
+    (void) altitudeMillimetres;
+    (void) radiusMillimetres;
+    (void) altitudeUncertaintyMillimetres;
+    (void) distanceMillimetres;
+    (void) pCallbackParam;
+
+    if ((gIndexCallbackCount < gIndexNumFences) &&
+        (pFence == gpIndexFence[gIndexCallbackCount])) {
+        gpIndexPositionState[gIndexCallbackCount] = positionState;
+    } else {
+        gIndexCallbackOutOfOrder = true;
+    }
+    gIndexCallbackCount++;
+}
+
+// Run every point of the test data whose radius of position is, or
+// is not, small enough for the spatial index to be used, shifted as
+// for a copy of the fence that the point belongs to, against the
+// fences in gpIndexFence, either through uGeofenceContextTest() or
+// fence-by-fence with uGeofenceTest(), returning how long it took
+// in milliseconds; the whole lot is timed, rather than each test,
+// since a test may take well under a tick.
+static int32_t indexTimePoints(bool indexUsable, bool fenceByFence,
+                               size_t *pNumPoints)
+{
+    const uGeofenceTestData_t *pTestData;
+    const uGeofenceTestPoint_t *pTestPoint;
+    const uGeofencePositionVariables_t *pVariables;
+    int64_t longitudeX1e9;
+    int32_t startTimeMs = uPortGetTickTimeMs();
+
+    *pNumPoints = 0;
+    for (size_t x = 0; x < gpUGeofenceTestDataSize; x++) {
+        pTestData = gpUGeofenceTestData[x];
+        for (size_t y = 0; y < pTestData->numPoints; y++) {
+            pTestPoint = pTestData->pPoint[y];
+            pVariables = &(pTestPoint->positionVariables);
+            if ((pVariables->radiusMillimetres <
+                 U_GEOFENCE_SQUARE_EXTENT_CHECK_UNCERTAINTY_METRES * 1000) == indexUsable) {
+                longitudeX1e9 = indexShiftLongitudeX1e9(pTestPoint->pPosition->longitudeX1e9,
+                                                        (x + y) % U_GEOFENCE_TEST_INDEX_NUM_COPIES);
+                // Transit tests have memory, not wanted here
+                for (size_t z = 0; z < sizeof(gTestParameters) / sizeof(gTestParameters[0]); z++) {
+                    if (gTestType[z] != U_GEOFENCE_TEST_TYPE_TRANSIT) {
+                        if (fenceByFence) {
+                            for (size_t f = 0; f < gIndexNumFences; f++) {
+                                uGeofenceTestResetMemory(gpIndexFence[f]);
+                                uGeofenceTest(gpIndexFence[f], gTestType[z],
+                                              gPessimisticNotOptimistic[z],
+                                              pTestPoint->pPosition->latitudeX1e9,
+                                              longitudeX1e9,
+                                              pVariables->altitudeMillimetres,
+                                              pVariables->radiusMillimetres,
+                                              pVariables->altitudeUncertaintyMillimetres);
+                            }
+                        } else {
+                            gIndexCallbackCount = 0;
+                            gpIndexFenceContext->positionState = U_GEOFENCE_POSITION_STATE_NONE;
+                            uGeofenceContextTest((uDeviceHandle_t) &gIndexCallbackCount,
+                                                 gpIndexFenceContext, gTestType[z],
+                                                 gPessimisticNotOptimistic[z],
+                                                 pTestPoint->pPosition->latitudeX1e9,
+                                                 longitudeX1e9,
+                                                 pVariables->altitudeMillimetres,
+                                                 pVariables->radiusMillimetres,
+                                                 pVariables->altitudeUncertaintyMillimetres);
+                        }
+                        (*pNumPoints)++;
+                    }
+                }
+            }
+        }
+    }
+
+    return uPortGetTickTimeMs() - startTimeMs;
+}
+
+// Test every point of the test data, shifted as for a copy of the
+// fence that the point belongs to, against the fences in
+// gpIndexFence, once through uGeofenceContextTest(), which uses
+// the spatial index, and once fence-by-fence with uGeofenceTest(),
+// which does not, checking that the outcomes are the same, then
+// time each way, separately for the points that the spatial index
+// can be used for and those it cannot.
+static void indexTestPoints(const char *pPrefix)
+{
+    const uGeofenceTestData_t *pTestData;
+    const uGeofenceTestPoint_t *pTestPoint;
+    const uGeofencePositionVariables_t *pVariables;
+    int64_t longitudeX1e9;
+    int32_t contextTimeMs;
+    int32_t fenceTimeMs;
+    size_t numPoints = 0;
+    size_t numDifferences = 0;
+
+    for (size_t x = 0; x < gpUGeofenceTestDataSize; x++) {
+        pTestData = gpUGeofenceTestData[x];
+        for (size_t y = 0; y < pTestData->numPoints; y++) {
+            pTestPoint = pTestData->pPoint[y];
+            pVariables = &(pTestPoint->positionVariables);
+            longitudeX1e9 = indexShiftLongitudeX1e9(pTestPoint->pPosition->longitudeX1e9,
+                                                    (x + y) % U_GEOFENCE_TEST_INDEX_NUM_COPIES);
+            // Transit tests have memory, not wanted here
+            for (size_t z = 0; z < sizeof(gTestParameters) / sizeof(gTestParameters[0]); z++) {
+                if (gTestType[z] != U_GEOFENCE_TEST_TYPE_TRANSIT) {
+                    gIndexCallbackCount = 0;
+                    gpIndexFenceContext->positionState = U_GEOFENCE_POSITION_STATE_NONE;
+                    uGeofenceContextTest((uDeviceHandle_t) &gIndexCallbackCount,
+                                         gpIndexFenceContext, gTestType[z],
+                                         gPessimisticNotOptimistic[z],
+                                         pTestPoint->pPosition->latitudeX1e9,
+                                         longitudeX1e9,
+                                         pVariables->altitudeMillimetres,
+                                         pVariables->radiusMillimetres,
+                                         pVariables->altitudeUncertaintyMillimetres);
+                    U_PORT_TEST_ASSERT(gIndexCallbackCount == gIndexNumFences);
+                    U_PORT_TEST_ASSERT(!gIndexCallbackOutOfOrder);
+                    for (size_t f = 0; f < gIndexNumFences; f++) {
+                        uGeofenceTestResetMemory(gpIndexFence[f]);
+                        uGeofenceTest(gpIndexFence[f], gTestType[z],
+                                      gPessimisticNotOptimistic[z],
+                                      pTestPoint->pPosition->latitudeX1e9,
+                                      longitudeX1e9,
+                                      pVariables->altitudeMillimetres,
+                                      pVariables->radiusMillimetres,
+                                      pVariables->altitudeUncertaintyMillimetres);
+                        if (uGeofenceTestGetPositionState(gpIndexFence[f]) != gpIndexPositionState[f]) {
+                            numDifferences++;
+                        }
+                    }
+                    numPoints++;
+                }
+            }
+        }
+    }
+    uPortLog("%s%d point(s) against %d fence(s), %d difference(s).\n", pPrefix,
+             numPoints, gIndexNumFences, numDifferences);
+    U_PORT_TEST_ASSERT(numDifferences == 0);
+
+    contextTimeMs = indexTimePoints(true, false, &numPoints);
+    fenceTimeMs = indexTimePoints(true, true, &numPoints);
+    uPortLog("%s%d point(s) with radius under %d m: %d ms with the spatial index,"
+             " %d ms fence-by-fence.\n", pPrefix, numPoints,
+             U_GEOFENCE_SQUARE_EXTENT_CHECK_UNCERTAINTY_METRES,
+             contextTimeMs, fenceTimeMs);
+    contextTimeMs = indexTimePoints(false, false, &numPoints);
+    fenceTimeMs = indexTimePoints(false, true, &numPoints);
+    uPortLog("%s%d point(s) with larger radius, for which the spatial index"
+             " cannot be used: %d ms through the context, %d ms fence-by-fence.\n",
+             pPrefix, numPoints, contextTimeMs, fenceTimeMs);
+}
+
+// Add the altitude limits and shapes of a fence of the test data to
+// a fence, shifted in longitude as for the given copy when testing
+// the spatial index, returning the number of shapes.
+static size_t addTestShapes(uGeofence_t *pFence, const uGeofenceTestFence_t *pTestFence,
+                            size_t copy)
+{
+    const uGeofenceTestCircle_t *pTestCircle;
+    const uGeofenceTestPolygon_t *pTestPolygon;
+    const uGeofenceTestVertex_t *pTestVertex;
+    size_t numShapes = 0;
+
+    if (pTestFence->altitudeMaxMillimetres != INT_MAX) {
+        U_PORT_TEST_ASSERT(uGeofenceSetAltitudeMax(pFence,
+                                                   pTestFence->altitudeMaxMillimetres) == 0);
+    }
+    if (pTestFence->altitudeMinMillimetres != INT_MIN) {
+        U_PORT_TEST_ASSERT(uGeofenceSetAltitudeMin(pFence,
+                                                   pTestFence->altitudeMinMillimetres) == 0);
+    }
+    for (size_t y = 0; y < pTestFence->numCircles; y++) {
+        pTestCircle = pTestFence->pCircle[y];
+        U_PORT_TEST_ASSERT(uGeofenceAddCircle(pFence,
+                                              pTestCircle->pCentre->latitudeX1e9,
+                                              indexShiftLongitudeX1e9(pTestCircle->pCentre->longitudeX1e9, copy),
+                                              pTestCircle->radiusMillimetres) == 0);
+        numShapes++;
+    }
+    for (size_t y = 0; y < pTestFence->numPolygons; y++) {
+        pTestPolygon = pTestFence->pPolygon[y];
+        for (size_t z = 0; z < pTestPolygon->numVertices; z++) {
+            pTestVertex = pTestPolygon->pVertex[z];
+            U_PORT_TEST_ASSERT(uGeofenceAddVertex(pFence,
+                                                  pTestVertex->latitudeX1e9,
+                                                  indexShiftLongitudeX1e9(pTestVertex->longitudeX1e9, copy),
+                                                  (y > 0) && (z == 0)) == 0);
+        }
+        numShapes++;
+    }
+
+    return numShapes;
+}
+
+// Create copies of all of the fences of the test data, shifted
+// around the earth in longitude, put them in gpIndexFence and apply
+// them to gpIndexFenceContext, returning the number of shapes.
+static size_t indexApplyFences()
+{
+    const uGeofenceTestFence_t *pTestFence;
+    uGeofence_t *pFence;
+    size_t numShapes = 0;
+
+    gIndexNumFences = gpUGeofenceTestDataSize * U_GEOFENCE_TEST_INDEX_NUM_COPIES;
+    gpIndexFence = (uGeofence_t **) pUPortMalloc(gIndexNumFences * sizeof(uGeofence_t *));
+    U_PORT_TEST_ASSERT(gpIndexFence != NULL);
+    memset(gpIndexFence, 0, gIndexNumFences * sizeof(uGeofence_t *));
+    gpIndexPositionState = (uGeofencePositionState_t *) pUPortMalloc(gIndexNumFences *
+                                                                      sizeof(uGeofencePositionState_t));
+    U_PORT_TEST_ASSERT(gpIndexPositionState != NULL);
+
+    for (size_t c = 0; c < U_GEOFENCE_TEST_INDEX_NUM_COPIES; c++) {
+        for (size_t x = 0; x < gpUGeofenceTestDataSize; x++) {
+            pTestFence = gpUGeofenceTestData[x]->pFence;
+            pFence = pUGeofenceCreate(pTestFence->pName);
+            U_PORT_TEST_ASSERT(pFence != NULL);
+            gpIndexFence[(c * gpUGeofenceTestDataSize) + x] = pFence;
+            numShapes += addTestShapes(pFence, pTestFence, c);
+            U_PORT_TEST_ASSERT(uGeofenceApply(&gpIndexFenceContext, pFence) == 0);
+        }
+    }
+    U_PORT_TEST_ASSERT(gpIndexFenceContext != NULL);
+    U_PORT_TEST_ASSERT(uGeofenceSetCallback(&gpIndexFenceContext, U_GEOFENCE_TEST_TYPE_INSIDE,
+                                            false, indexCallback, NULL) == 0);
+
+    return numShapes;
+}
+
+// Return the latitude of the centre of a fence of the sparse grid
+// used when testing the spatial index, spread between +/- 60 degrees.
+static int64_t indexSparseLatitudeX1e9(size_t row)
+{
+    return -60000000000LL + ((int64_t) row * (120000000000LL /
+                                              (U_GEOFENCE_TEST_INDEX_SPARSE_ROWS - 1)));
+}
+
+// Return the longitude of the centre of a fence of the sparse grid
+// used when testing the spatial index, spread all the way round.
+static int64_t indexSparseLongitudeX1e9(size_t column)
+{
+    return -180000000000LL + (((int64_t) column * 2 + 1) * (180000000000LL /
+                                                            U_GEOFENCE_TEST_INDEX_SPARSE_COLUMNS));
+}
+
+// Create a grid of small circular fences spread across the earth,
+// put them in gpIndexFence and apply them to gpIndexFenceContext.
+static void indexApplySparseFences()
+{
+    uGeofence_t *pFence;
+
+    gIndexNumFences = U_GEOFENCE_TEST_INDEX_SPARSE_ROWS * U_GEOFENCE_TEST_INDEX_SPARSE_COLUMNS;
+    gpIndexFence = (uGeofence_t **) pUPortMalloc(gIndexNumFences * sizeof(uGeofence_t *));
+    U_PORT_TEST_ASSERT(gpIndexFence != NULL);
+    memset(gpIndexFence, 0, gIndexNumFences * sizeof(uGeofence_t *));
+    gpIndexPositionState = (uGeofencePositionState_t *) pUPortMalloc(gIndexNumFences *
+                                                                      sizeof(uGeofencePositionState_t));
+    U_PORT_TEST_ASSERT(gpIndexPositionState != NULL);
+
+    for (size_t x = 0; x < gIndexNumFences; x++) {
+        pFence = pUGeofenceCreate(NULL);
+        U_PORT_TEST_ASSERT(pFence != NULL);
+        gpIndexFence[x] = pFence;
+        U_PORT_TEST_ASSERT(uGeofenceAddCircle(pFence,
+                                              indexSparseLatitudeX1e9(x / U_GEOFENCE_TEST_INDEX_SPARSE_COLUMNS),
+                                              indexSparseLongitudeX1e9(x % U_GEOFENCE_TEST_INDEX_SPARSE_COLUMNS),
+                                              U_GEOFENCE_TEST_INDEX_SPARSE_RADIUS_MILLIMETRES) == 0);
+        U_PORT_TEST_ASSERT(uGeofenceApply(&gpIndexFenceContext, pFence) == 0);
+    }
+    U_PORT_TEST_ASSERT(gpIndexFenceContext != NULL);
+    U_PORT_TEST_ASSERT(uGeofenceSetCallback(&gpIndexFenceContext, U_GEOFENCE_TEST_TYPE_INSIDE,
+                                            false, indexCallback, NULL) == 0);
+}
+
+// Test a position at the centre of, and one just beyond the edge of,
+// each fence of the sparse grid against all of the fences in
+// gpIndexFence, either through uGeofenceContextTest() or
+// fence-by-fence with uGeofenceTest(), returning how long it took
+// in milliseconds and counting the outcomes that are not as
+// expected, i.e. inside only the fence whose centre it is.
+static int32_t indexTimeSparsePoints(bool fenceByFence, size_t *pNumPoints,
+                                     size_t *pNumDifferences)
+{
+    int64_t latitudeX1e9;
+    int64_t longitudeX1e9;
+    int32_t startTimeMs = uPortGetTickTimeMs();
+
+    *pNumPoints = 0;
+    for (size_t x = 0; x < gIndexNumFences * 2; x++) {
+        latitudeX1e9 = indexSparseLatitudeX1e9((x / 2) / U_GEOFENCE_TEST_INDEX_SPARSE_COLUMNS);
+        longitudeX1e9 = indexSparseLongitudeX1e9((x / 2) % U_GEOFENCE_TEST_INDEX_SPARSE_COLUMNS);
+        if (x % 2 != 0) {
+            // About 1.2 km north of the edge of the fence
+            latitudeX1e9 += 20000000LL;
+        }
+        if (fenceByFence) {
+            for (size_t f = 0; f < gIndexNumFences; f++) {
+                uGeofenceTestResetMemory(gpIndexFence[f]);
+                if (uGeofenceTest(gpIndexFence[f], U_GEOFENCE_TEST_TYPE_INSIDE,
+                                  false, latitudeX1e9, longitudeX1e9,
+                                  INT_MIN, 10000, -1) != ((x % 2 == 0) && (f == x / 2))) {
+                    (*pNumDifferences)++;
+                }
+            }
+        } else {
+            gIndexCallbackCount = 0;
+            gpIndexFenceContext->positionState = U_GEOFENCE_POSITION_STATE_NONE;
+            if ((uGeofenceContextTest((uDeviceHandle_t) &gIndexCallbackCount,
+                                      gpIndexFenceContext, U_GEOFENCE_TEST_TYPE_INSIDE,
+                                      false, latitudeX1e9, longitudeX1e9,
+                                      INT_MIN, 10000, -1) == U_GEOFENCE_POSITION_STATE_INSIDE) !=
+                (x % 2 == 0)) {
+                (*pNumDifferences)++;
+            }
+        }
+        (*pNumPoints)++;
+    }
+
+    return uPortGetTickTimeMs() - startTimeMs;
+}
+
+// Remove every other fence of gpIndexFence from gpIndexFenceContext
+// and free it.
+static void indexRemoveHalfTheFences()
+{
+    size_t y = 0;
+
+    for (size_t x = 0; x < gIndexNumFences; x++) {
+        if (x % 2 == 0) {
+            U_PORT_TEST_ASSERT(uGeofenceRemove(&gpIndexFenceContext, gpIndexFence[x]) == 0);
+            U_PORT_TEST_ASSERT(uGeofenceFree(gpIndexFence[x]) == 0);
+        } else {
+            gpIndexFence[y] = gpIndexFence[x];
+            y++;
+        }
+    }
+    gIndexNumFences = y;
+}
+
+// Remove all of the fences of gpIndexFence from gpIndexFenceContext,
+// free them and free the context.
+static void indexFreeFences()
+{
+    U_PORT_TEST_ASSERT(uGeofenceRemove(&gpIndexFenceContext, NULL) == 0);
+    U_PORT_TEST_ASSERT(gpIndexFenceContext->pIndex == NULL);
+    U_PORT_TEST_ASSERT(gpIndexFenceContext->pFenceStatus == NULL);
+    uGeofenceContextFree(&gpIndexFenceContext);
+    for (size_t x = 0; x < gIndexNumFences; x++) {
+        U_PORT_TEST_ASSERT(uGeofenceFree(gpIndexFence[x]) == 0);
+    }
+    gIndexNumFences = 0;
+    uPortFree(gpIndexFence);
+    gpIndexFence = NULL;
+    uPortFree(gpIndexPositionState);
+    gpIndexPositionState = NULL;
+}
+
+// Test every point of the test data, shifted as in indexTestPoints(),
+// a number of times in succession against the fences in gpIndexFence
+// through uGeofenceContextTest(), with the maximum horizontal speed
+// of the device known, checking that the outcome is always the same
+// as testing fence-by-fence with uGeofenceTest().  Since the device
+// has not moved after the first fix, fences that are further away
+// than it can have travelled are not tested again.
+static void incrementalTestPoints(const char *pPrefix)
+{
+    const uGeofenceTestData_t *pTestData;
+    const uGeofenceTestPoint_t *pTestPoint;
+    const uGeofencePositionVariables_t *pVariables;
+    uLinkedList_t *pList;
+    int64_t longitudeX1e9;
+    int32_t startTimeMs;
+    int32_t firstFixTimeMs = 0;
+    int32_t laterFixTimeMs = 0;
+    size_t numPoints = 0;
+    size_t numOutOfReach = 0;
+    size_t numDifferences = 0;
+
+    for (size_t x = 0; x < gpUGeofenceTestDataSize; x++) {
+        pTestData = gpUGeofenceTestData[x];
+        for (size_t y = 0; y < pTestData->numPoints; y++) {
+            pTestPoint = pTestData->pPoint[y];
+            pVariables = &(pTestPoint->positionVariables);
+            longitudeX1e9 = indexShiftLongitudeX1e9(pTestPoint->pPosition->longitudeX1e9,
+                                                    (x + y) % U_GEOFENCE_TEST_INDEX_NUM_COPIES);
+            // Transit tests have memory, not wanted here
+            for (size_t z = 0; z < sizeof(gTestParameters) / sizeof(gTestParameters[0]); z++) {
+                if (gTestType[z] != U_GEOFENCE_TEST_TYPE_TRANSIT) {
+                    for (size_t f = 0; f < gIndexNumFences; f++) {
+                        uGeofenceTestResetMemory(gpIndexFence[f]);
+                        uGeofenceTest(gpIndexFence[f], gTestType[z],
+                                      gPessimisticNotOptimistic[z],
+                                      pTestPoint->pPosition->latitudeX1e9,
+                                      longitudeX1e9,
+                                      pVariables->altitudeMillimetres,
+                                      pVariables->radiusMillimetres,
+                                      pVariables->altitudeUncertaintyMillimetres);
+                    }
+                    // The device has jumped from the last point, faster
+                    // than its maximum speed, so forget what is known
+                    for (pList = gpIndexFenceContext->pFenceStatus; pList != NULL; pList = pList->pNext) {
+                        ((uGeofenceFenceStatus_t *) pList->p)->distanceMillimetresMin = 0;
+                    }
+                    for (size_t n = 0; n < U_GEOFENCE_TEST_INCREMENTAL_NUM_FIXES; n++) {
+                        gIndexCallbackCount = 0;
+                        gpIndexFenceContext->positionState = U_GEOFENCE_POSITION_STATE_NONE;
+                        startTimeMs = uPortGetTickTimeMs();
+                        uGeofenceContextTest((uDeviceHandle_t) &gIndexCallbackCount,
+                                             gpIndexFenceContext, gTestType[z],
+                                             gPessimisticNotOptimistic[z],
+                                             pTestPoint->pPosition->latitudeX1e9,
+                                             longitudeX1e9,
+                                             pVariables->altitudeMillimetres,
+                                             pVariables->radiusMillimetres,
+                                             pVariables->altitudeUncertaintyMillimetres);
+                        if (n == 0) {
+                            firstFixTimeMs += uPortGetTickTimeMs() - startTimeMs;
+                            for (pList = gpIndexFenceContext->pFenceStatus; pList != NULL; pList = pList->pNext) {
+                                if (((uGeofenceFenceStatus_t *) pList->p)->distanceMillimetresMin > 0) {
+                                    numOutOfReach++;
+                                }
+                            }
+                        } else {
+                            laterFixTimeMs += uPortGetTickTimeMs() - startTimeMs;
+                        }
+                        U_PORT_TEST_ASSERT(gIndexCallbackCount == gIndexNumFences);
+                        U_PORT_TEST_ASSERT(!gIndexCallbackOutOfOrder);
+                        for (size_t f = 0; f < gIndexNumFences; f++) {
+                            if (uGeofenceTestGetPositionState(gpIndexFence[f]) != gpIndexPositionState[f]) {
+                                numDifferences++;
+                            }
+                        }
+                    }
+                    numPoints++;
+                }
+            }
+        }
+    }
+
+    uPortLog("%s%d point(s) against %d fence(s): %d ms for the first fix at"
+             " each, %d ms for the other %d fix(es) at each, %d fence(s) found"
+             " out of reach, %d difference(s).\n", pPrefix, numPoints,
+             gIndexNumFences, firstFixTimeMs, laterFixTimeMs,
+             U_GEOFENCE_TEST_INCREMENTAL_NUM_FIXES - 1, numOutOfReach, numDifferences);
+    U_PORT_TEST_ASSERT(numOutOfReach > 0);
+    U_PORT_TEST_ASSERT(numDifferences == 0);
+}
+
+// Check that two distances, as returned by uGeofenceTestGetDistanceMin(),
+// agree to within the given number of parts per thousand or
+// U_GEOFENCE_TEST_FIXED_POINT_ERROR_MILLIMETRES, whichever is the
+// larger, returning the difference.
+static int64_t fixedPointDistanceDifference(int64_t distanceMillimetres,
+                                            int64_t referenceDistanceMillimetres,
+                                            int32_t errorPerMille)
+{
+    int64_t differenceMillimetres = 0;
+    int64_t errorMillimetres;
+
+    U_PORT_TEST_ASSERT((distanceMillimetres == LLONG_MIN) ==
+                       (referenceDistanceMillimetres == LLONG_MIN));
+    if (referenceDistanceMillimetres != LLONG_MIN) {
+        differenceMillimetres = distanceMillimetres - referenceDistanceMillimetres;
+        if (differenceMillimetres < 0) {
+            differenceMillimetres = -differenceMillimetres;
+        }
+        errorMillimetres = referenceDistanceMillimetres * errorPerMille / 1000;
+        if (errorMillimetres < U_GEOFENCE_TEST_FIXED_POINT_ERROR_MILLIMETRES) {
+            errorMillimetres = U_GEOFENCE_TEST_FIXED_POINT_ERROR_MILLIMETRES;
+        }
+        if (differenceMillimetres > errorMillimetres) {
+            U_TEST_PRINT_LINE("distance %lld mm, expected %lld mm +/- %lld mm.",
+                              distanceMillimetres, referenceDistanceMillimetres,
+                              errorMillimetres);
+            U_PORT_TEST_ASSERT(false);
+        }
+    }
+
+    return differenceMillimetres;
+}
+
 #ifdef _WIN32
 
 // Write the given position into the given buffer.
@@ -898,6 +1533,404 @@ U_PORT_TEST_FUNCTION("[geofence]", "geofenceBasic")
     U_PORT_TEST_ASSERT(resourceCount <= 0);
 }
 
+/** Test the spatial index over the fences applied to a context,
+ * checking that uGeofenceContextTest() gives the same outcome as
+ * testing each fence individually with thousands of shapes applied,
+ * and reporting how long each takes, separately for positions
+ * certain enough for the index to be used, then doing the same for
+ * many small fences spread across the earth, where the index should
+ * make the most difference.
+ */
+U_PORT_TEST_FUNCTION("[geofence]", "geofenceIndex")
+{
+    int32_t resourceCount;
+    size_t numShapes;
+    size_t numPoints;
+    size_t numDifferences;
+    int32_t contextTimeMs;
+    int32_t noIndexTimeMs;
+    int32_t fenceTimeMs;
+    uGeofenceIndex_t *pIndex;
+
+    uPortDeinit();
+
+    // Get the initial resource count
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    // Need to initialise only the port
+    uPortInit();
+
+    numShapes = indexApplyFences();
+    U_PORT_TEST_ASSERT(gpIndexFenceContext->pIndex != NULL);
+    U_TEST_PRINT_LINE("%d shape(s) in %d fence(s) applied.", numShapes, gIndexNumFences);
+
+    indexTestPoints(U_TEST_PREFIX "all fences: ");
+
+    // Remove every other fence, which the index must follow
+    indexRemoveHalfTheFences();
+    U_PORT_TEST_ASSERT(gpIndexFenceContext->pIndex != NULL);
+
+    indexTestPoints(U_TEST_PREFIX "half the fences: ");
+
+    // Remove the rest and free everything
+    indexFreeFences();
+
+    // Now many small fences spread across the earth, where only a
+    // handful can be near any one position, which is where the
+    // index should make the most difference
+    indexApplySparseFences();
+    U_PORT_TEST_ASSERT(gpIndexFenceContext->pIndex != NULL);
+    numDifferences = 0;
+    contextTimeMs = indexTimeSparsePoints(false, &numPoints, &numDifferences);
+    // Take the index away from the context to see what it is worth
+    pIndex = gpIndexFenceContext->pIndex;
+    gpIndexFenceContext->pIndex = NULL;
+    noIndexTimeMs = indexTimeSparsePoints(false, &numPoints, &numDifferences);
+    gpIndexFenceContext->pIndex = pIndex;
+    fenceTimeMs = indexTimeSparsePoints(true, &numPoints, &numDifferences);
+    U_TEST_PRINT_LINE("%d point(s) against %d small fence(s), %d difference(s): %d ms"
+                      " with the spatial index, %d ms without, %d ms fence-by-fence.",
+                      numPoints, gIndexNumFences, numDifferences, contextTimeMs,
+                      noIndexTimeMs, fenceTimeMs);
+    U_PORT_TEST_ASSERT(numDifferences == 0);
+    indexFreeFences();
+
+    // Free the mutex so that our memory sums add up
+    uGeofenceCleanUp();
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Test incremental evaluation of the fences applied to a context:
+ * when the maximum speed of the device is known, fences that it
+ * cannot have reached since they were last tested should not be
+ * tested again, without changing the outcome.
+ */
+U_PORT_TEST_FUNCTION("[geofence]", "geofenceIncremental")
+{
+    int32_t resourceCount;
+    size_t numShapes;
+
+    uPortDeinit();
+
+    // Get the initial resource count
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    // Need to initialise only the port
+    uPortInit();
+
+    numShapes = indexApplyFences();
+    gpIndexFenceContext->dynamic.maxHorizontalSpeedMillimetresPerSecond =
+        U_GEOFENCE_TEST_INCREMENTAL_MAX_SPEED_MILLIMETRES_PER_SECOND;
+    U_TEST_PRINT_LINE("%d shape(s) in %d fence(s) applied.", numShapes, gIndexNumFences);
+
+    incrementalTestPoints(U_TEST_PREFIX "all fences: ");
+
+    // Remove every other fence, which the fence status must follow
+    indexRemoveHalfTheFences();
+
+    incrementalTestPoints(U_TEST_PREFIX "half the fences: ");
+
+    // Remove the rest and free everything
+    indexFreeFences();
+
+    // Free the mutex so that our memory sums add up
+    uGeofenceCleanUp();
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Test uGeofenceTestBatch(), checking that it gives exactly the
+ * same outcome as calling uGeofenceTest() for each position in turn,
+ * and reporting how long each takes.
+ */
+U_PORT_TEST_FUNCTION("[geofence]", "geofenceBatch")
+{
+    int32_t resourceCount;
+    const uGeofenceTestData_t *pTestData;
+    const uGeofenceTestPoint_t *pTestPoint;
+    uGeofencePosition_t position[U_GEOFENCE_TEST_DATA_MAX_NUM_POINTS];
+    bool testIsMet[U_GEOFENCE_TEST_DATA_MAX_NUM_POINTS];
+    bool testIsMetBatch[U_GEOFENCE_TEST_DATA_MAX_NUM_POINTS];
+    uGeofencePositionState_t positionState[U_GEOFENCE_TEST_DATA_MAX_NUM_POINTS];
+    uGeofencePositionState_t positionStateBatch[U_GEOFENCE_TEST_DATA_MAX_NUM_POINTS];
+    int32_t count;
+    int32_t startTimeMs;
+    int32_t timeMs;
+    int32_t pointTimeMs = 0;
+    int32_t batchTimeMs = 0;
+    size_t repeats;
+    size_t numPositions = 0;
+
+    uPortDeinit();
+
+    // Get the initial resource count
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    // Need to initialise only the port
+    uPortInit();
+
+    gpFence = pUGeofenceCreate(U_GEOFENCE_TEST_FENCE_NAME);
+    U_PORT_TEST_ASSERT(gpFence != NULL);
+
+    // Check for bad parameters
+    U_PORT_TEST_ASSERT(uGeofenceTestBatch(NULL, U_GEOFENCE_TEST_TYPE_INSIDE,
+                                          false, position, 1, NULL, NULL) < 0);
+    U_PORT_TEST_ASSERT(uGeofenceTestBatch(gpFence, U_GEOFENCE_TEST_TYPE_INSIDE,
+                                          false, NULL, 1, NULL, NULL) < 0);
+    U_PORT_TEST_ASSERT(uGeofenceTestBatch(gpFence, U_GEOFENCE_TEST_TYPE_INSIDE,
+                                          false, NULL, 0, NULL, NULL) == 0);
+
+    for (size_t x = 0; x < gpUGeofenceTestDataSize; x++) {
+        pTestData = gpUGeofenceTestData[x];
+        U_PORT_TEST_ASSERT(uGeofenceClearMap(gpFence) == 0);
+        addTestShapes(gpFence, pTestData->pFence, 0);
+        // The points of the test data form the track
+        for (size_t y = 0; y < pTestData->numPoints; y++) {
+            pTestPoint = pTestData->pPoint[y];
+            position[y].latitudeX1e9 = pTestPoint->pPosition->latitudeX1e9;
+            position[y].longitudeX1e9 = pTestPoint->pPosition->longitudeX1e9;
+            position[y].altitudeMillimetres = pTestPoint->positionVariables.altitudeMillimetres;
+            position[y].radiusMillimetres = pTestPoint->positionVariables.radiusMillimetres;
+            position[y].altitudeUncertaintyMillimetres =
+                pTestPoint->positionVariables.altitudeUncertaintyMillimetres;
+        }
+        // Run the track, including the transit tests which have memory,
+        // point by point and then as a batch
+        for (size_t z = 0; z < sizeof(gTestParameters) / sizeof(gTestParameters[0]); z++) {
+            repeats = 0;
+            startTimeMs = uPortGetTickTimeMs();
+            do {
+                uGeofenceTestResetMemory(gpFence);
+                count = 0;
+                for (size_t y = 0; y < pTestData->numPoints; y++) {
+                    testIsMet[y] = uGeofenceTest(gpFence, gTestType[z],
+                                                 gPessimisticNotOptimistic[z],
+                                                 position[y].latitudeX1e9,
+                                                 position[y].longitudeX1e9,
+                                                 position[y].altitudeMillimetres,
+                                                 position[y].radiusMillimetres,
+                                                 position[y].altitudeUncertaintyMillimetres);
+                    positionState[y] = uGeofenceTestGetPositionState(gpFence);
+                    if (testIsMet[y]) {
+                        count++;
+                    }
+                }
+                repeats++;
+                timeMs = uPortGetTickTimeMs() - startTimeMs;
+            } while (timeMs < U_GEOFENCE_TEST_BATCH_MIN_TIME_MS);
+            pointTimeMs += timeMs;
+            startTimeMs = uPortGetTickTimeMs();
+            for (size_t r = 0; r < repeats; r++) {
+                uGeofenceTestResetMemory(gpFence);
+                U_PORT_TEST_ASSERT(uGeofenceTestBatch(gpFence, gTestType[z],
+                                                      gPessimisticNotOptimistic[z],
+                                                      position, pTestData->numPoints,
+                                                      testIsMetBatch,
+                                                      positionStateBatch) == count);
+            }
+            batchTimeMs += uPortGetTickTimeMs() - startTimeMs;
+            for (size_t y = 0; y < pTestData->numPoints; y++) {
+                U_PORT_TEST_ASSERT(testIsMetBatch[y] == testIsMet[y]);
+                U_PORT_TEST_ASSERT(positionStateBatch[y] == positionState[y]);
+            }
+            numPositions += pTestData->numPoints * repeats;
+        }
+    }
+
+    U_TEST_PRINT_LINE("%d position(s): %d ms (%d ns per position) point by point,"
+                      " %d ms (%d ns per position) as batches.", numPositions,
+                      pointTimeMs, (int32_t) ((((int64_t) pointTimeMs) * 1000000) / numPositions),
+                      batchTimeMs, (int32_t) ((((int64_t) batchTimeMs) * 1000000) / numPositions));
+
+    U_PORT_TEST_ASSERT(uGeofenceFree(gpFence) == 0);
+    gpFence = NULL;
+
+    // Free the mutex so that our memory sums add up
+    uGeofenceCleanUp();
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Test the fixed-point path for small shapes: once a fence has
+ * been applied its small shapes are tested in a local plane with
+ * integer arithmetic, which should give the same outcome as the
+ * floating point calculations that are used for a fence which has
+ * not been applied, with distances in error by no more than
+ * U_GEOFENCE_TEST_FIXED_POINT_ERROR_PER_MILLE; distances to small
+ * circles are also checked against those when WGS84 is forced
+ * by a large radius of position.
+ */
+U_PORT_TEST_FUNCTION("[geofence]", "geofenceFixedPoint")
+{
+    int32_t resourceCount;
+    const uGeofenceTestData_t *pTestData;
+    const uGeofenceTestFence_t *pTestFence;
+    const uGeofenceTestCircle_t *pTestCircle;
+    const uGeofenceTestPoint_t *pTestPoint;
+    const uGeofencePositionVariables_t *pVariables;
+    bool testIsMet;
+    int64_t latitudeX1e9;
+    int64_t offsetX1e9;
+    int64_t differenceMillimetres;
+    int64_t differenceMaxMillimetres = 0;
+    int64_t wgs84DifferenceMaxMillimetres = 0;
+    int32_t startTimeMs;
+    int32_t fixedPointTimeMs = 0;
+    int32_t floatTimeMs = 0;
+    size_t numPositions = 0;
+    size_t numCirclePositions = 0;
+
+    uPortDeinit();
+
+    // Get the initial resource count
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    // Need to initialise only the port
+    uPortInit();
+
+    gpFence = pUGeofenceCreate(U_GEOFENCE_TEST_FENCE_NAME);
+    U_PORT_TEST_ASSERT(gpFence != NULL);
+
+    for (size_t x = 0; x < gpUGeofenceTestDataSize; x++) {
+        pTestData = gpUGeofenceTestData[x];
+        pTestFence = pTestData->pFence;
+        // Two copies of the fence, one applied to a context, which
+        // gives it its local planes, the other not
+        U_PORT_TEST_ASSERT(uGeofenceClearMap(gpFence) == 0);
+        addTestShapes(gpFence, pTestFence, 0);
+        gpFenceFixedPoint = pUGeofenceCreate(U_GEOFENCE_TEST_FENCE_NAME);
+        U_PORT_TEST_ASSERT(gpFenceFixedPoint != NULL);
+        addTestShapes(gpFenceFixedPoint, pTestFence, 0);
+        U_PORT_TEST_ASSERT(uGeofenceApply(&gpFixedPointFenceContext, gpFenceFixedPoint) == 0);
+        for (size_t y = 0; y < pTestData->numPoints; y++) {
+            pTestPoint = pTestData->pPoint[y];
+            pVariables = &(pTestPoint->positionVariables);
+            for (size_t z = 0; z < sizeof(gTestParameters) / sizeof(gTestParameters[0]); z++) {
+                startTimeMs = uPortGetTickTimeMs();
+                for (size_t r = 0; r < U_GEOFENCE_TEST_BATCH_REPEATS; r++) {
+                    uGeofenceTestResetMemory(gpFence);
+                    testIsMet = uGeofenceTest(gpFence, gTestType[z],
+                                              gPessimisticNotOptimistic[z],
+                                              pTestPoint->pPosition->latitudeX1e9,
+                                              pTestPoint->pPosition->longitudeX1e9,
+                                              pVariables->altitudeMillimetres,
+                                              pVariables->radiusMillimetres,
+                                              pVariables->altitudeUncertaintyMillimetres);
+                }
+                floatTimeMs += uPortGetTickTimeMs() - startTimeMs;
+                startTimeMs = uPortGetTickTimeMs();
+                for (size_t r = 0; r < U_GEOFENCE_TEST_BATCH_REPEATS; r++) {
+                    uGeofenceTestResetMemory(gpFenceFixedPoint);
+                    U_PORT_TEST_ASSERT(uGeofenceTest(gpFenceFixedPoint, gTestType[z],
+                                                     gPessimisticNotOptimistic[z],
+                                                     pTestPoint->pPosition->latitudeX1e9,
+                                                     pTestPoint->pPosition->longitudeX1e9,
+                                                     pVariables->altitudeMillimetres,
+                                                     pVariables->radiusMillimetres,
+                                                     pVariables->altitudeUncertaintyMillimetres) == testIsMet);
+                }
+                fixedPointTimeMs += uPortGetTickTimeMs() - startTimeMs;
+                U_PORT_TEST_ASSERT(uGeofenceTestGetPositionState(gpFenceFixedPoint) ==
+                                   uGeofenceTestGetPositionState(gpFence));
+                differenceMillimetres = fixedPointDistanceDifference(uGeofenceTestGetDistanceMin(gpFenceFixedPoint),
+                                                                     uGeofenceTestGetDistanceMin(gpFence),
+                                                                     U_GEOFENCE_TEST_FIXED_POINT_ERROR_PER_MILLE);
+                if (differenceMillimetres > differenceMaxMillimetres) {
+                    differenceMaxMillimetres = differenceMillimetres;
+                }
+                numPositions += U_GEOFENCE_TEST_BATCH_REPEATS;
+            }
+        }
+        U_PORT_TEST_ASSERT(uGeofenceRemove(&gpFixedPointFenceContext, gpFenceFixedPoint) == 0);
+        U_PORT_TEST_ASSERT(uGeofenceFree(gpFenceFixedPoint) == 0);
+        gpFenceFixedPoint = NULL;
+
+        // Now each small circle on its own, positions north and south
+        // of it tested with no radius of position, so in the local
+        // plane, and with a radius of position that forces WGS84 (or
+        // spherical, if WGS84 is not available); the distance to the
+        // edge of a circle does not depend on the radius of position
+        // and, with no test type, neither does the outcome
+        for (size_t y = 0; y < pTestFence->numCircles; y++) {
+            pTestCircle = pTestFence->pCircle[y];
+            if ((pTestCircle->radiusMillimetres <= U_GEOFENCE_FIXED_POINT_THRESHOLD_METRES * 500LL) &&
+                (pTestCircle->pCentre->latitudeX1e9 < (90 - U_GEOFENCE_WGS84_THRESHOLD_POLE_DEGREES_FLOAT - 1) * 1000000000LL) &&
+                (pTestCircle->pCentre->latitudeX1e9 > -(90 - U_GEOFENCE_WGS84_THRESHOLD_POLE_DEGREES_FLOAT - 1) * 1000000000LL)) {
+                gpFenceFixedPoint = pUGeofenceCreate(U_GEOFENCE_TEST_FENCE_NAME);
+                U_PORT_TEST_ASSERT(gpFenceFixedPoint != NULL);
+                U_PORT_TEST_ASSERT(uGeofenceAddCircle(gpFenceFixedPoint,
+                                                      pTestCircle->pCentre->latitudeX1e9,
+                                                      pTestCircle->pCentre->longitudeX1e9,
+                                                      pTestCircle->radiusMillimetres) == 0);
+                U_PORT_TEST_ASSERT(uGeofenceApply(&gpFixedPointFenceContext, gpFenceFixedPoint) == 0);
+                for (int32_t z = -1; z <= 1; z += 2) {
+                    // 50 metres outside to the south, then to the north
+                    offsetX1e9 = z * (pTestCircle->radiusMillimetres + 50000LL) *
+                                 1000000000LL / 111319000LL;
+                    latitudeX1e9 = pTestCircle->pCentre->latitudeX1e9 + offsetX1e9;
+                    uGeofenceTestResetMemory(gpFenceFixedPoint);
+                    uGeofenceTest(gpFenceFixedPoint, U_GEOFENCE_TEST_TYPE_NONE, false,
+                                  latitudeX1e9, pTestCircle->pCentre->longitudeX1e9,
+                                  0, 0, 0);
+                    differenceMillimetres = uGeofenceTestGetDistanceMin(gpFenceFixedPoint);
+                    uGeofenceTestResetMemory(gpFenceFixedPoint);
+                    uGeofenceTest(gpFenceFixedPoint, U_GEOFENCE_TEST_TYPE_NONE, false,
+                                  latitudeX1e9, pTestCircle->pCentre->longitudeX1e9,
+                                  0, (U_GEOFENCE_WGS84_THRESHOLD_METRES * 1000) + 1, 0);
+                    differenceMillimetres = fixedPointDistanceDifference(differenceMillimetres,
+                                                                         uGeofenceTestGetDistanceMin(gpFenceFixedPoint),
+                                                                         U_GEOFENCE_TEST_FIXED_POINT_WGS84_ERROR_PER_MILLE);
+                    if (differenceMillimetres > wgs84DifferenceMaxMillimetres) {
+                        wgs84DifferenceMaxMillimetres = differenceMillimetres;
+                    }
+                    numCirclePositions++;
+                }
+                U_PORT_TEST_ASSERT(uGeofenceRemove(&gpFixedPointFenceContext, gpFenceFixedPoint) == 0);
+                U_PORT_TEST_ASSERT(uGeofenceFree(gpFenceFixedPoint) == 0);
+                gpFenceFixedPoint = NULL;
+            }
+        }
+    }
+
+    U_TEST_PRINT_LINE("%d position(s): %d ms with local planes, %d ms in floating point,"
+                      " largest difference in distance %d mm.", numPositions,
+                      fixedPointTimeMs, floatTimeMs, (int32_t) differenceMaxMillimetres);
+    U_TEST_PRINT_LINE("%d position(s) around small circles: largest difference in distance"
+                      " versus WGS84/spherical %d mm.", numCirclePositions,
+                      (int32_t) wgs84DifferenceMaxMillimetres);
+    U_PORT_TEST_ASSERT((numCirclePositions > 0) || (U_GEOFENCE_FIXED_POINT_THRESHOLD_METRES == 0));
+
+    uGeofenceContextFree(&gpFixedPointFenceContext);
+    U_PORT_TEST_ASSERT(uGeofenceFree(gpFence) == 0);
+    gpFence = NULL;
+
+    // Free the mutex so that our memory sums add up
+    uGeofenceCleanUp();
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
 #ifdef _WIN32
 
 /** Repeat run through the standalone test data but producing
@@ -1151,6 +2184,18 @@ U_PORT_TEST_FUNCTION("[geofence]", "geofenceCleanUp")
 {
     // In case a fence was left hanging
     uGeofenceFree(gpFence);
+    uGeofenceRemove(&gpFixedPointFenceContext, NULL);
+    uGeofenceContextFree(&gpFixedPointFenceContext);
+    uGeofenceFree(gpFenceFixedPoint);
+    uGeofenceRemove(&gpIndexFenceContext, NULL);
+    uGeofenceContextFree(&gpIndexFenceContext);
+    if (gpIndexFence != NULL) {
+        for (size_t x = 0; x < gIndexNumFences; x++) {
+            uGeofenceFree(gpIndexFence[x]);
+        }
+        uPortFree(gpIndexFence);
+    }
+    uPortFree(gpIndexPositionState);
     uGeofenceCleanUp();
 
 #ifdef _WIN32
@@ -125,6 +125,19 @@ static void setQueueHandle(uDeviceHandle_t devHandle, uPortQueueHandle_t queueHa
     }
 }
 
+// Send a message to the status queue without blocking: the queue
+// is only read while a network is being brought up or down (and
+// is cleared before each) so, if it is full, no-one is waiting for
+// the message and blocking would hold up the task that calls all
+// of the callbacks.
+static void statusQueueSend(const uPortQueueHandle_t queueHandle,
+                            const uStatusMessage_t *pMsg)
+{
+    if (uPortQueueGetFree(queueHandle) != 0) {
+        uPortQueueSend(queueHandle, pMsg);
+    }
+}
+
 static void wifiConnectionCallback(uDeviceHandle_t devHandle,
                                    int32_t connId,
                                    int32_t status,
@@ -149,7 +162,7 @@ static void wifiConnectionCallback(uDeviceHandle_t devHandle,
             .disconnectReason = disconnectReason,
             .netStatusMask = 0
         };
-        uPortQueueSend(queueHandle, &msg);
+        statusQueueSend(queueHandle, &msg);
     }
 
     // Note: can't lock the device API here since we may collide
@@ -233,7 +246,7 @@ static void wifiNetworkStatusCallback(uDeviceHandle_t devHandle,
         .netStatusMask = statusMask
     };
     if (queueHandle != NULL) {
-        uPortQueueSend(queueHandle, &msg);
+        statusQueueSend(queueHandle, &msg);
     }
 }
 
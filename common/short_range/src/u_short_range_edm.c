@@ -335,9 +335,10 @@ void uShortRangeEdmResetParser(void)
     gEdmParserState = EDM_PARSER_STATE_PARSE_START_BYTE;
 }
 
-bool uShortRangeEdmParse(char c, uShortRangeEdmEvent_t **ppResultEvent, bool *pMemAvailable)
+size_t uShortRangeEdmParseBuffer(const char *pBuffer, size_t size,
+                                 uShortRangeEdmEvent_t **ppResultEvent,
+                                 bool *pMemAvailable)
 {
-    edmParserState_t newState = gEdmParserState;
     static uint16_t payloadLength;
     static uShortRangePbuf_t *pBuf;
     static int32_t pBufSize;
@@ -345,160 +346,185 @@ bool uShortRangeEdmParse(char c, uShortRangeEdmEvent_t **ppResultEvent, bool *pM
     static uint32_t headerIndex;
     static uint16_t idAndType;
     static uint8_t channel;
-    bool charConsumed = false;
+    size_t consumed = 0;
+    size_t length;
+    const char *pStart;
+    char c;
     int32_t result;
 
     *pMemAvailable = true;
-    switch (gEdmParserState) {
-
-        case EDM_PARSER_STATE_PARSE_START_BYTE:
-            if (c == U_SHORT_RANGE_EDM_HEAD) {
-                headerIndex = 0;
-                newState = EDM_PARSER_STATE_PARSE_PAYLOAD_LENGTH;
-            }
-            charConsumed = true;
-            break;
+    // Keep going until the input is used up, an event has been
+    // generated (which puts us into the wait state) or we have
+    // run out of pbufs
+    while ((consumed < size) &&
+           (gEdmParserState != EDM_PARSER_STATE_WAIT_FOR_EVENT_PROCESSING) &&
+           *pMemAvailable) {
+        c = pBuffer[consumed];
+        switch (gEdmParserState) {
+
+            case EDM_PARSER_STATE_PARSE_START_BYTE:
+                // Skip straight to the next start byte, if there is one
+                pStart = (const char *) memchr(pBuffer + consumed, U_SHORT_RANGE_EDM_HEAD,
+                                               size - consumed);
+                if (pStart != NULL) {
+                    consumed = (pStart - pBuffer) + 1;
+                    headerIndex = 0;
+                    gEdmParserState = EDM_PARSER_STATE_PARSE_PAYLOAD_LENGTH;
+                } else {
+                    consumed = size;
+                }
+                break;
 
-        case EDM_PARSER_STATE_PARSE_PAYLOAD_LENGTH:
-            if (headerIndex == 0) {
-                payloadLength = (uint16_t)(uint8_t)c << 8;
-                headerIndex++;
-            } else {
-                payloadLength |= (uint16_t)(uint8_t)c;
-                if (payloadLength < 2) {
-                    // Something is wrong, start over
-                    newState = EDM_PARSER_STATE_PARSE_START_BYTE;
+            case EDM_PARSER_STATE_PARSE_PAYLOAD_LENGTH:
+                if (headerIndex == 0) {
+                    payloadLength = (uint16_t)(uint8_t)c << 8;
+                    headerIndex++;
                 } else {
-                    headerIndex = 0;
-                    newState = EDM_PARSER_STATE_PARSE_HEADER_LENGTH;
+                    payloadLength |= (uint16_t)(uint8_t)c;
+                    if (payloadLength < 2) {
+                        // Something is wrong, start over
+                        gEdmParserState = EDM_PARSER_STATE_PARSE_START_BYTE;
+                    } else {
+                        headerIndex = 0;
+                        gEdmParserState = EDM_PARSER_STATE_PARSE_HEADER_LENGTH;
+                    }
                 }
-            }
-            charConsumed = true;
-            break;
-        case EDM_PARSER_STATE_PARSE_HEADER_LENGTH:
-            header[headerIndex++] = c;
-            payloadLength--;
+                consumed++;
+                break;
+
+            case EDM_PARSER_STATE_PARSE_HEADER_LENGTH:
+                header[headerIndex++] = c;
+                payloadLength--;
 
-            if (headerIndex == 2) {
+                if (headerIndex == 2) {
 
-                idAndType = ((uint16_t)(uint8_t)header[0] << 8) | (uint16_t)(uint8_t)header[1];
+                    idAndType = ((uint16_t)(uint8_t)header[0] << 8) | (uint16_t)(uint8_t)header[1];
 
-                if ((idAndType == U_SHORT_RANGE_EDM_TYPE_AT_RESPONSE) ||
-                    (idAndType == U_SHORT_RANGE_EDM_TYPE_AT_EVENT)    ||
-                    (idAndType == U_SHORT_RANGE_EDM_TYPE_START_EVENT) ||
-                    (idAndType == U_SHORT_RANGE_EDM_TYPE_AT_REQUEST)) {
+                    if ((idAndType == U_SHORT_RANGE_EDM_TYPE_AT_RESPONSE) ||
+                        (idAndType == U_SHORT_RANGE_EDM_TYPE_AT_EVENT)    ||
+                        (idAndType == U_SHORT_RANGE_EDM_TYPE_START_EVENT) ||
+                        (idAndType == U_SHORT_RANGE_EDM_TYPE_AT_REQUEST)) {
 
-                    // Channel does not exist for these types so
-                    // fill in -1
-                    header[headerIndex++] = -1;
+                        // Channel does not exist for these types so
+                        // fill in -1
+                        header[headerIndex++] = -1;
+                    }
                 }
-            }
-
-            if (headerIndex == U_SHORT_RANGE_EDM_HEADER_SIZE) {
-                channel = header[2];
-                // gCurPBufChain should always be NULL here
-                // If it's not we have a leak
-                U_ASSERT(gCurPBufList == NULL);
-                pBuf = NULL;
-                newState = EDM_PARSER_STATE_ALLOCATE_PBUFLIST;
-                // For disconnect event there is no payload
-                // so directly head to parse tail byte
-                if ((idAndType == U_SHORT_RANGE_EDM_TYPE_DISCONNECT_EVENT) ||
-                    (idAndType == U_SHORT_RANGE_EDM_TYPE_START_EVENT)) {
-                    newState = EDM_PARSER_STATE_PARSE_TAIL_BYTE;
+
+                if (headerIndex == U_SHORT_RANGE_EDM_HEADER_SIZE) {
+                    channel = header[2];
+                    // gCurPBufChain should always be NULL here
+                    // If it's not we have a leak
+                    U_ASSERT(gCurPBufList == NULL);
+                    pBuf = NULL;
+                    gEdmParserState = EDM_PARSER_STATE_ALLOCATE_PBUFLIST;
+                    // For disconnect event there is no payload
+                    // so directly head to parse tail byte
+                    if ((idAndType == U_SHORT_RANGE_EDM_TYPE_DISCONNECT_EVENT) ||
+                        (idAndType == U_SHORT_RANGE_EDM_TYPE_START_EVENT)) {
+                        gEdmParserState = EDM_PARSER_STATE_PARSE_TAIL_BYTE;
+                    }
                 }
-            }
-            charConsumed = true;
-            break;
+                consumed++;
+                break;
 
-        case EDM_PARSER_STATE_ALLOCATE_PBUFLIST:
-
-            // if allocation fails stay back until
-            // we have some free memory in their respective pool
-            gCurPBufList = pUShortRangePbufListAlloc();
-            if (gCurPBufList != NULL) {
-                gCurPBufList->edmChannel = channel;
-                newState = EDM_PARSER_STATE_ALLOCATE_PAYLOAD;
-            } else {
-                *pMemAvailable = false; // remain at same state, try again later
-            }
-            // we dont consume the input char in this state
-            charConsumed = false;
-            break;
+            case EDM_PARSER_STATE_ALLOCATE_PBUFLIST:
+
+                // if allocation fails stay back until
+                // we have some free memory in their respective pool
+                gCurPBufList = pUShortRangePbufListAlloc();
+                if (gCurPBufList != NULL) {
+                    gCurPBufList->edmChannel = channel;
+                    gEdmParserState = EDM_PARSER_STATE_ALLOCATE_PAYLOAD;
+                    if (payloadLength == 0) {
+                        // Nothing to accumulate
+                        gEdmParserState = EDM_PARSER_STATE_PARSE_TAIL_BYTE;
+                    }
+                } else {
+                    *pMemAvailable = false; // remain at same state, try again later
+                }
+                // we dont consume the input char in this state
+                break;
 
-        case EDM_PARSER_STATE_ALLOCATE_PAYLOAD:
-
-            // if allocation fails stay back until
-            // we have some free memory in their respective pool
-            pBufSize = uShortRangePbufAlloc(&pBuf);
-            if (pBufSize > 0) {
-                headerIndex = 0;
-                newState = EDM_PARSER_STATE_ACCUMULATE_PAYLOAD;
-            } else {
-                *pMemAvailable = false; // remain at same state, try again later
-            }
-            // we dont consume the input char in this state
-            charConsumed = false;
-            break;
+            case EDM_PARSER_STATE_ALLOCATE_PAYLOAD:
 
-        case EDM_PARSER_STATE_ACCUMULATE_PAYLOAD:
-
-            U_ASSERT(pBufSize > 0);
-            U_ASSERT(pBuf != NULL);
-            U_ASSERT(pBuf->length < pBufSize);
-
-            pBuf->data[pBuf->length++] = c;
-            payloadLength--;
-
-            if ((pBuf->length == pBufSize) ||
-                (payloadLength == 0)) {
-                result = uShortRangePbufListAppend(gCurPBufList, pBuf);
-                U_ASSERT(result == 0);
-                if (payloadLength == 0) {
-                    newState = EDM_PARSER_STATE_PARSE_TAIL_BYTE;
-                } else if (pBuf->length == pBufSize) {
-                    // we have some more data coming in
-                    // so allocate memory for payload
-                    newState = EDM_PARSER_STATE_ALLOCATE_PAYLOAD;
+                // if allocation fails stay back until
+                // we have some free memory in their respective pool
+                pBufSize = uShortRangePbufAlloc(&pBuf);
+                if (pBufSize > 0) {
+                    headerIndex = 0;
+                    gEdmParserState = EDM_PARSER_STATE_ACCUMULATE_PAYLOAD;
+                } else {
+                    *pMemAvailable = false; // remain at same state, try again later
                 }
-                pBuf = NULL;
-            }
-            charConsumed = true;
-            break;
+                // we dont consume the input char in this state
+                break;
 
-        case EDM_PARSER_STATE_PARSE_TAIL_BYTE:
-            newState = EDM_PARSER_STATE_PARSE_START_BYTE;
-            if (c == U_SHORT_RANGE_EDM_TAIL) {
-                if (ppResultEvent != NULL) {
-                    *ppResultEvent = parseEdmPayload(idAndType, channel, gCurPBufList);
-                    if (*ppResultEvent == NULL) {
-                        // No event was generated
-                        // Reset parser
-                        newState = EDM_PARSER_STATE_PARSE_START_BYTE;
-                    } else {
-                        newState = EDM_PARSER_STATE_WAIT_FOR_EVENT_PROCESSING;
+            case EDM_PARSER_STATE_ACCUMULATE_PAYLOAD:
+
+                U_ASSERT(pBufSize > 0);
+                U_ASSERT(pBuf != NULL);
+                U_ASSERT(pBuf->length < pBufSize);
+
+                // Copy as much of the payload as we have, and
+                // as will fit, straight into the pbuf
+                length = size - consumed;
+                if (length > payloadLength) {
+                    length = payloadLength;
+                }
+                if (length > (size_t) (pBufSize - pBuf->length)) {
+                    length = pBufSize - pBuf->length;
+                }
+                memcpy(&pBuf->data[pBuf->length], pBuffer + consumed, length);
+                pBuf->length += (uint16_t) length;
+                payloadLength -= (uint16_t) length;
+                consumed += length;
+
+                if ((pBuf->length == pBufSize) ||
+                    (payloadLength == 0)) {
+                    result = uShortRangePbufListAppend(gCurPBufList, pBuf);
+                    U_ASSERT(result == 0);
+                    (void) result;
+                    if (payloadLength == 0) {
+                        gEdmParserState = EDM_PARSER_STATE_PARSE_TAIL_BYTE;
+                    } else if (pBuf->length == pBufSize) {
+                        // we have some more data coming in
+                        // so allocate memory for payload
+                        gEdmParserState = EDM_PARSER_STATE_ALLOCATE_PAYLOAD;
                     }
+                    pBuf = NULL;
                 }
-            }
-            if (newState == EDM_PARSER_STATE_PARSE_START_BYTE) {
-                // Always de-allocate the buffer when we reset the parser
-                uShortRangePbufListFree(gCurPBufList);
-            }
-            gCurPBufList = NULL;
-            charConsumed = true;
-            break;
+                break;
 
-        case EDM_PARSER_STATE_WAIT_FOR_EVENT_PROCESSING:
-            // Parser will stay in this state until parser is reset.
-            // This to avoid the parser overwriting data in an unprocessed event
-            // Any user of the parser thus have to reset the parser when it has
-            // processed a generated event, to make it ready for parsing
-            break;
-    }
+            case EDM_PARSER_STATE_PARSE_TAIL_BYTE:
+                gEdmParserState = EDM_PARSER_STATE_PARSE_START_BYTE;
+                if (c == U_SHORT_RANGE_EDM_TAIL) {
+                    if (ppResultEvent != NULL) {
+                        *ppResultEvent = parseEdmPayload(idAndType, channel, gCurPBufList);
+                        if (*ppResultEvent != NULL) {
+                            gEdmParserState = EDM_PARSER_STATE_WAIT_FOR_EVENT_PROCESSING;
+                        }
+                    }
+                }
+                if (gEdmParserState == EDM_PARSER_STATE_PARSE_START_BYTE) {
+                    // Always de-allocate the buffer when we reset the parser
+                    uShortRangePbufListFree(gCurPBufList);
+                }
+                gCurPBufList = NULL;
+                consumed++;
+                break;
 
-    gEdmParserState = newState;
+            case EDM_PARSER_STATE_WAIT_FOR_EVENT_PROCESSING:
+            default:
+                // Parser will stay in this state until parser is reset.
+                // This to avoid the parser overwriting data in an unprocessed event
+                // Any user of the parser thus have to reset the parser when it has
+                // processed a generated event, to make it ready for parsing
+                break;
+        }
+    }
 
-    return charConsumed;
+    return consumed;
 }
 
 int32_t uShortRangeEdmZeroCopyHeadData(uint8_t channel, uint32_t size, char *pHead)
@@ -103,7 +103,7 @@ typedef struct {
  *
  * @brief Check if EDM parser is available
  *
- * @note  Do not call the uShortRangeEdmParse function if this function
+ * @note  Do not call the uShortRangeEdmParseBuffer function if this function
  *        returns false.
  *
  * @return True if EDM parser is available
@@ -119,23 +119,33 @@ void uShortRangeEdmResetParser(void);
 
 /**
  *
- * @brief Function for parsing binary EDM data
+ * @brief Function for parsing a block of binary EDM data
  *
  * @note  Do not call this function if parser is not available,
- *        Check if parser is available with uShortRangeEdmParserAvailable
+ *        Check if parser is available with uShortRangeEdmParserReady.
  *        If a packet is invalid it will be silently dropped.
+ *        The start of a packet is searched for, and the payload
+ *        copied into pbufs, a block at a time, rather than
+ *        character by character.
  *
- * @param c Input character.
+ * @param[in] pBuffer Pointer to the input data.
+ *
+ * @param size The number of bytes at pBuffer.
  *
  * @param[out] ppResultEvent Address of pointer to event, NULL if no event was generated
  *             An event is created when the last character in a EDM packet
- *             is parsed and the packet is valid.
+ *             is parsed and the packet is valid; parsing stops there, leaving
+ *             any remaining data unconsumed, until the parser is reset.
  *
- * @param[out] pMemAvailable Pointer to a boolean that indicates if memory was allocated successfully.
+ * @param[out] pMemAvailable Pointer to a boolean that indicates if memory was allocated
+ *             successfully; if it was not, parsing stops, leaving any remaining data
+ *             unconsumed.
  *
- * @return True when input character c is consumed else false.
+ * @return The number of bytes of pBuffer consumed.
  */
-bool uShortRangeEdmParse(char c, uShortRangeEdmEvent_t **ppResultEvent, bool *pMemAvailable);
+size_t uShortRangeEdmParseBuffer(const char *pBuffer, size_t size,
+                                 uShortRangeEdmEvent_t **ppResultEvent,
+                                 bool *pMemAvailable);
 
 /**
  *
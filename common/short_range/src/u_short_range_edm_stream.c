@@ -39,6 +39,7 @@
 #include "u_port_event_queue.h"
 #include "u_port_uart.h"
 #include "u_port_debug.h"
+#include "u_ringbuffer.h"
 #include "u_at_client.h"
 #include "u_short_range_pbuf.h"
 #include "u_short_range_module_type.h"
@@ -73,6 +74,14 @@
 # define U_EDM_STREAM_TASK_PRIORITY U_AT_CLIENT_URC_TASK_PRIORITY
 #endif
 
+#ifndef U_SHORT_RANGE_EDM_STREAM_RX_BUFFER_LENGTH_BYTES
+// The size of the block that data is read into from the UART
+// before being parsed, and of the ring buffer that keeps whatever
+// the parser could not take; the larger it is, the fewer UART reads
+// are needed for a given amount of data.
+# define U_SHORT_RANGE_EDM_STREAM_RX_BUFFER_LENGTH_BYTES 256
+#endif
+
 // Debug logging for EDM activity
 // You can activate debug log output for EDM activity with the defines below
 //
@@ -199,6 +208,9 @@ typedef struct uEdmStreamInstance_t {
     int32_t atResponseLength;
     int32_t atResponseRead;
     uShortRangeEdmStreamConnections_t connections[U_SHORT_RANGE_EDM_STREAM_MAX_CONNECTIONS];
+    char rxBlock[U_SHORT_RANGE_EDM_STREAM_RX_BUFFER_LENGTH_BYTES]; // Read from the UART into here
+    char rxBuffer[U_SHORT_RANGE_EDM_STREAM_RX_BUFFER_LENGTH_BYTES]; // The storage of rxRingBuffer
+    uRingBuffer_t rxRingBuffer; // Data read but not yet parsed
 } uShortRangeEdmStreamInstance_t;
 
 /* ----------------------------------------------------------------
@@ -777,49 +789,64 @@ static void uartCallback(int32_t uartHandle, uint32_t eventBitmask,
         (eventBitmask == U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED)) {
         bool uartEmpty = false;
         // We don't want to read one character at the time from the uart driver since that will be
-        // quite an overhead when pumping a lot of data. Instead we read into a buffer
-        // and then comsume characters from that. But we might not consume all read characters
-        // before an EDM-event is generated by the parser which makes the parser unavailable
-        // and we have to leave this callback. When the parser later is available this
-        // uart-event will be placed on the queue again so that we come back here.
-        // We thus need a static buffer, and if there are unparsed characters left in it we move
-        // them to the beginning of the buffer befor leaving (instead of using a ring buffer).
+        // quite an overhead when pumping a lot of data. Instead we read a block and then parse
+        // the whole of it. But we might not consume all read characters before an EDM-event is
+        // generated by the parser which makes the parser unavailable and we have to leave this
+        // callback. When the parser later is available this uart-event will be placed on the
+        // queue again so that we come back here, and the unparsed characters will be waiting
+        // in the ring buffer, to be parsed before anything more is read.
         U_PORT_MUTEX_LOCK(gMutex);
         while (!uartEmpty && uShortRangeEdmParserReady() && memAvailable) {
             // Loop until we couldn't read any more characters from uart
             // or EDM parser is unavailable
             // or no pbuf memory is available
-            static char buffer[128];
-            static size_t charsInBuffer = 0;
-            size_t consumed = 0;
+            size_t length;
+            size_t consumed;
+            int32_t sizeOrError;
 
-            // Check if there are any existing characters in the buffer and parse them
-            while (uShortRangeEdmParserReady() && (consumed < charsInBuffer) && memAvailable) {
-                //lint -esym(727, buffer)
+            // Parse what was left in the ring buffer last time, a block at a time
+            while (uShortRangeEdmParserReady() &&
+                   (uRingBufferDataSize(&gEdmStream.rxRingBuffer) > 0) && memAvailable) {
                 uShortRangeEdmEvent_t *pEvent = NULL;
+                length = uRingBufferPeek(&gEdmStream.rxRingBuffer, gEdmStream.rxBlock,
+                                         sizeof(gEdmStream.rxBlock), 0);
                 // when there is no memory available in the pool to intake
-                // the data, this call would return false.In such
+                // the data, this call will not consume everything. In such
                 // cases hardware flow control will be triggered if
                 // UART H/W Rx FIFO is full.
-                if (uShortRangeEdmParse(buffer[consumed], &pEvent, &memAvailable)) {
-                    consumed++;
-                }
+                consumed = uShortRangeEdmParseBuffer(gEdmStream.rxBlock, length,
+                                                     &pEvent, &memAvailable);
+                uRingBufferRead(&gEdmStream.rxRingBuffer, NULL, consumed);
                 if (pEvent != NULL) {
                     processEdmEvent(pEvent);
                 }
             }
-            // Move unparsed data to beginning of buffer
-            if ((consumed > 0) && (charsInBuffer - consumed) > 0) {
-                memmove(buffer, buffer + consumed, charsInBuffer - consumed);
-            }
-            charsInBuffer -= consumed;
 
-            // Read as much as possible from uart into rest of buffer
-            if (charsInBuffer < sizeof buffer) {
-                int32_t sizeOrError = uPortUartRead(gEdmStream.uartHandle, buffer + charsInBuffer,
-                                                    sizeof buffer - charsInBuffer);
+            // Once that is all gone, read as much as possible from uart and parse
+            // it where it is, putting whatever the parser can't take into the
+            // ring buffer, which is empty, so there is always room for it
+            if (uShortRangeEdmParserReady() &&
+                (uRingBufferDataSize(&gEdmStream.rxRingBuffer) == 0) && memAvailable) {
+                length = uRingBufferAvailableSize(&gEdmStream.rxRingBuffer);
+                if (length > sizeof(gEdmStream.rxBlock)) {
+                    length = sizeof(gEdmStream.rxBlock);
+                }
+                sizeOrError = uPortUartRead(gEdmStream.uartHandle,
+                                            gEdmStream.rxBlock, length);
                 if (sizeOrError > 0) {
-                    charsInBuffer += sizeOrError;
+                    length = 0;
+                    while (uShortRangeEdmParserReady() &&
+                           (length < (size_t) sizeOrError) && memAvailable) {
+                        uShortRangeEdmEvent_t *pEvent = NULL;
+                        length += uShortRangeEdmParseBuffer(gEdmStream.rxBlock + length,
+                                                            sizeOrError - length,
+                                                            &pEvent, &memAvailable);
+                        if (pEvent != NULL) {
+                            processEdmEvent(pEvent);
+                        }
+                    }
+                    uRingBufferAdd(&gEdmStream.rxRingBuffer, gEdmStream.rxBlock + length,
+                                   sizeOrError - length);
                 } else {
                     uartEmpty = true;
                 }
@@ -998,7 +1025,10 @@ int32_t uShortRangeEdmStreamOpen(int32_t uartHandle)
                 gEdmStream.pAtResponseBuffer = (char *)pUPortMalloc(U_SHORT_RANGE_EDM_STREAM_AT_RESPONSE_LENGTH);
                 memset(gEdmStream.pAtResponseBuffer, 0, U_SHORT_RANGE_EDM_STREAM_AT_RESPONSE_LENGTH);
                 if (gEdmStream.pAtCommandBuffer == NULL ||
-                    gEdmStream.pAtResponseBuffer == NULL) {
+                    gEdmStream.pAtResponseBuffer == NULL ||
+                    (uRingBufferCreateLockFree(&gEdmStream.rxRingBuffer,
+                                               gEdmStream.rxBuffer,
+                                               sizeof(gEdmStream.rxBuffer)) != 0)) {
                     handleOrErrorCode = U_ERROR_COMMON_NO_MEMORY;
                     uPortUartEventCallbackRemove(uartHandle);
                 } else {
@@ -1086,6 +1116,7 @@ void uShortRangeEdmStreamClose(int32_t handle)
             gEdmStream.pAtCommandBuffer = NULL;
             uPortFree(gEdmStream.pAtResponseBuffer);
             gEdmStream.pAtResponseBuffer = NULL;
+            uRingBufferDelete(&gEdmStream.rxRingBuffer);
             for (uint32_t i = 0; i < U_SHORT_RANGE_EDM_STREAM_MAX_CONNECTIONS; i++) {
                 gEdmStream.connections[i].channel = -1;
                 gEdmStream.connections[i].type = U_SHORT_RANGE_CONNECTION_TYPE_INVALID;
@@ -0,0 +1,639 @@
+/*
+ * Copyright 2019-2023 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Tests for the EDM parser and the EDM stream; these do not
+ * require a short-range module, the EDM stream test requires a pair
+ * of UARTs (U_CFG_TEST_UART_A and U_CFG_TEST_UART_B) connected
+ * together.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memcpy(), memcmp(), memset()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+#include "u_cfg_os_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_os.h"
+#include "u_port_heap.h"
+#include "u_port_debug.h"
+#include "u_port_uart.h"
+
+#include "u_test_util_resource_check.h"
+
+#include "u_at_client.h"
+
+#include "u_short_range_pbuf.h"
+#include "u_short_range_module_type.h"
+#include "u_short_range.h"
+#include "u_short_range_edm.h"
+#include "u_short_range_edm_stream.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_SHORT_RANGE_EDM_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+/** The EDM ID/type of a connect event.
+ */
+#define U_SHORT_RANGE_EDM_TEST_TYPE_CONNECT_EVENT 0x0011
+
+/** The EDM ID/type of a disconnect event.
+ */
+#define U_SHORT_RANGE_EDM_TEST_TYPE_DISCONNECT_EVENT 0x0021
+
+/** The EDM ID/type of a data event.
+ */
+#define U_SHORT_RANGE_EDM_TEST_TYPE_DATA_EVENT 0x0031
+
+/** The EDM ID/type of an AT event.
+ */
+#define U_SHORT_RANGE_EDM_TEST_TYPE_AT_EVENT 0x0041
+
+/** The EDM ID/type of a start-up event.
+ */
+#define U_SHORT_RANGE_EDM_TEST_TYPE_START_EVENT 0x0071
+
+/** The EDM channel used in these tests.
+ */
+#define U_SHORT_RANGE_EDM_TEST_CHANNEL 3
+
+/** The size of the buffer for the EDM traffic of the parse test.
+ */
+#define U_SHORT_RANGE_EDM_TEST_PARSE_BUFFER_LENGTH_BYTES 2048
+
+#ifndef U_SHORT_RANGE_EDM_TEST_THROUGHPUT_NUM_PACKETS
+/** The number of full-sized data packets to send in the EDM stream
+ * throughput test.
+ */
+# define U_SHORT_RANGE_EDM_TEST_THROUGHPUT_NUM_PACKETS 100
+#endif
+
+#ifndef U_SHORT_RANGE_EDM_TEST_THROUGHPUT_WINDOW_PACKETS
+/** The number of data packets that may be in flight at any one
+ * time in the EDM stream throughput test: the sender waits for
+ * the receiver to catch up rather than filling the UART buffers,
+ * since a UART write that is blocked by flow control may also
+ * hold up the UART read on some platforms.
+ */
+# define U_SHORT_RANGE_EDM_TEST_THROUGHPUT_WINDOW_PACKETS 4
+#endif
+
+#ifndef U_SHORT_RANGE_EDM_TEST_THROUGHPUT_TIMEOUT_MS
+/** How long to wait for the data of the EDM stream throughput
+ * test to arrive.
+ */
+# define U_SHORT_RANGE_EDM_TEST_THROUGHPUT_TIMEOUT_MS 20000
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** What is expected of an EDM event in the parse test.
+ */
+typedef struct {
+    uShortRangeEdmEventType_t type;
+    const char *pData;
+    size_t length;
+} uShortRangeEdmTestEvent_t;
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+/** Context for the callbacks of the EDM stream throughput test.
+ */
+typedef struct {
+    volatile bool connected;
+    volatile bool disconnected;
+    volatile size_t bytesReceived;
+    volatile size_t packetsReceived;
+    volatile size_t errorCount;
+} uShortRangeEdmTestStream_t;
+#endif
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** Some rubbish, including a start byte followed by an invalid
+ * length, a tail byte and zeroes.
+ */
+static const char gRubbish[] = {0x00, 0x55, 'r', 'u', (char) 0xAA, 0x00, 0x01, 'b', 0x00};
+
+/** The payload of an IPv4 connect event: TCP, remote address
+ * 192.168.1.2 port 80, local address 192.168.1.3 port 2000.
+ */
+static const char gConnectIpv4[] = {0x02, 0x00, (char) 192, (char) 168, 1, 2, 0x00, 80,
+                                    (char) 192, (char) 168, 1, 3, 0x07, (char) 0xD0
+                                   };
+
+/** The payload of an AT event.
+ */
+static const char gAtEvent[] = "\r\n+UUDPC:1,2,0,192.168.1.3,2000,192.168.1.2,80\r\n";
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+/** UART handle on which the EDM stream is opened.
+ */
+static int32_t gUartAHandle = -1;
+
+/** UART handle from which EDM traffic is sent.
+ */
+static int32_t gUartBHandle = -1;
+
+/** The handle of the EDM stream.
+ */
+static int32_t gEdmStreamHandle = -1;
+#endif
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Encode an EDM packet as the module would send it, returning the
+// number of bytes written to pBuffer; channel is ignored if negative.
+static size_t edmEncode(char *pBuffer, uint16_t idAndType, int32_t channel,
+                        const char *pPayload, size_t length)
+{
+    size_t x = 0;
+    size_t edmLength = 2 + length;
+
+    if (channel >= 0) {
+        edmLength++;
+    }
+    pBuffer[x++] = (char) 0xAA;
+    pBuffer[x++] = (char) (edmLength >> 8);
+    pBuffer[x++] = (char) (edmLength & 0xFF);
+    pBuffer[x++] = (char) (idAndType >> 8);
+    pBuffer[x++] = (char) (idAndType & 0xFF);
+    if (channel >= 0) {
+        pBuffer[x++] = (char) channel;
+    }
+    memcpy(pBuffer + x, pPayload, length);
+    x += length;
+    pBuffer[x++] = (char) 0x55;
+
+    return x;
+}
+
+// Fill a buffer with a pattern that depends on the offset in the stream.
+static void fillPattern(char *pBuffer, size_t length, size_t offset)
+{
+    for (size_t x = 0; x < length; x++) {
+        pBuffer[x] = (char) ((offset + x) % 251);
+    }
+}
+
+// Check that a pbuf list contains the expected data, consuming it.
+static bool pbufListIsData(uShortRangePbufList_t *pBufList,
+                           const char *pData, size_t length)
+{
+    bool isData = false;
+    char buffer[U_SHORT_RANGE_EDM_BLK_SIZE];
+    size_t thisLength;
+    size_t offset = 0;
+
+    if ((pBufList != NULL) && (pBufList->totalLen == length)) {
+        isData = true;
+        while (isData && (offset < length)) {
+            thisLength = uShortRangePbufListConsumeData(pBufList, buffer, sizeof(buffer));
+            isData = (thisLength > 0) && (memcmp(buffer, pData + offset, thisLength) == 0);
+            offset += thisLength;
+        }
+    }
+
+    return isData;
+}
+
+// Check an event generated by the EDM parser, freeing any data.
+static bool edmEventIsExpected(uShortRangeEdmEvent_t *pEvent,
+                               const uShortRangeEdmTestEvent_t *pExpected)
+{
+    bool isExpected = (pEvent->type == pExpected->type);
+
+    switch (pEvent->type) {
+        case U_SHORT_RANGE_EDM_EVENT_CONNECT_IPv4:
+            isExpected = isExpected &&
+                         (pEvent->params.ipv4ConnectEvent.channel == U_SHORT_RANGE_EDM_TEST_CHANNEL) &&
+                         (pEvent->params.ipv4ConnectEvent.connection.remotePort == 80) &&
+                         (pEvent->params.ipv4ConnectEvent.connection.localPort == 2000);
+            break;
+        case U_SHORT_RANGE_EDM_EVENT_DISCONNECT:
+            isExpected = isExpected &&
+                         (pEvent->params.disconnectEvent.channel == U_SHORT_RANGE_EDM_TEST_CHANNEL);
+            break;
+        case U_SHORT_RANGE_EDM_EVENT_DATA:
+            isExpected = isExpected &&
+                         (pEvent->params.dataEvent.channel == U_SHORT_RANGE_EDM_TEST_CHANNEL) &&
+                         pbufListIsData(pEvent->params.dataEvent.pBufList,
+                                        pExpected->pData, pExpected->length);
+            uShortRangePbufListFree(pEvent->params.dataEvent.pBufList);
+            break;
+        case U_SHORT_RANGE_EDM_EVENT_AT:
+            isExpected = isExpected &&
+                         pbufListIsData(pEvent->params.atEvent.pBufList,
+                                        pExpected->pData, pExpected->length);
+            uShortRangePbufListFree(pEvent->params.atEvent.pBufList);
+            break;
+        default:
+            break;
+    }
+
+    return isExpected;
+}
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+
+// Callback for IP connection events from the EDM stream.
+static void ipEventCallback(int32_t edmStreamHandle,
+                            int32_t edmChannel,
+                            uShortRangeConnectionEventType_t eventType,
+                            const uShortRangeConnectDataIp_t *pConnectData,
+                            void *pCallbackParameter)
+{
+    uShortRangeEdmTestStream_t *pStream = (uShortRangeEdmTestStream_t *) pCallbackParameter;
+
+    (void) edmStreamHandle;
+    (void) pConnectData;
+
+    if (edmChannel != U_SHORT_RANGE_EDM_TEST_CHANNEL) {
+        pStream->errorCount++;
+    } else if (eventType == U_SHORT_RANGE_EVENT_CONNECTED) {
+        pStream->connected = true;
+    } else if (eventType == U_SHORT_RANGE_EVENT_DISCONNECTED) {
+        pStream->disconnected = true;
+    }
+}
+
+// Callback for data from the EDM stream: checks and frees it.
+static void dataEventCallback(int32_t edmStreamHandle,
+                              int32_t edmChannel,
+                              uShortRangePbufList_t *pBufList,
+                              void *pCallbackParameter)
+{
+    uShortRangeEdmTestStream_t *pStream = (uShortRangeEdmTestStream_t *) pCallbackParameter;
+    char buffer[U_SHORT_RANGE_EDM_BLK_SIZE];
+    char expected[U_SHORT_RANGE_EDM_BLK_SIZE];
+    size_t length;
+
+    (void) edmStreamHandle;
+
+    if (edmChannel != U_SHORT_RANGE_EDM_TEST_CHANNEL) {
+        pStream->errorCount++;
+    }
+    do {
+        length = uShortRangePbufListConsumeData(pBufList, buffer, sizeof(buffer));
+        fillPattern(expected, length, pStream->bytesReceived);
+        if (memcmp(buffer, expected, length) != 0) {
+            pStream->errorCount++;
+        }
+        pStream->bytesReceived += length;
+    } while (length > 0);
+    pStream->packetsReceived++;
+    uShortRangePbufListFree(pBufList);
+}
+
+// Write all of the given data to a UART.
+static bool uartWriteAll(int32_t uartHandle, const char *pData, size_t length)
+{
+    int32_t x = 0;
+
+    while ((length > 0) && (x >= 0)) {
+        x = uPortUartWrite(uartHandle, pData, length);
+        if (x > 0) {
+            pData += x;
+            length -= x;
+        }
+    }
+
+    return (length == 0);
+}
+
+#endif
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Feed a sequence of EDM packets, with rubbish in between, to the
+ * EDM parser in blocks of varying size and check that the right
+ * events come out.
+ */
+U_PORT_TEST_FUNCTION("[edm]", "edmParse")
+{
+    const size_t dataLength[] = {1, U_SHORT_RANGE_EDM_BLK_SIZE - 1, U_SHORT_RANGE_EDM_BLK_SIZE,
+                                 U_SHORT_RANGE_EDM_BLK_SIZE + 1, U_SHORT_RANGE_EDM_MTU_IP_MAX_SIZE,
+                                 1000
+                                };
+    const size_t blockSize[] = {1, 2, 7, U_SHORT_RANGE_EDM_BLK_SIZE, 100,
+                                U_SHORT_RANGE_EDM_TEST_PARSE_BUFFER_LENGTH_BYTES
+                               };
+    uShortRangeEdmTestEvent_t expected[sizeof(dataLength) / sizeof(dataLength[0]) + 4];
+    uShortRangeEdmEvent_t *pEvent;
+    char *pTraffic;
+    char *pData;
+    size_t trafficLength = 0;
+    size_t numEvents = 0;
+    size_t eventIndex;
+    size_t offset;
+    size_t length;
+    size_t consumed;
+    bool memAvailable;
+    int32_t startTimeMs;
+    int32_t resourceCount;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    U_PORT_TEST_ASSERT(uShortRangeMemPoolInit() == 0);
+
+    pTraffic = (char *) pUPortMalloc(U_SHORT_RANGE_EDM_TEST_PARSE_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(pTraffic != NULL);
+    pData = (char *) pUPortMalloc(U_SHORT_RANGE_EDM_MAX_SIZE);
+    U_PORT_TEST_ASSERT(pData != NULL);
+    fillPattern(pData, U_SHORT_RANGE_EDM_MAX_SIZE, 0);
+
+    // Assemble the EDM traffic that a module might send for a
+    // TCP connection, with rubbish in between
+    memcpy(pTraffic, gRubbish, sizeof(gRubbish));
+    trafficLength += sizeof(gRubbish);
+    trafficLength += edmEncode(pTraffic + trafficLength, U_SHORT_RANGE_EDM_TEST_TYPE_CONNECT_EVENT,
+                               U_SHORT_RANGE_EDM_TEST_CHANNEL, gConnectIpv4, sizeof(gConnectIpv4));
+    expected[numEvents].type = U_SHORT_RANGE_EDM_EVENT_CONNECT_IPv4;
+    numEvents++;
+    for (size_t x = 0; x < sizeof(dataLength) / sizeof(dataLength[0]); x++) {
+        trafficLength += edmEncode(pTraffic + trafficLength, U_SHORT_RANGE_EDM_TEST_TYPE_DATA_EVENT,
+                                   U_SHORT_RANGE_EDM_TEST_CHANNEL, pData, dataLength[x]);
+        expected[numEvents].type = U_SHORT_RANGE_EDM_EVENT_DATA;
+        expected[numEvents].pData = pData;
+        expected[numEvents].length = dataLength[x];
+        numEvents++;
+    }
+    trafficLength += edmEncode(pTraffic + trafficLength, U_SHORT_RANGE_EDM_TEST_TYPE_AT_EVENT,
+                               -1, gAtEvent, sizeof(gAtEvent) - 1);
+    expected[numEvents].type = U_SHORT_RANGE_EDM_EVENT_AT;
+    expected[numEvents].pData = gAtEvent;
+    expected[numEvents].length = sizeof(gAtEvent) - 1;
+    numEvents++;
+    memcpy(pTraffic + trafficLength, gRubbish, sizeof(gRubbish));
+    trafficLength += sizeof(gRubbish);
+    trafficLength += edmEncode(pTraffic + trafficLength, U_SHORT_RANGE_EDM_TEST_TYPE_DISCONNECT_EVENT,
+                               U_SHORT_RANGE_EDM_TEST_CHANNEL, NULL, 0);
+    expected[numEvents].type = U_SHORT_RANGE_EDM_EVENT_DISCONNECT;
+    numEvents++;
+    trafficLength += edmEncode(pTraffic + trafficLength, U_SHORT_RANGE_EDM_TEST_TYPE_START_EVENT,
+                               -1, NULL, 0);
+    expected[numEvents].type = U_SHORT_RANGE_EDM_EVENT_STARTUP;
+    numEvents++;
+    U_PORT_TEST_ASSERT(trafficLength <= U_SHORT_RANGE_EDM_TEST_PARSE_BUFFER_LENGTH_BYTES);
+
+    for (size_t x = 0; x < sizeof(blockSize) / sizeof(blockSize[0]); x++) {
+        U_TEST_PRINT_LINE("parsing %d byte(s) of EDM traffic in blocks of %d byte(s)...",
+                          trafficLength, blockSize[x]);
+        uShortRangeEdmResetParser();
+        eventIndex = 0;
+        startTimeMs = uPortGetTickTimeMs();
+        for (offset = 0; offset < trafficLength; offset += length) {
+            length = trafficLength - offset;
+            if (length > blockSize[x]) {
+                length = blockSize[x];
+            }
+            consumed = 0;
+            while (consumed < length) {
+                pEvent = NULL;
+                consumed += uShortRangeEdmParseBuffer(pTraffic + offset + consumed,
+                                                      length - consumed,
+                                                      &pEvent, &memAvailable);
+                U_PORT_TEST_ASSERT(memAvailable);
+                if (pEvent != NULL) {
+                    U_PORT_TEST_ASSERT(eventIndex < numEvents);
+                    U_PORT_TEST_ASSERT(edmEventIsExpected(pEvent, &(expected[eventIndex])));
+                    eventIndex++;
+                    // The parser waits until told the event is processed
+                    U_PORT_TEST_ASSERT(!uShortRangeEdmParserReady());
+                    uShortRangeEdmResetParser();
+                }
+            }
+        }
+        U_TEST_PRINT_LINE("%d event(s) in %d ms.", eventIndex,
+                          uPortGetTickTimeMs() - startTimeMs);
+        U_PORT_TEST_ASSERT(eventIndex == numEvents);
+    }
+
+    uShortRangeEdmResetParser();
+    uPortFree(pData);
+    uPortFree(pTraffic);
+    uShortRangeMemPoolDeInit();
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+/** Send the EDM traffic of a TCP connection carrying a stream of
+ * full-sized data packets into an EDM stream over a UART and measure
+ * how long it takes for the data to arrive at the data callback.
+ */
+U_PORT_TEST_FUNCTION("[edm]", "edmStreamThroughput")
+{
+    uShortRangeEdmTestStream_t stream;
+    char *pPacket;
+    char *pData;
+    size_t packetLength;
+    size_t totalLength = 0;
+    int32_t startTimeMs;
+    int32_t durationMs;
+    int32_t resourceCount;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    pPacket = (char *) pUPortMalloc(U_SHORT_RANGE_EDM_MTU_IP_MAX_SIZE +
+                                    U_SHORT_RANGE_EDM_MAX_OVERHEAD);
+    U_PORT_TEST_ASSERT(pPacket != NULL);
+    pData = (char *) pUPortMalloc(U_SHORT_RANGE_EDM_MTU_IP_MAX_SIZE);
+    U_PORT_TEST_ASSERT(pData != NULL);
+
+#ifdef U_CFG_TEST_UART_PREFIX
+    U_PORT_TEST_ASSERT(uPortUartPrefix(U_PORT_STRINGIFY_QUOTED(U_CFG_TEST_UART_PREFIX)) == 0);
+#endif
+    gUartAHandle = uPortUartOpen(U_CFG_TEST_UART_A,
+                                 U_CFG_TEST_BAUD_RATE,
+                                 NULL,
+                                 U_SHORT_RANGE_UART_BUFFER_LENGTH_BYTES,
+                                 U_CFG_TEST_PIN_UART_A_TXD,
+                                 U_CFG_TEST_PIN_UART_A_RXD,
+                                 U_CFG_TEST_PIN_UART_A_CTS,
+                                 U_CFG_TEST_PIN_UART_A_RTS);
+    U_PORT_TEST_ASSERT(gUartAHandle >= 0);
+#ifdef U_CFG_TEST_UART_PREFIX
+    U_PORT_TEST_ASSERT(uPortUartPrefix(U_PORT_STRINGIFY_QUOTED(U_CFG_TEST_UART_PREFIX)) == 0);
+#endif
+    gUartBHandle = uPortUartOpen(U_CFG_TEST_UART_B,
+                                 U_CFG_TEST_BAUD_RATE,
+                                 NULL,
+                                 U_SHORT_RANGE_UART_BUFFER_LENGTH_BYTES,
+                                 U_CFG_TEST_PIN_UART_B_TXD,
+                                 U_CFG_TEST_PIN_UART_B_RXD,
+                                 U_CFG_TEST_PIN_UART_B_CTS,
+                                 U_CFG_TEST_PIN_UART_B_RTS);
+    U_PORT_TEST_ASSERT(gUartBHandle >= 0);
+
+    U_PORT_TEST_ASSERT(uShortRangeEdmStreamInit() == 0);
+    gEdmStreamHandle = uShortRangeEdmStreamOpen(gUartAHandle);
+    U_PORT_TEST_ASSERT(gEdmStreamHandle >= 0);
+    memset(&stream, 0, sizeof(stream));
+    U_PORT_TEST_ASSERT(uShortRangeEdmStreamIpEventCallbackSet(gEdmStreamHandle,
+                                                              ipEventCallback,
+                                                              &stream) == 0);
+    U_PORT_TEST_ASSERT(uShortRangeEdmStreamDataEventCallbackSet(gEdmStreamHandle,
+                                                                U_SHORT_RANGE_CONNECTION_TYPE_IP,
+                                                                dataEventCallback,
+                                                                &stream) == 0);
+
+    // Connect
+    packetLength = edmEncode(pPacket, U_SHORT_RANGE_EDM_TEST_TYPE_CONNECT_EVENT,
+                             U_SHORT_RANGE_EDM_TEST_CHANNEL, gConnectIpv4,
+                             sizeof(gConnectIpv4));
+    U_PORT_TEST_ASSERT(uartWriteAll(gUartBHandle, pPacket, packetLength));
+    startTimeMs = uPortGetTickTimeMs();
+    while (!stream.connected &&
+           (uPortGetTickTimeMs() - startTimeMs < U_SHORT_RANGE_EDM_TEST_THROUGHPUT_TIMEOUT_MS)) {
+        uPortTaskBlock(10);
+    }
+    U_PORT_TEST_ASSERT(stream.connected);
+
+    // Send the data
+    U_TEST_PRINT_LINE("sending %d EDM data packet(s) of %d byte(s)...",
+                      U_SHORT_RANGE_EDM_TEST_THROUGHPUT_NUM_PACKETS,
+                      U_SHORT_RANGE_EDM_MTU_IP_MAX_SIZE);
+    startTimeMs = uPortGetTickTimeMs();
+    for (size_t x = 0; x < U_SHORT_RANGE_EDM_TEST_THROUGHPUT_NUM_PACKETS; x++) {
+        fillPattern(pData, U_SHORT_RANGE_EDM_MTU_IP_MAX_SIZE, totalLength);
+        packetLength = edmEncode(pPacket, U_SHORT_RANGE_EDM_TEST_TYPE_DATA_EVENT,
+                                 U_SHORT_RANGE_EDM_TEST_CHANNEL, pData,
+                                 U_SHORT_RANGE_EDM_MTU_IP_MAX_SIZE);
+        while ((totalLength - stream.bytesReceived >= U_SHORT_RANGE_EDM_TEST_THROUGHPUT_WINDOW_PACKETS *
+                U_SHORT_RANGE_EDM_MTU_IP_MAX_SIZE) && (stream.errorCount == 0) &&
+               (uPortGetTickTimeMs() - startTimeMs < U_SHORT_RANGE_EDM_TEST_THROUGHPUT_TIMEOUT_MS)) {
+            uPortTaskBlock(1);
+        }
+        U_PORT_TEST_ASSERT(uartWriteAll(gUartBHandle, pPacket, packetLength));
+        totalLength += U_SHORT_RANGE_EDM_MTU_IP_MAX_SIZE;
+    }
+    while ((stream.bytesReceived < totalLength) && (stream.errorCount == 0) &&
+           (uPortGetTickTimeMs() - startTimeMs < U_SHORT_RANGE_EDM_TEST_THROUGHPUT_TIMEOUT_MS)) {
+        uPortTaskBlock(10);
+    }
+    durationMs = uPortGetTickTimeMs() - startTimeMs;
+    U_TEST_PRINT_LINE("%d byte(s) in %d packet(s) received in %d ms (%d bytes/second).",
+                      stream.bytesReceived, stream.packetsReceived, durationMs,
+                      durationMs > 0 ? (int32_t) ((stream.bytesReceived * 1000) / durationMs) : 0);
+    U_PORT_TEST_ASSERT(stream.errorCount == 0);
+    U_PORT_TEST_ASSERT(stream.bytesReceived == totalLength);
+    U_PORT_TEST_ASSERT(stream.packetsReceived == U_SHORT_RANGE_EDM_TEST_THROUGHPUT_NUM_PACKETS);
+
+    // Disconnect
+    packetLength = edmEncode(pPacket, U_SHORT_RANGE_EDM_TEST_TYPE_DISCONNECT_EVENT,
+                             U_SHORT_RANGE_EDM_TEST_CHANNEL, NULL, 0);
+    U_PORT_TEST_ASSERT(uartWriteAll(gUartBHandle, pPacket, packetLength));
+    startTimeMs = uPortGetTickTimeMs();
+    while (!stream.disconnected &&
+           (uPortGetTickTimeMs() - startTimeMs < U_SHORT_RANGE_EDM_TEST_THROUGHPUT_TIMEOUT_MS)) {
+        uPortTaskBlock(10);
+    }
+    U_PORT_TEST_ASSERT(stream.disconnected);
+
+    uShortRangeEdmStreamClose(gEdmStreamHandle);
+    gEdmStreamHandle = -1;
+    uShortRangeEdmStreamDeinit();
+
+    uPortUartClose(gUartBHandle);
+    gUartBHandle = -1;
+    uPortUartClose(gUartAHandle);
+    gUartAHandle = -1;
+    uPortFree(pData);
+    uPortFree(pPacket);
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+#endif
+
+/** Clean-up to be run at the end of this round of tests, just
+ * in case there were test failures which would have resulted
+ * in the deinitialisation being skipped.
+ */
+U_PORT_TEST_FUNCTION("[edm]", "edmCleanUp")
+{
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+    if (gEdmStreamHandle >= 0) {
+        uShortRangeEdmStreamClose(gEdmStreamHandle);
+    }
+    uShortRangeEdmStreamDeinit();
+    if (gUartBHandle >= 0) {
+        uPortUartClose(gUartBHandle);
+    }
+    if (gUartAHandle >= 0) {
+        uPortUartClose(gUartAHandle);
+    }
+#endif
+    uShortRangeEdmResetParser();
+    uShortRangeMemPoolDeInit();
+    uPortDeinit();
+}
+
+// End of file
@@ -285,10 +285,9 @@ extern "C" {
 
 /** Determine if the bit corresponding to a given file descriptor is set.
  */
-#define U_SOCK_FD_ISSET(d, pSet) if (((d) >= 0) &&                           \
-                                     ((d) < U_SOCK_DESCRIPTOR_SET_SIZE)) {   \
-                                     (*(pSet))[(d) / 8] & (1 << ((d) & 7));  \
-                                 }
+#define U_SOCK_FD_ISSET(d, pSet) ((((d) >= 0) &&                                 \
+                                   ((d) < U_SOCK_DESCRIPTOR_SET_SIZE)) &&         \
+                                  (((*(pSet))[(d) / 8] & (1 << ((d) & 7))) != 0))
 
 /* ----------------------------------------------------------------
  * TYPES
@@ -707,9 +706,30 @@ int32_t uSockAccept(uSockDescriptor_t descriptor,
                     uSockAddress_t *pRemoteAddress);
 
 /** Select: wait for one of a set of sockets to become unblocked.
+ * The wait is event-driven: it ends as soon as data arrives on,
+ * or the far end closes, any of the sockets being selected on,
+ * without polling.
+ *
+ * A descriptor is readable if data has been received on it
+ * which has not yet been read, or if it has been shut down for
+ * reading, or if it is closing or has been closed, i.e. if a
+ * read would not block.  As with BSD sockets, a descriptor may
+ * be reported as readable when a subsequent read finds that the
+ * data has already been consumed (e.g. by a read that emptied
+ * the receive buffer exactly) so it is best to make the sockets
+ * non-blocking when using this function.  A descriptor is
+ * writable if it is open and, for TCP, connected.  A descriptor
+ * is in an exceptional condition if it is closing or has been
+ * closed by the far end.
+ *
+ * Since descriptors are allocated in the range 0 to
+ * #U_SOCK_DESCRIPTOR_SET_SIZE - 1 every open socket can be
+ * placed in a descriptor set.
  *
  * @param maxDescriptor         the highest numbered descriptor in the
- *                              sets that follow to select on + 1.
+ *                              sets that follow to select on + 1;
+ *                              must be no larger than
+ *                              #U_SOCK_DESCRIPTOR_SET_SIZE.
  * @param pReadDescriptorSet    the set of descriptors to check for
  *                              unblocking for a read operation. May
  *                              be NULL.
@@ -719,12 +739,19 @@ int32_t uSockAccept(uSockDescriptor_t descriptor,
  * @param pExceptDescriptorSet  the set of descriptors to check for
  *                              exceptional conditions. May be NULL.
  * @param timeMs                the timeout for the select operation
- *                              in milliseconds.
- * @return                      a positive value if an unblock
- *                              occurred, zero on timeout, negative
- *                              on any other error.  Use
- *                              #U_SOCK_FD_ISSET() to determine
- *                              which descriptor(s) were unblocked.
+ *                              in milliseconds; zero means check
+ *                              and return immediately, a negative
+ *                              value means wait forever.
+ * @return                      a positive value, the total number of
+ *                              descriptors set across the three
+ *                              sets, if an unblock occurred, zero on
+ *                              timeout, negative on any other error
+ *                              (e.g. a descriptor in one of the sets
+ *                              is not open), in which case errno
+ *                              will be set.  On return each set
+ *                              contains only the descriptors that
+ *                              were unblocked: use #U_SOCK_FD_ISSET()
+ *                              to determine which they were.
  */
 int32_t uSockSelect(int32_t maxDescriptor,
                     uSockDescriptorSet_t *pReadDescriptorSet,
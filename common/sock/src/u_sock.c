@@ -336,6 +336,7 @@
 #include "u_sock.h"
 #include "u_sock_security.h"
 #include "u_sock_errno.h"
+#include "u_sock_private.h"
 
 #include "u_cell_sec_tls.h"
 #include "u_cell_sock.h"
@@ -345,22 +346,24 @@
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
-#ifndef U_SOCK_NUM_STATIC_SOCKETS
-/** The number of statically allocated sockets.  When
- * more than this number of sockets are required to
- * be open simultaneously they will be allocated and
- * it is up to the user to call uSockCleanUp()
- * to release the memory occupied by closed allocated
- * sockets when done.
+#ifndef U_SOCK_CONTAINER_HASH_NUM_BUCKETS
+/** The number of buckets in the hash table that indexes socket
+ * containers by network handle and socket handle, used to find
+ * the container quickly from the callbacks of the underlying
+ * socket layer; must be a power of two.
  */
-# define U_SOCK_NUM_STATIC_SOCKETS     7
+# define U_SOCK_CONTAINER_HASH_NUM_BUCKETS 16
 #endif
 
-/** Increment a socket descriptor.
+/** Increment a socket descriptor, wrapping so that every
+ * descriptor fits into a uSockDescriptorSet_t for uSockSelect();
+ * there can be no more than U_SOCK_MAX_NUM_SOCKETS open at
+ * any one time so a free one will always be found.
  */
-#define U_SOCK_INC_DESCRIPTOR(d)  (d)++;         \
-                                  if ((d) < 0) { \
-                                      d = 0;     \
+#define U_SOCK_INC_DESCRIPTOR(d)  (d)++;                                   \
+                                  if (((d) < 0) ||                         \
+                                      ((d) >= U_SOCK_DESCRIPTOR_SET_SIZE)) { \
+                                      d = 0;                               \
                                   }
 
 /* ----------------------------------------------------------------
@@ -403,6 +406,10 @@ typedef struct {
     void *pDataCallbackParameter;
     void (*pClosedCallback) (void *);
     void *pClosedCallbackParameter;
+    volatile uint32_t dataEventCount; /**< Incremented by dataCallback(). */
+    uint32_t dataEventCountRead; /**< The value of dataEventCount
+                                      when a receive last found
+                                      no data waiting. */
     bool blocking; // At end to optimise structure packing
 } uSockSocket_t;
 
@@ -413,9 +420,19 @@ typedef struct uSockContainer_t {
     uSockDescriptor_t descriptor;
     uSockSocket_t socket;
     struct uSockContainer_t *pNext;
+    struct uSockContainer_t *pHashNext; /**< Next in the same bucket of
+                                             gpContainerHash[]. */
     bool isStatic; // At end to optimise structure packing
 } uSockContainer_t;
 
+/** A task waiting in uSockSelect(); these live on the stack
+ * of the waiting task.
+ */
+typedef struct uSockSelectWaiter_t {
+    uPortSemaphoreHandle_t semaphore;
+    struct uSockSelectWaiter_t *pNext;
+} uSockSelectWaiter_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -432,10 +449,31 @@ static uPortMutexHandle_t gMutexContainer = NULL;
  */
 static uPortMutexHandle_t gMutexCallbacks = NULL;
 
+/** Root of the list of tasks waiting in uSockSelect(),
+ * protected by gMutexCallbacks.
+ */
+static uSockSelectWaiter_t *gpSelectWaiterListHead = NULL;
+
 /** Root of the socket container list.
  */
 static uSockContainer_t *gpContainerListHead = NULL;
 
+/** Socket containers indexed by descriptor; an entry may
+ * be stale (closed or re-used with another descriptor) so
+ * always check the descriptor and state of what is found.
+ */
+static uSockContainer_t *gpContainerByDescriptor[U_SOCK_DESCRIPTOR_SET_SIZE] = {0};
+
+/** Socket containers indexed by a hash of network handle and
+ * socket handle, chained through pHashNext.
+ */
+static uSockContainer_t *gpContainerHash[U_SOCK_CONTAINER_HASH_NUM_BUCKETS] = {0};
+
+/** Allocated containers that have been cleaned up, kept for
+ * re-use, chained through pNext.
+ */
+static uSockContainer_t *gpContainerPool = NULL;
+
 /** The next descriptor to use.
  */
 static uSockDescriptor_t gNextDescriptor = 0;
@@ -492,6 +530,9 @@ static int32_t init()
             }
 
             if (errnoLocal == U_SOCK_ENONE) {
+                // Empty the indexes
+                memset(gpContainerByDescriptor, 0, sizeof(gpContainerByDescriptor));
+                memset(gpContainerHash, 0, sizeof(gpContainerHash));
                 //  Link the static containers into the start of the container list
                 for (size_t x = 0; x < sizeof(gStaticContainers) /
                      sizeof(gStaticContainers[0]); x++) {
@@ -499,6 +540,7 @@ static int32_t init()
                     (*ppContainer)->isStatic = true;
                     (*ppContainer)->socket.state = U_SOCK_STATE_CLOSED;
                     (*ppContainer)->pNext = NULL;
+                    (*ppContainer)->pHashNext = NULL;
                     if (ppPreviousNext != NULL) {
                         *ppPreviousNext = *ppContainer;
                     }
@@ -539,21 +581,69 @@ static void deinitButNotMutex()
  * STATIC FUNCTIONS: CONTAINER STUFF
  * -------------------------------------------------------------- */
 
+// Return the bucket of gpContainerHash[] for the given network
+// handle and socket handle.
+static size_t containerHashIndex(uDeviceHandle_t devHandle,
+                                 int32_t sockHandle)
+{
+    uint32_t hash = (uint32_t) (((uintptr_t) devHandle) >> 2);
+
+    hash ^= ((uint32_t) sockHandle) * 2654435761U;
+    hash ^= hash >> 16;
+
+    return (size_t) (hash & (U_SOCK_CONTAINER_HASH_NUM_BUCKETS - 1));
+}
+
+// Add a container to the hash index; devHandle and sockHandle
+// must have been populated.
+// This does NOT lock the mutex, you need to do that.
+static void containerHashAdd(uSockContainer_t *pContainer)
+{
+    uSockContainer_t **ppBucket = &(gpContainerHash[containerHashIndex(pContainer->socket.devHandle,
+                                                                       pContainer->socket.sockHandle)]);
+
+    pContainer->pHashNext = *ppBucket;
+    *ppBucket = pContainer;
+}
+
+// Remove a container from the hash index and the descriptor
+// table, if it is there.
+// This does NOT lock the mutex, you need to do that.
+static void containerIndexRemove(const uSockContainer_t *pContainer)
+{
+    uSockContainer_t **ppThis;
+
+    if ((pContainer->descriptor >= 0) &&
+        (pContainer->descriptor < U_SOCK_DESCRIPTOR_SET_SIZE) &&
+        (gpContainerByDescriptor[pContainer->descriptor] == pContainer)) {
+        gpContainerByDescriptor[pContainer->descriptor] = NULL;
+    }
+
+    ppThis = &(gpContainerHash[containerHashIndex(pContainer->socket.devHandle,
+                                                  pContainer->socket.sockHandle)]);
+    while (*ppThis != NULL) {
+        if (*ppThis == pContainer) {
+            *ppThis = pContainer->pHashNext;
+        } else {
+            ppThis = &((*ppThis)->pHashNext);
+        }
+    }
+}
+
 // Find the socket container for the given descriptor.
 // Will not find sockets in state CLOSED.
 // This does NOT lock the mutex, you need to do that.
 static uSockContainer_t *pContainerFindByDescriptor(uSockDescriptor_t descriptor)
 {
     uSockContainer_t *pContainer = NULL;
-    uSockContainer_t *pContainerThis = gpContainerListHead;
 
-    while ((pContainerThis != NULL) &&
-           (pContainer == NULL)) {
-        if ((pContainerThis->descriptor == descriptor) &&
-            (pContainerThis->socket.state != U_SOCK_STATE_CLOSED)) {
-            pContainer = pContainerThis;
+    if ((descriptor >= 0) && (descriptor < U_SOCK_DESCRIPTOR_SET_SIZE)) {
+        pContainer = gpContainerByDescriptor[descriptor];
+        if ((pContainer != NULL) &&
+            ((pContainer->descriptor != descriptor) ||
+             (pContainer->socket.state == U_SOCK_STATE_CLOSED))) {
+            pContainer = NULL;
         }
-        pContainerThis = pContainerThis->pNext;
     }
 
     return pContainer;
@@ -568,17 +658,30 @@ static uSockContainer_t *pContainerFindByDeviceHandle(uDeviceHandle_t devHandle,
                                                       int32_t sockHandle)
 {
     uSockContainer_t *pContainer = NULL;
-    uSockContainer_t *pContainerThis = gpContainerListHead;
-
-    while ((pContainerThis != NULL) &&
-           (pContainer == NULL)) {
-        if ((pContainerThis->socket.devHandle == devHandle) &&
-            ((pContainerThis->socket.sockHandle == sockHandle) ||
-             (pContainerThis->socket.sockHandle < 0)) &&
-            (pContainerThis->socket.state != U_SOCK_STATE_CLOSED)) {
-            pContainer = pContainerThis;
+    uSockContainer_t *pContainerThis;
+
+    if (sockHandle >= 0) {
+        // Only containers with a socket handle are in the hash index
+        pContainerThis = gpContainerHash[containerHashIndex(devHandle, sockHandle)];
+        while ((pContainerThis != NULL) && (pContainer == NULL)) {
+            if ((pContainerThis->socket.devHandle == devHandle) &&
+                (pContainerThis->socket.sockHandle == sockHandle) &&
+                (pContainerThis->socket.state != U_SOCK_STATE_CLOSED)) {
+                pContainer = pContainerThis;
+            }
+            pContainerThis = pContainerThis->pHashNext;
+        }
+    } else {
+        pContainerThis = gpContainerListHead;
+        while ((pContainerThis != NULL) &&
+               (pContainer == NULL)) {
+            if ((pContainerThis->socket.devHandle == devHandle) &&
+                (pContainerThis->socket.sockHandle < 0) &&
+                (pContainerThis->socket.state != U_SOCK_STATE_CLOSED)) {
+                pContainer = pContainerThis;
+            }
+            pContainerThis = pContainerThis->pNext;
         }
-        pContainerThis = pContainerThis->pNext;
     }
 
     return pContainer;
@@ -601,6 +704,27 @@ static size_t numContainersInUse()
     return numInUse;
 }
 
+// Release an allocated container to the pool.
+// This does NOT lock the mutex, you need to do that.
+static void containerRelease(uSockContainer_t *pContainer)
+{
+    pContainer->pNext = gpContainerPool;
+    gpContainerPool = pContainer;
+}
+
+// Free all of the containers in the pool.
+// This does NOT lock the mutex, you need to do that.
+static void containerPoolFree()
+{
+    uSockContainer_t *pTmp;
+
+    while (gpContainerPool != NULL) {
+        pTmp = gpContainerPool->pNext;
+        uPortFree(gpContainerPool);
+        gpContainerPool = pTmp;
+    }
+}
+
 // Create a socket in a container with the given descriptor.
 // This does NOT lock the mutex, you need to do that.
 static uSockContainer_t *pSockContainerCreate(uSockDescriptor_t descriptor,
@@ -616,6 +740,8 @@ static uSockContainer_t *pSockContainerCreate(uSockDescriptor_t descriptor,
     while ((*ppContainerThis != NULL) && (pContainer == NULL)) {
         if ((*ppContainerThis)->socket.state == U_SOCK_STATE_CLOSED) {
             pContainer = *ppContainerThis;
+            // Drop the old identity from the indexes
+            containerIndexRemove(pContainer);
         }
         pContainerPrevious = *ppContainerThis;
         ppContainerThis = &((*ppContainerThis)->pNext);
@@ -623,9 +749,15 @@ static uSockContainer_t *pSockContainerCreate(uSockDescriptor_t descriptor,
 
     if (pContainer == NULL) {
         // Reached the end of the list and found no re-usable
-        // containers, so allocate memory for the new container
-        // and add it to the list
-        pContainer = (uSockContainer_t *) pUPortMalloc(sizeof (*pContainer));
+        // containers, so take one from the pool or, failing
+        // that, allocate memory for the new container, and
+        // add it to the list
+        pContainer = gpContainerPool;
+        if (pContainer != NULL) {
+            gpContainerPool = pContainer->pNext;
+        } else {
+            pContainer = (uSockContainer_t *) pUPortMalloc(sizeof (*pContainer));
+        }
         if (pContainer != NULL) {
             pContainer->isStatic = false;
             pContainer->pPrevious = pContainerPrevious;
@@ -637,6 +769,7 @@ static uSockContainer_t *pSockContainerCreate(uSockDescriptor_t descriptor,
     // Set up the new container and socket
     if (pContainer != NULL) {
         pContainer->descriptor = descriptor;
+        pContainer->pHashNext = NULL;
         memset(&(pContainer->socket), 0, sizeof(pContainer->socket));
         pContainer->socket.type = type;
         pContainer->socket.protocol = protocol;
@@ -650,6 +783,7 @@ static uSockContainer_t *pSockContainerCreate(uSockDescriptor_t descriptor,
         pContainer->socket.pDataCallbackParameter = NULL;
         pContainer->socket.pClosedCallback = NULL;
         pContainer->socket.pClosedCallbackParameter = NULL;
+        gpContainerByDescriptor[descriptor] = pContainer;
     }
 
     return pContainer;
@@ -660,36 +794,33 @@ static uSockContainer_t *pSockContainerCreate(uSockDescriptor_t descriptor,
 // This does NOT lock the mutex, you need to do that.
 static bool containerFree(uSockDescriptor_t descriptor)
 {
-    uSockContainer_t **ppContainer = NULL;
-    uSockContainer_t **ppContainerThis = &gpContainerListHead;
+    uSockContainer_t *pContainer = pContainerFindByDescriptor(descriptor);
     bool success = false;
 
-    while ((*ppContainerThis != NULL) &&
-           (ppContainer == NULL)) {
-        if ((*ppContainerThis)->descriptor == descriptor) {
-            ppContainer = ppContainerThis;
-        } else {
-            ppContainerThis = &((*ppContainerThis)->pNext);
-        }
-    }
-
-    if ((ppContainer != NULL) && (*ppContainer != NULL)) {
-        if (!(*ppContainer)->isStatic) {
-            // If we found it, and it wasn't static, free it
+    if (pContainer != NULL) {
+        containerIndexRemove(pContainer);
+        if (!pContainer->isStatic) {
+            // If we found it, and it wasn't static, uncouple it
             // If there is a previous container, move its pNext
-            if ((*ppContainer)->pPrevious != NULL) {
-                (*ppContainer)->pPrevious->pNext = (*ppContainer)->pNext;
+            if (pContainer->pPrevious != NULL) {
+                pContainer->pPrevious->pNext = pContainer->pNext;
+            } else {
+                // If there is no previous container, must be
+                // at the start of the list so move the head
+                // pointer on instead
+                gpContainerListHead = pContainer->pNext;
             }
             // If there is a next container, move its pPrevious
-            if ((*ppContainer)->pNext != NULL) {
-                (*ppContainer)->pNext->pPrevious = (*ppContainer)->pPrevious;
+            if (pContainer->pNext != NULL) {
+                pContainer->pNext->pPrevious = pContainer->pPrevious;
             }
 
-            // Free the memory and NULL the pointer
-            uPortFree(*ppContainer);
-            *ppContainer = NULL;
+            // Return the memory to the pool
+            containerRelease(pContainer);
         } else {
-            // Nothing to do for a static container,
+            // Nothing to do for a static container other than
+            // mark it as re-usable once more
+            pContainer->socket.state = U_SOCK_STATE_CLOSED;
         }
 
         success = true;
@@ -702,6 +833,18 @@ static bool containerFree(uSockDescriptor_t descriptor)
  * STATIC FUNCTIONS: CALLBACKS
  * -------------------------------------------------------------- */
 
+// Wake up any tasks waiting in uSockSelect().
+// This does NOT lock gMutexCallbacks, you need to do that.
+static void selectWake()
+{
+    uSockSelectWaiter_t *pWaiter = gpSelectWaiterListHead;
+
+    while (pWaiter != NULL) {
+        uPortSemaphoreGive(pWaiter->semaphore);
+        pWaiter = pWaiter->pNext;
+    }
+}
+
 // Callback for when local socket closures at the underlying
 // cell/wifi socket layer happen asynchronously, either
 // due to local closure or by the remote host
@@ -719,6 +862,7 @@ static void closedCallback(uDeviceHandle_t devHandle,
         // Mark the container as closed
         pContainer->socket.state = U_SOCK_STATE_CLOSED;
         U_PORT_MUTEX_LOCK(gMutexCallbacks);
+        selectWake();
         if (pContainer->socket.pClosedCallback != NULL) {
             pContainer->socket.pClosedCallback(pContainer->socket.pClosedCallbackParameter);
             pContainer->socket.pClosedCallback = NULL;
@@ -745,6 +889,8 @@ static void dataCallback(uDeviceHandle_t devHandle,
                                               sockHandle);
     if (pContainer != NULL) {
         U_PORT_MUTEX_LOCK(gMutexCallbacks);
+        pContainer->socket.dataEventCount++;
+        selectWake();
         if (pContainer->socket.pDataCallback != NULL) {
             pContainer->socket.pDataCallback(pContainer->socket.pDataCallbackParameter);
         }
@@ -1169,6 +1315,19 @@ static int32_t uSockCreateEx(uDeviceHandle_t devHandle,
                         pContainer->socket.sockHandle = sockHandle;
                         pContainer->socket.devHandle = devHandle;
                         pContainer->socket.bytesSent = 0;
+                        containerHashAdd(pContainer);
+                        // Always hook the data callback of the
+                        // underlying socket layer so that
+                        // uSockSelect() is woken when data arrives
+                        if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
+                            uCellSockRegisterCallbackData(devHandle,
+                                                          sockHandle,
+                                                          dataCallback);
+                        } else if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
+                            uWifiSockRegisterCallbackData(devHandle,
+                                                          sockHandle,
+                                                          dataCallback);
+                        }
                         uPortLog("U_SOCK: socket created, descriptor %d,"
                                  " network handle 0x%08x, socket handle %d.\n",
                                  descriptorOrError, devHandle, sockHandle);
@@ -1201,7 +1360,7 @@ static int32_t uSockCreateEx(uDeviceHandle_t devHandle,
  * -------------------------------------------------------------- */
 
 // Receive data on a socket, either UDP or TCP.
-static int32_t receive(const uSockContainer_t *pContainer,
+static int32_t receive(uSockContainer_t *pContainer,
                        uSockAddress_t *pRemoteAddress,
                        void *pData, size_t dataSizeBytes)
 {
@@ -1210,10 +1369,15 @@ static int32_t receive(const uSockContainer_t *pContainer,
     int32_t negErrnoOrSize = -U_SOCK_ENOSYS;
     int32_t startTimeMs = uPortGetTickTimeMs();
     int32_t devType = uDeviceGetDeviceType(devHandle);
+    uint32_t dataEventCount;
 
     // Run around the loop until a packet of data turns up
     // or we time out or just once if we're non-blocking.
     do {
+        // Take a snapshot of the data event count _before_
+        // receiving so that, should the receive find nothing,
+        // a data event which arrives in the meantime is not lost
+        dataEventCount = pContainer->socket.dataEventCount;
         if ((pContainer->socket.protocol == U_SOCK_PROTOCOL_UDP) &&
             (pContainer->socket.pSecurityContext == NULL)) {
             // UDP style
@@ -1245,6 +1409,9 @@ static int32_t receive(const uSockContainer_t *pContainer,
             }
         }
         if (negErrnoOrSize < 0) {
+            // Nothing to read: uSockSelect() need no longer
+            // report this socket as readable
+            pContainer->socket.dataEventCountRead = dataEventCount;
             // Yield for the poll interval
             uPortTaskBlock(U_SOCK_RECEIVE_POLL_INTERVAL_MS);
         }
@@ -1256,6 +1423,80 @@ static int32_t receive(const uSockContainer_t *pContainer,
     return negErrnoOrSize;
 }
 
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: SELECT
+ * -------------------------------------------------------------- */
+
+// Check the descriptors in the "in" sets (any of which may be
+// NULL) for readiness, setting the ready ones in the "out" sets,
+// which must have been zeroed, and returning the total number of
+// descriptors set, or negated errno if a descriptor cannot be
+// found and closedIsError is true; if closedIsError is false a
+// descriptor that cannot be found is taken to have been closed
+// by the far end while we waited.
+// This does NOT lock the mutex, you need to do that.
+static int32_t selectCheck(int32_t maxDescriptor,
+                           uSockDescriptorSet_t *pReadSetIn,
+                           uSockDescriptorSet_t *pWriteSetIn,
+                           uSockDescriptorSet_t *pExceptSetIn,
+                           uSockDescriptorSet_t *pReadSetOut,
+                           uSockDescriptorSet_t *pWriteSetOut,
+                           uSockDescriptorSet_t *pExceptSetOut,
+                           bool closedIsError)
+{
+    int32_t negErrnoOrNum = 0;
+    const uSockContainer_t *pContainer;
+    bool inRead;
+    bool inWrite;
+    bool inExcept;
+    bool closing;
+
+    for (int32_t d = 0; (d < maxDescriptor) && (negErrnoOrNum >= 0); d++) {
+        inRead = (pReadSetIn != NULL) && U_SOCK_FD_ISSET(d, pReadSetIn);
+        inWrite = (pWriteSetIn != NULL) && U_SOCK_FD_ISSET(d, pWriteSetIn);
+        inExcept = (pExceptSetIn != NULL) && U_SOCK_FD_ISSET(d, pExceptSetIn);
+        if (inRead || inWrite || inExcept) {
+            pContainer = pContainerFindByDescriptor(d);
+            if (pContainer != NULL) {
+                closing = (pContainer->socket.state == U_SOCK_STATE_CLOSING);
+                if (inRead &&
+                    (closing ||
+                     (pContainer->socket.state == U_SOCK_STATE_SHUTDOWN_FOR_READ) ||
+                     (pContainer->socket.state == U_SOCK_STATE_SHUTDOWN_FOR_READ_WRITE) ||
+                     (pContainer->socket.dataEventCount != pContainer->socket.dataEventCountRead))) {
+                    U_SOCK_FD_SET(d, pReadSetOut);
+                    negErrnoOrNum++;
+                }
+                if (inWrite &&
+                    ((pContainer->socket.protocol != U_SOCK_PROTOCOL_TCP) ||
+                     (pContainer->socket.state != U_SOCK_STATE_CREATED))) {
+                    U_SOCK_FD_SET(d, pWriteSetOut);
+                    negErrnoOrNum++;
+                }
+                if (inExcept && closing) {
+                    U_SOCK_FD_SET(d, pExceptSetOut);
+                    negErrnoOrNum++;
+                }
+            } else if (closedIsError) {
+                negErrnoOrNum = -U_SOCK_EBADF;
+            } else {
+                // Closed while we waited: a read will not block
+                // and this is certainly exceptional
+                if (inRead) {
+                    U_SOCK_FD_SET(d, pReadSetOut);
+                    negErrnoOrNum++;
+                }
+                if (inExcept) {
+                    U_SOCK_FD_SET(d, pExceptSetOut);
+                    negErrnoOrNum++;
+                }
+            }
+        }
+    }
+
+    return negErrnoOrNum;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: CREATE/OPEN/CLOSE/CLEAN-UP
  * -------------------------------------------------------------- */
@@ -1491,13 +1732,15 @@ void uSockCleanUp()
                     pTmp = pContainer->pNext;
                     devHandle = pContainer->socket.devHandle;
 
-                    // Free the memory
-                    uPortFree(pContainer);
+                    // Return the memory to the pool
+                    containerIndexRemove(pContainer);
+                    containerRelease(pContainer);
                     // Move to the next entry
                     pContainer = pTmp;
                 } else {
                     // Remember the network handle
                     devHandle = pContainer->socket.devHandle;
+                    containerIndexRemove(pContainer);
                     pContainer->socket.state = U_SOCK_STATE_CLOSED;
                     pContainer->socket.devHandle = NULL;
                     // Move on
@@ -1523,6 +1766,7 @@ void uSockCleanUp()
 
         // If everything has been closed, we can deinit();
         if (numNonClosedSockets == 0) {
+            containerPoolFree();
             deinitButNotMutex();
         }
 
@@ -1581,10 +1825,12 @@ void uSockDeinit()
                 pTmp = pContainer->pNext;
 
                 // Free the memory
+                containerIndexRemove(pContainer);
                 uPortFree(pContainer);
                 // Move to the next entry
                 pContainer = pTmp;
             } else {
+                containerIndexRemove(pContainer);
                 pContainer->socket.state = U_SOCK_STATE_CLOSED;
                 // Move on
                 pContainer = pContainer->pNext;
@@ -1592,6 +1838,7 @@ void uSockDeinit()
         }
 
         // We can now deinit();
+        containerPoolFree();
         deinitButNotMutex();
 
         U_PORT_MUTEX_UNLOCK(gMutexContainer);
@@ -2356,6 +2603,12 @@ int32_t uSockShutdown(uSockDescriptor_t descriptor,
                     errnoLocal = U_SOCK_EINVAL;
                     break;
             }
+            if (errnoLocal == U_SOCK_ENONE) {
+                // Readiness may have changed
+                U_PORT_MUTEX_LOCK(gMutexCallbacks);
+                selectWake();
+                U_PORT_MUTEX_UNLOCK(gMutexCallbacks);
+            }
         }
 
         U_PORT_MUTEX_UNLOCK(gMutexContainer);
@@ -2642,14 +2895,108 @@ int32_t uSockSelect(int32_t maxDescriptor,
                     uSockDescriptorSet_t *pExceptDescriptorSet,
                     int32_t timeMs)
 {
-    // TODO
-    (void) maxDescriptor;
-    (void) pReadDescriptorSet;
-    (void) pWriteDescriptoreSet;
-    (void) pExceptDescriptorSet;
-    (void) timeMs;
-    errno = U_SOCK_ENOSYS;
-    return (int32_t) U_ERROR_COMMON_NOT_IMPLEMENTED;
+    int32_t errorCodeOrNum = (int32_t) U_ERROR_COMMON_SUCCESS;
+    int32_t errnoLocal;
+    int32_t negErrnoOrNum = 0;
+    int32_t startTimeMs = uPortGetTickTimeMs();
+    int32_t waitMs;
+    uSockSelectWaiter_t waiter = {0};
+    uSockSelectWaiter_t **ppWaiter;
+    uSockDescriptorSet_t readSet;
+    uSockDescriptorSet_t writeSet;
+    uSockDescriptorSet_t exceptSet;
+    bool closedIsError = true;
+    bool done = false;
+
+    errnoLocal = init();
+    if (errnoLocal == U_SOCK_ENONE) {
+        errnoLocal = U_SOCK_EINVAL;
+        if ((maxDescriptor >= 0) &&
+            (maxDescriptor <= U_SOCK_DESCRIPTOR_SET_SIZE)) {
+            errnoLocal = U_SOCK_ENOMEM;
+            if (uPortSemaphoreCreate(&(waiter.semaphore), 0, 1) == 0) {
+                errnoLocal = U_SOCK_ENONE;
+                // Add ourselves to the list of waiters _before_
+                // checking for readiness so that no event is missed
+                U_PORT_MUTEX_LOCK(gMutexCallbacks);
+                waiter.pNext = gpSelectWaiterListHead;
+                gpSelectWaiterListHead = &waiter;
+                U_PORT_MUTEX_UNLOCK(gMutexCallbacks);
+
+                do {
+                    U_SOCK_FD_ZERO(&readSet);
+                    U_SOCK_FD_ZERO(&writeSet);
+                    U_SOCK_FD_ZERO(&exceptSet);
+
+                    U_PORT_MUTEX_LOCK(gMutexContainer);
+                    negErrnoOrNum = selectCheck(maxDescriptor,
+                                                pReadDescriptorSet,
+                                                pWriteDescriptoreSet,
+                                                pExceptDescriptorSet,
+                                                &readSet, &writeSet,
+                                                &exceptSet, closedIsError);
+                    U_PORT_MUTEX_UNLOCK(gMutexContainer);
+
+                    // All descriptors were valid at the outset,
+                    // any that go missing have since been closed
+                    closedIsError = false;
+                    if (negErrnoOrNum != 0) {
+                        done = true;
+                    } else if (timeMs < 0) {
+                        // Nothing ready, wait forever to be woken
+                        // by a data or closed callback
+                        uPortSemaphoreTake(waiter.semaphore);
+                    } else {
+                        // As above but with a timeout; whether woken
+                        // or timed-out, go around again to check
+                        waitMs = timeMs - (int32_t) (uPortGetTickTimeMs() - startTimeMs);
+                        if (waitMs > 0) {
+                            uPortSemaphoreTryTake(waiter.semaphore, waitMs);
+                        } else {
+                            done = true;
+                        }
+                    }
+                } while (!done);
+
+                U_PORT_MUTEX_LOCK(gMutexCallbacks);
+                ppWaiter = &gpSelectWaiterListHead;
+                while (*ppWaiter != NULL) {
+                    if (*ppWaiter == &waiter) {
+                        *ppWaiter = waiter.pNext;
+                    } else {
+                        ppWaiter = &((*ppWaiter)->pNext);
+                    }
+                }
+                U_PORT_MUTEX_UNLOCK(gMutexCallbacks);
+                uPortSemaphoreDelete(waiter.semaphore);
+
+                if (negErrnoOrNum >= 0) {
+                    // Hand back the descriptors that are ready
+                    // (none on a timeout)
+                    if (pReadDescriptorSet != NULL) {
+                        memcpy(*pReadDescriptorSet, readSet, sizeof(readSet));
+                    }
+                    if (pWriteDescriptoreSet != NULL) {
+                        memcpy(*pWriteDescriptoreSet, writeSet, sizeof(writeSet));
+                    }
+                    if (pExceptDescriptorSet != NULL) {
+                        memcpy(*pExceptDescriptorSet, exceptSet, sizeof(exceptSet));
+                    }
+                    errorCodeOrNum = negErrnoOrNum;
+                } else {
+                    errnoLocal = -negErrnoOrNum;
+                }
+            }
+        }
+    }
+
+    if (errnoLocal != U_SOCK_ENONE) {
+        // Write the errno
+        errno = errnoLocal;
+        errorCodeOrNum = (int32_t) U_ERROR_COMMON_BSD_ERROR;
+    }
+
+    return errorCodeOrNum;
 }
 
 /* ----------------------------------------------------------------
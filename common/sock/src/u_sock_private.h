@@ -0,0 +1,56 @@
+/*
+ * Copyright 2019-2023 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_SOCK_PRIVATE_H_
+#define _U_SOCK_PRIVATE_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** @file
+ * @brief This header file defines the implementation settings of
+ * the sockets API which are private to it but which its tests
+ * need to see.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_SOCK_NUM_STATIC_SOCKETS
+/** The number of statically allocated sockets.  When
+ * more than this number of sockets are required to
+ * be open simultaneously they will be allocated and
+ * it is up to the user to call uSockCleanUp()
+ * to release the memory occupied by closed allocated
+ * sockets when done.
+ */
+# define U_SOCK_NUM_STATIC_SOCKETS     7
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _U_SOCK_PRIVATE_H_
+
+// End of file
@@ -1116,6 +1116,8 @@ U_PORT_TEST_FUNCTION("[sock]", "sockBasicTcp")
     size_t offset;
     int32_t y;
     char *pDataReceived;
+    uSockDescriptorSet_t readSet;
+    uSockDescriptorSet_t writeSet;
     int32_t startTimeMs;
     int32_t heapUsed;
     int32_t heapSockInitLoss = 0;
@@ -1246,6 +1248,21 @@ U_PORT_TEST_FUNCTION("[sock]", "sockBasicTcp")
         memset(pDataReceived,
                U_SOCK_TEST_FILL_CHARACTER,
                (sizeof(gSendData) - 1) + (U_SOCK_TEST_GUARD_LENGTH_SIZE_BYTES * 2));
+
+        U_TEST_PRINT_LINE("waiting for the echo with uSockSelect()...");
+        startTimeMs = uPortGetTickTimeMs();
+        U_SOCK_FD_ZERO(&readSet);
+        U_SOCK_FD_SET(descriptor, &readSet);
+        U_SOCK_FD_ZERO(&writeSet);
+        U_SOCK_FD_SET(descriptor, &writeSet);
+        errorCode = uSockSelect(descriptor + 1, &readSet, &writeSet, NULL, 20000);
+        U_TEST_PRINT_LINE("uSockSelect() returned %d after %d ms.", errorCode,
+                          (int32_t) (uPortGetTickTimeMs() - startTimeMs));
+        U_PORT_TEST_ASSERT(errorCode == 2);
+        U_PORT_TEST_ASSERT(U_SOCK_FD_ISSET(descriptor, &readSet));
+        U_PORT_TEST_ASSERT(U_SOCK_FD_ISSET(descriptor, &writeSet));
+        U_PORT_TEST_ASSERT(errno == 0);
+
         startTimeMs = uPortGetTickTimeMs();
         offset = 0;
         //lint -e{441} Suppress loop variable not found in
@@ -1289,6 +1306,11 @@ U_PORT_TEST_FUNCTION("[sock]", "sockBasicTcp")
                                      sizeof(gSendData) - 1) < 0);
         U_PORT_TEST_ASSERT(errno > 0);
         errno = 0;
+        // A socket that is shut down for read must not block a select
+        U_SOCK_FD_ZERO(&readSet);
+        U_SOCK_FD_SET(descriptor, &readSet);
+        U_PORT_TEST_ASSERT(uSockSelect(descriptor + 1, &readSet, NULL, NULL, 0) == 1);
+        U_PORT_TEST_ASSERT(U_SOCK_FD_ISSET(descriptor, &readSet));
 
         U_TEST_PRINT_LINE("shutting down socket for write...");
         errorCode = uSockShutdown(descriptor,
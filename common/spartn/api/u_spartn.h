@@ -56,10 +56,36 @@ extern "C" {
  */
 #define U_SPARTN_MESSAGE_LENGTH_MAX_BYTES (4 + 8 + 1024 + 64 + 4)
 
+/** The maximum length of a SPARTN message header: FRAME START +
+ * largest PAYLOAD DESCRIPTION (i.e. 32-bit GNSS time tag and
+ * ENCRYPT/AUTH); passing this much data to uSpartnDetect() is
+ * always sufficient to determine the length of a message.
+ */
+#define U_SPARTN_HEADER_LENGTH_MAX_BYTES (4 + 6 + 2)
+
+/** The preamble byte (TF001) with which every SPARTN message begins.
+ */
+#define U_SPARTN_PREAMBLE 0x73
+
+/** The sync bytes to pass to uRingBufferParseHandleSync() when
+ * uSpartnParse() is in the parser list, allowing everything that
+ * cannot be the start of a SPARTN message to be skipped quickly;
+ * this is just the preamble, #U_SPARTN_PREAMBLE, as a string.
+ */
+#define U_SPARTN_PARSE_SYNC_BYTES "\x73"
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** The identity of a SPARTN message, as returned by uSpartnParse().
+ */
+typedef struct {
+    int32_t type;    /**< the message type (TF002), set this to -1
+                          before calling uRingBufferParseHandle(). */
+    int32_t subType; /**< the message sub-type (TF007). */
+} uSpartnMessageId_t;
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -145,6 +171,57 @@ int32_t uSpartnDetect(const char *pBuffer, size_t bufferLengthBytes,
 int32_t uSpartnValidate(const char *pBuffer, size_t bufferLengthBytes,
                         const char **ppMessage);
 
+/** A ring-buffer parser for SPARTN messages, of type
+ * #U_RING_BUFFER_PARSER_f, for use with uRingBufferParseHandle() or
+ * uRingBufferParseHandleSync(), allowing SPARTN messages to be
+ * found, and validated (frame CRC and message CRC), as they arrive
+ * in a continuous stream of bytes, e.g. from an L-band receiver or
+ * from an MQTT broker, without the data having to be copied out of
+ * the ring buffer or searched more than once.  A SPARTN message is
+ * only recognised once all of it is in the ring buffer.  For
+ * instance:
+ *
+ * ```
+ * U_RING_BUFFER_PARSER_f parserList[] = {uSpartnParse, NULL};
+ * uSpartnMessageId_t id = {-1, -1};
+ * int32_t x;
+ *
+ * x = (int32_t) uRingBufferParseHandleSync(&ringBuffer, readHandle,
+ *                                          parserList,
+ *                                          U_SPARTN_PARSE_SYNC_BYTES,
+ *                                          sizeof(U_SPARTN_PARSE_SYNC_BYTES) - 1,
+ *                                          &id);
+ * if (id.type >= 0) {
+ *     // There is a SPARTN message of length x at the read handle
+ * } else if (x > 0) {
+ *     // There are x bytes to be discarded
+ * }
+ * ```
+ *
+ * ...where, if x is positive, uRingBufferReadHandle() should be
+ * used to remove (or uRingBufferPeekHandle() to copy) that many
+ * bytes from the ring buffer before calling again; if x is
+ * #U_ERROR_COMMON_TIMEOUT more data is needed.
+ *
+ * Note: u_ringbuffer.h must be included before this header file
+ * in order to use this function.
+ *
+ * @param parseHandle    the parse handle of the ring buffer to read
+ *                       from.
+ * @param[in] pUserParam the user parameter passed to
+ *                       uRingBufferParseHandle(): may be NULL, else
+ *                       a pointer to a #uSpartnMessageId_t, which
+ *                       will be populated if a SPARTN message is
+ *                       found with nothing needing to be discarded
+ *                       before it.
+ * @return               #U_ERROR_COMMON_SUCCESS if a complete and
+ *                       valid SPARTN message has been found,
+ *                       #U_ERROR_COMMON_TIMEOUT if more data is
+ *                       needed to decide, else
+ *                       #U_ERROR_COMMON_NOT_FOUND.
+ */
+int32_t uSpartnParse(uParseHandle_t parseHandle, void *pUserParam);
+
 #ifdef __cplusplus
 }
 #endif
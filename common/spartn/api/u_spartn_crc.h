@@ -110,6 +110,30 @@ uint32_t uSpartnCrc24(const char *pData, size_t size);
  */
 uint32_t uSpartnCrc32(const char *pData, size_t size);
 
+/** Continue a CRC calculation, of the given type, over a further
+ * block of data; useful where the data to be checked is not
+ * contiguous, e.g. where it wraps around the end of a ring buffer.
+ * For instance:
+ *
+ * `uSpartnCrcContinue(U_SPARTN_CRC_TYPE_32, uSpartnCrc32(pA, sizeA), pB, sizeB)`
+ *
+ * ...will return the same value as uSpartnCrc32() would if it
+ * were called on the concatenation of the data at pA and pB.
+ *
+ * @param type   the CRC type; #U_SPARTN_CRC_TYPE_NONE or
+ *               #U_SPARTN_CRC_TYPE_MAX_NUM will result in crc
+ *               being returned unchanged.
+ * @param crc    the CRC of the preceding data, as returned by
+ *               uSpartnCrc4(), uSpartnCrc8(), uSpartnCrc16(),
+ *               uSpartnCrc24(), uSpartnCrc32() or by a previous
+ *               call to this function; use 0 to start afresh.
+ * @param pData  a pointer to the data to be checked.
+ * @param size   the number of bytes pointed to by pData.
+ * @return       the CRC.
+ */
+uint32_t uSpartnCrcContinue(uSpartnCrcType_t type, uint32_t crc,
+                            const char *pData, size_t size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -93,10 +93,12 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
-#include "string.h"    // memcpy()
+#include "string.h"    // memcpy(), memchr()
 
 #include "u_error_common.h"
 
+#include "u_ringbuffer.h"
+
 #include "u_spartn.h"
 #include "u_spartn_crc.h"
 
@@ -122,6 +124,131 @@
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Decode the SPARTN message header at pInput, which must point to
+// a SPARTN preamble, returning the length of the entire message
+// and the message CRC type, else U_ERROR_COMMON_TIMEOUT if there
+// is not enough data to tell, else U_ERROR_COMMON_NOT_FOUND.
+static int32_t decodeFrame(const uint8_t *pInput, size_t bufferLengthBytes,
+                           uSpartnCrcType_t *pMessageCrcType)
+{
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_TIMEOUT;
+    uint8_t frameBuffer[4];
+    size_t lengthHeader;
+    size_t lengthBeyondHeader;
+    size_t crcType;
+
+    if (bufferLengthBytes >= U_SPARTN_HEADER_LENGTH_MIN_BYTES) {
+        // Have enough data to work on the header; confirm that this
+        // is a FRAME START by doing a frame CRC check on it
+        // Copy everything from FRAME START except TF001 into a buffer
+        memcpy(&frameBuffer, pInput + 1, 3);
+        frameBuffer[3] = 0;
+
+        // frameBuffer now contains, in order of bit-arrival:
+        //
+        // bytes:    |      0     |     1     |      2      |     3     |
+        // contents: |<---T7---><-----L10------->E1-MCT2-FC4|           |
+        // meaning:  |M       L M |           |L    M L  M L|           |
+
+        // Remove the frame CRC that is in the lower four
+        // bits of byte 2, giving us 20 bits in the buffer with
+        // zero-fill elsewhere
+        frameBuffer[2] &= 0xf0;
+        // Compute the CRC-4 over 24 bits and check it against the frame CRC (TF006)
+        if (uSpartnCrc4((const char *) frameBuffer, 3) == (*(pInput + 3) & 0x0f)) {
+            lengthHeader = U_SPARTN_HEADER_LENGTH_MIN_BYTES;
+            // So far so good, now parse the PAYLOAD DESCRIPTION to work out
+            // how long it is; check if the TF008 (GNSS time tag type) bit is set
+            if (*(pInput + 4) & 0x08) {
+                // The GNSS time tag is 32 bits instead of 16, so account for that
+                lengthHeader += 2;
+            }
+            // Work out the length beyond the message header
+            // First the length of the payload from the 10-bit TF003 field,
+            // which is splattered across the three bytes of frameBuffer
+            lengthBeyondHeader = ((((size_t) frameBuffer[0]) & 0x01) << 9) +
+                                 (((size_t) frameBuffer[1]) << 1) +
+                                 ((((size_t) frameBuffer[2]) & 0x80) >> 7);
+            // Add the length of the message CRC by looking at
+            // the 2-bit message CRC type field (TF005).  Since we have
+            // 0: CRC-8, 1: CRC-16, 2: CRC-24, 3: CRC-32 it is easy
+            // to calculate
+            crcType = (frameBuffer[2] & 0x30) >> 4;
+            lengthBeyondHeader += crcType + 1;
+            if (pMessageCrcType != NULL) {
+                *pMessageCrcType = (uSpartnCrcType_t) crcType;
+            }
+            // Work out the additions as a consequence of encryption/authentication
+            // being switched on
+            if (frameBuffer[2] & 0x40) {
+                // TF004 is set, so we need the ENCRYPT/AUTH fields to work
+                // out the message length; see if they are in the buffer
+                if ((int32_t) bufferLengthBytes - (int32_t) lengthHeader >= 2) {
+                    // The ENCRYPT/AUTH fields are in the buffer
+                    lengthHeader += 2;
+                    // To work out how big the AUTHENTICATION field is we
+                    // need to check if the authentication indicator field
+                    // (TF014) in PAYLOAD DESCRIPTION is greater than 1.
+                    // This is in the final byte of the header so we
+                    // can use lengthHeader, which is now pointing
+                    // at the start of the payload, to index to it
+                    if (((*(pInput + lengthHeader - 1) & 0x38) >> 3) > 1) {
+                        // AUTHENTICATION is present, find out how
+                        // big it is from the 3-bit authentication
+                        // length (TF015) at the beginning of the same
+                        // byte
+                        switch (*(pInput + lengthHeader - 1) & 0x07) {
+                            case 0: // 64 bits
+                                lengthBeyondHeader += 64 / 8;
+                                break;
+                            case 1: // 96 bits
+                                lengthBeyondHeader += 96 / 8;
+                                break;
+                            case 2: // 128 bits
+                                lengthBeyondHeader += 128 / 8;
+                                break;
+                            case 3: // 256 bits
+                                lengthBeyondHeader += 256 / 8;
+                                break;
+                            case 4: // 512 bits
+                                lengthBeyondHeader += 512 / 8;
+                                break;
+                            default:
+                                // Error case: not a supported message
+                                sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+                                lengthHeader = 0;
+                                break;
+                        }
+                    }
+                } else {
+                    // Might be a message but we don't yet have enough
+                    // data to work out its length; set the length
+                    // of the header to zero to flag this
+                    lengthHeader = 0;
+                }
+            }
+            if (lengthHeader > 0) {
+                // We have a header length, so (a) there are no errors and (b)
+                // we have all the data we need to determine the message length,
+                // then we are done; otherwise sizeOrErrorCode is left at
+                // U_ERROR_COMMON_TIMEOUT (or U_ERROR_COMMON_NOT_FOUND if there
+                // was an error)
+                sizeOrErrorCode = (int32_t) (lengthHeader + lengthBeyondHeader);
+            }
+        } else {
+            // Not a SPARTN message
+            sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+        }
+    } else {
+        // Might be a SPARTN message but we don't yet have all of
+        // the header and hence can't work out the message
+        // length; leave sizeOrErrorCode at U_ERROR_COMMON_TIMEOUT
+        // so that the caller knows we need more data
+    }
+
+    return sizeOrErrorCode;
+}
+
 // Look for a SPARTN message header in a buffer and supply its position,
 // plus the message CRC position and type.
 static int32_t decodeHeader(const char *pBuffer, size_t bufferLengthBytes,
@@ -133,145 +260,79 @@ static int32_t decodeHeader(const char *pBuffer, size_t bufferLengthBytes,
     // Use a uint8_t pointer for maths, more certain of its behaviour than char
     const uint8_t *pInput = (const uint8_t *) pBuffer;
     const uint8_t *pMessage = NULL;
-    uint8_t frameBuffer[4];
-    size_t lengthHeader;
-    size_t lengthBeyondHeader;
-    size_t crcType;
+    uSpartnCrcType_t crcType = U_SPARTN_CRC_TYPE_NONE;
 
     if (pInput != NULL) {
         sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
-        while ((sizeOrErrorCode < 0) && (sizeOrErrorCode != (int32_t) U_ERROR_COMMON_TIMEOUT) &&
+        while ((sizeOrErrorCode == (int32_t) U_ERROR_COMMON_NOT_FOUND) &&
                (bufferLengthBytes > 0)) {
-            if (*pInput == 0x73) {
-                // Potentially a FRAME START
-                sizeOrErrorCode = (int32_t) U_ERROR_COMMON_TIMEOUT;
-                pMessage = pInput;
-                if (bufferLengthBytes >= U_SPARTN_HEADER_LENGTH_MIN_BYTES) {
-                    // Have enough data to work on the header; confirm that this
-                    // is a FRAME START by doing a frame CRC check on it
-                    // Copy everything from FRAME START except TF001 into a buffer
-                    memcpy(&frameBuffer, pInput + 1, 3);
-                    frameBuffer[3] = 0;
-
-                    // frameBuffer now contains, in order of bit-arrival:
-                    //
-                    // bytes:    |      0     |     1     |      2      |     3     |
-                    // contents: |<---T7---><-----L10------->E1-MCT2-FC4|           |
-                    // meaning:  |M       L M |           |L    M L  M L|           |
-
-                    // Remove the frame CRC that is in the lower four
-                    // bits of byte 2, giving us 20 bits in the buffer with
-                    // zero-fill elsewhere
-                    frameBuffer[2] &= 0xf0;
-                    // Compute the CRC-4 over 24 bits and check it against the frame CRC (TF006)
-                    if (uSpartnCrc4((const char *) frameBuffer, 3) == (*(pInput + 3) & 0x0f)) {
-                        lengthHeader = U_SPARTN_HEADER_LENGTH_MIN_BYTES;
-                        // So far so good, now parse the PAYLOAD DESCRIPTION to work out
-                        // how long it is; check if the TF008 (GNSS time tag type) bit is set
-                        if (*(pInput + 4) & 0x08) {
-                            // The GNSS time tag is 32 bits instead of 16, so account for that
-                            lengthHeader += 2;
-                        }
-                        // Work out the length beyond the message header
-                        // First the length of the payload from the 10-bit TF003 field,
-                        // which is splattered across the three bytes of frameBuffer
-                        lengthBeyondHeader = ((((size_t) frameBuffer[0]) & 0x01) << 9) +
-                                             (((size_t) frameBuffer[1]) << 1) +
-                                             ((((size_t) frameBuffer[2]) & 0x80) >> 7);
-                        // Add the length of the message CRC by looking at
-                        // the 2-bit message CRC type field (TF005).  Since we have
-                        // 0: CRC-8, 1: CRC-16, 2: CRC-24, 3: CRC-32 it is easy
-                        // to calculate
-                        crcType = (frameBuffer[2] & 0x30) >> 4;
-                        lengthBeyondHeader += crcType + 1;
-                        if (pMessageCrcType != NULL) {
-                            *pMessageCrcType = (uSpartnCrcType_t) crcType;
-                        }
-                        // Work out the additions as a consequence of encryption/authentication
-                        // being switched on
-                        if (frameBuffer[2] & 0x40) {
-                            // TF004 is set, so we need the ENCRYPT/AUTH fields to work
-                            // out the message length; see if they are in the buffer
-                            if ((int32_t) bufferLengthBytes - (int32_t) lengthHeader >= 2) {
-                                // The ENCRYPT/AUTH fields are in the buffer
-                                lengthHeader += 2;
-                                // To work out how big the AUTHENTICATION field is we
-                                // need to check if the authentication indicator field
-                                // (TF014) in PAYLOAD DESCRIPTION is greater than 1.
-                                // This is in the final byte of the header so we
-                                // can use lengthHeader, which is now pointing
-                                // at the start of the payload, to index to it
-                                if (((*(pInput + lengthHeader - 1) & 0x38) >> 3) > 1) {
-                                    // AUTHENTICATION is present, find out how
-                                    // big it is from the 3-bit authentication
-                                    // length (TF015) at the beginning of the same
-                                    // byte
-                                    switch (*(pInput + lengthHeader - 1) & 0x07) {
-                                        case 0: // 64 bits
-                                            lengthBeyondHeader += 64 / 8;
-                                            break;
-                                        case 1: // 96 bits
-                                            lengthBeyondHeader += 96 / 8;
-                                            break;
-                                        case 2: // 128 bits
-                                            lengthBeyondHeader += 128 / 8;
-                                            break;
-                                        case 3: // 256 bits
-                                            lengthBeyondHeader += 256 / 8;
-                                            break;
-                                        case 4: // 512 bits
-                                            lengthBeyondHeader += 512 / 8;
-                                            break;
-                                        default:
-                                            // Error case: not a supported message
-                                            sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
-                                            lengthHeader = 0;
-                                            break;
-                                    }
-                                }
-                            } else {
-                                // Might be a message but we don't yet have enough
-                                // data to work out its length; set the length
-                                // of the header to zero to flag this
-                                lengthHeader = 0;
-                            }
-                        }
-                        if (lengthHeader > 0) {
-                            // We have a header length, so (a) there are no errors and (b)
-                            // we have all the data we need to determine the message length,
-                            // then we are done; otherwise sizeOrErrorCode is left at
-                            // U_ERROR_COMMON_TIMEOUT (or U_ERROR_COMMON_NOT_FOUND if there
-                            // was an error)
-                            sizeOrErrorCode = (int32_t) (lengthHeader + lengthBeyondHeader);
-                            if (ppMessageCrcStart != NULL) {
-                                *ppMessageCrcStart = (const char *) pMessage + lengthHeader + lengthBeyondHeader - (crcType + 1);
-                            }
-                        }
-                    } else {
-                        // Not a SPARTN message
-                        sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
-                    }
-                } else {
-                    // Might be a SPARTN message but we don't yet have all of
-                    // the header and hence can't work out the message
-                    // length; leave sizeOrErrorCode at U_ERROR_COMMON_TIMEOUT
-                    // so that the caller knows we need more data
-                }
+            // Skip straight to the next potential FRAME START
+            pMessage = (const uint8_t *) memchr(pInput, U_SPARTN_PREAMBLE,
+                                                bufferLengthBytes);
+            if (pMessage == NULL) {
+                break;
             }
-
+            bufferLengthBytes -= pMessage - pInput;
+            sizeOrErrorCode = decodeFrame(pMessage, bufferLengthBytes, &crcType);
             // Move along
-            pInput++;
+            pInput = pMessage + 1;
             bufferLengthBytes--;
         }
     }
 
-    if ((sizeOrErrorCode >= 0) && (ppMessage != NULL)) {
-        *ppMessage = (const char *) pMessage;
+    if (sizeOrErrorCode >= 0) {
+        if (ppMessage != NULL) {
+            *ppMessage = (const char *) pMessage;
+        }
+        if (ppMessageCrcStart != NULL) {
+            *ppMessageCrcStart = (const char *) pMessage + sizeOrErrorCode - (crcType + 1);
+        }
+        if (pMessageCrcType != NULL) {
+            *pMessageCrcType = crcType;
+        }
     }
 
     return sizeOrErrorCode;
 }
 
+// Assemble the MSB-first message CRC of the given type at pCrc.
+static uint32_t messageCrcGet(const uint8_t *pCrc, uSpartnCrcType_t crcType)
+{
+    uint32_t crc = 0;
+
+    for (size_t x = 0; x < (size_t) crcType + 1; x++) {
+        crc = (crc << 8) + *(pCrc + x);
+    }
+
+    return crc;
+}
+
+// Copy up to length bytes, starting offset bytes into the given
+// ring buffer spans, to pBuffer; returns the number of bytes copied.
+static size_t spanCopy(const uRingBufferSpan_t *pSpan, size_t numSpans,
+                       size_t offset, uint8_t *pBuffer, size_t length)
+{
+    size_t copied = 0;
+    size_t y;
+
+    for (size_t x = 0; (x < numSpans) && (length > 0); x++, pSpan++) {
+        if (offset >= pSpan->length) {
+            offset -= pSpan->length;
+        } else {
+            y = pSpan->length - offset;
+            if (y > length) {
+                y = length;
+            }
+            memcpy(pBuffer + copied, pSpan->pData + offset, y);
+            copied += y;
+            length -= y;
+            offset = 0;
+        }
+    }
+
+    return copied;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -293,7 +354,6 @@ int32_t uSpartnValidate(const char *pBuffer, size_t bufferLengthBytes,
     const uint8_t *pMessageCrcStart = NULL;
     uSpartnCrcType_t messageCrcType = U_SPARTN_CRC_TYPE_NONE;
     size_t crcLength;
-    uint32_t crcFromMessage;
 
     messageLength = decodeHeader(pBuffer, bufferLengthBytes, &pMessage,
                                  (const char **) &pMessageCrcStart, &messageCrcType);
@@ -308,39 +368,10 @@ int32_t uSpartnValidate(const char *pBuffer, size_t bufferLengthBytes,
             // the first byte, up to the start of the CRC and the
             // CRC value is MSB first like all the others
             crcLength = ((const char *) pMessageCrcStart) - pMessage - 1;
-            switch (messageCrcType) {
-                case U_SPARTN_CRC_TYPE_8:
-                    crcFromMessage = *pMessageCrcStart;
-                    if (uSpartnCrc8(pMessage + 1, crcLength) == crcFromMessage) {
-                        sizeOrErrorCode = messageLength;
-                    }
-                    break;
-                case U_SPARTN_CRC_TYPE_16:
-                    crcFromMessage = (((uint32_t) * pMessageCrcStart) << 8) +
-                                     (uint32_t) * (pMessageCrcStart + 1);
-                    if (uSpartnCrc16(pMessage + 1, crcLength) == crcFromMessage) {
-                        sizeOrErrorCode = messageLength;
-                    }
-                    break;
-                case U_SPARTN_CRC_TYPE_24:
-                    crcFromMessage = (((uint32_t) * pMessageCrcStart) << 16) +
-                                     ((uint32_t) * (pMessageCrcStart + 1) << 8) +
-                                     (uint32_t) * (pMessageCrcStart + 2);
-                    if (uSpartnCrc24(pMessage + 1, crcLength) == crcFromMessage) {
-                        sizeOrErrorCode = messageLength;
-                    }
-                    break;
-                case U_SPARTN_CRC_TYPE_32:
-                    crcFromMessage = (((uint32_t) * pMessageCrcStart) << 24) +
-                                     ((uint32_t) * (pMessageCrcStart + 1) << 16) +
-                                     ((uint32_t) * (pMessageCrcStart + 2) << 8) +
-                                     (uint32_t) * (pMessageCrcStart + 3);
-                    if (uSpartnCrc32(pMessage + 1, crcLength) == crcFromMessage) {
-                        sizeOrErrorCode = messageLength;
-                    }
-                    break;
-                default:
-                    break;
+            if ((messageCrcType < U_SPARTN_CRC_TYPE_MAX_NUM) &&
+                (uSpartnCrcContinue(messageCrcType, 0, pMessage + 1, crcLength) ==
+                 messageCrcGet(pMessageCrcStart, messageCrcType))) {
+                sizeOrErrorCode = messageLength;
             }
         }
     }
@@ -352,4 +383,62 @@ int32_t uSpartnValidate(const char *pBuffer, size_t bufferLengthBytes,
     return sizeOrErrorCode;
 }
 
+// Ring-buffer parser for SPARTN messages.
+int32_t uSpartnParse(uParseHandle_t parseHandle, void *pUserParam)
+{
+    int32_t messageLength;
+    uint8_t header[U_SPARTN_HEADER_LENGTH_MAX_BYTES];
+    uint8_t crc[4];
+    uSpartnCrcType_t messageCrcType = U_SPARTN_CRC_TYPE_NONE;
+    uRingBufferSpan_t span[2];
+    size_t numSpans;
+    size_t length;
+    size_t crcLength;
+    uint32_t calculated = 0;
+    uSpartnMessageId_t *pMessageId = (uSpartnMessageId_t *) pUserParam;
+
+    if (!uRingBufferGetByteUnprotected(parseHandle, &(header[0]))) {
+        return U_ERROR_COMMON_TIMEOUT;
+    }
+    if (header[0] != U_SPARTN_PREAMBLE) {
+        return U_ERROR_COMMON_NOT_FOUND;
+    }
+    // Work directly on the data that follows the preamble, a
+    // contiguous span at a time, rather than a byte at a time
+    numSpans = uRingBufferGetSpansUnprotected(parseHandle, span);
+    length = spanCopy(span, numSpans, 0, &(header[1]), sizeof(header) - 1) + 1;
+    messageLength = decodeFrame(header, length, &messageCrcType);
+    if (messageLength < 0) {
+        return messageLength;
+    }
+    if ((size_t) messageLength - 1 > uRingBufferBytesAvailableUnprotected(parseHandle)) {
+        return U_ERROR_COMMON_TIMEOUT;
+    }
+    // The message CRC is over everything after the preamble, up to
+    // the CRC itself, which is MSB first
+    crcLength = (size_t) messageLength - 1 - ((size_t) messageCrcType + 1);
+    length = crcLength;
+    for (size_t x = 0; (x < numSpans) && (length > 0); x++) {
+        size_t y = span[x].length;
+        if (y > length) {
+            y = length;
+        }
+        calculated = uSpartnCrcContinue(messageCrcType, calculated, span[x].pData, y);
+        length -= y;
+    }
+    spanCopy(span, numSpans, crcLength, crc, (size_t) messageCrcType + 1);
+    if (calculated != messageCrcGet(crc, messageCrcType)) {
+        return U_ERROR_COMMON_NOT_FOUND;
+    }
+    uRingBufferSkipUnprotected(parseHandle, (size_t) messageLength - 1);
+    // We can only claim this as a SPARTN message if
+    // there was nothing that needed discarding first
+    if ((pMessageId != NULL) && (uRingBufferBytesDiscardUnprotected(parseHandle) == 0)) {
+        pMessageId->type = header[1] >> 1;
+        pMessageId->subType = header[4] >> 4;
+    }
+
+    return U_ERROR_COMMON_SUCCESS;
+}
+
 // End of file
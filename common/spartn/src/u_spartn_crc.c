@@ -39,6 +39,12 @@
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+// CRC-16, CRC-24 and CRC-32 are computed one byte at a time unless
+// U_SPARTN_CRC_SLICE_BY_8 is defined, in which case they are computed
+// eight bytes at a time using slice-by-8 tables; that is several
+// times faster on long messages but the tables cost 20 kbytes of
+// flash.
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -222,104 +228,1031 @@ static const uint32_t u32Crc32Table[] = {
     0xAFB010B1U, 0xAB710D06U, 0xA6322BDFU, 0xA2F33668U, 0xBCB4666DU, 0xB8757BDAU, 0xB5365D03U, 0xB1F740B4U
 };
 
+#ifdef U_SPARTN_CRC_SLICE_BY_8
+
+// Slice-by-8 tables for CRC-16, CRC-24 and CRC-32: entry [k][b] is
+// the CRC of byte b followed by k zero bytes.  All of the CRCs are
+// MSB-first; CRC-24 is held left-aligned in a uint32_t, i.e. with
+// the CRC in the most significant bits, so that the same slicing
+// code serves both it and CRC-32, while CRC-16 has tables of its
+// own to keep them half the size.
+static const uint16_t u16Crc16SliceTable[8][256] = {
+    {
+        0x0000U, 0x1021U, 0x2042U, 0x3063U, 0x4084U, 0x50A5U, 0x60C6U, 0x70E7U,
+        0x8108U, 0x9129U, 0xA14AU, 0xB16BU, 0xC18CU, 0xD1ADU, 0xE1CEU, 0xF1EFU,
+        0x1231U, 0x0210U, 0x3273U, 0x2252U, 0x52B5U, 0x4294U, 0x72F7U, 0x62D6U,
+        0x9339U, 0x8318U, 0xB37BU, 0xA35AU, 0xD3BDU, 0xC39CU, 0xF3FFU, 0xE3DEU,
+        0x2462U, 0x3443U, 0x0420U, 0x1401U, 0x64E6U, 0x74C7U, 0x44A4U, 0x5485U,
+        0xA56AU, 0xB54BU, 0x8528U, 0x9509U, 0xE5EEU, 0xF5CFU, 0xC5ACU, 0xD58DU,
+        0x3653U, 0x2672U, 0x1611U, 0x0630U, 0x76D7U, 0x66F6U, 0x5695U, 0x46B4U,
+        0xB75BU, 0xA77AU, 0x9719U, 0x8738U, 0xF7DFU, 0xE7FEU, 0xD79DU, 0xC7BCU,
+        0x48C4U, 0x58E5U, 0x6886U, 0x78A7U, 0x0840U, 0x1861U, 0x2802U, 0x3823U,
+        0xC9CCU, 0xD9EDU, 0xE98EU, 0xF9AFU, 0x8948U, 0x9969U, 0xA90AU, 0xB92BU,
+        0x5AF5U, 0x4AD4U, 0x7AB7U, 0x6A96U, 0x1A71U, 0x0A50U, 0x3A33U, 0x2A12U,
+        0xDBFDU, 0xCBDCU, 0xFBBFU, 0xEB9EU, 0x9B79U, 0x8B58U, 0xBB3BU, 0xAB1AU,
+        0x6CA6U, 0x7C87U, 0x4CE4U, 0x5CC5U, 0x2C22U, 0x3C03U, 0x0C60U, 0x1C41U,
+        0xEDAEU, 0xFD8FU, 0xCDECU, 0xDDCDU, 0xAD2AU, 0xBD0BU, 0x8D68U, 0x9D49U,
+        0x7E97U, 0x6EB6U, 0x5ED5U, 0x4EF4U, 0x3E13U, 0x2E32U, 0x1E51U, 0x0E70U,
+        0xFF9FU, 0xEFBEU, 0xDFDDU, 0xCFFCU, 0xBF1BU, 0xAF3AU, 0x9F59U, 0x8F78U,
+        0x9188U, 0x81A9U, 0xB1CAU, 0xA1EBU, 0xD10CU, 0xC12DU, 0xF14EU, 0xE16FU,
+        0x1080U, 0x00A1U, 0x30C2U, 0x20E3U, 0x5004U, 0x4025U, 0x7046U, 0x6067U,
+        0x83B9U, 0x9398U, 0xA3FBU, 0xB3DAU, 0xC33DU, 0xD31CU, 0xE37FU, 0xF35EU,
+        0x02B1U, 0x1290U, 0x22F3U, 0x32D2U, 0x4235U, 0x5214U, 0x6277U, 0x7256U,
+        0xB5EAU, 0xA5CBU, 0x95A8U, 0x8589U, 0xF56EU, 0xE54FU, 0xD52CU, 0xC50DU,
+        0x34E2U, 0x24C3U, 0x14A0U, 0x0481U, 0x7466U, 0x6447U, 0x5424U, 0x4405U,
+        0xA7DBU, 0xB7FAU, 0x8799U, 0x97B8U, 0xE75FU, 0xF77EU, 0xC71DU, 0xD73CU,
+        0x26D3U, 0x36F2U, 0x0691U, 0x16B0U, 0x6657U, 0x7676U, 0x4615U, 0x5634U,
+        0xD94CU, 0xC96DU, 0xF90EU, 0xE92FU, 0x99C8U, 0x89E9U, 0xB98AU, 0xA9ABU,
+        0x5844U, 0x4865U, 0x7806U, 0x6827U, 0x18C0U, 0x08E1U, 0x3882U, 0x28A3U,
+        0xCB7DU, 0xDB5CU, 0xEB3FU, 0xFB1EU, 0x8BF9U, 0x9BD8U, 0xABBBU, 0xBB9AU,
+        0x4A75U, 0x5A54U, 0x6A37U, 0x7A16U, 0x0AF1U, 0x1AD0U, 0x2AB3U, 0x3A92U,
+        0xFD2EU, 0xED0FU, 0xDD6CU, 0xCD4DU, 0xBDAAU, 0xAD8BU, 0x9DE8U, 0x8DC9U,
+        0x7C26U, 0x6C07U, 0x5C64U, 0x4C45U, 0x3CA2U, 0x2C83U, 0x1CE0U, 0x0CC1U,
+        0xEF1FU, 0xFF3EU, 0xCF5DU, 0xDF7CU, 0xAF9BU, 0xBFBAU, 0x8FD9U, 0x9FF8U,
+        0x6E17U, 0x7E36U, 0x4E55U, 0x5E74U, 0x2E93U, 0x3EB2U, 0x0ED1U, 0x1EF0U
+    },
+    {
+        0x0000U, 0x3331U, 0x6662U, 0x5553U, 0xCCC4U, 0xFFF5U, 0xAAA6U, 0x9997U,
+        0x89A9U, 0xBA98U, 0xEFCBU, 0xDCFAU, 0x456DU, 0x765CU, 0x230FU, 0x103EU,
+        0x0373U, 0x3042U, 0x6511U, 0x5620U, 0xCFB7U, 0xFC86U, 0xA9D5U, 0x9AE4U,
+        0x8ADAU, 0xB9EBU, 0xECB8U, 0xDF89U, 0x461EU, 0x752FU, 0x207CU, 0x134DU,
+        0x06E6U, 0x35D7U, 0x6084U, 0x53B5U, 0xCA22U, 0xF913U, 0xAC40U, 0x9F71U,
+        0x8F4FU, 0xBC7EU, 0xE92DU, 0xDA1CU, 0x438BU, 0x70BAU, 0x25E9U, 0x16D8U,
+        0x0595U, 0x36A4U, 0x63F7U, 0x50C6U, 0xC951U, 0xFA60U, 0xAF33U, 0x9C02U,
+        0x8C3CU, 0xBF0DU, 0xEA5EU, 0xD96FU, 0x40F8U, 0x73C9U, 0x269AU, 0x15ABU,
+        0x0DCCU, 0x3EFDU, 0x6BAEU, 0x589FU, 0xC108U, 0xF239U, 0xA76AU, 0x945BU,
+        0x8465U, 0xB754U, 0xE207U, 0xD136U, 0x48A1U, 0x7B90U, 0x2EC3U, 0x1DF2U,
+        0x0EBFU, 0x3D8EU, 0x68DDU, 0x5BECU, 0xC27BU, 0xF14AU, 0xA419U, 0x9728U,
+        0x8716U, 0xB427U, 0xE174U, 0xD245U, 0x4BD2U, 0x78E3U, 0x2DB0U, 0x1E81U,
+        0x0B2AU, 0x381BU, 0x6D48U, 0x5E79U, 0xC7EEU, 0xF4DFU, 0xA18CU, 0x92BDU,
+        0x8283U, 0xB1B2U, 0xE4E1U, 0xD7D0U, 0x4E47U, 0x7D76U, 0x2825U, 0x1B14U,
+        0x0859U, 0x3B68U, 0x6E3BU, 0x5D0AU, 0xC49DU, 0xF7ACU, 0xA2FFU, 0x91CEU,
+        0x81F0U, 0xB2C1U, 0xE792U, 0xD4A3U, 0x4D34U, 0x7E05U, 0x2B56U, 0x1867U,
+        0x1B98U, 0x28A9U, 0x7DFAU, 0x4ECBU, 0xD75CU, 0xE46DU, 0xB13EU, 0x820FU,
+        0x9231U, 0xA100U, 0xF453U, 0xC762U, 0x5EF5U, 0x6DC4U, 0x3897U, 0x0BA6U,
+        0x18EBU, 0x2BDAU, 0x7E89U, 0x4DB8U, 0xD42FU, 0xE71EU, 0xB24DU, 0x817CU,
+        0x9142U, 0xA273U, 0xF720U, 0xC411U, 0x5D86U, 0x6EB7U, 0x3BE4U, 0x08D5U,
+        0x1D7EU, 0x2E4FU, 0x7B1CU, 0x482DU, 0xD1BAU, 0xE28BU, 0xB7D8U, 0x84E9U,
+        0x94D7U, 0xA7E6U, 0xF2B5U, 0xC184U, 0x5813U, 0x6B22U, 0x3E71U, 0x0D40U,
+        0x1E0DU, 0x2D3CU, 0x786FU, 0x4B5EU, 0xD2C9U, 0xE1F8U, 0xB4ABU, 0x879AU,
+        0x97A4U, 0xA495U, 0xF1C6U, 0xC2F7U, 0x5B60U, 0x6851U, 0x3D02U, 0x0E33U,
+        0x1654U, 0x2565U, 0x7036U, 0x4307U, 0xDA90U, 0xE9A1U, 0xBCF2U, 0x8FC3U,
+        0x9FFDU, 0xACCCU, 0xF99FU, 0xCAAEU, 0x5339U, 0x6008U, 0x355BU, 0x066AU,
+        0x1527U, 0x2616U, 0x7345U, 0x4074U, 0xD9E3U, 0xEAD2U, 0xBF81U, 0x8CB0U,
+        0x9C8EU, 0xAFBFU, 0xFAECU, 0xC9DDU, 0x504AU, 0x637BU, 0x3628U, 0x0519U,
+        0x10B2U, 0x2383U, 0x76D0U, 0x45E1U, 0xDC76U, 0xEF47U, 0xBA14U, 0x8925U,
+        0x991BU, 0xAA2AU, 0xFF79U, 0xCC48U, 0x55DFU, 0x66EEU, 0x33BDU, 0x008CU,
+        0x13C1U, 0x20F0U, 0x75A3U, 0x4692U, 0xDF05U, 0xEC34U, 0xB967U, 0x8A56U,
+        0x9A68U, 0xA959U, 0xFC0AU, 0xCF3BU, 0x56ACU, 0x659DU, 0x30CEU, 0x03FFU
+    },
+    {
+        0x0000U, 0x3730U, 0x6E60U, 0x5950U, 0xDCC0U, 0xEBF0U, 0xB2A0U, 0x8590U,
+        0xA9A1U, 0x9E91U, 0xC7C1U, 0xF0F1U, 0x7561U, 0x4251U, 0x1B01U, 0x2C31U,
+        0x4363U, 0x7453U, 0x2D03U, 0x1A33U, 0x9FA3U, 0xA893U, 0xF1C3U, 0xC6F3U,
+        0xEAC2U, 0xDDF2U, 0x84A2U, 0xB392U, 0x3602U, 0x0132U, 0x5862U, 0x6F52U,
+        0x86C6U, 0xB1F6U, 0xE8A6U, 0xDF96U, 0x5A06U, 0x6D36U, 0x3466U, 0x0356U,
+        0x2F67U, 0x1857U, 0x4107U, 0x7637U, 0xF3A7U, 0xC497U, 0x9DC7U, 0xAAF7U,
+        0xC5A5U, 0xF295U, 0xABC5U, 0x9CF5U, 0x1965U, 0x2E55U, 0x7705U, 0x4035U,
+        0x6C04U, 0x5B34U, 0x0264U, 0x3554U, 0xB0C4U, 0x87F4U, 0xDEA4U, 0xE994U,
+        0x1DADU, 0x2A9DU, 0x73CDU, 0x44FDU, 0xC16DU, 0xF65DU, 0xAF0DU, 0x983DU,
+        0xB40CU, 0x833CU, 0xDA6CU, 0xED5CU, 0x68CCU, 0x5FFCU, 0x06ACU, 0x319CU,
+        0x5ECEU, 0x69FEU, 0x30AEU, 0x079EU, 0x820EU, 0xB53EU, 0xEC6EU, 0xDB5EU,
+        0xF76FU, 0xC05FU, 0x990FU, 0xAE3FU, 0x2BAFU, 0x1C9FU, 0x45CFU, 0x72FFU,
+        0x9B6BU, 0xAC5BU, 0xF50BU, 0xC23BU, 0x47ABU, 0x709BU, 0x29CBU, 0x1EFBU,
+        0x32CAU, 0x05FAU, 0x5CAAU, 0x6B9AU, 0xEE0AU, 0xD93AU, 0x806AU, 0xB75AU,
+        0xD808U, 0xEF38U, 0xB668U, 0x8158U, 0x04C8U, 0x33F8U, 0x6AA8U, 0x5D98U,
+        0x71A9U, 0x4699U, 0x1FC9U, 0x28F9U, 0xAD69U, 0x9A59U, 0xC309U, 0xF439U,
+        0x3B5AU, 0x0C6AU, 0x553AU, 0x620AU, 0xE79AU, 0xD0AAU, 0x89FAU, 0xBECAU,
+        0x92FBU, 0xA5CBU, 0xFC9BU, 0xCBABU, 0x4E3BU, 0x790BU, 0x205BU, 0x176BU,
+        0x7839U, 0x4F09U, 0x1659U, 0x2169U, 0xA4F9U, 0x93C9U, 0xCA99U, 0xFDA9U,
+        0xD198U, 0xE6A8U, 0xBFF8U, 0x88C8U, 0x0D58U, 0x3A68U, 0x6338U, 0x5408U,
+        0xBD9CU, 0x8AACU, 0xD3FCU, 0xE4CCU, 0x615CU, 0x566CU, 0x0F3CU, 0x380CU,
+        0x143DU, 0x230DU, 0x7A5DU, 0x4D6DU, 0xC8FDU, 0xFFCDU, 0xA69DU, 0x91ADU,
+        0xFEFFU, 0xC9CFU, 0x909FU, 0xA7AFU, 0x223FU, 0x150FU, 0x4C5FU, 0x7B6FU,
+        0x575EU, 0x606EU, 0x393EU, 0x0E0EU, 0x8B9EU, 0xBCAEU, 0xE5FEU, 0xD2CEU,
+        0x26F7U, 0x11C7U, 0x4897U, 0x7FA7U, 0xFA37U, 0xCD07U, 0x9457U, 0xA367U,
+        0x8F56U, 0xB866U, 0xE136U, 0xD606U, 0x5396U, 0x64A6U, 0x3DF6U, 0x0AC6U,
+        0x6594U, 0x52A4U, 0x0BF4U, 0x3CC4U, 0xB954U, 0x8E64U, 0xD734U, 0xE004U,
+        0xCC35U, 0xFB05U, 0xA255U, 0x9565U, 0x10F5U, 0x27C5U, 0x7E95U, 0x49A5U,
+        0xA031U, 0x9701U, 0xCE51U, 0xF961U, 0x7CF1U, 0x4BC1U, 0x1291U, 0x25A1U,
+        0x0990U, 0x3EA0U, 0x67F0U, 0x50C0U, 0xD550U, 0xE260U, 0xBB30U, 0x8C00U,
+        0xE352U, 0xD462U, 0x8D32U, 0xBA02U, 0x3F92U, 0x08A2U, 0x51F2U, 0x66C2U,
+        0x4AF3U, 0x7DC3U, 0x2493U, 0x13A3U, 0x9633U, 0xA103U, 0xF853U, 0xCF63U
+    },
+    {
+        0x0000U, 0x76B4U, 0xED68U, 0x9BDCU, 0xCAF1U, 0xBC45U, 0x2799U, 0x512DU,
+        0x85C3U, 0xF377U, 0x68ABU, 0x1E1FU, 0x4F32U, 0x3986U, 0xA25AU, 0xD4EEU,
+        0x1BA7U, 0x6D13U, 0xF6CFU, 0x807BU, 0xD156U, 0xA7E2U, 0x3C3EU, 0x4A8AU,
+        0x9E64U, 0xE8D0U, 0x730CU, 0x05B8U, 0x5495U, 0x2221U, 0xB9FDU, 0xCF49U,
+        0x374EU, 0x41FAU, 0xDA26U, 0xAC92U, 0xFDBFU, 0x8B0BU, 0x10D7U, 0x6663U,
+        0xB28DU, 0xC439U, 0x5FE5U, 0x2951U, 0x787CU, 0x0EC8U, 0x9514U, 0xE3A0U,
+        0x2CE9U, 0x5A5DU, 0xC181U, 0xB735U, 0xE618U, 0x90ACU, 0x0B70U, 0x7DC4U,
+        0xA92AU, 0xDF9EU, 0x4442U, 0x32F6U, 0x63DBU, 0x156FU, 0x8EB3U, 0xF807U,
+        0x6E9CU, 0x1828U, 0x83F4U, 0xF540U, 0xA46DU, 0xD2D9U, 0x4905U, 0x3FB1U,
+        0xEB5FU, 0x9DEBU, 0x0637U, 0x7083U, 0x21AEU, 0x571AU, 0xCCC6U, 0xBA72U,
+        0x753BU, 0x038FU, 0x9853U, 0xEEE7U, 0xBFCAU, 0xC97EU, 0x52A2U, 0x2416U,
+        0xF0F8U, 0x864CU, 0x1D90U, 0x6B24U, 0x3A09U, 0x4CBDU, 0xD761U, 0xA1D5U,
+        0x59D2U, 0x2F66U, 0xB4BAU, 0xC20EU, 0x9323U, 0xE597U, 0x7E4BU, 0x08FFU,
+        0xDC11U, 0xAAA5U, 0x3179U, 0x47CDU, 0x16E0U, 0x6054U, 0xFB88U, 0x8D3CU,
+        0x4275U, 0x34C1U, 0xAF1DU, 0xD9A9U, 0x8884U, 0xFE30U, 0x65ECU, 0x1358U,
+        0xC7B6U, 0xB102U, 0x2ADEU, 0x5C6AU, 0x0D47U, 0x7BF3U, 0xE02FU, 0x969BU,
+        0xDD38U, 0xAB8CU, 0x3050U, 0x46E4U, 0x17C9U, 0x617DU, 0xFAA1U, 0x8C15U,
+        0x58FBU, 0x2E4FU, 0xB593U, 0xC327U, 0x920AU, 0xE4BEU, 0x7F62U, 0x09D6U,
+        0xC69FU, 0xB02BU, 0x2BF7U, 0x5D43U, 0x0C6EU, 0x7ADAU, 0xE106U, 0x97B2U,
+        0x435CU, 0x35E8U, 0xAE34U, 0xD880U, 0x89ADU, 0xFF19U, 0x64C5U, 0x1271U,
+        0xEA76U, 0x9CC2U, 0x071EU, 0x71AAU, 0x2087U, 0x5633U, 0xCDEFU, 0xBB5BU,
+        0x6FB5U, 0x1901U, 0x82DDU, 0xF469U, 0xA544U, 0xD3F0U, 0x482CU, 0x3E98U,
+        0xF1D1U, 0x8765U, 0x1CB9U, 0x6A0DU, 0x3B20U, 0x4D94U, 0xD648U, 0xA0FCU,
+        0x7412U, 0x02A6U, 0x997AU, 0xEFCEU, 0xBEE3U, 0xC857U, 0x538BU, 0x253FU,
+        0xB3A4U, 0xC510U, 0x5ECCU, 0x2878U, 0x7955U, 0x0FE1U, 0x943DU, 0xE289U,
+        0x3667U, 0x40D3U, 0xDB0FU, 0xADBBU, 0xFC96U, 0x8A22U, 0x11FEU, 0x674AU,
+        0xA803U, 0xDEB7U, 0x456BU, 0x33DFU, 0x62F2U, 0x1446U, 0x8F9AU, 0xF92EU,
+        0x2DC0U, 0x5B74U, 0xC0A8U, 0xB61CU, 0xE731U, 0x9185U, 0x0A59U, 0x7CEDU,
+        0x84EAU, 0xF25EU, 0x6982U, 0x1F36U, 0x4E1BU, 0x38AFU, 0xA373U, 0xD5C7U,
+        0x0129U, 0x779DU, 0xEC41U, 0x9AF5U, 0xCBD8U, 0xBD6CU, 0x26B0U, 0x5004U,
+        0x9F4DU, 0xE9F9U, 0x7225U, 0x0491U, 0x55BCU, 0x2308U, 0xB8D4U, 0xCE60U,
+        0x1A8EU, 0x6C3AU, 0xF7E6U, 0x8152U, 0xD07FU, 0xA6CBU, 0x3D17U, 0x4BA3U
+    },
+    {
+        0x0000U, 0xAA51U, 0x4483U, 0xEED2U, 0x8906U, 0x2357U, 0xCD85U, 0x67D4U,
+        0x022DU, 0xA87CU, 0x46AEU, 0xECFFU, 0x8B2BU, 0x217AU, 0xCFA8U, 0x65F9U,
+        0x045AU, 0xAE0BU, 0x40D9U, 0xEA88U, 0x8D5CU, 0x270DU, 0xC9DFU, 0x638EU,
+        0x0677U, 0xAC26U, 0x42F4U, 0xE8A5U, 0x8F71U, 0x2520U, 0xCBF2U, 0x61A3U,
+        0x08B4U, 0xA2E5U, 0x4C37U, 0xE666U, 0x81B2U, 0x2BE3U, 0xC531U, 0x6F60U,
+        0x0A99U, 0xA0C8U, 0x4E1AU, 0xE44BU, 0x839FU, 0x29CEU, 0xC71CU, 0x6D4DU,
+        0x0CEEU, 0xA6BFU, 0x486DU, 0xE23CU, 0x85E8U, 0x2FB9U, 0xC16BU, 0x6B3AU,
+        0x0EC3U, 0xA492U, 0x4A40U, 0xE011U, 0x87C5U, 0x2D94U, 0xC346U, 0x6917U,
+        0x1168U, 0xBB39U, 0x55EBU, 0xFFBAU, 0x986EU, 0x323FU, 0xDCEDU, 0x76BCU,
+        0x1345U, 0xB914U, 0x57C6U, 0xFD97U, 0x9A43U, 0x3012U, 0xDEC0U, 0x7491U,
+        0x1532U, 0xBF63U, 0x51B1U, 0xFBE0U, 0x9C34U, 0x3665U, 0xD8B7U, 0x72E6U,
+        0x171FU, 0xBD4EU, 0x539CU, 0xF9CDU, 0x9E19U, 0x3448U, 0xDA9AU, 0x70CBU,
+        0x19DCU, 0xB38DU, 0x5D5FU, 0xF70EU, 0x90DAU, 0x3A8BU, 0xD459U, 0x7E08U,
+        0x1BF1U, 0xB1A0U, 0x5F72U, 0xF523U, 0x92F7U, 0x38A6U, 0xD674U, 0x7C25U,
+        0x1D86U, 0xB7D7U, 0x5905U, 0xF354U, 0x9480U, 0x3ED1U, 0xD003U, 0x7A52U,
+        0x1FABU, 0xB5FAU, 0x5B28U, 0xF179U, 0x96ADU, 0x3CFCU, 0xD22EU, 0x787FU,
+        0x22D0U, 0x8881U, 0x6653U, 0xCC02U, 0xABD6U, 0x0187U, 0xEF55U, 0x4504U,
+        0x20FDU, 0x8AACU, 0x647EU, 0xCE2FU, 0xA9FBU, 0x03AAU, 0xED78U, 0x4729U,
+        0x268AU, 0x8CDBU, 0x6209U, 0xC858U, 0xAF8CU, 0x05DDU, 0xEB0FU, 0x415EU,
+        0x24A7U, 0x8EF6U, 0x6024U, 0xCA75U, 0xADA1U, 0x07F0U, 0xE922U, 0x4373U,
+        0x2A64U, 0x8035U, 0x6EE7U, 0xC4B6U, 0xA362U, 0x0933U, 0xE7E1U, 0x4DB0U,
+        0x2849U, 0x8218U, 0x6CCAU, 0xC69BU, 0xA14FU, 0x0B1EU, 0xE5CCU, 0x4F9DU,
+        0x2E3EU, 0x846FU, 0x6ABDU, 0xC0ECU, 0xA738U, 0x0D69U, 0xE3BBU, 0x49EAU,
+        0x2C13U, 0x8642U, 0x6890U, 0xC2C1U, 0xA515U, 0x0F44U, 0xE196U, 0x4BC7U,
+        0x33B8U, 0x99E9U, 0x773BU, 0xDD6AU, 0xBABEU, 0x10EFU, 0xFE3DU, 0x546CU,
+        0x3195U, 0x9BC4U, 0x7516U, 0xDF47U, 0xB893U, 0x12C2U, 0xFC10U, 0x5641U,
+        0x37E2U, 0x9DB3U, 0x7361U, 0xD930U, 0xBEE4U, 0x14B5U, 0xFA67U, 0x5036U,
+        0x35CFU, 0x9F9EU, 0x714CU, 0xDB1DU, 0xBCC9U, 0x1698U, 0xF84AU, 0x521BU,
+        0x3B0CU, 0x915DU, 0x7F8FU, 0xD5DEU, 0xB20AU, 0x185BU, 0xF689U, 0x5CD8U,
+        0x3921U, 0x9370U, 0x7DA2U, 0xD7F3U, 0xB027U, 0x1A76U, 0xF4A4U, 0x5EF5U,
+        0x3F56U, 0x9507U, 0x7BD5U, 0xD184U, 0xB650U, 0x1C01U, 0xF2D3U, 0x5882U,
+        0x3D7BU, 0x972AU, 0x79F8U, 0xD3A9U, 0xB47DU, 0x1E2CU, 0xF0FEU, 0x5AAFU
+    },
+    {
+        0x0000U, 0x45A0U, 0x8B40U, 0xCEE0U, 0x06A1U, 0x4301U, 0x8DE1U, 0xC841U,
+        0x0D42U, 0x48E2U, 0x8602U, 0xC3A2U, 0x0BE3U, 0x4E43U, 0x80A3U, 0xC503U,
+        0x1A84U, 0x5F24U, 0x91C4U, 0xD464U, 0x1C25U, 0x5985U, 0x9765U, 0xD2C5U,
+        0x17C6U, 0x5266U, 0x9C86U, 0xD926U, 0x1167U, 0x54C7U, 0x9A27U, 0xDF87U,
+        0x3508U, 0x70A8U, 0xBE48U, 0xFBE8U, 0x33A9U, 0x7609U, 0xB8E9U, 0xFD49U,
+        0x384AU, 0x7DEAU, 0xB30AU, 0xF6AAU, 0x3EEBU, 0x7B4BU, 0xB5ABU, 0xF00BU,
+        0x2F8CU, 0x6A2CU, 0xA4CCU, 0xE16CU, 0x292DU, 0x6C8DU, 0xA26DU, 0xE7CDU,
+        0x22CEU, 0x676EU, 0xA98EU, 0xEC2EU, 0x246FU, 0x61CFU, 0xAF2FU, 0xEA8FU,
+        0x6A10U, 0x2FB0U, 0xE150U, 0xA4F0U, 0x6CB1U, 0x2911U, 0xE7F1U, 0xA251U,
+        0x6752U, 0x22F2U, 0xEC12U, 0xA9B2U, 0x61F3U, 0x2453U, 0xEAB3U, 0xAF13U,
+        0x7094U, 0x3534U, 0xFBD4U, 0xBE74U, 0x7635U, 0x3395U, 0xFD75U, 0xB8D5U,
+        0x7DD6U, 0x3876U, 0xF696U, 0xB336U, 0x7B77U, 0x3ED7U, 0xF037U, 0xB597U,
+        0x5F18U, 0x1AB8U, 0xD458U, 0x91F8U, 0x59B9U, 0x1C19U, 0xD2F9U, 0x9759U,
+        0x525AU, 0x17FAU, 0xD91AU, 0x9CBAU, 0x54FBU, 0x115BU, 0xDFBBU, 0x9A1BU,
+        0x459CU, 0x003CU, 0xCEDCU, 0x8B7CU, 0x433DU, 0x069DU, 0xC87DU, 0x8DDDU,
+        0x48DEU, 0x0D7EU, 0xC39EU, 0x863EU, 0x4E7FU, 0x0BDFU, 0xC53FU, 0x809FU,
+        0xD420U, 0x9180U, 0x5F60U, 0x1AC0U, 0xD281U, 0x9721U, 0x59C1U, 0x1C61U,
+        0xD962U, 0x9CC2U, 0x5222U, 0x1782U, 0xDFC3U, 0x9A63U, 0x5483U, 0x1123U,
+        0xCEA4U, 0x8B04U, 0x45E4U, 0x0044U, 0xC805U, 0x8DA5U, 0x4345U, 0x06E5U,
+        0xC3E6U, 0x8646U, 0x48A6U, 0x0D06U, 0xC547U, 0x80E7U, 0x4E07U, 0x0BA7U,
+        0xE128U, 0xA488U, 0x6A68U, 0x2FC8U, 0xE789U, 0xA229U, 0x6CC9U, 0x2969U,
+        0xEC6AU, 0xA9CAU, 0x672AU, 0x228AU, 0xEACBU, 0xAF6BU, 0x618BU, 0x242BU,
+        0xFBACU, 0xBE0CU, 0x70ECU, 0x354CU, 0xFD0DU, 0xB8ADU, 0x764DU, 0x33EDU,
+        0xF6EEU, 0xB34EU, 0x7DAEU, 0x380EU, 0xF04FU, 0xB5EFU, 0x7B0FU, 0x3EAFU,
+        0xBE30U, 0xFB90U, 0x3570U, 0x70D0U, 0xB891U, 0xFD31U, 0x33D1U, 0x7671U,
+        0xB372U, 0xF6D2U, 0x3832U, 0x7D92U, 0xB5D3U, 0xF073U, 0x3E93U, 0x7B33U,
+        0xA4B4U, 0xE114U, 0x2FF4U, 0x6A54U, 0xA215U, 0xE7B5U, 0x2955U, 0x6CF5U,
+        0xA9F6U, 0xEC56U, 0x22B6U, 0x6716U, 0xAF57U, 0xEAF7U, 0x2417U, 0x61B7U,
+        0x8B38U, 0xCE98U, 0x0078U, 0x45D8U, 0x8D99U, 0xC839U, 0x06D9U, 0x4379U,
+        0x867AU, 0xC3DAU, 0x0D3AU, 0x489AU, 0x80DBU, 0xC57BU, 0x0B9BU, 0x4E3BU,
+        0x91BCU, 0xD41CU, 0x1AFCU, 0x5F5CU, 0x971DU, 0xD2BDU, 0x1C5DU, 0x59FDU,
+        0x9CFEU, 0xD95EU, 0x17BEU, 0x521EU, 0x9A5FU, 0xDFFFU, 0x111FU, 0x54BFU
+    },
+    {
+        0x0000U, 0xB861U, 0x60E3U, 0xD882U, 0xC1C6U, 0x79A7U, 0xA125U, 0x1944U,
+        0x93ADU, 0x2BCCU, 0xF34EU, 0x4B2FU, 0x526BU, 0xEA0AU, 0x3288U, 0x8AE9U,
+        0x377BU, 0x8F1AU, 0x5798U, 0xEFF9U, 0xF6BDU, 0x4EDCU, 0x965EU, 0x2E3FU,
+        0xA4D6U, 0x1CB7U, 0xC435U, 0x7C54U, 0x6510U, 0xDD71U, 0x05F3U, 0xBD92U,
+        0x6EF6U, 0xD697U, 0x0E15U, 0xB674U, 0xAF30U, 0x1751U, 0xCFD3U, 0x77B2U,
+        0xFD5BU, 0x453AU, 0x9DB8U, 0x25D9U, 0x3C9DU, 0x84FCU, 0x5C7EU, 0xE41FU,
+        0x598DU, 0xE1ECU, 0x396EU, 0x810FU, 0x984BU, 0x202AU, 0xF8A8U, 0x40C9U,
+        0xCA20U, 0x7241U, 0xAAC3U, 0x12A2U, 0x0BE6U, 0xB387U, 0x6B05U, 0xD364U,
+        0xDDECU, 0x658DU, 0xBD0FU, 0x056EU, 0x1C2AU, 0xA44BU, 0x7CC9U, 0xC4A8U,
+        0x4E41U, 0xF620U, 0x2EA2U, 0x96C3U, 0x8F87U, 0x37E6U, 0xEF64U, 0x5705U,
+        0xEA97U, 0x52F6U, 0x8A74U, 0x3215U, 0x2B51U, 0x9330U, 0x4BB2U, 0xF3D3U,
+        0x793AU, 0xC15BU, 0x19D9U, 0xA1B8U, 0xB8FCU, 0x009DU, 0xD81FU, 0x607EU,
+        0xB31AU, 0x0B7BU, 0xD3F9U, 0x6B98U, 0x72DCU, 0xCABDU, 0x123FU, 0xAA5EU,
+        0x20B7U, 0x98D6U, 0x4054U, 0xF835U, 0xE171U, 0x5910U, 0x8192U, 0x39F3U,
+        0x8461U, 0x3C00U, 0xE482U, 0x5CE3U, 0x45A7U, 0xFDC6U, 0x2544U, 0x9D25U,
+        0x17CCU, 0xAFADU, 0x772FU, 0xCF4EU, 0xD60AU, 0x6E6BU, 0xB6E9U, 0x0E88U,
+        0xABF9U, 0x1398U, 0xCB1AU, 0x737BU, 0x6A3FU, 0xD25EU, 0x0ADCU, 0xB2BDU,
+        0x3854U, 0x8035U, 0x58B7U, 0xE0D6U, 0xF992U, 0x41F3U, 0x9971U, 0x2110U,
+        0x9C82U, 0x24E3U, 0xFC61U, 0x4400U, 0x5D44U, 0xE525U, 0x3DA7U, 0x85C6U,
+        0x0F2FU, 0xB74EU, 0x6FCCU, 0xD7ADU, 0xCEE9U, 0x7688U, 0xAE0AU, 0x166BU,
+        0xC50FU, 0x7D6EU, 0xA5ECU, 0x1D8DU, 0x04C9U, 0xBCA8U, 0x642AU, 0xDC4BU,
+        0x56A2U, 0xEEC3U, 0x3641U, 0x8E20U, 0x9764U, 0x2F05U, 0xF787U, 0x4FE6U,
+        0xF274U, 0x4A15U, 0x9297U, 0x2AF6U, 0x33B2U, 0x8BD3U, 0x5351U, 0xEB30U,
+        0x61D9U, 0xD9B8U, 0x013AU, 0xB95BU, 0xA01FU, 0x187EU, 0xC0FCU, 0x789DU,
+        0x7615U, 0xCE74U, 0x16F6U, 0xAE97U, 0xB7D3U, 0x0FB2U, 0xD730U, 0x6F51U,
+        0xE5B8U, 0x5DD9U, 0x855BU, 0x3D3AU, 0x247EU, 0x9C1FU, 0x449DU, 0xFCFCU,
+        0x416EU, 0xF90FU, 0x218DU, 0x99ECU, 0x80A8U, 0x38C9U, 0xE04BU, 0x582AU,
+        0xD2C3U, 0x6AA2U, 0xB220U, 0x0A41U, 0x1305U, 0xAB64U, 0x73E6U, 0xCB87U,
+        0x18E3U, 0xA082U, 0x7800U, 0xC061U, 0xD925U, 0x6144U, 0xB9C6U, 0x01A7U,
+        0x8B4EU, 0x332FU, 0xEBADU, 0x53CCU, 0x4A88U, 0xF2E9U, 0x2A6BU, 0x920AU,
+        0x2F98U, 0x97F9U, 0x4F7BU, 0xF71AU, 0xEE5EU, 0x563FU, 0x8EBDU, 0x36DCU,
+        0xBC35U, 0x0454U, 0xDCD6U, 0x64B7U, 0x7DF3U, 0xC592U, 0x1D10U, 0xA571U
+    },
+    {
+        0x0000U, 0x47D3U, 0x8FA6U, 0xC875U, 0x0F6DU, 0x48BEU, 0x80CBU, 0xC718U,
+        0x1EDAU, 0x5909U, 0x917CU, 0xD6AFU, 0x11B7U, 0x5664U, 0x9E11U, 0xD9C2U,
+        0x3DB4U, 0x7A67U, 0xB212U, 0xF5C1U, 0x32D9U, 0x750AU, 0xBD7FU, 0xFAACU,
+        0x236EU, 0x64BDU, 0xACC8U, 0xEB1BU, 0x2C03U, 0x6BD0U, 0xA3A5U, 0xE476U,
+        0x7B68U, 0x3CBBU, 0xF4CEU, 0xB31DU, 0x7405U, 0x33D6U, 0xFBA3U, 0xBC70U,
+        0x65B2U, 0x2261U, 0xEA14U, 0xADC7U, 0x6ADFU, 0x2D0CU, 0xE579U, 0xA2AAU,
+        0x46DCU, 0x010FU, 0xC97AU, 0x8EA9U, 0x49B1U, 0x0E62U, 0xC617U, 0x81C4U,
+        0x5806U, 0x1FD5U, 0xD7A0U, 0x9073U, 0x576BU, 0x10B8U, 0xD8CDU, 0x9F1EU,
+        0xF6D0U, 0xB103U, 0x7976U, 0x3EA5U, 0xF9BDU, 0xBE6EU, 0x761BU, 0x31C8U,
+        0xE80AU, 0xAFD9U, 0x67ACU, 0x207FU, 0xE767U, 0xA0B4U, 0x68C1U, 0x2F12U,
+        0xCB64U, 0x8CB7U, 0x44C2U, 0x0311U, 0xC409U, 0x83DAU, 0x4BAFU, 0x0C7CU,
+        0xD5BEU, 0x926DU, 0x5A18U, 0x1DCBU, 0xDAD3U, 0x9D00U, 0x5575U, 0x12A6U,
+        0x8DB8U, 0xCA6BU, 0x021EU, 0x45CDU, 0x82D5U, 0xC506U, 0x0D73U, 0x4AA0U,
+        0x9362U, 0xD4B1U, 0x1CC4U, 0x5B17U, 0x9C0FU, 0xDBDCU, 0x13A9U, 0x547AU,
+        0xB00CU, 0xF7DFU, 0x3FAAU, 0x7879U, 0xBF61U, 0xF8B2U, 0x30C7U, 0x7714U,
+        0xAED6U, 0xE905U, 0x2170U, 0x66A3U, 0xA1BBU, 0xE668U, 0x2E1DU, 0x69CEU,
+        0xFD81U, 0xBA52U, 0x7227U, 0x35F4U, 0xF2ECU, 0xB53FU, 0x7D4AU, 0x3A99U,
+        0xE35BU, 0xA488U, 0x6CFDU, 0x2B2EU, 0xEC36U, 0xABE5U, 0x6390U, 0x2443U,
+        0xC035U, 0x87E6U, 0x4F93U, 0x0840U, 0xCF58U, 0x888BU, 0x40FEU, 0x072DU,
+        0xDEEFU, 0x993CU, 0x5149U, 0x169AU, 0xD182U, 0x9651U, 0x5E24U, 0x19F7U,
+        0x86E9U, 0xC13AU, 0x094FU, 0x4E9CU, 0x8984U, 0xCE57U, 0x0622U, 0x41F1U,
+        0x9833U, 0xDFE0U, 0x1795U, 0x5046U, 0x975EU, 0xD08DU, 0x18F8U, 0x5F2BU,
+        0xBB5DU, 0xFC8EU, 0x34FBU, 0x7328U, 0xB430U, 0xF3E3U, 0x3B96U, 0x7C45U,
+        0xA587U, 0xE254U, 0x2A21U, 0x6DF2U, 0xAAEAU, 0xED39U, 0x254CU, 0x629FU,
+        0x0B51U, 0x4C82U, 0x84F7U, 0xC324U, 0x043CU, 0x43EFU, 0x8B9AU, 0xCC49U,
+        0x158BU, 0x5258U, 0x9A2DU, 0xDDFEU, 0x1AE6U, 0x5D35U, 0x9540U, 0xD293U,
+        0x36E5U, 0x7136U, 0xB943U, 0xFE90U, 0x3988U, 0x7E5BU, 0xB62EU, 0xF1FDU,
+        0x283FU, 0x6FECU, 0xA799U, 0xE04AU, 0x2752U, 0x6081U, 0xA8F4U, 0xEF27U,
+        0x7039U, 0x37EAU, 0xFF9FU, 0xB84CU, 0x7F54U, 0x3887U, 0xF0F2U, 0xB721U,
+        0x6EE3U, 0x2930U, 0xE145U, 0xA696U, 0x618EU, 0x265DU, 0xEE28U, 0xA9FBU,
+        0x4D8DU, 0x0A5EU, 0xC22BU, 0x85F8U, 0x42E0U, 0x0533U, 0xCD46U, 0x8A95U,
+        0x5357U, 0x1484U, 0xDCF1U, 0x9B22U, 0x5C3AU, 0x1BE9U, 0xD39CU, 0x944FU
+    }
+};
+
+static const uint32_t u32Crc24SliceTable[8][256] = {
+    {
+        0x00000000U, 0x864CFB00U, 0x8AD50D00U, 0x0C99F600U, 0x93E6E100U, 0x15AA1A00U, 0x1933EC00U, 0x9F7F1700U,
+        0xA1813900U, 0x27CDC200U, 0x2B543400U, 0xAD18CF00U, 0x3267D800U, 0xB42B2300U, 0xB8B2D500U, 0x3EFE2E00U,
+        0xC54E8900U, 0x43027200U, 0x4F9B8400U, 0xC9D77F00U, 0x56A86800U, 0xD0E49300U, 0xDC7D6500U, 0x5A319E00U,
+        0x64CFB000U, 0xE2834B00U, 0xEE1ABD00U, 0x68564600U, 0xF7295100U, 0x7165AA00U, 0x7DFC5C00U, 0xFBB0A700U,
+        0x0CD1E900U, 0x8A9D1200U, 0x8604E400U, 0x00481F00U, 0x9F370800U, 0x197BF300U, 0x15E20500U, 0x93AEFE00U,
+        0xAD50D000U, 0x2B1C2B00U, 0x2785DD00U, 0xA1C92600U, 0x3EB63100U, 0xB8FACA00U, 0xB4633C00U, 0x322FC700U,
+        0xC99F6000U, 0x4FD39B00U, 0x434A6D00U, 0xC5069600U, 0x5A798100U, 0xDC357A00U, 0xD0AC8C00U, 0x56E07700U,
+        0x681E5900U, 0xEE52A200U, 0xE2CB5400U, 0x6487AF00U, 0xFBF8B800U, 0x7DB44300U, 0x712DB500U, 0xF7614E00U,
+        0x19A3D200U, 0x9FEF2900U, 0x9376DF00U, 0x153A2400U, 0x8A453300U, 0x0C09C800U, 0x00903E00U, 0x86DCC500U,
+        0xB822EB00U, 0x3E6E1000U, 0x32F7E600U, 0xB4BB1D00U, 0x2BC40A00U, 0xAD88F100U, 0xA1110700U, 0x275DFC00U,
+        0xDCED5B00U, 0x5AA1A000U, 0x56385600U, 0xD074AD00U, 0x4F0BBA00U, 0xC9474100U, 0xC5DEB700U, 0x43924C00U,
+        0x7D6C6200U, 0xFB209900U, 0xF7B96F00U, 0x71F59400U, 0xEE8A8300U, 0x68C67800U, 0x645F8E00U, 0xE2137500U,
+        0x15723B00U, 0x933EC000U, 0x9FA73600U, 0x19EBCD00U, 0x8694DA00U, 0x00D82100U, 0x0C41D700U, 0x8A0D2C00U,
+        0xB4F30200U, 0x32BFF900U, 0x3E260F00U, 0xB86AF400U, 0x2715E300U, 0xA1591800U, 0xADC0EE00U, 0x2B8C1500U,
+        0xD03CB200U, 0x56704900U, 0x5AE9BF00U, 0xDCA54400U, 0x43DA5300U, 0xC596A800U, 0xC90F5E00U, 0x4F43A500U,
+        0x71BD8B00U, 0xF7F17000U, 0xFB688600U, 0x7D247D00U, 0xE25B6A00U, 0x64179100U, 0x688E6700U, 0xEEC29C00U,
+        0x3347A400U, 0xB50B5F00U, 0xB992A900U, 0x3FDE5200U, 0xA0A14500U, 0x26EDBE00U, 0x2A744800U, 0xAC38B300U,
+        0x92C69D00U, 0x148A6600U, 0x18139000U, 0x9E5F6B00U, 0x01207C00U, 0x876C8700U, 0x8BF57100U, 0x0DB98A00U,
+        0xF6092D00U, 0x7045D600U, 0x7CDC2000U, 0xFA90DB00U, 0x65EFCC00U, 0xE3A33700U, 0xEF3AC100U, 0x69763A00U,
+        0x57881400U, 0xD1C4EF00U, 0xDD5D1900U, 0x5B11E200U, 0xC46EF500U, 0x42220E00U, 0x4EBBF800U, 0xC8F70300U,
+        0x3F964D00U, 0xB9DAB600U, 0xB5434000U, 0x330FBB00U, 0xAC70AC00U, 0x2A3C5700U, 0x26A5A100U, 0xA0E95A00U,
+        0x9E177400U, 0x185B8F00U, 0x14C27900U, 0x928E8200U, 0x0DF19500U, 0x8BBD6E00U, 0x87249800U, 0x01686300U,
+        0xFAD8C400U, 0x7C943F00U, 0x700DC900U, 0xF6413200U, 0x693E2500U, 0xEF72DE00U, 0xE3EB2800U, 0x65A7D300U,
+        0x5B59FD00U, 0xDD150600U, 0xD18CF000U, 0x57C00B00U, 0xC8BF1C00U, 0x4EF3E700U, 0x426A1100U, 0xC426EA00U,
+        0x2AE47600U, 0xACA88D00U, 0xA0317B00U, 0x267D8000U, 0xB9029700U, 0x3F4E6C00U, 0x33D79A00U, 0xB59B6100U,
+        0x8B654F00U, 0x0D29B400U, 0x01B04200U, 0x87FCB900U, 0x1883AE00U, 0x9ECF5500U, 0x9256A300U, 0x141A5800U,
+        0xEFAAFF00U, 0x69E60400U, 0x657FF200U, 0xE3330900U, 0x7C4C1E00U, 0xFA00E500U, 0xF6991300U, 0x70D5E800U,
+        0x4E2BC600U, 0xC8673D00U, 0xC4FECB00U, 0x42B23000U, 0xDDCD2700U, 0x5B81DC00U, 0x57182A00U, 0xD154D100U,
+        0x26359F00U, 0xA0796400U, 0xACE09200U, 0x2AAC6900U, 0xB5D37E00U, 0x339F8500U, 0x3F067300U, 0xB94A8800U,
+        0x87B4A600U, 0x01F85D00U, 0x0D61AB00U, 0x8B2D5000U, 0x14524700U, 0x921EBC00U, 0x9E874A00U, 0x18CBB100U,
+        0xE37B1600U, 0x6537ED00U, 0x69AE1B00U, 0xEFE2E000U, 0x709DF700U, 0xF6D10C00U, 0xFA48FA00U, 0x7C040100U,
+        0x42FA2F00U, 0xC4B6D400U, 0xC82F2200U, 0x4E63D900U, 0xD11CCE00U, 0x57503500U, 0x5BC9C300U, 0xDD853800U
+    },
+    {
+        0x00000000U, 0x668F4800U, 0xCD1E9000U, 0xAB91D800U, 0x1C71DB00U, 0x7AFE9300U, 0xD16F4B00U, 0xB7E00300U,
+        0x38E3B600U, 0x5E6CFE00U, 0xF5FD2600U, 0x93726E00U, 0x24926D00U, 0x421D2500U, 0xE98CFD00U, 0x8F03B500U,
+        0x71C76C00U, 0x17482400U, 0xBCD9FC00U, 0xDA56B400U, 0x6DB6B700U, 0x0B39FF00U, 0xA0A82700U, 0xC6276F00U,
+        0x4924DA00U, 0x2FAB9200U, 0x843A4A00U, 0xE2B50200U, 0x55550100U, 0x33DA4900U, 0x984B9100U, 0xFEC4D900U,
+        0xE38ED800U, 0x85019000U, 0x2E904800U, 0x481F0000U, 0xFFFF0300U, 0x99704B00U, 0x32E19300U, 0x546EDB00U,
+        0xDB6D6E00U, 0xBDE22600U, 0x1673FE00U, 0x70FCB600U, 0xC71CB500U, 0xA193FD00U, 0x0A022500U, 0x6C8D6D00U,
+        0x9249B400U, 0xF4C6FC00U, 0x5F572400U, 0x39D86C00U, 0x8E386F00U, 0xE8B72700U, 0x4326FF00U, 0x25A9B700U,
+        0xAAAA0200U, 0xCC254A00U, 0x67B49200U, 0x013BDA00U, 0xB6DBD900U, 0xD0549100U, 0x7BC54900U, 0x1D4A0100U,
+        0x41514B00U, 0x27DE0300U, 0x8C4FDB00U, 0xEAC09300U, 0x5D209000U, 0x3BAFD800U, 0x903E0000U, 0xF6B14800U,
+        0x79B2FD00U, 0x1F3DB500U, 0xB4AC6D00U, 0xD2232500U, 0x65C32600U, 0x034C6E00U, 0xA8DDB600U, 0xCE52FE00U,
+        0x30962700U, 0x56196F00U, 0xFD88B700U, 0x9B07FF00U, 0x2CE7FC00U, 0x4A68B400U, 0xE1F96C00U, 0x87762400U,
+        0x08759100U, 0x6EFAD900U, 0xC56B0100U, 0xA3E44900U, 0x14044A00U, 0x728B0200U, 0xD91ADA00U, 0xBF959200U,
+        0xA2DF9300U, 0xC450DB00U, 0x6FC10300U, 0x094E4B00U, 0xBEAE4800U, 0xD8210000U, 0x73B0D800U, 0x153F9000U,
+        0x9A3C2500U, 0xFCB36D00U, 0x5722B500U, 0x31ADFD00U, 0x864DFE00U, 0xE0C2B600U, 0x4B536E00U, 0x2DDC2600U,
+        0xD318FF00U, 0xB597B700U, 0x1E066F00U, 0x78892700U, 0xCF692400U, 0xA9E66C00U, 0x0277B400U, 0x64F8FC00U,
+        0xEBFB4900U, 0x8D740100U, 0x26E5D900U, 0x406A9100U, 0xF78A9200U, 0x9105DA00U, 0x3A940200U, 0x5C1B4A00U,
+        0x82A29600U, 0xE42DDE00U, 0x4FBC0600U, 0x29334E00U, 0x9ED34D00U, 0xF85C0500U, 0x53CDDD00U, 0x35429500U,
+        0xBA412000U, 0xDCCE6800U, 0x775FB000U, 0x11D0F800U, 0xA630FB00U, 0xC0BFB300U, 0x6B2E6B00U, 0x0DA12300U,
+        0xF365FA00U, 0x95EAB200U, 0x3E7B6A00U, 0x58F42200U, 0xEF142100U, 0x899B6900U, 0x220AB100U, 0x4485F900U,
+        0xCB864C00U, 0xAD090400U, 0x0698DC00U, 0x60179400U, 0xD7F79700U, 0xB178DF00U, 0x1AE90700U, 0x7C664F00U,
+        0x612C4E00U, 0x07A30600U, 0xAC32DE00U, 0xCABD9600U, 0x7D5D9500U, 0x1BD2DD00U, 0xB0430500U, 0xD6CC4D00U,
+        0x59CFF800U, 0x3F40B000U, 0x94D16800U, 0xF25E2000U, 0x45BE2300U, 0x23316B00U, 0x88A0B300U, 0xEE2FFB00U,
+        0x10EB2200U, 0x76646A00U, 0xDDF5B200U, 0xBB7AFA00U, 0x0C9AF900U, 0x6A15B100U, 0xC1846900U, 0xA70B2100U,
+        0x28089400U, 0x4E87DC00U, 0xE5160400U, 0x83994C00U, 0x34794F00U, 0x52F60700U, 0xF967DF00U, 0x9FE89700U,
+        0xC3F3DD00U, 0xA57C9500U, 0x0EED4D00U, 0x68620500U, 0xDF820600U, 0xB90D4E00U, 0x129C9600U, 0x7413DE00U,
+        0xFB106B00U, 0x9D9F2300U, 0x360EFB00U, 0x5081B300U, 0xE761B000U, 0x81EEF800U, 0x2A7F2000U, 0x4CF06800U,
+        0xB234B100U, 0xD4BBF900U, 0x7F2A2100U, 0x19A56900U, 0xAE456A00U, 0xC8CA2200U, 0x635BFA00U, 0x05D4B200U,
+        0x8AD70700U, 0xEC584F00U, 0x47C99700U, 0x2146DF00U, 0x96A6DC00U, 0xF0299400U, 0x5BB84C00U, 0x3D370400U,
+        0x207D0500U, 0x46F24D00U, 0xED639500U, 0x8BECDD00U, 0x3C0CDE00U, 0x5A839600U, 0xF1124E00U, 0x979D0600U,
+        0x189EB300U, 0x7E11FB00U, 0xD5802300U, 0xB30F6B00U, 0x04EF6800U, 0x62602000U, 0xC9F1F800U, 0xAF7EB000U,
+        0x51BA6900U, 0x37352100U, 0x9CA4F900U, 0xFA2BB100U, 0x4DCBB200U, 0x2B44FA00U, 0x80D52200U, 0xE65A6A00U,
+        0x6959DF00U, 0x0FD69700U, 0xA4474F00U, 0xC2C80700U, 0x75280400U, 0x13A74C00U, 0xB8369400U, 0xDEB9DC00U
+    },
+    {
+        0x00000000U, 0x8309D700U, 0x805F5500U, 0x03568200U, 0x86F25100U, 0x05FB8600U, 0x06AD0400U, 0x85A4D300U,
+        0x8BA85900U, 0x08A18E00U, 0x0BF70C00U, 0x88FEDB00U, 0x0D5A0800U, 0x8E53DF00U, 0x8D055D00U, 0x0E0C8A00U,
+        0x911C4900U, 0x12159E00U, 0x11431C00U, 0x924ACB00U, 0x17EE1800U, 0x94E7CF00U, 0x97B14D00U, 0x14B89A00U,
+        0x1AB41000U, 0x99BDC700U, 0x9AEB4500U, 0x19E29200U, 0x9C464100U, 0x1F4F9600U, 0x1C191400U, 0x9F10C300U,
+        0xA4746900U, 0x277DBE00U, 0x242B3C00U, 0xA722EB00U, 0x22863800U, 0xA18FEF00U, 0xA2D96D00U, 0x21D0BA00U,
+        0x2FDC3000U, 0xACD5E700U, 0xAF836500U, 0x2C8AB200U, 0xA92E6100U, 0x2A27B600U, 0x29713400U, 0xAA78E300U,
+        0x35682000U, 0xB661F700U, 0xB5377500U, 0x363EA200U, 0xB39A7100U, 0x3093A600U, 0x33C52400U, 0xB0CCF300U,
+        0xBEC07900U, 0x3DC9AE00U, 0x3E9F2C00U, 0xBD96FB00U, 0x38322800U, 0xBB3BFF00U, 0xB86D7D00U, 0x3B64AA00U,
+        0xCEA42900U, 0x4DADFE00U, 0x4EFB7C00U, 0xCDF2AB00U, 0x48567800U, 0xCB5FAF00U, 0xC8092D00U, 0x4B00FA00U,
+        0x450C7000U, 0xC605A700U, 0xC5532500U, 0x465AF200U, 0xC3FE2100U, 0x40F7F600U, 0x43A17400U, 0xC0A8A300U,
+        0x5FB86000U, 0xDCB1B700U, 0xDFE73500U, 0x5CEEE200U, 0xD94A3100U, 0x5A43E600U, 0x59156400U, 0xDA1CB300U,
+        0xD4103900U, 0x5719EE00U, 0x544F6C00U, 0xD746BB00U, 0x52E26800U, 0xD1EBBF00U, 0xD2BD3D00U, 0x51B4EA00U,
+        0x6AD04000U, 0xE9D99700U, 0xEA8F1500U, 0x6986C200U, 0xEC221100U, 0x6F2BC600U, 0x6C7D4400U, 0xEF749300U,
+        0xE1781900U, 0x6271CE00U, 0x61274C00U, 0xE22E9B00U, 0x678A4800U, 0xE4839F00U, 0xE7D51D00U, 0x64DCCA00U,
+        0xFBCC0900U, 0x78C5DE00U, 0x7B935C00U, 0xF89A8B00U, 0x7D3E5800U, 0xFE378F00U, 0xFD610D00U, 0x7E68DA00U,
+        0x70645000U, 0xF36D8700U, 0xF03B0500U, 0x7332D200U, 0xF6960100U, 0x759FD600U, 0x76C95400U, 0xF5C08300U,
+        0x1B04A900U, 0x980D7E00U, 0x9B5BFC00U, 0x18522B00U, 0x9DF6F800U, 0x1EFF2F00U, 0x1DA9AD00U, 0x9EA07A00U,
+        0x90ACF000U, 0x13A52700U, 0x10F3A500U, 0x93FA7200U, 0x165EA100U, 0x95577600U, 0x9601F400U, 0x15082300U,
+        0x8A18E000U, 0x09113700U, 0x0A47B500U, 0x894E6200U, 0x0CEAB100U, 0x8FE36600U, 0x8CB5E400U, 0x0FBC3300U,
+        0x01B0B900U, 0x82B96E00U, 0x81EFEC00U, 0x02E63B00U, 0x8742E800U, 0x044B3F00U, 0x071DBD00U, 0x84146A00U,
+        0xBF70C000U, 0x3C791700U, 0x3F2F9500U, 0xBC264200U, 0x39829100U, 0xBA8B4600U, 0xB9DDC400U, 0x3AD41300U,
+        0x34D89900U, 0xB7D14E00U, 0xB487CC00U, 0x378E1B00U, 0xB22AC800U, 0x31231F00U, 0x32759D00U, 0xB17C4A00U,
+        0x2E6C8900U, 0xAD655E00U, 0xAE33DC00U, 0x2D3A0B00U, 0xA89ED800U, 0x2B970F00U, 0x28C18D00U, 0xABC85A00U,
+        0xA5C4D000U, 0x26CD0700U, 0x259B8500U, 0xA6925200U, 0x23368100U, 0xA03F5600U, 0xA369D400U, 0x20600300U,
+        0xD5A08000U, 0x56A95700U, 0x55FFD500U, 0xD6F60200U, 0x5352D100U, 0xD05B0600U, 0xD30D8400U, 0x50045300U,
+        0x5E08D900U, 0xDD010E00U, 0xDE578C00U, 0x5D5E5B00U, 0xD8FA8800U, 0x5BF35F00U, 0x58A5DD00U, 0xDBAC0A00U,
+        0x44BCC900U, 0xC7B51E00U, 0xC4E39C00U, 0x47EA4B00U, 0xC24E9800U, 0x41474F00U, 0x4211CD00U, 0xC1181A00U,
+        0xCF149000U, 0x4C1D4700U, 0x4F4BC500U, 0xCC421200U, 0x49E6C100U, 0xCAEF1600U, 0xC9B99400U, 0x4AB04300U,
+        0x71D4E900U, 0xF2DD3E00U, 0xF18BBC00U, 0x72826B00U, 0xF726B800U, 0x742F6F00U, 0x7779ED00U, 0xF4703A00U,
+        0xFA7CB000U, 0x79756700U, 0x7A23E500U, 0xF92A3200U, 0x7C8EE100U, 0xFF873600U, 0xFCD1B400U, 0x7FD86300U,
+        0xE0C8A000U, 0x63C17700U, 0x6097F500U, 0xE39E2200U, 0x663AF100U, 0xE5332600U, 0xE665A400U, 0x656C7300U,
+        0x6B60F900U, 0xE8692E00U, 0xEB3FAC00U, 0x68367B00U, 0xED92A800U, 0x6E9B7F00U, 0x6DCDFD00U, 0xEEC42A00U
+    },
+    {
+        0x00000000U, 0x36095200U, 0x6C12A400U, 0x5A1BF600U, 0xD8254800U, 0xEE2C1A00U, 0xB437EC00U, 0x823EBE00U,
+        0x36066B00U, 0x000F3900U, 0x5A14CF00U, 0x6C1D9D00U, 0xEE232300U, 0xD82A7100U, 0x82318700U, 0xB438D500U,
+        0x6C0CD600U, 0x5A058400U, 0x001E7200U, 0x36172000U, 0xB4299E00U, 0x8220CC00U, 0xD83B3A00U, 0xEE326800U,
+        0x5A0ABD00U, 0x6C03EF00U, 0x36181900U, 0x00114B00U, 0x822FF500U, 0xB426A700U, 0xEE3D5100U, 0xD8340300U,
+        0xD819AC00U, 0xEE10FE00U, 0xB40B0800U, 0x82025A00U, 0x003CE400U, 0x3635B600U, 0x6C2E4000U, 0x5A271200U,
+        0xEE1FC700U, 0xD8169500U, 0x820D6300U, 0xB4043100U, 0x363A8F00U, 0x0033DD00U, 0x5A282B00U, 0x6C217900U,
+        0xB4157A00U, 0x821C2800U, 0xD807DE00U, 0xEE0E8C00U, 0x6C303200U, 0x5A396000U, 0x00229600U, 0x362BC400U,
+        0x82131100U, 0xB41A4300U, 0xEE01B500U, 0xD808E700U, 0x5A365900U, 0x6C3F0B00U, 0x3624FD00U, 0x002DAF00U,
+        0x367FA300U, 0x0076F100U, 0x5A6D0700U, 0x6C645500U, 0xEE5AEB00U, 0xD853B900U, 0x82484F00U, 0xB4411D00U,
+        0x0079C800U, 0x36709A00U, 0x6C6B6C00U, 0x5A623E00U, 0xD85C8000U, 0xEE55D200U, 0xB44E2400U, 0x82477600U,
+        0x5A737500U, 0x6C7A2700U, 0x3661D100U, 0x00688300U, 0x82563D00U, 0xB45F6F00U, 0xEE449900U, 0xD84DCB00U,
+        0x6C751E00U, 0x5A7C4C00U, 0x0067BA00U, 0x366EE800U, 0xB4505600U, 0x82590400U, 0xD842F200U, 0xEE4BA000U,
+        0xEE660F00U, 0xD86F5D00U, 0x8274AB00U, 0xB47DF900U, 0x36434700U, 0x004A1500U, 0x5A51E300U, 0x6C58B100U,
+        0xD8606400U, 0xEE693600U, 0xB472C000U, 0x827B9200U, 0x00452C00U, 0x364C7E00U, 0x6C578800U, 0x5A5EDA00U,
+        0x826AD900U, 0xB4638B00U, 0xEE787D00U, 0xD8712F00U, 0x5A4F9100U, 0x6C46C300U, 0x365D3500U, 0x00546700U,
+        0xB46CB200U, 0x8265E000U, 0xD87E1600U, 0xEE774400U, 0x6C49FA00U, 0x5A40A800U, 0x005B5E00U, 0x36520C00U,
+        0x6CFF4600U, 0x5AF61400U, 0x00EDE200U, 0x36E4B000U, 0xB4DA0E00U, 0x82D35C00U, 0xD8C8AA00U, 0xEEC1F800U,
+        0x5AF92D00U, 0x6CF07F00U, 0x36EB8900U, 0x00E2DB00U, 0x82DC6500U, 0xB4D53700U, 0xEECEC100U, 0xD8C79300U,
+        0x00F39000U, 0x36FAC200U, 0x6CE13400U, 0x5AE86600U, 0xD8D6D800U, 0xEEDF8A00U, 0xB4C47C00U, 0x82CD2E00U,
+        0x36F5FB00U, 0x00FCA900U, 0x5AE75F00U, 0x6CEE0D00U, 0xEED0B300U, 0xD8D9E100U, 0x82C21700U, 0xB4CB4500U,
+        0xB4E6EA00U, 0x82EFB800U, 0xD8F44E00U, 0xEEFD1C00U, 0x6CC3A200U, 0x5ACAF000U, 0x00D10600U, 0x36D85400U,
+        0x82E08100U, 0xB4E9D300U, 0xEEF22500U, 0xD8FB7700U, 0x5AC5C900U, 0x6CCC9B00U, 0x36D76D00U, 0x00DE3F00U,
+        0xD8EA3C00U, 0xEEE36E00U, 0xB4F89800U, 0x82F1CA00U, 0x00CF7400U, 0x36C62600U, 0x6CDDD000U, 0x5AD48200U,
+        0xEEEC5700U, 0xD8E50500U, 0x82FEF300U, 0xB4F7A100U, 0x36C91F00U, 0x00C04D00U, 0x5ADBBB00U, 0x6CD2E900U,
+        0x5A80E500U, 0x6C89B700U, 0x36924100U, 0x009B1300U, 0x82A5AD00U, 0xB4ACFF00U, 0xEEB70900U, 0xD8BE5B00U,
+        0x6C868E00U, 0x5A8FDC00U, 0x00942A00U, 0x369D7800U, 0xB4A3C600U, 0x82AA9400U, 0xD8B16200U, 0xEEB83000U,
+        0x368C3300U, 0x00856100U, 0x5A9E9700U, 0x6C97C500U, 0xEEA97B00U, 0xD8A02900U, 0x82BBDF00U, 0xB4B28D00U,
+        0x008A5800U, 0x36830A00U, 0x6C98FC00U, 0x5A91AE00U, 0xD8AF1000U, 0xEEA64200U, 0xB4BDB400U, 0x82B4E600U,
+        0x82994900U, 0xB4901B00U, 0xEE8BED00U, 0xD882BF00U, 0x5ABC0100U, 0x6CB55300U, 0x36AEA500U, 0x00A7F700U,
+        0xB49F2200U, 0x82967000U, 0xD88D8600U, 0xEE84D400U, 0x6CBA6A00U, 0x5AB33800U, 0x00A8CE00U, 0x36A19C00U,
+        0xEE959F00U, 0xD89CCD00U, 0x82873B00U, 0xB48E6900U, 0x36B0D700U, 0x00B98500U, 0x5AA27300U, 0x6CAB2100U,
+        0xD893F400U, 0xEE9AA600U, 0xB4815000U, 0x82880200U, 0x00B6BC00U, 0x36BFEE00U, 0x6CA41800U, 0x5AAD4A00U
+    },
+    {
+        0x00000000U, 0xD9FE8C00U, 0x35B1E300U, 0xEC4F6F00U, 0x6B63C600U, 0xB29D4A00U, 0x5ED22500U, 0x872CA900U,
+        0xD6C78C00U, 0x0F390000U, 0xE3766F00U, 0x3A88E300U, 0xBDA44A00U, 0x645AC600U, 0x8815A900U, 0x51EB2500U,
+        0x2BC3E300U, 0xF23D6F00U, 0x1E720000U, 0xC78C8C00U, 0x40A02500U, 0x995EA900U, 0x7511C600U, 0xACEF4A00U,
+        0xFD046F00U, 0x24FAE300U, 0xC8B58C00U, 0x114B0000U, 0x9667A900U, 0x4F992500U, 0xA3D64A00U, 0x7A28C600U,
+        0x5787C600U, 0x8E794A00U, 0x62362500U, 0xBBC8A900U, 0x3CE40000U, 0xE51A8C00U, 0x0955E300U, 0xD0AB6F00U,
+        0x81404A00U, 0x58BEC600U, 0xB4F1A900U, 0x6D0F2500U, 0xEA238C00U, 0x33DD0000U, 0xDF926F00U, 0x066CE300U,
+        0x7C442500U, 0xA5BAA900U, 0x49F5C600U, 0x900B4A00U, 0x1727E300U, 0xCED96F00U, 0x22960000U, 0xFB688C00U,
+        0xAA83A900U, 0x737D2500U, 0x9F324A00U, 0x46CCC600U, 0xC1E06F00U, 0x181EE300U, 0xF4518C00U, 0x2DAF0000U,
+        0xAF0F8C00U, 0x76F10000U, 0x9ABE6F00U, 0x4340E300U, 0xC46C4A00U, 0x1D92C600U, 0xF1DDA900U, 0x28232500U,
+        0x79C80000U, 0xA0368C00U, 0x4C79E300U, 0x95876F00U, 0x12ABC600U, 0xCB554A00U, 0x271A2500U, 0xFEE4A900U,
+        0x84CC6F00U, 0x5D32E300U, 0xB17D8C00U, 0x68830000U, 0xEFAFA900U, 0x36512500U, 0xDA1E4A00U, 0x03E0C600U,
+        0x520BE300U, 0x8BF56F00U, 0x67BA0000U, 0xBE448C00U, 0x39682500U, 0xE096A900U, 0x0CD9C600U, 0xD5274A00U,
+        0xF8884A00U, 0x2176C600U, 0xCD39A900U, 0x14C72500U, 0x93EB8C00U, 0x4A150000U, 0xA65A6F00U, 0x7FA4E300U,
+        0x2E4FC600U, 0xF7B14A00U, 0x1BFE2500U, 0xC200A900U, 0x452C0000U, 0x9CD28C00U, 0x709DE300U, 0xA9636F00U,
+        0xD34BA900U, 0x0AB52500U, 0xE6FA4A00U, 0x3F04C600U, 0xB8286F00U, 0x61D6E300U, 0x8D998C00U, 0x54670000U,
+        0x058C2500U, 0xDC72A900U, 0x303DC600U, 0xE9C34A00U, 0x6EEFE300U, 0xB7116F00U, 0x5B5E0000U, 0x82A08C00U,
+        0xD853E300U, 0x01AD6F00U, 0xEDE20000U, 0x341C8C00U, 0xB3302500U, 0x6ACEA900U, 0x8681C600U, 0x5F7F4A00U,
+        0x0E946F00U, 0xD76AE300U, 0x3B258C00U, 0xE2DB0000U, 0x65F7A900U, 0xBC092500U, 0x50464A00U, 0x89B8C600U,
+        0xF3900000U, 0x2A6E8C00U, 0xC621E300U, 0x1FDF6F00U, 0x98F3C600U, 0x410D4A00U, 0xAD422500U, 0x74BCA900U,
+        0x25578C00U, 0xFCA90000U, 0x10E66F00U, 0xC918E300U, 0x4E344A00U, 0x97CAC600U, 0x7B85A900U, 0xA27B2500U,
+        0x8FD42500U, 0x562AA900U, 0xBA65C600U, 0x639B4A00U, 0xE4B7E300U, 0x3D496F00U, 0xD1060000U, 0x08F88C00U,
+        0x5913A900U, 0x80ED2500U, 0x6CA24A00U, 0xB55CC600U, 0x32706F00U, 0xEB8EE300U, 0x07C18C00U, 0xDE3F0000U,
+        0xA417C600U, 0x7DE94A00U, 0x91A62500U, 0x4858A900U, 0xCF740000U, 0x168A8C00U, 0xFAC5E300U, 0x233B6F00U,
+        0x72D04A00U, 0xAB2EC600U, 0x4761A900U, 0x9E9F2500U, 0x19B38C00U, 0xC04D0000U, 0x2C026F00U, 0xF5FCE300U,
+        0x775C6F00U, 0xAEA2E300U, 0x42ED8C00U, 0x9B130000U, 0x1C3FA900U, 0xC5C12500U, 0x298E4A00U, 0xF070C600U,
+        0xA19BE300U, 0x78656F00U, 0x942A0000U, 0x4DD48C00U, 0xCAF82500U, 0x1306A900U, 0xFF49C600U, 0x26B74A00U,
+        0x5C9F8C00U, 0x85610000U, 0x692E6F00U, 0xB0D0E300U, 0x37FC4A00U, 0xEE02C600U, 0x024DA900U, 0xDBB32500U,
+        0x8A580000U, 0x53A68C00U, 0xBFE9E300U, 0x66176F00U, 0xE13BC600U, 0x38C54A00U, 0xD48A2500U, 0x0D74A900U,
+        0x20DBA900U, 0xF9252500U, 0x156A4A00U, 0xCC94C600U, 0x4BB86F00U, 0x9246E300U, 0x7E098C00U, 0xA7F70000U,
+        0xF61C2500U, 0x2FE2A900U, 0xC3ADC600U, 0x1A534A00U, 0x9D7FE300U, 0x44816F00U, 0xA8CE0000U, 0x71308C00U,
+        0x0B184A00U, 0xD2E6C600U, 0x3EA9A900U, 0xE7572500U, 0x607B8C00U, 0xB9850000U, 0x55CA6F00U, 0x8C34E300U,
+        0xDDDFC600U, 0x04214A00U, 0xE86E2500U, 0x3190A900U, 0xB6BC0000U, 0x6F428C00U, 0x830DE300U, 0x5AF36F00U
+    },
+    {
+        0x00000000U, 0x36EB3D00U, 0x6DD67A00U, 0x5B3D4700U, 0xDBACF400U, 0xED47C900U, 0xB67A8E00U, 0x8091B300U,
+        0x31151300U, 0x07FE2E00U, 0x5CC36900U, 0x6A285400U, 0xEAB9E700U, 0xDC52DA00U, 0x876F9D00U, 0xB184A000U,
+        0x622A2600U, 0x54C11B00U, 0x0FFC5C00U, 0x39176100U, 0xB986D200U, 0x8F6DEF00U, 0xD450A800U, 0xE2BB9500U,
+        0x533F3500U, 0x65D40800U, 0x3EE94F00U, 0x08027200U, 0x8893C100U, 0xBE78FC00U, 0xE545BB00U, 0xD3AE8600U,
+        0xC4544C00U, 0xF2BF7100U, 0xA9823600U, 0x9F690B00U, 0x1FF8B800U, 0x29138500U, 0x722EC200U, 0x44C5FF00U,
+        0xF5415F00U, 0xC3AA6200U, 0x98972500U, 0xAE7C1800U, 0x2EEDAB00U, 0x18069600U, 0x433BD100U, 0x75D0EC00U,
+        0xA67E6A00U, 0x90955700U, 0xCBA81000U, 0xFD432D00U, 0x7DD29E00U, 0x4B39A300U, 0x1004E400U, 0x26EFD900U,
+        0x976B7900U, 0xA1804400U, 0xFABD0300U, 0xCC563E00U, 0x4CC78D00U, 0x7A2CB000U, 0x2111F700U, 0x17FACA00U,
+        0x0EE46300U, 0x380F5E00U, 0x63321900U, 0x55D92400U, 0xD5489700U, 0xE3A3AA00U, 0xB89EED00U, 0x8E75D000U,
+        0x3FF17000U, 0x091A4D00U, 0x52270A00U, 0x64CC3700U, 0xE45D8400U, 0xD2B6B900U, 0x898BFE00U, 0xBF60C300U,
+        0x6CCE4500U, 0x5A257800U, 0x01183F00U, 0x37F30200U, 0xB762B100U, 0x81898C00U, 0xDAB4CB00U, 0xEC5FF600U,
+        0x5DDB5600U, 0x6B306B00U, 0x300D2C00U, 0x06E61100U, 0x8677A200U, 0xB09C9F00U, 0xEBA1D800U, 0xDD4AE500U,
+        0xCAB02F00U, 0xFC5B1200U, 0xA7665500U, 0x918D6800U, 0x111CDB00U, 0x27F7E600U, 0x7CCAA100U, 0x4A219C00U,
+        0xFBA53C00U, 0xCD4E0100U, 0x96734600U, 0xA0987B00U, 0x2009C800U, 0x16E2F500U, 0x4DDFB200U, 0x7B348F00U,
+        0xA89A0900U, 0x9E713400U, 0xC54C7300U, 0xF3A74E00U, 0x7336FD00U, 0x45DDC000U, 0x1EE08700U, 0x280BBA00U,
+        0x998F1A00U, 0xAF642700U, 0xF4596000U, 0xC2B25D00U, 0x4223EE00U, 0x74C8D300U, 0x2FF59400U, 0x191EA900U,
+        0x1DC8C600U, 0x2B23FB00U, 0x701EBC00U, 0x46F58100U, 0xC6643200U, 0xF08F0F00U, 0xABB24800U, 0x9D597500U,
+        0x2CDDD500U, 0x1A36E800U, 0x410BAF00U, 0x77E09200U, 0xF7712100U, 0xC19A1C00U, 0x9AA75B00U, 0xAC4C6600U,
+        0x7FE2E000U, 0x4909DD00U, 0x12349A00U, 0x24DFA700U, 0xA44E1400U, 0x92A52900U, 0xC9986E00U, 0xFF735300U,
+        0x4EF7F300U, 0x781CCE00U, 0x23218900U, 0x15CAB400U, 0x955B0700U, 0xA3B03A00U, 0xF88D7D00U, 0xCE664000U,
+        0xD99C8A00U, 0xEF77B700U, 0xB44AF000U, 0x82A1CD00U, 0x02307E00U, 0x34DB4300U, 0x6FE60400U, 0x590D3900U,
+        0xE8899900U, 0xDE62A400U, 0x855FE300U, 0xB3B4DE00U, 0x33256D00U, 0x05CE5000U, 0x5EF31700U, 0x68182A00U,
+        0xBBB6AC00U, 0x8D5D9100U, 0xD660D600U, 0xE08BEB00U, 0x601A5800U, 0x56F16500U, 0x0DCC2200U, 0x3B271F00U,
+        0x8AA3BF00U, 0xBC488200U, 0xE775C500U, 0xD19EF800U, 0x510F4B00U, 0x67E47600U, 0x3CD93100U, 0x0A320C00U,
+        0x132CA500U, 0x25C79800U, 0x7EFADF00U, 0x4811E200U, 0xC8805100U, 0xFE6B6C00U, 0xA5562B00U, 0x93BD1600U,
+        0x2239B600U, 0x14D28B00U, 0x4FEFCC00U, 0x7904F100U, 0xF9954200U, 0xCF7E7F00U, 0x94433800U, 0xA2A80500U,
+        0x71068300U, 0x47EDBE00U, 0x1CD0F900U, 0x2A3BC400U, 0xAAAA7700U, 0x9C414A00U, 0xC77C0D00U, 0xF1973000U,
+        0x40139000U, 0x76F8AD00U, 0x2DC5EA00U, 0x1B2ED700U, 0x9BBF6400U, 0xAD545900U, 0xF6691E00U, 0xC0822300U,
+        0xD778E900U, 0xE193D400U, 0xBAAE9300U, 0x8C45AE00U, 0x0CD41D00U, 0x3A3F2000U, 0x61026700U, 0x57E95A00U,
+        0xE66DFA00U, 0xD086C700U, 0x8BBB8000U, 0xBD50BD00U, 0x3DC10E00U, 0x0B2A3300U, 0x50177400U, 0x66FC4900U,
+        0xB552CF00U, 0x83B9F200U, 0xD884B500U, 0xEE6F8800U, 0x6EFE3B00U, 0x58150600U, 0x03284100U, 0x35C37C00U,
+        0x8447DC00U, 0xB2ACE100U, 0xE991A600U, 0xDF7A9B00U, 0x5FEB2800U, 0x69001500U, 0x323D5200U, 0x04D66F00U
+    },
+    {
+        0x00000000U, 0x3B918C00U, 0x77231800U, 0x4CB29400U, 0xEE463000U, 0xD5D7BC00U, 0x99652800U, 0xA2F4A400U,
+        0x5AC09B00U, 0x61511700U, 0x2DE38300U, 0x16720F00U, 0xB486AB00U, 0x8F172700U, 0xC3A5B300U, 0xF8343F00U,
+        0xB5813600U, 0x8E10BA00U, 0xC2A22E00U, 0xF933A200U, 0x5BC70600U, 0x60568A00U, 0x2CE41E00U, 0x17759200U,
+        0xEF41AD00U, 0xD4D02100U, 0x9862B500U, 0xA3F33900U, 0x01079D00U, 0x3A961100U, 0x76248500U, 0x4DB50900U,
+        0xED4E9700U, 0xD6DF1B00U, 0x9A6D8F00U, 0xA1FC0300U, 0x0308A700U, 0x38992B00U, 0x742BBF00U, 0x4FBA3300U,
+        0xB78E0C00U, 0x8C1F8000U, 0xC0AD1400U, 0xFB3C9800U, 0x59C83C00U, 0x6259B000U, 0x2EEB2400U, 0x157AA800U,
+        0x58CFA100U, 0x635E2D00U, 0x2FECB900U, 0x147D3500U, 0xB6899100U, 0x8D181D00U, 0xC1AA8900U, 0xFA3B0500U,
+        0x020F3A00U, 0x399EB600U, 0x752C2200U, 0x4EBDAE00U, 0xEC490A00U, 0xD7D88600U, 0x9B6A1200U, 0xA0FB9E00U,
+        0x5CD1D500U, 0x67405900U, 0x2BF2CD00U, 0x10634100U, 0xB297E500U, 0x89066900U, 0xC5B4FD00U, 0xFE257100U,
+        0x06114E00U, 0x3D80C200U, 0x71325600U, 0x4AA3DA00U, 0xE8577E00U, 0xD3C6F200U, 0x9F746600U, 0xA4E5EA00U,
+        0xE950E300U, 0xD2C16F00U, 0x9E73FB00U, 0xA5E27700U, 0x0716D300U, 0x3C875F00U, 0x7035CB00U, 0x4BA44700U,
+        0xB3907800U, 0x8801F400U, 0xC4B36000U, 0xFF22EC00U, 0x5DD64800U, 0x6647C400U, 0x2AF55000U, 0x1164DC00U,
+        0xB19F4200U, 0x8A0ECE00U, 0xC6BC5A00U, 0xFD2DD600U, 0x5FD97200U, 0x6448FE00U, 0x28FA6A00U, 0x136BE600U,
+        0xEB5FD900U, 0xD0CE5500U, 0x9C7CC100U, 0xA7ED4D00U, 0x0519E900U, 0x3E886500U, 0x723AF100U, 0x49AB7D00U,
+        0x041E7400U, 0x3F8FF800U, 0x733D6C00U, 0x48ACE000U, 0xEA584400U, 0xD1C9C800U, 0x9D7B5C00U, 0xA6EAD000U,
+        0x5EDEEF00U, 0x654F6300U, 0x29FDF700U, 0x126C7B00U, 0xB098DF00U, 0x8B095300U, 0xC7BBC700U, 0xFC2A4B00U,
+        0xB9A3AA00U, 0x82322600U, 0xCE80B200U, 0xF5113E00U, 0x57E59A00U, 0x6C741600U, 0x20C68200U, 0x1B570E00U,
+        0xE3633100U, 0xD8F2BD00U, 0x94402900U, 0xAFD1A500U, 0x0D250100U, 0x36B48D00U, 0x7A061900U, 0x41979500U,
+        0x0C229C00U, 0x37B31000U, 0x7B018400U, 0x40900800U, 0xE264AC00U, 0xD9F52000U, 0x9547B400U, 0xAED63800U,
+        0x56E20700U, 0x6D738B00U, 0x21C11F00U, 0x1A509300U, 0xB8A43700U, 0x8335BB00U, 0xCF872F00U, 0xF416A300U,
+        0x54ED3D00U, 0x6F7CB100U, 0x23CE2500U, 0x185FA900U, 0xBAAB0D00U, 0x813A8100U, 0xCD881500U, 0xF6199900U,
+        0x0E2DA600U, 0x35BC2A00U, 0x790EBE00U, 0x429F3200U, 0xE06B9600U, 0xDBFA1A00U, 0x97488E00U, 0xACD90200U,
+        0xE16C0B00U, 0xDAFD8700U, 0x964F1300U, 0xADDE9F00U, 0x0F2A3B00U, 0x34BBB700U, 0x78092300U, 0x4398AF00U,
+        0xBBAC9000U, 0x803D1C00U, 0xCC8F8800U, 0xF71E0400U, 0x55EAA000U, 0x6E7B2C00U, 0x22C9B800U, 0x19583400U,
+        0xE5727F00U, 0xDEE3F300U, 0x92516700U, 0xA9C0EB00U, 0x0B344F00U, 0x30A5C300U, 0x7C175700U, 0x4786DB00U,
+        0xBFB2E400U, 0x84236800U, 0xC891FC00U, 0xF3007000U, 0x51F4D400U, 0x6A655800U, 0x26D7CC00U, 0x1D464000U,
+        0x50F34900U, 0x6B62C500U, 0x27D05100U, 0x1C41DD00U, 0xBEB57900U, 0x8524F500U, 0xC9966100U, 0xF207ED00U,
+        0x0A33D200U, 0x31A25E00U, 0x7D10CA00U, 0x46814600U, 0xE475E200U, 0xDFE46E00U, 0x9356FA00U, 0xA8C77600U,
+        0x083CE800U, 0x33AD6400U, 0x7F1FF000U, 0x448E7C00U, 0xE67AD800U, 0xDDEB5400U, 0x9159C000U, 0xAAC84C00U,
+        0x52FC7300U, 0x696DFF00U, 0x25DF6B00U, 0x1E4EE700U, 0xBCBA4300U, 0x872BCF00U, 0xCB995B00U, 0xF008D700U,
+        0xBDBDDE00U, 0x862C5200U, 0xCA9EC600U, 0xF10F4A00U, 0x53FBEE00U, 0x686A6200U, 0x24D8F600U, 0x1F497A00U,
+        0xE77D4500U, 0xDCECC900U, 0x905E5D00U, 0xABCFD100U, 0x093B7500U, 0x32AAF900U, 0x7E186D00U, 0x4589E100U
+    },
+    {
+        0x00000000U, 0xF50BAF00U, 0x6C5BA500U, 0x99500A00U, 0xD8B74A00U, 0x2DBCE500U, 0xB4ECEF00U, 0x41E74000U,
+        0x37226F00U, 0xC229C000U, 0x5B79CA00U, 0xAE726500U, 0xEF952500U, 0x1A9E8A00U, 0x83CE8000U, 0x76C52F00U,
+        0x6E44DE00U, 0x9B4F7100U, 0x021F7B00U, 0xF714D400U, 0xB6F39400U, 0x43F83B00U, 0xDAA83100U, 0x2FA39E00U,
+        0x5966B100U, 0xAC6D1E00U, 0x353D1400U, 0xC036BB00U, 0x81D1FB00U, 0x74DA5400U, 0xED8A5E00U, 0x1881F100U,
+        0xDC89BC00U, 0x29821300U, 0xB0D21900U, 0x45D9B600U, 0x043EF600U, 0xF1355900U, 0x68655300U, 0x9D6EFC00U,
+        0xEBABD300U, 0x1EA07C00U, 0x87F07600U, 0x72FBD900U, 0x331C9900U, 0xC6173600U, 0x5F473C00U, 0xAA4C9300U,
+        0xB2CD6200U, 0x47C6CD00U, 0xDE96C700U, 0x2B9D6800U, 0x6A7A2800U, 0x9F718700U, 0x06218D00U, 0xF32A2200U,
+        0x85EF0D00U, 0x70E4A200U, 0xE9B4A800U, 0x1CBF0700U, 0x5D584700U, 0xA853E800U, 0x3103E200U, 0xC4084D00U,
+        0x3F5F8300U, 0xCA542C00U, 0x53042600U, 0xA60F8900U, 0xE7E8C900U, 0x12E36600U, 0x8BB36C00U, 0x7EB8C300U,
+        0x087DEC00U, 0xFD764300U, 0x64264900U, 0x912DE600U, 0xD0CAA600U, 0x25C10900U, 0xBC910300U, 0x499AAC00U,
+        0x511B5D00U, 0xA410F200U, 0x3D40F800U, 0xC84B5700U, 0x89AC1700U, 0x7CA7B800U, 0xE5F7B200U, 0x10FC1D00U,
+        0x66393200U, 0x93329D00U, 0x0A629700U, 0xFF693800U, 0xBE8E7800U, 0x4B85D700U, 0xD2D5DD00U, 0x27DE7200U,
+        0xE3D63F00U, 0x16DD9000U, 0x8F8D9A00U, 0x7A863500U, 0x3B617500U, 0xCE6ADA00U, 0x573AD000U, 0xA2317F00U,
+        0xD4F45000U, 0x21FFFF00U, 0xB8AFF500U, 0x4DA45A00U, 0x0C431A00U, 0xF948B500U, 0x6018BF00U, 0x95131000U,
+        0x8D92E100U, 0x78994E00U, 0xE1C94400U, 0x14C2EB00U, 0x5525AB00U, 0xA02E0400U, 0x397E0E00U, 0xCC75A100U,
+        0xBAB08E00U, 0x4FBB2100U, 0xD6EB2B00U, 0x23E08400U, 0x6207C400U, 0x970C6B00U, 0x0E5C6100U, 0xFB57CE00U,
+        0x7EBF0600U, 0x8BB4A900U, 0x12E4A300U, 0xE7EF0C00U, 0xA6084C00U, 0x5303E300U, 0xCA53E900U, 0x3F584600U,
+        0x499D6900U, 0xBC96C600U, 0x25C6CC00U, 0xD0CD6300U, 0x912A2300U, 0x64218C00U, 0xFD718600U, 0x087A2900U,
+        0x10FBD800U, 0xE5F07700U, 0x7CA07D00U, 0x89ABD200U, 0xC84C9200U, 0x3D473D00U, 0xA4173700U, 0x511C9800U,
+        0x27D9B700U, 0xD2D21800U, 0x4B821200U, 0xBE89BD00U, 0xFF6EFD00U, 0x0A655200U, 0x93355800U, 0x663EF700U,
+        0xA236BA00U, 0x573D1500U, 0xCE6D1F00U, 0x3B66B000U, 0x7A81F000U, 0x8F8A5F00U, 0x16DA5500U, 0xE3D1FA00U,
+        0x9514D500U, 0x601F7A00U, 0xF94F7000U, 0x0C44DF00U, 0x4DA39F00U, 0xB8A83000U, 0x21F83A00U, 0xD4F39500U,
+        0xCC726400U, 0x3979CB00U, 0xA029C100U, 0x55226E00U, 0x14C52E00U, 0xE1CE8100U, 0x789E8B00U, 0x8D952400U,
+        0xFB500B00U, 0x0E5BA400U, 0x970BAE00U, 0x62000100U, 0x23E74100U, 0xD6ECEE00U, 0x4FBCE400U, 0xBAB74B00U,
+        0x41E08500U, 0xB4EB2A00U, 0x2DBB2000U, 0xD8B08F00U, 0x9957CF00U, 0x6C5C6000U, 0xF50C6A00U, 0x0007C500U,
+        0x76C2EA00U, 0x83C94500U, 0x1A994F00U, 0xEF92E000U, 0xAE75A000U, 0x5B7E0F00U, 0xC22E0500U, 0x3725AA00U,
+        0x2FA45B00U, 0xDAAFF400U, 0x43FFFE00U, 0xB6F45100U, 0xF7131100U, 0x0218BE00U, 0x9B48B400U, 0x6E431B00U,
+        0x18863400U, 0xED8D9B00U, 0x74DD9100U, 0x81D63E00U, 0xC0317E00U, 0x353AD100U, 0xAC6ADB00U, 0x59617400U,
+        0x9D693900U, 0x68629600U, 0xF1329C00U, 0x04393300U, 0x45DE7300U, 0xB0D5DC00U, 0x2985D600U, 0xDC8E7900U,
+        0xAA4B5600U, 0x5F40F900U, 0xC610F300U, 0x331B5C00U, 0x72FC1C00U, 0x87F7B300U, 0x1EA7B900U, 0xEBAC1600U,
+        0xF32DE700U, 0x06264800U, 0x9F764200U, 0x6A7DED00U, 0x2B9AAD00U, 0xDE910200U, 0x47C10800U, 0xB2CAA700U,
+        0xC40F8800U, 0x31042700U, 0xA8542D00U, 0x5D5F8200U, 0x1CB8C200U, 0xE9B36D00U, 0x70E36700U, 0x85E8C800U
+    }
+};
+
+static const uint32_t u32Crc32SliceTable[8][256] = {
+    {
+        0x00000000U, 0x04C11DB7U, 0x09823B6EU, 0x0D4326D9U, 0x130476DCU, 0x17C56B6BU, 0x1A864DB2U, 0x1E475005U,
+        0x2608EDB8U, 0x22C9F00FU, 0x2F8AD6D6U, 0x2B4BCB61U, 0x350C9B64U, 0x31CD86D3U, 0x3C8EA00AU, 0x384FBDBDU,
+        0x4C11DB70U, 0x48D0C6C7U, 0x4593E01EU, 0x4152FDA9U, 0x5F15ADACU, 0x5BD4B01BU, 0x569796C2U, 0x52568B75U,
+        0x6A1936C8U, 0x6ED82B7FU, 0x639B0DA6U, 0x675A1011U, 0x791D4014U, 0x7DDC5DA3U, 0x709F7B7AU, 0x745E66CDU,
+        0x9823B6E0U, 0x9CE2AB57U, 0x91A18D8EU, 0x95609039U, 0x8B27C03CU, 0x8FE6DD8BU, 0x82A5FB52U, 0x8664E6E5U,
+        0xBE2B5B58U, 0xBAEA46EFU, 0xB7A96036U, 0xB3687D81U, 0xAD2F2D84U, 0xA9EE3033U, 0xA4AD16EAU, 0xA06C0B5DU,
+        0xD4326D90U, 0xD0F37027U, 0xDDB056FEU, 0xD9714B49U, 0xC7361B4CU, 0xC3F706FBU, 0xCEB42022U, 0xCA753D95U,
+        0xF23A8028U, 0xF6FB9D9FU, 0xFBB8BB46U, 0xFF79A6F1U, 0xE13EF6F4U, 0xE5FFEB43U, 0xE8BCCD9AU, 0xEC7DD02DU,
+        0x34867077U, 0x30476DC0U, 0x3D044B19U, 0x39C556AEU, 0x278206ABU, 0x23431B1CU, 0x2E003DC5U, 0x2AC12072U,
+        0x128E9DCFU, 0x164F8078U, 0x1B0CA6A1U, 0x1FCDBB16U, 0x018AEB13U, 0x054BF6A4U, 0x0808D07DU, 0x0CC9CDCAU,
+        0x7897AB07U, 0x7C56B6B0U, 0x71159069U, 0x75D48DDEU, 0x6B93DDDBU, 0x6F52C06CU, 0x6211E6B5U, 0x66D0FB02U,
+        0x5E9F46BFU, 0x5A5E5B08U, 0x571D7DD1U, 0x53DC6066U, 0x4D9B3063U, 0x495A2DD4U, 0x44190B0DU, 0x40D816BAU,
+        0xACA5C697U, 0xA864DB20U, 0xA527FDF9U, 0xA1E6E04EU, 0xBFA1B04BU, 0xBB60ADFCU, 0xB6238B25U, 0xB2E29692U,
+        0x8AAD2B2FU, 0x8E6C3698U, 0x832F1041U, 0x87EE0DF6U, 0x99A95DF3U, 0x9D684044U, 0x902B669DU, 0x94EA7B2AU,
+        0xE0B41DE7U, 0xE4750050U, 0xE9362689U, 0xEDF73B3EU, 0xF3B06B3BU, 0xF771768CU, 0xFA325055U, 0xFEF34DE2U,
+        0xC6BCF05FU, 0xC27DEDE8U, 0xCF3ECB31U, 0xCBFFD686U, 0xD5B88683U, 0xD1799B34U, 0xDC3ABDEDU, 0xD8FBA05AU,
+        0x690CE0EEU, 0x6DCDFD59U, 0x608EDB80U, 0x644FC637U, 0x7A089632U, 0x7EC98B85U, 0x738AAD5CU, 0x774BB0EBU,
+        0x4F040D56U, 0x4BC510E1U, 0x46863638U, 0x42472B8FU, 0x5C007B8AU, 0x58C1663DU, 0x558240E4U, 0x51435D53U,
+        0x251D3B9EU, 0x21DC2629U, 0x2C9F00F0U, 0x285E1D47U, 0x36194D42U, 0x32D850F5U, 0x3F9B762CU, 0x3B5A6B9BU,
+        0x0315D626U, 0x07D4CB91U, 0x0A97ED48U, 0x0E56F0FFU, 0x1011A0FAU, 0x14D0BD4DU, 0x19939B94U, 0x1D528623U,
+        0xF12F560EU, 0xF5EE4BB9U, 0xF8AD6D60U, 0xFC6C70D7U, 0xE22B20D2U, 0xE6EA3D65U, 0xEBA91BBCU, 0xEF68060BU,
+        0xD727BBB6U, 0xD3E6A601U, 0xDEA580D8U, 0xDA649D6FU, 0xC423CD6AU, 0xC0E2D0DDU, 0xCDA1F604U, 0xC960EBB3U,
+        0xBD3E8D7EU, 0xB9FF90C9U, 0xB4BCB610U, 0xB07DABA7U, 0xAE3AFBA2U, 0xAAFBE615U, 0xA7B8C0CCU, 0xA379DD7BU,
+        0x9B3660C6U, 0x9FF77D71U, 0x92B45BA8U, 0x9675461FU, 0x8832161AU, 0x8CF30BADU, 0x81B02D74U, 0x857130C3U,
+        0x5D8A9099U, 0x594B8D2EU, 0x5408ABF7U, 0x50C9B640U, 0x4E8EE645U, 0x4A4FFBF2U, 0x470CDD2BU, 0x43CDC09CU,
+        0x7B827D21U, 0x7F436096U, 0x7200464FU, 0x76C15BF8U, 0x68860BFDU, 0x6C47164AU, 0x61043093U, 0x65C52D24U,
+        0x119B4BE9U, 0x155A565EU, 0x18197087U, 0x1CD86D30U, 0x029F3D35U, 0x065E2082U, 0x0B1D065BU, 0x0FDC1BECU,
+        0x3793A651U, 0x3352BBE6U, 0x3E119D3FU, 0x3AD08088U, 0x2497D08DU, 0x2056CD3AU, 0x2D15EBE3U, 0x29D4F654U,
+        0xC5A92679U, 0xC1683BCEU, 0xCC2B1D17U, 0xC8EA00A0U, 0xD6AD50A5U, 0xD26C4D12U, 0xDF2F6BCBU, 0xDBEE767CU,
+        0xE3A1CBC1U, 0xE760D676U, 0xEA23F0AFU, 0xEEE2ED18U, 0xF0A5BD1DU, 0xF464A0AAU, 0xF9278673U, 0xFDE69BC4U,
+        0x89B8FD09U, 0x8D79E0BEU, 0x803AC667U, 0x84FBDBD0U, 0x9ABC8BD5U, 0x9E7D9662U, 0x933EB0BBU, 0x97FFAD0CU,
+        0xAFB010B1U, 0xAB710D06U, 0xA6322BDFU, 0xA2F33668U, 0xBCB4666DU, 0xB8757BDAU, 0xB5365D03U, 0xB1F740B4U
+    },
+    {
+        0x00000000U, 0xD219C1DCU, 0xA0F29E0FU, 0x72EB5FD3U, 0x452421A9U, 0x973DE075U, 0xE5D6BFA6U, 0x37CF7E7AU,
+        0x8A484352U, 0x5851828EU, 0x2ABADD5DU, 0xF8A31C81U, 0xCF6C62FBU, 0x1D75A327U, 0x6F9EFCF4U, 0xBD873D28U,
+        0x10519B13U, 0xC2485ACFU, 0xB0A3051CU, 0x62BAC4C0U, 0x5575BABAU, 0x876C7B66U, 0xF58724B5U, 0x279EE569U,
+        0x9A19D841U, 0x4800199DU, 0x3AEB464EU, 0xE8F28792U, 0xDF3DF9E8U, 0x0D243834U, 0x7FCF67E7U, 0xADD6A63BU,
+        0x20A33626U, 0xF2BAF7FAU, 0x8051A829U, 0x524869F5U, 0x6587178FU, 0xB79ED653U, 0xC5758980U, 0x176C485CU,
+        0xAAEB7574U, 0x78F2B4A8U, 0x0A19EB7BU, 0xD8002AA7U, 0xEFCF54DDU, 0x3DD69501U, 0x4F3DCAD2U, 0x9D240B0EU,
+        0x30F2AD35U, 0xE2EB6CE9U, 0x9000333AU, 0x4219F2E6U, 0x75D68C9CU, 0xA7CF4D40U, 0xD5241293U, 0x073DD34FU,
+        0xBABAEE67U, 0x68A32FBBU, 0x1A487068U, 0xC851B1B4U, 0xFF9ECFCEU, 0x2D870E12U, 0x5F6C51C1U, 0x8D75901DU,
+        0x41466C4CU, 0x935FAD90U, 0xE1B4F243U, 0x33AD339FU, 0x04624DE5U, 0xD67B8C39U, 0xA490D3EAU, 0x76891236U,
+        0xCB0E2F1EU, 0x1917EEC2U, 0x6BFCB111U, 0xB9E570CDU, 0x8E2A0EB7U, 0x5C33CF6BU, 0x2ED890B8U, 0xFCC15164U,
+        0x5117F75FU, 0x830E3683U, 0xF1E56950U, 0x23FCA88CU, 0x1433D6F6U, 0xC62A172AU, 0xB4C148F9U, 0x66D88925U,
+        0xDB5FB40DU, 0x094675D1U, 0x7BAD2A02U, 0xA9B4EBDEU, 0x9E7B95A4U, 0x4C625478U, 0x3E890BABU, 0xEC90CA77U,
+        0x61E55A6AU, 0xB3FC9BB6U, 0xC117C465U, 0x130E05B9U, 0x24C17BC3U, 0xF6D8BA1FU, 0x8433E5CCU, 0x562A2410U,
+        0xEBAD1938U, 0x39B4D8E4U, 0x4B5F8737U, 0x994646EBU, 0xAE893891U, 0x7C90F94DU, 0x0E7BA69EU, 0xDC626742U,
+        0x71B4C179U, 0xA3AD00A5U, 0xD1465F76U, 0x035F9EAAU, 0x3490E0D0U, 0xE689210CU, 0x94627EDFU, 0x467BBF03U,
+        0xFBFC822BU, 0x29E543F7U, 0x5B0E1C24U, 0x8917DDF8U, 0xBED8A382U, 0x6CC1625EU, 0x1E2A3D8DU, 0xCC33FC51U,
+        0x828CD898U, 0x50951944U, 0x227E4697U, 0xF067874BU, 0xC7A8F931U, 0x15B138EDU, 0x675A673EU, 0xB543A6E2U,
+        0x08C49BCAU, 0xDADD5A16U, 0xA83605C5U, 0x7A2FC419U, 0x4DE0BA63U, 0x9FF97BBFU, 0xED12246CU, 0x3F0BE5B0U,
+        0x92DD438BU, 0x40C48257U, 0x322FDD84U, 0xE0361C58U, 0xD7F96222U, 0x05E0A3FEU, 0x770BFC2DU, 0xA5123DF1U,
+        0x189500D9U, 0xCA8CC105U, 0xB8679ED6U, 0x6A7E5F0AU, 0x5DB12170U, 0x8FA8E0ACU, 0xFD43BF7FU, 0x2F5A7EA3U,
+        0xA22FEEBEU, 0x70362F62U, 0x02DD70B1U, 0xD0C4B16DU, 0xE70BCF17U, 0x35120ECBU, 0x47F95118U, 0x95E090C4U,
+        0x2867ADECU, 0xFA7E6C30U, 0x889533E3U, 0x5A8CF23FU, 0x6D438C45U, 0xBF5A4D99U, 0xCDB1124AU, 0x1FA8D396U,
+        0xB27E75ADU, 0x6067B471U, 0x128CEBA2U, 0xC0952A7EU, 0xF75A5404U, 0x254395D8U, 0x57A8CA0BU, 0x85B10BD7U,
+        0x383636FFU, 0xEA2FF723U, 0x98C4A8F0U, 0x4ADD692CU, 0x7D121756U, 0xAF0BD68AU, 0xDDE08959U, 0x0FF94885U,
+        0xC3CAB4D4U, 0x11D37508U, 0x63382ADBU, 0xB121EB07U, 0x86EE957DU, 0x54F754A1U, 0x261C0B72U, 0xF405CAAEU,
+        0x4982F786U, 0x9B9B365AU, 0xE9706989U, 0x3B69A855U, 0x0CA6D62FU, 0xDEBF17F3U, 0xAC544820U, 0x7E4D89FCU,
+        0xD39B2FC7U, 0x0182EE1BU, 0x7369B1C8U, 0xA1707014U, 0x96BF0E6EU, 0x44A6CFB2U, 0x364D9061U, 0xE45451BDU,
+        0x59D36C95U, 0x8BCAAD49U, 0xF921F29AU, 0x2B383346U, 0x1CF74D3CU, 0xCEEE8CE0U, 0xBC05D333U, 0x6E1C12EFU,
+        0xE36982F2U, 0x3170432EU, 0x439B1CFDU, 0x9182DD21U, 0xA64DA35BU, 0x74546287U, 0x06BF3D54U, 0xD4A6FC88U,
+        0x6921C1A0U, 0xBB38007CU, 0xC9D35FAFU, 0x1BCA9E73U, 0x2C05E009U, 0xFE1C21D5U, 0x8CF77E06U, 0x5EEEBFDAU,
+        0xF33819E1U, 0x2121D83DU, 0x53CA87EEU, 0x81D34632U, 0xB61C3848U, 0x6405F994U, 0x16EEA647U, 0xC4F7679BU,
+        0x79705AB3U, 0xAB699B6FU, 0xD982C4BCU, 0x0B9B0560U, 0x3C547B1AU, 0xEE4DBAC6U, 0x9CA6E515U, 0x4EBF24C9U
+    },
+    {
+        0x00000000U, 0x01D8AC87U, 0x03B1590EU, 0x0269F589U, 0x0762B21CU, 0x06BA1E9BU, 0x04D3EB12U, 0x050B4795U,
+        0x0EC56438U, 0x0F1DC8BFU, 0x0D743D36U, 0x0CAC91B1U, 0x09A7D624U, 0x087F7AA3U, 0x0A168F2AU, 0x0BCE23ADU,
+        0x1D8AC870U, 0x1C5264F7U, 0x1E3B917EU, 0x1FE33DF9U, 0x1AE87A6CU, 0x1B30D6EBU, 0x19592362U, 0x18818FE5U,
+        0x134FAC48U, 0x129700CFU, 0x10FEF546U, 0x112659C1U, 0x142D1E54U, 0x15F5B2D3U, 0x179C475AU, 0x1644EBDDU,
+        0x3B1590E0U, 0x3ACD3C67U, 0x38A4C9EEU, 0x397C6569U, 0x3C7722FCU, 0x3DAF8E7BU, 0x3FC67BF2U, 0x3E1ED775U,
+        0x35D0F4D8U, 0x3408585FU, 0x3661ADD6U, 0x37B90151U, 0x32B246C4U, 0x336AEA43U, 0x31031FCAU, 0x30DBB34DU,
+        0x269F5890U, 0x2747F417U, 0x252E019EU, 0x24F6AD19U, 0x21FDEA8CU, 0x2025460BU, 0x224CB382U, 0x23941F05U,
+        0x285A3CA8U, 0x2982902FU, 0x2BEB65A6U, 0x2A33C921U, 0x2F388EB4U, 0x2EE02233U, 0x2C89D7BAU, 0x2D517B3DU,
+        0x762B21C0U, 0x77F38D47U, 0x759A78CEU, 0x7442D449U, 0x714993DCU, 0x70913F5BU, 0x72F8CAD2U, 0x73206655U,
+        0x78EE45F8U, 0x7936E97FU, 0x7B5F1CF6U, 0x7A87B071U, 0x7F8CF7E4U, 0x7E545B63U, 0x7C3DAEEAU, 0x7DE5026DU,
+        0x6BA1E9B0U, 0x6A794537U, 0x6810B0BEU, 0x69C81C39U, 0x6CC35BACU, 0x6D1BF72BU, 0x6F7202A2U, 0x6EAAAE25U,
+        0x65648D88U, 0x64BC210FU, 0x66D5D486U, 0x670D7801U, 0x62063F94U, 0x63DE9313U, 0x61B7669AU, 0x606FCA1DU,
+        0x4D3EB120U, 0x4CE61DA7U, 0x4E8FE82EU, 0x4F5744A9U, 0x4A5C033CU, 0x4B84AFBBU, 0x49ED5A32U, 0x4835F6B5U,
+        0x43FBD518U, 0x4223799FU, 0x404A8C16U, 0x41922091U, 0x44996704U, 0x4541CB83U, 0x47283E0AU, 0x46F0928DU,
+        0x50B47950U, 0x516CD5D7U, 0x5305205EU, 0x52DD8CD9U, 0x57D6CB4CU, 0x560E67CBU, 0x54679242U, 0x55BF3EC5U,
+        0x5E711D68U, 0x5FA9B1EFU, 0x5DC04466U, 0x5C18E8E1U, 0x5913AF74U, 0x58CB03F3U, 0x5AA2F67AU, 0x5B7A5AFDU,
+        0xEC564380U, 0xED8EEF07U, 0xEFE71A8EU, 0xEE3FB609U, 0xEB34F19CU, 0xEAEC5D1BU, 0xE885A892U, 0xE95D0415U,
+        0xE29327B8U, 0xE34B8B3FU, 0xE1227EB6U, 0xE0FAD231U, 0xE5F195A4U, 0xE4293923U, 0xE640CCAAU, 0xE798602DU,
+        0xF1DC8BF0U, 0xF0042777U, 0xF26DD2FEU, 0xF3B57E79U, 0xF6BE39ECU, 0xF766956BU, 0xF50F60E2U, 0xF4D7CC65U,
+        0xFF19EFC8U, 0xFEC1434FU, 0xFCA8B6C6U, 0xFD701A41U, 0xF87B5DD4U, 0xF9A3F153U, 0xFBCA04DAU, 0xFA12A85DU,
+        0xD743D360U, 0xD69B7FE7U, 0xD4F28A6EU, 0xD52A26E9U, 0xD021617CU, 0xD1F9CDFBU, 0xD3903872U, 0xD24894F5U,
+        0xD986B758U, 0xD85E1BDFU, 0xDA37EE56U, 0xDBEF42D1U, 0xDEE40544U, 0xDF3CA9C3U, 0xDD555C4AU, 0xDC8DF0CDU,
+        0xCAC91B10U, 0xCB11B797U, 0xC978421EU, 0xC8A0EE99U, 0xCDABA90CU, 0xCC73058BU, 0xCE1AF002U, 0xCFC25C85U,
+        0xC40C7F28U, 0xC5D4D3AFU, 0xC7BD2626U, 0xC6658AA1U, 0xC36ECD34U, 0xC2B661B3U, 0xC0DF943AU, 0xC10738BDU,
+        0x9A7D6240U, 0x9BA5CEC7U, 0x99CC3B4EU, 0x981497C9U, 0x9D1FD05CU, 0x9CC77CDBU, 0x9EAE8952U, 0x9F7625D5U,
+        0x94B80678U, 0x9560AAFFU, 0x97095F76U, 0x96D1F3F1U, 0x93DAB464U, 0x920218E3U, 0x906BED6AU, 0x91B341EDU,
+        0x87F7AA30U, 0x862F06B7U, 0x8446F33EU, 0x859E5FB9U, 0x8095182CU, 0x814DB4ABU, 0x83244122U, 0x82FCEDA5U,
+        0x8932CE08U, 0x88EA628FU, 0x8A839706U, 0x8B5B3B81U, 0x8E507C14U, 0x8F88D093U, 0x8DE1251AU, 0x8C39899DU,
+        0xA168F2A0U, 0xA0B05E27U, 0xA2D9ABAEU, 0xA3010729U, 0xA60A40BCU, 0xA7D2EC3BU, 0xA5BB19B2U, 0xA463B535U,
+        0xAFAD9698U, 0xAE753A1FU, 0xAC1CCF96U, 0xADC46311U, 0xA8CF2484U, 0xA9178803U, 0xAB7E7D8AU, 0xAAA6D10DU,
+        0xBCE23AD0U, 0xBD3A9657U, 0xBF5363DEU, 0xBE8BCF59U, 0xBB8088CCU, 0xBA58244BU, 0xB831D1C2U, 0xB9E97D45U,
+        0xB2275EE8U, 0xB3FFF26FU, 0xB19607E6U, 0xB04EAB61U, 0xB545ECF4U, 0xB49D4073U, 0xB6F4B5FAU, 0xB72C197DU
+    },
+    {
+        0x00000000U, 0xDC6D9AB7U, 0xBC1A28D9U, 0x6077B26EU, 0x7CF54C05U, 0xA098D6B2U, 0xC0EF64DCU, 0x1C82FE6BU,
+        0xF9EA980AU, 0x258702BDU, 0x45F0B0D3U, 0x999D2A64U, 0x851FD40FU, 0x59724EB8U, 0x3905FCD6U, 0xE5686661U,
+        0xF7142DA3U, 0x2B79B714U, 0x4B0E057AU, 0x97639FCDU, 0x8BE161A6U, 0x578CFB11U, 0x37FB497FU, 0xEB96D3C8U,
+        0x0EFEB5A9U, 0xD2932F1EU, 0xB2E49D70U, 0x6E8907C7U, 0x720BF9ACU, 0xAE66631BU, 0xCE11D175U, 0x127C4BC2U,
+        0xEAE946F1U, 0x3684DC46U, 0x56F36E28U, 0x8A9EF49FU, 0x961C0AF4U, 0x4A719043U, 0x2A06222DU, 0xF66BB89AU,
+        0x1303DEFBU, 0xCF6E444CU, 0xAF19F622U, 0x73746C95U, 0x6FF692FEU, 0xB39B0849U, 0xD3ECBA27U, 0x0F812090U,
+        0x1DFD6B52U, 0xC190F1E5U, 0xA1E7438BU, 0x7D8AD93CU, 0x61082757U, 0xBD65BDE0U, 0xDD120F8EU, 0x017F9539U,
+        0xE417F358U, 0x387A69EFU, 0x580DDB81U, 0x84604136U, 0x98E2BF5DU, 0x448F25EAU, 0x24F89784U, 0xF8950D33U,
+        0xD1139055U, 0x0D7E0AE2U, 0x6D09B88CU, 0xB164223BU, 0xADE6DC50U, 0x718B46E7U, 0x11FCF489U, 0xCD916E3EU,
+        0x28F9085FU, 0xF49492E8U, 0x94E32086U, 0x488EBA31U, 0x540C445AU, 0x8861DEEDU, 0xE8166C83U, 0x347BF634U,
+        0x2607BDF6U, 0xFA6A2741U, 0x9A1D952FU, 0x46700F98U, 0x5AF2F1F3U, 0x869F6B44U, 0xE6E8D92AU, 0x3A85439DU,
+        0xDFED25FCU, 0x0380BF4BU, 0x63F70D25U, 0xBF9A9792U, 0xA31869F9U, 0x7F75F34EU, 0x1F024120U, 0xC36FDB97U,
+        0x3BFAD6A4U, 0xE7974C13U, 0x87E0FE7DU, 0x5B8D64CAU, 0x470F9AA1U, 0x9B620016U, 0xFB15B278U, 0x277828CFU,
+        0xC2104EAEU, 0x1E7DD419U, 0x7E0A6677U, 0xA267FCC0U, 0xBEE502ABU, 0x6288981CU, 0x02FF2A72U, 0xDE92B0C5U,
+        0xCCEEFB07U, 0x108361B0U, 0x70F4D3DEU, 0xAC994969U, 0xB01BB702U, 0x6C762DB5U, 0x0C019FDBU, 0xD06C056CU,
+        0x3504630DU, 0xE969F9BAU, 0x891E4BD4U, 0x5573D163U, 0x49F12F08U, 0x959CB5BFU, 0xF5EB07D1U, 0x29869D66U,
+        0xA6E63D1DU, 0x7A8BA7AAU, 0x1AFC15C4U, 0xC6918F73U, 0xDA137118U, 0x067EEBAFU, 0x660959C1U, 0xBA64C376U,
+        0x5F0CA517U, 0x83613FA0U, 0xE3168DCEU, 0x3F7B1779U, 0x23F9E912U, 0xFF9473A5U, 0x9FE3C1CBU, 0x438E5B7CU,
+        0x51F210BEU, 0x8D9F8A09U, 0xEDE83867U, 0x3185A2D0U, 0x2D075CBBU, 0xF16AC60CU, 0x911D7462U, 0x4D70EED5U,
+        0xA81888B4U, 0x74751203U, 0x1402A06DU, 0xC86F3ADAU, 0xD4EDC4B1U, 0x08805E06U, 0x68F7EC68U, 0xB49A76DFU,
+        0x4C0F7BECU, 0x9062E15BU, 0xF0155335U, 0x2C78C982U, 0x30FA37E9U, 0xEC97AD5EU, 0x8CE01F30U, 0x508D8587U,
+        0xB5E5E3E6U, 0x69887951U, 0x09FFCB3FU, 0xD5925188U, 0xC910AFE3U, 0x157D3554U, 0x750A873AU, 0xA9671D8DU,
+        0xBB1B564FU, 0x6776CCF8U, 0x07017E96U, 0xDB6CE421U, 0xC7EE1A4AU, 0x1B8380FDU, 0x7BF43293U, 0xA799A824U,
+        0x42F1CE45U, 0x9E9C54F2U, 0xFEEBE69CU, 0x22867C2BU, 0x3E048240U, 0xE26918F7U, 0x821EAA99U, 0x5E73302EU,
+        0x77F5AD48U, 0xAB9837FFU, 0xCBEF8591U, 0x17821F26U, 0x0B00E14DU, 0xD76D7BFAU, 0xB71AC994U, 0x6B775323U,
+        0x8E1F3542U, 0x5272AFF5U, 0x32051D9BU, 0xEE68872CU, 0xF2EA7947U, 0x2E87E3F0U, 0x4EF0519EU, 0x929DCB29U,
+        0x80E180EBU, 0x5C8C1A5CU, 0x3CFBA832U, 0xE0963285U, 0xFC14CCEEU, 0x20795659U, 0x400EE437U, 0x9C637E80U,
+        0x790B18E1U, 0xA5668256U, 0xC5113038U, 0x197CAA8FU, 0x05FE54E4U, 0xD993CE53U, 0xB9E47C3DU, 0x6589E68AU,
+        0x9D1CEBB9U, 0x4171710EU, 0x2106C360U, 0xFD6B59D7U, 0xE1E9A7BCU, 0x3D843D0BU, 0x5DF38F65U, 0x819E15D2U,
+        0x64F673B3U, 0xB89BE904U, 0xD8EC5B6AU, 0x0481C1DDU, 0x18033FB6U, 0xC46EA501U, 0xA419176FU, 0x78748DD8U,
+        0x6A08C61AU, 0xB6655CADU, 0xD612EEC3U, 0x0A7F7474U, 0x16FD8A1FU, 0xCA9010A8U, 0xAAE7A2C6U, 0x768A3871U,
+        0x93E25E10U, 0x4F8FC4A7U, 0x2FF876C9U, 0xF395EC7EU, 0xEF171215U, 0x337A88A2U, 0x530D3ACCU, 0x8F60A07BU
+    },
+    {
+        0x00000000U, 0x490D678DU, 0x921ACF1AU, 0xDB17A897U, 0x20F48383U, 0x69F9E40EU, 0xB2EE4C99U, 0xFBE32B14U,
+        0x41E90706U, 0x08E4608BU, 0xD3F3C81CU, 0x9AFEAF91U, 0x611D8485U, 0x2810E308U, 0xF3074B9FU, 0xBA0A2C12U,
+        0x83D20E0CU, 0xCADF6981U, 0x11C8C116U, 0x58C5A69BU, 0xA3268D8FU, 0xEA2BEA02U, 0x313C4295U, 0x78312518U,
+        0xC23B090AU, 0x8B366E87U, 0x5021C610U, 0x192CA19DU, 0xE2CF8A89U, 0xABC2ED04U, 0x70D54593U, 0x39D8221EU,
+        0x036501AFU, 0x4A686622U, 0x917FCEB5U, 0xD872A938U, 0x2391822CU, 0x6A9CE5A1U, 0xB18B4D36U, 0xF8862ABBU,
+        0x428C06A9U, 0x0B816124U, 0xD096C9B3U, 0x999BAE3EU, 0x6278852AU, 0x2B75E2A7U, 0xF0624A30U, 0xB96F2DBDU,
+        0x80B70FA3U, 0xC9BA682EU, 0x12ADC0B9U, 0x5BA0A734U, 0xA0438C20U, 0xE94EEBADU, 0x3259433AU, 0x7B5424B7U,
+        0xC15E08A5U, 0x88536F28U, 0x5344C7BFU, 0x1A49A032U, 0xE1AA8B26U, 0xA8A7ECABU, 0x73B0443CU, 0x3ABD23B1U,
+        0x06CA035EU, 0x4FC764D3U, 0x94D0CC44U, 0xDDDDABC9U, 0x263E80DDU, 0x6F33E750U, 0xB4244FC7U, 0xFD29284AU,
+        0x47230458U, 0x0E2E63D5U, 0xD539CB42U, 0x9C34ACCFU, 0x67D787DBU, 0x2EDAE056U, 0xF5CD48C1U, 0xBCC02F4CU,
+        0x85180D52U, 0xCC156ADFU, 0x1702C248U, 0x5E0FA5C5U, 0xA5EC8ED1U, 0xECE1E95CU, 0x37F641CBU, 0x7EFB2646U,
+        0xC4F10A54U, 0x8DFC6DD9U, 0x56EBC54EU, 0x1FE6A2C3U, 0xE40589D7U, 0xAD08EE5AU, 0x761F46CDU, 0x3F122140U,
+        0x05AF02F1U, 0x4CA2657CU, 0x97B5CDEBU, 0xDEB8AA66U, 0x255B8172U, 0x6C56E6FFU, 0xB7414E68U, 0xFE4C29E5U,
+        0x444605F7U, 0x0D4B627AU, 0xD65CCAEDU, 0x9F51AD60U, 0x64B28674U, 0x2DBFE1F9U, 0xF6A8496EU, 0xBFA52EE3U,
+        0x867D0CFDU, 0xCF706B70U, 0x1467C3E7U, 0x5D6AA46AU, 0xA6898F7EU, 0xEF84E8F3U, 0x34934064U, 0x7D9E27E9U,
+        0xC7940BFBU, 0x8E996C76U, 0x558EC4E1U, 0x1C83A36CU, 0xE7608878U, 0xAE6DEFF5U, 0x757A4762U, 0x3C7720EFU,
+        0x0D9406BCU, 0x44996131U, 0x9F8EC9A6U, 0xD683AE2BU, 0x2D60853FU, 0x646DE2B2U, 0xBF7A4A25U, 0xF6772DA8U,
+        0x4C7D01BAU, 0x05706637U, 0xDE67CEA0U, 0x976AA92DU, 0x6C898239U, 0x2584E5B4U, 0xFE934D23U, 0xB79E2AAEU,
+        0x8E4608B0U, 0xC74B6F3DU, 0x1C5CC7AAU, 0x5551A027U, 0xAEB28B33U, 0xE7BFECBEU, 0x3CA84429U, 0x75A523A4U,
+        0xCFAF0FB6U, 0x86A2683BU, 0x5DB5C0ACU, 0x14B8A721U, 0xEF5B8C35U, 0xA656EBB8U, 0x7D41432FU, 0x344C24A2U,
+        0x0EF10713U, 0x47FC609EU, 0x9CEBC809U, 0xD5E6AF84U, 0x2E058490U, 0x6708E31DU, 0xBC1F4B8AU, 0xF5122C07U,
+        0x4F180015U, 0x06156798U, 0xDD02CF0FU, 0x940FA882U, 0x6FEC8396U, 0x26E1E41BU, 0xFDF64C8CU, 0xB4FB2B01U,
+        0x8D23091FU, 0xC42E6E92U, 0x1F39C605U, 0x5634A188U, 0xADD78A9CU, 0xE4DAED11U, 0x3FCD4586U, 0x76C0220BU,
+        0xCCCA0E19U, 0x85C76994U, 0x5ED0C103U, 0x17DDA68EU, 0xEC3E8D9AU, 0xA533EA17U, 0x7E244280U, 0x3729250DU,
+        0x0B5E05E2U, 0x4253626FU, 0x9944CAF8U, 0xD049AD75U, 0x2BAA8661U, 0x62A7E1ECU, 0xB9B0497BU, 0xF0BD2EF6U,
+        0x4AB702E4U, 0x03BA6569U, 0xD8ADCDFEU, 0x91A0AA73U, 0x6A438167U, 0x234EE6EAU, 0xF8594E7DU, 0xB15429F0U,
+        0x888C0BEEU, 0xC1816C63U, 0x1A96C4F4U, 0x539BA379U, 0xA878886DU, 0xE175EFE0U, 0x3A624777U, 0x736F20FAU,
+        0xC9650CE8U, 0x80686B65U, 0x5B7FC3F2U, 0x1272A47FU, 0xE9918F6BU, 0xA09CE8E6U, 0x7B8B4071U, 0x328627FCU,
+        0x083B044DU, 0x413663C0U, 0x9A21CB57U, 0xD32CACDAU, 0x28CF87CEU, 0x61C2E043U, 0xBAD548D4U, 0xF3D82F59U,
+        0x49D2034BU, 0x00DF64C6U, 0xDBC8CC51U, 0x92C5ABDCU, 0x692680C8U, 0x202BE745U, 0xFB3C4FD2U, 0xB231285FU,
+        0x8BE90A41U, 0xC2E46DCCU, 0x19F3C55BU, 0x50FEA2D6U, 0xAB1D89C2U, 0xE210EE4FU, 0x390746D8U, 0x700A2155U,
+        0xCA000D47U, 0x830D6ACAU, 0x581AC25DU, 0x1117A5D0U, 0xEAF48EC4U, 0xA3F9E949U, 0x78EE41DEU, 0x31E32653U
+    },
+    {
+        0x00000000U, 0x1B280D78U, 0x36501AF0U, 0x2D781788U, 0x6CA035E0U, 0x77883898U, 0x5AF02F10U, 0x41D82268U,
+        0xD9406BC0U, 0xC26866B8U, 0xEF107130U, 0xF4387C48U, 0xB5E05E20U, 0xAEC85358U, 0x83B044D0U, 0x989849A8U,
+        0xB641CA37U, 0xAD69C74FU, 0x8011D0C7U, 0x9B39DDBFU, 0xDAE1FFD7U, 0xC1C9F2AFU, 0xECB1E527U, 0xF799E85FU,
+        0x6F01A1F7U, 0x7429AC8FU, 0x5951BB07U, 0x4279B67FU, 0x03A19417U, 0x1889996FU, 0x35F18EE7U, 0x2ED9839FU,
+        0x684289D9U, 0x736A84A1U, 0x5E129329U, 0x453A9E51U, 0x04E2BC39U, 0x1FCAB141U, 0x32B2A6C9U, 0x299AABB1U,
+        0xB102E219U, 0xAA2AEF61U, 0x8752F8E9U, 0x9C7AF591U, 0xDDA2D7F9U, 0xC68ADA81U, 0xEBF2CD09U, 0xF0DAC071U,
+        0xDE0343EEU, 0xC52B4E96U, 0xE853591EU, 0xF37B5466U, 0xB2A3760EU, 0xA98B7B76U, 0x84F36CFEU, 0x9FDB6186U,
+        0x0743282EU, 0x1C6B2556U, 0x311332DEU, 0x2A3B3FA6U, 0x6BE31DCEU, 0x70CB10B6U, 0x5DB3073EU, 0x469B0A46U,
+        0xD08513B2U, 0xCBAD1ECAU, 0xE6D50942U, 0xFDFD043AU, 0xBC252652U, 0xA70D2B2AU, 0x8A753CA2U, 0x915D31DAU,
+        0x09C57872U, 0x12ED750AU, 0x3F956282U, 0x24BD6FFAU, 0x65654D92U, 0x7E4D40EAU, 0x53355762U, 0x481D5A1AU,
+        0x66C4D985U, 0x7DECD4FDU, 0x5094C375U, 0x4BBCCE0DU, 0x0A64EC65U, 0x114CE11DU, 0x3C34F695U, 0x271CFBEDU,
+        0xBF84B245U, 0xA4ACBF3DU, 0x89D4A8B5U, 0x92FCA5CDU, 0xD32487A5U, 0xC80C8ADDU, 0xE5749D55U, 0xFE5C902DU,
+        0xB8C79A6BU, 0xA3EF9713U, 0x8E97809BU, 0x95BF8DE3U, 0xD467AF8BU, 0xCF4FA2F3U, 0xE237B57BU, 0xF91FB803U,
+        0x6187F1ABU, 0x7AAFFCD3U, 0x57D7EB5BU, 0x4CFFE623U, 0x0D27C44BU, 0x160FC933U, 0x3B77DEBBU, 0x205FD3C3U,
+        0x0E86505CU, 0x15AE5D24U, 0x38D64AACU, 0x23FE47D4U, 0x622665BCU, 0x790E68C4U, 0x54767F4CU, 0x4F5E7234U,
+        0xD7C63B9CU, 0xCCEE36E4U, 0xE196216CU, 0xFABE2C14U, 0xBB660E7CU, 0xA04E0304U, 0x8D36148CU, 0x961E19F4U,
+        0xA5CB3AD3U, 0xBEE337ABU, 0x939B2023U, 0x88B32D5BU, 0xC96B0F33U, 0xD243024BU, 0xFF3B15C3U, 0xE41318BBU,
+        0x7C8B5113U, 0x67A35C6BU, 0x4ADB4BE3U, 0x51F3469BU, 0x102B64F3U, 0x0B03698BU, 0x267B7E03U, 0x3D53737BU,
+        0x138AF0E4U, 0x08A2FD9CU, 0x25DAEA14U, 0x3EF2E76CU, 0x7F2AC504U, 0x6402C87CU, 0x497ADFF4U, 0x5252D28CU,
+        0xCACA9B24U, 0xD1E2965CU, 0xFC9A81D4U, 0xE7B28CACU, 0xA66AAEC4U, 0xBD42A3BCU, 0x903AB434U, 0x8B12B94CU,
+        0xCD89B30AU, 0xD6A1BE72U, 0xFBD9A9FAU, 0xE0F1A482U, 0xA12986EAU, 0xBA018B92U, 0x97799C1AU, 0x8C519162U,
+        0x14C9D8CAU, 0x0FE1D5B2U, 0x2299C23AU, 0x39B1CF42U, 0x7869ED2AU, 0x6341E052U, 0x4E39F7DAU, 0x5511FAA2U,
+        0x7BC8793DU, 0x60E07445U, 0x4D9863CDU, 0x56B06EB5U, 0x17684CDDU, 0x0C4041A5U, 0x2138562DU, 0x3A105B55U,
+        0xA28812FDU, 0xB9A01F85U, 0x94D8080DU, 0x8FF00575U, 0xCE28271DU, 0xD5002A65U, 0xF8783DEDU, 0xE3503095U,
+        0x754E2961U, 0x6E662419U, 0x431E3391U, 0x58363EE9U, 0x19EE1C81U, 0x02C611F9U, 0x2FBE0671U, 0x34960B09U,
+        0xAC0E42A1U, 0xB7264FD9U, 0x9A5E5851U, 0x81765529U, 0xC0AE7741U, 0xDB867A39U, 0xF6FE6DB1U, 0xEDD660C9U,
+        0xC30FE356U, 0xD827EE2EU, 0xF55FF9A6U, 0xEE77F4DEU, 0xAFAFD6B6U, 0xB487DBCEU, 0x99FFCC46U, 0x82D7C13EU,
+        0x1A4F8896U, 0x016785EEU, 0x2C1F9266U, 0x37379F1EU, 0x76EFBD76U, 0x6DC7B00EU, 0x40BFA786U, 0x5B97AAFEU,
+        0x1D0CA0B8U, 0x0624ADC0U, 0x2B5CBA48U, 0x3074B730U, 0x71AC9558U, 0x6A849820U, 0x47FC8FA8U, 0x5CD482D0U,
+        0xC44CCB78U, 0xDF64C600U, 0xF21CD188U, 0xE934DCF0U, 0xA8ECFE98U, 0xB3C4F3E0U, 0x9EBCE468U, 0x8594E910U,
+        0xAB4D6A8FU, 0xB06567F7U, 0x9D1D707FU, 0x86357D07U, 0xC7ED5F6FU, 0xDCC55217U, 0xF1BD459FU, 0xEA9548E7U,
+        0x720D014FU, 0x69250C37U, 0x445D1BBFU, 0x5F7516C7U, 0x1EAD34AFU, 0x058539D7U, 0x28FD2E5FU, 0x33D52327U
+    },
+    {
+        0x00000000U, 0x4F576811U, 0x9EAED022U, 0xD1F9B833U, 0x399CBDF3U, 0x76CBD5E2U, 0xA7326DD1U, 0xE86505C0U,
+        0x73397BE6U, 0x3C6E13F7U, 0xED97ABC4U, 0xA2C0C3D5U, 0x4AA5C615U, 0x05F2AE04U, 0xD40B1637U, 0x9B5C7E26U,
+        0xE672F7CCU, 0xA9259FDDU, 0x78DC27EEU, 0x378B4FFFU, 0xDFEE4A3FU, 0x90B9222EU, 0x41409A1DU, 0x0E17F20CU,
+        0x954B8C2AU, 0xDA1CE43BU, 0x0BE55C08U, 0x44B23419U, 0xACD731D9U, 0xE38059C8U, 0x3279E1FBU, 0x7D2E89EAU,
+        0xC824F22FU, 0x87739A3EU, 0x568A220DU, 0x19DD4A1CU, 0xF1B84FDCU, 0xBEEF27CDU, 0x6F169FFEU, 0x2041F7EFU,
+        0xBB1D89C9U, 0xF44AE1D8U, 0x25B359EBU, 0x6AE431FAU, 0x8281343AU, 0xCDD65C2BU, 0x1C2FE418U, 0x53788C09U,
+        0x2E5605E3U, 0x61016DF2U, 0xB0F8D5C1U, 0xFFAFBDD0U, 0x17CAB810U, 0x589DD001U, 0x89646832U, 0xC6330023U,
+        0x5D6F7E05U, 0x12381614U, 0xC3C1AE27U, 0x8C96C636U, 0x64F3C3F6U, 0x2BA4ABE7U, 0xFA5D13D4U, 0xB50A7BC5U,
+        0x9488F9E9U, 0xDBDF91F8U, 0x0A2629CBU, 0x457141DAU, 0xAD14441AU, 0xE2432C0BU, 0x33BA9438U, 0x7CEDFC29U,
+        0xE7B1820FU, 0xA8E6EA1EU, 0x791F522DU, 0x36483A3CU, 0xDE2D3FFCU, 0x917A57EDU, 0x4083EFDEU, 0x0FD487CFU,
+        0x72FA0E25U, 0x3DAD6634U, 0xEC54DE07U, 0xA303B616U, 0x4B66B3D6U, 0x0431DBC7U, 0xD5C863F4U, 0x9A9F0BE5U,
+        0x01C375C3U, 0x4E941DD2U, 0x9F6DA5E1U, 0xD03ACDF0U, 0x385FC830U, 0x7708A021U, 0xA6F11812U, 0xE9A67003U,
+        0x5CAC0BC6U, 0x13FB63D7U, 0xC202DBE4U, 0x8D55B3F5U, 0x6530B635U, 0x2A67DE24U, 0xFB9E6617U, 0xB4C90E06U,
+        0x2F957020U, 0x60C21831U, 0xB13BA002U, 0xFE6CC813U, 0x1609CDD3U, 0x595EA5C2U, 0x88A71DF1U, 0xC7F075E0U,
+        0xBADEFC0AU, 0xF589941BU, 0x24702C28U, 0x6B274439U, 0x834241F9U, 0xCC1529E8U, 0x1DEC91DBU, 0x52BBF9CAU,
+        0xC9E787ECU, 0x86B0EFFDU, 0x574957CEU, 0x181E3FDFU, 0xF07B3A1FU, 0xBF2C520EU, 0x6ED5EA3DU, 0x2182822CU,
+        0x2DD0EE65U, 0x62878674U, 0xB37E3E47U, 0xFC295656U, 0x144C5396U, 0x5B1B3B87U, 0x8AE283B4U, 0xC5B5EBA5U,
+        0x5EE99583U, 0x11BEFD92U, 0xC04745A1U, 0x8F102DB0U, 0x67752870U, 0x28224061U, 0xF9DBF852U, 0xB68C9043U,
+        0xCBA219A9U, 0x84F571B8U, 0x550CC98BU, 0x1A5BA19AU, 0xF23EA45AU, 0xBD69CC4BU, 0x6C907478U, 0x23C71C69U,
+        0xB89B624FU, 0xF7CC0A5EU, 0x2635B26DU, 0x6962DA7CU, 0x8107DFBCU, 0xCE50B7ADU, 0x1FA90F9EU, 0x50FE678FU,
+        0xE5F41C4AU, 0xAAA3745BU, 0x7B5ACC68U, 0x340DA479U, 0xDC68A1B9U, 0x933FC9A8U, 0x42C6719BU, 0x0D91198AU,
+        0x96CD67ACU, 0xD99A0FBDU, 0x0863B78EU, 0x4734DF9FU, 0xAF51DA5FU, 0xE006B24EU, 0x31FF0A7DU, 0x7EA8626CU,
+        0x0386EB86U, 0x4CD18397U, 0x9D283BA4U, 0xD27F53B5U, 0x3A1A5675U, 0x754D3E64U, 0xA4B48657U, 0xEBE3EE46U,
+        0x70BF9060U, 0x3FE8F871U, 0xEE114042U, 0xA1462853U, 0x49232D93U, 0x06744582U, 0xD78DFDB1U, 0x98DA95A0U,
+        0xB958178CU, 0xF60F7F9DU, 0x27F6C7AEU, 0x68A1AFBFU, 0x80C4AA7FU, 0xCF93C26EU, 0x1E6A7A5DU, 0x513D124CU,
+        0xCA616C6AU, 0x8536047BU, 0x54CFBC48U, 0x1B98D459U, 0xF3FDD199U, 0xBCAAB988U, 0x6D5301BBU, 0x220469AAU,
+        0x5F2AE040U, 0x107D8851U, 0xC1843062U, 0x8ED35873U, 0x66B65DB3U, 0x29E135A2U, 0xF8188D91U, 0xB74FE580U,
+        0x2C139BA6U, 0x6344F3B7U, 0xB2BD4B84U, 0xFDEA2395U, 0x158F2655U, 0x5AD84E44U, 0x8B21F677U, 0xC4769E66U,
+        0x717CE5A3U, 0x3E2B8DB2U, 0xEFD23581U, 0xA0855D90U, 0x48E05850U, 0x07B73041U, 0xD64E8872U, 0x9919E063U,
+        0x02459E45U, 0x4D12F654U, 0x9CEB4E67U, 0xD3BC2676U, 0x3BD923B6U, 0x748E4BA7U, 0xA577F394U, 0xEA209B85U,
+        0x970E126FU, 0xD8597A7EU, 0x09A0C24DU, 0x46F7AA5CU, 0xAE92AF9CU, 0xE1C5C78DU, 0x303C7FBEU, 0x7F6B17AFU,
+        0xE4376989U, 0xAB600198U, 0x7A99B9ABU, 0x35CED1BAU, 0xDDABD47AU, 0x92FCBC6BU, 0x43050458U, 0x0C526C49U
+    },
+    {
+        0x00000000U, 0x5BA1DCCAU, 0xB743B994U, 0xECE2655EU, 0x6A466E9FU, 0x31E7B255U, 0xDD05D70BU, 0x86A40BC1U,
+        0xD48CDD3EU, 0x8F2D01F4U, 0x63CF64AAU, 0x386EB860U, 0xBECAB3A1U, 0xE56B6F6BU, 0x09890A35U, 0x5228D6FFU,
+        0xADD8A7CBU, 0xF6797B01U, 0x1A9B1E5FU, 0x413AC295U, 0xC79EC954U, 0x9C3F159EU, 0x70DD70C0U, 0x2B7CAC0AU,
+        0x79547AF5U, 0x22F5A63FU, 0xCE17C361U, 0x95B61FABU, 0x1312146AU, 0x48B3C8A0U, 0xA451ADFEU, 0xFFF07134U,
+        0x5F705221U, 0x04D18EEBU, 0xE833EBB5U, 0xB392377FU, 0x35363CBEU, 0x6E97E074U, 0x8275852AU, 0xD9D459E0U,
+        0x8BFC8F1FU, 0xD05D53D5U, 0x3CBF368BU, 0x671EEA41U, 0xE1BAE180U, 0xBA1B3D4AU, 0x56F95814U, 0x0D5884DEU,
+        0xF2A8F5EAU, 0xA9092920U, 0x45EB4C7EU, 0x1E4A90B4U, 0x98EE9B75U, 0xC34F47BFU, 0x2FAD22E1U, 0x740CFE2BU,
+        0x262428D4U, 0x7D85F41EU, 0x91679140U, 0xCAC64D8AU, 0x4C62464BU, 0x17C39A81U, 0xFB21FFDFU, 0xA0802315U,
+        0xBEE0A442U, 0xE5417888U, 0x09A31DD6U, 0x5202C11CU, 0xD4A6CADDU, 0x8F071617U, 0x63E57349U, 0x3844AF83U,
+        0x6A6C797CU, 0x31CDA5B6U, 0xDD2FC0E8U, 0x868E1C22U, 0x002A17E3U, 0x5B8BCB29U, 0xB769AE77U, 0xECC872BDU,
+        0x13380389U, 0x4899DF43U, 0xA47BBA1DU, 0xFFDA66D7U, 0x797E6D16U, 0x22DFB1DCU, 0xCE3DD482U, 0x959C0848U,
+        0xC7B4DEB7U, 0x9C15027DU, 0x70F76723U, 0x2B56BBE9U, 0xADF2B028U, 0xF6536CE2U, 0x1AB109BCU, 0x4110D576U,
+        0xE190F663U, 0xBA312AA9U, 0x56D34FF7U, 0x0D72933DU, 0x8BD698FCU, 0xD0774436U, 0x3C952168U, 0x6734FDA2U,
+        0x351C2B5DU, 0x6EBDF797U, 0x825F92C9U, 0xD9FE4E03U, 0x5F5A45C2U, 0x04FB9908U, 0xE819FC56U, 0xB3B8209CU,
+        0x4C4851A8U, 0x17E98D62U, 0xFB0BE83CU, 0xA0AA34F6U, 0x260E3F37U, 0x7DAFE3FDU, 0x914D86A3U, 0xCAEC5A69U,
+        0x98C48C96U, 0xC365505CU, 0x2F873502U, 0x7426E9C8U, 0xF282E209U, 0xA9233EC3U, 0x45C15B9DU, 0x1E608757U,
+        0x79005533U, 0x22A189F9U, 0xCE43ECA7U, 0x95E2306DU, 0x13463BACU, 0x48E7E766U, 0xA4058238U, 0xFFA45EF2U,
+        0xAD8C880DU, 0xF62D54C7U, 0x1ACF3199U, 0x416EED53U, 0xC7CAE692U, 0x9C6B3A58U, 0x70895F06U, 0x2B2883CCU,
+        0xD4D8F2F8U, 0x8F792E32U, 0x639B4B6CU, 0x383A97A6U, 0xBE9E9C67U, 0xE53F40ADU, 0x09DD25F3U, 0x527CF939U,
+        0x00542FC6U, 0x5BF5F30CU, 0xB7179652U, 0xECB64A98U, 0x6A124159U, 0x31B39D93U, 0xDD51F8CDU, 0x86F02407U,
+        0x26700712U, 0x7DD1DBD8U, 0x9133BE86U, 0xCA92624CU, 0x4C36698DU, 0x1797B547U, 0xFB75D019U, 0xA0D40CD3U,
+        0xF2FCDA2CU, 0xA95D06E6U, 0x45BF63B8U, 0x1E1EBF72U, 0x98BAB4B3U, 0xC31B6879U, 0x2FF90D27U, 0x7458D1EDU,
+        0x8BA8A0D9U, 0xD0097C13U, 0x3CEB194DU, 0x674AC587U, 0xE1EECE46U, 0xBA4F128CU, 0x56AD77D2U, 0x0D0CAB18U,
+        0x5F247DE7U, 0x0485A12DU, 0xE867C473U, 0xB3C618B9U, 0x35621378U, 0x6EC3CFB2U, 0x8221AAECU, 0xD9807626U,
+        0xC7E0F171U, 0x9C412DBBU, 0x70A348E5U, 0x2B02942FU, 0xADA69FEEU, 0xF6074324U, 0x1AE5267AU, 0x4144FAB0U,
+        0x136C2C4FU, 0x48CDF085U, 0xA42F95DBU, 0xFF8E4911U, 0x792A42D0U, 0x228B9E1AU, 0xCE69FB44U, 0x95C8278EU,
+        0x6A3856BAU, 0x31998A70U, 0xDD7BEF2EU, 0x86DA33E4U, 0x007E3825U, 0x5BDFE4EFU, 0xB73D81B1U, 0xEC9C5D7BU,
+        0xBEB48B84U, 0xE515574EU, 0x09F73210U, 0x5256EEDAU, 0xD4F2E51BU, 0x8F5339D1U, 0x63B15C8FU, 0x38108045U,
+        0x9890A350U, 0xC3317F9AU, 0x2FD31AC4U, 0x7472C60EU, 0xF2D6CDCFU, 0xA9771105U, 0x4595745BU, 0x1E34A891U,
+        0x4C1C7E6EU, 0x17BDA2A4U, 0xFB5FC7FAU, 0xA0FE1B30U, 0x265A10F1U, 0x7DFBCC3BU, 0x9119A965U, 0xCAB875AFU,
+        0x3548049BU, 0x6EE9D851U, 0x820BBD0FU, 0xD9AA61C5U, 0x5F0E6A04U, 0x04AFB6CEU, 0xE84DD390U, 0xB3EC0F5AU,
+        0xE1C4D9A5U, 0xBA65056FU, 0x56876031U, 0x0D26BCFBU, 0x8B82B73AU, 0xD0236BF0U, 0x3CC10EAEU, 0x6760D264U
+    }
+};
+#endif // #ifdef U_SPARTN_CRC_SLICE_BY_8
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
-/* ----------------------------------------------------------------
- * PUBLIC FUNCTIONS
- * -------------------------------------------------------------- */
+#ifdef U_SPARTN_CRC_SLICE_BY_8
+// Run CRC-16 over as many whole blocks of eight bytes as there are
+// at *ppData, moving *ppData and *pSize on past the blocks that were
+// consumed.
+static uint16_t sliceBy8Crc16(uint16_t u16Remainder, const uint8_t **ppU8Msg,
+                              size_t *pSize)
+{
+    const uint8_t *pU8Msg = *ppU8Msg;
+    size_t size = *pSize;
 
-uint8_t uSpartnCrc4(const char *pData, size_t size)
+    while (size >= 8) {
+        u16Remainder ^= (uint16_t) ((((uint16_t) pU8Msg[0]) << 8) | pU8Msg[1]);
+        u16Remainder = u16Crc16SliceTable[7][u16Remainder >> 8] ^
+                       u16Crc16SliceTable[6][u16Remainder & 0xFF] ^
+                       u16Crc16SliceTable[5][pU8Msg[2]] ^ u16Crc16SliceTable[4][pU8Msg[3]] ^
+                       u16Crc16SliceTable[3][pU8Msg[4]] ^ u16Crc16SliceTable[2][pU8Msg[5]] ^
+                       u16Crc16SliceTable[1][pU8Msg[6]] ^ u16Crc16SliceTable[0][pU8Msg[7]];
+        pU8Msg += 8;
+        size -= 8;
+    }
+
+    *ppU8Msg = pU8Msg;
+    *pSize = size;
+
+    return u16Remainder;
+}
+
+// Run a left-aligned CRC, using the given slice-by-8 table, over as
+// many whole blocks of eight bytes as there are at *ppData, moving
+// *ppData and *pSize on past the blocks that were consumed.
+static uint32_t sliceBy8(const uint32_t (*pTable)[256], uint32_t u32Remainder,
+                         const uint8_t **ppU8Msg, size_t *pSize)
 {
-    // Initialize local variables
-    uint8_t u8TableRemainder;
-    uint8_t u8Remainder = 0; // Initial remainder
-    const uint8_t *pU8Msg = (uint8_t *) pData;
+    const uint8_t *pU8Msg = *ppU8Msg;
+    size_t size = *pSize;
+
+    while (size >= 8) {
+        u32Remainder ^= (((uint32_t) pU8Msg[0]) << 24) | (((uint32_t) pU8Msg[1]) << 16) |
+                        (((uint32_t) pU8Msg[2]) << 8) | (uint32_t) pU8Msg[3];
+        u32Remainder = pTable[7][u32Remainder >> 24] ^ pTable[6][(u32Remainder >> 16) & 0xFF] ^
+                       pTable[5][(u32Remainder >> 8) & 0xFF] ^ pTable[4][u32Remainder & 0xFF] ^
+                       pTable[3][pU8Msg[4]] ^ pTable[2][pU8Msg[5]] ^
+                       pTable[1][pU8Msg[6]] ^ pTable[0][pU8Msg[7]];
+        pU8Msg += 8;
+        size -= 8;
+    }
+
+    *ppU8Msg = pU8Msg;
+    *pSize = size;
+
+    return u32Remainder;
+}
+#endif
 
-    // Compute the CRC value
+// CRC-4, starting from the given remainder.
+static uint8_t crc4(uint8_t u8Remainder, const uint8_t *pU8Msg, size_t size)
+{
     // Divide each byte of the message by the corresponding polynomial
     for (size_t x = 0; x < size; x++) {
-        u8TableRemainder = pU8Msg[x] ^ u8Remainder;
-        u8Remainder = u8Crc4Table[u8TableRemainder];
+        u8Remainder = u8Crc4Table[pU8Msg[x] ^ u8Remainder];
     }
 
     return u8Remainder;
 }
 
-uint8_t uSpartnCrc8(const char *pData, size_t size)
+// CRC-8, starting from the given remainder.
+static uint8_t crc8(uint8_t u8Remainder, const uint8_t *pU8Msg, size_t size)
 {
-    // Initialize local variables
-    uint8_t u8TableRemainder;
-    uint8_t u8Remainder = 0; // Initial remainder
-    const uint8_t *pU8Msg = (uint8_t *) pData;
-
-    // Compute the CRC value
     // Divide each byte of the message by the corresponding polynomial
     for (size_t x = 0; x < size; x++) {
-        u8TableRemainder = pU8Msg[x] ^ u8Remainder;
-        u8Remainder = u8Crc8Table[u8TableRemainder];
+        u8Remainder = u8Crc8Table[pU8Msg[x] ^ u8Remainder];
     }
 
     return u8Remainder;
 }
 
-uint16_t uSpartnCrc16(const char *pData, size_t size)
+// CRC-16, starting from the given remainder.
+static uint16_t crc16(uint16_t u16Remainder, const uint8_t *pU8Msg, size_t size)
 {
-    // Initialize local variables
-    uint16_t u16TableRemainder;
-    uint16_t u16Remainder = 0; // Initial remainder
-    uint8_t  u8NumBitsInCrc = (8 * sizeof(uint16_t));
-    const uint8_t  *pU8Msg = (uint8_t *) pData;
+#ifdef U_SPARTN_CRC_SLICE_BY_8
+    if (size >= 8) {
+        u16Remainder = sliceBy8Crc16(u16Remainder, &pU8Msg, &size);
+    }
+#endif
 
-    // Compute the CRC value
-    // Divide each byte of the message by the corresponding polynomial
+    // Divide each remaining byte of the message by the polynomial
     for (size_t x = 0; x < size; x++) {
-        u16TableRemainder = pU8Msg[x] ^ (u16Remainder >> (u8NumBitsInCrc - 8));
-        u16Remainder = u16Crc16Table[u16TableRemainder] ^ (u16Remainder << 8);
+        u16Remainder = u16Crc16Table[pU8Msg[x] ^ (u16Remainder >> 8)] ^ (uint16_t) (u16Remainder << 8);
     }
 
     return u16Remainder;
 }
 
-uint32_t uSpartnCrc24(const char *pData, size_t size)
+// CRC-24, starting from the given remainder.
+static uint32_t crc24(uint32_t u32Remainder, const uint8_t *pU8Msg, size_t size)
 {
-    // Initialize local variables
-    uint32_t u32TableRemainder;
-    uint32_t u32Remainder = 0; // Initial remainder
-    uint8_t u8NumBitsInCrc = (8 * sizeof(uint8_t) * 3);
-    const uint8_t *pU8Msg = (uint8_t *) pData;
+#ifdef U_SPARTN_CRC_SLICE_BY_8
+    if (size >= 8) {
+        u32Remainder = sliceBy8(u32Crc24SliceTable, u32Remainder << 8,
+                                &pU8Msg, &size) >> 8;
+    }
+#endif
 
-    // Compute the CRC value
-    // Divide each byte of the message by the corresponding polynomial
+    // Divide each remaining byte of the message by the polynomial
     for (size_t x = 0; x < size; x++) {
-        u32TableRemainder = pU8Msg[x] ^ (u32Remainder >> (u8NumBitsInCrc - 8));
-        u32Remainder = u32Crc24Table[u32TableRemainder] ^ (u32Remainder << 8);
+        u32Remainder = u32Crc24Table[pU8Msg[x] ^ (u32Remainder >> 16)] ^ (u32Remainder << 8);
         u32Remainder = u32Remainder & 0x00FFFFFF; // Only interested in 24 bits
     }
 
     return u32Remainder;
 }
 
-uint32_t uSpartnCrc32(const char *pData, size_t size)
+// CRC-32, starting from the given remainder, no final XOR.
+static uint32_t crc32(uint32_t u32Remainder, const uint8_t *pU8Msg, size_t size)
 {
-    // Initialize local variables
-    uint32_t u32TableRemainder;
-    uint32_t u32Remainder = 0xFFFFFFFFU; // Initial remainder
-    uint8_t u8NumBitsInCrc = (8 * sizeof(uint32_t));
-    uint32_t u32FinalXORValue = 0xFFFFFFFFU;
-    const uint8_t *pU8Msg = (uint8_t *) pData;
-
-    // Compute the CRC value
-    // Divide each byte of the message by the corresponding polynomial
-    for (size_t x = 0; x < size; x++) {
-        u32TableRemainder = pU8Msg[x] ^ (u32Remainder >> (u8NumBitsInCrc - 8));
-        u32Remainder = u32Crc32Table[u32TableRemainder] ^ (u32Remainder << 8);
+#ifdef U_SPARTN_CRC_SLICE_BY_8
+    if (size >= 8) {
+        u32Remainder = sliceBy8(u32Crc32SliceTable, u32Remainder, &pU8Msg, &size);
     }
+#endif
 
-    u32Remainder = u32Remainder ^ u32FinalXORValue;
+    // Divide each remaining byte of the message by the polynomial
+    for (size_t x = 0; x < size; x++) {
+        u32Remainder = u32Crc32Table[pU8Msg[x] ^ (u32Remainder >> 24)] ^ (u32Remainder << 8);
+    }
 
     return u32Remainder;
 }
 
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+uint8_t uSpartnCrc4(const char *pData, size_t size)
+{
+    return crc4(0, (const uint8_t *) pData, size);
+}
+
+uint8_t uSpartnCrc8(const char *pData, size_t size)
+{
+    return crc8(0, (const uint8_t *) pData, size);
+}
+
+uint16_t uSpartnCrc16(const char *pData, size_t size)
+{
+    return crc16(0, (const uint8_t *) pData, size);
+}
+
+uint32_t uSpartnCrc24(const char *pData, size_t size)
+{
+    return crc24(0, (const uint8_t *) pData, size);
+}
+
+uint32_t uSpartnCrc32(const char *pData, size_t size)
+{
+    // Initial remainder and final XOR are both 0xFFFFFFFF
+    return crc32(0xFFFFFFFFU, (const uint8_t *) pData, size) ^ 0xFFFFFFFFU;
+}
+
+uint32_t uSpartnCrcContinue(uSpartnCrcType_t type, uint32_t crc,
+                            const char *pData, size_t size)
+{
+    const uint8_t *pU8Msg = (const uint8_t *) pData;
+
+    switch (type) {
+        case U_SPARTN_CRC_TYPE_4:
+            crc = crc4((uint8_t) crc, pU8Msg, size);
+            break;
+        case U_SPARTN_CRC_TYPE_8:
+            crc = crc8((uint8_t) crc, pU8Msg, size);
+            break;
+        case U_SPARTN_CRC_TYPE_16:
+            crc = crc16((uint16_t) crc, pU8Msg, size);
+            break;
+        case U_SPARTN_CRC_TYPE_24:
+            crc = crc24(crc & 0x00FFFFFF, pU8Msg, size);
+            break;
+        case U_SPARTN_CRC_TYPE_32:
+            // Undo the final XOR of the previous result to get
+            // back to the remainder, then re-apply it
+            crc = crc32(crc ^ 0xFFFFFFFFU, pU8Msg, size) ^ 0xFFFFFFFFU;
+            break;
+        default:
+            break;
+    }
+
+    return crc;
+}
+
 // End of file
@@ -51,6 +51,8 @@
 
 #include "u_test_util_resource_check.h"
 
+#include "u_ringbuffer.h"
+
 #include "u_spartn.h"
 #include "u_spartn_crc.h"
 #include "u_spartn_test_data.h"
@@ -82,6 +84,35 @@
 # define U_SPARTN_TEST_BUFFER_SIZE_BYTES (U_SPARTN_MESSAGE_LENGTH_MAX_BYTES + U_SPARTN_TEST_BUFFER_EXTRA_SIZE_BYTES)
 #endif
 
+#ifndef U_SPARTN_TEST_CRC_MAX_LENGTH_BYTES
+/** The maximum length of data to check the CRC functions against
+ * the reference implementations with.
+ */
+# define U_SPARTN_TEST_CRC_MAX_LENGTH_BYTES 64
+#endif
+
+#ifndef U_SPARTN_TEST_RING_BUFFER_SIZE_BYTES
+/** The size of ring buffer to use when testing uSpartnParse():
+ * must be enough to hold a maximum length SPARTN message plus
+ * the largest block that is added to it in one go.
+ */
+# define U_SPARTN_TEST_RING_BUFFER_SIZE_BYTES (U_SPARTN_MESSAGE_LENGTH_MAX_BYTES * 2)
+#endif
+
+#ifndef U_SPARTN_TEST_THROUGHPUT_ITERATIONS
+/** The number of times to pass #gUSpartnTestData through the
+ * SPARTN message functions when measuring throughput.
+ */
+# define U_SPARTN_TEST_THROUGHPUT_ITERATIONS 100
+#endif
+
+#ifndef U_SPARTN_TEST_THROUGHPUT_BLOCK_SIZE_BYTES
+/** The size of the blocks in which #gUSpartnTestData is added
+ * to the ring buffer when measuring throughput.
+ */
+# define U_SPARTN_TEST_THROUGHPUT_BLOCK_SIZE_BYTES 512
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -249,6 +280,99 @@ static crc24 crc_octets(unsigned char *octets, size_t len)
     return crc & 0xFFFFFFL;
 }
 
+// Bit-at-a-time CRC-16/XMODEM, as a reference.
+static uint16_t crc16Bitwise(const char *pData, size_t size)
+{
+    uint16_t crc = 0;
+
+    while (size--) {
+        crc ^= ((uint16_t) (uint8_t) *pData++) << 8;
+        for (size_t x = 0; x < 8; x++) {
+            crc = (crc & 0x8000) ? (uint16_t) ((crc << 1) ^ 0x1021) : (uint16_t) (crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+// Bit-at-a-time CRC-32/BZIP2, as a reference.
+static uint32_t crc32Bitwise(const char *pData, size_t size)
+{
+    uint32_t crc = 0xFFFFFFFFU;
+
+    while (size--) {
+        crc ^= ((uint32_t) (uint8_t) *pData++) << 24;
+        for (size_t x = 0; x < 8; x++) {
+            crc = (crc & 0x80000000U) ? (crc << 1) ^ 0x04C11DB7U : crc << 1;
+        }
+    }
+
+    return crc ^ 0xFFFFFFFFU;
+}
+
+#ifndef __ZEPHYR__
+
+// Parse everything that can be parsed from a ring buffer with
+// uSpartnParse(), removing what has been parsed; returns the
+// number of SPARTN messages found and adds the number of bytes
+// discarded to *pDiscardCount.
+static size_t parseAll(uRingBuffer_t *pRingBuffer, size_t *pDiscardCount)
+{
+    U_RING_BUFFER_PARSER_f parserList[] = {uSpartnParse, NULL};
+    uSpartnMessageId_t id;
+    size_t messageCount = 0;
+    int32_t x;
+
+    do {
+        id.type = -1;
+        x = (int32_t) uRingBufferParseHandleSync(pRingBuffer, 0, parserList,
+                                                 U_SPARTN_PARSE_SYNC_BYTES,
+                                                 sizeof(U_SPARTN_PARSE_SYNC_BYTES) - 1,
+                                                 &id);
+        if (x > 0) {
+            if (id.type >= 0) {
+                U_PORT_TEST_ASSERT(x <= U_SPARTN_MESSAGE_LENGTH_MAX_BYTES);
+                U_PORT_TEST_ASSERT(id.type < 128);
+                U_PORT_TEST_ASSERT((id.subType >= 0) && (id.subType < 16));
+                messageCount++;
+            } else {
+                *pDiscardCount += x;
+            }
+            U_PORT_TEST_ASSERT(uRingBufferRead(pRingBuffer, NULL, x) == (size_t) x);
+        }
+    } while (x > 0);
+
+    return messageCount;
+}
+
+// Add data to a ring buffer in blocks of the given size (random
+// if zero), calling parseAll() after each one; returns the number
+// of SPARTN messages found.
+static size_t addAndParse(uRingBuffer_t *pRingBuffer, const char *pData,
+                          size_t size, size_t blockSize, size_t *pDiscardCount)
+{
+    size_t messageCount = 0;
+    size_t y;
+
+    while (size > 0) {
+        y = blockSize;
+        if (y == 0) {
+            y = (rand() % 100) + 1;
+        }
+        if (y > size) {
+            y = size;
+        }
+        U_PORT_TEST_ASSERT(uRingBufferAdd(pRingBuffer, pData, y));
+        pData += y;
+        size -= y;
+        messageCount += parseAll(pRingBuffer, pDiscardCount);
+    }
+
+    return messageCount;
+}
+
+#endif // __ZEPHYR__
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: TESTS
  * -------------------------------------------------------------- */
@@ -309,6 +433,43 @@ U_PORT_TEST_FUNCTION("[spartn]", "spartnCrc")
     U_TEST_PRINT_LINE("CRC-24: calculated 0x%08x, expected 0x%08x.", calculated, expected);
     U_PORT_TEST_ASSERT(calculated == expected);
 
+    // CRC-16, CRC-24 and CRC-32 are computed eight bytes at a time,
+    // with the remainder done a byte at a time, so check them
+    // against bit-at-a-time references for all lengths up to
+    // U_SPARTN_TEST_CRC_MAX_LENGTH_BYTES at all alignments
+    U_TEST_PRINT_LINE("checking CRCs against references for lengths up to %d.",
+                      U_SPARTN_TEST_CRC_MAX_LENGTH_BYTES);
+    for (size_t x = 0; x < 8; x++) {
+        for (size_t y = 0; y <= U_SPARTN_TEST_CRC_MAX_LENGTH_BYTES; y++) {
+            U_PORT_TEST_ASSERT(uSpartnCrc16(gUSpartnTestData + x, y) ==
+                               crc16Bitwise(gUSpartnTestData + x, y));
+            U_PORT_TEST_ASSERT(uSpartnCrc24(gUSpartnTestData + x, y) ==
+                               (uint32_t) crc_octets((unsigned char *) gUSpartnTestData + x, y));
+            U_PORT_TEST_ASSERT(uSpartnCrc32(gUSpartnTestData + x, y) ==
+                               crc32Bitwise(gUSpartnTestData + x, y));
+        }
+    }
+
+    // Check that a CRC calculation split at any point, using
+    // uSpartnCrcContinue(), gives the same answer as one over
+    // the whole
+    for (size_t x = 0; x < sizeof(gpTestData) / sizeof(gpTestData[0]); x++) {
+        pTestData = gpTestData[x];
+        U_PORT_TEST_ASSERT(uSpartnCrcContinue(pTestData->type, 0, pTestData->pData,
+                                              pTestData->size) == pTestData->result);
+        for (size_t y = 0; y <= pTestData->size; y++) {
+            calculated = uSpartnCrcContinue(pTestData->type, 0, pTestData->pData, y);
+            calculated = uSpartnCrcContinue(pTestData->type, calculated,
+                                            pTestData->pData + y, pTestData->size - y);
+            U_PORT_TEST_ASSERT(calculated == pTestData->result);
+        }
+    }
+    for (size_t y = 0; y <= U_SPARTN_TEST_CRC_MAX_LENGTH_BYTES; y++) {
+        calculated = uSpartnCrcContinue(U_SPARTN_CRC_TYPE_24, uSpartnCrc24(gUSpartnTestData, y),
+                                        gUSpartnTestData + y, U_SPARTN_TEST_CRC_MAX_LENGTH_BYTES - y);
+        U_PORT_TEST_ASSERT(calculated == uSpartnCrc24(gUSpartnTestData, U_SPARTN_TEST_CRC_MAX_LENGTH_BYTES));
+    }
+
     // Check for resource leaks
     uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
     resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
@@ -452,6 +613,173 @@ U_PORT_TEST_FUNCTION("[spartn]", "spartnMessage")
     U_PORT_TEST_ASSERT(resourceCount <= 0);
 }
 
+/** Testing of uSpartnParse(), finding SPARTN messages in a stream
+ * of bytes passing through a ring buffer.
+ */
+U_PORT_TEST_FUNCTION("[spartn]", "spartnParse")
+{
+    int32_t resourceCount;
+    uRingBuffer_t ringBuffer;
+    char *pLinearBuffer;
+    char garbage[20];
+    char *pCorrupt;
+    const char *pData;
+    const char *pMessage;
+    int32_t messageLength;
+    size_t garbageLength;
+    size_t garbageCount = 0;
+    size_t discardCount = 0;
+    size_t messageCount = 0;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    U_TEST_PRINT_LINE("testing SPARTN message parsing from a ring buffer.");
+
+    pLinearBuffer = (char *) pUPortMalloc(U_SPARTN_TEST_RING_BUFFER_SIZE_BYTES);
+    U_PORT_TEST_ASSERT(pLinearBuffer != NULL);
+    U_PORT_TEST_ASSERT(uRingBufferCreate(&ringBuffer, pLinearBuffer,
+                                         U_SPARTN_TEST_RING_BUFFER_SIZE_BYTES) == 0);
+
+    // Pass the SPARTN messages of the test data set through the ring
+    // buffer in random length blocks, with a random amount of garbage
+    // (which cannot contain a preamble) before each one; all of the
+    // messages should be found and all of the garbage discarded
+    pData = gUSpartnTestData;
+    while ((messageLength = uSpartnValidate(pData,
+                                            gUSpartnTestDataSize - (pData - gUSpartnTestData),
+                                            &pMessage)) > 0) {
+        U_PORT_TEST_ASSERT(pMessage == pData);
+        for (size_t x = 0; x < sizeof(garbage); x++) {
+            garbage[x] = (char) rand();
+            if (garbage[x] == U_SPARTN_PREAMBLE) {
+                garbage[x] = 0;
+            }
+        }
+        garbageLength = rand() % sizeof(garbage);
+        messageCount += addAndParse(&ringBuffer, garbage, garbageLength, 0, &discardCount);
+        garbageCount += garbageLength;
+        messageCount += addAndParse(&ringBuffer, pData, messageLength, 0, &discardCount);
+        pData += messageLength;
+    }
+    U_TEST_PRINT_LINE("found %d message(s) out of %d, discarded %d byte(s) of %d garbage.",
+                      messageCount, gUSpartnTestDataNumMessages, discardCount, garbageCount);
+    U_PORT_TEST_ASSERT(messageCount == gUSpartnTestDataNumMessages);
+    U_PORT_TEST_ASSERT(discardCount == garbageCount);
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(&ringBuffer) == 0);
+
+    // A message with a corrupted body should not be found, while
+    // a good one following it should; add enough padding to
+    // flush out anything in the corrupted message that looks
+    // like the start of a SPARTN message
+    pCorrupt = (char *) pUPortMalloc(sizeof(gpSpartnMessage));
+    U_PORT_TEST_ASSERT(pCorrupt != NULL);
+    memcpy(pCorrupt, gpSpartnMessage, sizeof(gpSpartnMessage));
+    *(pCorrupt + (sizeof(gpSpartnMessage) / 2)) ^= 0x01;
+    discardCount = 0;
+    messageCount = addAndParse(&ringBuffer, pCorrupt, sizeof(gpSpartnMessage), 0, &discardCount);
+    messageCount += addAndParse(&ringBuffer, gpSpartnMessage, sizeof(gpSpartnMessage), 0,
+                                &discardCount);
+    memset(garbage, 0, sizeof(garbage));
+    for (size_t x = 0; x < U_SPARTN_MESSAGE_LENGTH_MAX_BYTES; x += sizeof(garbage)) {
+        messageCount += addAndParse(&ringBuffer, garbage, sizeof(garbage), 0, &discardCount);
+    }
+    U_TEST_PRINT_LINE("after corruption found %d message(s), discarded %d byte(s).",
+                      messageCount, discardCount);
+    U_PORT_TEST_ASSERT(messageCount == 1);
+    U_PORT_TEST_ASSERT(discardCount >= sizeof(gpSpartnMessage));
+    uPortFree(pCorrupt);
+
+    uRingBufferDelete(&ringBuffer);
+    uPortFree(pLinearBuffer);
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Measure the rate at which SPARTN messages can be found and
+ * validated, both in a linear buffer with uSpartnValidate() and
+ * in a stream passing through a ring buffer with uSpartnParse(),
+ * by replaying #gUSpartnTestData many times.  The results are
+ * printed, not checked, since they are platform dependent.
+ */
+U_PORT_TEST_FUNCTION("[spartn]", "spartnThroughput")
+{
+    int32_t resourceCount;
+    uRingBuffer_t ringBuffer;
+    char *pLinearBuffer;
+    const char *pData;
+    const char *pMessage;
+    int32_t messageLength;
+    size_t messageCount;
+    size_t discardCount = 0;
+    int32_t startTimeMs;
+    int32_t durationMs;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    pLinearBuffer = (char *) pUPortMalloc(U_SPARTN_TEST_RING_BUFFER_SIZE_BYTES);
+    U_PORT_TEST_ASSERT(pLinearBuffer != NULL);
+    U_PORT_TEST_ASSERT(uRingBufferCreate(&ringBuffer, pLinearBuffer,
+                                         U_SPARTN_TEST_RING_BUFFER_SIZE_BYTES) == 0);
+
+    U_TEST_PRINT_LINE("passing %d bytes of SPARTN messages %d times through each method.",
+                      gUSpartnTestDataSize, U_SPARTN_TEST_THROUGHPUT_ITERATIONS);
+
+    // Method 0 is uSpartnValidate(), method 1 is uSpartnParse()
+    for (size_t m = 0; m < 2; m++) {
+        startTimeMs = uPortGetTickTimeMs();
+        for (size_t i = 0; i < U_SPARTN_TEST_THROUGHPUT_ITERATIONS; i++) {
+            messageCount = 0;
+            if (m == 0) {
+                pData = gUSpartnTestData;
+                while ((messageLength = uSpartnValidate(pData,
+                                                        gUSpartnTestDataSize - (pData - gUSpartnTestData),
+                                                        &pMessage)) > 0) {
+                    messageCount++;
+                    pData = pMessage + messageLength;
+                }
+            } else {
+                messageCount = addAndParse(&ringBuffer, gUSpartnTestData, gUSpartnTestDataSize,
+                                           U_SPARTN_TEST_THROUGHPUT_BLOCK_SIZE_BYTES,
+                                           &discardCount);
+            }
+            U_PORT_TEST_ASSERT(messageCount == gUSpartnTestDataNumMessages);
+        }
+        durationMs = uPortGetTickTimeMs() - startTimeMs;
+        U_TEST_PRINT_LINE("%s took %d ms, %d kbytes/second.",
+                          m == 0 ? "uSpartnValidate()" : "uSpartnParse()", durationMs,
+                          (int32_t) (((int64_t) gUSpartnTestDataSize * U_SPARTN_TEST_THROUGHPUT_ITERATIONS) /
+                                     (durationMs > 0 ? durationMs : 1)));
+    }
+    U_PORT_TEST_ASSERT(discardCount == 0);
+
+    uRingBufferDelete(&ringBuffer);
+    uPortFree(pLinearBuffer);
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
 #endif // __ZEPHYR__
 
 /** Clean-up to be run at the end of this round of tests, just
@@ -29,7 +29,11 @@
 /** @file
  * @brief Ring buffer wrapper API for linear buffer.
  * All functions except uRingBufferCreate() and uRingBufferDelete()
- * are thread-safe.
+ * are thread-safe.  A ring buffer created with uRingBufferCreateLockFree()
+ * or uRingBufferCreateWithReadHandleLockFree() does not take its
+ * mutex in the data path (add/read/peek/data-size/parse): it is then
+ * thread-safe for a single producer and, per read pointer, a single
+ * consumer.
  */
 
 #ifdef __cplusplus
@@ -40,6 +44,13 @@ extern "C" {
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+#ifndef U_RING_BUFFER_PARSE_SYNC_BYTES_MAX_NUM
+/** The maximum number of sync bytes that may be passed to
+ * uRingBufferParseHandleSync().
+ */
+# define U_RING_BUFFER_PARSE_SYNC_BYTES_MAX_NUM 8
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -84,6 +95,9 @@ typedef struct {
     bool readHandleRequired;        /**< true to ONLY allow uRingBufferReadHandle()/
                                          uRingBufferPeekHandle(); uRingBufferRead()/
                                          uRingBufferPeek() will return nothing. */
+    bool lockFree;                  /**< true if the data path of the ring
+                                         buffer does not take the mutex, see
+                                         uRingBufferCreateLockFree(). */
     size_t statReadLossNormalBytes; /**< storage for the bytes lost as a
                                          result of forced add pushing
                                          data out of the "normal" read
@@ -103,6 +117,14 @@ typedef struct {
 
 typedef void *uParseHandle_t; //!< Parser handle.
 
+/** A contiguous span of the data in a ring buffer, as returned
+ * by uRingBufferGetSpansUnprotected().
+ */
+typedef struct {
+    const char *pData;
+    size_t length;
+} uRingBufferSpan_t;
+
 /** Parser function prototype, used with uRingBufferParseHandle().
  *
  * @param parseHandle     the parser handle used to access the ring buffer.
@@ -148,6 +170,26 @@ void uRingBufferDump(uRingBuffer_t *pRingBuffer);
 int32_t uRingBufferCreate(uRingBuffer_t *pRingBuffer, char *pLinearBuffer,
                           size_t size);
 
+/** As uRingBufferCreate() but create a ring buffer that does not
+ * lock its mutex when data is added, read, peeked or parsed: the
+ * read and write pointers are instead published atomically.  This
+ * is quicker but is ONLY safe if there is a single producer (a single
+ * task calling uRingBufferAdd()) and a single consumer (a single task
+ * calling uRingBufferRead()/uRingBufferPeek()/uRingBufferParseHandle()
+ * etc.).  uRingBufferForceAdd() on such a ring buffer cannot move the
+ * read pointer of a consumer and hence behaves as uRingBufferAdd().
+ *
+ * @param[in] pRingBuffer   a pointer to a ring buffer, cannot be NULL.
+ * @param[in] pLinearBuffer a pointer to the linear buffer.
+ * @param size              the size of the linear buffer in bytes; the
+ *                          ring buffer will be of maximum size this
+ *                          number minus one as one byte is used to
+ *                          prevent pointer-wrap.
+ * @return                  zero on success else negative error code.
+ */
+int32_t uRingBufferCreateLockFree(uRingBuffer_t *pRingBuffer,
+                                  char *pLinearBuffer, size_t size);
+
 /** Delete a ring buffer.
  *
  * @param[in] pRingBuffer   a pointer to the ring buffer, cannot be NULL.
@@ -296,6 +338,27 @@ int32_t uRingBufferCreateWithReadHandle(uRingBuffer_t *pRingBuffer,
                                         char *pLinearBuffer, size_t size,
                                         size_t maxNumReadHandles);
 
+/** As uRingBufferCreateWithReadHandle() but, like
+ * uRingBufferCreateLockFree(), the data path does not lock the mutex;
+ * there must be a single producer and each read handle (and the
+ * "normal" read pointer) must be used by no more than one consumer
+ * task.  Taking, giving, locking and flushing read handles still
+ * employs the mutex.
+ *
+ * @param[in] pRingBuffer   a pointer to a ring buffer, cannot be NULL.
+ * @param[in] pLinearBuffer a pointer to the linear buffer.
+ * @param size              the size of the linear buffer in bytes; the
+ *                          ring buffer will be of maximum size this
+ *                          number minus one as one byte is used to
+ *                          prevent pointer-wrap.
+ * @param maxNumReadHandles the maximum number of read handles that
+ *                          should be allowed; up to 64 are permitted.
+ * @return                  zero on success else negative error code.
+ */
+int32_t uRingBufferCreateWithReadHandleLockFree(uRingBuffer_t *pRingBuffer,
+                                                char *pLinearBuffer, size_t size,
+                                                size_t maxNumReadHandles);
+
 /** Set whether a ring buffer accepts uRingBufferRead() / uRingBufferPeek()
  * or requires the "handle" form, uRingBufferReadHandle() /
  * uRingBufferPeekHandle(), to be used.  Only useful if the ring buffer
@@ -473,6 +536,31 @@ size_t uRingBufferStatReadLossHandle(uRingBuffer_t *pRingBuffer,
 size_t uRingBufferParseHandle(uRingBuffer_t *pRingBuffer, int32_t handle,
                               U_RING_BUFFER_PARSER_f *pParserList, void *pUserParam);
 
+/** As uRingBufferParseHandle() but, rather than trying every parser
+ * at every byte offset, the parsers are only run at offsets where one
+ * of pSyncBytes is found, the search being performed with memchr();
+ * the bytes in between are discarded.  This can ONLY be used if every
+ * parser in the list returns #U_ERROR_COMMON_NOT_FOUND when the first
+ * byte it is given is not one of pSyncBytes.
+ *
+ * @param[in] pRingBuffer a pointer to the ring buffer, cannot be NULL.
+ * @param handle          a read handle, as originally returned by
+ *                        uRingBufferTakeReadHandle().
+ * @param[in] pParserList a pointer to a list of parsers, terminated by
+ *                        a NULL pointer.
+ * @param[in] pSyncBytes  the bytes that may start a message; may be
+ *                        NULL, in which case this function behaves as
+ *                        uRingBufferParseHandle().
+ * @param numSyncBytes    the number of bytes at pSyncBytes, no more than
+ *                        #U_RING_BUFFER_PARSE_SYNC_BYTES_MAX_NUM.
+ * @param[in] pUserParam  a user parameter to pass to each parser in the list.
+ * @return                as uRingBufferParseHandle().
+ */
+size_t uRingBufferParseHandleSync(uRingBuffer_t *pRingBuffer, int32_t handle,
+                                  U_RING_BUFFER_PARSER_f *pParserList,
+                                  const char *pSyncBytes, size_t numSyncBytes,
+                                  void *pUserParam);
+
 /** Get a byte from the ring buffer while in a parser function.
  *
  * IMPORTANT: unlike all of the other ring-buffer functions, this function
@@ -510,6 +598,40 @@ size_t uRingBufferBytesAvailableUnprotected(uParseHandle_t parseHandle);
  */
 size_t uRingBufferBytesDiscardUnprotected(uParseHandle_t parseHandle);
 
+/** Get the data that remains to be parsed, while in a parser function,
+ * as up to two contiguous spans of memory (the second being present
+ * only if the data wraps around the end of the ring buffer), allowing
+ * a parser to work through a block of data without a function call
+ * per byte.  This does not move the parse position on, use
+ * uRingBufferSkipUnprotected() for that.
+ *
+ * IMPORTANT: unlike all of the other ring-buffer functions, this function
+ * is NOT thread-safe, it is ONLY intended to be used from within a
+ * U_RING_BUFFER_PARSER_f function that will be called by uRingBufferParseHandle()
+ * (which adds thread-safety).
+ *
+ * @param parseHandle     the parser handle used to access the ring buffer.
+ * @param[out] pSpans     a pointer to an array of two spans, cannot be NULL.
+ * @return                the number of spans populated, 0, 1 or 2.
+ */
+size_t uRingBufferGetSpansUnprotected(uParseHandle_t parseHandle,
+                                      uRingBufferSpan_t *pSpans);
+
+/** Move the parse position on, while in a parser function, as
+ * if uRingBufferGetByteUnprotected() had been called length times.
+ *
+ * IMPORTANT: unlike all of the other ring-buffer functions, this function
+ * is NOT thread-safe, it is ONLY intended to be used from within a
+ * U_RING_BUFFER_PARSER_f function that will be called by uRingBufferParseHandle()
+ * (which adds thread-safety).
+ *
+ * @param parseHandle     the parser handle used to access the ring buffer.
+ * @param length          the number of bytes to skip.
+ * @return                the number of bytes skipped, which will be less
+ *                        than length if there was not enough data.
+ */
+size_t uRingBufferSkipUnprotected(uParseHandle_t parseHandle, size_t length);
+
 #ifdef __cplusplus
 }
 #endif
@@ -34,7 +34,7 @@
 #include "stdio.h"    // snprintf()
 
 #include "u_cfg_sw.h"
-#include "u_compiler.h" // For U_INLINE
+#include "u_compiler.h" // For U_INLINE, U_ATOMIC_GET/U_ATOMIC_SET
 
 #include "u_error_common.h"
 #include "u_assert.h"
@@ -118,6 +118,45 @@ static U_INLINE const char *pPtrOffset(const char *pData, size_t offset,
     return pData;
 }
 
+// Get the write pointer; for a lock-free ring buffer this may
+// be moved on by the producer while a consumer is looking at it.
+static U_INLINE char *pWriteGet(const uRingBuffer_t *pRingBuffer)
+{
+    return U_ATOMIC_GET(&(pRingBuffer->pDataWrite));
+}
+
+// Get a read pointer; for a lock-free ring buffer this may be
+// moved on by a consumer while the producer is looking at it.
+static U_INLINE const char *pReadGet(const uRingBuffer_t *pRingBuffer,
+                                     size_t index)
+{
+    return U_ATOMIC_GET(&(pRingBuffer->pDataRead[index]));
+}
+
+// Set a read pointer.
+static U_INLINE void readSet(uRingBuffer_t *pRingBuffer, size_t index,
+                             const char *pRead)
+{
+    U_ATOMIC_SET(&(pRingBuffer->pDataRead[index]), pRead);
+}
+
+// Lock the ring buffer's mutex in the data path, i.e. unless
+// the ring buffer is lock-free.
+static U_INLINE void dataLock(const uRingBuffer_t *pRingBuffer)
+{
+    if (!pRingBuffer->lockFree) {
+        uPortMutexLock((uPortMutexHandle_t) pRingBuffer->mutex);
+    }
+}
+
+// Unlock the ring buffer's mutex in the data path.
+static U_INLINE void dataUnlock(const uRingBuffer_t *pRingBuffer)
+{
+    if (!pRingBuffer->lockFree) {
+        uPortMutexUnlock((uPortMutexHandle_t) pRingBuffer->mutex);
+    }
+}
+
 // The ring buffer's mutex should be locked before this is called
 static void bufferReset(uRingBuffer_t *pRingBuffer)
 {
@@ -143,55 +182,68 @@ static int32_t createCommon(uRingBuffer_t *pRingBuffer, char *pLinearBuffer, siz
     return uPortMutexCreate((uPortMutexHandle_t *) &pRingBuffer->mutex);
 }
 
-// The ring buffer's mutex should be locked before this is called
+// The ring buffer's mutex should be locked before this is called,
+// unless the ring buffer is lock-free.
 static size_t read(uRingBuffer_t *pRingBuffer, int32_t handle, char *pData,
                    size_t length, size_t offset, bool destructive)
 {
     size_t bytesRead = 0;
     size_t available;
-    const char *pSource;
-
-    if ((handle >= 0) && (handle < (int32_t) pRingBuffer->maxNumReadPointers) &&
-        (pRingBuffer->pDataRead[handle] != NULL)) {
+    size_t chunk;
+    const char *pSource = NULL;
 
-        pSource = pPtrOffset(pRingBuffer->pDataRead[handle], offset,
-                             pRingBuffer->pBuffer, pRingBuffer->size);
-        available = ptrDiff(pSource, pRingBuffer->pDataWrite, pRingBuffer->size);
+    if ((handle >= 0) && (handle < (int32_t) pRingBuffer->maxNumReadPointers)) {
+        pSource = pReadGet(pRingBuffer, handle);
+    }
+    if (pSource != NULL) {
+        pSource = pPtrOffset(pSource, offset, pRingBuffer->pBuffer, pRingBuffer->size);
+        available = ptrDiff(pSource, pWriteGet(pRingBuffer), pRingBuffer->size);
         if (length > available) {
             length = available;
         }
 
+        // Copy in at most two contiguous chunks, either side of the wrap
         while (bytesRead < length) {
+            chunk = (pRingBuffer->pBuffer + pRingBuffer->size) - pSource;
+            if (chunk > length - bytesRead) {
+                chunk = length - bytesRead;
+            }
             if (pData != NULL) {
-                *pData = *pSource;
-                pData++;
+                memcpy(pData + bytesRead, pSource, chunk);
             }
-            pSource = pPtrInc(pSource, pRingBuffer->pBuffer, pRingBuffer->size);
-            bytesRead++;
+            pSource = pPtrOffset(pSource, chunk, pRingBuffer->pBuffer, pRingBuffer->size);
+            bytesRead += chunk;
         }
         if (destructive) {
-            pRingBuffer->pDataRead[handle] = pSource;
+            // Only publish the new read pointer once the data is out
+            readSet(pRingBuffer, handle, pSource);
         }
     }
 
     return bytesRead;
 }
 
-// The ring buffer's mutex should be locked before this is called
+// The ring buffer's mutex should be locked before this is called,
+// unless the ring buffer is lock-free.
 static bool add(uRingBuffer_t *pRingBuffer, const char *pData,
                 size_t length, bool destructive)
 {
     bool dataFitsInBuffer = true;
+    // Only the producer moves the write pointer so it may be read directly
+    char *pWrite = pRingBuffer->pDataWrite;
+    const char *pRead;
     size_t lost;
     size_t used;
+    size_t chunk;
 
     if (length >= pRingBuffer->size) {
         dataFitsInBuffer = false;
     } else {
         for (size_t x = 0; (x < pRingBuffer->maxNumReadPointers) &&
              (dataFitsInBuffer || destructive); x++) {
-            if (pRingBuffer->pDataRead[x] != NULL) {
-                used = ptrDiff(pRingBuffer->pDataRead[x], pRingBuffer->pDataWrite, pRingBuffer->size);
+            pRead = pReadGet(pRingBuffer, x);
+            if (pRead != NULL) {
+                used = ptrDiff(pRead, pWrite, pRingBuffer->size);
                 used++; // Account for the fact that we can't have the pointers overlap
                 if (used + length > pRingBuffer->size) {
                     // If we're on the "normal" read pointer (0) and it can't be used (because
@@ -215,13 +267,19 @@ static bool add(uRingBuffer_t *pRingBuffer, const char *pData,
     }
 
     if (dataFitsInBuffer) {
+        // Copy in at most two contiguous chunks, either side of the wrap
         while (length > 0) {
-            *(pRingBuffer->pDataWrite) = *pData;
-            pRingBuffer->pDataWrite = (char *) pPtrInc(pRingBuffer->pDataWrite, pRingBuffer->pBuffer,
-                                                       pRingBuffer->size);
-            length--;
-            pData++;
+            chunk = (pRingBuffer->pBuffer + pRingBuffer->size) - pWrite;
+            if (chunk > length) {
+                chunk = length;
+            }
+            memcpy(pWrite, pData, chunk);
+            pWrite = (char *) pPtrOffset(pWrite, chunk, pRingBuffer->pBuffer, pRingBuffer->size);
+            length -= chunk;
+            pData += chunk;
         }
+        // Only publish the new write pointer once the data is in
+        U_ATOMIC_SET(&(pRingBuffer->pDataWrite), pWrite);
     } else {
         pRingBuffer->statAddLossBytes += length;
     }
@@ -229,6 +287,47 @@ static bool add(uRingBuffer_t *pRingBuffer, const char *pData,
     return dataFitsInBuffer;
 }
 
+// Return the distance from pSource to the nearest of pSyncBytes,
+// bytesAvailable if there is none.  pSyncPosition caches, for each
+// sync byte, where it was last found (in terms of bytesDiscard) so
+// that the search for that byte is only repeated once the parse has
+// moved past it; SIZE_MAX means "not yet searched for".
+static size_t syncSkip(const uRingBuffer_t *pRingBuffer, const char *pSource,
+                       size_t bytesAvailable, size_t bytesDiscard,
+                       const char *pSyncBytes, size_t numSyncBytes,
+                       size_t *pSyncPosition)
+{
+    size_t nearest = bytesAvailable;
+    size_t firstSpanLength = (pRingBuffer->pBuffer + pRingBuffer->size) - pSource;
+    const char *pFound;
+
+    if (firstSpanLength > bytesAvailable) {
+        firstSpanLength = bytesAvailable;
+    }
+    for (size_t x = 0; x < numSyncBytes; x++) {
+        if ((pSyncPosition[x] == SIZE_MAX) || (pSyncPosition[x] < bytesDiscard)) {
+            // Not found is recorded as the end of the data
+            pSyncPosition[x] = bytesDiscard + bytesAvailable;
+            pFound = (const char *) memchr(pSource, pSyncBytes[x], firstSpanLength);
+            if (pFound != NULL) {
+                pSyncPosition[x] = bytesDiscard + (pFound - pSource);
+            } else if (bytesAvailable > firstSpanLength) {
+                pFound = (const char *) memchr(pRingBuffer->pBuffer, pSyncBytes[x],
+                                               bytesAvailable - firstSpanLength);
+                if (pFound != NULL) {
+                    pSyncPosition[x] = bytesDiscard + firstSpanLength +
+                                       (pFound - pRingBuffer->pBuffer);
+                }
+            }
+        }
+        if (pSyncPosition[x] - bytesDiscard < nearest) {
+            nearest = pSyncPosition[x] - bytesDiscard;
+        }
+    }
+
+    return nearest;
+}
+
 // This function does the ring buffer mutex locking itself.
 static size_t lock(uRingBuffer_t *pRingBuffer, int32_t handle, bool lockNotUnlock)
 {
@@ -241,7 +340,8 @@ static size_t lock(uRingBuffer_t *pRingBuffer, int32_t handle, bool lockNotUnloc
         if ((handle >= 1) && (handle < (int32_t) pRingBuffer->maxNumReadPointers)) {
             if (lockNotUnlock) {
                 pRingBuffer->dataReadLockBitmap |= 1ULL << (handle - 1);
-                dataSize = ptrDiff(pRingBuffer->pDataRead[handle], pRingBuffer->pDataWrite, pRingBuffer->size);
+                dataSize = ptrDiff(pReadGet(pRingBuffer, handle), pWriteGet(pRingBuffer),
+                                   pRingBuffer->size);
             } else {
                 pRingBuffer->dataReadLockBitmap &= ~(1ULL << (handle - 1));
             }
@@ -275,7 +375,7 @@ static size_t availableSize(const uRingBuffer_t *pRingBuffer, bool max)
                 // locked data buffer pointers and we ignore 0 since
                 // it is not lockable
                 if (!max || ((x > 0) && (pRingBuffer->dataReadLockBitmap & (1ULL << (x - 1))))) {
-                    y = pRingBuffer->size - ptrDiff(pRingBuffer->pDataRead[x], pRingBuffer->pDataWrite,
+                    y = pRingBuffer->size - ptrDiff(pReadGet(pRingBuffer, x), pWriteGet(pRingBuffer),
                                                     pRingBuffer->size);
                     if (y < size) {
                         size = y;
@@ -289,7 +389,7 @@ static size_t availableSize(const uRingBuffer_t *pRingBuffer, bool max)
             // If we didn't find a single data read pointer,
             // and we're not doing max, report what is in the
             // buffer anyway
-            size = pRingBuffer->size - ptrDiff(pRingBuffer->pBuffer, pRingBuffer->pDataWrite,
+            size = pRingBuffer->size - ptrDiff(pRingBuffer->pBuffer, pWriteGet(pRingBuffer),
                                                pRingBuffer->size);
         }
         if (size > 0) {
@@ -398,6 +498,18 @@ int32_t uRingBufferCreate(uRingBuffer_t *pRingBuffer, char *pLinearBuffer, size_
     return createCommon(pRingBuffer, pLinearBuffer, size);
 }
 
+int32_t uRingBufferCreateLockFree(uRingBuffer_t *pRingBuffer, char *pLinearBuffer,
+                                  size_t size)
+{
+    int32_t errorCode = uRingBufferCreate(pRingBuffer, pLinearBuffer, size);
+
+    if (errorCode == 0) {
+        pRingBuffer->lockFree = true;
+    }
+
+    return errorCode;
+}
+
 void uRingBufferDelete(uRingBuffer_t *pRingBuffer)
 {
     if ((pRingBuffer != NULL) && (pRingBuffer->mutex != NULL)) {
@@ -420,11 +532,11 @@ bool uRingBufferAdd(uRingBuffer_t *pRingBuffer, const char *pData, size_t length
 
     if (pRingBuffer->pBuffer != NULL) {
 
-        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+        dataLock(pRingBuffer);
 
         dataFitsInBuffer = add(pRingBuffer, pData, length, false);
 
-        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+        dataUnlock(pRingBuffer);
     }
 
     return dataFitsInBuffer;
@@ -438,7 +550,10 @@ bool uRingBufferForceAdd(uRingBuffer_t *pRingBuffer, const char *pData, size_t l
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
 
-        dataFitsInBuffer = add(pRingBuffer, pData, length, true);
+        // A lock-free ring buffer cannot have its read pointers
+        // moved on from under a consumer, hence a forced add
+        // becomes a normal add in that case
+        dataFitsInBuffer = add(pRingBuffer, pData, length, !pRingBuffer->lockFree);
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
     }
@@ -452,11 +567,11 @@ size_t uRingBufferRead(uRingBuffer_t *pRingBuffer, char *pData, size_t length)
 
     if ((pRingBuffer->pBuffer != NULL) && !pRingBuffer->readHandleRequired) {
 
-        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+        dataLock(pRingBuffer);
 
         bytesRead = read(pRingBuffer, 0, pData, length, 0, true);
 
-        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+        dataUnlock(pRingBuffer);
     }
 
     return bytesRead;
@@ -469,11 +584,11 @@ size_t uRingBufferPeek(uRingBuffer_t *pRingBuffer, char *pData, size_t length,
 
     if ((pRingBuffer->pBuffer != NULL) && !pRingBuffer->readHandleRequired) {
 
-        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+        dataLock(pRingBuffer);
 
         bytesRead = read(pRingBuffer, 0, pData, length, offset, false);
 
-        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+        dataUnlock(pRingBuffer);
     }
 
     return bytesRead;
@@ -485,14 +600,14 @@ size_t uRingBufferDataSize(const uRingBuffer_t *pRingBuffer)
 
     if (pRingBuffer->pBuffer != NULL) {
 
-        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+        dataLock(pRingBuffer);
 
         if (!pRingBuffer->readHandleRequired) {
             // Only report if the non-handled read can be used
-            dataSize = ptrDiff(pRingBuffer->pDataRead[0], pRingBuffer->pDataWrite, pRingBuffer->size);
+            dataSize = ptrDiff(pReadGet(pRingBuffer, 0), pWriteGet(pRingBuffer), pRingBuffer->size);
         }
 
-        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+        dataUnlock(pRingBuffer);
     }
 
     return dataSize;
@@ -509,7 +624,7 @@ void uRingBufferFlush(uRingBuffer_t *pRingBuffer)
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
 
-        pRingBuffer->pDataRead[0] = pRingBuffer->pDataWrite;
+        readSet(pRingBuffer, 0, pWriteGet(pRingBuffer));
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
     }
@@ -525,15 +640,15 @@ void uRingBufferFlushValue(uRingBuffer_t *pRingBuffer, char value, size_t length
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
 
-        pData = pRingBuffer->pDataRead[0];
-        dataSize = ptrDiff(pData, pRingBuffer->pDataWrite, pRingBuffer->size);
+        pData = pReadGet(pRingBuffer, 0);
+        dataSize = ptrDiff(pData, pWriteGet(pRingBuffer), pRingBuffer->size);
         if (dataSize >= length) {
             while ((bytesRead < dataSize) && (*pData == value)) {
                 pData = pPtrInc(pData, pRingBuffer->pBuffer, pRingBuffer->size);
                 bytesRead++;
             }
             if (bytesRead >= length) {
-                pRingBuffer->pDataRead[0] = pData;
+                readSet(pRingBuffer, 0, pData);
             }
         }
 
@@ -619,6 +734,20 @@ int32_t uRingBufferCreateWithReadHandle(uRingBuffer_t *pRingBuffer, char *pLinea
     return errorCode;
 }
 
+int32_t uRingBufferCreateWithReadHandleLockFree(uRingBuffer_t *pRingBuffer,
+                                                char *pLinearBuffer, size_t size,
+                                                size_t maxNumReadHandles)
+{
+    int32_t errorCode = uRingBufferCreateWithReadHandle(pRingBuffer, pLinearBuffer,
+                                                        size, maxNumReadHandles);
+
+    if (errorCode == 0) {
+        pRingBuffer->lockFree = true;
+    }
+
+    return errorCode;
+}
+
 void uRingBufferSetReadRequiresHandle(uRingBuffer_t *pRingBuffer, bool onNotOff)
 {
     if (pRingBuffer->pBuffer != NULL) {
@@ -656,7 +785,7 @@ int32_t uRingBufferTakeReadHandle(uRingBuffer_t *pRingBuffer)
         for (size_t x = 1; (x < pRingBuffer->maxNumReadPointers) &&
              (readHandle < 0); x++) {
             if (pRingBuffer->pDataRead[x] == NULL) {
-                pRingBuffer->pDataRead[x] = pRingBuffer->pDataWrite;
+                readSet(pRingBuffer, x, pWriteGet(pRingBuffer));
                 pRingBuffer->statReadLossBytes[x] = 0;
                 readHandle = x;
             }
@@ -675,7 +804,7 @@ void uRingBufferGiveReadHandle(uRingBuffer_t *pRingBuffer, int32_t handle)
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
 
         if ((handle >= 1) && (handle < (int32_t) pRingBuffer->maxNumReadPointers)) {
-            pRingBuffer->pDataRead[handle] = NULL;
+            readSet(pRingBuffer, handle, NULL);
             pRingBuffer->dataReadLockBitmap &= ~(1ULL << (handle - 1));
         }
 
@@ -722,11 +851,11 @@ size_t uRingBufferReadHandle(uRingBuffer_t *pRingBuffer, int32_t handle,
 
     if (pRingBuffer->pBuffer != NULL) {
 
-        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+        dataLock(pRingBuffer);
 
         bytesRead = read(pRingBuffer, handle, pData, length, 0, true);
 
-        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+        dataUnlock(pRingBuffer);
     }
 
     return bytesRead;
@@ -739,11 +868,11 @@ size_t uRingBufferPeekHandle(uRingBuffer_t *pRingBuffer, int32_t handle,
 
     if (pRingBuffer->pBuffer != NULL) {
 
-        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+        dataLock(pRingBuffer);
 
         bytesRead = read(pRingBuffer, handle, pData, length, offset, false);
 
-        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+        dataUnlock(pRingBuffer);
     }
 
     return bytesRead;
@@ -755,14 +884,15 @@ size_t uRingBufferDataSizeHandle(const uRingBuffer_t *pRingBuffer, int32_t handl
 
     if (pRingBuffer->pBuffer != NULL) {
 
-        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+        dataLock(pRingBuffer);
 
         if ((handle >= 1) && (handle < (int32_t) pRingBuffer->maxNumReadPointers) &&
-            (pRingBuffer->pDataRead[handle] != NULL)) {
-            dataSize = ptrDiff(pRingBuffer->pDataRead[handle], pRingBuffer->pDataWrite, pRingBuffer->size);
+            (pReadGet(pRingBuffer, handle) != NULL)) {
+            dataSize = ptrDiff(pReadGet(pRingBuffer, handle), pWriteGet(pRingBuffer),
+                               pRingBuffer->size);
         }
 
-        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+        dataUnlock(pRingBuffer);
     }
 
     return dataSize;
@@ -781,7 +911,7 @@ void uRingBufferFlushHandle(uRingBuffer_t *pRingBuffer, int32_t handle)
 
         if ((handle >= 1) && (handle < (int32_t) pRingBuffer->maxNumReadPointers) &&
             (pRingBuffer->pDataRead[handle] != NULL)) {
-            pRingBuffer->pDataRead[handle] = pRingBuffer->pDataWrite;
+            readSet(pRingBuffer, handle, pWriteGet(pRingBuffer));
         }
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
@@ -814,21 +944,53 @@ size_t uRingBufferStatReadLossHandle(uRingBuffer_t *pRingBuffer,
 
 size_t uRingBufferParseHandle(uRingBuffer_t *pRingBuffer, int32_t handle,
                               U_RING_BUFFER_PARSER_f *pParserList, void *pUserParam)
+{
+    return uRingBufferParseHandleSync(pRingBuffer, handle, pParserList,
+                                      NULL, 0, pUserParam);
+}
+
+size_t uRingBufferParseHandleSync(uRingBuffer_t *pRingBuffer, int32_t handle,
+                                  U_RING_BUFFER_PARSER_f *pParserList,
+                                  const char *pSyncBytes, size_t numSyncBytes,
+                                  void *pUserParam)
 {
     int32_t errorCodeOrLength = U_ERROR_COMMON_INVALID_PARAMETER;
+    size_t syncPosition[U_RING_BUFFER_PARSE_SYNC_BYTES_MAX_NUM];
+    size_t skip;
 
-    if (pRingBuffer->pBuffer != NULL) {
+    if (pSyncBytes == NULL) {
+        numSyncBytes = 0;
+    }
 
-        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+    if ((pRingBuffer->pBuffer != NULL) &&
+        (numSyncBytes <= U_RING_BUFFER_PARSE_SYNC_BYTES_MAX_NUM)) {
+
+        dataLock(pRingBuffer);
 
         if ((handle >= 0) && (handle < (int32_t) pRingBuffer->maxNumReadPointers) &&
-            (pRingBuffer->pDataRead[handle] != NULL)) {
-            const char *pOffset = pPtrOffset(pRingBuffer->pDataRead[handle], 0, pRingBuffer->pBuffer,
+            (pReadGet(pRingBuffer, handle) != NULL)) {
+            const char *pOffset = pPtrOffset(pReadGet(pRingBuffer, handle), 0, pRingBuffer->pBuffer,
                                              pRingBuffer->size);
-            size_t bytesAvailable = ptrDiff(pOffset, pRingBuffer->pDataWrite, pRingBuffer->size);
+            // For a lock-free ring buffer this is a snapshot: the
+            // producer may add more while we parse, which is fine
+            size_t bytesAvailable = ptrDiff(pOffset, pWriteGet(pRingBuffer), pRingBuffer->size);
             size_t bytesDiscard  = 0;
+            for (size_t x = 0; x < numSyncBytes; x++) {
+                syncPosition[x] = SIZE_MAX;
+            }
             errorCodeOrLength = U_ERROR_COMMON_TIMEOUT;
             while (bytesAvailable) {
+                if (numSyncBytes > 0) {
+                    // Jump to the next place a message might start
+                    skip = syncSkip(pRingBuffer, pOffset, bytesAvailable, bytesDiscard,
+                                    pSyncBytes, numSyncBytes, syncPosition);
+                    pOffset = pPtrOffset(pOffset, skip, pRingBuffer->pBuffer, pRingBuffer->size);
+                    bytesDiscard += skip;
+                    bytesAvailable -= skip;
+                    if (bytesAvailable == 0) {
+                        break;
+                    }
+                }
                 U_RING_BUFFER_PARSER_f *pParser = pParserList;
                 // find the right protocol
                 errorCodeOrLength = U_ERROR_COMMON_NOT_FOUND;
@@ -861,13 +1023,12 @@ size_t uRingBufferParseHandle(uRingBuffer_t *pRingBuffer, int32_t handle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+        dataUnlock(pRingBuffer);
     }
 
     return errorCodeOrLength;
 }
 
-
 bool uRingBufferGetByteUnprotected(uParseHandle_t parseHandle, void *p)
 {
     uRingBufferParseContext_t *pCtx = (uRingBufferParseContext_t *)parseHandle;
@@ -894,4 +1055,43 @@ size_t uRingBufferBytesDiscardUnprotected(uParseHandle_t parseHandle)
     return pCtx->bytesDiscard;
 }
 
+size_t uRingBufferGetSpansUnprotected(uParseHandle_t parseHandle,
+                                      uRingBufferSpan_t *pSpans)
+{
+    uRingBufferParseContext_t *pCtx = (uRingBufferParseContext_t *)parseHandle;
+    const uRingBuffer_t *pRingBuffer = pCtx->pRingBuffer;
+    size_t numSpans = 0;
+    size_t toEnd = (pRingBuffer->pBuffer + pRingBuffer->size) - pCtx->pSource;
+
+    if (pCtx->bytesAvailable > 0) {
+        pSpans->pData = pCtx->pSource;
+        pSpans->length = pCtx->bytesAvailable;
+        numSpans++;
+        if (pCtx->bytesAvailable > toEnd) {
+            pSpans->length = toEnd;
+            pSpans++;
+            pSpans->pData = pRingBuffer->pBuffer;
+            pSpans->length = pCtx->bytesAvailable - toEnd;
+            numSpans++;
+        }
+    }
+
+    return numSpans;
+}
+
+size_t uRingBufferSkipUnprotected(uParseHandle_t parseHandle, size_t length)
+{
+    uRingBufferParseContext_t *pCtx = (uRingBufferParseContext_t *)parseHandle;
+
+    if (length > pCtx->bytesAvailable) {
+        length = pCtx->bytesAvailable;
+    }
+    pCtx->pSource = pPtrOffset(pCtx->pSource, length, pCtx->pRingBuffer->pBuffer,
+                               pCtx->pRingBuffer->size);
+    pCtx->bytesParsed += length;
+    pCtx->bytesAvailable -= length;
+
+    return length;
+}
+
 // End of file
@@ -35,6 +35,7 @@
 #include "string.h"    // strncpy(), strcmp(), memcpy(), memset()
 
 #include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
 #include "u_cfg_app_platform_specific.h"
 #include "u_cfg_test_platform_specific.h"
 
@@ -77,14 +78,60 @@
 # define U_TEST_UTILS_RINGBUFFER_FILL_CHAR 0x5a
 #endif
 
+#ifndef U_TEST_UTILS_RINGBUFFER_THROUGHPUT_SIZE
+/** The ring buffer size to use when measuring throughput.
+ */
+# define U_TEST_UTILS_RINGBUFFER_THROUGHPUT_SIZE 1024
+#endif
+
+#ifndef U_TEST_UTILS_RINGBUFFER_THROUGHPUT_BLOCK_SIZE
+/** The size of the blocks added to/read from the ring buffer when
+ * measuring throughput.
+ */
+# define U_TEST_UTILS_RINGBUFFER_THROUGHPUT_BLOCK_SIZE 64
+#endif
+
+#ifndef U_TEST_UTILS_RINGBUFFER_THROUGHPUT_BYTES
+/** The number of bytes to pass from a producer task to a
+ * consumer task through the ring buffer when measuring throughput.
+ */
+# define U_TEST_UTILS_RINGBUFFER_THROUGHPUT_BYTES (256 * 1024)
+#endif
+
+#ifndef U_TEST_UTILS_RINGBUFFER_THROUGHPUT_SINGLE_TASK_BYTES
+/** The number of bytes to add/read from a single task when
+ * measuring throughput; this is quicker so can be larger.
+ */
+# define U_TEST_UTILS_RINGBUFFER_THROUGHPUT_SINGLE_TASK_BYTES (4 * 1024 * 1024)
+#endif
+
+#ifndef U_TEST_UTILS_RINGBUFFER_THROUGHPUT_TIMEOUT_MS
+/** Guard timer on the two-task throughput measurement.
+ */
+# define U_TEST_UTILS_RINGBUFFER_THROUGHPUT_TIMEOUT_MS 60000
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** Parameters for the producer task of the throughput test.
+ */
+typedef struct {
+    uRingBuffer_t *pRingBuffer;
+    size_t numBytes;
+    volatile bool done;
+} uTestUtilsRingBufferProducer_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
 
+/** The linear buffer used by the throughput test, static to keep
+ * it off the stack.
+ */
+static char gThroughputBuffer[U_TEST_UTILS_RINGBUFFER_THROUGHPUT_SIZE];
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -109,6 +156,188 @@ static void printBuffer(const char *pTitle, const char *pStr, size_t length)
     uPortTaskBlock(10);
 }
 
+// Fill a block with a pattern that depends on its position in the stream.
+static void patternFill(char *pBuffer, size_t length, size_t position)
+{
+    for (size_t x = 0; x < length; x++) {
+        *pBuffer++ = (char) (position + x);
+    }
+}
+
+// Check a block against the pattern written by patternFill().
+static bool patternCheck(const char *pBuffer, size_t length, size_t position)
+{
+    bool good = true;
+
+    for (size_t x = 0; (x < length) && good; x++) {
+        good = (*pBuffer++ == (char) (position + x));
+    }
+
+    return good;
+}
+
+// Parser for the parse test: a message is '<', a length byte, that
+// many bytes of body and then '>'; the body is summed, into the
+// int32_t at pUserParam, using the span interface.
+static int32_t parseTestMessage(uParseHandle_t parseHandle, void *pUserParam)
+{
+    int32_t *pSum = (int32_t *) pUserParam;
+    uRingBufferSpan_t span[2];
+    size_t numSpans;
+    size_t length;
+    size_t y;
+    char c;
+
+    if (!uRingBufferGetByteUnprotected(parseHandle, &c)) {
+        return U_ERROR_COMMON_TIMEOUT;
+    }
+    if (c != '<') {
+        return U_ERROR_COMMON_NOT_FOUND;
+    }
+    if (!uRingBufferGetByteUnprotected(parseHandle, &c)) {
+        return U_ERROR_COMMON_TIMEOUT;
+    }
+    length = (uint8_t) c;
+    if (uRingBufferBytesAvailableUnprotected(parseHandle) < length + 1) {
+        return U_ERROR_COMMON_TIMEOUT;
+    }
+    *pSum = 0;
+    numSpans = uRingBufferGetSpansUnprotected(parseHandle, span);
+    y = length;
+    for (size_t x = 0; (x < numSpans) && (y > 0); x++) {
+        for (size_t z = 0; (z < span[x].length) && (y > 0); z++) {
+            *pSum += *(span[x].pData + z);
+            y--;
+        }
+    }
+    if (uRingBufferSkipUnprotected(parseHandle, length) != length) {
+        return U_ERROR_COMMON_NOT_FOUND;
+    }
+    if (!uRingBufferGetByteUnprotected(parseHandle, &c) || (c != '>')) {
+        return U_ERROR_COMMON_NOT_FOUND;
+    }
+
+    return U_ERROR_COMMON_SUCCESS;
+}
+
+// Run uRingBufferParseHandle() and uRingBufferParseHandleSync() on
+// the "normal" read pointer of a ring buffer and check that they agree.
+static int32_t parseBoth(uRingBuffer_t *pRingBuffer, int32_t *pSum)
+{
+    U_RING_BUFFER_PARSER_f parserList[] = {parseTestMessage, NULL};
+    int32_t sumSync = -1;
+    int32_t errorCodeOrLength;
+
+    *pSum = -1;
+    errorCodeOrLength = (int32_t) uRingBufferParseHandle(pRingBuffer, 0, parserList, pSum);
+    if ((int32_t) uRingBufferParseHandleSync(pRingBuffer, 0, parserList, "<", 1,
+                                             &sumSync) != errorCodeOrLength) {
+        errorCodeOrLength = (int32_t) U_ERROR_COMMON_UNKNOWN;
+    }
+    if (sumSync != *pSum) {
+        errorCodeOrLength = (int32_t) U_ERROR_COMMON_UNKNOWN;
+    }
+
+    return errorCodeOrLength;
+}
+
+// Pass numBytes through a ring buffer from a single task, adding then
+// reading a block at a time: this measures the overhead of each call;
+// returns the time taken in milliseconds or negative on error.
+static int32_t throughputSingleTask(uRingBuffer_t *pRingBuffer, size_t numBytes)
+{
+    char block[U_TEST_UTILS_RINGBUFFER_THROUGHPUT_BLOCK_SIZE];
+    size_t position = 0;
+    size_t length;
+    int32_t startTimeMs = uPortGetTickTimeMs();
+
+    while (position < numBytes) {
+        length = numBytes - position;
+        if (length > sizeof(block)) {
+            length = sizeof(block);
+        }
+        patternFill(block, length, position);
+        if (!uRingBufferAdd(pRingBuffer, block, length) ||
+            (uRingBufferRead(pRingBuffer, block, sizeof(block)) != length) ||
+            !patternCheck(block, length, position)) {
+            return -1;
+        }
+        position += length;
+    }
+
+    return uPortGetTickTimeMs() - startTimeMs;
+}
+
+// Producer task for throughputTwoTasks().
+static void producerTask(void *pParameter)
+{
+    uTestUtilsRingBufferProducer_t *pProducer = (uTestUtilsRingBufferProducer_t *) pParameter;
+    char block[U_TEST_UTILS_RINGBUFFER_THROUGHPUT_BLOCK_SIZE];
+    size_t position = 0;
+    size_t length;
+
+    while (position < pProducer->numBytes) {
+        length = pProducer->numBytes - position;
+        if (length > sizeof(block)) {
+            length = sizeof(block);
+        }
+        patternFill(block, length, position);
+        while (!uRingBufferAdd(pProducer->pRingBuffer, block, length)) {
+            uPortTaskBlock(1);
+        }
+        position += length;
+    }
+
+    pProducer->done = true;
+    uPortTaskDelete(NULL);
+}
+
+// Pass numBytes through a ring buffer from a producer task to
+// this task: this is the real-world case and checks that data
+// is not corrupted by concurrent access; returns the time taken in
+// milliseconds or negative on error.
+static int32_t throughputTwoTasks(uRingBuffer_t *pRingBuffer, size_t numBytes)
+{
+    int32_t errorCodeOrTimeMs;
+    uTestUtilsRingBufferProducer_t producer = {.pRingBuffer = pRingBuffer,
+                                               .numBytes = numBytes,
+                                               .done = false
+                                              };
+    uPortTaskHandle_t taskHandle;
+    char block[U_TEST_UTILS_RINGBUFFER_THROUGHPUT_BLOCK_SIZE];
+    size_t position = 0;
+    size_t length;
+    int32_t startTimeMs = uPortGetTickTimeMs();
+
+    errorCodeOrTimeMs = uPortTaskCreate(producerTask, "testProducer",
+                                        U_CFG_TEST_OS_TASK_STACK_SIZE_BYTES,
+                                        (void *) &producer,
+                                        U_CFG_TEST_OS_TASK_PRIORITY,
+                                        &taskHandle);
+    while ((errorCodeOrTimeMs == 0) && (position < numBytes)) {
+        length = uRingBufferRead(pRingBuffer, block, sizeof(block));
+        if (!patternCheck(block, length, position)) {
+            errorCodeOrTimeMs = -1;
+        } else if ((uPortGetTickTimeMs() - startTimeMs) >
+                   U_TEST_UTILS_RINGBUFFER_THROUGHPUT_TIMEOUT_MS) {
+            errorCodeOrTimeMs = (int32_t) U_ERROR_COMMON_TIMEOUT;
+        } else if (length == 0) {
+            uPortTaskBlock(1);
+        }
+        position += length;
+    }
+    if (errorCodeOrTimeMs == 0) {
+        errorCodeOrTimeMs = uPortGetTickTimeMs() - startTimeMs;
+        // Let the producer task exit
+        while (!producer.done) {
+            uPortTaskBlock(10);
+        }
+        uPortTaskBlock(U_CFG_OS_YIELD_MS + 100);
+    }
+
+    return errorCodeOrTimeMs;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: TESTS
  * -------------------------------------------------------------- */
@@ -883,4 +1112,146 @@ U_PORT_TEST_FUNCTION("[ringbuffer]", "ringbufferBasic")
     U_PORT_TEST_ASSERT(resourceCount <= 0);
 }
 
-// End of file
\ No newline at end of file
+/** Test the lock-free form of ring buffer and compare its
+ * throughput with that of the normal form.
+ */
+U_PORT_TEST_FUNCTION("[ringbuffer]", "ringbufferLockFree")
+{
+    int32_t resourceCount;
+    uRingBuffer_t ringBuffer = {0};
+    char block[U_TEST_UTILS_RINGBUFFER_THROUGHPUT_BLOCK_SIZE];
+    int32_t handle;
+    int32_t timeMs[2][2];
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    for (size_t lockFree = 0; lockFree < 2; lockFree++) {
+        U_TEST_PRINT_LINE("measuring throughput of %s ring buffer, blocks of %d"
+                          " byte(s) through a %d byte buffer...",
+                          lockFree ? "lock-free" : "normal",
+                          U_TEST_UTILS_RINGBUFFER_THROUGHPUT_BLOCK_SIZE,
+                          sizeof(gThroughputBuffer));
+        if (lockFree) {
+            U_PORT_TEST_ASSERT(uRingBufferCreateLockFree(&ringBuffer, gThroughputBuffer,
+                                                         sizeof(gThroughputBuffer)) == 0);
+        } else {
+            U_PORT_TEST_ASSERT(uRingBufferCreate(&ringBuffer, gThroughputBuffer,
+                                                 sizeof(gThroughputBuffer)) == 0);
+        }
+        timeMs[lockFree][0] = throughputSingleTask(&ringBuffer,
+                                                   U_TEST_UTILS_RINGBUFFER_THROUGHPUT_SINGLE_TASK_BYTES);
+        U_TEST_PRINT_LINE(" single task, %d byte(s): %d ms.",
+                          U_TEST_UTILS_RINGBUFFER_THROUGHPUT_SINGLE_TASK_BYTES,
+                          timeMs[lockFree][0]);
+        U_PORT_TEST_ASSERT(timeMs[lockFree][0] >= 0);
+        timeMs[lockFree][1] = throughputTwoTasks(&ringBuffer,
+                                                 U_TEST_UTILS_RINGBUFFER_THROUGHPUT_BYTES);
+        U_TEST_PRINT_LINE(" producer and consumer tasks, %d byte(s): %d ms.",
+                          U_TEST_UTILS_RINGBUFFER_THROUGHPUT_BYTES, timeMs[lockFree][1]);
+        U_PORT_TEST_ASSERT(timeMs[lockFree][1] >= 0);
+        U_PORT_TEST_ASSERT(uRingBufferDataSize(&ringBuffer) == 0);
+        uRingBufferDelete(&ringBuffer);
+    }
+    U_TEST_PRINT_LINE("single task lock-free/normal %d/%d ms, producer/consumer"
+                      " lock-free/normal %d/%d ms.", timeMs[1][0], timeMs[0][0],
+                      timeMs[1][1], timeMs[0][1]);
+
+    // A forced add to a lock-free ring buffer must not move
+    // a read pointer on
+    U_PORT_TEST_ASSERT(uRingBufferCreateWithReadHandleLockFree(&ringBuffer, gThroughputBuffer,
+                                                               sizeof(block) + 1, 1) == 0);
+    handle = uRingBufferTakeReadHandle(&ringBuffer);
+    U_PORT_TEST_ASSERT(handle > 0);
+    patternFill(block, sizeof(block), 0);
+    U_PORT_TEST_ASSERT(uRingBufferForceAdd(&ringBuffer, block, sizeof(block)));
+    U_PORT_TEST_ASSERT(!uRingBufferForceAdd(&ringBuffer, block, 1));
+    U_PORT_TEST_ASSERT(uRingBufferStatReadLossHandle(&ringBuffer, handle) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferDataSizeHandle(&ringBuffer, handle) == sizeof(block));
+    memset(block, 0, sizeof(block));
+    U_PORT_TEST_ASSERT(uRingBufferReadHandle(&ringBuffer, handle, block,
+                                             sizeof(block)) == sizeof(block));
+    U_PORT_TEST_ASSERT(patternCheck(block, sizeof(block), 0));
+    uRingBufferGiveReadHandle(&ringBuffer, handle);
+    uRingBufferDelete(&ringBuffer);
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Test the parser interface of the ring buffer, with and
+ * without sync bytes, including a message that wraps.
+ */
+U_PORT_TEST_FUNCTION("[ringbuffer]", "ringbufferParse")
+{
+    int32_t resourceCount;
+    uRingBuffer_t ringBuffer = {0};
+    char linearBuffer[32];
+    U_RING_BUFFER_PARSER_f parserList[] = {parseTestMessage, NULL};
+    const char message[] = {'a', 'b', '<', 5, 1, 2, 3, 4, 5, '>'};
+    int32_t sum;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    U_PORT_TEST_ASSERT(uRingBufferCreate(&ringBuffer, linearBuffer, sizeof(linearBuffer)) == 0);
+    // Move the pointers close to the end of the buffer so that
+    // the message wraps
+    memset(linearBuffer, 'x', sizeof(linearBuffer));
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, linearBuffer, sizeof(linearBuffer) - 4));
+    U_PORT_TEST_ASSERT(uRingBufferRead(&ringBuffer, NULL,
+                                       sizeof(linearBuffer)) == sizeof(linearBuffer) - 4);
+
+    // The first parse should discard the two leading bytes,
+    // the second should find the message
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, message, sizeof(message)));
+    U_PORT_TEST_ASSERT(parseBoth(&ringBuffer, &sum) == 2);
+    U_PORT_TEST_ASSERT(uRingBufferRead(&ringBuffer, NULL, 2) == 2);
+    U_PORT_TEST_ASSERT(parseBoth(&ringBuffer, &sum) == sizeof(message) - 2);
+    U_PORT_TEST_ASSERT(sum == 1 + 2 + 3 + 4 + 5);
+    U_PORT_TEST_ASSERT(uRingBufferRead(&ringBuffer, NULL, sizeof(message)) == sizeof(message) - 2);
+
+    // A partial message needs more data
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, message + 2, 4));
+    U_PORT_TEST_ASSERT(parseBoth(&ringBuffer, &sum) == (int32_t) U_ERROR_COMMON_TIMEOUT);
+    // Completing it should find it
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, message + 6, sizeof(message) - 6));
+    U_PORT_TEST_ASSERT(parseBoth(&ringBuffer, &sum) == sizeof(message) - 2);
+    U_PORT_TEST_ASSERT(sum == 1 + 2 + 3 + 4 + 5);
+    U_PORT_TEST_ASSERT(uRingBufferRead(&ringBuffer, NULL, sizeof(message)) == sizeof(message) - 2);
+
+    // Nothing but rubbish should be discarded in its entirety
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, "rubbish", 7));
+    U_PORT_TEST_ASSERT(parseBoth(&ringBuffer, &sum) == 7);
+
+    // Too many sync bytes is an error
+    U_PORT_TEST_ASSERT((int32_t) uRingBufferParseHandleSync(&ringBuffer, 0, parserList,
+                                                            linearBuffer,
+                                                            U_RING_BUFFER_PARSE_SYNC_BYTES_MAX_NUM + 1,
+                                                            &sum) == (int32_t) U_ERROR_COMMON_INVALID_PARAMETER);
+
+    uRingBufferDelete(&ringBuffer);
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+// End of file
@@ -112,6 +112,14 @@ extern "C" {
                        U_GNSS_CFG_VAL_LAYER_BBRAM |                        \
                        U_GNSS_CFG_VAL_LAYER_FLASH)
 
+#ifndef U_GNSS_CFG_VAL_CACHE_MAX_NUM_KEYS
+/** The number of configuration values that the cache switched on
+ * by uGnssCfgValCacheSet() can hold; each one occupies 16 bytes of
+ * heap.  When the cache is full the oldest entry is overwritten.
+ */
+# define U_GNSS_CFG_VAL_CACHE_MAX_NUM_KEYS 32
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -731,6 +739,92 @@ int32_t uGnssCfgValDelListX(uDeviceHandle_t gnssHandle,
                             uGnssCfgValTransaction_t transaction,
                             uint32_t layers);
 
+/* ----------------------------------------------------------------
+ * FUNCTIONS: BATCHING AND CACHING OF VALSET/VALGET
+ * -------------------------------------------------------------- */
+
+/** Start a batch of configuration changes; only applicable to M9
+ * modules and beyond.  Until uGnssCfgValBatchCommit() is called,
+ * values set without a transaction, whether directly with
+ * uGnssCfgValSet() / uGnssCfgValSetList() (or the #U_GNSS_CFG_SET_VAL
+ * macros) or indirectly by functions such as uGnssCfgSetRate(),
+ * uGnssCfgSetDynamic() and uGnssCfgSetProtocolOut(), are NOT sent
+ * to the GNSS chip but are collected on the host; a later value for
+ * a key that is already in the batch replaces the earlier one.  When
+ * the batch is committed the values are sent in as few
+ * UBX-CFG-VALSET messages as possible (each carrying up to 64 keys),
+ * one set of messages for each set of layers that values were set in,
+ * wrapped in a transaction if more than one message is required so
+ * that they are still applied all at once.  This saves a round-trip
+ * to the GNSS chip per value, which is significant when a GNSS chip
+ * is being configured at start-up.
+ *
+ * Since the set functions return before the values have been sent,
+ * they will return success while batching: any error is reported
+ * by uGnssCfgValBatchCommit().  The following cause the values
+ * collected so far to be sent immediately, the batch carrying on
+ * afterwards: reading a configuration value (directly or otherwise),
+ * deleting a configuration value, setting a value as part of a
+ * transaction and setting a key that is already in the batch in a
+ * different set of layers.
+ *
+ * Calling this function when a batch has already been started has
+ * no effect.  If the GNSS instance is removed while batching, the
+ * uncommitted values are discarded.
+ *
+ * @param gnssHandle  the handle of the GNSS instance.
+ * @return            zero on success else negative error code.
+ */
+int32_t uGnssCfgValBatchStart(uDeviceHandle_t gnssHandle);
+
+/** Send the configuration values collected since
+ * uGnssCfgValBatchStart() was called to the GNSS chip and stop
+ * batching.  Calling this function when no batch has been started
+ * has no effect.
+ *
+ * @param gnssHandle  the handle of the GNSS instance.
+ * @return            zero on success else negative error code,
+ *                    which may be the result of any of the
+ *                    UBX-CFG-VALSET messages sent since the batch
+ *                    was started.
+ */
+int32_t uGnssCfgValBatchCommit(uDeviceHandle_t gnssHandle);
+
+/** Switch a host-side cache of configuration values on or off; only
+ * applicable to M9 modules and beyond, off by default.  When the cache
+ * is on, the values read from the GNSS chip with UBX-CFG-VALGET and
+ * those successfully written with UBX-CFG-VALSET without a
+ * transaction are remembered, along with the layers that they are
+ * known to be in, up to #U_GNSS_CFG_VAL_CACHE_MAX_NUM_KEYS of them.
+ * A read of a key from the #U_GNSS_CFG_VAL_LAYER_RAM,
+ * #U_GNSS_CFG_VAL_LAYER_BBRAM or #U_GNSS_CFG_VAL_LAYER_FLASH layer
+ * that can be answered from the cache is not sent to the GNSS chip,
+ * and a key that is being set to the value it is already known to
+ * have, in all of the requested layers, is left out of the
+ * UBX-CFG-VALSET message (which is not sent at all if nothing is left).
+ *
+ * This applies to all configuration done through this API, including
+ * that done by the likes of uGnssCfgGetDynamic() and uGnssPwrGetMode().
+ * The cache is emptied when the GNSS chip is powered on or off with
+ * the uGnssPwr functions and when a transaction is executed; if you
+ * change the configuration of the GNSS chip by any other means (e.g.
+ * by sending UBX-CFG messages yourself with uGnssMsgSend(), or by
+ * resetting it through a pin) you should call uGnssCfgValCacheClear().
+ *
+ * @param gnssHandle  the handle of the GNSS instance.
+ * @param onNotOff    true to switch the cache on, false to switch it
+ *                    off, freeing its memory.
+ * @return            zero on success else negative error code.
+ */
+int32_t uGnssCfgValCacheSet(uDeviceHandle_t gnssHandle, bool onNotOff);
+
+/** Empty the cache of configuration values switched on by
+ * uGnssCfgValCacheSet(); does nothing if the cache is off.
+ *
+ * @param gnssHandle  the handle of the GNSS instance.
+ */
+void uGnssCfgValCacheClear(uDeviceHandle_t gnssHandle);
+
 #ifdef __cplusplus
 }
 #endif
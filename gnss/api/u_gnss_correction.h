@@ -0,0 +1,237 @@
+/*
+ * Copyright 2019-2023 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_GNSS_CORRECTION_H_
+#define _U_GNSS_CORRECTION_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+#include "u_device.h"
+
+/** \addtogroup _GNSS
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines the correction-forwarding API of
+ * GNSS: a task which pulls SPARTN or RTCM correction data from a
+ * source of the application's choosing (e.g. a socket or an MQTT
+ * topic), checks that it is made up of valid SPARTN/RTCM messages
+ * and writes those messages, in bulk, to a GNSS chip that is
+ * connected via a streaming transport (UART, I2C, SPI or virtual
+ * serial).
+ *
+ * The source is read directly into the buffer of the forwarding
+ * task and the messages are written to the GNSS chip from that
+ * same buffer, so there is no copying of the data in the
+ * application; runs of contiguous valid messages are written to the
+ * GNSS chip with a single transport write.  Since the forwarding task
+ * only reads from the source when it has room in its buffer, and
+ * the buffer is only emptied by writing to the GNSS chip, a GNSS
+ * transport that is slower than the source pushes back on the
+ * source (e.g. a socket will simply hold on to the data, closing the
+ * TCP window), rather than data being lost.
+ *
+ * This API is not thread-safe in the sense that, once
+ * uGnssCorrectionStart() has been called, the read callback will be
+ * called from the forwarding task: the read callback should not call
+ * back into the GNSS API.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_GNSS_CORRECTION_BUFFER_LENGTH_BYTES
+/** The size of the buffer into which the correction-forwarding
+ * task reads data from the source; this must be at least as big
+ * as the largest SPARTN message (#U_SPARTN_MESSAGE_LENGTH_MAX_BYTES),
+ * which is also larger than the largest RTCM message, and is
+ * best made a few times that so that several messages may be
+ * forwarded to the GNSS chip in one write.
+ */
+# define U_GNSS_CORRECTION_BUFFER_LENGTH_BYTES 4096
+#endif
+
+#ifndef U_GNSS_CORRECTION_TASK_STACK_SIZE_BYTES
+/** The number of bytes of stack to allocate to the task started
+ * by uGnssCorrectionStart(), the context in which the read
+ * callback is called; if the read callback calls a socket or
+ * MQTT read function, which will in turn talk to a cellular or
+ * Wi-Fi module, this should be at least as big as the stack of
+ * an AT client callback.
+ */
+# define U_GNSS_CORRECTION_TASK_STACK_SIZE_BYTES (1024 * 3)
+#endif
+
+#ifndef U_GNSS_CORRECTION_TASK_POLL_TIME_MS
+/** The task started by uGnssCorrectionStart() calls the read
+ * callback when it is woken up by uGnssCorrectionNotify(); this
+ * is the longest it will wait before calling the read callback
+ * anyway, so that a source which does not call
+ * uGnssCorrectionNotify() may simply be polled.
+ */
+# define U_GNSS_CORRECTION_TASK_POLL_TIME_MS 100
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The callback that the correction-forwarding task calls to
+ * obtain data from its source, for instance a socket or an MQTT
+ * topic; the data must be written directly to pBuffer.  For a
+ * socket this might be:
+ *
+ * ```
+ * int32_t readCallback(uDeviceHandle_t gnssHandle,
+ *                      char *pBuffer, size_t size,
+ *                      void *pCallbackParam)
+ * {
+ *     return uSockRead(*((int32_t *) pCallbackParam), pBuffer, size);
+ * }
+ * ```
+ *
+ * ...with uSockRegisterCallbackData() used to arrange for
+ * uGnssCorrectionNotify() to be called when data arrives.  For an
+ * MQTT topic, uMqttClientMessageRead() may be called in the same
+ * way, with uMqttClientSetMessageCallback() used to arrange for
+ * uGnssCorrectionNotify() to be called.  The size passed to the
+ * callback is always at least #U_GNSS_CORRECTION_BUFFER_LENGTH_BYTES
+ * minus #U_SPARTN_MESSAGE_LENGTH_MAX_BYTES (since the buffer may
+ * already contain the start of a message) so, in the MQTT case,
+ * #U_GNSS_CORRECTION_BUFFER_LENGTH_BYTES should be set such that
+ * this is larger than the largest MQTT message.
+ *
+ * The data need not be aligned with message boundaries: it will
+ * be checked for valid SPARTN and RTCM messages and anything else
+ * will be discarded.  Note that something in the discarded data that
+ * looks like the start of a message will hold up the messages that
+ * follow it until enough data has arrived to show that it is not.
+ *
+ * @param gnssHandle         the handle of the GNSS instance.
+ * @param[out] pBuffer       the buffer to write data to.
+ * @param size               the amount of room at pBuffer.
+ * @param[in] pCallbackParam the pCallbackParam that was passed to
+ *                           uGnssCorrectionStart().
+ * @return                   the number of bytes written to pBuffer;
+ *                           zero or a negative value means that
+ *                           there is nothing to read at the moment.
+ */
+typedef int32_t (*uGnssCorrectionReadCallback_t)(uDeviceHandle_t gnssHandle,
+                                                 char *pBuffer, size_t size,
+                                                 void *pCallbackParam);
+
+/** Statistics on the correction-forwarding task, as returned by
+ * uGnssCorrectionStat(); all times are in units of the system tick,
+ * milliseconds, hence latencies below a millisecond will appear as
+ * zero.
+ */
+typedef struct {
+    size_t bytesRead;          /**< the number of bytes returned by the
+                                    read callback. */
+    size_t bytesForwarded;     /**< the number of bytes written to the
+                                    GNSS chip. */
+    size_t bytesDiscarded;     /**< the number of bytes discarded because
+                                    they were not part of a valid SPARTN
+                                    or RTCM message. */
+    size_t messagesForwarded;  /**< the number of SPARTN or RTCM messages
+                                    written to the GNSS chip. */
+    size_t messagesDropped;    /**< the number of valid SPARTN or RTCM
+                                    messages that were dropped because
+                                    the write to the GNSS chip failed. */
+    int32_t latencyLastMs;     /**< the time between the most recent data
+                                    arriving and the messages in it being
+                                    written to the GNSS chip: where
+                                    uGnssCorrectionNotify() is called this
+                                    is measured from that call, otherwise
+                                    from the task waking up, so any time
+                                    that the data spent waiting for the
+                                    poll is not included. */
+    int32_t latencyMaxMs;      /**< the largest value of latencyLastMs. */
+    int32_t latencyAverageMs;  /**< the average value of latencyLastMs. */
+} uGnssCorrectionStat_t;
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Start forwarding SPARTN/RTCM correction data to a GNSS chip:
+ * a task is started which calls pCallback to obtain data, checks
+ * the data for valid SPARTN or RTCM messages and writes those
+ * messages to the GNSS chip.  Only one correction source may be
+ * active per GNSS instance.  Only streaming transports (UART, I2C,
+ * SPI or virtual serial) are supported, not AT.
+ *
+ * @param gnssHandle         the handle of the GNSS instance.
+ * @param pCallback          the read callback, cannot be NULL.
+ * @param[in] pCallbackParam a parameter that will be passed to
+ *                           pCallback; may be NULL.
+ * @return                   zero on success else negative error code;
+ *                           #U_ERROR_COMMON_NOT_SUPPORTED will be
+ *                           returned if the transport is not a
+ *                           streaming one.
+ */
+int32_t uGnssCorrectionStart(uDeviceHandle_t gnssHandle,
+                             uGnssCorrectionReadCallback_t pCallback,
+                             void *pCallbackParam);
+
+/** Tell the correction-forwarding task that there is new data for
+ * it to read; call this from, for instance, the data callback of a
+ * socket or the message callback of an MQTT client.  This function
+ * does NOT lock the GNSS API, it just wakes the task up, and so may
+ * be called from any callback; it does nothing if
+ * uGnssCorrectionStart() has not been called.
+ *
+ * @param gnssHandle  the handle of the GNSS instance.
+ */
+void uGnssCorrectionNotify(uDeviceHandle_t gnssHandle);
+
+/** Stop forwarding correction data to a GNSS chip; any data read
+ * from the source but not yet forwarded is lost.  This is called
+ * automatically when the GNSS instance is removed.
+ *
+ * @param gnssHandle  the handle of the GNSS instance.
+ * @return            zero on success else negative error code.
+ */
+int32_t uGnssCorrectionStop(uDeviceHandle_t gnssHandle);
+
+/** Get the statistics of the correction-forwarding task; these are
+ * reset by uGnssCorrectionStart().
+ *
+ * @param gnssHandle   the handle of the GNSS instance.
+ * @param[out] pStat   a place to put the statistics, cannot be NULL.
+ * @return             zero on success else negative error code.
+ */
+int32_t uGnssCorrectionStat(uDeviceHandle_t gnssHandle,
+                            uGnssCorrectionStat_t *pStat);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_GNSS_CORRECTION_H_
+
+// End of file
@@ -24,6 +24,14 @@
 
 #include "u_gnss_dec_ubx_nav_pvt.h"
 #include "u_gnss_dec_ubx_nav_hpposllh.h"
+#include "u_gnss_dec_ubx_nav_dop.h"
+#include "u_gnss_dec_ubx_nav_cov.h"
+#include "u_gnss_dec_ubx_nav_timeutc.h"
+#include "u_gnss_dec_ubx_nav_sat.h"
+#include "u_gnss_dec_ubx_nav_sig.h"
+#include "u_gnss_dec_ubx_rxm_rawx.h"
+#include "u_gnss_dec_nmea_gga.h"
+#include "u_gnss_dec_nmea_rmc.h"
 
 /** \addtogroup _GNSS
  *  @{
@@ -37,6 +45,11 @@
  * to obtain high precision position from a HPG GNSS device
  * by requesting it to emit the UBX-NAV-HPPOSLLH message.
  *
+ * pUGnssDecAlloc() allocates memory for each decoded message;
+ * if you are decoding a continuous stream of messages at a
+ * high rate you may prefer uGnssDecDecode(), which decodes into
+ * storage that you provide and never allocates memory.
+ *
  * The functions are thread-safe with the exception of
  * uGnssDecSetCallback().
  */
@@ -58,10 +71,18 @@ extern "C" {
 typedef union {
     uGnssDecUbxNavPvt_t           ubxNavPvt;      /**< UBX-NAV-PVT. */
     uGnssDecUbxNavHpposllh_t      ubxNavHpposllh; /**< UBX-NAV-HPPOSLLH. */
+    uGnssDecUbxNavDop_t           ubxNavDop;      /**< UBX-NAV-DOP. */
+    uGnssDecUbxNavCov_t           ubxNavCov;      /**< UBX-NAV-COV. */
+    uGnssDecUbxNavTimeutc_t       ubxNavTimeutc;  /**< UBX-NAV-TIMEUTC. */
+    uGnssDecUbxNavSat_t           ubxNavSat;      /**< UBX-NAV-SAT. */
+    uGnssDecUbxNavSig_t           ubxNavSig;      /**< UBX-NAV-SIG. */
+    uGnssDecUbxRxmRawx_t          ubxRxmRawx;     /**< UBX-RXM-RAWX. */
+    uGnssDecNmeaGga_t             nmeaGga;        /**< NMEA GGA. */
+    uGnssDecNmeaRmc_t             nmeaRmc;        /**< NMEA RMC. */
 } uGnssDecUnion_t;
 
 /** The result of attempting to decode a message, returned by
- * pUGnssDecAlloc().
+ * pUGnssDecAlloc() or populated by uGnssDecDecode().
  */
 typedef struct {
     int32_t errorCode;   /**< the outcome of message decoding:
@@ -155,12 +176,14 @@ typedef int32_t (uGnssDecFunction_t) (uGnssMessageId_t *pId,
  * and must include all headers; no checking of checksums etc. on the
  * end of a known message is performed, hence they may be omitted.
  *
- * Currently only a very limited set of messages (actually just
- * UBX-NAV-PVT and UBX-NAV-HPPOSLLH, the latter useful if you wish
- * to use a high precision GNSS (HPG) device to its full extent) are
- * supported; see the top of the file u_gnss_dec.c for instructions
- * on how to add more decoders, or use uGnssDecSetCallback() to
- * hook-in your own decoders at run-time.
+ * Currently only a limited set of messages (UBX-NAV-PVT,
+ * UBX-NAV-HPPOSLLH, the latter useful if you wish to use a high
+ * precision GNSS (HPG) device to its full extent, UBX-NAV-DOP,
+ * UBX-NAV-COV, UBX-NAV-TIMEUTC, UBX-NAV-SAT, UBX-NAV-SIG,
+ * UBX-RXM-RAWX and NMEA GGA and RMC from any talker) are supported;
+ * see the top of the file u_gnss_dec.c for instructions on how to
+ * add more decoders, or use uGnssDecSetCallback() to hook-in your
+ * own decoders at run-time.
  *
  * If only a partial decode is possible then the errorCode field of
  * the returned structure will be negative but the protocol type
@@ -186,6 +209,40 @@ typedef int32_t (uGnssDecFunction_t) (uGnssMessageId_t *pId,
  */
 uGnssDec_t *pUGnssDecAlloc(const char *pBuffer, size_t size);
 
+/** Decode a message buffer received from a GNSS device into storage
+ * provided by the caller; this does the same job as pUGnssDecAlloc()
+ * except that it never allocates memory, hence it is the better
+ * choice when decoding a stream of messages at a high rate.  The
+ * same rules on the message buffer apply as for pUGnssDecAlloc().
+ *
+ * Since a callback set with uGnssDecSetCallback() must allocate
+ * memory for the message body, it is NOT called by this function:
+ * only the built-in decoders listed by uGnssDecGetIdList() are used.
+ *
+ * Note that the larger message structures (e.g. those of UBX-NAV-SAT,
+ * UBX-NAV-SIG and UBX-RXM-RAWX) are a few kbytes in size, hence
+ * #uGnssDecUnion_t should normally be static or allocated once
+ * rather than placed on the stack of a small task.
+ *
+ * @param[in] pBuffer     the buffer containing the message to be
+ *                        decoded; cannot be NULL.
+ * @param size            the amount of data at pBuffer.
+ * @param[out] pDec       a pointer to a place to put the result of
+ *                        the decode; the pBody field will be set to
+ *                        pBody if the body was decoded, else NULL;
+ *                        the nmea field is used as the storage for
+ *                        id.id.pNmea, hence the structure must remain
+ *                        in scope for as long as the ID is used.
+ *                        Cannot be NULL.
+ * @param[out] pBody      a pointer to a place to decode the message
+ *                        body into; cannot be NULL.
+ * @return                zero on success, else negative error code,
+ *                        which is also written to the errorCode
+ *                        field of pDec.
+ */
+int32_t uGnssDecDecode(const char *pBuffer, size_t size,
+                       uGnssDec_t *pDec, uGnssDecUnion_t *pBody);
+
 /** Free the memory returned by pUGnssDecAlloc().
  *
  * @param[in] pDec the pointer returned by pUGnssDecAlloc(); may
@@ -193,7 +250,8 @@ uGnssDec_t *pUGnssDecAlloc(const char *pBuffer, size_t size);
  */
 void uGnssDecFree(uGnssDec_t *pDec);
 
-/** Get the list of message IDs that pUGnssDecAlloc() can decode;
+/** Get the list of message IDs that pUGnssDecAlloc() and
+ * uGnssDecDecode() can decode;
  * does not include any added by uGnssDecSetCallback().
  *
  * @param[out] ppIdList  a pointer to a place to put the pointer
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2019-2023 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_GNSS_DEC_NMEA_GGA_H_
+#define _U_GNSS_DEC_NMEA_GGA_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** \addtogroup _GNSS
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines the types of an NMEA GGA
+ * message.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The NMEA message ID of a GGA message, with a wildcard for
+ * any talker ID.
+ */
+#define U_GNSS_DEC_NMEA_GGA_MESSAGE_ID "??GGA"
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** Bit fields of the "present" field of #uGnssDecNmeaGga_t; NMEA
+ * fields are frequently empty, for instance before a fix is
+ * achieved, hence use these to determine which of the fields of
+ * #uGnssDecNmeaGga_t were populated, e.g.
+ *
+ * `if (present & (1 << U_GNSS_DEC_NMEA_GGA_PRESENT_LAT_LON)) {`
+ *
+ * ...would determine if the lat and lon fields are valid.
+ */
+typedef enum {
+    U_GNSS_DEC_NMEA_GGA_PRESENT_TIME = 0,        /**< the time field is valid. */
+    U_GNSS_DEC_NMEA_GGA_PRESENT_LAT_LON = 1,     /**< the lat and lon fields
+                                                      are valid. */
+    U_GNSS_DEC_NMEA_GGA_PRESENT_HDOP = 2,        /**< the HDOP field is valid. */
+    U_GNSS_DEC_NMEA_GGA_PRESENT_ALT = 3,         /**< the alt field is valid. */
+    U_GNSS_DEC_NMEA_GGA_PRESENT_SEP = 4,         /**< the sep field is valid. */
+    U_GNSS_DEC_NMEA_GGA_PRESENT_DIFF_AGE = 5,    /**< the diffAge field is valid. */
+    U_GNSS_DEC_NMEA_GGA_PRESENT_DIFF_STATION = 6 /**< the diffStation field
+                                                      is valid. */
+} uGnssDecNmeaGgaPresent_t;
+
+/** Possible values of the "quality" field of #uGnssDecNmeaGga_t.
+ */
+typedef enum {
+    U_GNSS_DEC_NMEA_GGA_QUALITY_NO_FIX = 0,
+    U_GNSS_DEC_NMEA_GGA_QUALITY_AUTONOMOUS = 1,
+    U_GNSS_DEC_NMEA_GGA_QUALITY_DIFFERENTIAL = 2,
+    U_GNSS_DEC_NMEA_GGA_QUALITY_RTK_FIXED = 4,
+    U_GNSS_DEC_NMEA_GGA_QUALITY_RTK_FLOAT = 5,
+    U_GNSS_DEC_NMEA_GGA_QUALITY_DEAD_RECKONING = 6
+} uGnssDecNmeaGgaQuality_t;
+
+/** NMEA GGA message structure; the naming of each element follows
+ * that of the interface manual but, to avoid the need for floating
+ * point, the values are converted to fixed-point integers and the
+ * hemisphere indicators are folded into the sign of the latitude
+ * and longitude.
+ */
+typedef struct {
+    uint8_t present;     /**< which of the fields below are valid,
+                              see #uGnssDecNmeaGgaPresent_t. */
+    int32_t time;        /**< UTC time of day in milliseconds since
+                              midnight. */
+    int32_t lat;         /**< latitude in degrees times 1e7, negative
+                              for south. */
+    int32_t lon;         /**< longitude in degrees times 1e7, negative
+                              for west. */
+    uGnssDecNmeaGgaQuality_t quality; /**< the fix quality indicator. */
+    uint8_t numSV;       /**< the number of satellites used. */
+    int32_t HDOP;        /**< horizontal DOP times 100. */
+    int32_t alt;         /**< altitude above mean sea level in mm. */
+    int32_t sep;         /**< geoid separation (ellipsoid height
+                              minus altitude above mean sea level)
+                              in mm. */
+    int32_t diffAge;     /**< age of differential corrections in
+                              milliseconds. */
+    int32_t diffStation; /**< ID of the station providing differential
+                              corrections. */
+} uGnssDecNmeaGga_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_GNSS_DEC_NMEA_GGA_H_
+
+// End of file
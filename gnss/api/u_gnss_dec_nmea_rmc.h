@@ -0,0 +1,110 @@
+/*
+ * Copyright 2019-2023 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_GNSS_DEC_NMEA_RMC_H_
+#define _U_GNSS_DEC_NMEA_RMC_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** \addtogroup _GNSS
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines the types of an NMEA RMC
+ * message.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The NMEA message ID of an RMC message, with a wildcard for
+ * any talker ID.
+ */
+#define U_GNSS_DEC_NMEA_RMC_MESSAGE_ID "??RMC"
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** Bit fields of the "present" field of #uGnssDecNmeaRmc_t; NMEA
+ * fields are frequently empty, for instance before a fix is
+ * achieved, hence use these to determine which of the fields of
+ * #uGnssDecNmeaRmc_t were populated, e.g.
+ *
+ * `if (present & (1 << U_GNSS_DEC_NMEA_RMC_PRESENT_DATE)) {`
+ *
+ * ...would determine if the year, month and day fields are valid.
+ */
+typedef enum {
+    U_GNSS_DEC_NMEA_RMC_PRESENT_TIME = 0,    /**< the time field is valid. */
+    U_GNSS_DEC_NMEA_RMC_PRESENT_LAT_LON = 1, /**< the lat and lon fields
+                                                  are valid. */
+    U_GNSS_DEC_NMEA_RMC_PRESENT_SPD = 2,     /**< the spd field is valid. */
+    U_GNSS_DEC_NMEA_RMC_PRESENT_COG = 3,     /**< the cog field is valid. */
+    U_GNSS_DEC_NMEA_RMC_PRESENT_DATE = 4,    /**< the year, month and day
+                                                  fields are valid. */
+    U_GNSS_DEC_NMEA_RMC_PRESENT_MV = 5       /**< the mv field is valid. */
+} uGnssDecNmeaRmcPresent_t;
+
+/** NMEA RMC message structure; the naming of each element follows
+ * that of the interface manual but, to avoid the need for floating
+ * point, the values are converted to fixed-point integers and the
+ * hemisphere/direction indicators are folded into the sign of the
+ * latitude, longitude and magnetic variation.
+ */
+typedef struct {
+    uint8_t present;  /**< which of the fields below are valid, see
+                           #uGnssDecNmeaRmcPresent_t. */
+    int32_t time;     /**< UTC time of day in milliseconds since
+                           midnight. */
+    char status;      /**< 'A' for data valid, 'V' for data invalid,
+                           0 if not present. */
+    int32_t lat;      /**< latitude in degrees times 1e7, negative
+                           for south. */
+    int32_t lon;      /**< longitude in degrees times 1e7, negative
+                           for west. */
+    int32_t spd;      /**< speed over ground in knots times 1000. */
+    int32_t cog;      /**< course over ground in degrees times 100. */
+    uint16_t year;    /**< year (UTC), e.g. 2023. */
+    uint8_t month;    /**< month, range 1 to 12 (UTC). */
+    uint8_t day;      /**< day of month, range 1 to 31 (UTC). */
+    int32_t mv;       /**< magnetic variation in degrees times 100,
+                           negative for west. */
+    char posMode;     /**< the mode indicator, e.g. 'A' for
+                           autonomous, 'D' for differential, 'N'
+                           for no fix; 0 if not present. */
+    char navStatus;   /**< the navigational status indicator,
+                           0 if not present. */
+} uGnssDecNmeaRmc_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_GNSS_DEC_NMEA_RMC_H_
+
+// End of file
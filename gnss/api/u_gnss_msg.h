@@ -81,6 +81,23 @@ extern "C" {
 # define U_GNSS_MSG_RECEIVE_TASK_STACK_SIZE_BYTES (1024 * 3)
 #endif
 
+#ifndef U_GNSS_MSG_RECEIVE_TASK_EVENT_TIMEOUT_MS
+/** Where the transport to the GNSS chip is a UART, the task
+ * started by uGnssMsgReceiveStart() does not poll, instead it waits
+ * for a data-received event from the UART; this is the longest it
+ * will wait before checking the UART anyway, a backstop.
+ */
+# define U_GNSS_MSG_RECEIVE_TASK_EVENT_TIMEOUT_MS 1000
+#endif
+
+#ifndef U_GNSS_MSG_RECEIVE_TASK_EVENT_STACK_SIZE_BYTES
+/** The number of bytes of stack to allocate to the task in which
+ * the UART data-received event that wakes up the task started by
+ * uGnssMsgReceiveStart() is delivered; it does very little.
+ */
+# define U_GNSS_MSG_RECEIVE_TASK_EVENT_STACK_SIZE_BYTES 1536
+#endif
+
 #ifndef U_GNSS_MSG_RECEIVE_TASK_QUEUE_LENGTH
 /** The length of the queue controlling the message receive
  * task: just need the one.
@@ -99,6 +116,34 @@ extern "C" {
  * TYPES
  * -------------------------------------------------------------- */
 
+/** Statistics on the task that runs the non-blocking message
+ * receive, as returned by uGnssMsgReceiveStatTask(); all times are
+ * in units of the system tick, milliseconds, hence latencies
+ * below a millisecond will appear as zero.
+ */
+typedef struct {
+    bool eventDriven;       /**< true if the task is woken up by data arriving
+                                 from a UART, false if it is polling (e.g. because
+                                 the transport is I2C or SPI). */
+    size_t wakeUpCount;     /**< the number of times the task has woken up. */
+    size_t wakeUpIdleCount; /**< the number of times the task woke up and found
+                                 nothing to read. */
+    size_t messageCount;    /**< the number of messages the task has decoded. */
+    int32_t latencyLastMs;  /**< the time between the most recent message
+                                 arriving and it being passed to the callbacks:
+                                 for the event-driven case this is measured from
+                                 the data-received event, for the polled case
+                                 from the task waking up, so any time that the
+                                 message spent waiting for the poll is not included. */
+    int32_t latencyMaxMs;   /**< the largest value of latencyLastMs. */
+    int32_t latencyAverageMs; /**< the average value of latencyLastMs. */
+    int32_t busyTimeMs;     /**< the total time the task has spent awake. */
+    int32_t runTimeMs;      /**< the time since the task was started; busyTimeMs
+                                 divided by this gives the proportion of the time
+                                 that the task is using, including the time spent
+                                 in the message callbacks. */
+} uGnssMsgReceiveStatTask_t;
+
 /** A callback which will be called by uGnssMsgReceiveStart()
  * when a matching message has been received from the GNSS chip.
  * This callback should be executed as quickly as possible to
@@ -468,6 +513,18 @@ size_t uGnssMsgReceiveStatReadLoss(uDeviceHandle_t gnssHandle);
  */
 size_t uGnssMsgReceiveStatStreamLoss(uDeviceHandle_t gnssHandle);
 
+/** Get the statistics for the task that is running the message
+ * receive: how it is woken up, how often, how long it takes to deliver
+ * messages to the callbacks and how busy it is.  Will return a valid
+ * outcome only if at least one uGnssMsgReceiveStart() is running.
+ *
+ * @param gnssHandle   the handle of the GNSS instance.
+ * @param[out] pStat   a place to put the statistics, cannot be NULL.
+ * @return             zero on success else negative error code.
+ */
+int32_t uGnssMsgReceiveStatTask(uDeviceHandle_t gnssHandle,
+                                uGnssMsgReceiveStatTask_t *pStat);
+
 #ifdef __cplusplus
 }
 #endif
@@ -58,6 +58,9 @@
 #include "u_gnss_geofence.h"
 
 #include "u_gnss_private.h"
+#include "u_gnss_cfg_val_key.h"
+#include "u_gnss_cfg.h"
+#include "u_gnss_cfg_private.h" // For uGnssCfgPrivateCleanUp()
 
 // The headers below are necessary to work around an Espressif linker problem, see uGnssInit()
 #include "u_gnss_pos.h" // For uGnssPosPrivateLink()
@@ -156,12 +159,16 @@ static void deleteGnssInstance(uGnssPrivateInstance_t *pInstance)
     pCurrent = gpUGnssPrivateInstanceList;
     while (pCurrent != NULL) {
         if (pInstance == pCurrent) {
+            // Stop any correction forwarding
+            uGnssPrivateStopCorrection(pInstance);
             // Stop any asynchronous position establishment task
             uGnssPrivateCleanUpPosTask(pInstance);
             // Stop and clean up streamed position
             uGnssPrivateCleanUpStreamedPos(pInstance);
             // Stop asynchronus message receive from happening
             uGnssPrivateStopMsgReceive(pInstance);
+            // Free the configuration cache and any uncommitted batch
+            uGnssCfgPrivateCleanUp(pInstance);
             // Free the SPI buffer, if there is one
             if (pInstance->pSpiRingBuffer != NULL) {
                 uRingBufferDelete(pInstance->pSpiRingBuffer);
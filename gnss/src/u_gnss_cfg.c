@@ -83,6 +83,39 @@ typedef struct {
     size_t itemCount;
 } uGnssCfgValGetMessageBody_t;
 
+/** An entry in the cache of configuration values.
+ */
+typedef struct {
+    uint32_t keyId;
+    uint8_t layers; /**< bit-map of the uGnssCfgValLayer_t layers
+                         that value is known to be in. */
+    uint64_t value;
+} uGnssCfgValCacheEntry_t;
+
+/** The cache of configuration values.
+ */
+typedef struct {
+    size_t numEntries;
+    size_t nextEntry; /**< the entry to overwrite when the cache is full. */
+    uGnssCfgValCacheEntry_t entry[U_GNSS_CFG_VAL_CACHE_MAX_NUM_KEYS];
+} uGnssCfgValCache_t;
+
+/** An entry in a batch of configuration values.
+ */
+typedef struct {
+    uGnssCfgVal_t cfgVal;
+    uint32_t layers;
+} uGnssCfgValBatchEntry_t;
+
+/** A batch of configuration values waiting to be sent.
+ */
+typedef struct {
+    uGnssCfgValBatchEntry_t *pEntry;
+    size_t numEntries;
+    size_t maxNumEntries; /**< the number of entries there is room for at pEntry. */
+    int32_t errorCode; /**< the first error that occurred while sending. */
+} uGnssCfgValBatch_t;
+
 /* ----------------------------------------------------------------
  * STATIC VARIABLES
  * -------------------------------------------------------------- */
@@ -348,44 +381,23 @@ static int32_t valGetByte(uGnssPrivateInstance_t *pInstance,
                           uint32_t keyId)
 {
     int32_t errorCodeOrByteValue;
-    // Message buffer for the UBX-CFG-VALGET message body:
-    // four bytes of header and four bytes for the key ID
-    char messageOut[4 + 4] = {0};
-    char *pMessageIn = NULL;
-    char *pMessage;
-    size_t messageInSizeBytes;
-    uint32_t y;
-
-    // The 4-byte message header is all zeroes: version 0,
-    // 0 for the RAM layer, position 0, so all we have to
-    // do is copy in the key Id
-    *((uint32_t *) &(messageOut[4])) = uUbxProtocolUint32Encode(keyId); // *NOPAD*
-    // Send it off and wait for the response
-    errorCodeOrByteValue = uGnssPrivateSendReceiveUbxMessageAlloc(pInstance,
-                                                                  0x06, 0x8b,
-                                                                  messageOut,
-                                                                  sizeof(messageOut),
-                                                                  &pMessageIn);
-    // 4 below since there must be at least four bytes of header
-    if ((errorCodeOrByteValue >= 4) && (pMessageIn != NULL)) {
-        messageInSizeBytes = (size_t) errorCodeOrByteValue;
+    uGnssCfgVal_t *pCfgVal = NULL;
+
+    // Go via uGnssCfgPrivateValGetListAlloc() so that any batched
+    // values are sent first and the cache, if there is one, is used
+    errorCodeOrByteValue = uGnssCfgPrivateValGetListAlloc(pInstance,
+                                                          &keyId, 1,
+                                                          &pCfgVal,
+                                                          U_GNSS_CFG_VAL_LAYER_RAM);
+    if (errorCodeOrByteValue >= 0) {
         errorCodeOrByteValue = (int32_t) U_ERROR_COMMON_PLATFORM;
-        pMessage = pMessageIn + 4;
-        // After a four byte header, which we can ignore,
-        // find in the received message our key ID and the E1/L value
-        while ((errorCodeOrByteValue < 0) &&
-               (messageInSizeBytes - (pMessage - pMessageIn) >= 4 + 1)) {
-            y = uUbxProtocolUint32Decode(pMessage);
-            pMessage += sizeof(uint32_t);
-            if (y == keyId) {
-                errorCodeOrByteValue = *pMessage;
-            }
-            pMessage += getStorageSizeBytes(keyId >> 24);
+        if ((pCfgVal != NULL) && (pCfgVal->keyId == keyId)) {
+            errorCodeOrByteValue = (uint8_t) pCfgVal->value;
         }
     }
 
-    // Free memory from uGnssPrivateSendReceiveUbxMessageAlloc()
-    uPortFree(pMessageIn);
+    // Free memory from uGnssCfgPrivateValGetListAlloc()
+    uPortFree(pCfgVal);
 
     return errorCodeOrByteValue;
 }
@@ -398,23 +410,585 @@ static int32_t valGetByte(uGnssPrivateInstance_t *pInstance,
 static int32_t valSetByte(uGnssPrivateInstance_t *pInstance,
                           uint32_t keyId, uint8_t value)
 {
-    // Message buffer for the UBX-CFG-VALSET message body:
-    // four bytes of header, four bytes for the key ID and
-    // one byte for the value
-    char message[4 + 4 + 1];
-
-    // Assemble the message
-    message[0] = 0; // version
-    message[1] = U_GNSS_CFG_VAL_LAYER_RAM;
-    message[2] = 0; // reserved
-    message[3] = 0;
-    // Add the key ID and value
-    *((uint32_t *) &(message[4])) = uUbxProtocolUint32Encode(keyId); // *NOPAD*
-    message[8] = (char) value;
-
-    // Send the message off
-    return uGnssPrivateSendUbxMessage(pInstance, 0x06, 0x8a,
-                                      message, sizeof(message));
+    uGnssCfgVal_t cfgVal;
+
+    cfgVal.keyId = keyId;
+    cfgVal.value = value;
+
+    // Go via uGnssCfgPrivateValSetList() so that batching and
+    // the cache, if they are in use, are applied
+    return uGnssCfgPrivateValSetList(pInstance, &cfgVal, 1,
+                                     U_GNSS_CFG_VAL_TRANSACTION_NONE,
+                                     U_GNSS_CFG_VAL_LAYER_RAM);
+}
+
+// Get a list of configuration items from the GNSS chip using VALGET,
+// allocating memory for the answer; the parameters are not checked.
+static int32_t valGetListAlloc(uGnssPrivateInstance_t *pInstance,
+                               const uint32_t *pKeyIdList,
+                               size_t numKeyIds,
+                               uGnssCfgVal_t **pList,
+                               int32_t encodedLayer)
+{
+    int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+    char *pMessageOut = NULL;
+    size_t messageOutSize = 4 + (4 * numKeyIds);
+    uGnssCfgValGetMessageBody_t messageIn[U_GNSS_CFG_MAX_NUM_VAL_GET_SEGMENTS] = {0};
+    size_t messageInCount = 0;
+
+    // Get memory for the body of the UBX-CFG-VALGET message
+    pMessageOut = (char *) pUPortMalloc(messageOutSize);
+    if (pMessageOut != NULL) {
+        // Assemble the message
+        *pMessageOut       = 0; // Version
+        *(pMessageOut + 1) = (char) encodedLayer;
+        // Position is added in the loop below
+        for (size_t x = 0; x < numKeyIds; x++) {
+            *((uint32_t *) (pMessageOut + 4 + (x << 2))) = uUbxProtocolUint32Encode(*pKeyIdList);
+            pKeyIdList++;
+        }
+        do {
+            // Slip in the current position
+            *((uint16_t *) (pMessageOut + 2)) = uUbxProtocolUint16Encode((uint16_t) (messageInCount *
+                                                                                     U_GNSS_CFG_VAL_MSG_MAX_NUM_VALUES));
+            // Send it off and wait for the response
+            errorCodeOrCount = uGnssPrivateSendReceiveUbxMessageAlloc(pInstance,
+                                                                      0x06, 0x8b,
+                                                                      pMessageOut,
+                                                                      messageOutSize,
+                                                                      &(messageIn[messageInCount].pBody));
+            if (errorCodeOrCount >= 0) {
+                messageIn[messageInCount].size = errorCodeOrCount;
+                messageInCount++;
+            }
+            // Repeat until less than 64 responses are returned or we
+            // run out of message buffers
+        } while ((messageInCount < sizeof(messageIn) / sizeof (messageIn[0])) &&
+                 (errorCodeOrCount >= U_GNSS_CFG_VAL_MSG_MAX_NUM_VALUES));
+
+        // Now process all of the messages into an array; note that even if
+        // we got an error part way through we still return what we received
+        // because we get a NACK to indicate "done", which would appear as
+        // an error code
+        if (messageInCount > 0) {
+            errorCodeOrCount = unpackMessageAlloc(messageIn, messageInCount, pList);
+            // Free the memory that was allocated by the send/receive calls
+            for (size_t x = 0; x < messageInCount; x++) {
+                uPortFree(messageIn[x].pBody);
+            }
+        }
+
+        // Free the memory that was used for the outgoing message
+        uPortFree(pMessageOut);
+    }
+
+    return errorCodeOrCount;
+}
+
+// Set a list of no more than U_GNSS_CFG_VAL_MSG_MAX_NUM_VALUES
+// configuration items with a single VALSET message; the parameters
+// are not checked.
+static int32_t valSetMessage(uGnssPrivateInstance_t *pInstance,
+                             const uGnssCfgVal_t *pList,
+                             size_t numValues,
+                             uGnssCfgValTransaction_t transaction,
+                             uint32_t layers)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+    char *pMessage = NULL;
+    size_t messageSize = 4 + (4 * numValues);
+
+    // Work out how much memory we need for the message;
+    // we already have the overhead and the amount per key ID,
+    // need to add the amount per value
+    for (size_t x = 0; x < numValues; x++) {
+        messageSize += getStorageSizeBytes(U_GNSS_CFG_VAL_KEY_GET_SIZE((pList + x)->keyId));
+    }
+    // Get memory for the body of the UBX-CFG-VALSET message
+    pMessage = (char *) pUPortMalloc(messageSize);
+    if (pMessage != NULL) {
+        // Assemble the message
+        *pMessage       = 0x01; // Version
+        *(pMessage + 1) = (char) layers;
+        *(pMessage + 2) = transaction;
+        *(pMessage + 3) = 0; // Reserved
+        // Add the values
+        packMessage(pList, numValues, pMessage + 4, messageSize - 4);
+        // Send them all off
+        errorCode = uGnssPrivateSendUbxMessage(pInstance, 0x06, 0x8a,
+                                               pMessage, messageSize);
+        // Free memory
+        uPortFree(pMessage);
+    }
+
+    return errorCode;
+}
+
+// Delete a list of no more than U_GNSS_CFG_VAL_MSG_MAX_NUM_VALUES
+// configuration items with a single VALDEL message; the parameters
+// are not checked.
+static int32_t valDelMessage(uGnssPrivateInstance_t *pInstance,
+                             const uint32_t *pKeyIdList,
+                             size_t numKeyIds,
+                             uGnssCfgValTransaction_t transaction,
+                             uint32_t layers)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+    char *pMessage = NULL;
+    int32_t messageSize = 4 + (4 * numKeyIds);
+    uint32_t *pUintBuffer;
+
+    // Get memory for the body of the UBX-CFG-VALDEL message
+    pMessage = pUPortMalloc(messageSize);
+    if (pMessage != NULL) {
+        // Assemble the message
+        *pMessage       = 0x01; // Version
+        *(pMessage + 1) = (char) layers;
+        *(pMessage + 2) = transaction;
+        *(pMessage + 3) = 0; // Reserved
+        // Add the key IDs
+        pUintBuffer = (uint32_t *) (pMessage + 4);
+        for (size_t x = 0; x < numKeyIds; x++) {
+            *pUintBuffer = uUbxProtocolUint32Encode(*pKeyIdList);
+            pKeyIdList++;
+            pUintBuffer++;
+        }
+        // Send them all off
+        errorCode = uGnssPrivateSendUbxMessage(pInstance, 0x06, 0x8c,
+                                               pMessage, messageSize);
+        // Free memory
+        uPortFree(pMessage);
+    }
+
+    return errorCode;
+}
+
+// Work out the transaction type to use for message number index
+// of the numMessages VALSET/VALDEL messages that a list has been
+// split into, such that the list is still applied all at once.
+static uGnssCfgValTransaction_t messageTransaction(uGnssCfgValTransaction_t transaction,
+                                                   size_t index, size_t numMessages)
+{
+    if (numMessages > 1) {
+        switch (transaction) {
+            case U_GNSS_CFG_VAL_TRANSACTION_NONE:
+                transaction = U_GNSS_CFG_VAL_TRANSACTION_CONTINUE;
+                if (index == 0) {
+                    transaction = U_GNSS_CFG_VAL_TRANSACTION_BEGIN;
+                } else if (index == numMessages - 1) {
+                    transaction = U_GNSS_CFG_VAL_TRANSACTION_EXECUTE;
+                }
+                break;
+            case U_GNSS_CFG_VAL_TRANSACTION_BEGIN:
+                if (index > 0) {
+                    transaction = U_GNSS_CFG_VAL_TRANSACTION_CONTINUE;
+                }
+                break;
+            case U_GNSS_CFG_VAL_TRANSACTION_EXECUTE:
+                if (index < numMessages - 1) {
+                    transaction = U_GNSS_CFG_VAL_TRANSACTION_CONTINUE;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    return transaction;
+}
+
+// Return the number of VALSET/VALDEL messages needed for numValues;
+// always at least one since a message with no values may be used to
+// execute a transaction.
+static size_t numMessages(size_t numValues)
+{
+    size_t count = 1;
+
+    if (numValues > U_GNSS_CFG_VAL_MSG_MAX_NUM_VALUES) {
+        count = (numValues + U_GNSS_CFG_VAL_MSG_MAX_NUM_VALUES - 1) /
+                U_GNSS_CFG_VAL_MSG_MAX_NUM_VALUES;
+    }
+
+    return count;
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: CACHE AND BATCH
+ * -------------------------------------------------------------- */
+
+// Return true if a key ID contains a wild-card.
+static bool keyIdIsWild(uint32_t keyId)
+{
+    return (U_GNSS_CFG_VAL_KEY_GET_GROUP_ID(keyId) == U_GNSS_CFG_VAL_KEY_GROUP_ID_ALL) ||
+           (U_GNSS_CFG_VAL_KEY_GET_ITEM_ID(keyId) == U_GNSS_CFG_VAL_KEY_ITEM_ID_ALL);
+}
+
+// Return true if keyId is matched by wantedKeyId, which may contain
+// wild-cards.
+static bool keyIdMatches(uint32_t wantedKeyId, uint32_t keyId)
+{
+    return (U_GNSS_CFG_VAL_KEY_GET_GROUP_ID(wantedKeyId) == U_GNSS_CFG_VAL_KEY_GROUP_ID_ALL) ||
+           ((U_GNSS_CFG_VAL_KEY_GET_GROUP_ID(wantedKeyId) == U_GNSS_CFG_VAL_KEY_GET_GROUP_ID(keyId)) &&
+            ((U_GNSS_CFG_VAL_KEY_GET_ITEM_ID(wantedKeyId) == U_GNSS_CFG_VAL_KEY_ITEM_ID_ALL) ||
+             (wantedKeyId == keyId)));
+}
+
+// Return true if the values of a layer may be cached.
+static bool layerIsCacheable(uGnssCfgValLayer_t layer)
+{
+    return (layer == U_GNSS_CFG_VAL_LAYER_RAM) ||
+           (layer == U_GNSS_CFG_VAL_LAYER_BBRAM) ||
+           (layer == U_GNSS_CFG_VAL_LAYER_FLASH);
+}
+
+// Truncate a value to the storage size given by its key ID, the
+// size that it has when read back from the GNSS chip.
+static uint64_t valueTruncate(uint32_t keyId, uint64_t value)
+{
+    size_t storageSizeBytes = getStorageSizeBytes(U_GNSS_CFG_VAL_KEY_GET_SIZE(keyId));
+
+    if (storageSizeBytes < sizeof(value)) {
+        value &= (((uint64_t) 1) << (storageSizeBytes * 8)) - 1;
+    }
+
+    return value;
+}
+
+// Find the entry for a key ID in the cache, NULL if there isn't one.
+static uGnssCfgValCacheEntry_t *pCacheFind(uGnssCfgValCache_t *pCache,
+                                           uint32_t keyId)
+{
+    uGnssCfgValCacheEntry_t *pEntry = NULL;
+
+    for (size_t x = 0; (x < pCache->numEntries) && (pEntry == NULL); x++) {
+        if (pCache->entry[x].keyId == keyId) {
+            pEntry = &(pCache->entry[x]);
+        }
+    }
+
+    return pEntry;
+}
+
+// Record in the cache that a key is known to have the given value
+// in the given layers.
+static void cacheAdd(uGnssCfgValCache_t *pCache, uint32_t keyId,
+                     uint64_t value, uint32_t layers)
+{
+    uGnssCfgValCacheEntry_t *pEntry = pCacheFind(pCache, keyId);
+
+    value = valueTruncate(keyId, value);
+    if (pEntry == NULL) {
+        if (pCache->numEntries < sizeof(pCache->entry) / sizeof(pCache->entry[0])) {
+            pEntry = &(pCache->entry[pCache->numEntries]);
+            pCache->numEntries++;
+        } else {
+            // Full: overwrite the oldest entry
+            pEntry = &(pCache->entry[pCache->nextEntry]);
+            pCache->nextEntry++;
+            if (pCache->nextEntry >= sizeof(pCache->entry) / sizeof(pCache->entry[0])) {
+                pCache->nextEntry = 0;
+            }
+        }
+        pEntry->keyId = keyId;
+        pEntry->layers = 0;
+    }
+
+    if ((pEntry->layers != 0) && (pEntry->value == value)) {
+        pEntry->layers |= (uint8_t) layers;
+    } else {
+        // The value in any other layer is now unknown
+        pEntry->value = value;
+        pEntry->layers = (uint8_t) layers;
+    }
+}
+
+// Forget what the cache knows about the given layers for the
+// keys matching keyId, which may contain wild-cards.
+static void cacheForget(uGnssCfgValCache_t *pCache, uint32_t keyId,
+                        uint32_t layers)
+{
+    for (size_t x = 0; x < pCache->numEntries; x++) {
+        if (keyIdMatches(keyId, pCache->entry[x].keyId)) {
+            pCache->entry[x].layers &= (uint8_t) ~layers;
+        }
+    }
+}
+
+// Return true if the cache knows that a value is already in all of
+// the given layers.
+static bool cacheHas(uGnssCfgValCache_t *pCache,
+                     const uGnssCfgVal_t *pCfgVal, uint32_t layers)
+{
+    const uGnssCfgValCacheEntry_t *pEntry = pCacheFind(pCache, pCfgVal->keyId);
+
+    return (pEntry != NULL) && ((pEntry->layers & layers) == layers) &&
+           (pEntry->value == valueTruncate(pCfgVal->keyId, pCfgVal->value));
+}
+
+// Get a list of values from the cache, allocating memory for the
+// answer; U_ERROR_COMMON_NOT_FOUND is returned if there is no
+// cache or if not all of the values are known to it.
+static int32_t cacheGetListAlloc(uGnssCfgValCache_t *pCache,
+                                 const uint32_t *pKeyIdList,
+                                 size_t numKeyIds,
+                                 uGnssCfgVal_t **pList,
+                                 uGnssCfgValLayer_t layer)
+{
+    int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+    const uGnssCfgValCacheEntry_t *pEntry = NULL;
+    size_t x = 0;
+
+    if ((pCache != NULL) && layerIsCacheable(layer)) {
+        do {
+            pEntry = NULL;
+            if (!keyIdIsWild(*(pKeyIdList + x))) {
+                pEntry = pCacheFind(pCache, *(pKeyIdList + x));
+                if ((pEntry != NULL) && ((pEntry->layers & layer) == 0)) {
+                    pEntry = NULL;
+                }
+            }
+            x++;
+        } while ((pEntry != NULL) && (x < numKeyIds));
+
+        if (pEntry != NULL) {
+            // Got them all
+            errorCodeOrCount = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            *pList = (uGnssCfgVal_t *) pUPortMalloc(numKeyIds * sizeof(uGnssCfgVal_t));
+            if (*pList != NULL) {
+                for (x = 0; x < numKeyIds; x++) {
+                    pEntry = pCacheFind(pCache, *(pKeyIdList + x));
+                    if (pEntry != NULL) {
+                        (*pList + x)->keyId = pEntry->keyId;
+                        (*pList + x)->value = pEntry->value;
+                    }
+                }
+                errorCodeOrCount = (int32_t) numKeyIds;
+            }
+        }
+    }
+
+    return errorCodeOrCount;
+}
+
+// Empty the cache.
+static void cacheClear(uGnssCfgValCache_t *pCache)
+{
+    pCache->numEntries = 0;
+    pCache->nextEntry = 0;
+}
+
+// Set a list of configuration items of any length using as few
+// VALSET messages as possible, leaving out any that the cache knows
+// are already set and updating the cache afterwards.
+static int32_t valSetList(uGnssPrivateInstance_t *pInstance,
+                          const uGnssCfgVal_t *pList,
+                          size_t numValues,
+                          uGnssCfgValTransaction_t transaction,
+                          uint32_t layers)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    uGnssCfgValCache_t *pCache = (uGnssCfgValCache_t *) pInstance->pCfgValCache;
+    uGnssCfgVal_t *pListToSend = NULL;
+    size_t messageCount = numMessages(numValues);
+    size_t messageNumValues;
+    size_t x = 0;
+
+    if ((pCache != NULL) && (transaction == U_GNSS_CFG_VAL_TRANSACTION_NONE) &&
+        (numValues > 0)) {
+        // Copy the list, leaving out the values that the GNSS
+        // chip is already known to have
+        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        pListToSend = (uGnssCfgVal_t *) pUPortMalloc(numValues * sizeof(uGnssCfgVal_t));
+        if (pListToSend != NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            for (size_t y = 0; y < numValues; y++) {
+                if (!cacheHas(pCache, pList + y, layers)) {
+                    *(pListToSend + x) = *(pList + y);
+                    x++;
+                }
+            }
+            pList = pListToSend;
+            numValues = x;
+            messageCount = numMessages(numValues);
+            if (numValues == 0) {
+                // Nothing left to send
+                messageCount = 0;
+            }
+        }
+    }
+
+    for (x = 0; (x < messageCount) && (errorCode == 0); x++) {
+        messageNumValues = numValues - (x * U_GNSS_CFG_VAL_MSG_MAX_NUM_VALUES);
+        if (messageNumValues > U_GNSS_CFG_VAL_MSG_MAX_NUM_VALUES) {
+            messageNumValues = U_GNSS_CFG_VAL_MSG_MAX_NUM_VALUES;
+        }
+        errorCode = valSetMessage(pInstance,
+                                  pList + (x * U_GNSS_CFG_VAL_MSG_MAX_NUM_VALUES),
+                                  messageNumValues,
+                                  messageTransaction(transaction, x, messageCount),
+                                  layers);
+    }
+
+    if (pCache != NULL) {
+        if (transaction == U_GNSS_CFG_VAL_TRANSACTION_EXECUTE) {
+            // Values that the cache did not see, sent earlier in
+            // the transaction, have now been applied
+            cacheClear(pCache);
+        } else {
+            for (x = 0; x < numValues; x++) {
+                if ((transaction == U_GNSS_CFG_VAL_TRANSACTION_NONE) && (errorCode == 0)) {
+                    cacheAdd(pCache, (pList + x)->keyId, (pList + x)->value, layers);
+                } else {
+                    // Not applied yet, or not at all: who knows
+                    cacheForget(pCache, (pList + x)->keyId, U_GNSS_CFG_VAL_LAYER_DEFAULT);
+                }
+            }
+        }
+    }
+
+    // Free memory
+    uPortFree(pListToSend);
+
+    return errorCode;
+}
+
+// Delete a list of configuration items of any length using as few
+// VALDEL messages as possible, updating the cache afterwards.
+static int32_t valDelList(uGnssPrivateInstance_t *pInstance,
+                          const uint32_t *pKeyIdList,
+                          size_t numKeyIds,
+                          uGnssCfgValTransaction_t transaction,
+                          uint32_t layers)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    uGnssCfgValCache_t *pCache = (uGnssCfgValCache_t *) pInstance->pCfgValCache;
+    size_t messageCount = numMessages(numKeyIds);
+    size_t messageNumKeyIds;
+
+    for (size_t x = 0; (x < messageCount) && (errorCode == 0); x++) {
+        messageNumKeyIds = numKeyIds - (x * U_GNSS_CFG_VAL_MSG_MAX_NUM_VALUES);
+        if (messageNumKeyIds > U_GNSS_CFG_VAL_MSG_MAX_NUM_VALUES) {
+            messageNumKeyIds = U_GNSS_CFG_VAL_MSG_MAX_NUM_VALUES;
+        }
+        errorCode = valDelMessage(pInstance,
+                                  pKeyIdList + (x * U_GNSS_CFG_VAL_MSG_MAX_NUM_VALUES),
+                                  messageNumKeyIds,
+                                  messageTransaction(transaction, x, messageCount),
+                                  layers);
+    }
+
+    if (pCache != NULL) {
+        if (transaction == U_GNSS_CFG_VAL_TRANSACTION_EXECUTE) {
+            cacheClear(pCache);
+        } else {
+            for (size_t x = 0; x < numKeyIds; x++) {
+                cacheForget(pCache, *(pKeyIdList + x), layers);
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Send any values in the batch to the GNSS chip, remembering
+// the first error so that uGnssCfgValBatchCommit() can report it.
+static void batchFlush(uGnssPrivateInstance_t *pInstance)
+{
+    uGnssCfgValBatch_t *pBatch = (uGnssCfgValBatch_t *) pInstance->pCfgValBatch;
+    uGnssCfgValBatchEntry_t *pEntry;
+    uGnssCfgVal_t *pList;
+    size_t numValues;
+    uint32_t layers;
+    int32_t result;
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+
+    if ((pBatch != NULL) && (pBatch->numEntries > 0)) {
+        pList = (uGnssCfgVal_t *) pUPortMalloc(pBatch->numEntries * sizeof(uGnssCfgVal_t));
+        if (pList != NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            // Send the values for each set of layers in turn, in the
+            // order that the sets of layers first appear, marking
+            // the entries that have been dealt with by zeroing layers
+            for (size_t x = 0; x < pBatch->numEntries; x++) {
+                layers = (pBatch->pEntry + x)->layers;
+                if (layers != 0) {
+                    numValues = 0;
+                    for (size_t y = x; y < pBatch->numEntries; y++) {
+                        pEntry = pBatch->pEntry + y;
+                        if (pEntry->layers == layers) {
+                            *(pList + numValues) = pEntry->cfgVal;
+                            numValues++;
+                            pEntry->layers = 0;
+                        }
+                    }
+                    result = valSetList(pInstance, pList, numValues,
+                                        U_GNSS_CFG_VAL_TRANSACTION_NONE,
+                                        layers);
+                    if (errorCode == 0) {
+                        errorCode = result;
+                    }
+                }
+            }
+            uPortFree(pList);
+        }
+        if ((errorCode < 0) && (pBatch->errorCode == 0)) {
+            pBatch->errorCode = errorCode;
+        }
+        pBatch->numEntries = 0;
+    }
+}
+
+// Add a list of values to the batch.
+static int32_t batchAdd(uGnssPrivateInstance_t *pInstance,
+                        const uGnssCfgVal_t *pList, size_t numValues,
+                        uint32_t layers)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    uGnssCfgValBatch_t *pBatch = (uGnssCfgValBatch_t *) pInstance->pCfgValBatch;
+    uGnssCfgValBatchEntry_t *pTmp;
+    size_t y;
+
+    for (size_t x = 0; (x < numValues) && (errorCode == 0); x++) {
+        // A later value for a key replaces any earlier one
+        y = 0;
+        while ((y < pBatch->numEntries) &&
+               ((pBatch->pEntry + y)->cfgVal.keyId != (pList + x)->keyId)) {
+            y++;
+        }
+        if ((y < pBatch->numEntries) && ((pBatch->pEntry + y)->layers != layers)) {
+            // ...unless it is for a different set of layers, in
+            // which case the order matters: send what we have
+            batchFlush(pInstance);
+            y = 0;
+        }
+        if ((y == pBatch->numEntries) &&
+            (pBatch->numEntries >= pBatch->maxNumEntries)) {
+            // Need more room: grow by a VALSET message's worth
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            pTmp = (uGnssCfgValBatchEntry_t *) pUPortMalloc((pBatch->maxNumEntries +
+                                                             U_GNSS_CFG_VAL_MSG_MAX_NUM_VALUES) *
+                                                            sizeof(uGnssCfgValBatchEntry_t));
+            if (pTmp != NULL) {
+                if (pBatch->pEntry != NULL) {
+                    memcpy(pTmp, pBatch->pEntry,
+                           pBatch->numEntries * sizeof(uGnssCfgValBatchEntry_t));
+                }
+                uPortFree(pBatch->pEntry);
+                pBatch->pEntry = pTmp;
+                pBatch->maxNumEntries += U_GNSS_CFG_VAL_MSG_MAX_NUM_VALUES;
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        }
+        if (errorCode == 0) {
+            (pBatch->pEntry + y)->cfgVal = *(pList + x);
+            (pBatch->pEntry + y)->layers = layers;
+            if (y == pBatch->numEntries) {
+                pBatch->numEntries++;
+            }
+        }
+    }
+
+    return errorCode;
 }
 
 /* ----------------------------------------------------------------
@@ -430,60 +1004,26 @@ int32_t uGnssCfgPrivateValGetListAlloc(uGnssPrivateInstance_t *pInstance,
 {
     int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
     int32_t encodedLayer = encodeLayerForGet(layer);
-    char *pMessageOut = NULL;
-    size_t messageOutSize = 4 + (4 * numKeyIds);
-    uGnssCfgValGetMessageBody_t messageIn[U_GNSS_CFG_MAX_NUM_VAL_GET_SEGMENTS] = {0};
-    size_t messageInCount = 0;
+    uGnssCfgValCache_t *pCache;
 
     if ((pInstance != NULL) && (pKeyIdList != NULL) && (numKeyIds > 0) &&
         (pList != NULL) && (encodedLayer >= 0)) {
         errorCodeOrCount = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
         if (U_GNSS_PRIVATE_HAS(pInstance->pModule, U_GNSS_PRIVATE_FEATURE_CFGVALXXX)) {
-            errorCodeOrCount = (int32_t) U_ERROR_COMMON_NO_MEMORY;
-            // Get memory for the body of the UBX-CFG-VALGET message
-            pMessageOut = (char *) pUPortMalloc(messageOutSize);
-            if (pMessageOut != NULL) {
-                // Assemble the message
-                *pMessageOut       = 0; // Version
-                *(pMessageOut + 1) = (char) encodedLayer;
-                // Position is added in the loop below
-                for (size_t x = 0; x < numKeyIds; x++) {
-                    *((uint32_t *) (pMessageOut + 4 + (x << 2))) = uUbxProtocolUint32Encode(*pKeyIdList);
-                    pKeyIdList++;
-                }
-                do {
-                    // Slip in the current position
-                    *((uint16_t *) (pMessageOut + 2)) = uUbxProtocolUint16Encode((uint16_t) (messageInCount *
-                                                                                             U_GNSS_CFG_VAL_MSG_MAX_NUM_VALUES));
-                    // Send it off and wait for the response
-                    errorCodeOrCount = uGnssPrivateSendReceiveUbxMessageAlloc(pInstance,
-                                                                              0x06, 0x8b,
-                                                                              pMessageOut,
-                                                                              messageOutSize,
-                                                                              &(messageIn[messageInCount].pBody));
-                    if (errorCodeOrCount >= 0) {
-                        messageIn[messageInCount].size = errorCodeOrCount;
-                        messageInCount++;
-                    }
-                    // Repeat until less than 64 responses are returned or we
-                    // run out of message buffers
-                } while ((messageInCount < sizeof(messageIn) / sizeof (messageIn[0])) &&
-                         (errorCodeOrCount >= U_GNSS_CFG_VAL_MSG_MAX_NUM_VALUES));
-
-                // Now process all of the messages into an array; note that even if
-                // we got an error part way through we still return what we received
-                // because we get a NACK to indicate "done", which would appear as
-                // an error code
-                if (messageInCount > 0) {
-                    errorCodeOrCount = unpackMessageAlloc(messageIn, messageInCount, pList);
-                    // Free the memory that was allocated by the send/receive calls
-                    for (size_t x = 0; x < messageInCount; x++) {
-                        uPortFree(messageIn[x].pBody);
+            pCache = (uGnssCfgValCache_t *) pInstance->pCfgValCache;
+            // Anything that has been batched must reach the
+            // GNSS chip before it is asked for anything
+            batchFlush(pInstance);
+            errorCodeOrCount = cacheGetListAlloc(pCache, pKeyIdList, numKeyIds,
+                                                 pList, layer);
+            if (errorCodeOrCount == (int32_t) U_ERROR_COMMON_NOT_FOUND) {
+                errorCodeOrCount = valGetListAlloc(pInstance, pKeyIdList, numKeyIds,
+                                                   pList, encodedLayer);
+                if ((pCache != NULL) && layerIsCacheable(layer)) {
+                    for (int32_t x = 0; x < errorCodeOrCount; x++) {
+                        cacheAdd(pCache, (*pList + x)->keyId, (*pList + x)->value, layer);
                     }
                 }
-
-                // Free the memory that was used for the outgoing message
-                uPortFree(pMessageOut);
             }
         }
     }
@@ -499,38 +1039,21 @@ int32_t uGnssCfgPrivateValSetList(uGnssPrivateInstance_t *pInstance,
                                   int32_t layers)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-    char *pMessage = NULL;
-    size_t messageSize = 4 + (4 * numValues);
 
     if ((pInstance != NULL) &&
         ((pList != NULL) || (numValues == 0)) &&
-        (numValues <= U_GNSS_CFG_VAL_MSG_MAX_NUM_VALUES) &&
         ((numValues == 0) ||
          ((layers > 0) && ((layers & ~U_GNSS_CFG_VAL_LAYER_DEFAULT) == 0)))) {
         errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
         if (U_GNSS_PRIVATE_HAS(pInstance->pModule, U_GNSS_PRIVATE_FEATURE_CFGVALXXX)) {
-            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
-            // Work out how much memory we need for the message;
-            // we already have the overhead and the amount per key ID,
-            // need to add the amount per value
-            for (size_t x = 0; x < numValues; x++) {
-                messageSize += getStorageSizeBytes(U_GNSS_CFG_VAL_KEY_GET_SIZE((pList + x)->keyId));
-            }
-            // Get memory for the body of the UBX-CFG-VALSET message
-            pMessage = (char *) pUPortMalloc(messageSize);
-            if (pMessage != NULL) {
-                // Assemble the message
-                *pMessage       = 0x01; // Version
-                *(pMessage + 1) = layers;
-                *(pMessage + 2) = transaction;
-                *(pMessage + 3) = 0; // Reserved
-                // Add the values
-                packMessage(pList, numValues, pMessage + 4, messageSize - 4);
-                // Send them all off
-                errorCode = uGnssPrivateSendUbxMessage(pInstance, 0x06, 0x8a,
-                                                       pMessage, messageSize);
-                // Free memory
-                uPortFree(pMessage);
+            if ((pInstance->pCfgValBatch != NULL) &&
+                (transaction == U_GNSS_CFG_VAL_TRANSACTION_NONE) && (numValues > 0)) {
+                errorCode = batchAdd(pInstance, pList, numValues, (uint32_t) layers);
+            } else {
+                // Anything that has been batched must go first
+                batchFlush(pInstance);
+                errorCode = valSetList(pInstance, pList, numValues,
+                                       transaction, (uint32_t) layers);
             }
         }
     }
@@ -546,46 +1069,48 @@ int32_t uGnssCfgPrivateValDelList(uGnssPrivateInstance_t *pInstance,
                                   uint32_t layers)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-    char *pMessage = NULL;
-    int32_t messageSize = 4 + (4 * numKeyIds);
-    uint32_t *pUintBuffer;
 
     if ((pInstance != NULL) &&
         ((pKeyIdList != NULL) || (numKeyIds == 0)) &&
-        (numKeyIds <= U_GNSS_CFG_VAL_MSG_MAX_NUM_VALUES) &&
         ((numKeyIds == 0) ||
          ((layers > 0) &&
           ((layers & ~(U_GNSS_CFG_VAL_LAYER_BBRAM | U_GNSS_CFG_VAL_LAYER_FLASH)) == 0)))) {
         errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
         if (U_GNSS_PRIVATE_HAS(pInstance->pModule, U_GNSS_PRIVATE_FEATURE_CFGVALXXX)) {
-            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
-            // Get memory for the body of the UBX-CFG-VALDEL message
-            pMessage = pUPortMalloc(messageSize);
-            if (pMessage != NULL) {
-                // Assemble the message
-                *pMessage       = 0x01; // Version
-                *(pMessage + 1) = layers;
-                *(pMessage + 2) = transaction;
-                *(pMessage + 3) = 0; // Reserved
-                // Add the key IDs
-                pUintBuffer = (uint32_t *) (pMessage + 4);
-                for (size_t x = 0; x < numKeyIds; x++) {
-                    *pUintBuffer = uUbxProtocolUint32Encode(*pKeyIdList);
-                    pKeyIdList++;
-                    pUintBuffer++;
-                }
-                // Send them all off
-                errorCode = uGnssPrivateSendUbxMessage(pInstance, 0x06, 0x8c,
-                                                       pMessage, messageSize);
-                // Free memory
-                uPortFree(pMessage);
-            }
+            // Anything that has been batched must go first
+            batchFlush(pInstance);
+            errorCode = valDelList(pInstance, pKeyIdList, numKeyIds,
+                                   transaction, layers);
         }
     }
 
     return errorCode;
 }
 
+// Empty the cache of configuration values.
+void uGnssCfgPrivateValCacheClear(uGnssPrivateInstance_t *pInstance)
+{
+    if ((pInstance != NULL) && (pInstance->pCfgValCache != NULL)) {
+        cacheClear((uGnssCfgValCache_t *) pInstance->pCfgValCache);
+    }
+}
+
+// Free the cache and any uncommitted batch.
+void uGnssCfgPrivateCleanUp(uGnssPrivateInstance_t *pInstance)
+{
+    uGnssCfgValBatch_t *pBatch;
+
+    if (pInstance != NULL) {
+        pBatch = (uGnssCfgValBatch_t *) pInstance->pCfgValBatch;
+        if (pBatch != NULL) {
+            uPortFree(pBatch->pEntry);
+            uPortFree(pBatch);
+            pInstance->pCfgValBatch = NULL;
+        }
+        uPortFree(pInstance->pCfgValCache);
+        pInstance->pCfgValCache = NULL;
+    }
+}
 
 // Get the dynamic platform model from the GNSS chip.
 int32_t uGnssCfgPrivateGetDynamic(uGnssPrivateInstance_t *pInstance)
@@ -1271,4 +1796,125 @@ int32_t uGnssCfgValDelListX(uDeviceHandle_t gnssHandle,
     return errorCode;
 }
 
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: BATCHING AND CACHING OF VALSET/VALGET
+ * -------------------------------------------------------------- */
+
+// Start a batch of configuration changes.
+int32_t uGnssCfgValBatchStart(uDeviceHandle_t gnssHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    uGnssCfgValBatch_t *pBatch;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if (pInstance != NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            if (U_GNSS_PRIVATE_HAS(pInstance->pModule, U_GNSS_PRIVATE_FEATURE_CFGVALXXX)) {
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                if (pInstance->pCfgValBatch == NULL) {
+                    errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                    pBatch = (uGnssCfgValBatch_t *) pUPortMalloc(sizeof(uGnssCfgValBatch_t));
+                    if (pBatch != NULL) {
+                        memset(pBatch, 0, sizeof(*pBatch));
+                        pInstance->pCfgValBatch = pBatch;
+                        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                    }
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Send a batch of configuration changes.
+int32_t uGnssCfgValBatchCommit(uDeviceHandle_t gnssHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    uGnssCfgValBatch_t *pBatch;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if (pInstance != NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            pBatch = (uGnssCfgValBatch_t *) pInstance->pCfgValBatch;
+            if (pBatch != NULL) {
+                batchFlush(pInstance);
+                errorCode = pBatch->errorCode;
+                uPortFree(pBatch->pEntry);
+                uPortFree(pBatch);
+                pInstance->pCfgValBatch = NULL;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Switch the cache of configuration values on or off.
+int32_t uGnssCfgValCacheSet(uDeviceHandle_t gnssHandle, bool onNotOff)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    uGnssCfgValCache_t *pCache;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if (pInstance != NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            if (U_GNSS_PRIVATE_HAS(pInstance->pModule, U_GNSS_PRIVATE_FEATURE_CFGVALXXX)) {
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                if (!onNotOff) {
+                    uPortFree(pInstance->pCfgValCache);
+                    pInstance->pCfgValCache = NULL;
+                } else if (pInstance->pCfgValCache == NULL) {
+                    errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                    pCache = (uGnssCfgValCache_t *) pUPortMalloc(sizeof(uGnssCfgValCache_t));
+                    if (pCache != NULL) {
+                        cacheClear(pCache);
+                        pInstance->pCfgValCache = pCache;
+                        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                    }
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Empty the cache of configuration values.
+void uGnssCfgValCacheClear(uDeviceHandle_t gnssHandle)
+{
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        uGnssCfgPrivateValCacheClear(pUGnssPrivateGetInstance(gnssHandle));
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+}
+
 // End of file
@@ -78,6 +78,15 @@ int32_t uGnssCfgPrivateValGetListAlloc(uGnssPrivateInstance_t *pInstance,
  * this function comes into its own when setting values that have been read
  * using uGnssCfgValGetAlloc() or uGnssCfgValGetListAlloc(), e.g. with wildcards.
  *
+ * There is no limit on numValues: if more than will fit into a single
+ * UBX-CFG-VALSET message are given then they are sent in as many
+ * messages as necessary, with the transaction type of each adjusted
+ * so that the whole list is applied at once; for instance, with
+ * #U_GNSS_CFG_VAL_TRANSACTION_NONE the first message will begin a
+ * transaction and the last will execute it.  If batching is on (see
+ * uGnssCfgValBatchStart()) then, with #U_GNSS_CFG_VAL_TRANSACTION_NONE,
+ * the values are only added to the batch.
+ *
  * @param[in] pInstance a pointer to the GNSS instance, cannot be NULL.
  * @param[in] pList     a pointer to an array defining one or more
  *                      values to set; must be NULL if numValues is 0.
@@ -159,6 +168,25 @@ int32_t uGnssCfgPrivateValDelList(uGnssPrivateInstance_t *pInstance,
                                   uGnssCfgValTransaction_t transaction,
                                   uint32_t layers);
 
+/** Empty the cache of configuration values, if there is one; kept
+ * here so that the uGnssPwr functions can call it.
+ *
+ * Note: gUGnssPrivateMutex should be locked before this is called.
+ *
+ * @param[in] pInstance  a pointer to the GNSS instance, cannot be NULL.
+ */
+void uGnssCfgPrivateValCacheClear(uGnssPrivateInstance_t *pInstance);
+
+/** Free the cache of configuration values and discard any
+ * uncommitted batch; kept here so that GNSS deinitialisation can
+ * call it.
+ *
+ * Note: gUGnssPrivateMutex should be locked before this is called.
+ *
+ * @param[in] pInstance  a pointer to the GNSS instance, cannot be NULL.
+ */
+void uGnssCfgPrivateCleanUp(uGnssPrivateInstance_t *pInstance);
+
 /** Get the dynamic platform model from the GNSS chip.
  *
  * @param[in] pInstance  a pointer to the GNSS instance, cannot be NULL.
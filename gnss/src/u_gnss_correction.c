@@ -0,0 +1,480 @@
+/*
+ * Copyright 2019-2023 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Implementation of the correction-forwarding API for GNSS.
+ *
+ * Architectural note: data flows as follows:
+ *
+ *   source (e.g. socket/MQTT) --> buffer --> GNSS transport (e.g. UART)
+ *
+ * The read callback writes straight into the buffer of the forwarding
+ * task, the buffer is scanned for SPARTN/RTCM messages in place and
+ * each run of contiguous valid messages is written to the GNSS
+ * transport directly from the buffer with uGnssPrivateSendOnlyStreamRaw();
+ * anything that is not part of a valid message is skipped over and
+ * only the start of a message that has not yet fully arrived is moved
+ * down to the start of the buffer to await the rest.  The task only
+ * reads from the source when there is room in the buffer, hence a
+ * blocking write to the GNSS transport holds off the source.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memset(), memmove()
+
+#include "u_cfg_os_platform_specific.h" // U_CFG_OS_YIELD_MS
+#include "u_cfg_sw.h"
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_os.h"
+#include "u_port_heap.h"
+
+#include "u_at_client.h" // Required by u_gnss_private.h
+
+#include "u_ringbuffer.h"
+
+#include "u_spartn.h"
+#include "u_spartn_crc.h"
+
+#include "u_gnss_module_type.h"
+#include "u_gnss_type.h"
+#include "u_gnss.h"
+#include "u_gnss_private.h"
+#include "u_gnss_correction.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_GNSS_CORRECTION_TASK_PRIORITY
+/** The priority that the correction-forwarding task runs at; the
+ * same as the asynchronous message receive task.
+ */
+# define U_GNSS_CORRECTION_TASK_PRIORITY (U_CFG_OS_PRIORITY_MAX - 5)
+#endif
+
+/** The preamble byte with which every RTCM 3 message begins.
+ */
+#define U_GNSS_CORRECTION_RTCM_PREAMBLE 0xD3
+
+/** The length of the header of an RTCM 3 message: the preamble
+ * followed by six reserved bits and a ten-bit length.
+ */
+#define U_GNSS_CORRECTION_RTCM_HEADER_LENGTH_BYTES 3
+
+/** The length of the CRC at the end of an RTCM 3 message.
+ */
+#define U_GNSS_CORRECTION_RTCM_CRC_LENGTH_BYTES 3
+
+#if U_GNSS_CORRECTION_BUFFER_LENGTH_BYTES <= U_SPARTN_MESSAGE_LENGTH_MAX_BYTES
+/* There must always be room to read more once the start of the
+ * largest possible message is sitting in the buffer.
+ */
+# error U_GNSS_CORRECTION_BUFFER_LENGTH_BYTES must be bigger than U_SPARTN_MESSAGE_LENGTH_MAX_BYTES
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * STATIC VARIABLES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Check if there is a complete and valid RTCM 3 or SPARTN message
+// at the start of pBuffer, returning its length if so,
+// U_ERROR_COMMON_TIMEOUT if there is the start of one but more data
+// is needed to tell, else U_ERROR_COMMON_NOT_FOUND.
+static int32_t messageCheck(const char *pBuffer, size_t size)
+{
+    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+    // Use a uint8_t pointer for maths, more certain of its behaviour than char
+    const uint8_t *pInput = (const uint8_t *) pBuffer;
+    const char *pMessage = NULL;
+    size_t length;
+    uint32_t crc = 0;
+
+    if (size > 0) {
+        if (*pInput == U_GNSS_CORRECTION_RTCM_PREAMBLE) {
+            errorCodeOrLength = (int32_t) U_ERROR_COMMON_TIMEOUT;
+            if (size >= U_GNSS_CORRECTION_RTCM_HEADER_LENGTH_BYTES) {
+                errorCodeOrLength = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+                // The six bits after the preamble are reserved, must be zero
+                if ((*(pInput + 1) & 0xFC) == 0) {
+                    length = (((size_t) (*(pInput + 1) & 0x03)) << 8) | *(pInput + 2);
+                    length += U_GNSS_CORRECTION_RTCM_HEADER_LENGTH_BYTES +
+                              U_GNSS_CORRECTION_RTCM_CRC_LENGTH_BYTES;
+                    errorCodeOrLength = (int32_t) U_ERROR_COMMON_TIMEOUT;
+                    if (size >= length) {
+                        errorCodeOrLength = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+                        // RTCM 3 uses CRC-24Q, MSB first, which is the
+                        // same as the SPARTN CRC-24
+                        for (size_t x = length - U_GNSS_CORRECTION_RTCM_CRC_LENGTH_BYTES;
+                             x < length; x++) {
+                            crc = (crc << 8) | *(pInput + x);
+                        }
+                        if (uSpartnCrc24(pBuffer, length - U_GNSS_CORRECTION_RTCM_CRC_LENGTH_BYTES) == crc) {
+                            errorCodeOrLength = (int32_t) length;
+                        }
+                    }
+                }
+            }
+        } else if (*pInput == U_SPARTN_PREAMBLE) {
+            // Only give uSpartnDetect() the header so that it can't go
+            // off looking for a message further down the buffer
+            length = size;
+            if (length > U_SPARTN_HEADER_LENGTH_MAX_BYTES) {
+                length = U_SPARTN_HEADER_LENGTH_MAX_BYTES;
+            }
+            errorCodeOrLength = uSpartnDetect(pBuffer, length, &pMessage);
+            if ((errorCodeOrLength > 0) && (pMessage == pBuffer)) {
+                length = (size_t) errorCodeOrLength;
+                errorCodeOrLength = (int32_t) U_ERROR_COMMON_TIMEOUT;
+                if (size >= length) {
+                    errorCodeOrLength = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+                    if ((uSpartnValidate(pBuffer, length, &pMessage) == (int32_t) length) &&
+                        (pMessage == pBuffer)) {
+                        errorCodeOrLength = (int32_t) length;
+                    }
+                }
+            } else if ((errorCodeOrLength != (int32_t) U_ERROR_COMMON_TIMEOUT) ||
+                       (size >= U_SPARTN_HEADER_LENGTH_MAX_BYTES)) {
+                errorCodeOrLength = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+            }
+        }
+    }
+
+    return errorCodeOrLength;
+}
+
+// Return the number of bytes at pBuffer before the next byte that
+// could be the start of an RTCM 3 or SPARTN message.
+static size_t skipToPreamble(const char *pBuffer, size_t size)
+{
+    const uint8_t *pInput = (const uint8_t *) pBuffer;
+    size_t x = 0;
+
+    while ((x < size) && (*(pInput + x) != U_GNSS_CORRECTION_RTCM_PREAMBLE) &&
+           (*(pInput + x) != U_SPARTN_PREAMBLE)) {
+        x++;
+    }
+
+    return x;
+}
+
+// Write a run of messages to the GNSS chip and update the statistics.
+static void sendRun(uGnssPrivateInstance_t *pInstance,
+                    const char *pBuffer, size_t size,
+                    size_t numMessages, int32_t dataTimeMs)
+{
+    uGnssPrivateCorrection_t *pCorrection = pInstance->pCorrection;
+    int32_t latencyMs;
+
+    if (numMessages > 0) {
+        if (uGnssPrivateSendOnlyStreamRaw(pInstance, pBuffer, size) == (int32_t) size) {
+            latencyMs = uPortGetTickTimeMs() - dataTimeMs;
+            pCorrection->statBytesForwarded += size;
+            pCorrection->statMessagesForwarded += numMessages;
+            pCorrection->statWriteCount++;
+            pCorrection->statLatencyLastMs = latencyMs;
+            pCorrection->statLatencyTotalMs += latencyMs;
+            if (latencyMs > pCorrection->statLatencyMaxMs) {
+                pCorrection->statLatencyMaxMs = latencyMs;
+            }
+        } else {
+            pCorrection->statMessagesDropped += numMessages;
+        }
+    }
+}
+
+// Forward all of the complete messages in the buffer to the GNSS
+// chip, discarding anything that isn't a message and leaving only
+// the start of any incomplete message at the start of the buffer.
+static void forward(uGnssPrivateInstance_t *pInstance, int32_t dataTimeMs)
+{
+    uGnssPrivateCorrection_t *pCorrection = pInstance->pCorrection;
+    char *pBuffer = pCorrection->pBuffer;
+    size_t size = pCorrection->bufferDataSize;
+    size_t offset = 0;
+    size_t runStart = 0;
+    size_t runLength = 0;
+    size_t runMessages = 0;
+    size_t skip;
+    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+
+    while ((offset < size) && (errorCodeOrLength != (int32_t) U_ERROR_COMMON_TIMEOUT)) {
+        errorCodeOrLength = messageCheck(pBuffer + offset, size - offset);
+        if (errorCodeOrLength > 0) {
+            // Add the message to the current run
+            if (runMessages == 0) {
+                runStart = offset;
+            }
+            runLength += errorCodeOrLength;
+            runMessages++;
+            offset += errorCodeOrLength;
+        } else {
+            // The run, if there is one, ends here: send it
+            sendRun(pInstance, pBuffer + runStart, runLength,
+                    runMessages, dataTimeMs);
+            runLength = 0;
+            runMessages = 0;
+            if (errorCodeOrLength != (int32_t) U_ERROR_COMMON_TIMEOUT) {
+                // Not a message, skip to the next possible one
+                skip = 1 + skipToPreamble(pBuffer + offset + 1, size - offset - 1);
+                pCorrection->statBytesDiscarded += skip;
+                offset += skip;
+            }
+        }
+    }
+    sendRun(pInstance, pBuffer + runStart, runLength, runMessages, dataTimeMs);
+
+    // Move whatever is left, the start of a message, down
+    if ((offset > 0) && (offset < size)) {
+        memmove(pBuffer, pBuffer + offset, size - offset);
+    }
+    pCorrection->bufferDataSize = size - offset;
+}
+
+// Task that forwards correction data to the GNSS chip.
+static void correctionTask(void *pParam)
+{
+    uGnssPrivateInstance_t *pInstance = (uGnssPrivateInstance_t *) pParam;
+    uGnssPrivateCorrection_t *pCorrection = pInstance->pCorrection;
+    int32_t readSize;
+    int32_t dataTimeMs;
+
+    U_PORT_MUTEX_LOCK(pCorrection->taskRunningMutexHandle);
+
+    dataTimeMs = uPortGetTickTimeMs();
+
+    while (pCorrection->keepGoing) {
+
+        // Note that this does NOT lock gUGnssPrivateMutex: it doesn't need to,
+        // provided this task is brought up and torn down in an organised way
+
+        // Read straight into the space at the end of our buffer;
+        // there is always some space since forward() leaves at
+        // most the start of one message in the buffer
+        readSize = ((uGnssCorrectionReadCallback_t) pCorrection->pReadCallback)(pInstance->gnssHandle,
+                                                                                pCorrection->pBuffer +
+                                                                                pCorrection->bufferDataSize,
+                                                                                U_GNSS_CORRECTION_BUFFER_LENGTH_BYTES -
+                                                                                pCorrection->bufferDataSize,
+                                                                                pCorrection->pCallbackParam);
+        if (readSize > 0) {
+            if (readSize > U_GNSS_CORRECTION_BUFFER_LENGTH_BYTES - (int32_t) pCorrection->bufferDataSize) {
+                // Don't believe anything that says it is bigger than it can be
+                readSize = U_GNSS_CORRECTION_BUFFER_LENGTH_BYTES - (int32_t) pCorrection->bufferDataSize;
+            }
+            pCorrection->statBytesRead += readSize;
+            pCorrection->bufferDataSize += readSize;
+            forward(pInstance, dataTimeMs);
+            // There may be more where that came from so go around
+            // again straight away, clearing any notification for
+            // the data we're about to read
+            uPortSemaphoreTryTake(pCorrection->notifySemaphoreHandle, 0);
+            dataTimeMs = uPortGetTickTimeMs();
+        } else if (uPortSemaphoreTryTake(pCorrection->notifySemaphoreHandle,
+                                         U_GNSS_CORRECTION_TASK_POLL_TIME_MS) == 0) {
+            dataTimeMs = pCorrection->notifyTimeMs;
+        } else {
+            dataTimeMs = uPortGetTickTimeMs();
+        }
+    }
+
+    U_PORT_MUTEX_UNLOCK(pCorrection->taskRunningMutexHandle);
+
+    // Delete ourself
+    uPortTaskDelete(NULL);
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Start forwarding correction data to a GNSS chip.
+int32_t uGnssCorrectionStart(uDeviceHandle_t gnssHandle,
+                             uGnssCorrectionReadCallback_t pCallback,
+                             void *pCallbackParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    uGnssPrivateCorrection_t *pCorrection;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if ((pInstance != NULL) && (pCallback != NULL) &&
+            (pInstance->pCorrection == NULL)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            if (uGnssPrivateGetStreamType(pInstance->transportType) >= 0) {
+                errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                pCorrection = (uGnssPrivateCorrection_t *) pUPortMalloc(sizeof(*pCorrection));
+                if (pCorrection != NULL) {
+                    memset(pCorrection, 0, sizeof(*pCorrection));
+                    pCorrection->pReadCallback = (void *) pCallback;
+                    pCorrection->pCallbackParam = pCallbackParam;
+                    pCorrection->keepGoing = true;
+                    pCorrection->pBuffer = (char *) pUPortMalloc(U_GNSS_CORRECTION_BUFFER_LENGTH_BYTES);
+                    if (pCorrection->pBuffer != NULL) {
+                        errorCode = uPortSemaphoreCreate(&(pCorrection->notifySemaphoreHandle), 0, 1);
+                        if (errorCode == 0) {
+                            errorCode = uPortMutexCreate(&(pCorrection->taskRunningMutexHandle));
+                            if (errorCode == 0) {
+                                pInstance->pCorrection = pCorrection;
+                                errorCode = uPortTaskCreate(correctionTask,
+                                                            "gnssCorrection",
+                                                            U_GNSS_CORRECTION_TASK_STACK_SIZE_BYTES,
+                                                            pInstance, U_GNSS_CORRECTION_TASK_PRIORITY,
+                                                            &(pCorrection->taskHandle));
+                                if (errorCode == 0) {
+                                    // Wait for the task to lock the mutex,
+                                    // which shows it is running
+                                    while (uPortMutexTryLock(pCorrection->taskRunningMutexHandle, 0) == 0) {
+                                        uPortMutexUnlock(pCorrection->taskRunningMutexHandle);
+                                        uPortTaskBlock(U_CFG_OS_YIELD_MS);
+                                    }
+                                }
+                            }
+                        }
+                    }
+                    if (errorCode != 0) {
+                        // Tidy up if we couldn't get OS resources
+                        if (pCorrection->taskRunningMutexHandle != NULL) {
+                            uPortMutexDelete(pCorrection->taskRunningMutexHandle);
+                        }
+                        if (pCorrection->notifySemaphoreHandle != NULL) {
+                            uPortSemaphoreDelete(pCorrection->notifySemaphoreHandle);
+                        }
+                        uPortFree(pCorrection->pBuffer);
+                        uPortFree(pCorrection);
+                        pInstance->pCorrection = NULL;
+                    }
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Tell the correction-forwarding task that there is new data.
+// This function does NOT lock gUGnssPrivateMutex in order that
+// it can be called from any callback; this is fine since the
+// correction-forwarding task is brought up and torn down in an
+// organised way.
+void uGnssCorrectionNotify(uDeviceHandle_t gnssHandle)
+{
+    uGnssPrivateInstance_t *pInstance;
+    uGnssPrivateCorrection_t *pCorrection;
+
+    if (gUGnssPrivateMutex != NULL) {
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if (pInstance != NULL) {
+            pCorrection = pInstance->pCorrection;
+            if (pCorrection != NULL) {
+                pCorrection->notifyTimeMs = uPortGetTickTimeMs();
+                uPortSemaphoreGive(pCorrection->notifySemaphoreHandle);
+            }
+        }
+    }
+}
+
+// Stop forwarding correction data to a GNSS chip.
+int32_t uGnssCorrectionStop(uDeviceHandle_t gnssHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if (pInstance != NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            uGnssPrivateStopCorrection(pInstance);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Get the statistics of the correction-forwarding task.
+int32_t uGnssCorrectionStat(uDeviceHandle_t gnssHandle,
+                            uGnssCorrectionStat_t *pStat)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    uGnssPrivateCorrection_t *pCorrection;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if ((pInstance != NULL) && (pInstance->pCorrection != NULL) && (pStat != NULL)) {
+            pCorrection = pInstance->pCorrection;
+            // The task updates these without locking; each is
+            // written in one go, which is good enough for statistics
+            memset(pStat, 0, sizeof(*pStat));
+            pStat->bytesRead = pCorrection->statBytesRead;
+            pStat->bytesForwarded = pCorrection->statBytesForwarded;
+            pStat->bytesDiscarded = pCorrection->statBytesDiscarded;
+            pStat->messagesForwarded = pCorrection->statMessagesForwarded;
+            pStat->messagesDropped = pCorrection->statMessagesDropped;
+            pStat->latencyLastMs = pCorrection->statLatencyLastMs;
+            pStat->latencyMaxMs = pCorrection->statLatencyMaxMs;
+            if (pCorrection->statWriteCount > 0) {
+                pStat->latencyAverageMs = (int32_t) (pCorrection->statLatencyTotalMs /
+                                                     (int64_t) pCorrection->statWriteCount);
+            }
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// End of file
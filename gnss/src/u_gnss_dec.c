@@ -39,9 +39,14 @@
  * interface manual: see u_gnss_dec_ubx_nav_pvt.h for an example.
  * Make sure to follow the usual pattern for the header file gating
  * \#defines and the _MESSAGE_CLASS, _MESSAGE_ID and _BODY_MIN_LENGTH
- * macros.  You may also choose to define helper functions which
- * convert the elements of the structure as defined by the GNSS
- * device interface manual into more friendly structures.
+ * macros.  If the message contains a repeated block, give the
+ * structure a fixed-size array with a compile-time-overridable
+ * maximum length (see u_gnss_dec_ubx_nav_sat.h for an example),
+ * since nothing here may allocate memory for the message body
+ * other than pUGnssDecAlloc() itself.  You may also choose to
+ * define helper functions which convert the elements of the
+ * structure as defined by the GNSS device interface manual into
+ * more friendly structures.
  *
  * 2. \#include this new header file in u_gnss_dec.h, add it to
  * ubxlib.h and add the new message struct to the #uGnssDecUnion_t
@@ -49,12 +54,14 @@
  *
  * 3. Create the static decode function for the message here,
  * following the naming pattern, e.g. for UBX-XXX-YYY the function
- * would be named ubxXxxYyyAlloc(); the function  must have the
- * function signature of #uGnssDecKnownFunction_t.
+ * would be named ubxXxxYyyDecode(); the function  must have the
+ * function signature of #uGnssDecKnownFunction_t and must decode
+ * into the storage it is given, never allocating memory.
  *
- * 4. Add the static function to the gpFunctionList array and add
- * its message ID to the gIdList array, making sure to put it in the
- * same position in both.
+ * 4. Add the message ID to the gIdList array and add an entry
+ * for the decode function, the size of the message structure and
+ * the minimum body length to the gDecoderList array, making sure to
+ * put it in the same position in both.
  *
  * 5. If in step (1) you chose to include helper functions, add a
  * .c file in this src directory, of the same name as the .h file,
@@ -67,11 +74,13 @@
  * function if there are any (again, see the handling of UBX-NAV-PVT
  * for an example).
  *
- * Obviously it would be possible to add NMEA messages, or RTCM messages,
- * in the same way, just replacing "ubx" with "nmea" or "rtcm", but note
- * that this code does not use NMEA or RTCM messages and we want to avoid
- * code bloat, hence the uGnssDecSetCallback() hook to allow a customer
- * to add their own decoders at run-time.
+ * NMEA messages are added in the same way, just replacing "ubx" with
+ * "nmea"; the NMEA message ID in gIdList should use a "??" wildcard
+ * for the talker ID so that, for instance, GPGGA and GNGGA are both
+ * handled.  RTCM messages could be added in the same way but note
+ * that this code does not use RTCM messages and we want to avoid
+ * code bloat, hence the uGnssDecSetCallback() hook to allow a
+ * customer to add their own decoders at run-time.
  */
 
 #ifdef U_CFG_OVERRIDE
@@ -104,6 +113,14 @@
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+#ifndef U_GNSS_DEC_NMEA_MAX_NUM_FIELDS
+/** The maximum number of comma-separated fields that will be
+ * examined in the body of an NMEA message; must be at least as
+ * large as the number of fields of the largest known NMEA message.
+ */
+# define U_GNSS_DEC_NMEA_MAX_NUM_FIELDS 16
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -112,19 +129,19 @@
  * pUGnssDecAlloc() by uGnssDecSetCallback() to decode message types
  * that _are_ known to this code.
  *
- * @param[in] pBuffer             the buffer pointer that was passed to
- *                                pUGnssDecAlloc().
- * @param size                    the number of bytes at pBuffer;
- *                                for a known protocol it _might_
- *                                be that any FCS/check-sum bytes
- *                                on the end have been removed
- *                                by the caller, hence the function
- *                                should not _require_ them to be
- *                                present in the count.
- * @param[out] ppBody             a pointer to a place to put the
- *                                decoded message body, which the
- *                                callback should allocate using
- *                                pUPortMalloc(); will never be NULL.
+ * @param[in] pBuffer             a pointer to the start of the body
+ *                                of the message, i.e. after the UBX
+ *                                header or after the comma that
+ *                                follows the NMEA message ID.
+ * @param size                    the number of bytes of body at
+ *                                pBuffer; for UBX this is the length
+ *                                from the message header, which will
+ *                                be at least the minimum body length
+ *                                given in gDecoderList, for NMEA it
+ *                                excludes any check-sum.
+ * @param[out] pBody              a pointer to a place to put the
+ *                                decoded message body, will have been
+ *                                zeroed; never NULL.
  * @return                        zero on a successful decode, else
  *                                negative error code, preferably
  *                                from the set suggested for the
@@ -132,7 +149,27 @@
  */
 typedef int32_t (uGnssDecKnownFunction_t) (const char *pBuffer,
                                            size_t size,
-                                           uGnssDecUnion_t **ppBody);
+                                           uGnssDecUnion_t *pBody);
+
+/** An entry in the table of known message decoders.
+ */
+typedef struct {
+    uGnssDecKnownFunction_t *pFunction; /**< the decode function. */
+    size_t bodySize;                    /**< the size of the decoded
+                                             structure, what
+                                             pUGnssDecAlloc() has to
+                                             allocate. */
+    size_t bodyMinLength;               /**< for UBX, the minimum length
+                                             of the message body, zero
+                                             for NMEA. */
+} uGnssDecKnown_t;
+
+/** A field of an NMEA message.
+ */
+typedef struct {
+    const char *pStart;
+    size_t length;
+} uGnssDecNmeaField_t;
 
 /* ----------------------------------------------------------------
  * STATIC VARIABLES: MISC
@@ -147,7 +184,7 @@ static uGnssDecFunction_t *gpCallback = NULL;
 static void *gpCallbackParam = NULL;
 
 /** The list of known message IDs; order is important,
- * MUST be in the same order as gpFunctionList (see further
+ * MUST be in the same order as gDecoderList (see further
  * down in this file) and both lists must contain the same number
  * of elements.
  */
@@ -159,122 +196,580 @@ static const uGnssMessageId_t gIdList[] = {
     {
         .type = U_GNSS_PROTOCOL_UBX,
         .id.ubx = U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_NAV_HPPOSLLH_MESSAGE_CLASS, U_GNSS_DEC_UBX_NAV_HPPOSLLH_MESSAGE_ID)
+    },
+    {
+        .type = U_GNSS_PROTOCOL_UBX,
+        .id.ubx = U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_NAV_DOP_MESSAGE_CLASS, U_GNSS_DEC_UBX_NAV_DOP_MESSAGE_ID)
+    },
+    {
+        .type = U_GNSS_PROTOCOL_UBX,
+        .id.ubx = U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_NAV_COV_MESSAGE_CLASS, U_GNSS_DEC_UBX_NAV_COV_MESSAGE_ID)
+    },
+    {
+        .type = U_GNSS_PROTOCOL_UBX,
+        .id.ubx = U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_NAV_TIMEUTC_MESSAGE_CLASS, U_GNSS_DEC_UBX_NAV_TIMEUTC_MESSAGE_ID)
+    },
+    {
+        .type = U_GNSS_PROTOCOL_UBX,
+        .id.ubx = U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_NAV_SAT_MESSAGE_CLASS, U_GNSS_DEC_UBX_NAV_SAT_MESSAGE_ID)
+    },
+    {
+        .type = U_GNSS_PROTOCOL_UBX,
+        .id.ubx = U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_NAV_SIG_MESSAGE_CLASS, U_GNSS_DEC_UBX_NAV_SIG_MESSAGE_ID)
+    },
+    {
+        .type = U_GNSS_PROTOCOL_UBX,
+        .id.ubx = U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_RXM_RAWX_MESSAGE_CLASS, U_GNSS_DEC_UBX_RXM_RAWX_MESSAGE_ID)
+    },
+    {
+        .type = U_GNSS_PROTOCOL_NMEA,
+        .id.pNmea = U_GNSS_DEC_NMEA_GGA_MESSAGE_ID
+    },
+    {
+        .type = U_GNSS_PROTOCOL_NMEA,
+        .id.pNmea = U_GNSS_DEC_NMEA_RMC_MESSAGE_ID
     }
 };
 
 // MORE STATIC VARIABLES after the message decoders...
 
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: HELPERS
+ * -------------------------------------------------------------- */
+
+// Decode a float from a pointer to a little-endian IEEE754 float.
+static float floatDecode(const char *pByte)
+{
+    uint32_t x = uUbxProtocolUint32Decode(pByte);
+    float f;
+
+    memcpy(&f, &x, sizeof(f));
+
+    return f;
+}
+
+// Decode a double from a pointer to a little-endian IEEE754 double.
+static double doubleDecode(const char *pByte)
+{
+    uint64_t x = uUbxProtocolUint64Decode(pByte);
+    double d;
+
+    memcpy(&d, &x, sizeof(d));
+
+    return d;
+}
+
+// Work out how many repeated blocks of a UBX message to decode,
+// limited by both the length of the body and the storage available.
+static size_t ubxNumBlocks(size_t numBlocks, size_t size, size_t offset,
+                           size_t blockLength, size_t maxNumBlocks)
+{
+    if (numBlocks > (size - offset) / blockLength) {
+        numBlocks = (size - offset) / blockLength;
+    }
+    if (numBlocks > maxNumBlocks) {
+        numBlocks = maxNumBlocks;
+    }
+
+    return numBlocks;
+}
+
+// Split the body of an NMEA message into comma-separated fields,
+// returning the number of fields found.
+static size_t nmeaFieldSplit(const char *pBuffer, size_t size,
+                             uGnssDecNmeaField_t *pField,
+                             size_t maxNumFields)
+{
+    size_t numFields = 0;
+    const char *pEnd = pBuffer + size;
+
+    while (numFields < maxNumFields) {
+        pField->pStart = pBuffer;
+        while ((pBuffer < pEnd) && (*pBuffer != ',')) {
+            pBuffer++;
+        }
+        pField->length = pBuffer - pField->pStart;
+        pField++;
+        numFields++;
+        if (pBuffer >= pEnd) {
+            break;
+        }
+        // Move past the comma
+        pBuffer++;
+    }
+
+    return numFields;
+}
+
+// Decode a decimal number from an NMEA field, e.g. "-12.345",
+// as a fixed-point integer with the given number of decimal
+// places, truncating any extra decimal places; returns false
+// if the field is empty or is not a number.
+static bool nmeaFixedDecode(const uGnssDecNmeaField_t *pField,
+                            int32_t decimalPlaces, int64_t *pValue)
+{
+    bool success = false;
+    const char *pBuffer = pField->pStart;
+    const char *pEnd = pField->pStart + pField->length;
+    bool negative = false;
+    bool decimalPoint = false;
+    bool digits = false;
+    int64_t value = 0;
+
+    if ((pBuffer < pEnd) && ((*pBuffer == '-') || (*pBuffer == '+'))) {
+        negative = (*pBuffer == '-');
+        pBuffer++;
+    }
+    success = true;
+    for (; (pBuffer < pEnd) && success; pBuffer++) {
+        if ((*pBuffer >= '0') && (*pBuffer <= '9')) {
+            digits = true;
+            if (!decimalPoint || (decimalPlaces > 0)) {
+                // Stop the integer part before it can overflow
+                success = (value < 100000000000000LL);
+                value = (value * 10) + (*pBuffer - '0');
+                if (decimalPoint) {
+                    decimalPlaces--;
+                }
+            }
+        } else if ((*pBuffer == '.') && !decimalPoint) {
+            decimalPoint = true;
+        } else {
+            success = false;
+        }
+    }
+    success = success && digits;
+    if (success) {
+        for (; decimalPlaces > 0; decimalPlaces--) {
+            value *= 10;
+        }
+        if (negative) {
+            value = -value;
+        }
+        *pValue = value;
+    }
+
+    return success;
+}
+
+// Decode an NMEA time field, hhmmss.ss, into milliseconds since
+// midnight.
+static bool nmeaTimeDecode(const uGnssDecNmeaField_t *pField,
+                           int32_t *pTime)
+{
+    bool success = false;
+    int64_t value;
+    int32_t hours;
+    int32_t minutes;
+
+    if (nmeaFixedDecode(pField, 3, &value) && (value >= 0)) {
+        hours = (int32_t) (value / 10000000);
+        minutes = (int32_t) ((value / 100000) % 100);
+        if ((hours < 24) && (minutes < 60)) {
+            *pTime = (hours * 3600000) + (minutes * 60000) + (int32_t) (value % 100000);
+            success = true;
+        }
+    }
+
+    return success;
+}
+
+// Decode an NMEA latitude or longitude field, [d]ddmm.mmmmm, plus
+// its hemisphere field into degrees times 1e7.
+static bool nmeaLatLonDecode(const uGnssDecNmeaField_t *pField,
+                             const uGnssDecNmeaField_t *pHemisphere,
+                             int32_t *pValue)
+{
+    bool success = false;
+    int64_t value;
+
+    if (nmeaFixedDecode(pField, 7, &value) && (value >= 0) &&
+        (value < 181000000000LL)) {
+        // value / 1e9 is degrees, value % 1e9 is minutes times 1e7
+        *pValue = (int32_t) (((value / 1000000000) * 10000000) +
+                             (((value % 1000000000) + 30) / 60));
+        if ((pHemisphere->length > 0) &&
+            ((*pHemisphere->pStart == 'S') || (*pHemisphere->pStart == 'W'))) {
+            *pValue = -*pValue;
+        }
+        success = true;
+    }
+
+    return success;
+}
+
+// Decode a single-character NMEA field, returning 0 if empty.
+static char nmeaCharDecode(const uGnssDecNmeaField_t *pField)
+{
+    char c = 0;
+
+    if (pField->length > 0) {
+        c = *pField->pStart;
+    }
+
+    return c;
+}
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS: MESSAGE DECODERS
  * -------------------------------------------------------------- */
 
+// Note: for the UBX decoders below, the caller will have checked
+// that the body is at least the minimum length given in gDecoderList.
+// Since each message will have been checked for integrity before
+// it gets here, it is better to trust that the module emitted
+// stuff correctly (it knows more about this than we do), hence
+// the UBX decoders do not range-check fields, and offsets
+// throughout match the offsets in the interface manual.
+
 // Decode a UBX-NAV-PVT message.
-static int32_t ubxNavPvtAlloc(const char *pBuffer, size_t size,
-                              uGnssDecUnion_t **ppBody)
+static int32_t ubxNavPvtDecode(const char *pBuffer, size_t size,
+                               uGnssDecUnion_t *pBody)
+{
+    uGnssDecUbxNavPvt_t *pPvt = &(pBody->ubxNavPvt);
+
+    (void) size;
+
+    pPvt->iTOW = (int32_t) uUbxProtocolUint32Decode(pBuffer + 0);
+    pPvt->year = uUbxProtocolUint16Decode(pBuffer + 4);
+    pPvt->month = (uint8_t) *(pBuffer + 6); // *NOPAD* stop AStyle making * look like a multiply
+    pPvt->day = (uint8_t) *(pBuffer + 7); // *NOPAD*
+    pPvt->hour = (uint8_t) *(pBuffer + 8); // *NOPAD*
+    pPvt->min = (uint8_t) *(pBuffer + 9); // *NOPAD*
+    pPvt->sec = (uint8_t) *(pBuffer + 10); // *NOPAD*
+    pPvt->valid = (uint8_t) *(pBuffer + 11); // *NOPAD*
+    pPvt->tAcc = uUbxProtocolUint32Decode(pBuffer + 12);
+    pPvt->nano = (int32_t) uUbxProtocolUint32Decode(pBuffer + 16);
+    pPvt->fixType = (uGnssDecUbxNavPvtFixType_t) *(pBuffer + 20); // *NOPAD*
+    pPvt->flags = (uint8_t) *(pBuffer + 21); // *NOPAD*
+    pPvt->flags2 = (uint8_t) *(pBuffer + 22); // *NOPAD*
+    pPvt->numSV = (uint8_t) *(pBuffer + 23); // *NOPAD*
+    pPvt->lon = (int32_t) uUbxProtocolUint32Decode(pBuffer + 24);
+    pPvt->lat = (int32_t) uUbxProtocolUint32Decode(pBuffer + 28);
+    pPvt->height = (int32_t) uUbxProtocolUint32Decode(pBuffer + 32);
+    pPvt->hMSL = (int32_t) uUbxProtocolUint32Decode(pBuffer + 36);
+    pPvt->hAcc = uUbxProtocolUint32Decode(pBuffer + 40);
+    pPvt->vAcc = uUbxProtocolUint32Decode(pBuffer + 44);
+    pPvt->velN = (int32_t) uUbxProtocolUint32Decode(pBuffer + 48);
+    pPvt->velE = (int32_t) uUbxProtocolUint32Decode(pBuffer + 52);
+    pPvt->velD = (int32_t) uUbxProtocolUint32Decode(pBuffer + 56);
+    pPvt->gSpeed = (int32_t) uUbxProtocolUint32Decode(pBuffer + 60);
+    pPvt->headMot = (int32_t) uUbxProtocolUint32Decode(pBuffer + 64);
+    pPvt->sAcc = uUbxProtocolUint32Decode(pBuffer + 68);
+    pPvt->headAcc = uUbxProtocolUint32Decode(pBuffer + 72);
+    pPvt->pDOP = uUbxProtocolUint16Decode(pBuffer + 76);
+    pPvt->flags3 = uUbxProtocolUint16Decode(pBuffer + 78);
+    // 4 reserved bytes here
+    pPvt->headVeh = (int32_t) uUbxProtocolUint32Decode(pBuffer + 84);
+    pPvt->magDec = (int16_t) uUbxProtocolUint16Decode(pBuffer + 88);
+    pPvt->magAcc = (int16_t) uUbxProtocolUint16Decode(pBuffer + 90);
+
+    return (int32_t) U_ERROR_COMMON_SUCCESS;
+}
+
+// Decode a UBX-NAV-HPPOSLLH message.
+static int32_t ubxNavHpposllhDecode(const char *pBuffer, size_t size,
+                                    uGnssDecUnion_t *pBody)
+{
+    uGnssDecUbxNavHpposllh_t *pHpposllh = &(pBody->ubxNavHpposllh);
+
+    (void) size;
+
+    pHpposllh->version = (uint8_t) *(pBuffer + 0); // *NOPAD* stop AStyle making * look like a multiply
+    // 2 reserved bytes here
+    pHpposllh->flags = (uint8_t) *(pBuffer + 3); // *NOPAD*
+    pHpposllh->iTOW = (int32_t) uUbxProtocolUint32Decode(pBuffer + 4);
+    pHpposllh->lon = (int32_t) uUbxProtocolUint32Decode(pBuffer + 8);
+    pHpposllh->lat = (int32_t) uUbxProtocolUint32Decode(pBuffer + 12);
+    pHpposllh->height = (int32_t) uUbxProtocolUint32Decode(pBuffer + 16);
+    pHpposllh->hMSL = (int32_t) uUbxProtocolUint32Decode(pBuffer + 20);
+    pHpposllh->lonHp = (int8_t) *(pBuffer + 24); // *NOPAD*
+    pHpposllh->latHp = (int8_t) *(pBuffer + 25); // *NOPAD*
+    pHpposllh->heightHp = (int8_t) *(pBuffer + 26); // *NOPAD*
+    pHpposllh->hMSLHp = (int8_t) *(pBuffer + 27); // *NOPAD*
+    pHpposllh->hAcc = uUbxProtocolUint32Decode(pBuffer + 28);
+    pHpposllh->vAcc = uUbxProtocolUint32Decode(pBuffer + 32);
+
+    return (int32_t) U_ERROR_COMMON_SUCCESS;
+}
+
+// Decode a UBX-NAV-DOP message.
+static int32_t ubxNavDopDecode(const char *pBuffer, size_t size,
+                               uGnssDecUnion_t *pBody)
+{
+    uGnssDecUbxNavDop_t *pDop = &(pBody->ubxNavDop);
+
+    (void) size;
+
+    pDop->iTOW = uUbxProtocolUint32Decode(pBuffer + 0);
+    pDop->gDOP = uUbxProtocolUint16Decode(pBuffer + 4);
+    pDop->pDOP = uUbxProtocolUint16Decode(pBuffer + 6);
+    pDop->tDOP = uUbxProtocolUint16Decode(pBuffer + 8);
+    pDop->vDOP = uUbxProtocolUint16Decode(pBuffer + 10);
+    pDop->hDOP = uUbxProtocolUint16Decode(pBuffer + 12);
+    pDop->nDOP = uUbxProtocolUint16Decode(pBuffer + 14);
+    pDop->eDOP = uUbxProtocolUint16Decode(pBuffer + 16);
+
+    return (int32_t) U_ERROR_COMMON_SUCCESS;
+}
+
+// Decode a UBX-NAV-COV message.
+static int32_t ubxNavCovDecode(const char *pBuffer, size_t size,
+                               uGnssDecUnion_t *pBody)
+{
+    uGnssDecUbxNavCov_t *pCov = &(pBody->ubxNavCov);
+
+    (void) size;
+
+    pCov->iTOW = uUbxProtocolUint32Decode(pBuffer + 0);
+    pCov->version = (uint8_t) *(pBuffer + 4); // *NOPAD*
+    pCov->posCovValid = (uint8_t) *(pBuffer + 5); // *NOPAD*
+    pCov->velCovValid = (uint8_t) *(pBuffer + 6); // *NOPAD*
+    // 9 reserved bytes here
+    pCov->posCovNN = floatDecode(pBuffer + 16);
+    pCov->posCovNE = floatDecode(pBuffer + 20);
+    pCov->posCovND = floatDecode(pBuffer + 24);
+    pCov->posCovEE = floatDecode(pBuffer + 28);
+    pCov->posCovED = floatDecode(pBuffer + 32);
+    pCov->posCovDD = floatDecode(pBuffer + 36);
+    pCov->velCovNN = floatDecode(pBuffer + 40);
+    pCov->velCovNE = floatDecode(pBuffer + 44);
+    pCov->velCovND = floatDecode(pBuffer + 48);
+    pCov->velCovEE = floatDecode(pBuffer + 52);
+    pCov->velCovED = floatDecode(pBuffer + 56);
+    pCov->velCovDD = floatDecode(pBuffer + 60);
+
+    return (int32_t) U_ERROR_COMMON_SUCCESS;
+}
+
+// Decode a UBX-NAV-TIMEUTC message.
+static int32_t ubxNavTimeutcDecode(const char *pBuffer, size_t size,
+                                   uGnssDecUnion_t *pBody)
+{
+    uGnssDecUbxNavTimeutc_t *pTimeutc = &(pBody->ubxNavTimeutc);
+
+    (void) size;
+
+    pTimeutc->iTOW = uUbxProtocolUint32Decode(pBuffer + 0);
+    pTimeutc->tAcc = uUbxProtocolUint32Decode(pBuffer + 4);
+    pTimeutc->nano = (int32_t) uUbxProtocolUint32Decode(pBuffer + 8);
+    pTimeutc->year = uUbxProtocolUint16Decode(pBuffer + 12);
+    pTimeutc->month = (uint8_t) *(pBuffer + 14); // *NOPAD*
+    pTimeutc->day = (uint8_t) *(pBuffer + 15); // *NOPAD*
+    pTimeutc->hour = (uint8_t) *(pBuffer + 16); // *NOPAD*
+    pTimeutc->min = (uint8_t) *(pBuffer + 17); // *NOPAD*
+    pTimeutc->sec = (uint8_t) *(pBuffer + 18); // *NOPAD*
+    pTimeutc->valid = (uint8_t) *(pBuffer + 19); // *NOPAD*
+
+    return (int32_t) U_ERROR_COMMON_SUCCESS;
+}
+
+// Decode a UBX-NAV-SAT message.
+static int32_t ubxNavSatDecode(const char *pBuffer, size_t size,
+                               uGnssDecUnion_t *pBody)
+{
+    uGnssDecUbxNavSat_t *pSat = &(pBody->ubxNavSat);
+    uGnssDecUbxNavSatSv_t *pSv = pSat->sv;
+    const char *pBlock = pBuffer + U_GNSS_DEC_UBX_NAV_SAT_BODY_MIN_LENGTH;
+
+    pSat->iTOW = uUbxProtocolUint32Decode(pBuffer + 0);
+    pSat->version = (uint8_t) *(pBuffer + 4); // *NOPAD*
+    pSat->numSvs = (uint8_t) ubxNumBlocks((uint8_t) *(pBuffer + 5), size, // *NOPAD*
+                                          U_GNSS_DEC_UBX_NAV_SAT_BODY_MIN_LENGTH,
+                                          U_GNSS_DEC_UBX_NAV_SAT_BLOCK_LENGTH,
+                                          U_GNSS_DEC_UBX_NAV_SAT_MAX_NUM_SVS);
+    // 2 reserved bytes here
+    for (size_t x = 0; x < pSat->numSvs; x++) {
+        pSv->gnssId = (uint8_t) *(pBlock + 0); // *NOPAD*
+        pSv->svId = (uint8_t) *(pBlock + 1); // *NOPAD*
+        pSv->cno = (uint8_t) *(pBlock + 2); // *NOPAD*
+        pSv->elev = (int8_t) *(pBlock + 3); // *NOPAD*
+        pSv->azim = (int16_t) uUbxProtocolUint16Decode(pBlock + 4);
+        pSv->prRes = (int16_t) uUbxProtocolUint16Decode(pBlock + 6);
+        pSv->flags = uUbxProtocolUint32Decode(pBlock + 8);
+        pSv++;
+        pBlock += U_GNSS_DEC_UBX_NAV_SAT_BLOCK_LENGTH;
+    }
+
+    return (int32_t) U_ERROR_COMMON_SUCCESS;
+}
+
+// Decode a UBX-NAV-SIG message.
+static int32_t ubxNavSigDecode(const char *pBuffer, size_t size,
+                               uGnssDecUnion_t *pBody)
+{
+    uGnssDecUbxNavSig_t *pSig = &(pBody->ubxNavSig);
+    uGnssDecUbxNavSigSig_t *pSigSig = pSig->sig;
+    const char *pBlock = pBuffer + U_GNSS_DEC_UBX_NAV_SIG_BODY_MIN_LENGTH;
+
+    pSig->iTOW = uUbxProtocolUint32Decode(pBuffer + 0);
+    pSig->version = (uint8_t) *(pBuffer + 4); // *NOPAD*
+    pSig->numSigs = (uint8_t) ubxNumBlocks((uint8_t) *(pBuffer + 5), size, // *NOPAD*
+                                           U_GNSS_DEC_UBX_NAV_SIG_BODY_MIN_LENGTH,
+                                           U_GNSS_DEC_UBX_NAV_SIG_BLOCK_LENGTH,
+                                           U_GNSS_DEC_UBX_NAV_SIG_MAX_NUM_SIGS);
+    // 2 reserved bytes here
+    for (size_t x = 0; x < pSig->numSigs; x++) {
+        pSigSig->gnssId = (uint8_t) *(pBlock + 0); // *NOPAD*
+        pSigSig->svId = (uint8_t) *(pBlock + 1); // *NOPAD*
+        pSigSig->sigId = (uint8_t) *(pBlock + 2); // *NOPAD*
+        pSigSig->freqId = (uint8_t) *(pBlock + 3); // *NOPAD*
+        pSigSig->prRes = (int16_t) uUbxProtocolUint16Decode(pBlock + 4);
+        pSigSig->cno = (uint8_t) *(pBlock + 6); // *NOPAD*
+        pSigSig->qualityInd = (uint8_t) *(pBlock + 7); // *NOPAD*
+        pSigSig->corrSource = (uint8_t) *(pBlock + 8); // *NOPAD*
+        pSigSig->ionoModel = (uint8_t) *(pBlock + 9); // *NOPAD*
+        pSigSig->sigFlags = uUbxProtocolUint16Decode(pBlock + 10);
+        // 4 reserved bytes here
+        pSigSig++;
+        pBlock += U_GNSS_DEC_UBX_NAV_SIG_BLOCK_LENGTH;
+    }
+
+    return (int32_t) U_ERROR_COMMON_SUCCESS;
+}
+
+// Decode a UBX-RXM-RAWX message.
+static int32_t ubxRxmRawxDecode(const char *pBuffer, size_t size,
+                                uGnssDecUnion_t *pBody)
+{
+    uGnssDecUbxRxmRawx_t *pRawx = &(pBody->ubxRxmRawx);
+    uGnssDecUbxRxmRawxMeas_t *pMeas = pRawx->meas;
+    const char *pBlock = pBuffer + U_GNSS_DEC_UBX_RXM_RAWX_BODY_MIN_LENGTH;
+
+    pRawx->rcvTow = doubleDecode(pBuffer + 0);
+    pRawx->week = uUbxProtocolUint16Decode(pBuffer + 8);
+    pRawx->leapS = (int8_t) *(pBuffer + 10); // *NOPAD*
+    pRawx->numMeas = (uint8_t) ubxNumBlocks((uint8_t) *(pBuffer + 11), size, // *NOPAD*
+                                            U_GNSS_DEC_UBX_RXM_RAWX_BODY_MIN_LENGTH,
+                                            U_GNSS_DEC_UBX_RXM_RAWX_BLOCK_LENGTH,
+                                            U_GNSS_DEC_UBX_RXM_RAWX_MAX_NUM_MEAS);
+    pRawx->recStat = (uint8_t) *(pBuffer + 12); // *NOPAD*
+    pRawx->version = (uint8_t) *(pBuffer + 13); // *NOPAD*
+    // 2 reserved bytes here
+    for (size_t x = 0; x < pRawx->numMeas; x++) {
+        pMeas->prMes = doubleDecode(pBlock + 0);
+        pMeas->cpMes = doubleDecode(pBlock + 8);
+        pMeas->doMes = floatDecode(pBlock + 16);
+        pMeas->gnssId = (uint8_t) *(pBlock + 20); // *NOPAD*
+        pMeas->svId = (uint8_t) *(pBlock + 21); // *NOPAD*
+        pMeas->sigId = (uint8_t) *(pBlock + 22); // *NOPAD*
+        pMeas->freqId = (uint8_t) *(pBlock + 23); // *NOPAD*
+        pMeas->locktime = uUbxProtocolUint16Decode(pBlock + 24);
+        pMeas->cno = (uint8_t) *(pBlock + 26); // *NOPAD*
+        pMeas->prStdev = (uint8_t) *(pBlock + 27); // *NOPAD*
+        pMeas->cpStdev = (uint8_t) *(pBlock + 28); // *NOPAD*
+        pMeas->doStdev = (uint8_t) *(pBlock + 29); // *NOPAD*
+        pMeas->trkStat = (uint8_t) *(pBlock + 30); // *NOPAD*
+        // 1 reserved byte here
+        pMeas++;
+        pBlock += U_GNSS_DEC_UBX_RXM_RAWX_BLOCK_LENGTH;
+    }
+
+    return (int32_t) U_ERROR_COMMON_SUCCESS;
+}
+
+// Decode an NMEA GGA message.
+static int32_t nmeaGgaDecode(const char *pBuffer, size_t size,
+                             uGnssDecUnion_t *pBody)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_TRUNCATED;
-    uGnssDecUbxNavPvt_t *pBody;
-
-    // No need to check pBuffer or ppBody for NULLity,
-    // we will never give this function NULL for those.
-    if (size >= U_UBX_PROTOCOL_HEADER_LENGTH_BYTES + U_GNSS_DEC_UBX_NAV_PVT_BODY_MIN_LENGTH) {
-        // Move past the header so that we can use payload offsets
-        // throughout, matching the offsets in the interface manual
-        pBuffer += U_UBX_PROTOCOL_HEADER_LENGTH_BYTES;
-        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
-        pBody = (uGnssDecUbxNavPvt_t *) pUPortMalloc(sizeof(uGnssDecUbxNavPvt_t));
-        if (pBody != NULL) {
-            memset(pBody, 0, sizeof(*pBody));
-            // All good now, unless we hit a field we can't decode,
-            // in which case we _could_ set U_ERROR_COMMON_BAD_DATA,
-            // but, since this message will have been checked for
-            // integrity before it gets here, it is better to trust
-            // that the module emitted stuff correctly: it knows
-            // more about this than we do
-            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
-            pBody->iTOW = (int32_t) uUbxProtocolUint32Decode(pBuffer + 0);
-            pBody->year = uUbxProtocolUint16Decode(pBuffer + 4);
-            pBody->month = (uint8_t) *(pBuffer + 6); // *NOPAD* stop AStyle making * look like a multiply
-            pBody->day = (uint8_t) *(pBuffer + 7); // *NOPAD*
-            pBody->hour = (uint8_t) *(pBuffer + 8); // *NOPAD*
-            pBody->min = (uint8_t) *(pBuffer + 9); // *NOPAD*
-            pBody->sec = (uint8_t) *(pBuffer + 10); // *NOPAD*
-            pBody->valid = (uint8_t) *(pBuffer + 11); // *NOPAD*
-            pBody->tAcc = uUbxProtocolUint32Decode(pBuffer + 12);
-            pBody->nano = (int32_t) uUbxProtocolUint32Decode(pBuffer + 16);
-            pBody->fixType = (uGnssDecUbxNavPvtFixType_t) *(pBuffer + 20); // *NOPAD*
-            pBody->flags = (uint8_t) *(pBuffer + 21); // *NOPAD*
-            pBody->flags2 = (uint8_t) *(pBuffer + 22); // *NOPAD*
-            pBody->numSV = (uint8_t) *(pBuffer + 23); // *NOPAD*
-            pBody->lon = (int32_t) uUbxProtocolUint32Decode(pBuffer + 24);
-            pBody->lat = (int32_t) uUbxProtocolUint32Decode(pBuffer + 28);
-            pBody->height = (int32_t) uUbxProtocolUint32Decode(pBuffer + 32);
-            pBody->hMSL = (int32_t) uUbxProtocolUint32Decode(pBuffer + 36);
-            pBody->hAcc = uUbxProtocolUint32Decode(pBuffer + 40);
-            pBody->vAcc = uUbxProtocolUint32Decode(pBuffer + 44);
-            pBody->velN = (int32_t) uUbxProtocolUint32Decode(pBuffer + 48);
-            pBody->velE = (int32_t) uUbxProtocolUint32Decode(pBuffer + 52);
-            pBody->velD = (int32_t) uUbxProtocolUint32Decode(pBuffer + 56);
-            pBody->gSpeed = (int32_t) uUbxProtocolUint32Decode(pBuffer + 60);
-            pBody->headMot = (int32_t) uUbxProtocolUint32Decode(pBuffer + 64);
-            pBody->sAcc = uUbxProtocolUint32Decode(pBuffer + 68);
-            pBody->headAcc = uUbxProtocolUint32Decode(pBuffer + 72);
-            pBody->pDOP = uUbxProtocolUint16Decode(pBuffer + 76);
-            pBody->flags3 = uUbxProtocolUint16Decode(pBuffer + 78);
-            // 4 reserved bytes here
-            pBody->headVeh = (int32_t) uUbxProtocolUint32Decode(pBuffer + 84);
-            pBody->magDec = (int16_t) uUbxProtocolUint16Decode(pBuffer + 88);
-            pBody->magAcc = (int16_t) uUbxProtocolUint16Decode(pBuffer + 90);
-
-            // Populate the pointer that was passed in
-            *ppBody = (uGnssDecUnion_t *) pBody;
+    uGnssDecNmeaGga_t *pGga = &(pBody->nmeaGga);
+    uGnssDecNmeaField_t field[U_GNSS_DEC_NMEA_MAX_NUM_FIELDS];
+    size_t numFields;
+    int64_t value;
+
+    // time,lat,NS,lon,EW,quality,numSV,HDOP,alt,altUnit,sep,sepUnit,diffAge,diffStation
+    numFields = nmeaFieldSplit(pBuffer, size, field, sizeof(field) / sizeof(field[0]));
+    if (numFields >= 14) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        if (nmeaTimeDecode(&(field[0]), &(pGga->time))) {
+            pGga->present |= 1 << U_GNSS_DEC_NMEA_GGA_PRESENT_TIME;
+        }
+        if (nmeaLatLonDecode(&(field[1]), &(field[2]), &(pGga->lat)) &&
+            nmeaLatLonDecode(&(field[3]), &(field[4]), &(pGga->lon))) {
+            pGga->present |= 1 << U_GNSS_DEC_NMEA_GGA_PRESENT_LAT_LON;
+        }
+        if (nmeaFixedDecode(&(field[5]), 0, &value)) {
+            pGga->quality = (uGnssDecNmeaGgaQuality_t) value;
+        }
+        if (nmeaFixedDecode(&(field[6]), 0, &value)) {
+            pGga->numSV = (uint8_t) value;
+        }
+        if (nmeaFixedDecode(&(field[7]), 2, &value)) {
+            pGga->HDOP = (int32_t) value;
+            pGga->present |= 1 << U_GNSS_DEC_NMEA_GGA_PRESENT_HDOP;
+        }
+        if (nmeaFixedDecode(&(field[8]), 3, &value)) {
+            pGga->alt = (int32_t) value;
+            pGga->present |= 1 << U_GNSS_DEC_NMEA_GGA_PRESENT_ALT;
+        }
+        if (nmeaFixedDecode(&(field[10]), 3, &value)) {
+            pGga->sep = (int32_t) value;
+            pGga->present |= 1 << U_GNSS_DEC_NMEA_GGA_PRESENT_SEP;
+        }
+        if (nmeaFixedDecode(&(field[12]), 3, &value)) {
+            pGga->diffAge = (int32_t) value;
+            pGga->present |= 1 << U_GNSS_DEC_NMEA_GGA_PRESENT_DIFF_AGE;
+        }
+        if (nmeaFixedDecode(&(field[13]), 0, &value)) {
+            pGga->diffStation = (int32_t) value;
+            pGga->present |= 1 << U_GNSS_DEC_NMEA_GGA_PRESENT_DIFF_STATION;
         }
     }
 
     return errorCode;
 }
 
-// Decode a UBX-NAV-HPPOSLLH message.
-static int32_t ubxNavHpposllhAlloc(const char *pBuffer, size_t size,
-                                   uGnssDecUnion_t **ppBody)
+// Decode an NMEA RMC message.
+static int32_t nmeaRmcDecode(const char *pBuffer, size_t size,
+                             uGnssDecUnion_t *pBody)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_TRUNCATED;
-    uGnssDecUbxNavHpposllh_t *pBody;
-
-    // No need to check pBuffer or ppBody for NULLity,
-    // we will never give this function NULL for those.
-    if (size >= U_UBX_PROTOCOL_HEADER_LENGTH_BYTES + U_GNSS_DEC_UBX_NAV_HPPOSLLH_BODY_MIN_LENGTH) {
-        // Move past the header so that we can use payload offsets
-        // throughout, matching the offsets in the interface manual
-        pBuffer += U_UBX_PROTOCOL_HEADER_LENGTH_BYTES;
-        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
-        pBody = (uGnssDecUbxNavHpposllh_t *) pUPortMalloc(sizeof(uGnssDecUbxNavHpposllh_t));
-        if (pBody != NULL) {
-            memset(pBody, 0, sizeof(*pBody));
-            // All good now, unless we hit a field we can't decode,
-            // in which case we _could_ set U_ERROR_COMMON_BAD_DATA,
-            // but, since this message will have been checked for
-            // integrity before it gets here, it is better to trust
-            // that the module emitted stuff correctly: it knows
-            // more about this than we do
-            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
-            pBody->version = (uint8_t) *(pBuffer + 0); // *NOPAD* stop AStyle making * look like a multiply
-            // 2 reserved bytes here
-            pBody->flags = (uint8_t) *(pBuffer + 3); // *NOPAD*
-            pBody->iTOW = (int32_t) uUbxProtocolUint32Decode(pBuffer + 4);
-            pBody->lon = (int32_t) uUbxProtocolUint32Decode(pBuffer + 8);
-            pBody->lat = (int32_t) uUbxProtocolUint32Decode(pBuffer + 12);
-            pBody->height = (int32_t) uUbxProtocolUint32Decode(pBuffer + 16);
-            pBody->hMSL = (int32_t) uUbxProtocolUint32Decode(pBuffer + 20);
-            pBody->lonHp = (int8_t) *(pBuffer + 24); // *NOPAD*
-            pBody->latHp = (int8_t) *(pBuffer + 25); // *NOPAD*
-            pBody->heightHp = (int8_t) *(pBuffer + 26); // *NOPAD*
-            pBody->hMSLHp = (int8_t) *(pBuffer + 27); // *NOPAD*
-            pBody->hAcc = uUbxProtocolUint32Decode(pBuffer + 28);
-            pBody->vAcc = uUbxProtocolUint32Decode(pBuffer + 32);
-
-            // Populate the pointer that was passed in
-            *ppBody = (uGnssDecUnion_t *) pBody;
+    uGnssDecNmeaRmc_t *pRmc = &(pBody->nmeaRmc);
+    uGnssDecNmeaField_t field[U_GNSS_DEC_NMEA_MAX_NUM_FIELDS];
+    size_t numFields;
+    int64_t value;
+
+    // time,status,lat,NS,lon,EW,spd,cog,date,mv,mvEW,posMode,navStatus,
+    // where posMode and navStatus are only present in later NMEA versions
+    numFields = nmeaFieldSplit(pBuffer, size, field, sizeof(field) / sizeof(field[0]));
+    if (numFields >= 11) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        if (nmeaTimeDecode(&(field[0]), &(pRmc->time))) {
+            pRmc->present |= 1 << U_GNSS_DEC_NMEA_RMC_PRESENT_TIME;
+        }
+        pRmc->status = nmeaCharDecode(&(field[1]));
+        if (nmeaLatLonDecode(&(field[2]), &(field[3]), &(pRmc->lat)) &&
+            nmeaLatLonDecode(&(field[4]), &(field[5]), &(pRmc->lon))) {
+            pRmc->present |= 1 << U_GNSS_DEC_NMEA_RMC_PRESENT_LAT_LON;
+        }
+        if (nmeaFixedDecode(&(field[6]), 3, &value)) {
+            pRmc->spd = (int32_t) value;
+            pRmc->present |= 1 << U_GNSS_DEC_NMEA_RMC_PRESENT_SPD;
+        }
+        if (nmeaFixedDecode(&(field[7]), 2, &value)) {
+            pRmc->cog = (int32_t) value;
+            pRmc->present |= 1 << U_GNSS_DEC_NMEA_RMC_PRESENT_COG;
+        }
+        // Date is ddmmyy
+        if (nmeaFixedDecode(&(field[8]), 0, &value) && (value >= 0)) {
+            pRmc->day = (uint8_t) (value / 10000);
+            pRmc->month = (uint8_t) ((value / 100) % 100);
+            pRmc->year = (uint16_t) (2000 + (value % 100));
+            pRmc->present |= 1 << U_GNSS_DEC_NMEA_RMC_PRESENT_DATE;
+        }
+        if (nmeaFixedDecode(&(field[9]), 2, &value)) {
+            pRmc->mv = (int32_t) value;
+            if (nmeaCharDecode(&(field[10])) == 'W') {
+                pRmc->mv = -pRmc->mv;
+            }
+            pRmc->present |= 1 << U_GNSS_DEC_NMEA_RMC_PRESENT_MV;
+        }
+        if (numFields > 11) {
+            pRmc->posMode = nmeaCharDecode(&(field[11]));
+        }
+        if (numFields > 12) {
+            pRmc->navStatus = nmeaCharDecode(&(field[12]));
         }
     }
 
@@ -285,117 +780,236 @@ static int32_t ubxNavHpposllhAlloc(const char *pBuffer, size_t size,
  * STATIC VARIABLES: MESSAGE DECODER LIST
  * -------------------------------------------------------------- */
 
-/** A list of message decode functions; order is important,
- * MUST be in the same order as gIdList and both lists
- * must contain the same number of elements.
+/** A list of message decoders; order is important, MUST be in
+ * the same order as gIdList and both lists must contain the same
+ * number of elements.
  */
-static uGnssDecKnownFunction_t *gpFunctionList[] = {
-    ubxNavPvtAlloc,
-    ubxNavHpposllhAlloc
+static const uGnssDecKnown_t gDecoderList[] = {
+    {ubxNavPvtDecode, sizeof(uGnssDecUbxNavPvt_t), U_GNSS_DEC_UBX_NAV_PVT_BODY_MIN_LENGTH},
+    {ubxNavHpposllhDecode, sizeof(uGnssDecUbxNavHpposllh_t), U_GNSS_DEC_UBX_NAV_HPPOSLLH_BODY_MIN_LENGTH},
+    {ubxNavDopDecode, sizeof(uGnssDecUbxNavDop_t), U_GNSS_DEC_UBX_NAV_DOP_BODY_MIN_LENGTH},
+    {ubxNavCovDecode, sizeof(uGnssDecUbxNavCov_t), U_GNSS_DEC_UBX_NAV_COV_BODY_MIN_LENGTH},
+    {ubxNavTimeutcDecode, sizeof(uGnssDecUbxNavTimeutc_t), U_GNSS_DEC_UBX_NAV_TIMEUTC_BODY_MIN_LENGTH},
+    {ubxNavSatDecode, sizeof(uGnssDecUbxNavSat_t), U_GNSS_DEC_UBX_NAV_SAT_BODY_MIN_LENGTH},
+    {ubxNavSigDecode, sizeof(uGnssDecUbxNavSig_t), U_GNSS_DEC_UBX_NAV_SIG_BODY_MIN_LENGTH},
+    {ubxRxmRawxDecode, sizeof(uGnssDecUbxRxmRawx_t), U_GNSS_DEC_UBX_RXM_RAWX_BODY_MIN_LENGTH},
+    {nmeaGgaDecode, sizeof(uGnssDecNmeaGga_t), 0},
+    {nmeaRmcDecode, sizeof(uGnssDecNmeaRmc_t), 0}
 };
 
 /* ----------------------------------------------------------------
- * PUBLIC FUNCTIONS
+ * STATIC FUNCTIONS: MESSAGE IDENTIFICATION
  * -------------------------------------------------------------- */
 
-// Decode a message buffer received from a GNSS device.
-uGnssDec_t *pUGnssDecAlloc(const char *pBuffer, size_t size)
+// Return true if the given message ID matches a known message ID,
+// allowing '?' wildcards in the known NMEA ID; deliberately cheaper
+// than uGnssMsgIdIsWanted() since it is called for every message.
+static bool idMatch(const uGnssMessageId_t *pId,
+                    const uGnssMessageId_t *pIdKnown)
 {
-    uGnssDec_t *pDec = NULL;
+    bool match = false;
+    const char *pNmea;
+    const char *pNmeaKnown;
+
+    if (pId->type == pIdKnown->type) {
+        switch (pId->type) {
+            case U_GNSS_PROTOCOL_UBX:
+                match = (pId->id.ubx == pIdKnown->id.ubx);
+                break;
+            case U_GNSS_PROTOCOL_NMEA:
+                pNmea = pId->id.pNmea;
+                pNmeaKnown = pIdKnown->id.pNmea;
+                match = true;
+                for (; match && (*pNmeaKnown != 0); pNmea++, pNmeaKnown++) {
+                    match = (*pNmea != 0) && ((*pNmeaKnown == '?') || (*pNmeaKnown == *pNmea));
+                }
+                // The IDs must also be the same length
+                match = match && (*pNmea == 0);
+                break;
+            case U_GNSS_PROTOCOL_RTCM:
+                match = (pId->id.rtcm == pIdKnown->id.rtcm);
+                break;
+            default:
+                break;
+        }
+    }
+
+    return match;
+}
+
+// Determine the protocol type/message ID of the message in pBuffer,
+// populating the errorCode, id and nmea fields of pDec, and return
+// the entry in gDecoderList for it, or NULL if there isn't one or
+// the message is too short to decode; ppBody and pBodySize are
+// populated with the location and size of the message body.
+static const uGnssDecKnown_t *pDecodeId(const char *pBuffer, size_t size,
+                                        uGnssDec_t *pDec,
+                                        const char **ppBody,
+                                        size_t *pBodySize)
+{
+    const uGnssDecKnown_t *pKnown = NULL;
     uint8_t *pBufferUint8 = (uint8_t *) pBuffer; // To avoid problems with signed char compares
-    uGnssDecKnownFunction_t *pFunction = NULL;
     size_t x;
     size_t y;
 
-    pDec = (uGnssDec_t *) pUPortMalloc(sizeof(uGnssDec_t));
-    if (pDec != NULL) {
-        memset(pDec, 0, sizeof(*pDec));
-        pDec->errorCode = (int32_t) U_ERROR_COMMON_EMPTY;
-        pDec->id.type = U_GNSS_PROTOCOL_UNKNOWN;
-        if ((pBufferUint8 != NULL) && (size > 0)) {
-            // Determine the protocol type/message ID and make
-            // sure the header is sound
-            pDec->errorCode = (int32_t) U_ERROR_COMMON_UNKNOWN;
-            if ((*pBufferUint8 == 0xB5) && (size >= 1) && (*(pBufferUint8 + 1) == 0x62)) {
-                // Likely a UBX message
+    memset(pDec, 0, sizeof(*pDec));
+    pDec->errorCode = (int32_t) U_ERROR_COMMON_EMPTY;
+    pDec->id.type = U_GNSS_PROTOCOL_UNKNOWN;
+    if ((pBufferUint8 != NULL) && (size > 0)) {
+        // Determine the protocol type/message ID and make
+        // sure the header is sound
+        pDec->errorCode = (int32_t) U_ERROR_COMMON_UNKNOWN;
+        if ((*pBufferUint8 == 0xB5) && (size >= 2) && (*(pBufferUint8 + 1) == 0x62)) {
+            // Likely a UBX message
+            pBufferUint8 += 2;
+            pDec->id.type = U_GNSS_PROTOCOL_UBX;
+            pDec->errorCode = (int32_t) U_ERROR_COMMON_TRUNCATED;
+            if (size >= U_UBX_PROTOCOL_HEADER_LENGTH_BYTES) {
+                // Grab the message class and message ID, check the length,
+                // allowing the checksum bytes to be omitted
+                pDec->id.id.ubx = U_GNSS_UBX_MESSAGE(*pBufferUint8, *(pBufferUint8 + 1));
                 pBufferUint8 += 2;
-                pDec->id.type = U_GNSS_PROTOCOL_UBX;
-                pDec->errorCode = (int32_t) U_ERROR_COMMON_TRUNCATED;
-                if (size >= U_UBX_PROTOCOL_HEADER_LENGTH_BYTES) {
-                    // Grab the message class and message ID, check the length,
-                    // allowing the checksum bytes to be omitted
-                    pDec->id.id.ubx = U_GNSS_UBX_MESSAGE(*pBufferUint8, *(pBufferUint8 + 1));
-                    pBufferUint8 += 2;
-                    y = *pBufferUint8 + ((uint16_t) *(pBufferUint8 + 1) << 8); // *NOPAD*
-                    if (size >= y + U_UBX_PROTOCOL_HEADER_LENGTH_BYTES) {
-                        pDec->errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
-                    }
-                }
-            } else if (*pBufferUint8 == '$') {
-                // Likely an NMEA message
-                pBufferUint8++;
-                y = size - 1;
-                pDec->id.type = U_GNSS_PROTOCOL_NMEA;
-                pDec->errorCode = (int32_t) U_ERROR_COMMON_TRUNCATED;
-                for (x = 0; (((*pBufferUint8 >= 'A') && (*pBufferUint8 <= 'Z')) ||
-                             ((*pBufferUint8 >= '0') && (*pBufferUint8 <= '9'))) &&
-                     (x < y) && (x < sizeof(pDec->nmea) - 1); x++) {
-                    // Looking for up to U_GNSS_NMEA_MESSAGE_MATCH_LENGTH_CHARACTERS
-                    // characters in the range 0-9, A-Z, followed by a comma
-                    pDec->nmea[x] = *pBufferUint8;
-                    pBufferUint8++;
-                }
-                if ((x < y) && (*pBufferUint8 == ',')) {
-                    pDec->id.id.pNmea = pDec->nmea;
+                y = *pBufferUint8 + ((uint16_t) *(pBufferUint8 + 1) << 8); // *NOPAD*
+                if (size >= y + U_UBX_PROTOCOL_HEADER_LENGTH_BYTES) {
+                    *ppBody = pBuffer + U_UBX_PROTOCOL_HEADER_LENGTH_BYTES;
+                    *pBodySize = y;
                     pDec->errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
                 }
-                // No need to add a terminator since we zeroed the structure to begin with
-            } else if (*pBufferUint8 == 0xD3) {
-                // Likely an RTCM message
+            }
+        } else if (*pBufferUint8 == '$') {
+            // Likely an NMEA message
+            pBufferUint8++;
+            y = size - 1;
+            pDec->id.type = U_GNSS_PROTOCOL_NMEA;
+            pDec->errorCode = (int32_t) U_ERROR_COMMON_TRUNCATED;
+            for (x = 0; (x < y) && (((*pBufferUint8 >= 'A') && (*pBufferUint8 <= 'Z')) ||
+                                    ((*pBufferUint8 >= '0') && (*pBufferUint8 <= '9'))) &&
+                 (x < sizeof(pDec->nmea) - 1); x++) {
+                // Looking for up to U_GNSS_NMEA_MESSAGE_MATCH_LENGTH_CHARACTERS
+                // characters in the range 0-9, A-Z, followed by a comma
+                pDec->nmea[x] = *pBufferUint8;
                 pBufferUint8++;
-                pDec->id.type = U_GNSS_PROTOCOL_RTCM;
-                pDec->errorCode = (int32_t) U_ERROR_COMMON_TRUNCATED;
-                // Length is only in the first three bits of the first length byte,
-                // the rest must be zero
-                if ((size >= 1 /* D3 */ + 2 /* length */) &&
-                    ((*pBufferUint8 & 0xFC) == 0)) {
-                    y = ((uint16_t) (*pBufferUint8 & 0x03) << 8) + *(pBufferUint8 + 1);
-                    pBufferUint8 += 2;
-                    if (size >= 1 /* D3 */ + 2 /* length */ + 2 /* ID */) {
-                        // Grab the ID from the next two bytes
-                        pDec->id.id.rtcm = (*(pBufferUint8 + 1) >> 4) + (((uint16_t) *pBufferUint8) << 4); // *NOPAD*
-                        if (size >= 1 /* D3 */ + 2 /* length */ + y /* length includes the message ID */ ) {
-                            // Check the length, allowing the CRC bytes to be omitted
-                            pDec->errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
-                        }
-                    }
+            }
+            if ((x < y) && (*pBufferUint8 == ',')) {
+                pDec->id.id.pNmea = pDec->nmea;
+                // The body is everything after the comma, up to
+                // any check-sum
+                pBufferUint8++;
+                *ppBody = (const char *) pBufferUint8;
+                for (y -= x + 1; (y > 0) && (*pBufferUint8 != '*'); y--) {
+                    pBufferUint8++;
                 }
+                *pBodySize = (const char *) pBufferUint8 - *ppBody;
+                pDec->errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
             }
-            if (pDec->errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
-                // Got a known protocol, an ID and a valid length, see if we have
-                // a decoder for this message ID
-                pDec->errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
-                for (x = 0; (pFunction == NULL) && (x < sizeof(gIdList) / sizeof(gIdList[0])); x++) {
-                    if (uGnssMsgIdIsWanted(&(pDec->id), (uGnssMessageId_t *) & (gIdList[x]))) {
-                        pFunction = gpFunctionList[x];
+            // No need to add a terminator since we zeroed the structure to begin with
+        } else if (*pBufferUint8 == 0xD3) {
+            // Likely an RTCM message
+            pBufferUint8++;
+            pDec->id.type = U_GNSS_PROTOCOL_RTCM;
+            pDec->errorCode = (int32_t) U_ERROR_COMMON_TRUNCATED;
+            // Length is only in the first three bits of the first length byte,
+            // the rest must be zero
+            if ((size >= 1 /* D3 */ + 2 /* length */) &&
+                ((*pBufferUint8 & 0xFC) == 0)) {
+                y = ((uint16_t) (*pBufferUint8 & 0x03) << 8) + *(pBufferUint8 + 1);
+                pBufferUint8 += 2;
+                if (size >= 1 /* D3 */ + 2 /* length */ + 2 /* ID */) {
+                    // Grab the ID from the next two bytes
+                    pDec->id.id.rtcm = (*(pBufferUint8 + 1) >> 4) + (((uint16_t) *pBufferUint8) << 4); // *NOPAD*
+                    if (size >= 1 /* D3 */ + 2 /* length */ + y /* length includes the message ID */ ) {
+                        // Check the length, allowing the CRC bytes to be omitted
+                        pDec->errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
                     }
                 }
-                if (pFunction != NULL) {
-                    // Found a matching decoder, run it
-                    pDec->errorCode = pFunction(pBuffer, size, &(pDec->pBody));
+            }
+        }
+        if (pDec->errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
+            // Got a known protocol, an ID and a valid length, see if we have
+            // a decoder for this message ID
+            pDec->errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            for (x = 0; (pKnown == NULL) && (x < sizeof(gIdList) / sizeof(gIdList[0])); x++) {
+                if (idMatch(&(pDec->id), &(gIdList[x]))) {
+                    pKnown = &(gDecoderList[x]);
                 }
             }
-            if ((pDec->errorCode != (int32_t) U_ERROR_COMMON_SUCCESS) &&
-                (gpCallback != NULL)) {
-                // Couldn't decode the message: let the user callback try
-                pDec->errorCode = gpCallback(&(pDec->id), pBuffer, size, &(pDec->pBody), gpCallbackParam);
+            if ((pKnown != NULL) && (*pBodySize < pKnown->bodyMinLength)) {
+                pDec->errorCode = (int32_t) U_ERROR_COMMON_TRUNCATED;
+                pKnown = NULL;
+            }
+        }
+    }
+
+    return pKnown;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Decode a message buffer received from a GNSS device.
+uGnssDec_t *pUGnssDecAlloc(const char *pBuffer, size_t size)
+{
+    uGnssDec_t *pDec = NULL;
+    const uGnssDecKnown_t *pKnown;
+    const char *pBody = NULL;
+    size_t bodySize = 0;
+
+    pDec = (uGnssDec_t *) pUPortMalloc(sizeof(uGnssDec_t));
+    if (pDec != NULL) {
+        pKnown = pDecodeId(pBuffer, size, pDec, &pBody, &bodySize);
+        if (pKnown != NULL) {
+            // Found a matching decoder, allocate memory and run it
+            pDec->errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            pDec->pBody = (uGnssDecUnion_t *) pUPortMalloc(pKnown->bodySize);
+            if (pDec->pBody != NULL) {
+                memset(pDec->pBody, 0, pKnown->bodySize);
+                pDec->errorCode = pKnown->pFunction(pBody, bodySize, pDec->pBody);
+                if ((pDec->errorCode != (int32_t) U_ERROR_COMMON_SUCCESS) &&
+                    (pDec->errorCode != (int32_t) U_ERROR_COMMON_BAD_DATA)) {
+                    uPortFree(pDec->pBody);
+                    pDec->pBody = NULL;
+                }
             }
         }
+        if ((pDec->errorCode != (int32_t) U_ERROR_COMMON_SUCCESS) &&
+            (pDec->errorCode != (int32_t) U_ERROR_COMMON_EMPTY) &&
+            (gpCallback != NULL)) {
+            // Couldn't decode the message: let the user callback try
+            uPortFree(pDec->pBody);
+            pDec->pBody = NULL;
+            pDec->errorCode = gpCallback(&(pDec->id), pBuffer, size, &(pDec->pBody), gpCallbackParam);
+        }
     }
 
     return pDec;
 }
 
+// Decode a message buffer into caller-supplied storage.
+int32_t uGnssDecDecode(const char *pBuffer, size_t size,
+                       uGnssDec_t *pDec, uGnssDecUnion_t *pBody)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    const uGnssDecKnown_t *pKnown;
+    const char *pMessageBody = NULL;
+    size_t bodySize = 0;
+
+    if ((pDec != NULL) && (pBody != NULL)) {
+        pKnown = pDecodeId(pBuffer, size, pDec, &pMessageBody, &bodySize);
+        if (pKnown != NULL) {
+            memset(pBody, 0, pKnown->bodySize);
+            pDec->errorCode = pKnown->pFunction(pMessageBody, bodySize, pBody);
+            if ((pDec->errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) ||
+                (pDec->errorCode == (int32_t) U_ERROR_COMMON_BAD_DATA)) {
+                pDec->pBody = pBody;
+            }
+        }
+        errorCode = pDec->errorCode;
+    }
+
+    return errorCode;
+}
+
 // Free the memory returned by pUGnssDecAlloc().
 void uGnssDecFree(uGnssDec_t *pDec)
 {
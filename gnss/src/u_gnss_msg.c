@@ -54,6 +54,18 @@
  * much data as it wishes from the GNSS chip without being limited by the size
  * of the ring-buffer chosen at compile-time for ubxlib, provided of course
  * another reader hasn't left its read pointer locked.
+ *
+ * The non-blocking message readers are kept in a linked list but the
+ * task that calls them doesn't walk that list: it dispatches each message
+ * using an index of the list, built whenever a reader is added or removed,
+ * in which the readers are sorted into buckets by the message ID they
+ * want (a hash of the UBX class/ID, the other protocols and the
+ * wild-cards), so that only the readers in the buckets a message might
+ * match need be checked.  The index is double-buffered: a reader
+ * being added or removed causes the index to be rebuilt in the buffer
+ * the task is not using, which is then published with a pointer swap;
+ * the adder/remover waits for the task to let go of the old buffer
+ * but the task never waits for the adder/remover.
  */
 
 #ifdef U_CFG_OVERRIDE
@@ -67,6 +79,7 @@
 
 #include "u_cfg_os_platform_specific.h" // U_CFG_OS_YIELD_MS
 #include "u_cfg_sw.h"
+#include "u_compiler.h" // U_ATOMIC_GET/U_ATOMIC_SET
 #include "u_error_common.h"
 
 #include "u_port.h"
@@ -110,9 +123,11 @@
 
 #ifndef U_GNSS_MSG_TASK_STACK_YIELD_TIME_MS
 /** How long the asynchronous message receive task guarantees to give
- * to the rest of the system; if this is made larger the asynchronous
- * receive task won't be able to service the input stream so often
- * and hence the UART/I2C transport may overflow.
+ * to the rest of the system when it is polling, i.e. for I2C/SPI
+ * transports or where a UART data event could not be set up; if this
+ * is made larger the asynchronous receive task won't be able to
+ * service the input stream so often and hence the transport may
+ * overflow.
  */
 # define U_GNSS_MSG_TASK_STACK_YIELD_TIME_MS 50
 #endif
@@ -124,10 +139,76 @@
 # error U_GNSS_MSG_TASK_STACK_YIELD_TIME_MS must be at least as big as U_CFG_OS_YIELD_MS
 #endif
 
+#ifndef U_GNSS_MSG_READER_UBX_HASH_SIZE
+/** The number of buckets into which non-blocking readers of a specific
+ * UBX-format message (i.e. no wild-cards) are hashed by message class/ID
+ * in the index used by the asynchronous message receive task.
+ */
+# define U_GNSS_MSG_READER_UBX_HASH_SIZE 8
+#endif
+
+/** The bucket, in the reader index, of readers that want UBX-format
+ * messages with a wild-card in the class or ID.
+ */
+#define U_GNSS_MSG_READER_BUCKET_UBX_WILDCARD U_GNSS_MSG_READER_UBX_HASH_SIZE
+
+/** The bucket, in the reader index, of readers that want NMEA messages.
+ */
+#define U_GNSS_MSG_READER_BUCKET_NMEA (U_GNSS_MSG_READER_BUCKET_UBX_WILDCARD + 1)
+
+/** The bucket, in the reader index, of readers that want RTCM messages.
+ */
+#define U_GNSS_MSG_READER_BUCKET_RTCM (U_GNSS_MSG_READER_BUCKET_NMEA + 1)
+
+/** The bucket, in the reader index, of readers that want messages of
+ * unknown protocol.
+ */
+#define U_GNSS_MSG_READER_BUCKET_UNKNOWN (U_GNSS_MSG_READER_BUCKET_RTCM + 1)
+
+/** The bucket, in the reader index, of readers that want messages
+ * of any protocol.
+ */
+#define U_GNSS_MSG_READER_BUCKET_ANY (U_GNSS_MSG_READER_BUCKET_UNKNOWN + 1)
+
+/** The number of buckets in the reader index.
+ */
+#define U_GNSS_MSG_READER_NUM_BUCKETS (U_GNSS_MSG_READER_BUCKET_ANY + 1)
+
+/** The maximum number of buckets a single message may match in
+ * the reader index: its own, the UBX wild-card bucket (only for UBX)
+ * and the any-protocol bucket.
+ */
+#define U_GNSS_MSG_READER_MAX_NUM_BUCKETS_PER_MESSAGE 3
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** An index of the non-blocking readers, see the architectural note
+ * at the top of this file; stored in pReaderIndex[] of
+ * uGnssPrivateMsgReceive_t.
+ */
+typedef struct {
+    size_t capacity; /**< the number of entries at ppReader. */
+    size_t bucketStart[U_GNSS_MSG_READER_NUM_BUCKETS + 1]; /**< the readers
+                                                                in bucket n are
+                                                                ppReader[bucketStart[n]]
+                                                                to
+                                                                ppReader[bucketStart[n + 1] - 1]. */
+    uGnssPrivateMsgReader_t **ppReader; /**< points to the memory immediately
+                                             after this structure; within a
+                                             bucket the readers are in the
+                                             same order as pReaderList,
+                                             i.e. most-recently-added first. */
+} uGnssMsgReaderIndex_t;
+
+/** A run of readers from the reader index that a message may match.
+ */
+typedef struct {
+    uGnssPrivateMsgReader_t **ppReader;
+    uGnssPrivateMsgReader_t **ppEnd;
+} uGnssMsgReaderRun_t;
+
 /* ----------------------------------------------------------------
  * STATIC VARIABLES
  * -------------------------------------------------------------- */
@@ -136,16 +217,291 @@
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Callback for the UART data-received event: wakes up msgReceiveTask().
+static void dataEventCallback(int32_t uartHandle, uint32_t eventBitmask,
+                              void *pParameters)
+{
+    uGnssPrivateMsgReceive_t *pMsgReceive = (uGnssPrivateMsgReceive_t *) pParameters;
+
+    (void) uartHandle;
+    (void) eventBitmask;
+
+    pMsgReceive->dataEventTimeMs = uPortGetTickTimeMs();
+    uPortSemaphoreGive(pMsgReceive->dataEventSemaphoreHandle);
+}
+
+// If the transport is a UART, set up the data-received event that
+// wakes up msgReceiveTask(); if that is not possible the task will poll.
+static void dataEventStart(uGnssPrivateInstance_t *pInstance)
+{
+    uGnssPrivateMsgReceive_t *pMsgReceive = pInstance->pMsgReceive;
+
+    if ((uGnssPrivateGetStreamType(pInstance->transportType) == U_GNSS_PRIVATE_STREAM_TYPE_UART) &&
+        (uPortSemaphoreCreate(&(pMsgReceive->dataEventSemaphoreHandle), 0, 1) == 0)) {
+        pMsgReceive->dataEventUartHandle = pInstance->transportHandle.uart;
+        if (uPortUartEventCallbackSet(pMsgReceive->dataEventUartHandle,
+                                      U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED,
+                                      dataEventCallback, pMsgReceive,
+                                      U_GNSS_MSG_RECEIVE_TASK_EVENT_STACK_SIZE_BYTES,
+                                      U_GNSS_MSG_RECEIVE_TASK_PRIORITY) != 0) {
+            uPortSemaphoreDelete(pMsgReceive->dataEventSemaphoreHandle);
+            pMsgReceive->dataEventSemaphoreHandle = NULL;
+        }
+    }
+}
+
+// Return the hash bucket for a specific UBX message class/ID.
+static size_t readerBucketUbx(uint16_t ubx)
+{
+    return (((size_t) (ubx >> 8) * 31) + (ubx & 0xFF)) % U_GNSS_MSG_READER_UBX_HASH_SIZE;
+}
+
+// Return the bucket of the reader index that a reader wanting the
+// given message ID belongs in.
+static size_t readerBucket(const uGnssPrivateMessageId_t *pMessageIdWanted)
+{
+    size_t bucket = U_GNSS_MSG_READER_BUCKET_ANY;
+
+    switch (pMessageIdWanted->type) {
+        case U_GNSS_PROTOCOL_UBX:
+            bucket = U_GNSS_MSG_READER_BUCKET_UBX_WILDCARD;
+            if (((pMessageIdWanted->id.ubx >> 8) != U_GNSS_UBX_MESSAGE_CLASS_ALL) &&
+                ((pMessageIdWanted->id.ubx & 0xFF) != U_GNSS_UBX_MESSAGE_ID_ALL)) {
+                bucket = readerBucketUbx(pMessageIdWanted->id.ubx);
+            }
+            break;
+        case U_GNSS_PROTOCOL_NMEA:
+            bucket = U_GNSS_MSG_READER_BUCKET_NMEA;
+            break;
+        case U_GNSS_PROTOCOL_RTCM:
+            bucket = U_GNSS_MSG_READER_BUCKET_RTCM;
+            break;
+        case U_GNSS_PROTOCOL_UNKNOWN:
+            bucket = U_GNSS_MSG_READER_BUCKET_UNKNOWN;
+            break;
+        default:
+            // U_GNSS_PROTOCOL_ANY/U_GNSS_PROTOCOL_ALL and, for
+            // anything else, uGnssPrivateMessageIdIsWanted() will
+            // sort it out
+            break;
+    }
+
+    return bucket;
+}
+
+// Return the number of readers in a list.
+static size_t readerListCount(const uGnssPrivateMsgReader_t *pReader)
+{
+    size_t numReaders = 0;
+
+    for (; pReader != NULL; pReader = pReader->pNext) {
+        numReaders++;
+    }
+
+    return numReaders;
+}
+
+// Make sure that the reader index in the buffer which the task is NOT
+// using can hold numReaders, returning a pointer to it.
+static uGnssMsgReaderIndex_t *pReaderIndexSpare(uGnssPrivateMsgReceive_t *pMsgReceive,
+                                                size_t numReaders)
+{
+    size_t spare = 0;
+    uGnssMsgReaderIndex_t *pIndex;
+
+    if (pMsgReceive->pReaderIndexPublished == pMsgReceive->pReaderIndex[0]) {
+        spare = 1;
+    }
+    pIndex = (uGnssMsgReaderIndex_t *) pMsgReceive->pReaderIndex[spare];
+    if ((pIndex == NULL) || (pIndex->capacity < numReaders)) {
+        // Not big enough: since this buffer is not published we can
+        // simply replace it
+        uPortFree(pIndex);
+        pIndex = (uGnssMsgReaderIndex_t *) pUPortMalloc(sizeof(uGnssMsgReaderIndex_t) +
+                                                        (numReaders *
+                                                         sizeof(uGnssPrivateMsgReader_t *)));
+        if (pIndex != NULL) {
+            pIndex->capacity = numReaders;
+            pIndex->ppReader = (uGnssPrivateMsgReader_t **) (pIndex + 1);
+        }
+        pMsgReceive->pReaderIndex[spare] = pIndex;
+    }
+
+    return pIndex;
+}
+
+// Index pReaderList in pIndex, which must be the spare buffer returned
+// by pReaderIndexSpare() with enough capacity, then publish it to the
+// task and wait for the task to stop using the previous one.
+// The reader mutex must be locked before this is called.
+static void readerIndexPublish(uGnssPrivateMsgReceive_t *pMsgReceive,
+                               uGnssMsgReaderIndex_t *pIndex)
+{
+    uGnssPrivateMsgReader_t *pReader;
+    size_t bucketEnd[U_GNSS_MSG_READER_NUM_BUCKETS];
+    size_t bucket;
+    void *pOld;
+
+    // Count the readers in each bucket
+    memset(pIndex->bucketStart, 0, sizeof(pIndex->bucketStart));
+    for (pReader = pMsgReceive->pReaderList; pReader != NULL; pReader = pReader->pNext) {
+        pIndex->bucketStart[readerBucket(&(pReader->privateMessageId)) + 1]++;
+    }
+    // Turn the counts into start positions
+    for (bucket = 0; bucket < U_GNSS_MSG_READER_NUM_BUCKETS; bucket++) {
+        pIndex->bucketStart[bucket + 1] += pIndex->bucketStart[bucket];
+        bucketEnd[bucket] = pIndex->bucketStart[bucket];
+    }
+    // Fill the buckets, maintaining the order of the list
+    for (pReader = pMsgReceive->pReaderList; pReader != NULL; pReader = pReader->pNext) {
+        bucket = readerBucket(&(pReader->privateMessageId));
+        pIndex->ppReader[bucketEnd[bucket]] = pReader;
+        bucketEnd[bucket]++;
+    }
+
+    // Publish the new index and wait for the task to let go
+    // of the old one: this is what allows the task to dispatch
+    // messages without locking anything.  Note that the store of
+    // pReaderIndexPublished followed by the load of pReaderIndexInUse
+    // here, and the reverse in pReaderIndexAcquire(), MUST be
+    // sequentially consistent, otherwise each side could miss the
+    // other's store, hence U_ATOMIC_SET/U_ATOMIC_GET
+    pOld = pMsgReceive->pReaderIndexPublished;
+    U_ATOMIC_SET(&(pMsgReceive->pReaderIndexPublished), (void *) pIndex);
+    if (pOld != NULL) {
+        while (U_ATOMIC_GET(&(pMsgReceive->pReaderIndexInUse)) == pOld) {
+            uPortTaskBlock(U_CFG_OS_YIELD_MS);
+        }
+    }
+}
+
+// Called by the task to obtain the published reader index; the
+// index will remain valid until readerIndexRelease() is called.
+static uGnssMsgReaderIndex_t *pReaderIndexAcquire(uGnssPrivateMsgReceive_t *pMsgReceive)
+{
+    void *pIndex;
+
+    // Mark the index as in use before using it and then check that
+    // it was not replaced in the meantime, since readerIndexPublish()
+    // may have looked at pReaderIndexInUse in between
+    do {
+        pIndex = U_ATOMIC_GET(&(pMsgReceive->pReaderIndexPublished));
+        U_ATOMIC_SET(&(pMsgReceive->pReaderIndexInUse), pIndex);
+    } while (pIndex != U_ATOMIC_GET(&(pMsgReceive->pReaderIndexPublished)));
+
+    return (uGnssMsgReaderIndex_t *) pIndex;
+}
+
+// Called by the task when it has finished with the reader index.
+static void readerIndexRelease(uGnssPrivateMsgReceive_t *pMsgReceive)
+{
+    U_ATOMIC_SET(&(pMsgReceive->pReaderIndexInUse), NULL);
+}
+
+// Populate pRun with the runs of readers in pIndex that the given
+// message ID may match, returning the number of runs.
+static size_t readerIndexRuns(const uGnssMsgReaderIndex_t *pIndex,
+                              const uGnssPrivateMessageId_t *pMessageId,
+                              uGnssMsgReaderRun_t *pRun)
+{
+    size_t bucket[U_GNSS_MSG_READER_MAX_NUM_BUCKETS_PER_MESSAGE];
+    size_t numBuckets = 0;
+    size_t numRuns = 0;
+
+    switch (pMessageId->type) {
+        case U_GNSS_PROTOCOL_UBX:
+            bucket[numBuckets] = readerBucketUbx(pMessageId->id.ubx);
+            numBuckets++;
+            bucket[numBuckets] = U_GNSS_MSG_READER_BUCKET_UBX_WILDCARD;
+            numBuckets++;
+            break;
+        case U_GNSS_PROTOCOL_NMEA:
+            bucket[numBuckets] = U_GNSS_MSG_READER_BUCKET_NMEA;
+            numBuckets++;
+            break;
+        case U_GNSS_PROTOCOL_RTCM:
+            bucket[numBuckets] = U_GNSS_MSG_READER_BUCKET_RTCM;
+            numBuckets++;
+            break;
+        case U_GNSS_PROTOCOL_UNKNOWN:
+            bucket[numBuckets] = U_GNSS_MSG_READER_BUCKET_UNKNOWN;
+            numBuckets++;
+            break;
+        default:
+            break;
+    }
+    bucket[numBuckets] = U_GNSS_MSG_READER_BUCKET_ANY;
+    numBuckets++;
+
+    for (size_t x = 0; x < numBuckets; x++) {
+        if (pIndex->bucketStart[bucket[x] + 1] > pIndex->bucketStart[bucket[x]]) {
+            pRun[numRuns].ppReader = pIndex->ppReader + pIndex->bucketStart[bucket[x]];
+            pRun[numRuns].ppEnd = pIndex->ppReader + pIndex->bucketStart[bucket[x] + 1];
+            numRuns++;
+        }
+    }
+
+    return numRuns;
+}
+
+// Call the callbacks of the readers that want the given message, in
+// the order the readers would appear in pReaderList.
+static void readerDispatch(uGnssPrivateInstance_t *pInstance,
+                           uGnssPrivateMessageId_t *pPrivateMessageId,
+                           uGnssMessageId_t *pMessageId,
+                           int32_t errorCodeOrLength)
+{
+    uGnssPrivateMsgReceive_t *pMsgReceive = pInstance->pMsgReceive;
+    uGnssMsgReaderIndex_t *pIndex;
+    uGnssMsgReaderRun_t run[U_GNSS_MSG_READER_MAX_NUM_BUCKETS_PER_MESSAGE];
+    uGnssMsgReaderRun_t *pNextRun;
+    uGnssPrivateMsgReader_t *pReader;
+    size_t numRuns;
+
+    pIndex = pReaderIndexAcquire(pMsgReceive);
+    if (pIndex != NULL) {
+        numRuns = readerIndexRuns(pIndex, pPrivateMessageId, run);
+        do {
+            // Handles are allocated in ascending order and the list
+            // is most-recently-added first so, to call the readers in
+            // list order, merge the runs by descending handle
+            pNextRun = NULL;
+            for (size_t x = 0; x < numRuns; x++) {
+                if ((run[x].ppReader < run[x].ppEnd) &&
+                    ((pNextRun == NULL) ||
+                     ((*run[x].ppReader)->handle > (*pNextRun->ppReader)->handle))) {
+                    pNextRun = &(run[x]);
+                }
+            }
+            if (pNextRun != NULL) {
+                pReader = *pNextRun->ppReader;
+                pNextRun->ppReader++;
+                if (uGnssPrivateMessageIdIsWanted(pPrivateMessageId,
+                                                  &(pReader->privateMessageId))) {
+                    // This reader is interested, call the callback
+                    ((uGnssMsgReceiveCallback_t) pReader->pCallback)(pInstance->gnssHandle,
+                                                                     pMessageId,
+                                                                     errorCodeOrLength,
+                                                                     pReader->pCallbackParam);
+                }
+            }
+        } while (pNextRun != NULL);
+    }
+    readerIndexRelease(pMsgReceive);
+}
+
 // Task that runs the non-blocking message receive.
 static void msgReceiveTask(void *pParam)
 {
     uGnssPrivateInstance_t *pInstance = (uGnssPrivateInstance_t *) pParam;
     char queueItem[U_GNSS_MSG_RECEIVE_TASK_QUEUE_ITEM_SIZE_BYTES];
     uGnssPrivateMsgReceive_t *pMsgReceive = pInstance->pMsgReceive;
-    uGnssPrivateMsgReader_t *pReader;
     int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_UNKNOWN;
     int32_t receiveSize;
     int32_t yieldTimeMs;
+    int32_t awakeTimeMs;
+    int32_t dataTimeMs;
+    int32_t latencyMs;
     size_t discardSize = 0;
     uGnssMessageId_t messageId;
     uGnssPrivateMessageId_t privateMessageId;
@@ -157,6 +513,10 @@ static void msgReceiveTask(void *pParam)
     uRingBufferLockReadHandle(&(pInstance->ringBuffer),
                               pMsgReceive->ringBufferReadHandle);
 
+    pMsgReceive->startTimeMs = uPortGetTickTimeMs();
+    awakeTimeMs = pMsgReceive->startTimeMs;
+    dataTimeMs = awakeTimeMs;
+
     // Continue until we receive something on the queue, which
     // will cause us to exit
     while (uPortQueueTryReceive(pMsgReceive->taskExitQueueHandle, 0, queueItem) < 0) {
@@ -164,8 +524,12 @@ static void msgReceiveTask(void *pParam)
         // Note that this does NOT lock gUGnssPrivateMutex: it doesn't need to,
         // provided this task is brought up and torn down in an organised way
 
+        pMsgReceive->statWakeUpCount++;
         // Pull stuff into the ring buffer
         receiveSize = uGnssPrivateStreamFillRingBuffer(pInstance, 0, 0);
+        if (receiveSize <= 0) {
+            pMsgReceive->statWakeUpIdleCount++;
+        }
         // Deal with any discard from a previous run around this loop
         discardSize -= uRingBufferReadHandle(&(pInstance->ringBuffer),
                                              pMsgReceive->ringBufferReadHandle,
@@ -191,25 +555,17 @@ static void msgReceiveTask(void *pParam)
 
                     if (uGnssPrivateMessageIdToPublic(&privateMessageId, &messageId, nmeaId) == 0) {
                         // Got something, with a message ID now in public form;
-                        // go through the list of readers looking for those interested
-
-                        U_PORT_MUTEX_LOCK(pMsgReceive->readerMutexHandle);
-
-                        pReader = pMsgReceive->pReaderList;
-                        while (pReader != NULL) {
-                            if (uGnssPrivateMessageIdIsWanted(&privateMessageId,
-                                                              &(pReader->privateMessageId))) {
-                                // This reader is interested, call the callback
-                                ((uGnssMsgReceiveCallback_t) pReader->pCallback)(pInstance->gnssHandle,
-                                                                                 &messageId,
-                                                                                 errorCodeOrLength,
-                                                                                 pReader->pCallbackParam);
-                            }
-                            // Next!
-                            pReader = pReader->pNext;
+                        // note how long it took to get here and then call
+                        // the readers that are interested
+                        latencyMs = uPortGetTickTimeMs() - dataTimeMs;
+                        pMsgReceive->statMessageCount++;
+                        pMsgReceive->statLatencyLastMs = latencyMs;
+                        pMsgReceive->statLatencyTotalMs += latencyMs;
+                        if (latencyMs > pMsgReceive->statLatencyMaxMs) {
+                            pMsgReceive->statLatencyMaxMs = latencyMs;
                         }
-
-                        U_PORT_MUTEX_UNLOCK(pMsgReceive->readerMutexHandle);
+                        readerDispatch(pInstance, &privateMessageId,
+                                       &messageId, errorCodeOrLength);
                     }
 
                     // Clear out any remaining data
@@ -220,14 +576,34 @@ static void msgReceiveTask(void *pParam)
             }
         }
 
-        // Relax to let others in; relax for twice as long if we last
-        // received nothing and aren't desperately seeking more data,
-        // in order to allow some data to build up
-        yieldTimeMs = U_GNSS_MSG_TASK_STACK_YIELD_TIME_MS;
-        if ((receiveSize == 0) && (errorCodeOrLength != (int32_t) U_ERROR_COMMON_TIMEOUT))  {
-            yieldTimeMs *= 2;
+        pMsgReceive->statBusyTimeMs += uPortGetTickTimeMs() - awakeTimeMs;
+
+        if (pMsgReceive->dataEventSemaphoreHandle != NULL) {
+            // Event-driven: if we got something there may be more
+            // where that came from so go around again straight away,
+            // clearing any event for the data we're about to read,
+            // else wait for the UART to tell us that data has arrived
+            if (receiveSize > 0) {
+                uPortSemaphoreTryTake(pMsgReceive->dataEventSemaphoreHandle, 0);
+                dataTimeMs = uPortGetTickTimeMs();
+            } else if (uPortSemaphoreTryTake(pMsgReceive->dataEventSemaphoreHandle,
+                                             U_GNSS_MSG_RECEIVE_TASK_EVENT_TIMEOUT_MS) == 0) {
+                dataTimeMs = pMsgReceive->dataEventTimeMs;
+            } else {
+                dataTimeMs = uPortGetTickTimeMs();
+            }
+        } else {
+            // Polling: relax to let others in; relax for twice as long
+            // if we last received nothing and aren't desperately seeking
+            // more data, in order to allow some data to build up
+            yieldTimeMs = U_GNSS_MSG_TASK_STACK_YIELD_TIME_MS;
+            if ((receiveSize == 0) && (errorCodeOrLength != (int32_t) U_ERROR_COMMON_TIMEOUT))  {
+                yieldTimeMs *= 2;
+            }
+            uPortTaskBlock(yieldTimeMs);
+            dataTimeMs = uPortGetTickTimeMs();
         }
-        uPortTaskBlock(yieldTimeMs);
+        awakeTimeMs = uPortGetTickTimeMs();
     }
 
     // Now we can unlock our ring buffer read handle.  Phew.
@@ -291,6 +667,7 @@ int32_t uGnssMsgPrivateReceiveStart(uGnssPrivateInstance_t *pInstance,
     int32_t errorCodeOrHandle = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
     uGnssPrivateMsgReceive_t *pMsgReceive;
     uGnssPrivateMsgReader_t *pReader;
+    uGnssMsgReaderIndex_t *pIndex;
     const char *pTaskName = "gnssMsgRx";
 
     if ((pInstance != NULL) && (pPrivateMessageId != NULL) && (pCallback != NULL)) {
@@ -314,7 +691,7 @@ int32_t uGnssMsgPrivateReceiveStart(uGnssPrivateInstance_t *pInstance,
                         // asynchronous task
                         pMsgReceive->pTemporaryBuffer = (char *) pUPortMalloc(U_GNSS_MSG_TEMPORARY_BUFFER_LENGTH_BYTES);
                         if (pMsgReceive->pTemporaryBuffer != NULL) {
-                            // Create the mutex that controls access to the linked-list of readers
+                            // Create the mutex that serialises changes to the linked-list of readers
                             errorCodeOrHandle = uPortMutexCreate(&(pMsgReceive->readerMutexHandle));
                             if (errorCodeOrHandle == 0) {
                                 // Create the queue that allows us to get the task to exit
@@ -325,6 +702,9 @@ int32_t uGnssMsgPrivateReceiveStart(uGnssPrivateInstance_t *pInstance,
                                     // Create the mutex for task running status
                                     errorCodeOrHandle = uPortMutexCreate(&(pMsgReceive->taskRunningMutexHandle));
                                     if (errorCodeOrHandle == 0) {
+                                        // Where possible have the task woken
+                                        // by data arriving rather than polling
+                                        dataEventStart(pInstance);
                                         //... and then the task
                                         errorCodeOrHandle = uPortTaskCreate(msgReceiveTask,
                                                                             pTaskName,
@@ -345,6 +725,10 @@ int32_t uGnssMsgPrivateReceiveStart(uGnssPrivateInstance_t *pInstance,
                         }
                         if (errorCodeOrHandle != 0) {
                             // Tidy up if we couldn't get OS resources
+                            if (pMsgReceive->dataEventSemaphoreHandle != NULL) {
+                                uPortUartEventCallbackRemove(pMsgReceive->dataEventUartHandle);
+                                uPortSemaphoreDelete(pMsgReceive->dataEventSemaphoreHandle);
+                            }
                             if (pMsgReceive->taskRunningMutexHandle != NULL) {
                                 uPortMutexDelete(pMsgReceive->taskRunningMutexHandle);
                             }
@@ -383,16 +767,34 @@ int32_t uGnssMsgPrivateReceiveStart(uGnssPrivateInstance_t *pInstance,
             pReader->privateMessageId = *pPrivateMessageId;
             pReader->pCallback = (void *) pCallback;
             pReader->pCallbackParam = pCallbackParam;
-            pReader->pNext = pInstance->pMsgReceive->pReaderList;
+            pMsgReceive = pInstance->pMsgReceive;
+            pReader->pNext = pMsgReceive->pReaderList;
 
-            U_PORT_MUTEX_LOCK(pInstance->pMsgReceive->readerMutexHandle);
+            U_PORT_MUTEX_LOCK(pMsgReceive->readerMutexHandle);
 
-            pInstance->pMsgReceive->pReaderList = pReader;
+            // Make sure there is room to index the new reader
+            // before adding it to the list and publishing
+            // the index to the task
+            errorCodeOrHandle = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            pIndex = pReaderIndexSpare(pMsgReceive,
+                                       readerListCount(pMsgReceive->pReaderList) + 1);
+            if (pIndex != NULL) {
+                pMsgReceive->pReaderList = pReader;
+                readerIndexPublish(pMsgReceive, pIndex);
+                // Return the handle
+                errorCodeOrHandle = pReader->handle;
+            }
 
-            U_PORT_MUTEX_UNLOCK(pInstance->pMsgReceive->readerMutexHandle);
+            U_PORT_MUTEX_UNLOCK(pMsgReceive->readerMutexHandle);
 
-            // Return the handle
-            errorCodeOrHandle = pReader->handle;
+            if (pIndex == NULL) {
+                uPortFree(pReader);
+                if (pMsgReceive->pReaderList == NULL) {
+                    // We just started the task for this reader,
+                    // shut it down again
+                    uGnssPrivateStopMsgReceive(pInstance);
+                }
+            }
         }
     }
 
@@ -407,6 +809,7 @@ int32_t uGnssMsgPrivateReceiveStop(uGnssPrivateInstance_t *pInstance,
     uGnssPrivateMsgReceive_t *pMsgReceive;
     uGnssPrivateMsgReader_t *pCurrent;
     uGnssPrivateMsgReader_t *pPrev = NULL;
+    uGnssMsgReaderIndex_t *pIndex;
 
     if (pInstance != NULL) {
         errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
@@ -415,22 +818,32 @@ int32_t uGnssMsgPrivateReceiveStop(uGnssPrivateInstance_t *pInstance,
 
             U_PORT_MUTEX_LOCK(pMsgReceive->readerMutexHandle);
 
-            // Remove the entry from the list
+            // Find the entry in the list
             errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
             pCurrent = pMsgReceive->pReaderList;
-            while (pCurrent != NULL) {
-                if (pCurrent->handle == asyncHandle) {
+            while ((pCurrent != NULL) && (pCurrent->handle != asyncHandle)) {
+                pPrev = pCurrent;
+                pCurrent = pPrev->pNext;
+            }
+            if (pCurrent != NULL) {
+                // The spare index was last published with at least
+                // as many readers as the list now has less one, so
+                // this should not need to allocate memory
+                errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                pIndex = pReaderIndexSpare(pMsgReceive,
+                                           readerListCount(pMsgReceive->pReaderList) - 1);
+                if (pIndex != NULL) {
+                    // Remove the entry from the list and publish
+                    // the index without it to the task: once that
+                    // is done the task can no longer be calling it
                     if (pPrev != NULL) {
                         pPrev->pNext = pCurrent->pNext;
                     } else {
                         pMsgReceive->pReaderList = pCurrent->pNext;
                     }
+                    readerIndexPublish(pMsgReceive, pIndex);
                     uPortFree(pCurrent);
-                    pCurrent = NULL;
                     errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
-                } else {
-                    pPrev = pCurrent;
-                    pCurrent = pPrev->pNext;
                 }
             }
 
@@ -794,4 +1207,44 @@ size_t uGnssMsgReceiveStatStreamLoss(uDeviceHandle_t gnssHandle)
     return bytesLost;
 }
 
+// Get the statistics of the message receive task.
+int32_t uGnssMsgReceiveStatTask(uDeviceHandle_t gnssHandle,
+                                uGnssMsgReceiveStatTask_t *pStat)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    uGnssPrivateMsgReceive_t *pMsgReceive;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if ((pInstance != NULL) && (pInstance->pMsgReceive != NULL) && (pStat != NULL)) {
+            pMsgReceive = pInstance->pMsgReceive;
+            // The task updates these without locking; each is
+            // written in one go, which is good enough for statistics
+            memset(pStat, 0, sizeof(*pStat));
+            pStat->eventDriven = (pMsgReceive->dataEventSemaphoreHandle != NULL);
+            pStat->wakeUpCount = pMsgReceive->statWakeUpCount;
+            pStat->wakeUpIdleCount = pMsgReceive->statWakeUpIdleCount;
+            pStat->messageCount = pMsgReceive->statMessageCount;
+            pStat->latencyLastMs = pMsgReceive->statLatencyLastMs;
+            pStat->latencyMaxMs = pMsgReceive->statLatencyMaxMs;
+            if (pStat->messageCount > 0) {
+                pStat->latencyAverageMs = (int32_t) (pMsgReceive->statLatencyTotalMs /
+                                                     (int64_t) pStat->messageCount);
+            }
+            pStat->busyTimeMs = pMsgReceive->statBusyTimeMs;
+            pStat->runTimeMs = uPortGetTickTimeMs() - pMsgReceive->startTimeMs;
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
 // End of file
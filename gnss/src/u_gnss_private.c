@@ -96,6 +96,13 @@
 # define U_GNSS_PRIVATE_SPI_READ_LENGTH_MIN_BYTES 1
 #endif
 
+/** The bytes at which a UBX, NMEA or RTCM message can start, used
+ * to skip quickly over anything else when parsing the stream: every
+ * one of the parsers passed to uRingBufferParseHandleSync() must
+ * reject a message that does not start with one of these.
+ */
+#define U_GNSS_PRIVATE_PARSE_SYNC_BYTES "\xB5$\xD3"
+
 // Do some cross-checking
 #if U_GNSS_PRIVATE_SPI_READ_LENGTH_MIN_BYTES > U_GNSS_DEFAULT_SPI_FILL_THRESHOLD
 # error U_GNSS_PRIVATE_SPI_READ_LENGTH_MIN_BYTES must be less than or equal to U_GNSS_DEFAULT_SPI_FILL_THRESHOLD
@@ -774,10 +781,22 @@ static int32_t parseUbx(uParseHandle_t parseHandle, void *pUserParam)
     if (l > uRingBufferBytesAvailableUnprotected(parseHandle)) {
         return U_ERROR_COMMON_TIMEOUT;
     }
-    while (l --) {
-        uRingBufferGetByteUnprotected(parseHandle, &by);
-        cka += by;
-        ckb += cka;
+    // Checksum the body a contiguous span at a time
+    uRingBufferSpan_t span[2];
+    size_t numSpans = uRingBufferGetSpansUnprotected(parseHandle, span);
+    uRingBufferSkipUnprotected(parseHandle, l);
+    for (size_t x = 0; (x < numSpans) && (l > 0); x++) {
+        const uint8_t *pData = (const uint8_t *) span[x].pData;
+        size_t y = span[x].length;
+        if (y > l) {
+            y = l;
+        }
+        l -= (uint16_t) y;
+        while (y--) {
+            cka += *pData;
+            ckb += cka;
+            pData++;
+        }
     }
     cka = cka & 0xFF;
     ckb = ckb & 0xFF;
@@ -834,14 +853,26 @@ static int32_t parseNmea(uParseHandle_t parseHandle, void *pUserParam)
         pMsgId->id.nmea[i++] = ch;
     }
     pMsgId->id.nmea[i] = '\0';
-    while (uRingBufferGetByteUnprotected(parseHandle, &ch)) {
-        if ((' ' > ch) || ('~' < ch)) {
-            return U_ERROR_COMMON_NOT_FOUND;    // not in printable range 32 - 126
-        }
-        if ('*' == ch) {
-            break;    // *
+    // Run through the body, up to the '*', a contiguous span at a time
+    uRingBufferSpan_t span[2];
+    size_t numSpans = uRingBufferGetSpansUnprotected(parseHandle, span);
+    bool foundStar = false;
+    for (size_t x = 0; (x < numSpans) && !foundStar; x++) {
+        const char *pData = span[x].pData;
+        size_t y = 0;
+        while ((y < span[x].length) && !foundStar) {
+            ch = pData[y];
+            if ((' ' > ch) || ('~' < ch)) {
+                return U_ERROR_COMMON_NOT_FOUND;    // not in printable range 32 - 126
+            }
+            if ('*' == ch) {
+                foundStar = true;
+            } else {
+                crc ^= ch;
+            }
+            y++;
         }
-        crc ^= ch;
+        uRingBufferSkipUnprotected(parseHandle, y);
     }
     if (!uRingBufferGetByteUnprotected(parseHandle, &ch)) {
         return U_ERROR_COMMON_TIMEOUT;
@@ -961,9 +992,21 @@ static int32_t parseRtcm(uParseHandle_t parseHandle, void *pUserParam)
     l--;
     crc = RTCM_CRC(crc, idHi);
     pMsgId->id.rtcm = (idHi >> 4) + (idLo << 4);
-    while (l--) {
-        uRingBufferGetByteUnprotected(parseHandle, &by);
-        crc = RTCM_CRC(crc, by);
+    // CRC the body a contiguous span at a time
+    uRingBufferSpan_t span[2];
+    size_t numSpans = uRingBufferGetSpansUnprotected(parseHandle, span);
+    uRingBufferSkipUnprotected(parseHandle, l);
+    for (size_t x = 0; (x < numSpans) && (l > 0); x++) {
+        const uint8_t *pData = (const uint8_t *) span[x].pData;
+        size_t y = span[x].length;
+        if (y > l) {
+            y = l;
+        }
+        l -= (uint16_t) y;
+        while (y--) {
+            crc = RTCM_CRC(crc, *pData);
+            pData++;
+        }
     }
     // Compare CRC
     for (int32_t x = 2; (x >= 0) && uRingBufferGetByteUnprotected(parseHandle, &by); x--) {
@@ -1761,21 +1804,31 @@ void uGnssPrivateStopMsgReceive(uGnssPrivateInstance_t *pInstance)
 
         // Sending the task anything will cause it to exit
         uPortQueueSend(pMsgReceive->taskExitQueueHandle, queueItem);
+        if (pMsgReceive->dataEventSemaphoreHandle != NULL) {
+            // Wake the task up so that it sees the queue
+            uPortSemaphoreGive(pMsgReceive->dataEventSemaphoreHandle);
+        }
         U_PORT_MUTEX_LOCK(pMsgReceive->taskRunningMutexHandle);
         U_PORT_MUTEX_UNLOCK(pMsgReceive->taskRunningMutexHandle);
         // Wait for the task to actually exit: the STM32F4 platform
         // needs this additional delay for some reason or it stalls here
         uPortTaskBlock(U_CFG_OS_YIELD_MS);
 
-        // Free all the readers; no need to lock the reader mutex since
-        // we've shut the task down
+        // Free all the readers, and their index; no need to lock the
+        // reader mutex since we've shut the task down
         while (pMsgReceive->pReaderList != NULL) {
             pNext = pMsgReceive->pReaderList->pNext;
             uPortFree(pMsgReceive->pReaderList);
             pMsgReceive->pReaderList = pNext;
         }
+        uPortFree(pMsgReceive->pReaderIndex[0]);
+        uPortFree(pMsgReceive->pReaderIndex[1]);
 
         // Free all the other OS resources
+        if (pMsgReceive->dataEventSemaphoreHandle != NULL) {
+            uPortUartEventCallbackRemove(pMsgReceive->dataEventUartHandle);
+            uPortSemaphoreDelete(pMsgReceive->dataEventSemaphoreHandle);
+        }
         uPortMutexDelete(pMsgReceive->taskRunningMutexHandle);
         uPortQueueDelete(pMsgReceive->taskExitQueueHandle);
         uPortMutexDelete(pMsgReceive->readerMutexHandle);
@@ -1798,6 +1851,36 @@ void uGnssPrivateStopMsgReceive(uGnssPrivateInstance_t *pInstance)
     }
 }
 
+// Stop the correction-forwarding task.
+void uGnssPrivateStopCorrection(uGnssPrivateInstance_t *pInstance)
+{
+    uGnssPrivateCorrection_t *pCorrection;
+
+    if ((pInstance != NULL) && (pInstance->pCorrection != NULL)) {
+        pCorrection = pInstance->pCorrection;
+
+        // Tell the task to exit and wake it up so that it notices
+        pCorrection->keepGoing = false;
+        uPortSemaphoreGive(pCorrection->notifySemaphoreHandle);
+        U_PORT_MUTEX_LOCK(pCorrection->taskRunningMutexHandle);
+        U_PORT_MUTEX_UNLOCK(pCorrection->taskRunningMutexHandle);
+        // Wait for the task to actually exit
+        uPortTaskBlock(U_CFG_OS_YIELD_MS);
+
+        uPortMutexDelete(pCorrection->taskRunningMutexHandle);
+        uPortSemaphoreDelete(pCorrection->notifySemaphoreHandle);
+
+        // Pause here to allow the deletions
+        // to actually occur in the idle thread,
+        // required by some RTOSs (e.g. FreeRTOS)
+        uPortTaskBlock(U_CFG_OS_YIELD_MS);
+
+        uPortFree(pCorrection->pBuffer);
+        uPortFree(pInstance->pCorrection);
+        pInstance->pCorrection = NULL;
+    }
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS THAT ARE PRIVATE TO GNSS: MESSAGE RELATED
  * -------------------------------------------------------------- */
@@ -2029,7 +2112,12 @@ int32_t uGnssPrivateStreamDecodeRingBuffer(uRingBuffer_t *pRingBuffer,
             uGnssPrivateMessageId_t msg;
             memset(&msg, 0, sizeof(msg));
             msg.type = U_GNSS_PROTOCOL_UNKNOWN;
-            errorCodeOrLength = uRingBufferParseHandle(pRingBuffer, readHandle, parserList, &msg);
+            // Only try the parsers where a UBX (0xB5), NMEA ('$')
+            // or RTCM (0xD3) message might start
+            errorCodeOrLength = uRingBufferParseHandleSync(pRingBuffer, readHandle, parserList,
+                                                           U_GNSS_PRIVATE_PARSE_SYNC_BYTES,
+                                                           sizeof(U_GNSS_PRIVATE_PARSE_SYNC_BYTES) - 1,
+                                                           &msg);
             if (errorCodeOrLength <= 0) {
                 break;
             } else if (uGnssPrivateMessageIdIsWanted(&msg, pPrivateMessageId)) {
@@ -191,10 +191,35 @@ typedef struct {
     char *pTemporaryBuffer;
     uPortMutexHandle_t taskRunningMutexHandle;
     uPortQueueHandle_t taskExitQueueHandle;
-    uPortMutexHandle_t readerMutexHandle;
+    uPortMutexHandle_t readerMutexHandle; /**< serialises changes to pReaderList,
+                                               NOT taken by the task. */
     int32_t ringBufferReadHandle;
     size_t msgBytesLeftToRead;
     uGnssPrivateMsgReader_t *pReaderList;
+    void *pReaderIndex[2]; /**< two buffers in which pReaderList is indexed
+                                by message ID, see u_gnss_msg.c. */
+    void *pReaderIndexPublished; /**< whichever of pReaderIndex the task
+                                      should use to dispatch messages; only
+                                      access with U_ATOMIC_GET/U_ATOMIC_SET. */
+    void *pReaderIndexInUse;  /**< the pReaderIndex the task is currently
+                                   dispatching from, NULL if it is not; only
+                                   access with U_ATOMIC_GET/U_ATOMIC_SET. */
+    uPortSemaphoreHandle_t dataEventSemaphoreHandle; /**< given by the UART
+                                                          data-received event,
+                                                          NULL if the task is
+                                                          polling. */
+    int32_t dataEventUartHandle;     /**< the UART whose event callback was set,
+                                          only valid if dataEventSemaphoreHandle
+                                          is non-NULL. */
+    volatile int32_t dataEventTimeMs; /**< the time of the last data-received event. */
+    int32_t startTimeMs;
+    size_t statWakeUpCount;
+    size_t statWakeUpIdleCount;
+    size_t statMessageCount;
+    int32_t statLatencyLastMs;
+    int32_t statLatencyMaxMs;
+    int64_t statLatencyTotalMs;
+    int32_t statBusyTimeMs;
 } uGnssPrivateMsgReceive_t;
 
 /** Parameters to pass to the streamed position callback.
@@ -226,6 +251,32 @@ typedef struct {
     int32_t errorCode;
 } uGnssPrivateMga_t;
 
+/** Structure to hold the data associated with the task that
+ * forwards correction data to the GNSS chip.
+ */
+typedef struct {
+    void *pReadCallback; /**< a uGnssCorrectionReadCallback_t, stored as a void *
+                              to avoid dragging u_gnss_correction.h into
+                              everything. */
+    void *pCallbackParam;
+    uPortTaskHandle_t taskHandle;
+    uPortMutexHandle_t taskRunningMutexHandle;
+    uPortSemaphoreHandle_t notifySemaphoreHandle; /**< given by uGnssCorrectionNotify(). */
+    volatile bool keepGoing; /**< cleared to make the task exit. */
+    volatile int32_t notifyTimeMs; /**< the time of the last uGnssCorrectionNotify(). */
+    char *pBuffer; /**< U_GNSS_CORRECTION_BUFFER_LENGTH_BYTES long. */
+    size_t bufferDataSize; /**< the amount of data at pBuffer. */
+    size_t statBytesRead;
+    size_t statBytesForwarded;
+    size_t statBytesDiscarded;
+    size_t statMessagesForwarded;
+    size_t statMessagesDropped;
+    size_t statWriteCount;
+    int32_t statLatencyLastMs;
+    int32_t statLatencyMaxMs;
+    int64_t statLatencyTotalMs;
+} uGnssPrivateCorrection_t;
+
 /** Definition of a GNSS instance.
  * Note: a pointer to this structure is passed to the asynchronous
  * "get position" function (posGetTask()) which does NOT lock the
@@ -272,6 +323,9 @@ typedef struct uGnssPrivateInstance_t {
     uGnssRrlpMode_t rrlpMode; /**< The type of MEASX to use with RRLP capture. */
     uGnssPrivateMga_t *pMga; /**< Storage for AssistNow. */
     void *pFenceContext; /**< Storage for a uGeofenceContext_t. */
+    uGnssPrivateCorrection_t *pCorrection; /**< Storage for correction forwarding. */
+    void *pCfgValCache; /**< Storage for the cache of configuration values, private to u_gnss_cfg.c. */
+    void *pCfgValBatch; /**< Storage for a batch of configuration values, private to u_gnss_cfg.c. */
     struct uGnssPrivateInstance_t *pNext;
 } uGnssPrivateInstance_t;
 // *INDENT-ON*
@@ -521,6 +575,15 @@ bool uGnssPrivateIsInsideCell(const uGnssPrivateInstance_t *pInstance);
  */
 void uGnssPrivateStopMsgReceive(uGnssPrivateInstance_t *pInstance);
 
+/** Stop the correction-forwarding task; kept here so that GNSS
+ * deinitialisation can call it.
+ *
+ * Note: gUGnssPrivateMutex should be locked before this is called.
+ *
+ * @param[in] pInstance  a pointer to the GNSS instance, cannot  be NULL.
+ */
+void uGnssPrivateStopCorrection(uGnssPrivateInstance_t *pInstance);
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: MESSAGE RELATED
  * -------------------------------------------------------------- */
@@ -491,6 +491,8 @@ int32_t uGnssPwrOn(uDeviceHandle_t gnssHandle)
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         pInstance = pUGnssPrivateGetInstance(gnssHandle);
         if (pInstance != NULL) {
+            // Whatever the cache knew may no longer be true
+            uGnssCfgPrivateValCacheClear(pInstance);
             errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
             if (pInstance->pinGnssEnablePower >= 0) {
                 errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
@@ -631,6 +633,8 @@ int32_t uGnssPwrOff(uDeviceHandle_t gnssHandle)
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         pInstance = pUGnssPrivateGetInstance(gnssHandle);
         if (pInstance != NULL) {
+            // Whatever the cache knew may no longer be true
+            uGnssCfgPrivateValCacheClear(pInstance);
             if (pInstance->transportType == U_GNSS_TRANSPORT_AT) {
                 // For the AT interface, need to ask the cellular module
                 // to power the GNSS module down
@@ -686,6 +690,8 @@ int32_t uGnssPwrOffBackup(uDeviceHandle_t gnssHandle)
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         pInstance = pUGnssPrivateGetInstance(gnssHandle);
         if (pInstance != NULL) {
+            // Whatever the cache knew may no longer be true
+            uGnssCfgPrivateValCacheClear(pInstance);
             errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
             if (pInstance->transportType != U_GNSS_TRANSPORT_AT) {
                 // Put the GNSS chip into backup mode with UBX-RXM-PMREQ
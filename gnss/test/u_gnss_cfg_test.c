@@ -885,6 +885,131 @@ U_PORT_TEST_FUNCTION("[gnssCfg]", "gnssCfgValBasic")
     U_PORT_TEST_ASSERT(resourceCount <= 0);
 }
 
+/** Test batching and caching of VALSET/VALGET.
+ */
+U_PORT_TEST_FUNCTION("[gnssCfg]", "gnssCfgValBatch")
+{
+    uDeviceHandle_t gnssHandle;
+    const uGnssPrivateModule_t *pModule;
+    int32_t resourceCount;
+    int32_t startTimeMs;
+    int32_t y;
+    uGnssDynamic_t dynamic;
+    uGnssFixMode_t fixMode;
+    size_t iterations;
+    uGnssTransportType_t transportTypes[U_GNSS_TRANSPORT_MAX_NUM];
+
+    // In case a previous test failed
+    uGnssTestPrivateCleanup(&gHandles);
+
+    // Get the initial resource count
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    // Repeat for all transport types
+    iterations = uGnssTestPrivateTransportTypesSet(transportTypes, U_CFG_APP_GNSS_UART,
+                                                   U_CFG_APP_GNSS_I2C, U_CFG_APP_GNSS_SPI);
+    for (size_t x = 0; x < iterations; x++) {
+        // Do the standard preamble
+        U_TEST_PRINT_LINE("testing on transport %s...",
+                          pGnssTestPrivateTransportTypeName(transportTypes[x]));
+        U_PORT_TEST_ASSERT(uGnssTestPrivatePreamble(U_CFG_TEST_GNSS_MODULE_TYPE,
+                                                    transportTypes[x], &gHandles, true,
+                                                    U_CFG_APP_CELL_PIN_GNSS_POWER,
+                                                    U_CFG_APP_CELL_PIN_GNSS_DATA_READY) == 0);
+        gnssHandle = gHandles.gnssHandle;
+
+        // Get the private module data and only proceeed if it supports
+        // VALXXX-style configuation
+        pModule = pUGnssPrivateGetModule(gnssHandle);
+        U_PORT_TEST_ASSERT(pModule != NULL);
+        if (U_GNSS_PRIVATE_HAS(pModule, U_GNSS_PRIVATE_FEATURE_CFGVALXXX)) {
+            // So that we can see what we're doing
+            uGnssSetUbxMessagePrint(gnssHandle, true);
+
+            // Get the initial settings the long way
+            startTimeMs = uPortGetTickTimeMs();
+            gDynamic = uGnssCfgGetDynamic(gnssHandle);
+            gFixMode = uGnssCfgGetFixMode(gnssHandle);
+            U_TEST_PRINT_LINE("reading dynamic (%d) and fix mode (%d) from the GNSS"
+                              " chip took %d ms.", gDynamic, gFixMode,
+                              uPortGetTickTimeMs() - startTimeMs);
+            U_PORT_TEST_ASSERT((gDynamic >= (int32_t) U_GNSS_DYNAMIC_PORTABLE) &&
+                               (gDynamic <= (int32_t) U_GNSS_DYNAMIC_BIKE));
+            U_PORT_TEST_ASSERT((gFixMode >= (int32_t) U_GNSS_FIX_MODE_2D) &&
+                               (gFixMode <= (int32_t) U_GNSS_FIX_MODE_AUTO));
+
+            // Switch the cache on: the first read fills it, the
+            // second should be answered from it
+            U_PORT_TEST_ASSERT(uGnssCfgValCacheSet(gnssHandle, true) == 0);
+            U_PORT_TEST_ASSERT(uGnssCfgGetDynamic(gnssHandle) == gDynamic);
+            U_PORT_TEST_ASSERT(uGnssCfgGetFixMode(gnssHandle) == gFixMode);
+            startTimeMs = uPortGetTickTimeMs();
+            U_PORT_TEST_ASSERT(uGnssCfgGetDynamic(gnssHandle) == gDynamic);
+            U_PORT_TEST_ASSERT(uGnssCfgGetFixMode(gnssHandle) == gFixMode);
+            // Setting the same values again should also not need the GNSS chip
+            U_PORT_TEST_ASSERT(uGnssCfgSetDynamic(gnssHandle, (uGnssDynamic_t) gDynamic) == 0);
+            U_PORT_TEST_ASSERT(uGnssCfgSetFixMode(gnssHandle, (uGnssFixMode_t) gFixMode) == 0);
+            U_TEST_PRINT_LINE("reading and writing them again with the cache on took %d ms.",
+                              uPortGetTickTimeMs() - startTimeMs);
+
+            // Now change both in a batch
+            dynamic = U_GNSS_DYNAMIC_AUTOMOTIVE;
+            if (gDynamic == (int32_t) dynamic) {
+                dynamic = U_GNSS_DYNAMIC_PORTABLE;
+            }
+            fixMode = U_GNSS_FIX_MODE_AUTO;
+            if (gFixMode == (int32_t) fixMode) {
+                fixMode = U_GNSS_FIX_MODE_3D;
+            }
+            U_TEST_PRINT_LINE("setting dynamic %d and fix mode %d in a batch.", dynamic, fixMode);
+            startTimeMs = uPortGetTickTimeMs();
+            U_PORT_TEST_ASSERT(uGnssCfgValBatchStart(gnssHandle) == 0);
+            U_PORT_TEST_ASSERT(uGnssCfgSetDynamic(gnssHandle, dynamic) == 0);
+            U_PORT_TEST_ASSERT(uGnssCfgSetFixMode(gnssHandle, fixMode) == 0);
+            U_PORT_TEST_ASSERT(uGnssCfgValBatchCommit(gnssHandle) == 0);
+            U_TEST_PRINT_LINE("that took %d ms.", uPortGetTickTimeMs() - startTimeMs);
+            // Committing again should do nothing
+            U_PORT_TEST_ASSERT(uGnssCfgValBatchCommit(gnssHandle) == 0);
+            // The cache should know the new values...
+            U_PORT_TEST_ASSERT(uGnssCfgGetDynamic(gnssHandle) == (int32_t) dynamic);
+            U_PORT_TEST_ASSERT(uGnssCfgGetFixMode(gnssHandle) == (int32_t) fixMode);
+            // ...but switch it off to be sure that they got to the GNSS chip
+            U_PORT_TEST_ASSERT(uGnssCfgValCacheSet(gnssHandle, false) == 0);
+            U_PORT_TEST_ASSERT(uGnssCfgGetDynamic(gnssHandle) == (int32_t) dynamic);
+            U_PORT_TEST_ASSERT(uGnssCfgGetFixMode(gnssHandle) == (int32_t) fixMode);
+
+            // Put the initial settings back, also in a batch, reading
+            // one back in the middle, which should send the batch so far
+            U_PORT_TEST_ASSERT(uGnssCfgValBatchStart(gnssHandle) == 0);
+            U_PORT_TEST_ASSERT(uGnssCfgSetDynamic(gnssHandle, (uGnssDynamic_t) gDynamic) == 0);
+            U_PORT_TEST_ASSERT(uGnssCfgGetDynamic(gnssHandle) == gDynamic);
+            U_PORT_TEST_ASSERT(uGnssCfgSetFixMode(gnssHandle, (uGnssFixMode_t) gFixMode) == 0);
+            U_PORT_TEST_ASSERT(uGnssCfgValBatchCommit(gnssHandle) == 0);
+            U_PORT_TEST_ASSERT(uGnssCfgGetDynamic(gnssHandle) == gDynamic);
+            U_PORT_TEST_ASSERT(uGnssCfgGetFixMode(gnssHandle) == gFixMode);
+
+            // Check that we haven't dropped any incoming data
+            y = uGnssMsgReceiveStatStreamLoss(gnssHandle);
+            U_TEST_PRINT_LINE("%d byte(s) lost at the input to the ring-buffer during that test.", y);
+            U_PORT_TEST_ASSERT(y == 0);
+        } else {
+            U_TEST_PRINT_LINE("this module does not support VALXXX messages, not testing them.");
+            U_PORT_TEST_ASSERT(uGnssCfgValBatchStart(gnssHandle) < 0);
+            U_PORT_TEST_ASSERT(uGnssCfgValCacheSet(gnssHandle, true) < 0);
+        }
+
+        // Do the standard postamble, leaving the module on for the next
+        // test to speed things up
+        uGnssTestPrivatePostamble(&gHandles, false);
+    }
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
 /** Clean-up to be run at the end of this round of tests, just
  * in case there were test failures which would have resulted
  * in the deinitialisation being skipped.
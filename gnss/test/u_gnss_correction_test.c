@@ -0,0 +1,377 @@
+/*
+ * Copyright 2019-2023 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Tests for the GNSS correction-forwarding API: these should
+ * pass on all platforms where a pair of UARTs, cross-connected, are
+ * available.  No GNSS module is actually used in this set of tests:
+ * the GNSS instance is added on UART A and what it is sent is read
+ * back on UART B.
+ * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
+ * naming rules that must be followed when using the U_PORT_TEST_FUNCTION()
+ * macro.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memcmp()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_os.h"
+#include "u_port_heap.h"
+#include "u_port_debug.h"
+#include "u_port_uart.h"
+
+#include "u_test_util_resource_check.h"
+
+#include "u_spartn_test_data.h"
+
+#include "u_gnss_module_type.h"
+#include "u_gnss_type.h"
+#include "u_gnss.h"
+#include "u_gnss_correction.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_GNSS_CORRECTION_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+#ifndef U_GNSS_CORRECTION_TEST_TIMEOUT_MS
+/** How long to wait for all of the correction data to arrive
+ * at UART B.
+ */
+# define U_GNSS_CORRECTION_TEST_TIMEOUT_MS 30000
+#endif
+
+#ifndef U_GNSS_CORRECTION_TEST_CHUNK_MAX_BYTES
+/** The largest chunk of data that the test read callback will
+ * return in one go; the chunk size is varied up to this so that
+ * messages are split across reads.
+ */
+# define U_GNSS_CORRECTION_TEST_CHUNK_MAX_BYTES 300
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** A segment of test data for the read callback.
+ */
+typedef struct {
+    const char *pData;
+    size_t size;
+    bool forwarded; /**< true if this segment should arrive at the GNSS
+                         chip, false if it should be discarded. */
+} uGnssCorrectionTestSegment_t;
+
+/** Context for the test read callback.
+ */
+typedef struct {
+    const uGnssCorrectionTestSegment_t *pSegment;
+    size_t numSegments;
+    size_t segmentIndex;
+    size_t offset;
+    size_t callCount;
+} uGnssCorrectionTestSource_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+
+/** UART handle for the GNSS instance.
+ */
+static int32_t gUartAHandle = -1;
+
+/** UART handle on which to receive what the GNSS instance sends.
+ */
+static int32_t gUartBHandle = -1;
+
+/** Buffer for what is received on UART B.
+ */
+static char *gpReceived = NULL;
+
+/** An RTCM 3 type 1005 message, the example from the RTCM standard.
+ */
+static const char gRtcm1005[] = {0xD3, 0x00, 0x13, 0x3E, 0xD7, 0xD3, 0x02, 0x02, 0x98, 0x0E,
+                                 0xDE, 0xEF, 0x34, 0xB4, 0xBD, 0x62, 0xAC, 0x09, 0x41, 0x98,
+                                 0x6F, 0x33, 0x36, 0x0B, 0x98
+                                };
+
+/** The same RTCM message with a corrupted CRC.
+ */
+static const char gRtcm1005Bad[] = {0xD3, 0x00, 0x13, 0x3E, 0xD7, 0xD3, 0x02, 0x02, 0x98, 0x0E,
+                                    0xDE, 0xEF, 0x34, 0xB4, 0xBD, 0x62, 0xAC, 0x09, 0x41, 0x98,
+                                    0x6F, 0x33, 0x36, 0x0B, 0x99
+                                   };
+
+/** Some rubbish, including things that look like the start of
+ * SPARTN (0x73) and RTCM (0xD3) messages.
+ */
+static const char gRubbish[] = {'r', 'u', 'b', 0x73, 'b', 'i', 0xD3, 0x00, 's', 'h'};
+
+#endif
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+
+// Read callback, returning the test segments in chunks of
+// varying size.
+static int32_t readCallback(uDeviceHandle_t gnssHandle,
+                            char *pBuffer, size_t size,
+                            void *pCallbackParam)
+{
+    uGnssCorrectionTestSource_t *pSource = (uGnssCorrectionTestSource_t *) pCallbackParam;
+    const uGnssCorrectionTestSegment_t *pSegment;
+    size_t chunkSize;
+    size_t thisSize;
+    size_t readSize = 0;
+
+    (void) gnssHandle;
+
+    pSource->callCount++;
+    chunkSize = 1 + ((pSource->callCount * 37) % U_GNSS_CORRECTION_TEST_CHUNK_MAX_BYTES);
+    if (chunkSize > size) {
+        chunkSize = size;
+    }
+    while ((readSize < chunkSize) && (pSource->segmentIndex < pSource->numSegments)) {
+        pSegment = pSource->pSegment + pSource->segmentIndex;
+        thisSize = pSegment->size - pSource->offset;
+        if (thisSize > chunkSize - readSize) {
+            thisSize = chunkSize - readSize;
+        }
+        memcpy(pBuffer + readSize, pSegment->pData + pSource->offset, thisSize);
+        readSize += thisSize;
+        pSource->offset += thisSize;
+        if (pSource->offset >= pSegment->size) {
+            pSource->segmentIndex++;
+            pSource->offset = 0;
+        }
+    }
+
+    return (int32_t) readSize;
+}
+
+#endif
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+/** Forward a mixture of RTCM, SPARTN and rubbish to a GNSS instance
+ * and check that only the valid messages arrive.
+ */
+U_PORT_TEST_FUNCTION("[gnssCorrection]", "gnssCorrectionBasic")
+{
+    uDeviceHandle_t gnssHandle;
+    uGnssTransportHandle_t transportHandle;
+    uGnssCorrectionStat_t stat;
+    uGnssCorrectionTestSource_t source;
+    const uGnssCorrectionTestSegment_t segment[] = {
+        {gRubbish, sizeof(gRubbish), false},
+        {gRtcm1005, sizeof(gRtcm1005), true},
+        {gRtcm1005Bad, sizeof(gRtcm1005Bad), false},
+        {gRubbish, sizeof(gRubbish), false},
+        {gRtcm1005, sizeof(gRtcm1005), true},
+        // Last since a false start-of-message in what
+        // precedes it can only be resolved by more data
+        {gUSpartnTestData, gUSpartnTestDataSize, true}
+    };
+    size_t totalSize = 0;
+    size_t forwardedSize = 0;
+    size_t receivedSize = 0;
+    size_t offset = 0;
+    int32_t startTimeMs;
+    int32_t x;
+    int32_t resourceCount;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    for (size_t y = 0; y < sizeof(segment) / sizeof(segment[0]); y++) {
+        totalSize += segment[y].size;
+        if (segment[y].forwarded) {
+            forwardedSize += segment[y].size;
+        }
+    }
+    gpReceived = (char *) pUPortMalloc(forwardedSize);
+    U_PORT_TEST_ASSERT(gpReceived != NULL);
+
+#ifdef U_CFG_TEST_UART_PREFIX
+    U_PORT_TEST_ASSERT(uPortUartPrefix(U_PORT_STRINGIFY_QUOTED(U_CFG_TEST_UART_PREFIX)) == 0);
+#endif
+    gUartAHandle = uPortUartOpen(U_CFG_TEST_UART_A,
+                                 U_CFG_TEST_BAUD_RATE,
+                                 NULL,
+                                 U_GNSS_UART_BUFFER_LENGTH_BYTES,
+                                 U_CFG_TEST_PIN_UART_A_TXD,
+                                 U_CFG_TEST_PIN_UART_A_RXD,
+                                 U_CFG_TEST_PIN_UART_A_CTS,
+                                 U_CFG_TEST_PIN_UART_A_RTS);
+    U_PORT_TEST_ASSERT(gUartAHandle >= 0);
+#ifdef U_CFG_TEST_UART_PREFIX
+    U_PORT_TEST_ASSERT(uPortUartPrefix(U_PORT_STRINGIFY_QUOTED(U_CFG_TEST_UART_PREFIX)) == 0);
+#endif
+    gUartBHandle = uPortUartOpen(U_CFG_TEST_UART_B,
+                                 U_CFG_TEST_BAUD_RATE,
+                                 NULL,
+                                 U_GNSS_UART_BUFFER_LENGTH_BYTES,
+                                 U_CFG_TEST_PIN_UART_B_TXD,
+                                 U_CFG_TEST_PIN_UART_B_RXD,
+                                 U_CFG_TEST_PIN_UART_B_CTS,
+                                 U_CFG_TEST_PIN_UART_B_RTS);
+    U_PORT_TEST_ASSERT(gUartBHandle >= 0);
+
+    U_PORT_TEST_ASSERT(uGnssInit() == 0);
+    transportHandle.uart = gUartAHandle;
+    U_PORT_TEST_ASSERT(uGnssAdd(U_GNSS_MODULE_TYPE_M8,
+                                U_GNSS_TRANSPORT_UART, transportHandle,
+                                -1, false, &gnssHandle) == 0);
+
+    // Check parameters
+    U_PORT_TEST_ASSERT(uGnssCorrectionStart(gnssHandle, NULL, NULL) < 0);
+    U_PORT_TEST_ASSERT(uGnssCorrectionStat(gnssHandle, &stat) < 0);
+
+    memset(&source, 0, sizeof(source));
+    source.pSegment = segment;
+    source.numSegments = sizeof(segment) / sizeof(segment[0]);
+    U_TEST_PRINT_LINE("forwarding %d byte(s) of correction data, of which %d"
+                      " byte(s) are valid messages...", totalSize, forwardedSize);
+    U_PORT_TEST_ASSERT(uGnssCorrectionStart(gnssHandle, readCallback, &source) == 0);
+    // Can only have one at a time
+    U_PORT_TEST_ASSERT(uGnssCorrectionStart(gnssHandle, readCallback, &source) < 0);
+
+    startTimeMs = uPortGetTickTimeMs();
+    while ((receivedSize < forwardedSize) &&
+           (uPortGetTickTimeMs() - startTimeMs < U_GNSS_CORRECTION_TEST_TIMEOUT_MS)) {
+        // Nudge the task, as a socket data callback would
+        uGnssCorrectionNotify(gnssHandle);
+        x = uPortUartRead(gUartBHandle, gpReceived + receivedSize,
+                          forwardedSize - receivedSize);
+        if (x > 0) {
+            receivedSize += x;
+        } else {
+            uPortTaskBlock(10);
+        }
+    }
+    U_TEST_PRINT_LINE("%d byte(s) received in %d ms.", receivedSize,
+                      uPortGetTickTimeMs() - startTimeMs);
+    U_PORT_TEST_ASSERT(receivedSize == forwardedSize);
+
+    // Check that what arrived is the valid messages, in order
+    for (size_t y = 0; y < sizeof(segment) / sizeof(segment[0]); y++) {
+        if (segment[y].forwarded) {
+            U_PORT_TEST_ASSERT(memcmp(gpReceived + offset, segment[y].pData,
+                                      segment[y].size) == 0);
+            offset += segment[y].size;
+        }
+    }
+
+    U_PORT_TEST_ASSERT(uGnssCorrectionStat(gnssHandle, &stat) == 0);
+    U_TEST_PRINT_LINE("%d byte(s) read, %d forwarded, %d discarded.",
+                      stat.bytesRead, stat.bytesForwarded, stat.bytesDiscarded);
+    U_TEST_PRINT_LINE("%d message(s) forwarded, %d dropped.",
+                      stat.messagesForwarded, stat.messagesDropped);
+    U_TEST_PRINT_LINE("latency: last %d ms, max %d ms, average %d ms.",
+                      stat.latencyLastMs, stat.latencyMaxMs, stat.latencyAverageMs);
+    U_PORT_TEST_ASSERT(stat.bytesRead == totalSize);
+    U_PORT_TEST_ASSERT(stat.bytesForwarded == forwardedSize);
+    U_PORT_TEST_ASSERT(stat.bytesDiscarded == totalSize - forwardedSize);
+    U_PORT_TEST_ASSERT(stat.messagesForwarded == gUSpartnTestDataNumMessages + 2);
+    U_PORT_TEST_ASSERT(stat.messagesDropped == 0);
+    U_PORT_TEST_ASSERT(stat.latencyMaxMs >= stat.latencyLastMs);
+    U_PORT_TEST_ASSERT(stat.latencyMaxMs >= stat.latencyAverageMs);
+
+    U_PORT_TEST_ASSERT(uGnssCorrectionStop(gnssHandle) == 0);
+    U_PORT_TEST_ASSERT(uGnssCorrectionStat(gnssHandle, &stat) < 0);
+
+    // Start again and leave it running: removing the
+    // instance should tidy it up
+    memset(&source, 0, sizeof(source));
+    U_PORT_TEST_ASSERT(uGnssCorrectionStart(gnssHandle, readCallback, &source) == 0);
+
+    uGnssDeinit();
+
+    uPortUartClose(gUartBHandle);
+    gUartBHandle = -1;
+    uPortUartClose(gUartAHandle);
+    gUartAHandle = -1;
+    uPortFree(gpReceived);
+    gpReceived = NULL;
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Clean-up to be run at the end of this round of tests, just
+ * in case there were test failures which would have resulted
+ * in the deinitialisation being skipped.
+ */
+U_PORT_TEST_FUNCTION("[gnssCorrection]", "gnssCorrectionCleanUp")
+{
+    uGnssDeinit();
+    if (gUartBHandle >= 0) {
+        uPortUartClose(gUartBHandle);
+    }
+    if (gUartAHandle >= 0) {
+        uPortUartClose(gUartAHandle);
+    }
+    uPortFree(gpReceived);
+    uPortDeinit();
+}
+#endif
+
+// End of file
@@ -102,6 +102,13 @@
 # define U_GNSS_DEC_TEST_HEX_DUMP_WIDTH 16
 #endif
 
+#ifndef U_GNSS_DEC_TEST_THROUGHPUT_ITERATIONS
+/** The number of times to decode the test data set when measuring
+ * decode throughput.
+ */
+# define U_GNSS_DEC_TEST_THROUGHPUT_ITERATIONS 10000
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -224,11 +231,287 @@ static const uGnssDecTestDataKnown_t gUbxNavHpposllh[] = {
     }
 };
 
+/** Decoded test data for UBX-NAV-DOP, to be used by gUbxNavDop (item 0).
+ */
+static const uGnssDecUbxNavDop_t gUbxNavDopDecoded0 = {
+    477230000 /* iTOW */, 189 /* gDOP */, 118 /* pDOP */, 104 /* tDOP */,
+    97 /* vDOP */, 68 /* hDOP */, 52 /* nDOP */, 44 /* eDOP */
+};
+
+/** Array of test data for UBX-NAV-DOP.
+ */
+static const uGnssDecTestDataKnown_t gUbxNavDop[] = {
+    {
+        {
+            "\xb5\x62\x01\x04\x12\x00\xb0\xf3\x71\x1c\xbd\x00\x76\x00\x68\x00"
+            "\x61\x00\x44\x00\x34\x00\x2c\x00\xe7\xbf", 26
+        },
+        {
+            U_GNSS_PROTOCOL_UBX, 0x0104, NULL
+        },
+        (void *) &gUbxNavDopDecoded0
+    }
+};
+
+/** Decoded test data for UBX-NAV-COV, to be used by gUbxNavCov (item 0).
+ */
+static const uGnssDecUbxNavCov_t gUbxNavCovDecoded0 = {
+    477230000 /* iTOW */, 0 /* version */, 1 /* posCovValid */,
+    1 /* velCovValid */, 0.5f /* posCovNN */, 0.25f /* posCovNE */,
+    -0.125f /* posCovND */, 0.75f /* posCovEE */, 0.0625f /* posCovED */,
+    2.5f /* posCovDD */, 0.015625f /* velCovNN */, -0.03125f /* velCovNE */,
+    0.001953125f /* velCovND */, 0.0078125f /* velCovEE */,
+    0.0f /* velCovED */, 0.125f /* velCovDD */
+};
+
+/** Array of test data for UBX-NAV-COV.
+ */
+static const uGnssDecTestDataKnown_t gUbxNavCov[] = {
+    {
+        {
+            "\xb5\x62\x01\x36\x40\x00\xb0\xf3\x71\x1c\x00\x01\x01\x00\x00\x00"
+            "\x00\x00\x00\x00\x00\x00\x00\x00\x00\x3f\x00\x00\x80\x3e\x00\x00"
+            "\x00\xbe\x00\x00\x40\x3f\x00\x00\x80\x3d\x00\x00\x20\x40\x00\x00"
+            "\x80\x3c\x00\x00\x00\xbd\x00\x00\x00\x3b\x00\x00\x00\x3c\x00\x00"
+            "\x00\x00\x00\x00\x00\x3e\x2e\x83", 72
+        },
+        {
+            U_GNSS_PROTOCOL_UBX, 0x0136, NULL
+        },
+        (void *) &gUbxNavCovDecoded0
+    }
+};
+
+/** Decoded test data for UBX-NAV-TIMEUTC, to be used by gUbxNavTimeutc (item 0).
+ */
+static const uGnssDecUbxNavTimeutc_t gUbxNavTimeutcDecoded0 = {
+    477230000 /* iTOW */, 25 /* tAcc */, -73790 /* nano */, 2023 /* year */,
+    8 /* month */, 11 /* day */, 12 /* hour */, 33 /* min */, 32 /* sec */,
+    0x37 /* valid */
+};
+
+/** Array of test data for UBX-NAV-TIMEUTC.
+ */
+static const uGnssDecTestDataKnown_t gUbxNavTimeutc[] = {
+    {
+        {
+            "\xb5\x62\x01\x21\x14\x00\xb0\xf3\x71\x1c\x19\x00\x00\x00\xc2\xdf"
+            "\xfe\xff\xe7\x07\x08\x0b\x0c\x21\x20\x37\xa2\x58", 28
+        },
+        {
+            U_GNSS_PROTOCOL_UBX, 0x0121, NULL
+        },
+        (void *) &gUbxNavTimeutcDecoded0
+    }
+};
+
+/** Decoded test data for UBX-NAV-SAT, to be used by gUbxNavSat (item 0).
+ */
+static const uGnssDecUbxNavSat_t gUbxNavSatDecoded0 = {
+    477230000 /* iTOW */, 1 /* version */, 3 /* numSvs */,
+    {
+        // gnssId, svId, cno, elev, azim, prRes, flags
+        {0, 2, 42, 56, 123, -3, 0x191f},
+        {2, 11, 38, 23, 301, 12, 0x1917},
+        {6, 4, 0, -91, 0, 0, 0x1210}
+    }
+};
+
+/** Array of test data for UBX-NAV-SAT.
+ */
+static const uGnssDecTestDataKnown_t gUbxNavSat[] = {
+    {
+        {
+            "\xb5\x62\x01\x35\x2c\x00\xb0\xf3\x71\x1c\x01\x03\x00\x00\x00\x02"
+            "\x2a\x38\x7b\x00\xfd\xff\x1f\x19\x00\x00\x02\x0b\x26\x17\x2d\x01"
+            "\x0c\x00\x17\x19\x00\x00\x06\x04\x00\xa5\x00\x00\x00\x00\x10\x12"
+            "\x00\x00\x2e\xea", 52
+        },
+        {
+            U_GNSS_PROTOCOL_UBX, 0x0135, NULL
+        },
+        (void *) &gUbxNavSatDecoded0
+    }
+};
+
+/** Decoded test data for UBX-NAV-SIG, to be used by gUbxNavSig (item 0).
+ */
+static const uGnssDecUbxNavSig_t gUbxNavSigDecoded0 = {
+    477230000 /* iTOW */, 0 /* version */, 3 /* numSigs */,
+    {
+        // gnssId, svId, sigId, freqId, prRes, cno, qualityInd,
+        // corrSource, ionoModel, sigFlags
+        {0, 2, 0, 0, -3, 42, 7, 0, 1, 0x29},
+        {0, 2, 3, 0, 5, 40, 7, 0, 1, 0x29},
+        {6, 4, 0, 8, 0, 31, 4, 0, 0, 0x01}
+    }
+};
+
+/** Array of test data for UBX-NAV-SIG.
+ */
+static const uGnssDecTestDataKnown_t gUbxNavSig[] = {
+    {
+        {
+            "\xb5\x62\x01\x43\x38\x00\xb0\xf3\x71\x1c\x00\x03\x00\x00\x00\x02"
+            "\x00\x00\xfd\xff\x2a\x07\x00\x01\x29\x00\x00\x00\x00\x00\x00\x02"
+            "\x03\x00\x05\x00\x28\x07\x00\x01\x29\x00\x00\x00\x00\x00\x06\x04"
+            "\x00\x08\x00\x00\x1f\x04\x00\x00\x01\x00\x00\x00\x00\x00\xa1\x20", 64
+        },
+        {
+            U_GNSS_PROTOCOL_UBX, 0x0143, NULL
+        },
+        (void *) &gUbxNavSigDecoded0
+    }
+};
+
+/** Decoded test data for UBX-RXM-RAWX, to be used by gUbxRxmRawx (item 0).
+ */
+static const uGnssDecUbxRxmRawx_t gUbxRxmRawxDecoded0 = {
+    477230.0 /* rcvTow */, 2275 /* week */, 18 /* leapS */, 2 /* numMeas */,
+    0x01 /* recStat */, 1 /* version */,
+    {
+        // prMes, cpMes, doMes, gnssId, svId, sigId, freqId, locktime,
+        // cno, prStdev, cpStdev, doStdev, trkStat
+        {21234567.125, 111587654.5, -1234.5f, 0, 2, 0, 0, 64500, 42, 3, 1, 4, 0x07},
+        {23456789.25, 123265432.75, 2345.25f, 6, 4, 0, 8, 1200, 31, 5, 15, 6, 0x01}
+    }
+};
+
+/** Array of test data for UBX-RXM-RAWX.
+ */
+static const uGnssDecTestDataKnown_t gUbxRxmRawx[] = {
+    {
+        {
+            "\xb5\x62\x02\x15\x50\x00\x00\x00\x00\x00\xb8\x20\x1d\x41\xe3\x08"
+            "\x12\x02\x01\x01\x00\x00\x00\x00\x00\x72\x38\x40\x74\x41\x00\x00"
+            "\x00\x1a\xc5\x9a\x9a\x41\x00\x50\x9a\xc4\x00\x02\x00\x00\xf4\xfb"
+            "\x2a\x03\x01\x04\x07\x00\x00\x00\x00\x54\xc1\x5e\x76\x41\x00\x00"
+            "\x00\x63\x86\x63\x9d\x41\x00\x94\x12\x45\x06\x04\x00\x08\xb0\x04"
+            "\x1f\x05\x0f\x06\x01\x00\xa8\x0d", 88
+        },
+        {
+            U_GNSS_PROTOCOL_UBX, 0x0215, NULL
+        },
+        (void *) &gUbxRxmRawxDecoded0
+    }
+};
+
+/** Decoded test data for NMEA GGA, to be used by gNmeaGga (item 0).
+ */
+static const uGnssDecNmeaGga_t gNmeaGgaDecoded0 = {
+    0x1f /* present */, 34070000 /* time */, 533613367 /* lat */,
+    -65056200 /* lon */, U_GNSS_DEC_NMEA_GGA_QUALITY_AUTONOMOUS /* quality */,
+    8 /* numSV */, 103 /* HDOP */, 61700 /* alt */, 55200 /* sep */,
+    0 /* diffAge */, 0 /* diffStation */
+};
+
+/** Decoded test data for NMEA GGA, to be used by gNmeaGga (item 1).
+ */
+static const uGnssDecNmeaGga_t gNmeaGgaDecoded1 = {
+    0x7f /* present */, 45212000 /* time */, 522227387 /* lat */,
+    -748260 /* lon */, U_GNSS_DEC_NMEA_GGA_QUALITY_RTK_FIXED /* quality */,
+    12 /* numSV */, 58 /* HDOP */, 83100 /* alt */, 45700 /* sep */,
+    1200 /* diffAge */, 23 /* diffStation */
+};
+
+/** Decoded test data for NMEA GGA, to be used by gNmeaGga (item 2),
+ * a GGA message from before a fix has been achieved.
+ */
+static const uGnssDecNmeaGga_t gNmeaGgaDecoded2 = {
+    0x04 /* present */, 0 /* time */, 0 /* lat */, 0 /* lon */,
+    U_GNSS_DEC_NMEA_GGA_QUALITY_NO_FIX /* quality */, 0 /* numSV */,
+    9999 /* HDOP */, 0 /* alt */, 0 /* sep */, 0 /* diffAge */,
+    0 /* diffStation */
+};
+
+/** Array of test data for NMEA GGA; item 0 is taken from
+ * https://en.wikipedia.org/wiki/NMEA_0183.
+ */
+static const uGnssDecTestDataKnown_t gNmeaGga[] = {
+    {
+        {
+            "$GPGGA,092750.000,5321.6802,N,00630.3372,W,1,8,1.03,61.7,M,55.2,M,,*76", 70
+        },
+        {
+            U_GNSS_PROTOCOL_NMEA, 0, "GPGGA"
+        },
+        (void *) &gNmeaGgaDecoded0
+    },
+    {
+        {
+            "$GNGGA,123332.00,5213.36432,N,00004.48956,W,4,12,0.58,83.1,M,45.7,M,1.2,0023*4E", 79
+        },
+        {
+            U_GNSS_PROTOCOL_NMEA, 0, "GNGGA"
+        },
+        (void *) &gNmeaGgaDecoded1
+    },
+    {
+        {
+            "$GPGGA,,,,,,0,00,99.99,,,,,,*48", 31
+        },
+        {
+            U_GNSS_PROTOCOL_NMEA, 0, "GPGGA"
+        },
+        (void *) &gNmeaGgaDecoded2
+    }
+};
+
+/** Decoded test data for NMEA RMC, to be used by gNmeaRmc (item 0).
+ */
+static const uGnssDecNmeaRmc_t gNmeaRmcDecoded0 = {
+    0x17 /* present */, 45212000 /* time */, 'A' /* status */,
+    522227387 /* lat */, -748260 /* lon */, 17 /* spd */, 0 /* cog */,
+    2023 /* year */, 8 /* month */, 11 /* day */, 0 /* mv */,
+    'D' /* posMode */, 'V' /* navStatus */
+};
+
+/** Decoded test data for NMEA RMC, to be used by gNmeaRmc (item 1),
+ * an older-style RMC message without posMode or navStatus.
+ */
+static const uGnssDecNmeaRmc_t gNmeaRmcDecoded1 = {
+    0x3f /* present */, 34070000 /* time */, 'A' /* status */,
+    533613367 /* lat */, -65056200 /* lon */, 20 /* spd */, 3166 /* cog */,
+    2011 /* year */, 5 /* month */, 28 /* day */, 150 /* mv */,
+    0 /* posMode */, 0 /* navStatus */
+};
+
+/** Array of test data for NMEA RMC.
+ */
+static const uGnssDecTestDataKnown_t gNmeaRmc[] = {
+    {
+        {
+            "$GNRMC,123332.00,A,5213.36432,N,00004.48956,W,0.017,,110823,,,D,V*09", 68
+        },
+        {
+            U_GNSS_PROTOCOL_NMEA, 0, "GNRMC"
+        },
+        (void *) &gNmeaRmcDecoded0
+    },
+    {
+        {
+            "$GPRMC,092750.000,A,5321.6802,N,00630.3372,W,0.02,31.66,280511,1.5,E*41", 71
+        },
+        {
+            U_GNSS_PROTOCOL_NMEA, 0, "GPRMC"
+        },
+        (void *) &gNmeaRmcDecoded1
+    }
+};
+
 /** Array of arrays of test vectors for all known message types.
  */
 static const uGnssDecTestDataKnownSet_t gTestDataKnownSet[] = {
     {gUbxNavPvt, sizeof(gUbxNavPvt) / sizeof(gUbxNavPvt[0]), sizeof(gUbxNavPvtDecoded0)},
-    {gUbxNavHpposllh, sizeof(gUbxNavHpposllh) / sizeof(gUbxNavHpposllh[0]), sizeof(gUbxNavHpposllhDecoded0)}
+    {gUbxNavHpposllh, sizeof(gUbxNavHpposllh) / sizeof(gUbxNavHpposllh[0]), sizeof(gUbxNavHpposllhDecoded0)},
+    {gUbxNavDop, sizeof(gUbxNavDop) / sizeof(gUbxNavDop[0]), sizeof(gUbxNavDopDecoded0)},
+    {gUbxNavCov, sizeof(gUbxNavCov) / sizeof(gUbxNavCov[0]), sizeof(gUbxNavCovDecoded0)},
+    {gUbxNavTimeutc, sizeof(gUbxNavTimeutc) / sizeof(gUbxNavTimeutc[0]), sizeof(gUbxNavTimeutcDecoded0)},
+    {gUbxNavSat, sizeof(gUbxNavSat) / sizeof(gUbxNavSat[0]), sizeof(gUbxNavSatDecoded0)},
+    {gUbxNavSig, sizeof(gUbxNavSig) / sizeof(gUbxNavSig[0]), sizeof(gUbxNavSigDecoded0)},
+    {gUbxRxmRawx, sizeof(gUbxRxmRawx) / sizeof(gUbxRxmRawx[0]), sizeof(gUbxRxmRawxDecoded0)},
+    {gNmeaGga, sizeof(gNmeaGga) / sizeof(gNmeaGga[0]), sizeof(gNmeaGgaDecoded0)},
+    {gNmeaRmc, sizeof(gNmeaRmc) / sizeof(gNmeaRmc[0]), sizeof(gNmeaRmcDecoded0)}
 };
 
 /** Flag to share with the user callback.
@@ -274,10 +557,10 @@ static const uGnssDecTestDataCallback_t gTestDataCallback[] = {
     // NMEA
     {
         {
-            "$GPGGA,092750.000,5321.6802,N,00630.3372,W,1,8,1.03,61.7,M,55.2,M,,*76", 69
+            "$GPVTG,,T,,M,0.017,N,0.032,K,A*24", 33
         },
         {
-            U_GNSS_PROTOCOL_NMEA, 0, "GPGGA"
+            U_GNSS_PROTOCOL_NMEA, 0, "GPVTG"
         },
         2
     },
@@ -632,6 +915,8 @@ U_PORT_TEST_FUNCTION("[gnssDec]", "gnssDecKnown")
 {
     int32_t resourceCount;
     uGnssDec_t *pDec;
+    uGnssDec_t dec;
+    uGnssDecUnion_t *pBody;
     const uGnssDecTestDataKnown_t *pTestData = NULL;
     size_t decodedStructureSize;
     char prefix[64]; // Just for printing
@@ -639,6 +924,10 @@ U_PORT_TEST_FUNCTION("[gnssDec]", "gnssDecKnown")
     // Get the initial resource count
     resourceCount = uTestUtilGetDynamicResourceCount();
 
+    // Storage for uGnssDecDecode(), too large for the stack
+    pBody = (uGnssDecUnion_t *) pUPortMalloc(sizeof(*pBody));
+    U_PORT_TEST_ASSERT(pBody != NULL);
+
     // For each message type
     for (size_t x = 0; x < sizeof(gTestDataKnownSet) / sizeof(gTestDataKnownSet[0]); x++) {
         decodedStructureSize = gTestDataKnownSet[x].decodedStructureSize;
@@ -697,9 +986,107 @@ U_PORT_TEST_FUNCTION("[gnssDec]", "gnssDecKnown")
             }
             // Free the structure once more
             uGnssDecFree(pDec);
+
+            // Now do the same with uGnssDecDecode(), making sure
+            // that it doesn't leave anything from before behind
+            memset(pBody, 0xFF, sizeof(*pBody));
+            U_PORT_TEST_ASSERT(uGnssDecDecode(pTestData->raw.p,
+                                              pTestData->raw.length - gCrcLength[pTestData->id.type],
+                                              &dec, pBody) == 0);
+            U_PORT_TEST_ASSERT(dec.errorCode == 0);
+            U_PORT_TEST_ASSERT(dec.pBody == pBody);
+            U_PORT_TEST_ASSERT(dec.id.type == pTestData->id.type);
+            if (pTestData->id.type == U_GNSS_PROTOCOL_NMEA) {
+                U_PORT_TEST_ASSERT(strcmp(dec.id.id.pNmea, pTestData->id.pIdNmea) == 0);
+            }
+            if (memcmp(pBody, pTestData->pDecoded, decodedStructureSize) != 0) {
+                snprintf(prefix, sizeof(prefix), U_TEST_PREFIX_X_Y, (int) x, (int) y);
+                U_TEST_PRINT_LINE_X_Y("decoded in place:", x, y);
+                hexDump(prefix, (const char *) pBody, decodedStructureSize);
+                U_TEST_PRINT_LINE_X_Y("expected:", x, y);
+                hexDump(prefix, (const char *) pTestData->pDecoded, decodedStructureSize);
+                U_PORT_TEST_ASSERT(false);
+            }
+            if (pTestData->id.type == U_GNSS_PROTOCOL_UBX) {
+                // A UBX message with a body shorter than its header
+                // claims must be reported as truncated
+                U_PORT_TEST_ASSERT(uGnssDecDecode(pTestData->raw.p,
+                                                  pTestData->raw.length - gCrcLength[pTestData->id.type] - 1,
+                                                  &dec, pBody) == (int32_t) U_ERROR_COMMON_TRUNCATED);
+                U_PORT_TEST_ASSERT(dec.pBody == NULL);
+            }
         }
     }
 
+    uPortFree(pBody);
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Measure the throughput of pUGnssDecAlloc() and uGnssDecDecode()
+ * on a stream made up of all of the known test data, i.e. a mix of
+ * the UBX and NMEA messages that would be emitted at each epoch.
+ */
+U_PORT_TEST_FUNCTION("[gnssDec]", "gnssDecThroughput")
+{
+    int32_t resourceCount;
+    uGnssDec_t *pDec;
+    uGnssDec_t dec;
+    uGnssDecUnion_t *pBody;
+    const uGnssDecTestDataKnown_t *pTestData = NULL;
+    size_t numMessages = 0;
+    size_t numBytes = 0;
+    int32_t startTimeMs;
+    int32_t durationMs[2];
+
+    // Get the initial resource count
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    pBody = (uGnssDecUnion_t *) pUPortMalloc(sizeof(*pBody));
+    U_PORT_TEST_ASSERT(pBody != NULL);
+
+    // Work out the size of the stream
+    for (size_t x = 0; x < sizeof(gTestDataKnownSet) / sizeof(gTestDataKnownSet[0]); x++) {
+        for (size_t y = 0; y < gTestDataKnownSet[x].size; y++) {
+            numMessages++;
+            numBytes += gTestDataKnownSet[x].pTestData[y].raw.length;
+        }
+    }
+    U_TEST_PRINT_LINE("decoding %d messages (%d bytes) %d times with each method.",
+                      numMessages, numBytes, U_GNSS_DEC_TEST_THROUGHPUT_ITERATIONS);
+
+    // Method 0 is pUGnssDecAlloc(), method 1 is uGnssDecDecode()
+    for (size_t m = 0; m < sizeof(durationMs) / sizeof(durationMs[0]); m++) {
+        startTimeMs = uPortGetTickTimeMs();
+        for (size_t i = 0; i < U_GNSS_DEC_TEST_THROUGHPUT_ITERATIONS; i++) {
+            for (size_t x = 0; x < sizeof(gTestDataKnownSet) / sizeof(gTestDataKnownSet[0]); x++) {
+                for (size_t y = 0; y < gTestDataKnownSet[x].size; y++) {
+                    pTestData = gTestDataKnownSet[x].pTestData + y;
+                    if (m == 0) {
+                        pDec = pUGnssDecAlloc(pTestData->raw.p, pTestData->raw.length);
+                        U_PORT_TEST_ASSERT(pDec != NULL);
+                        U_PORT_TEST_ASSERT(pDec->errorCode == 0);
+                        uGnssDecFree(pDec);
+                    } else {
+                        U_PORT_TEST_ASSERT(uGnssDecDecode(pTestData->raw.p, pTestData->raw.length,
+                                                          &dec, pBody) == 0);
+                    }
+                }
+            }
+        }
+        durationMs[m] = uPortGetTickTimeMs() - startTimeMs;
+        U_TEST_PRINT_LINE("%s took %d ms, %d messages/second.",
+                          m == 0 ? "pUGnssDecAlloc()" : "uGnssDecDecode()", durationMs[m],
+                          (int32_t) (((int64_t) numMessages * U_GNSS_DEC_TEST_THROUGHPUT_ITERATIONS * 1000) /
+                                     (durationMs[m] > 0 ? durationMs[m] : 1)));
+    }
+
+    uPortFree(pBody);
+
     // Check for resource leaks
     uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
     resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
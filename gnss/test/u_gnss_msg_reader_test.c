@@ -0,0 +1,451 @@
+/*
+ * Copyright 2019-2023 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Tests for the non-blocking message readers of the GNSS API:
+ * these should pass on all platforms where a pair of UARTs,
+ * cross-connected, are available.  No GNSS module is actually used
+ * in this set of tests: the GNSS instance is added on UART A and
+ * messages are sent to it from UART B while readers are added and
+ * removed.
+ * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
+ * naming rules that must be followed when using the U_PORT_TEST_FUNCTION()
+ * macro.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memset()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_os.h"
+#include "u_port_heap.h"
+#include "u_port_debug.h"
+#include "u_port_uart.h"
+
+#include "u_test_util_resource_check.h"
+
+#include "u_ubx_protocol.h"
+
+#include "u_gnss_module_type.h"
+#include "u_gnss_type.h"
+#include "u_gnss.h"
+#include "u_gnss_msg.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_GNSS_MSG_READER_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+#ifndef U_GNSS_MSG_READER_TEST_ITERATIONS
+/** The number of times to add and remove a reader.
+ */
+# define U_GNSS_MSG_READER_TEST_ITERATIONS 500
+#endif
+
+#ifndef U_GNSS_MSG_READER_TEST_NUM_TRANSIENT
+/** The number of transient readers, which are added and removed
+ * while messages are flowing; there is also one persistent reader,
+ * so this must be less than #U_GNSS_MSG_RECEIVER_MAX_NUM.
+ */
+# define U_GNSS_MSG_READER_TEST_NUM_TRANSIENT 6
+#endif
+
+#ifndef U_GNSS_MSG_READER_TEST_TIMEOUT_MS
+/** How long to wait for the persistent reader to have seen
+ * all of the messages that were sent.
+ */
+# define U_GNSS_MSG_READER_TEST_TIMEOUT_MS 10000
+#endif
+
+/** The UBX message class that the sending task uses.
+ */
+#define U_GNSS_MSG_READER_TEST_UBX_CLASS 0x01
+
+/** The UBX message ID that the sending task uses.
+ */
+#define U_GNSS_MSG_READER_TEST_UBX_ID 0x07
+
+/** The length of the body of the UBX messages that the sending
+ * task uses.
+ */
+#define U_GNSS_MSG_READER_TEST_UBX_BODY_LENGTH_BYTES 16
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** Context for a reader.
+ */
+typedef struct {
+    int32_t handle;
+    volatile bool stopped; /**< set once uGnssMsgReceiveStop() has
+                                returned for this reader. */
+    volatile size_t count;
+    volatile size_t countAfterStop;
+} uGnssMsgReaderTestReader_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+
+/** UART handle for the GNSS instance.
+ */
+static int32_t gUartAHandle = -1;
+
+/** UART handle from which messages are sent to the GNSS instance.
+ */
+static int32_t gUartBHandle = -1;
+
+/** Set to make the sending task stop.
+ */
+static volatile bool gSendStop = false;
+
+/** Set by the sending task when it has stopped.
+ */
+static volatile bool gSendDone = false;
+
+/** The number of messages sent by the sending task.
+ */
+static volatile size_t gSendCount = 0;
+
+/** The sentence that the sending task sends in between the
+ * UBX messages, checksum included.
+ */
+static const char gNmea[] = "$GPGLL,5107.0013,N,00000.0000,E,120000.00,A,A*6B\r\n";
+
+#endif
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+
+// Write the whole of a buffer to UART B.
+static void sendBuffer(const char *pBuffer, size_t size)
+{
+    int32_t x;
+
+    while ((size > 0) && !gSendStop) {
+        x = uPortUartWrite(gUartBHandle, pBuffer, size);
+        if (x > 0) {
+            pBuffer += x;
+            size -= x;
+        } else {
+            uPortTaskBlock(U_CFG_OS_YIELD_MS);
+        }
+    }
+}
+
+// Task that sends UBX messages, each followed by an NMEA sentence,
+// to the GNSS instance until told to stop.
+static void sendTask(void *pParam)
+{
+    char body[U_GNSS_MSG_READER_TEST_UBX_BODY_LENGTH_BYTES];
+    char message[U_GNSS_MSG_READER_TEST_UBX_BODY_LENGTH_BYTES + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES];
+    int32_t length;
+
+    (void) pParam;
+
+    while (!gSendStop) {
+        memset(body, (int) gSendCount, sizeof(body));
+        length = uUbxProtocolEncode(U_GNSS_MSG_READER_TEST_UBX_CLASS,
+                                    U_GNSS_MSG_READER_TEST_UBX_ID,
+                                    body, sizeof(body), message);
+        if (length > 0) {
+            sendBuffer(message, length);
+            sendBuffer(gNmea, sizeof(gNmea) - 1);
+            if (!gSendStop) {
+                gSendCount++;
+            }
+        }
+        // Give the GNSS receive task a chance to keep up
+        if ((gSendCount % 10) == 0) {
+            uPortTaskBlock(1);
+        }
+    }
+
+    gSendDone = true;
+    uPortTaskDelete(NULL);
+}
+
+// Reader callback: counts messages and notes if it is called
+// after uGnssMsgReceiveStop() has returned.
+static void readerCallback(uDeviceHandle_t gnssHandle,
+                           const uGnssMessageId_t *pMessageId,
+                           int32_t errorCodeOrLength,
+                           void *pCallbackParam)
+{
+    uGnssMsgReaderTestReader_t *pReader = (uGnssMsgReaderTestReader_t *) pCallbackParam;
+
+    (void) gnssHandle;
+    (void) pMessageId;
+    (void) errorCodeOrLength;
+
+    if (pReader->stopped) {
+        pReader->countAfterStop++;
+    }
+    pReader->count++;
+}
+
+// Return the message ID to use for the given transient reader,
+// a mixture of the things that are indexed differently.
+static void readerMessageId(size_t index, uGnssMessageId_t *pMessageId)
+{
+    memset(pMessageId, 0, sizeof(*pMessageId));
+    switch (index % 5) {
+        case 0:
+            pMessageId->type = U_GNSS_PROTOCOL_UBX;
+            pMessageId->id.ubx = (U_GNSS_MSG_READER_TEST_UBX_CLASS << 8) |
+                                 U_GNSS_MSG_READER_TEST_UBX_ID;
+            break;
+        case 1:
+            pMessageId->type = U_GNSS_PROTOCOL_UBX;
+            pMessageId->id.ubx = (U_GNSS_MSG_READER_TEST_UBX_CLASS << 8) |
+                                 U_GNSS_UBX_MESSAGE_ID_ALL;
+            break;
+        case 2:
+            pMessageId->type = U_GNSS_PROTOCOL_NMEA;
+            pMessageId->id.pNmea = "GPGLL";
+            break;
+        case 3:
+            // A UBX message that is never sent
+            pMessageId->type = U_GNSS_PROTOCOL_UBX;
+            pMessageId->id.ubx = 0x0A04;
+            break;
+        default:
+            pMessageId->type = U_GNSS_PROTOCOL_ALL;
+            break;
+    }
+}
+
+#endif
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+/** Add and remove readers, in and out of order, while messages are
+ * flowing, checking that no reader callback is called once
+ * uGnssMsgReceiveStop() has returned and that a persistent reader
+ * sees every message.
+ */
+U_PORT_TEST_FUNCTION("[gnssMsgReader]", "gnssMsgReaderStress")
+{
+    uDeviceHandle_t gnssHandle;
+    uGnssTransportHandle_t transportHandle;
+    uGnssMessageId_t messageId;
+    uGnssMsgReaderTestReader_t persistent;
+    uGnssMsgReaderTestReader_t transient[U_GNSS_MSG_READER_TEST_NUM_TRANSIENT];
+    uGnssMsgReaderTestReader_t *pReader;
+    uPortTaskHandle_t taskHandle;
+    size_t numAdds = 0;
+    size_t numCallbacks = 0;
+    size_t numCallbacksAfterStop = 0;
+    int32_t startTimeMs;
+    int32_t resourceCount;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+#ifdef U_CFG_TEST_UART_PREFIX
+    U_PORT_TEST_ASSERT(uPortUartPrefix(U_PORT_STRINGIFY_QUOTED(U_CFG_TEST_UART_PREFIX)) == 0);
+#endif
+    gUartAHandle = uPortUartOpen(U_CFG_TEST_UART_A,
+                                 U_CFG_TEST_BAUD_RATE,
+                                 NULL,
+                                 U_GNSS_UART_BUFFER_LENGTH_BYTES,
+                                 U_CFG_TEST_PIN_UART_A_TXD,
+                                 U_CFG_TEST_PIN_UART_A_RXD,
+                                 U_CFG_TEST_PIN_UART_A_CTS,
+                                 U_CFG_TEST_PIN_UART_A_RTS);
+    U_PORT_TEST_ASSERT(gUartAHandle >= 0);
+#ifdef U_CFG_TEST_UART_PREFIX
+    U_PORT_TEST_ASSERT(uPortUartPrefix(U_PORT_STRINGIFY_QUOTED(U_CFG_TEST_UART_PREFIX)) == 0);
+#endif
+    gUartBHandle = uPortUartOpen(U_CFG_TEST_UART_B,
+                                 U_CFG_TEST_BAUD_RATE,
+                                 NULL,
+                                 U_GNSS_UART_BUFFER_LENGTH_BYTES,
+                                 U_CFG_TEST_PIN_UART_B_TXD,
+                                 U_CFG_TEST_PIN_UART_B_RXD,
+                                 U_CFG_TEST_PIN_UART_B_CTS,
+                                 U_CFG_TEST_PIN_UART_B_RTS);
+    U_PORT_TEST_ASSERT(gUartBHandle >= 0);
+
+    U_PORT_TEST_ASSERT(uGnssInit() == 0);
+    transportHandle.uart = gUartAHandle;
+    U_PORT_TEST_ASSERT(uGnssAdd(U_GNSS_MODULE_TYPE_M8,
+                                U_GNSS_TRANSPORT_UART, transportHandle,
+                                -1, false, &gnssHandle) == 0);
+
+    // Start the persistent reader, which should see every UBX message
+    memset(&persistent, 0, sizeof(persistent));
+    memset(transient, 0, sizeof(transient));
+    for (size_t x = 0; x < sizeof(transient) / sizeof(transient[0]); x++) {
+        transient[x].handle = -1;
+    }
+    messageId.type = U_GNSS_PROTOCOL_UBX;
+    messageId.id.ubx = (U_GNSS_MSG_READER_TEST_UBX_CLASS << 8) | U_GNSS_MSG_READER_TEST_UBX_ID;
+    persistent.handle = uGnssMsgReceiveStart(gnssHandle, &messageId,
+                                             readerCallback, &persistent);
+    U_PORT_TEST_ASSERT(persistent.handle >= 0);
+
+    // Start sending
+    gSendStop = false;
+    gSendDone = false;
+    gSendCount = 0;
+    U_PORT_TEST_ASSERT(uPortTaskCreate(sendTask, "testSend",
+                                       U_CFG_TEST_OS_TASK_STACK_SIZE_BYTES,
+                                       NULL, U_CFG_TEST_OS_TASK_PRIORITY,
+                                       &taskHandle) == 0);
+
+    // Add and remove transient readers, removing them out of
+    // the order in which they were added
+    U_TEST_PRINT_LINE("adding and removing readers %d time(s) while messages are flowing...",
+                      U_GNSS_MSG_READER_TEST_ITERATIONS);
+    startTimeMs = uPortGetTickTimeMs();
+    for (size_t x = 0; x < U_GNSS_MSG_READER_TEST_ITERATIONS; x++) {
+        pReader = &(transient[(x * 5) % U_GNSS_MSG_READER_TEST_NUM_TRANSIENT]);
+        if (pReader->handle >= 0) {
+            U_PORT_TEST_ASSERT(uGnssMsgReceiveStop(gnssHandle, pReader->handle) == 0);
+            // From here on the callback must not be called
+            pReader->stopped = true;
+            // Give the receive task a chance to misbehave
+            uPortTaskBlock(1);
+            numCallbacks += pReader->count;
+            numCallbacksAfterStop += pReader->countAfterStop;
+            memset(pReader, 0, sizeof(*pReader));
+            pReader->handle = -1;
+        } else {
+            readerMessageId(x, &messageId);
+            pReader->handle = uGnssMsgReceiveStart(gnssHandle, &messageId,
+                                                   readerCallback, pReader);
+            U_PORT_TEST_ASSERT(pReader->handle >= 0);
+            numAdds++;
+        }
+    }
+    U_TEST_PRINT_LINE("%d reader(s) added in %d ms, %d message(s) sent.", numAdds,
+                      uPortGetTickTimeMs() - startTimeMs, gSendCount);
+
+    // Stop sending
+    gSendStop = true;
+    while (!gSendDone) {
+        uPortTaskBlock(10);
+    }
+    // Wait for the persistent reader to catch up
+    startTimeMs = uPortGetTickTimeMs();
+    while ((persistent.count < gSendCount) &&
+           (uPortGetTickTimeMs() - startTimeMs < U_GNSS_MSG_READER_TEST_TIMEOUT_MS)) {
+        uPortTaskBlock(10);
+    }
+
+    // Remove the remaining transient readers
+    for (size_t x = 0; x < U_GNSS_MSG_READER_TEST_NUM_TRANSIENT; x++) {
+        pReader = &(transient[x]);
+        if (pReader->handle >= 0) {
+            U_PORT_TEST_ASSERT(uGnssMsgReceiveStop(gnssHandle, pReader->handle) == 0);
+            pReader->stopped = true;
+            numCallbacks += pReader->count;
+            numCallbacksAfterStop += pReader->countAfterStop;
+        }
+    }
+    U_PORT_TEST_ASSERT(uGnssMsgReceiveStop(gnssHandle, persistent.handle) == 0);
+    persistent.stopped = true;
+    uPortTaskBlock(100);
+    for (size_t x = 0; x < U_GNSS_MSG_READER_TEST_NUM_TRANSIENT; x++) {
+        numCallbacksAfterStop += transient[x].countAfterStop;
+    }
+    numCallbacksAfterStop += persistent.countAfterStop;
+
+    U_TEST_PRINT_LINE("persistent reader saw %d of %d message(s), transient readers"
+                      " %d message(s), %d callback(s) after stop.", persistent.count,
+                      gSendCount, numCallbacks, numCallbacksAfterStop);
+    U_PORT_TEST_ASSERT(numCallbacksAfterStop == 0);
+    // >= since the message that was being sent when the sending
+    // task was told to stop may or may not have been counted
+    U_PORT_TEST_ASSERT(persistent.count >= gSendCount);
+    U_PORT_TEST_ASSERT(numCallbacks > 0);
+
+    uGnssDeinit();
+
+    uPortUartClose(gUartBHandle);
+    gUartBHandle = -1;
+    uPortUartClose(gUartAHandle);
+    gUartAHandle = -1;
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Clean-up to be run at the end of this round of tests, just
+ * in case there were test failures which would have resulted
+ * in the deinitialisation being skipped.
+ */
+U_PORT_TEST_FUNCTION("[gnssMsgReader]", "gnssMsgReaderCleanUp")
+{
+    gSendStop = true;
+    uGnssDeinit();
+    if (gUartBHandle >= 0) {
+        uPortUartClose(gUartBHandle);
+    }
+    if (gUartAHandle >= 0) {
+        uPortUartClose(gUartAHandle);
+    }
+    uPortDeinit();
+}
+#endif
+
+// End of file
@@ -490,6 +490,8 @@ U_PORT_TEST_FUNCTION("[gnssMsg]", "gnssMsgReceiveNonBlocking")
     size_t iterations;
     uGnssTransportType_t transportTypes[U_GNSS_TRANSPORT_MAX_NUM];
     uGnssCommunicationStats_t communicationStats;
+    uGnssMsgReceiveStatTask_t statTask;
+    int32_t e;
     const char *pProtocolName;
 
     // In case a previous test failed
@@ -608,6 +610,7 @@ U_PORT_TEST_FUNCTION("[gnssMsg]", "gnssMsgReceiveNonBlocking")
                 // stop everything; not asserting here so that we can see what
                 // the outcome of all the above was first
                 a = uGnssMsgReceiveStackMinFree(gnssHandle);
+                e = uGnssMsgReceiveStatTask(gnssHandle, &statTask);
                 uPortTaskBlock(100);
                 b = uGnssMsgReceiveStopAll(gnssHandle);
                 uPortTaskBlock(100);
@@ -701,6 +704,18 @@ U_PORT_TEST_FUNCTION("[gnssMsg]", "gnssMsgReceiveNonBlocking")
                     U_TEST_PRINT_LINE("the minimum stack of the callback task  was %d.", a);
                 }
                 U_TEST_PRINT_LINE("the callback error code was %d.", gCallbackErrorCode);
+                if (e == 0) {
+                    U_TEST_PRINT_LINE("the receive task was %s, woke up %d time(s)"
+                                      " (%d with nothing to read) and dispatched %d"
+                                      " message(s).", statTask.eventDriven ? "event-driven" : "polling",
+                                      (int) statTask.wakeUpCount, (int) statTask.wakeUpIdleCount,
+                                      (int) statTask.messageCount);
+                    U_TEST_PRINT_LINE("receive task latency was %d ms (last), %d ms (max),"
+                                      " %d ms (average), it was busy for %d ms out of %d ms.",
+                                      statTask.latencyLastMs, statTask.latencyMaxMs,
+                                      statTask.latencyAverageMs, statTask.busyTimeMs,
+                                      statTask.runTimeMs);
+                }
 
                 // Now do the asserting
                 U_PORT_TEST_ASSERT(!bad);
@@ -709,6 +724,10 @@ U_PORT_TEST_FUNCTION("[gnssMsg]", "gnssMsgReceiveNonBlocking")
                 U_PORT_TEST_ASSERT(b == 0);
                 U_PORT_TEST_ASSERT(c == 0);
                 U_PORT_TEST_ASSERT(d == 0);
+                U_PORT_TEST_ASSERT(e == 0);
+                U_PORT_TEST_ASSERT(statTask.messageCount > 0);
+                U_PORT_TEST_ASSERT(statTask.wakeUpIdleCount <= statTask.wakeUpCount);
+                U_PORT_TEST_ASSERT(statTask.latencyAverageMs <= statTask.latencyMaxMs);
                 U_PORT_TEST_ASSERT(gCallbackErrorCode == 0);
 
                 // Switch message printing on for this bit
@@ -89,6 +89,14 @@ extern "C" {
  * TYPES
  * -------------------------------------------------------------- */
 
+/** A block of data to be written by uPortUartWriteV(), the
+ * equivalent of a POSIX struct iovec.
+ */
+typedef struct {
+    const void *pBuffer; /**< a pointer to the data to send. */
+    size_t sizeBytes;    /**< the number of bytes at pBuffer. */
+} uPortUartIoVec_t;
+
 /* ----------------------------------------------------------------
  * FUNCTIONS
  * -------------------------------------------------------------- */
@@ -249,6 +257,28 @@ int32_t uPortUartRead(int32_t handle, void *pBuffer,
 int32_t uPortUartWrite(int32_t handle, const void *pBuffer,
                        size_t sizeBytes);
 
+/** Write a number of separate blocks of data to the given UART
+ * interface as if they were one contiguous buffer, avoiding the
+ * need for the caller to copy them together first.  Will block
+ * until all of the data has been written or an error has occurred.
+ * Where the platform supports it (e.g. writev() on Linux) the
+ * blocks are handed to the driver in a single operation.
+ *
+ * You do not need to implement this function: where it is not
+ * implemented a #U_WEAK implementation provided in
+ * u_port_uart_vector.c will call uPortUartWrite() for each block
+ * in turn.
+ *
+ * @param handle       the handle of the UART instance.
+ * @param[in] pIoVec   an array of the blocks of data to send;
+ *                     blocks with a sizeBytes of zero are ignored.
+ * @param count        the number of entries in pIoVec.
+ * @return             the number of bytes sent or negative
+ *                     error code.
+ */
+int32_t uPortUartWriteV(int32_t handle, const uPortUartIoVec_t *pIoVec,
+                        size_t count);
+
 /** Set a callback to be called when a UART event occurs.
  * pFunction will be called asynchronously in its own task,
  * for which the stack size and priority can be specified.
@@ -69,11 +69,13 @@
 #include "assert.h"
 #include "string.h"
 
-#include "unistd.h"
+#include "limits.h"    // INT_MAX
+#include "unistd.h"    // syscall()
+#include "sys/syscall.h"
+#include "linux/futex.h"
 #include "semaphore.h"
 #include "sched.h"
 #include "pthread.h"
-#include "fcntl.h"
 #include "time.h"
 #include "signal.h"
 #include "errno.h"
@@ -112,17 +114,28 @@ int32_t _uPortMutexUnlock(uPortMutexHandle_t mutexHandle);
 
 /* Structures for storing os specific type data to be kept in linked lists. */
 
-/** Queues are implemented using Posix pipes. A mutex is protecting the
- *  available count and a semaphore is used for synchronisation.
- *  Pipe descriptor 0 is used for reading and 1 for writing.
+/** Queues are implemented in memory as a bounded multi-producer,
+ *  multi-consumer ring of cells.  Each cell begins with a sequence
+ *  number that tells a sender or receiver whether the cell is theirs
+ *  to use, so neither needs a lock (this is Dmitry Vyukov's bounded
+ *  MPMC queue, except that sequence numbers go up in twos, a cell
+ *  at position pos being free at pos * 2 and full at pos * 2 + 1, so
+ *  that even with a queue length of one a full cell can never be
+ *  mistaken for a free one).  Only when a queue is empty (or full) does a receiver
+ *  (or sender) sleep, on a futex that the other side bumps if, and
+ *  only if, it knows there is someone waiting.
 */
 typedef struct {
-    uPortMutexHandle_t mutex;
-    uPortSemaphoreHandle_t semHandle;
-    int fd[2];            /*!< Pipe in/out descriptor. */
-    size_t queueLength;   /*!< Max number of elements. */
-    size_t itemSizeBytes; /*!< Element size */
-    size_t readCount;     /*!< Unread bytes in the queue. */
+    size_t queueLength;      /*!< Max number of elements. */
+    size_t itemSizeBytes;    /*!< Element size. */
+    size_t cellSizeBytes;    /*!< Sequence number plus element, aligned. */
+    size_t sendPos;          /*!< Position of the next send. */
+    size_t receivePos;       /*!< Position of the next receive. */
+    uint32_t notEmpty;       /*!< Futex bumped when a waiting receiver can go. */
+    uint32_t notFull;        /*!< Futex bumped when a waiting sender can go. */
+    uint32_t receiveWaiters; /*!< The number of receivers waiting on notEmpty. */
+    uint32_t sendWaiters;    /*!< The number of senders waiting on notFull. */
+    char *pCells;            /*!< The cells, allocated after this structure. */
 } uPortQueue_t;
 
 /** Timers are implemented using Posix timer_t timers.
@@ -254,26 +267,160 @@ static void timerCallback(union sigval sv)
     pTimer->pCallback(pTimer, pTimer->pCallbackParam);
 }
 
-// Read from a queue if an event is available.
-static uErrorCode_t readFromQueue(uPortQueue_t *pQueue,
-                                  void *pEventData)
+// Get the monotonic time in milliseconds.
+static int64_t monotonicMs()
 {
-    uErrorCode_t errorCode = U_ERROR_COMMON_EMPTY;
-    MTX_FN(uPortMutexLock(pQueue->mutex));
-    if (pQueue->readCount >= pQueue->itemSizeBytes) {
-        errorCode = U_ERROR_COMMON_TRUNCATED;
-        size_t readCount = read(pQueue->fd[0], pEventData, pQueue->itemSizeBytes);
-        if (readCount == pQueue->itemSizeBytes) {
-            errorCode = U_ERROR_COMMON_SUCCESS;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((int64_t) now.tv_sec * 1000) + (now.tv_nsec / 1000000);
+}
+
+// Sleep while a futex still has the given value, for at most
+// waitMs (forever if waitMs is negative).
+static void futexWait(uint32_t *pFutex, uint32_t value, int32_t waitMs)
+{
+    struct timespec timeout;
+    struct timespec *pTimeout = NULL;
+    if (waitMs >= 0) {
+        msToTimeSpec(waitMs, &timeout, false);
+        pTimeout = &timeout;
+    }
+    syscall(SYS_futex, pFutex, FUTEX_WAIT_PRIVATE, value, pTimeout, NULL, 0);
+}
+
+// Bump a futex and wake up everyone sleeping on it, but only if
+// someone is waiting; the fence pairs with the one in queueWait().
+static void futexWake(uint32_t *pFutex, uint32_t *pWaiters)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(pWaiters, __ATOMIC_RELAXED) > 0) {
+        __atomic_add_fetch(pFutex, 1, __ATOMIC_SEQ_CST);
+        syscall(SYS_futex, pFutex, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+    }
+}
+
+// Get a pointer to the sequence number of the cell at the given
+// position in a queue; the data follows the sequence number.
+static size_t *pQueueCell(uPortQueue_t *pQueue, size_t pos)
+{
+    return (size_t *) (pQueue->pCells + ((pos % pQueue->queueLength) *
+                                         pQueue->cellSizeBytes));
+}
+
+// Put an item on a queue if there is room, without blocking.
+static bool queueTrySend(uPortQueue_t *pQueue, const void *pEventData)
+{
+    size_t pos = __atomic_load_n(&pQueue->sendPos, __ATOMIC_RELAXED);
+    size_t *pCell;
+    intptr_t diff;
+    bool sent = false;
+    bool full = false;
+
+    while (!sent && !full) {
+        pCell = pQueueCell(pQueue, pos);
+        diff = (intptr_t) __atomic_load_n(pCell, __ATOMIC_ACQUIRE) - (intptr_t) (pos * 2);
+        if (diff == 0) {
+            // The cell is free: claim it; if someone beats us to it
+            // pos is updated and we go around again
+            if (__atomic_compare_exchange_n(&pQueue->sendPos, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                memcpy(pCell + 1, pEventData, pQueue->itemSizeBytes);
+                // Hand the cell to receivers
+                __atomic_store_n(pCell, (pos * 2) + 1, __ATOMIC_RELEASE);
+                sent = true;
+            }
+        } else if (diff < 0) {
+            // The cell still holds an item from the previous lap
+            full = true;
+        } else {
+            pos = __atomic_load_n(&pQueue->sendPos, __ATOMIC_RELAXED);
         }
-        if (readCount >= 0) {
-            pQueue->readCount -= readCount;
+    }
+    if (sent) {
+        futexWake(&pQueue->notEmpty, &pQueue->receiveWaiters);
+    }
+
+    return sent;
+}
+
+// Take an item from a queue if there is one, without blocking.
+static bool queueTryReceive(uPortQueue_t *pQueue, void *pEventData)
+{
+    size_t pos = __atomic_load_n(&pQueue->receivePos, __ATOMIC_RELAXED);
+    size_t *pCell;
+    intptr_t diff;
+    bool received = false;
+    bool empty = false;
+
+    while (!received && !empty) {
+        pCell = pQueueCell(pQueue, pos);
+        diff = (intptr_t) __atomic_load_n(pCell, __ATOMIC_ACQUIRE) - (intptr_t) ((pos * 2) + 1);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&pQueue->receivePos, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                memcpy(pEventData, pCell + 1, pQueue->itemSizeBytes);
+                // Hand the cell back to senders for the next lap
+                __atomic_store_n(pCell, (pos + pQueue->queueLength) * 2, __ATOMIC_RELEASE);
+                received = true;
+            }
+        } else if (diff < 0) {
+            empty = true;
         } else {
-            errorCode = U_ERROR_COMMON_PLATFORM;
+            pos = __atomic_load_n(&pQueue->receivePos, __ATOMIC_RELAXED);
         }
     }
-    MTX_FN(uPortMutexUnlock(pQueue->mutex));
-    return errorCode;
+    if (received) {
+        futexWake(&pQueue->notFull, &pQueue->sendWaiters);
+    }
+
+    return received;
+}
+
+// Keep trying to send to or receive from a queue for up to
+// waitMs (forever if waitMs is negative), sleeping on the given
+// futex in between.  The futex is sampled and the waiter counted
+// before each retry so that, should the other side make a move
+// after the retry fails, it is bound to see the waiter and bump
+// the futex, which the sleep will notice.
+static bool queueWait(uPortQueue_t *pQueue, void *pEventData,
+                      bool sendNotReceive, int32_t waitMs)
+{
+    uint32_t *pFutex = sendNotReceive ? &pQueue->notFull : &pQueue->notEmpty;
+    uint32_t *pWaiters = sendNotReceive ? &pQueue->sendWaiters : &pQueue->receiveWaiters;
+    int64_t stopTimeMs = monotonicMs() + waitMs;
+    int32_t remainingMs = waitMs;
+    uint32_t futexValue;
+    bool done = false;
+
+    while (!done && (remainingMs != 0)) {
+        futexValue = __atomic_load_n(pFutex, __ATOMIC_SEQ_CST);
+        __atomic_add_fetch(pWaiters, 1, __ATOMIC_SEQ_CST);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (sendNotReceive) {
+            done = queueTrySend(pQueue, pEventData);
+        } else {
+            done = queueTryReceive(pQueue, pEventData);
+        }
+        if (!done) {
+            futexWait(pFutex, futexValue, remainingMs);
+        }
+        __atomic_sub_fetch(pWaiters, 1, __ATOMIC_SEQ_CST);
+        if (!done) {
+            if (sendNotReceive) {
+                done = queueTrySend(pQueue, pEventData);
+            } else {
+                done = queueTryReceive(pQueue, pEventData);
+            }
+            if (waitMs > 0) {
+                remainingMs = (int32_t) (stopTimeMs - monotonicMs());
+                if (remainingMs < 0) {
+                    remainingMs = 0;
+                }
+            }
+        }
+    }
+
+    return done;
 }
 
 // Special version of uPortMutexCreate() which does not use
@@ -510,33 +657,29 @@ int32_t uPortQueueCreate(size_t queueLength,
                          uPortQueueHandle_t *pQueueHandle)
 {
     uErrorCode_t errorCode = U_ERROR_COMMON_INVALID_PARAMETER;
-    if (pQueueHandle != NULL) {
+    if ((pQueueHandle != NULL) && (queueLength > 0) && (itemSizeBytes > 0)) {
         errorCode = U_ERROR_COMMON_NO_MEMORY;
-        uPortQueue_t *pQueue = (uPortQueue_t *)pUPortMalloc(sizeof(uPortQueue_t));
+        // Each cell is a sequence number followed by the item,
+        // rounded up so that the next sequence number is aligned
+        size_t cellSizeBytes = sizeof(size_t) +
+                               (((itemSizeBytes + sizeof(size_t) - 1) / sizeof(size_t)) *
+                                sizeof(size_t));
+        uPortQueue_t *pQueue = (uPortQueue_t *)pUPortMalloc(sizeof(uPortQueue_t) +
+                                                            (queueLength * cellSizeBytes));
         if (pQueue) {
-            uPortMutexHandle_t mutex;
-            uPortSemaphoreHandle_t semHandle;
-            if (uPortSemaphoreCreate(&semHandle, 0, queueLength) != 0) {
-                uPortFree(pQueue);
-            } else if (MTX_FN(uPortMutexCreate(&mutex)) == 0) {
-                // Create a non blocking pipe.
-                if (pipe2(pQueue->fd, O_NONBLOCK) == 0) {
-                    if (queueLength * itemSizeBytes < fcntl(pQueue->fd[1], F_GETPIPE_SZ)) {
-                        pQueue->mutex = mutex;
-                        pQueue->semHandle = semHandle;
-                        pQueue->queueLength = queueLength;
-                        pQueue->itemSizeBytes = itemSizeBytes;
-                        pQueue->readCount = 0;
-                        *pQueueHandle = pQueue;
-                        errorCode = U_ERROR_COMMON_SUCCESS;
-                        U_ATOMIC_INCREMENT(&gResourceAllocCount);
-                        U_PORT_OS_DEBUG_PRINT_QUEUE_CREATE(*pQueueHandle, queueLength, itemSizeBytes);
-                    }
-                } else {
-                    MTX_FN(uPortMutexDelete(mutex));
-                    uPortFree(pQueue);
-                }
+            memset(pQueue, 0, sizeof(*pQueue));
+            pQueue->queueLength = queueLength;
+            pQueue->itemSizeBytes = itemSizeBytes;
+            pQueue->cellSizeBytes = cellSizeBytes;
+            pQueue->pCells = (char *) (pQueue + 1);
+            // Initially each cell is free for the sender on the first lap
+            for (size_t x = 0; x < queueLength; x++) {
+                *pQueueCell(pQueue, x) = x * 2;
             }
+            *pQueueHandle = pQueue;
+            errorCode = U_ERROR_COMMON_SUCCESS;
+            U_ATOMIC_INCREMENT(&gResourceAllocCount);
+            U_PORT_OS_DEBUG_PRINT_QUEUE_CREATE(*pQueueHandle, queueLength, itemSizeBytes);
         }
     }
     return (int32_t) errorCode;
@@ -548,10 +691,6 @@ int32_t uPortQueueDelete(const uPortQueueHandle_t queueHandle)
     uErrorCode_t errorCode = U_ERROR_COMMON_INVALID_PARAMETER;
     uPortQueue_t *pQueue = (uPortQueue_t *)queueHandle;
     if (pQueue != NULL) {
-        close(pQueue->fd[0]);
-        close(pQueue->fd[1]);
-        MTX_FN(uPortMutexDelete(pQueue->mutex));
-        uPortSemaphoreDelete(pQueue->semHandle);
         uPortFree(pQueue);
         errorCode = U_ERROR_COMMON_SUCCESS;
         U_ATOMIC_DECREMENT(&gResourceAllocCount);
@@ -566,42 +705,45 @@ int32_t uPortQueueSend(const uPortQueueHandle_t queueHandle,
 {
     uErrorCode_t errorCode = U_ERROR_COMMON_INVALID_PARAMETER;
     uPortQueue_t *pQueue = (uPortQueue_t *)queueHandle;
-    if (pQueue != NULL) {
-        errorCode = U_ERROR_COMMON_TRUNCATED;
-        MTX_FN(uPortMutexLock(pQueue->mutex));
-        size_t writeCount = write(pQueue->fd[1], pEventData, pQueue->itemSizeBytes);
-        if (writeCount == pQueue->itemSizeBytes) {
-            errorCode = U_ERROR_COMMON_SUCCESS;
-        }
-        if (writeCount >= 0) {
-            pQueue->readCount += writeCount;
-        } else {
-            errorCode = U_ERROR_COMMON_PLATFORM;
+    if ((pQueue != NULL) && (pEventData != NULL)) {
+        errorCode = U_ERROR_COMMON_SUCCESS;
+        if (!queueTrySend(pQueue, pEventData)) {
+            // Full, blocking wait for room
+            queueWait(pQueue, (void *) pEventData, true, -1);
         }
-        MTX_FN(uPortMutexUnlock(pQueue->mutex));
-        uPortSemaphoreGive(pQueue->semHandle);
     }
     return (int32_t)errorCode;
 }
 
-// Send to the given queue from an interrupt; not relevant
-// on Linux
+// Send to the given queue from an interrupt: there are no
+// interrupts on Linux but this is the non-blocking form of
+// uPortQueueSend(), failing if the queue is full.
 int32_t uPortQueueSendIrq(const uPortQueueHandle_t queueHandle,
                           const void *pEventData)
 {
-    return (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+    uErrorCode_t errorCode = U_ERROR_COMMON_INVALID_PARAMETER;
+    uPortQueue_t *pQueue = (uPortQueue_t *)queueHandle;
+    if ((pQueue != NULL) && (pEventData != NULL)) {
+        errorCode = U_ERROR_COMMON_PLATFORM;
+        if (queueTrySend(pQueue, pEventData)) {
+            errorCode = U_ERROR_COMMON_SUCCESS;
+        }
+    }
+    return (int32_t)errorCode;
 }
 
 // Receive from the given queue, blocking.
 int32_t uPortQueueReceive(const uPortQueueHandle_t queueHandle,
                           void *pEventData)
 {
+    uErrorCode_t errorCode = U_ERROR_COMMON_INVALID_PARAMETER;
     uPortQueue_t *pQueue = (uPortQueue_t *)queueHandle;
-    uErrorCode_t errorCode = readFromQueue(pQueue, pEventData);
-    while (errorCode == U_ERROR_COMMON_EMPTY) {
-        // Not available, blocking wait.
-        uPortSemaphoreTake(pQueue->semHandle);
-        errorCode = readFromQueue(pQueue, pEventData);
+    if ((pQueue != NULL) && (pEventData != NULL)) {
+        errorCode = U_ERROR_COMMON_SUCCESS;
+        if (!queueTryReceive(pQueue, pEventData)) {
+            // Not available, blocking wait.
+            queueWait(pQueue, pEventData, false, -1);
+        }
     }
     return (int32_t)errorCode;
 }
@@ -617,13 +759,16 @@ int32_t uPortQueueReceiveIrq(const uPortQueueHandle_t queueHandle,
 int32_t uPortQueueTryReceive(const uPortQueueHandle_t queueHandle,
                              int32_t waitMs, void *pEventData)
 {
+    uErrorCode_t errorCode = U_ERROR_COMMON_INVALID_PARAMETER;
     uPortQueue_t *pQueue = (uPortQueue_t *)queueHandle;
-    uErrorCode_t errorCode = readFromQueue(pQueue, pEventData);
-    if (errorCode != U_ERROR_COMMON_SUCCESS) {
-        // Not available, timeout wait.
-        errorCode = uPortSemaphoreTryTake(pQueue->semHandle, waitMs);
-        if (errorCode == U_ERROR_COMMON_SUCCESS) {
-            errorCode = readFromQueue(pQueue, pEventData);
+    if ((pQueue != NULL) && (pEventData != NULL)) {
+        errorCode = U_ERROR_COMMON_SUCCESS;
+        if (!queueTryReceive(pQueue, pEventData)) {
+            // Not available, timeout wait.
+            errorCode = U_ERROR_COMMON_TIMEOUT;
+            if ((waitMs > 0) && queueWait(pQueue, pEventData, false, waitMs)) {
+                errorCode = U_ERROR_COMMON_SUCCESS;
+            }
         }
     }
     return (int32_t)errorCode;
@@ -633,7 +778,33 @@ int32_t uPortQueueTryReceive(const uPortQueueHandle_t queueHandle,
 int32_t uPortQueuePeek(const uPortQueueHandle_t queueHandle,
                        void *pEventData)
 {
-    return (int32_t)U_ERROR_COMMON_NOT_IMPLEMENTED;
+    uErrorCode_t errorCode = U_ERROR_COMMON_INVALID_PARAMETER;
+    uPortQueue_t *pQueue = (uPortQueue_t *)queueHandle;
+    size_t pos;
+    size_t *pCell;
+    intptr_t diff;
+    if ((pQueue != NULL) && (pEventData != NULL)) {
+        errorCode = U_ERROR_COMMON_PLATFORM;
+        while (errorCode == U_ERROR_COMMON_PLATFORM) {
+            pos = __atomic_load_n(&pQueue->receivePos, __ATOMIC_ACQUIRE);
+            pCell = pQueueCell(pQueue, pos);
+            diff = (intptr_t) __atomic_load_n(pCell, __ATOMIC_ACQUIRE) - (intptr_t) ((pos * 2) + 1);
+            if (diff == 0) {
+                memcpy(pEventData, pCell + 1, pQueue->itemSizeBytes);
+                // A sender can only overwrite the cell once a receiver
+                // has claimed the item, which moves the receive
+                // position on; if it has moved while we were copying
+                // the copy may be torn and we must try again
+                __atomic_thread_fence(__ATOMIC_ACQUIRE);
+                if (__atomic_load_n(&pQueue->receivePos, __ATOMIC_RELAXED) == pos) {
+                    errorCode = U_ERROR_COMMON_SUCCESS;
+                }
+            } else if (diff < 0) {
+                errorCode = U_ERROR_COMMON_TIMEOUT;
+            }
+        }
+    }
+    return (int32_t)errorCode;
 }
 
 // Get the number of free spaces in the given queue.
@@ -641,12 +812,14 @@ int32_t uPortQueueGetFree(const uPortQueueHandle_t queueHandle)
 {
     uPortQueue_t *pQueue = (uPortQueue_t *)queueHandle;
     if (pQueue != NULL) {
-        size_t maxFree = pQueue->queueLength * pQueue->itemSizeBytes;
-        size_t freeBytes = fcntl(pQueue->fd[1], F_GETPIPE_SZ) - pQueue->readCount;
-        if (freeBytes > maxFree) {
-            freeBytes = maxFree;
+        size_t receivePos = __atomic_load_n(&pQueue->receivePos, __ATOMIC_ACQUIRE);
+        size_t used = __atomic_load_n(&pQueue->sendPos, __ATOMIC_ACQUIRE) - receivePos;
+        if (used > pQueue->queueLength) {
+            // Can happen transiently, as the two positions
+            // are not read at the same instant
+            used = pQueue->queueLength;
         }
-        return (freeBytes / pQueue->itemSizeBytes);
+        return (int32_t) (pQueue->queueLength - used);
     } else {
         return (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
     }
@@ -31,10 +31,12 @@
 #include "fcntl.h"
 #include "termios.h"
 #include "unistd.h"
-#include "sys/select.h"
 #include "pthread.h"  // threadId
 #include "sys/ioctl.h"
+#include "sys/uio.h"   // readv(), writev()
 #include "sys/param.h"
+#include "sys/epoll.h"
+#include "sys/eventfd.h"
 #include "u_error_common.h"
 #include "u_linked_list.h"
 
@@ -54,17 +56,73 @@
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
-#ifndef U_PORT_UART_READ_WAIT_MS
-/** How long to wait when there is nothing to read from the UART.
+#ifndef U_PORT_UART_IO_TASK_STACK_SIZE_BYTES
+/** The stack size of the task that reads from all open UARTs.
  */
-# define U_PORT_UART_READ_WAIT_MS 10
+# define U_PORT_UART_IO_TASK_STACK_SIZE_BYTES (1024 * 4)
 #endif
 
-#ifndef U_PORT_UART_START_STOP_WAIT_MS
-/** How long to wait for a UART, mostly the read task, to start up
- * and shut down.
+#ifndef U_PORT_UART_IO_TASK_PRIORITY
+/** The priority of the task that reads from all open UARTs.
  */
-# define U_PORT_UART_START_STOP_WAIT_MS (U_PORT_UART_READ_WAIT_MS * 10)
+# define U_PORT_UART_IO_TASK_PRIORITY (U_CFG_OS_PRIORITY_MAX - 5)
+#endif
+
+#ifndef U_PORT_UART_IO_EVENTS_MAX_NUM
+/** The maximum number of epoll events the I/O task will handle
+ * each time it wakes up.
+ */
+# define U_PORT_UART_IO_EVENTS_MAX_NUM 8
+#endif
+
+#ifndef U_PORT_UART_IO_HUP_RETRY_MS
+/** How often the I/O task tries again with a UART that has hung
+ * up, e.g. a pseudo-terminal with nothing on the other side, in
+ * milliseconds.  Such a UART is taken out of the epoll set, since
+ * epoll would otherwise report the hang-up continuously, and put
+ * back when it is next read from or written to, or after this
+ * time, whichever is sooner.
+ */
+# define U_PORT_UART_IO_HUP_RETRY_MS 100
+#endif
+
+#ifndef U_PORT_UART_VMIN
+/** The termios VMIN value for an open UART.  Since a single task
+ * reads from all UARTs this should normally be left at 0: a
+ * non-zero value will make that task wait for VMIN characters on
+ * one UART before it can service any other.
+ */
+# define U_PORT_UART_VMIN 0
+#endif
+
+#ifndef U_PORT_UART_VTIME_DECISECONDS
+/** The termios VTIME value for an open UART, in tenths of a second;
+ * with VMIN at 0 this only matters if a read is attempted when
+ * there is nothing to read, which the I/O task does not do.
+ */
+# define U_PORT_UART_VTIME_DECISECONDS 1
+#endif
+
+#ifndef U_PORT_UART_LOW_LATENCY
+/** Set this to 1 to ask the serial driver to pass received
+ * characters up immediately (ASYNC_LOW_LATENCY) rather than
+ * buffering them for a few milliseconds; not all drivers support
+ * this (e.g. a pseudo-terminal does not), in which case it is
+ * silently ignored.
+ */
+# define U_PORT_UART_LOW_LATENCY 0
+#endif
+
+#if U_PORT_UART_LOW_LATENCY
+# include "linux/serial.h" // struct serial_struct, ASYNC_LOW_LATENCY
+#endif
+
+#ifndef U_PORT_UART_WRITE_V_MAX_NUM
+/** The maximum number of blocks that uPortUartWriteV() will pass
+ * to a single call of writev(); more than this and the blocks are
+ * sent in several goes.
+ */
+# define U_PORT_UART_WRITE_V_MAX_NUM 16
 #endif
 
 /* ----------------------------------------------------------------
@@ -74,7 +132,7 @@
 typedef struct uPortUartData_t {
     int uartFd;
     bool markedForDeletion;
-    uPortTaskHandle_t rxTask;
+    bool ioAdded;
     uPortMutexHandle_t mutex;
     bool bufferAllocated;
     char *pBuffer;
@@ -82,9 +140,14 @@ typedef struct uPortUartData_t {
     size_t readPos;
     size_t writePos;
     bool bufferFull;
+    bool ioHungUp; /**< true while the UART is out of the epoll set
+                        because it has hung up; protected by mutex. */
     bool hwHandshake;
     bool handshakeSuspended;
     int32_t eventQueueHandle;
+    bool eventPending; /**< true while a data-received event is waiting in,
+                            or being handled by, the event queue; protected
+                            by mutex. */
     uint32_t eventFilter;
     void (*pEventCallback)(int32_t, uint32_t, void *);
     void *pEventCallbackParam;
@@ -97,6 +160,10 @@ typedef struct {
     uint32_t eventBitMap;
     void (*pEventCallback)(int32_t, uint32_t, void *);
     void *pEventCallbackParam;
+    int32_t eventQueueHandle; /**< the event queue that the I/O task sent
+                                   this event to, so that eventHandler()
+                                   can clear eventPending, -1 for an event
+                                   from uPortUartEventSend(). */
 } uPortUartEvent_t;
 
 /** Structure to hold a UART name prefix along with the thread
@@ -128,15 +195,79 @@ static uLinkedList_t *gpUartPrefixList = NULL;
  */
 static volatile int32_t gResourceAllocCount = 0;
 
+/** Mutex to protect the I/O task and its resources; the I/O task
+ * itself never locks this.
+ */
+static uPortMutexHandle_t gIoMutex = NULL;
+
+/** The handle of the task that reads from all open UARTs.
+ */
+static uPortTaskHandle_t gIoTask = NULL;
+
+/** The epoll instance that the I/O task waits on.
+ */
+static int gIoEpollFd = -1;
+
+/** An eventfd, also in the epoll set, used to wake the I/O task.
+ */
+static int gIoWakeFd = -1;
+
+/** Semaphore given by the I/O task when it has been woken up
+ * and has finished with the events it was handling.
+ */
+static uPortSemaphoreHandle_t gIoSyncSemaphore = NULL;
+
+/** Set this to make the I/O task exit the next time it is woken.
+ */
+static volatile bool gIoTaskExit = false;
+
+/** The number of UARTs in the epoll set.
+ */
+static int32_t gIoUartCount = 0;
+
+/** The number of UARTs that have been taken out of the epoll set
+ * because they have hung up.
+ */
+static volatile int32_t gIoHungUpCount = 0;
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+static uPortUartData_t *findUart(int32_t handle)
+{
+    uLinkedList_t *p = gpUartList;
+    while (p != NULL) {
+        uPortUartData_t *pUart = (uPortUartData_t *)(p->p);
+        if (pUart->uartFd == handle) {
+            return pUart;
+        }
+        p = p->pNext;
+    }
+    return NULL;
+}
+
 // Event handler, calls the user's event callback.
 static void eventHandler(void *pParam, size_t paramLength)
 {
     uPortUartEvent_t *pEvent = (uPortUartEvent_t *) pParam;
     (void) paramLength;
+    // Clear the pending flag before calling the callback so
+    // that data arriving while it runs causes another event
+    if ((pEvent->eventQueueHandle >= 0) && (gMutex != NULL)) {
+        // Look the UART up since a closed event queue may still
+        // deliver events after the UART has gone
+        U_PORT_MUTEX_LOCK(gMutex);
+        uPortUartData_t *pUartData = findUart(pEvent->uartHandle);
+        if ((pUartData != NULL) && !pUartData->markedForDeletion) {
+            U_PORT_MUTEX_LOCK(pUartData->mutex);
+            if (pUartData->eventQueueHandle == pEvent->eventQueueHandle) {
+                pUartData->eventPending = false;
+            }
+            U_PORT_MUTEX_UNLOCK(pUartData->mutex);
+        }
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
     if (pEvent->pEventCallback != NULL) {
         pEvent->pEventCallback(pEvent->uartHandle,
                                pEvent->eventBitMap,
@@ -144,96 +275,314 @@ static void eventHandler(void *pParam, size_t paramLength)
     }
 }
 
-// Task handling incoming uart data
-static void readTask(void *pParam)
+// Start or stop epoll listening for received data on a UART;
+// p->mutex must be locked.
+static void ioListen(uPortUartData_t *p, bool onNotOff)
 {
-    uPortUartData_t *p = (uPortUartData_t *)pParam;
-    struct timeval tv = {0};
+    struct epoll_event event = {0};
 
-    // Initiate a set for select operation.
-    fd_set set;
-    tv.tv_usec = U_CFG_OS_YIELD_MS * 1000;
-    // Need a brief pause before calling select after open.
-    uPortTaskBlock(10);
-    while (!p->markedForDeletion) {
-        FD_ZERO(&set);
-        FD_SET(p->uartFd, &set);
-        // Wait for input
-        int res = select(p->uartFd + 1, &set, NULL, NULL, &tv);
-        if (res > 0) {
-            // Input is available.
-            int available;
-            do {
-                available = 0;
-                ioctl(p->uartFd, FIONREAD, &available);
-                size_t cnt = 0;
-                size_t tot = 0;
-                // Sample readPos
-                size_t readPos = p->readPos;
+    if (!p->ioHungUp) {
+        event.events = onNotOff ? EPOLLIN : 0;
+        event.data.ptr = p;
+        epoll_ctl(gIoEpollFd, EPOLL_CTL_MOD, p->uartFd, &event);
+    }
+}
+
+// Take a UART that has hung up out of the epoll set: epoll reports
+// EPOLLHUP and EPOLLERR whatever events are asked for, so leaving
+// it there would keep the I/O task spinning; called by ioRead()
+// with p->mutex locked.
+static void ioHangUp(uPortUartData_t *p)
+{
+    if (!p->ioHungUp &&
+        (epoll_ctl(gIoEpollFd, EPOLL_CTL_DEL, p->uartFd, NULL) == 0)) {
+        p->ioHungUp = true;
+        U_ATOMIC_INCREMENT(&gIoHungUpCount);
+    }
+}
+
+// Put a UART that has hung up back into the epoll set, in case
+// whatever was on the other end has come back: if it has not,
+// the I/O task will simply take it out again; p->mutex must
+// be locked.
+static void ioResume(uPortUartData_t *p)
+{
+    struct epoll_event event = {0};
+
+    if (p->ioHungUp) {
+        event.events = p->bufferFull ? 0 : EPOLLIN;
+        event.data.ptr = p;
+        if (epoll_ctl(gIoEpollFd, EPOLL_CTL_ADD, p->uartFd, &event) == 0) {
+            p->ioHungUp = false;
+            U_ATOMIC_DECREMENT(&gIoHungUpCount);
+        }
+    }
+}
+
+// Put all UARTs that have hung up back into the epoll set; called
+// by ioTask() every U_PORT_UART_IO_HUP_RETRY_MS while there are any,
+// so that a UART the application neither reads from nor writes to
+// still comes back.  gMutex is only tried, not waited for, since
+// uPortUartWrite() holds it while it writes and the write may be
+// waiting for this task to read from another UART.
+static void ioResumeAll()
+{
+    uLinkedList_t *pList;
+    uPortUartData_t *p;
+
+    if (uPortMutexTryLock(gMutex, 0) == 0) {
+        pList = gpUartList;
+        while (pList != NULL) {
+            p = (uPortUartData_t *) pList->p;
+            if (!p->markedForDeletion) {
                 U_PORT_MUTEX_LOCK(p->mutex);
-                if (p->writePos >= readPos) {
-                    // Write pos ahead of read. Use the remaining area in the
-                    // buffer first.
-                    cnt = MIN(available, p->bufferSize - p->writePos);
-                    cnt = read(p->uartFd, p->pBuffer + p->writePos, cnt);
-                    if (cnt > 0) {
-                        available -= cnt;
-                        p->writePos = (p->writePos + cnt) % p->bufferSize;
-                    }
-                    tot = cnt;
-                }
-                if ((available > 0) && (p->writePos < readPos)) {
-                    // Read pos ahead of write.
-                    cnt = MIN(available, readPos - p->writePos);
-                    cnt = read(p->uartFd, p->pBuffer + p->writePos, cnt);
-                    if (cnt > 0) {
-                        available -= cnt;
-                        p->writePos = (p->writePos + cnt) % p->bufferSize;
-                        // We might have filled up the buffer, in which case we must wait below.
-                        p->bufferFull = p->writePos == readPos;
-                    }
-                    tot += cnt;
-                }
+                ioResume(p);
                 U_PORT_MUTEX_UNLOCK(p->mutex);
-                if ((tot > 0) &&
-                    (p->eventQueueHandle >= 0)) {
-                    // Call the user callback
-                    uPortUartEvent_t event;
-                    event.uartHandle = p->uartFd;
-                    event.eventBitMap = U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED;
-                    event.pEventCallback = p->pEventCallback;
-                    event.pEventCallbackParam = p->pEventCallbackParam;
-                    uPortEventQueueSend(p->eventQueueHandle, &event, sizeof(event));
-                }
-                while (p->bufferFull && !p->markedForDeletion) {
-                    // Buffer is full, wait for consumption.
-                    uPortTaskBlock(U_PORT_UART_READ_WAIT_MS);
+            }
+            pList = pList->pNext;
+        }
+        uPortMutexUnlock(gMutex);
+    }
+}
+
+// Read what has arrived on a UART into its receive buffer, in at
+// most two chunks with a single readv(), and let the user know;
+// called by ioTask().  Since this one task serves all UARTs, a
+// data-received event is only sent if there is not one already
+// pending for the UART: that way the event queue of a UART can
+// never be full, so the send never blocks and a slow event
+// callback cannot hold up reception on the other UARTs (or
+// deadlock against uPortUartClose() called from that callback).
+static void ioRead(uPortUartData_t *p, uint32_t events)
+{
+    struct iovec ioVec[2];
+    int ioVecCount = 0;
+    ssize_t cnt = 0;
+    size_t readPos;
+    int32_t eventQueueHandle = -1;
+    uPortUartEvent_t event;
+
+    U_PORT_MUTEX_LOCK(p->mutex);
+    readPos = p->readPos;
+    if (!p->bufferFull) {
+        ioVec[0].iov_base = p->pBuffer + p->writePos;
+        if (p->writePos >= readPos) {
+            // Write pos ahead of read: use the remaining area in
+            // the buffer first and then wrap up to the read pointer
+            ioVec[0].iov_len = p->bufferSize - p->writePos;
+            ioVecCount = 1;
+            if (readPos > 0) {
+                ioVec[1].iov_base = p->pBuffer;
+                ioVec[1].iov_len = readPos;
+                ioVecCount = 2;
+            }
+        } else {
+            // Read pos ahead of write
+            ioVec[0].iov_len = readPos - p->writePos;
+            ioVecCount = 1;
+        }
+        cnt = readv(p->uartFd, ioVec, ioVecCount);
+        if (cnt > 0) {
+            p->writePos = (p->writePos + cnt) % p->bufferSize;
+            p->bufferFull = (p->writePos == readPos);
+        }
+    }
+    if ((cnt <= 0) && ((events & (EPOLLHUP | EPOLLERR)) != 0)) {
+        // The device has gone away
+        ioHangUp(p);
+    } else if (p->bufferFull) {
+        // There is no more room: uPortUartRead() will start
+        // listening again once it has made some
+        ioListen(p, false);
+    }
+    if ((cnt > 0) && !p->eventPending) {
+        eventQueueHandle = p->eventQueueHandle;
+        if (eventQueueHandle >= 0) {
+            p->eventPending = true;
+            event.uartHandle = p->uartFd;
+            event.eventBitMap = U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED;
+            event.pEventCallback = p->pEventCallback;
+            event.pEventCallbackParam = p->pEventCallbackParam;
+            event.eventQueueHandle = eventQueueHandle;
+        }
+    }
+    U_PORT_MUTEX_UNLOCK(p->mutex);
+
+    if (eventQueueHandle >= 0) {
+        // Call the user callback
+        if (uPortEventQueueSend(eventQueueHandle, &event, sizeof(event)) < 0) {
+            U_PORT_MUTEX_LOCK(p->mutex);
+            p->eventPending = false;
+            U_PORT_MUTEX_UNLOCK(p->mutex);
+        }
+    }
+}
+
+// The single task that handles incoming data for all UARTs.
+static void ioTask(void *pParam)
+{
+    struct epoll_event events[U_PORT_UART_IO_EVENTS_MAX_NUM];
+    int numEvents;
+    uint64_t value;
+    bool woken;
+    bool exitNow = false;
+
+    (void) pParam;
+
+    while (!exitNow) {
+        woken = false;
+        // Only time out if there is a UART that has hung up
+        numEvents = epoll_wait(gIoEpollFd, events,
+                               sizeof(events) / sizeof(events[0]),
+                               gIoHungUpCount > 0 ? U_PORT_UART_IO_HUP_RETRY_MS : -1);
+        if ((numEvents == 0) && (gIoHungUpCount > 0)) {
+            ioResumeAll();
+        }
+        for (int x = 0; x < numEvents; x++) {
+            if (events[x].data.ptr == NULL) {
+                // Someone is waiting on us, see ioSync()
+                if (read(gIoWakeFd, &value, sizeof(value)) == sizeof(value)) {
+                    woken = true;
                 }
-            } while ((available > 0) && !p->markedForDeletion);
+            } else {
+                ioRead((uPortUartData_t *) events[x].data.ptr, events[x].events);
+            }
+        }
+        if (woken) {
+            exitNow = gIoTaskExit;
+            uPortSemaphoreGive(gIoSyncSemaphore);
         }
     }
+
+    uPortTaskDelete(NULL);
 }
 
-static uPortUartPrefix_t *findPrefix(pthread_t threadId)
+// Wait for the I/O task to finish with the events it is handling;
+// once this returns the I/O task holds no reference to a UART
+// that has been removed from the epoll set.  gIoMutex must be
+// locked.
+static void ioSync()
 {
-    uLinkedList_t *p = gpUartPrefixList;
-    while (p != NULL) {
-        uPortUartPrefix_t *pUartPrefix = (uPortUartPrefix_t *)(p->p);
-        if (pUartPrefix->threadId == threadId) {
-            return pUartPrefix;
+    uint64_t value = 1;
+
+    if (write(gIoWakeFd, &value, sizeof(value)) == sizeof(value)) {
+        uPortSemaphoreTake(gIoSyncSemaphore);
+    }
+}
+
+// Free the resources of the I/O task; gIoMutex must be locked.
+static void ioFree()
+{
+    if (gIoSyncSemaphore != NULL) {
+        uPortSemaphoreDelete(gIoSyncSemaphore);
+        gIoSyncSemaphore = NULL;
+    }
+    if (gIoWakeFd >= 0) {
+        close(gIoWakeFd);
+        gIoWakeFd = -1;
+    }
+    if (gIoEpollFd >= 0) {
+        close(gIoEpollFd);
+        gIoEpollFd = -1;
+    }
+}
+
+// Start the I/O task; gIoMutex must be locked.
+static int32_t ioStart()
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+    struct epoll_event event = {0};
+
+    gIoTaskExit = false;
+    gIoEpollFd = epoll_create1(EPOLL_CLOEXEC);
+    gIoWakeFd = eventfd(0, EFD_CLOEXEC);
+    if ((gIoEpollFd >= 0) && (gIoWakeFd >= 0)) {
+        // The wake-up eventfd is the one with a NULL pointer
+        event.events = EPOLLIN;
+        event.data.ptr = NULL;
+        if ((epoll_ctl(gIoEpollFd, EPOLL_CTL_ADD, gIoWakeFd, &event) == 0) &&
+            (uPortSemaphoreCreate(&gIoSyncSemaphore, 0, 1) == 0)) {
+            errorCode = uPortTaskCreate(ioTask, "uartIo",
+                                        U_PORT_UART_IO_TASK_STACK_SIZE_BYTES,
+                                        NULL, U_PORT_UART_IO_TASK_PRIORITY,
+                                        &gIoTask);
         }
-        p = p->pNext;
     }
-    return NULL;
+    if (errorCode != 0) {
+        ioFree();
+    }
+
+    return errorCode;
 }
 
-static uPortUartData_t *findUart(int32_t handle)
+// Stop the I/O task; gIoMutex must be locked.
+static void ioStop()
 {
-    uLinkedList_t *p = gpUartList;
+    gIoTaskExit = true;
+    ioSync();
+    gIoTask = NULL;
+    ioFree();
+}
+
+// Add a UART to the set the I/O task listens to, starting the
+// I/O task if required.
+static int32_t ioAdd(uPortUartData_t *p)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    struct epoll_event event = {0};
+
+    U_PORT_MUTEX_LOCK(gIoMutex);
+    if (gIoUartCount == 0) {
+        errorCode = ioStart();
+    }
+    if (errorCode == 0) {
+        event.events = EPOLLIN;
+        event.data.ptr = p;
+        if (epoll_ctl(gIoEpollFd, EPOLL_CTL_ADD, p->uartFd, &event) == 0) {
+            p->ioAdded = true;
+            gIoUartCount++;
+        } else {
+            errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+            if (gIoUartCount == 0) {
+                ioStop();
+            }
+        }
+    }
+    U_PORT_MUTEX_UNLOCK(gIoMutex);
+
+    return errorCode;
+}
+
+// Remove a UART from the set the I/O task listens to, stopping
+// the I/O task if it is the last one.
+static void ioRemove(uPortUartData_t *p)
+{
+    U_PORT_MUTEX_LOCK(gIoMutex);
+    if (p->ioAdded) {
+        epoll_ctl(gIoEpollFd, EPOLL_CTL_DEL, p->uartFd, NULL);
+        p->ioAdded = false;
+        gIoUartCount--;
+        if (gIoUartCount > 0) {
+            ioSync();
+        } else {
+            ioStop();
+        }
+        // The I/O task has now let go of the UART
+        if (p->ioHungUp) {
+            p->ioHungUp = false;
+            U_ATOMIC_DECREMENT(&gIoHungUpCount);
+        }
+    }
+    U_PORT_MUTEX_UNLOCK(gIoMutex);
+}
+
+static uPortUartPrefix_t *findPrefix(pthread_t threadId)
+{
+    uLinkedList_t *p = gpUartPrefixList;
     while (p != NULL) {
-        uPortUartData_t *pUart = (uPortUartData_t *)(p->p);
-        if (pUart->uartFd == handle) {
-            return pUart;
+        uPortUartPrefix_t *pUartPrefix = (uPortUartPrefix_t *)(p->p);
+        if (pUartPrefix->threadId == threadId) {
+            return pUartPrefix;
         }
         p = p->pNext;
     }
@@ -243,13 +592,12 @@ static uPortUartData_t *findUart(int32_t handle)
 static void disposeUartData(uPortUartData_t *p)
 {
     if (p != NULL) {
+        U_PORT_MUTEX_LOCK(gMutex);
         uLinkedListRemove(&gpUartList, p);
-        if (p->rxTask != NULL) {
-            uPortTaskDelete(p->rxTask);
-            // Wait for the task to exit before
-            // we pull the structures out from under it
-            uPortTaskBlock(U_PORT_UART_START_STOP_WAIT_MS);
-        }
+        U_PORT_MUTEX_UNLOCK(gMutex);
+        // Make sure the I/O task has let go of the UART
+        // before we pull the structures out from under it
+        ioRemove(p);
         if (p->eventQueueHandle >= 0) {
             uPortEventQueueClose(p->eventQueueHandle);
         }
@@ -319,6 +667,13 @@ int32_t uPortUartInit()
     uErrorCode_t errorCode = U_ERROR_COMMON_SUCCESS;
     if (gMutex == NULL) {
         errorCode = uPortMutexCreate(&gMutex);
+        if (errorCode == U_ERROR_COMMON_SUCCESS) {
+            errorCode = uPortMutexCreate(&gIoMutex);
+            if (errorCode != U_ERROR_COMMON_SUCCESS) {
+                uPortMutexDelete(gMutex);
+                gMutex = NULL;
+            }
+        }
     }
     return (int32_t) errorCode;
 }
@@ -353,7 +708,11 @@ void uPortUartDeinit()
             uPortUartData_t *pUart = (uPortUartData_t *)(gpUartList->p);
             disposeUartData(pUart);
         }
-        // Delete the mutex
+        // Delete the mutexes
+        U_PORT_MUTEX_LOCK(gIoMutex);
+        U_PORT_MUTEX_UNLOCK(gIoMutex);
+        uPortMutexDelete(gIoMutex);
+        gIoMutex = NULL;
         U_PORT_MUTEX_LOCK(gMutex);
         U_PORT_MUTEX_UNLOCK(gMutex);
         uPortMutexDelete(gMutex);
@@ -463,14 +822,21 @@ int32_t uPortUartOpen(int32_t uart, int32_t baudRate,
     } else {
         options.c_cflag &= ~CRTSCTS;
     }
-    // Set timed read with 100 ms timeout
-    options.c_cc[VMIN] = 0;
-    options.c_cc[VTIME] = 1;
+    options.c_cc[VMIN] = U_PORT_UART_VMIN;
+    options.c_cc[VTIME] = U_PORT_UART_VTIME_DECISECONDS;
     if (tcsetattr(pUartData->uartFd, TCSANOW, &options) == 0) {
         tcflush(pUartData->uartFd, TCIOFLUSH);
     } else {
         FAIL(U_ERROR_COMMON_PLATFORM);
     }
+#if U_PORT_UART_LOW_LATENCY
+    struct serial_struct serial;
+    if (ioctl(pUartData->uartFd, TIOCGSERIAL, &serial) == 0) {
+        serial.flags |= ASYNC_LOW_LATENCY;
+        // Not all drivers support this, carry on regardless
+        ioctl(pUartData->uartFd, TIOCSSERIAL, &serial);
+    }
+#endif
 
     if (pReceiveBuffer == NULL) {
         pUartData->pBuffer = pUPortMalloc(bufferSize);
@@ -488,12 +854,9 @@ int32_t uPortUartOpen(int32_t uart, int32_t baudRate,
     if (uPortMutexCreate(&(pUartData->mutex)) != 0) {
         FAIL(U_ERROR_COMMON_NO_MEMORY);
     }
-    if (uPortTaskCreate(readTask, "", 4 * 1024, pUartData, U_CFG_OS_PRIORITY_MAX - 5,
-                        &(pUartData->rxTask)) != 0) {
+    if (ioAdd(pUartData) != 0) {
         FAIL(U_ERROR_COMMON_PLATFORM);
     }
-    // Wait for the read task to start
-    uPortTaskBlock(U_PORT_UART_START_STOP_WAIT_MS);
     U_PORT_MUTEX_LOCK(gMutex);
     uLinkedListAdd(&gpUartList, (void *)pUartData);
     U_PORT_MUTEX_UNLOCK(gMutex);
@@ -504,12 +867,13 @@ int32_t uPortUartOpen(int32_t uart, int32_t baudRate,
 // Close a UART instance.
 void uPortUartClose(int32_t handle)
 {
-    if (gMutex != NULL) {
+    uPortUartData_t *pUartData = NULL;
 
-        uPortUartData_t *pUartData = findUart(handle);
+    if (gMutex != NULL) {
 
         U_PORT_MUTEX_LOCK(gMutex);
 
+        pUartData = findUart(handle);
         if ((pUartData != NULL) && !pUartData->markedForDeletion) {
             // Mark the UART for deletion within the mutex
             pUartData->markedForDeletion = true;
@@ -592,9 +956,11 @@ int32_t uPortUartRead(int32_t handle, void *pBuffer,
                 }
             }
             if (pUartData->bufferFull && (sizeOrErrorCode > 0)) {
-                // Release possible waiting read task.
+                // There is room again: have the I/O task listen
                 pUartData->bufferFull = false;
+                ioListen(pUartData, true);
             }
+            ioResume(pUartData);
             U_PORT_MUTEX_UNLOCK(pUartData->mutex);
         }
         U_PORT_MUTEX_UNLOCK(gMutex);
@@ -613,6 +979,9 @@ int32_t uPortUartWrite(int32_t handle, const void *pBuffer,
         uPortUartData_t *pUartData = findUart(handle);
         if ((pBuffer != NULL) && (sizeBytes > 0) &&
             (pUartData != NULL) && !pUartData->markedForDeletion) {
+            U_PORT_MUTEX_LOCK(pUartData->mutex);
+            ioResume(pUartData);
+            U_PORT_MUTEX_UNLOCK(pUartData->mutex);
             sizeOrErrorCode = write(pUartData->uartFd, pBuffer, sizeBytes);
             if (sizeOrErrorCode < 0) {
                 sizeOrErrorCode = (int32_t)U_ERROR_COMMON_PLATFORM;
@@ -623,6 +992,62 @@ int32_t uPortUartWrite(int32_t handle, const void *pBuffer,
     return sizeOrErrorCode;
 }
 
+// Write blocks of data in one go with writev().
+int32_t uPortUartWriteV(int32_t handle, const uPortUartIoVec_t *pIoVec,
+                        size_t count)
+{
+    int32_t sizeOrErrorCode = (int32_t)U_ERROR_COMMON_NOT_INITIALISED;
+    struct iovec ioVec[U_PORT_UART_WRITE_V_MAX_NUM];
+    size_t ioVecCount;
+    size_t wantedSize;
+    ssize_t thisSize;
+    int32_t totalSize = 0;
+    if (gMutex != NULL) {
+        U_PORT_MUTEX_LOCK(gMutex);
+        sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        uPortUartData_t *pUartData = findUart(handle);
+        if ((pIoVec != NULL) && (pUartData != NULL) && !pUartData->markedForDeletion) {
+            U_PORT_MUTEX_LOCK(pUartData->mutex);
+            ioResume(pUartData);
+            U_PORT_MUTEX_UNLOCK(pUartData->mutex);
+            sizeOrErrorCode = 0;
+            while ((count > 0) && (sizeOrErrorCode == 0)) {
+                // Gather as many non-empty blocks as will fit
+                ioVecCount = 0;
+                wantedSize = 0;
+                while ((count > 0) && (ioVecCount < U_PORT_UART_WRITE_V_MAX_NUM)) {
+                    if ((pIoVec->pBuffer != NULL) && (pIoVec->sizeBytes > 0)) {
+                        ioVec[ioVecCount].iov_base = (void *) pIoVec->pBuffer;
+                        ioVec[ioVecCount].iov_len = pIoVec->sizeBytes;
+                        wantedSize += pIoVec->sizeBytes;
+                        ioVecCount++;
+                    }
+                    pIoVec++;
+                    count--;
+                }
+                if (ioVecCount > 0) {
+                    thisSize = writev(pUartData->uartFd, ioVec, (int) ioVecCount);
+                    if (thisSize < 0) {
+                        sizeOrErrorCode = (int32_t)U_ERROR_COMMON_PLATFORM;
+                    } else {
+                        totalSize += (int32_t) thisSize;
+                        if ((size_t) thisSize < wantedSize) {
+                            // Short write: stop here and let the
+                            // caller deal with the remainder
+                            count = 0;
+                        }
+                    }
+                }
+            }
+            if (sizeOrErrorCode == 0) {
+                sizeOrErrorCode = totalSize;
+            }
+        }
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+    return sizeOrErrorCode;
+}
+
 // Set an event callback.
 int32_t uPortUartEventCallbackSet(int32_t handle,
                                   uint32_t filter,
@@ -651,10 +1076,14 @@ int32_t uPortUartEventCallbackSet(int32_t handle,
                                             priority,
                                             U_PORT_UART_EVENT_QUEUE_SIZE);
             if (errorCode >= 0) {
+                U_PORT_MUTEX_LOCK(pUartData->mutex);
+                // Any event pending on a previous queue is gone
+                pUartData->eventPending = false;
                 pUartData->eventQueueHandle = (int32_t) errorCode;
                 pUartData->eventFilter = filter;
                 pUartData->pEventCallback = pFunction;
                 pUartData->pEventCallbackParam = pParam;
+                U_PORT_MUTEX_UNLOCK(pUartData->mutex);
                 errorCode = U_ERROR_COMMON_SUCCESS;
             }
         }
@@ -743,6 +1172,7 @@ int32_t uPortUartEventSend(int32_t handle, uint32_t eventBitMap)
             event.eventBitMap = eventBitMap;
             event.pEventCallback = pUartData->pEventCallback;
             event.pEventCallbackParam = pUartData->pEventCallbackParam;
+            event.eventQueueHandle = -1;
             errorCode = uPortEventQueueSend(pUartData->eventQueueHandle,
                                             &event, sizeof(event));
         }
@@ -755,12 +1185,40 @@ int32_t uPortUartEventSend(int32_t handle, uint32_t eventBitMap)
 int32_t uPortUartEventTrySend(int32_t handle, uint32_t eventBitMap,
                               int32_t delayMs)
 {
-    (void) handle;
-    (void) eventBitMap;
-    (void) delayMs;
-    // Not supported on Linux since uPortEventQueueSendIrq() is
-    // not supported.
-    return (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+    uErrorCode_t errorCode = U_ERROR_COMMON_NOT_INITIALISED;
+    int32_t eventQueueHandle = -1;
+    uPortUartEvent_t event;
+    int32_t startTimeMs = uPortGetTickTimeMs();
+    if (gMutex != NULL) {
+        U_PORT_MUTEX_LOCK(gMutex);
+        errorCode = U_ERROR_COMMON_INVALID_PARAMETER;
+        uPortUartData_t *pUartData = findUart(handle);
+        if ((pUartData != NULL) && !pUartData->markedForDeletion &&
+            (pUartData->eventQueueHandle >= 0) &&
+            // The only event we support right now
+            (eventBitMap == U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED)) {
+            eventQueueHandle = pUartData->eventQueueHandle;
+            event.uartHandle = handle;
+            event.eventBitMap = eventBitMap;
+            event.pEventCallback = pUartData->pEventCallback;
+            event.pEventCallbackParam = pUartData->pEventCallbackParam;
+            event.eventQueueHandle = -1;
+        }
+        U_PORT_MUTEX_UNLOCK(gMutex);
+        // Retry outside gMutex since eventHandler() needs it
+        // in order to empty the queue
+        if (eventQueueHandle >= 0) {
+            do {
+                errorCode = uPortEventQueueSendIrq(eventQueueHandle,
+                                                   &event, sizeof(event));
+                if (errorCode != 0) {
+                    uPortTaskBlock(U_CFG_OS_YIELD_MS);
+                }
+            } while ((errorCode != 0) &&
+                     (uPortGetTickTimeMs() - startTimeMs < delayMs));
+        }
+    }
+    return (int32_t) errorCode;
 }
 
 // Return true if we're in an event callback.
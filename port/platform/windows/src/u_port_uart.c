@@ -859,6 +859,40 @@ int32_t uPortUartWrite(int32_t handle, const void *pBuffer,
     return sizeOrErrorCode;
 }
 
+// Write blocks of data; Windows has no gather-write for serial
+// ports so this simply writes each block in turn (and has to be
+// here since MSVC can't cope with the U_WEAK one).
+int32_t uPortUartWriteV(int32_t handle, const uPortUartIoVec_t *pIoVec,
+                        size_t count)
+{
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    int32_t thisSizeOrErrorCode;
+    int32_t totalSize = 0;
+
+    if (pIoVec != NULL) {
+        sizeOrErrorCode = 0;
+        for (size_t x = 0; (x < count) && (sizeOrErrorCode >= 0); x++) {
+            if ((pIoVec + x)->sizeBytes > 0) {
+                thisSizeOrErrorCode = uPortUartWrite(handle, (pIoVec + x)->pBuffer,
+                                                     (pIoVec + x)->sizeBytes);
+                if (thisSizeOrErrorCode < 0) {
+                    sizeOrErrorCode = thisSizeOrErrorCode;
+                } else {
+                    totalSize += thisSizeOrErrorCode;
+                    if (thisSizeOrErrorCode < (int32_t) (pIoVec + x)->sizeBytes) {
+                        break;
+                    }
+                }
+            }
+        }
+        if (sizeOrErrorCode >= 0) {
+            sizeOrErrorCode = totalSize;
+        }
+    }
+
+    return sizeOrErrorCode;
+}
+
 // Set an event callback.
 int32_t uPortUartEventCallbackSet(int32_t handle,
                                   uint32_t filter,
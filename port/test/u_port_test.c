@@ -75,6 +75,18 @@
 
 #include "u_test_util_resource_check.h"
 
+#if defined(__linux__) && !defined(__ZEPHYR__)
+/** On Linux a pseudo-terminal can stand in for a UART, allowing
+ * the UART receive path to be tested without any wiring.
+ */
+# define U_PORT_TEST_LINUX_PTY
+# include "fcntl.h"     // open()
+# include "unistd.h"    // write(), close()
+# include "sys/ioctl.h" // TIOCSPTLCK, TIOCGPTN
+# include "termios.h"   // cfmakeraw()
+# include "poll.h"      // poll()
+#endif
+
 #ifdef CONFIG_IRQ_OFFLOAD // To test semaphore from ISR in zephyr
 #include <version.h>
 #if KERNEL_VERSION_NUMBER >= ZEPHYR_VERSION(3,1,0)
@@ -116,6 +128,48 @@
  */
 #define U_PORT_TEST_QUEUE_LENGTH 20
 
+#ifdef U_PORT_TEST_LINUX_PTY
+/** The size of the UART receive buffer for the pseudo-terminal
+ * test; deliberately small so that it fills up.
+ */
+# define U_PORT_TEST_LINUX_PTY_BUFFER_LENGTH_BYTES 256
+
+/** The number of single bytes to send when measuring latency in
+ * the pseudo-terminal test.
+ */
+# define U_PORT_TEST_LINUX_PTY_LATENCY_ITERATIONS 1000
+
+/** The largest byte-to-callback latency that the pseudo-terminal
+ * test will accept; this is a sanity check rather than a target,
+ * it has to survive a heavily loaded test machine.
+ */
+# define U_PORT_TEST_LINUX_PTY_LATENCY_MAX_US 100000
+
+/** The number of bytes to send in the buffer-full part of the
+ * pseudo-terminal test, must be more than
+ * U_PORT_TEST_LINUX_PTY_BUFFER_LENGTH_BYTES and less than a
+ * pseudo-terminal will buffer (4 kbytes).
+ */
+# define U_PORT_TEST_LINUX_PTY_FULL_LENGTH_BYTES 1000
+
+/** The number of separate writes to make to a pseudo-terminal whose
+ * callback is held up, must be more than U_PORT_UART_EVENT_QUEUE_SIZE
+ * for the test to be meaningful.
+ */
+# define U_PORT_TEST_LINUX_PTY_HELD_WRITES 50
+
+/** How long to leave a pseudo-terminal hung up for in the hang-up
+ * test.
+ */
+# define U_PORT_TEST_LINUX_PTY_HUP_WAIT_MS 1000
+
+/** The most CPU time that the process may use while a
+ * pseudo-terminal is hung up for U_PORT_TEST_LINUX_PTY_HUP_WAIT_MS;
+ * a spinning I/O task would use all of it.
+ */
+# define U_PORT_TEST_LINUX_PTY_HUP_CPU_MAX_MS 200
+#endif
+
 /** The size of each item on the queue during testing.
  */
 #define U_PORT_TEST_QUEUE_ITEM_SIZE sizeof(int32_t)
@@ -244,6 +298,26 @@
  */
 #define U_PORT_OS_TEST_TASK_TRY_RECEIVE_MS 10
 
+#ifndef U_PORT_TEST_OS_QUEUE_THROUGHPUT_ITEMS
+/** The number of items to pass through a queue when measuring
+ * queue throughput.
+ */
+# define U_PORT_TEST_OS_QUEUE_THROUGHPUT_ITEMS 100000
+#endif
+
+#ifndef U_PORT_TEST_OS_QUEUE_PEEK_ITEMS
+/** The number of items to pass through a queue of length one
+ * while another task peeks at it.
+ */
+# define U_PORT_TEST_OS_QUEUE_PEEK_ITEMS 100000
+#endif
+
+/** The number of int32_t values in each item passed through a
+ * queue while another task peeks at it, all of which carry the same
+ * value so that a torn copy can be spotted.
+ */
+#define U_PORT_TEST_OS_QUEUE_PEEK_ITEM_VALUES 8
+
 #ifndef U_PORT_TEST_CRITICAL_SECTION_TEST_TASK_START_TIME_SECONDS
 /** How long to wait for the critical section test task to start,
  * leaving plenty of time for Windows.
@@ -320,6 +394,21 @@ typedef enum {
 
 #endif
 
+#ifdef U_PORT_TEST_LINUX_PTY
+
+/** Data for the pseudo-terminal UART test callback.
+ */
+typedef struct {
+    uPortSemaphoreHandle_t semaphoreHandle;
+    int64_t callbackTimeUs;
+    char buffer[U_PORT_TEST_LINUX_PTY_BUFFER_LENGTH_BYTES];
+    int32_t bytesRead;
+    volatile bool hold;            /**< the callback waits while this is true. */
+    volatile bool closeInCallback; /**< the callback closes the UART. */
+} uPortTestLinuxPty_t;
+
+#endif
+
 /** Struct for mktime64() and gmtime_r() testing.
  */
 typedef struct {
@@ -379,6 +468,15 @@ static int32_t gEventQueueMinErrorFlag;
 // Counter for event queue callback min length
 static int32_t gEventQueueMinCounter;
 
+// Flag to tell the queue peek test task to stop.
+static volatile bool gQueuePeekStop;
+
+// The number of successful peeks made by the queue peek test task.
+static volatile int32_t gQueuePeekCount;
+
+// The number of torn items seen by the queue peek test task.
+static volatile int32_t gQueuePeekTornCount;
+
 #if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B < 0)
 
 // The data to send during UART testing.
@@ -1018,6 +1116,8 @@ static void runUartTest(int32_t size, int32_t speed,
     int32_t stackMinFreeBytes;
     int32_t x;
     const char *pFlowControl = "?";
+    uPortUartIoVec_t ioVec[2];
+    bool useWriteV = false;
 
     eventCallbackData.callCount = 0;
     eventCallbackData.pReceive = gUartBuffer;
@@ -1172,9 +1272,20 @@ static void runUartTest(int32_t size, int32_t speed,
         if (bytesToSend > size - bytesSent) {
             bytesToSend = size - bytesSent;
         }
-        U_PORT_TEST_ASSERT(uPortUartWrite(uartHandle,
-                                          gUartTestData,
-                                          bytesToSend) == bytesToSend);
+        if (useWriteV) {
+            // Every other time, send the same thing in
+            // two blocks using the scatter/gather write
+            ioVec[0].pBuffer = gUartTestData;
+            ioVec[0].sizeBytes = bytesToSend / 2;
+            ioVec[1].pBuffer = gUartTestData + ioVec[0].sizeBytes;
+            ioVec[1].sizeBytes = bytesToSend - ioVec[0].sizeBytes;
+            U_PORT_TEST_ASSERT(uPortUartWriteV(uartHandle, ioVec, 2) == bytesToSend);
+        } else {
+            U_PORT_TEST_ASSERT(uPortUartWrite(uartHandle,
+                                              gUartTestData,
+                                              bytesToSend) == bytesToSend);
+        }
+        useWriteV = !useWriteV;
         bytesSent += bytesToSend;
         U_TEST_PRINT_LINE("%d byte(s) sent.", bytesSent);
         // Yield so that the receive task has chance to do
@@ -1227,6 +1338,130 @@ static void runUartTest(int32_t size, int32_t speed,
 
 #endif // (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B < 0)
 
+#ifdef U_PORT_TEST_LINUX_PTY
+
+// Get a monotonic time in microseconds.
+static int64_t linuxTimeUs()
+{
+    struct timespec timeSpec;
+
+    clock_gettime(CLOCK_MONOTONIC, &timeSpec);
+    return ((int64_t) timeSpec.tv_sec * 1000000) + (timeSpec.tv_nsec / 1000);
+}
+
+// UART callback for the pseudo-terminal test: note the time and
+// read whatever has arrived.
+static void linuxPtyCallback(int32_t uartHandle, uint32_t eventBitmask,
+                             void *pParameters)
+{
+    uPortTestLinuxPty_t *pPty = (uPortTestLinuxPty_t *) pParameters;
+    int32_t x;
+
+    pPty->callbackTimeUs = linuxTimeUs();
+    while (pPty->hold) {
+        uPortTaskBlock(10);
+    }
+    if (pPty->closeInCallback) {
+        pPty->closeInCallback = false;
+        uPortUartClose(uartHandle);
+        uPortSemaphoreGive(pPty->semaphoreHandle);
+    } else if ((eventBitmask & U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED) != 0) {
+        x = uPortUartRead(uartHandle, pPty->buffer, sizeof(pPty->buffer));
+        if (x > 0) {
+            pPty->bytesRead += x;
+            uPortSemaphoreGive(pPty->semaphoreHandle);
+        }
+    }
+}
+
+// Create a pseudo-terminal and open its slave side as a UART with
+// linuxPtyCallback() attached, returning the UART handle and
+// setting *pMasterFd to the master side.
+static int32_t linuxPtyOpen(uPortTestLinuxPty_t *pPty, int *pMasterFd)
+{
+    int32_t uartHandle = -1;
+    int ptyNumber = 0;
+    int unlock = 0;
+
+    *pMasterFd = open("/dev/ptmx", O_RDWR | O_NOCTTY);
+    if ((*pMasterFd >= 0) &&
+        (ioctl(*pMasterFd, TIOCSPTLCK, &unlock) == 0) &&
+        (ioctl(*pMasterFd, TIOCGPTN, &ptyNumber) == 0) &&
+        (uPortUartPrefix("/dev/pts/") == 0)) {
+        uartHandle = uPortUartOpen(ptyNumber, 115200, NULL,
+                                   U_PORT_TEST_LINUX_PTY_BUFFER_LENGTH_BYTES,
+                                   -1, -1, -1, -1);
+        if ((uartHandle >= 0) &&
+            ((uPortSemaphoreCreate(&(pPty->semaphoreHandle), 0, 1) != 0) ||
+             (uPortUartEventCallbackSet(uartHandle,
+                                        U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED,
+                                        linuxPtyCallback, pPty,
+                                        U_PORT_EVENT_QUEUE_MIN_TASK_STACK_SIZE_BYTES,
+                                        U_CFG_OS_PRIORITY_MAX - 5) != 0))) {
+            uPortUartClose(uartHandle);
+            uartHandle = -1;
+        }
+    }
+
+    return uartHandle;
+}
+
+// Get the CPU time used by this process in milliseconds.
+static int32_t linuxCpuTimeMs()
+{
+    struct timespec timeSpec;
+
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &timeSpec);
+    return (int32_t) ((timeSpec.tv_sec * 1000) + (timeSpec.tv_nsec / 1000000));
+}
+
+// Open the slave side of a pseudo-terminal, raw so that nothing
+// is echoed back.
+static int linuxPtySlaveOpen(int ptyNumber)
+{
+    char name[32];
+    struct termios options;
+    int fd;
+
+    snprintf(name, sizeof(name), "/dev/pts/%d", ptyNumber);
+    fd = open(name, O_RDWR | O_NOCTTY);
+    if (fd >= 0) {
+        tcgetattr(fd, &options);
+        cfmakeraw(&options);
+        tcsetattr(fd, TCSANOW, &options);
+    }
+
+    return fd;
+}
+
+// Check that data flows both ways between the slave side of a
+// pseudo-terminal and a UART open on its master side.
+static bool linuxPtyCheckFlow(uPortTestLinuxPty_t *pPty, int32_t uartHandle,
+                              int slaveFd, char c)
+{
+    bool good;
+    struct pollfd pollFd = {0};
+    char buffer[8];
+
+    pPty->bytesRead = 0;
+    good = (write(slaveFd, &c, 1) == 1) &&
+           (uPortSemaphoreTryTake(pPty->semaphoreHandle, 1000) == 0) &&
+           (pPty->bytesRead == 1) && (pPty->buffer[0] == c);
+    if (good) {
+        c++;
+        pollFd.fd = slaveFd;
+        pollFd.events = POLLIN;
+        good = (uPortUartWrite(uartHandle, &c, 1) == 1) &&
+               (poll(&pollFd, 1, 1000) == 1) &&
+               (read(slaveFd, buffer, sizeof(buffer)) == 1) &&
+               (buffer[0] == c);
+    }
+
+    return good;
+}
+
+#endif // #ifdef U_PORT_TEST_LINUX_PTY
+
 #if (U_CFG_APP_GNSS_SPI >= 0)
 
 // Compare SPI fill words, doing it for the right word length.
@@ -1659,6 +1894,28 @@ U_PORT_TEST_FUNCTION("[port]", "portOs")
     }
     U_PORT_TEST_ASSERT(uPortQueueDelete(queueHandle) == 0);
 
+    // Create a queue and fill it: it should hold exactly
+    // U_PORT_TEST_QUEUE_LENGTH items, after which a non-blocking
+    // send should fail, and succeed again once there is room
+    U_PORT_TEST_ASSERT(uPortQueueCreate(U_PORT_TEST_QUEUE_LENGTH,
+                                        U_PORT_TEST_QUEUE_ITEM_SIZE,
+                                        &queueHandle) == 0);
+    for (y = 0; y < U_PORT_TEST_QUEUE_LENGTH; y++) {
+        U_PORT_TEST_ASSERT(sendToQueue(queueHandle, y) == 0);
+    }
+    z = uPortQueueGetFree(queueHandle);
+    U_TEST_PRINT_LINE("queue of length %d has %d free after %d sends.",
+                      U_PORT_TEST_QUEUE_LENGTH, z, U_PORT_TEST_QUEUE_LENGTH);
+    U_PORT_TEST_ASSERT((z == 0) || (z == (int32_t) U_ERROR_COMMON_NOT_SUPPORTED));
+    z = sendToQueueIrq(queueHandle, y);
+    if (z != (int32_t) U_ERROR_COMMON_NOT_SUPPORTED) {
+        U_PORT_TEST_ASSERT(z < 0);
+        U_PORT_TEST_ASSERT(uPortQueueReceive(queueHandle, &z) == 0);
+        U_PORT_TEST_ASSERT(z == 0);
+        U_PORT_TEST_ASSERT(sendToQueueIrq(queueHandle, y) == 0);
+    }
+    U_PORT_TEST_ASSERT(uPortQueueDelete(queueHandle) == 0);
+
     timeNowMs = uPortGetTickTimeMs() - startTimeMs;
     U_TEST_PRINT_LINE("according to uPortGetTickTimeMs()"
                       " the test took %d ms.", (int32_t) timeNowMs);
@@ -1694,6 +1951,60 @@ static void osTestTaskSemaphoreGiveFromIsr(const void *pParameters)
 }
 #endif
 
+// Task that sends U_PORT_TEST_OS_QUEUE_THROUGHPUT_ITEMS integers,
+// counting up from zero, to the queue it is given and then exits.
+static void osQueueThroughputTask(void *pParameters)
+{
+    uPortQueueHandle_t queueHandle = (uPortQueueHandle_t) pParameters;
+
+    for (int32_t x = 0; x < U_PORT_TEST_OS_QUEUE_THROUGHPUT_ITEMS; x++) {
+        uPortQueueSend(queueHandle, &x);
+    }
+
+    uPortTaskDelete(NULL);
+}
+
+// Task that sends U_PORT_TEST_OS_QUEUE_PEEK_ITEMS items, each
+// filled with a value counting up from zero, to the queue it is
+// given and then exits.
+static void osQueuePeekSendTask(void *pParameters)
+{
+    uPortQueueHandle_t queueHandle = (uPortQueueHandle_t) pParameters;
+    int32_t item[U_PORT_TEST_OS_QUEUE_PEEK_ITEM_VALUES];
+
+    for (int32_t x = 0; x < U_PORT_TEST_OS_QUEUE_PEEK_ITEMS; x++) {
+        for (size_t y = 0; y < sizeof(item) / sizeof(item[0]); y++) {
+            item[y] = x;
+        }
+        uPortQueueSend(queueHandle, item);
+    }
+
+    uPortTaskDelete(NULL);
+}
+
+// Task that peeks at the queue it is given until gQueuePeekStop
+// is set, counting the items seen and any that are torn, and
+// then exits.
+static void osQueuePeekTask(void *pParameters)
+{
+    uPortQueueHandle_t queueHandle = (uPortQueueHandle_t) pParameters;
+    int32_t item[U_PORT_TEST_OS_QUEUE_PEEK_ITEM_VALUES];
+
+    while (!gQueuePeekStop) {
+        if (uPortQueuePeek(queueHandle, item) == 0) {
+            for (size_t y = 1; y < sizeof(item) / sizeof(item[0]); y++) {
+                if (item[y] != item[0]) {
+                    gQueuePeekTornCount++;
+                    break;
+                }
+            }
+            gQueuePeekCount++;
+        }
+    }
+
+    uPortTaskDelete(NULL);
+}
+
 U_PORT_TEST_FUNCTION("[port]", "portOsSemaphore")
 {
     int32_t errorCode;
@@ -1866,6 +2177,160 @@ U_PORT_TEST_FUNCTION("[port]", "portOsSemaphore")
     U_PORT_TEST_ASSERT(resourceCount <= 0);
 }
 
+/** Measure the throughput of an OS queue, both within a single
+ * task and between two tasks.
+ */
+U_PORT_TEST_FUNCTION("[port]", "portOsQueueThroughput")
+{
+    int32_t resourceCount;
+    uPortQueueHandle_t queueHandle = NULL;
+    uPortTaskHandle_t taskHandle = NULL;
+    int32_t startTimeMs;
+    int32_t durationMs;
+    int32_t item;
+    int32_t itemsPerSecond;
+    bool good = true;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    U_PORT_TEST_ASSERT(uPortQueueCreate(U_PORT_TEST_QUEUE_LENGTH,
+                                        sizeof(int32_t),
+                                        &queueHandle) == 0);
+
+    // Send and then receive in this task, which never blocks
+    startTimeMs = uPortGetTickTimeMs();
+    for (int32_t x = 0; (x < U_PORT_TEST_OS_QUEUE_THROUGHPUT_ITEMS) && good; x++) {
+        item = -1;
+        good = (uPortQueueSend(queueHandle, &x) == 0) &&
+               (uPortQueueReceive(queueHandle, &item) == 0) &&
+               (item == x);
+    }
+    durationMs = uPortGetTickTimeMs() - startTimeMs;
+    U_PORT_TEST_ASSERT(good);
+    if (durationMs <= 0) {
+        durationMs = 1;
+    }
+    itemsPerSecond = (int32_t) (((int64_t) U_PORT_TEST_OS_QUEUE_THROUGHPUT_ITEMS * 1000) / durationMs);
+    U_TEST_PRINT_LINE("%d send/receive pair(s) in one task took %d ms, %d per second.",
+                      U_PORT_TEST_OS_QUEUE_THROUGHPUT_ITEMS, durationMs, itemsPerSecond);
+
+    // Now have another task do the sending, so that both
+    // the sender and the receiver will have to wait
+    startTimeMs = uPortGetTickTimeMs();
+    U_PORT_TEST_ASSERT(uPortTaskCreate(osQueueThroughputTask, "osQueueThroughputTask",
+                                       U_CFG_TEST_OS_TASK_STACK_SIZE_BYTES,
+                                       (void *) queueHandle,
+                                       U_CFG_TEST_OS_TASK_PRIORITY,
+                                       &taskHandle) == 0);
+    for (int32_t x = 0; (x < U_PORT_TEST_OS_QUEUE_THROUGHPUT_ITEMS) && good; x++) {
+        item = -1;
+        good = (uPortQueueTryReceive(queueHandle, 5000, &item) == 0) && (item == x);
+        if (!good) {
+            U_TEST_PRINT_LINE("expected %d but received %d.", x, item);
+        }
+    }
+    durationMs = uPortGetTickTimeMs() - startTimeMs;
+    U_PORT_TEST_ASSERT(good);
+    if (durationMs <= 0) {
+        durationMs = 1;
+    }
+    itemsPerSecond = (int32_t) (((int64_t) U_PORT_TEST_OS_QUEUE_THROUGHPUT_ITEMS * 1000) / durationMs);
+    U_TEST_PRINT_LINE("%d item(s) between two tasks took %d ms, %d per second.",
+                      U_PORT_TEST_OS_QUEUE_THROUGHPUT_ITEMS, durationMs, itemsPerSecond);
+    U_PORT_TEST_ASSERT(uPortQueueGetFree(queueHandle) == U_PORT_TEST_QUEUE_LENGTH);
+
+    // Give the sending task time to exit
+    uPortTaskBlock(100);
+    U_PORT_TEST_ASSERT(uPortQueueDelete(queueHandle) == 0);
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Peek at a queue of length one while one task sends to it and
+ * another receives from it, so that the single item is forever
+ * being replaced under the peeker's nose: a peek must never return
+ * a torn item, nor may an item be lost or received out of order.
+ */
+U_PORT_TEST_FUNCTION("[port]", "portOsQueuePeek")
+{
+    int32_t resourceCount;
+    uPortQueueHandle_t queueHandle = NULL;
+    uPortTaskHandle_t taskHandle = NULL;
+    int32_t item[U_PORT_TEST_OS_QUEUE_PEEK_ITEM_VALUES];
+    bool good = true;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    U_PORT_TEST_ASSERT(uPortQueueCreate(1, sizeof(item), &queueHandle) == 0);
+
+    // A queue of length one is full after a single send
+    item[0] = 0;
+    U_PORT_TEST_ASSERT(uPortQueueSendIrq(queueHandle, item) == 0);
+    U_PORT_TEST_ASSERT(uPortQueueGetFree(queueHandle) == 0);
+    U_PORT_TEST_ASSERT(uPortQueueSendIrq(queueHandle, item) < 0);
+    U_PORT_TEST_ASSERT(uPortQueueReceive(queueHandle, item) == 0);
+    U_PORT_TEST_ASSERT(uPortQueuePeek(queueHandle, item) < 0);
+
+    gQueuePeekStop = false;
+    gQueuePeekCount = 0;
+    gQueuePeekTornCount = 0;
+    U_PORT_TEST_ASSERT(uPortTaskCreate(osQueuePeekTask, "osQueuePeekTask",
+                                       U_CFG_TEST_OS_TASK_STACK_SIZE_BYTES,
+                                       (void *) queueHandle,
+                                       U_CFG_TEST_OS_TASK_PRIORITY,
+                                       &taskHandle) == 0);
+    U_PORT_TEST_ASSERT(uPortTaskCreate(osQueuePeekSendTask, "osQueuePeekSendTask",
+                                       U_CFG_TEST_OS_TASK_STACK_SIZE_BYTES,
+                                       (void *) queueHandle,
+                                       U_CFG_TEST_OS_TASK_PRIORITY,
+                                       &taskHandle) == 0);
+    for (int32_t x = 0; (x < U_PORT_TEST_OS_QUEUE_PEEK_ITEMS) && good; x++) {
+        memset(item, 0xff, sizeof(item));
+        good = (uPortQueueTryReceive(queueHandle, 5000, item) == 0);
+        for (size_t y = 0; good && (y < sizeof(item) / sizeof(item[0])); y++) {
+            good = (item[y] == x);
+        }
+        if (!good) {
+            U_TEST_PRINT_LINE("expected %d but received %d.", x, item[0]);
+        }
+    }
+    gQueuePeekStop = true;
+    U_TEST_PRINT_LINE("%d item(s) received, %d peek(s) of which %d torn.",
+                      U_PORT_TEST_OS_QUEUE_PEEK_ITEMS, gQueuePeekCount,
+                      gQueuePeekTornCount);
+    U_PORT_TEST_ASSERT(good);
+    U_PORT_TEST_ASSERT(gQueuePeekTornCount == 0);
+    U_PORT_TEST_ASSERT(uPortQueueGetFree(queueHandle) == 1);
+
+    // Give the tasks time to exit
+    uPortTaskBlock(100);
+    U_PORT_TEST_ASSERT(uPortQueueDelete(queueHandle) == 0);
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
 #if (U_CFG_TEST_UART_A >= 0) && defined(U_PORT_TEST_CHECK_TIME_TAKEN)
 /** Some ports, e.g. the Nordic one, use the tick time somewhat
  * differently when the UART is running so initialise that
@@ -2649,6 +3114,276 @@ U_PORT_TEST_FUNCTION("[port]", "portUartRequiresSpecificWiring")
 }
 #endif
 
+#ifdef U_PORT_TEST_LINUX_PTY
+/** Test the Linux UART receive path through a pseudo-terminal,
+ * measuring the latency from a byte being written to the UART
+ * callback being called and checking that data is not lost when
+ * the receive buffer fills up.
+ */
+U_PORT_TEST_FUNCTION("[port]", "portUartLinuxPty")
+{
+    int32_t resourceCount;
+    uPortTestLinuxPty_t pty = {0};
+    int masterFd;
+    int32_t uartHandle;
+    char c;
+    int32_t x;
+    int32_t bytesReceived = 0;
+    int64_t sendTimeUs;
+    int64_t latencyUs;
+    int64_t latencyMinUs = INT64_MAX;
+    int64_t latencyMaxUs = 0;
+    int64_t latencyTotalUs = 0;
+    int32_t startTimeMs;
+    bool good = true;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    // Create a pseudo-terminal and open its slave side as a UART
+    uartHandle = linuxPtyOpen(&pty, &masterFd);
+    U_TEST_PRINT_LINE("opened pseudo-terminal as UART handle %d.", uartHandle);
+    U_PORT_TEST_ASSERT(uartHandle >= 0);
+
+    // Send single bytes and time how long each takes to arrive
+    for (size_t y = 0; (y < U_PORT_TEST_LINUX_PTY_LATENCY_ITERATIONS) && good; y++) {
+        c = (char) y;
+        pty.bytesRead = 0;
+        sendTimeUs = linuxTimeUs();
+        good = (write(masterFd, &c, 1) == 1) &&
+               (uPortSemaphoreTryTake(pty.semaphoreHandle, 1000) == 0) &&
+               (pty.bytesRead == 1) && (pty.buffer[0] == c);
+        if (good) {
+            latencyUs = pty.callbackTimeUs - sendTimeUs;
+            latencyTotalUs += latencyUs;
+            if (latencyUs < latencyMinUs) {
+                latencyMinUs = latencyUs;
+            }
+            if (latencyUs > latencyMaxUs) {
+                latencyMaxUs = latencyUs;
+            }
+        } else {
+            U_TEST_PRINT_LINE("byte %d failed to arrive.", (int32_t) y);
+        }
+    }
+    U_PORT_TEST_ASSERT(good);
+    U_TEST_PRINT_LINE("byte-to-callback latency over %d byte(s): min %d us,"
+                      " average %d us, max %d us.",
+                      U_PORT_TEST_LINUX_PTY_LATENCY_ITERATIONS,
+                      (int32_t) latencyMinUs,
+                      (int32_t) (latencyTotalUs / U_PORT_TEST_LINUX_PTY_LATENCY_ITERATIONS),
+                      (int32_t) latencyMaxUs);
+    U_PORT_TEST_ASSERT(latencyMaxUs < U_PORT_TEST_LINUX_PTY_LATENCY_MAX_US);
+
+    // Now, without the callback reading anything, send more than
+    // will fit in the receive buffer: it should fill up and then,
+    // as it is read, the rest should arrive intact
+    uPortUartEventCallbackRemove(uartHandle);
+    for (x = 0; x < U_PORT_TEST_LINUX_PTY_FULL_LENGTH_BYTES; x++) {
+        c = (char) (x % 251);
+        U_PORT_TEST_ASSERT(write(masterFd, &c, 1) == 1);
+    }
+    startTimeMs = uPortGetTickTimeMs();
+    while ((uPortUartGetReceiveSize(uartHandle) < U_PORT_TEST_LINUX_PTY_BUFFER_LENGTH_BYTES) &&
+           (uPortGetTickTimeMs() - startTimeMs < 1000)) {
+        uPortTaskBlock(10);
+    }
+    U_PORT_TEST_ASSERT(uPortUartGetReceiveSize(uartHandle) == U_PORT_TEST_LINUX_PTY_BUFFER_LENGTH_BYTES);
+    startTimeMs = uPortGetTickTimeMs();
+    while ((bytesReceived < U_PORT_TEST_LINUX_PTY_FULL_LENGTH_BYTES) &&
+           (uPortGetTickTimeMs() - startTimeMs < 5000)) {
+        // Read in odd-sized chunks to exercise the wrap
+        x = uPortUartRead(uartHandle, pty.buffer, 37);
+        U_PORT_TEST_ASSERT(x >= 0);
+        for (int32_t y = 0; y < x; y++) {
+            U_PORT_TEST_ASSERT(pty.buffer[y] == (char) ((bytesReceived + y) % 251));
+        }
+        bytesReceived += x;
+        if (x == 0) {
+            uPortTaskBlock(1);
+        }
+    }
+    U_TEST_PRINT_LINE("%d byte(s) received through a full buffer.", bytesReceived);
+    U_PORT_TEST_ASSERT(bytesReceived == U_PORT_TEST_LINUX_PTY_FULL_LENGTH_BYTES);
+
+    uPortUartClose(uartHandle);
+    uPortSemaphoreDelete(pty.semaphoreHandle);
+    close(masterFd);
+
+    // This also removes the UART prefix we set
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Test that, on Linux, where a single task reads from all UARTs,
+ * an event callback that is held up does not hold up the reception
+ * of data on another UART, and that a UART can be closed from its
+ * own event callback while data is arriving.
+ */
+U_PORT_TEST_FUNCTION("[port]", "portUartLinuxPtySlowCallback")
+{
+    int32_t resourceCount;
+    uPortTestLinuxPty_t ptyA = {0};
+    uPortTestLinuxPty_t ptyB = {0};
+    int masterFdA;
+    int masterFdB;
+    int32_t uartHandleA;
+    int32_t uartHandleB;
+    char c = 0;
+    char buffer[8];
+    int32_t startTimeMs;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    uartHandleA = linuxPtyOpen(&ptyA, &masterFdA);
+    U_PORT_TEST_ASSERT(uartHandleA >= 0);
+    uartHandleB = linuxPtyOpen(&ptyB, &masterFdB);
+    U_PORT_TEST_ASSERT(uartHandleB >= 0);
+
+    // Hold up the callback of UART A and send it more separate
+    // lumps of data than its event queue can hold
+    ptyA.hold = true;
+    for (size_t x = 0; x < U_PORT_TEST_LINUX_PTY_HELD_WRITES; x++) {
+        U_PORT_TEST_ASSERT(write(masterFdA, &c, 1) == 1);
+        uPortTaskBlock(2);
+    }
+
+    // UART B should still work
+    U_PORT_TEST_ASSERT(write(masterFdB, &c, 1) == 1);
+    U_PORT_TEST_ASSERT(uPortSemaphoreTryTake(ptyB.semaphoreHandle, 1000) == 0);
+    U_PORT_TEST_ASSERT(ptyB.bytesRead == 1);
+
+    // Let UART A go: everything should be received
+    ptyA.hold = false;
+    startTimeMs = uPortGetTickTimeMs();
+    while ((ptyA.bytesRead < U_PORT_TEST_LINUX_PTY_HELD_WRITES) &&
+           (uPortGetTickTimeMs() - startTimeMs < 5000)) {
+        uPortTaskBlock(10);
+    }
+    U_TEST_PRINT_LINE("%d byte(s) received after the callback was held up.",
+                      ptyA.bytesRead);
+    U_PORT_TEST_ASSERT(ptyA.bytesRead == U_PORT_TEST_LINUX_PTY_HELD_WRITES);
+
+    // Now do the same but have the callback close UART A
+    ptyA.hold = true;
+    for (size_t x = 0; x < U_PORT_TEST_LINUX_PTY_HELD_WRITES; x++) {
+        U_PORT_TEST_ASSERT(write(masterFdA, &c, 1) == 1);
+        uPortTaskBlock(2);
+    }
+    while (uPortSemaphoreTryTake(ptyA.semaphoreHandle, 0) == 0) {}
+    ptyA.closeInCallback = true;
+    ptyA.hold = false;
+    U_PORT_TEST_ASSERT(uPortSemaphoreTryTake(ptyA.semaphoreHandle, 5000) == 0);
+    U_PORT_TEST_ASSERT(uPortUartRead(uartHandleA, buffer, sizeof(buffer)) < 0);
+    // UART B should still work
+    U_PORT_TEST_ASSERT(write(masterFdB, &c, 1) == 1);
+    U_PORT_TEST_ASSERT(uPortSemaphoreTryTake(ptyB.semaphoreHandle, 1000) == 0);
+    U_PORT_TEST_ASSERT(ptyB.bytesRead == 2);
+
+    uPortUartClose(uartHandleB);
+    uPortSemaphoreDelete(ptyB.semaphoreHandle);
+    uPortSemaphoreDelete(ptyA.semaphoreHandle);
+    close(masterFdB);
+    close(masterFdA);
+
+    // This also removes the UART prefix we set
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+#endif
+
+#ifdef U_PORT_TEST_LINUX_PTY
+/** Test that, on Linux, a UART whose other end goes away does not
+ * leave the I/O task spinning and that data flows again once the
+ * other end comes back.  The UART is opened on the master side of
+ * a pseudo-terminal, where the test can make the other end, the
+ * slave side, go away and come back at will; the UART handle on
+ * Linux is a file descriptor, which is used here to find the
+ * number of the pseudo-terminal.
+ */
+U_PORT_TEST_FUNCTION("[port]", "portUartLinuxPtyHangUp")
+{
+    int32_t resourceCount;
+    uPortTestLinuxPty_t pty = {0};
+    int32_t uartHandle;
+    int ptyNumber = 0;
+    int unlock = 0;
+    int slaveFd;
+    int32_t cpuTimeMs;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    U_PORT_TEST_ASSERT(uPortSemaphoreCreate(&(pty.semaphoreHandle), 0, 1) == 0);
+    U_PORT_TEST_ASSERT(uPortUartPrefix("/dev/ptmx") == 0);
+    uartHandle = uPortUartOpen(-1, 115200, NULL,
+                               U_PORT_TEST_LINUX_PTY_BUFFER_LENGTH_BYTES,
+                               -1, -1, -1, -1);
+    U_PORT_TEST_ASSERT(uartHandle >= 0);
+    U_PORT_TEST_ASSERT(ioctl(uartHandle, TIOCSPTLCK, &unlock) == 0);
+    U_PORT_TEST_ASSERT(ioctl(uartHandle, TIOCGPTN, &ptyNumber) == 0);
+    U_PORT_TEST_ASSERT(uPortUartEventCallbackSet(uartHandle,
+                                                 U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED,
+                                                 linuxPtyCallback, &pty,
+                                                 U_PORT_EVENT_QUEUE_MIN_TASK_STACK_SIZE_BYTES,
+                                                 U_CFG_OS_PRIORITY_MAX - 5) == 0);
+    U_TEST_PRINT_LINE("opened master side of pseudo-terminal %d as UART handle %d.",
+                      ptyNumber, uartHandle);
+
+    for (size_t x = 0; x < 3; x++) {
+        // Nothing is on the other end: the I/O task should be quiet
+        cpuTimeMs = linuxCpuTimeMs();
+        uPortTaskBlock(U_PORT_TEST_LINUX_PTY_HUP_WAIT_MS);
+        cpuTimeMs = linuxCpuTimeMs() - cpuTimeMs;
+        U_TEST_PRINT_LINE("%d ms of CPU time used in %d ms while hung up.",
+                          cpuTimeMs, U_PORT_TEST_LINUX_PTY_HUP_WAIT_MS);
+        U_PORT_TEST_ASSERT(cpuTimeMs < U_PORT_TEST_LINUX_PTY_HUP_CPU_MAX_MS);
+        // Bring the other end back: data should flow, without the
+        // UART having been read from or written to in the meantime
+        slaveFd = linuxPtySlaveOpen(ptyNumber);
+        U_PORT_TEST_ASSERT(slaveFd >= 0);
+        U_PORT_TEST_ASSERT(linuxPtyCheckFlow(&pty, uartHandle, slaveFd, (char) (x * 2)));
+        U_TEST_PRINT_LINE("data flowed with the other end open (%d).", x + 1);
+        close(slaveFd);
+    }
+
+    uPortUartClose(uartHandle);
+    uPortSemaphoreDelete(pty.semaphoreHandle);
+
+    // This also removes the UART prefix we set
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+#endif
+
 #if (U_CFG_APP_GNSS_I2C >= 0) && !defined(U_PORT_TEST_DISABLE_I2C)
 /** Test I2C.
  */
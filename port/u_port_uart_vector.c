@@ -0,0 +1,94 @@
+/*
+ * Copyright 2019-2023 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ * @brief Default implementation of uPortUartWriteV(), for platforms
+ * which have no scatter/gather write of their own.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stdint.h"     // int32_t etc.
+#include "stddef.h"     // NULL, size_t etc.
+#include "stdbool.h"
+
+#include "u_compiler.h" // U_WEAK
+
+#include "u_error_common.h"
+
+#include "u_port_uart.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+#ifndef _MSC_VER
+/* Note: MSVC won't do weak-linkage for more than one function (see
+ * u_port_resource.c) so the Windows platform provides its own.
+ */
+// Default implementation of a scatter/gather UART write.
+U_WEAK int32_t uPortUartWriteV(int32_t handle, const uPortUartIoVec_t *pIoVec,
+                               size_t count)
+{
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    int32_t thisSizeOrErrorCode;
+    int32_t totalSize = 0;
+
+    if (pIoVec != NULL) {
+        sizeOrErrorCode = 0;
+        for (size_t x = 0; (x < count) && (sizeOrErrorCode >= 0); x++) {
+            if ((pIoVec + x)->sizeBytes > 0) {
+                thisSizeOrErrorCode = uPortUartWrite(handle, (pIoVec + x)->pBuffer,
+                                                     (pIoVec + x)->sizeBytes);
+                if (thisSizeOrErrorCode < 0) {
+                    sizeOrErrorCode = thisSizeOrErrorCode;
+                } else {
+                    totalSize += thisSizeOrErrorCode;
+                    if (thisSizeOrErrorCode < (int32_t) (pIoVec + x)->sizeBytes) {
+                        // Short write, let the caller sort it out
+                        break;
+                    }
+                }
+            }
+        }
+        if (sizeOrErrorCode >= 0) {
+            sizeOrErrorCode = totalSize;
+        }
+    }
+
+    return sizeOrErrorCode;
+}
+#endif
+
+// End of file
@@ -151,6 +151,9 @@ list(APPEND UBXLIB_SRC ${UBXLIB_BASE}/port/u_port_timezone.c)
 # Default uPortXxxResource implementation
 list(APPEND UBXLIB_SRC ${UBXLIB_BASE}/port/u_port_resource.c)
 
+# Default uPortUartWriteV() implementation
+list(APPEND UBXLIB_SRC ${UBXLIB_BASE}/port/u_port_uart_vector.c)
+
 # Optional features
 
 # short range
@@ -70,6 +70,9 @@ UBXLIB_SRC += ${UBXLIB_BASE}/port/u_port_timezone.c
 # Default uPortXxxResource implementation
 UBXLIB_SRC += ${UBXLIB_BASE}/port/u_port_resource.c
 
+# Default uPortUartWriteV() implementation
+UBXLIB_SRC += ${UBXLIB_BASE}/port/u_port_uart_vector.c
+
 # Optional short range related files and directories
 ifneq ($(filter short_range,$(UBXLIB_FEATURES)),)
 UBXLIB_MODULE_DIRS += \
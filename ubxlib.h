@@ -139,9 +139,18 @@
 #include <u_gnss_pos.h>
 #include <u_gnss_pwr.h>
 #include <u_gnss_msg.h>
+#include <u_gnss_correction.h>
 #include <u_gnss_dec.h>
 #include <u_gnss_dec_ubx_nav_pvt.h>
 #include <u_gnss_dec_ubx_nav_hpposllh.h>
+#include <u_gnss_dec_ubx_nav_dop.h>
+#include <u_gnss_dec_ubx_nav_cov.h>
+#include <u_gnss_dec_ubx_nav_timeutc.h>
+#include <u_gnss_dec_ubx_nav_sat.h>
+#include <u_gnss_dec_ubx_nav_sig.h>
+#include <u_gnss_dec_ubx_rxm_rawx.h>
+#include <u_gnss_dec_nmea_gga.h>
+#include <u_gnss_dec_nmea_rmc.h>
 #include <u_gnss_mga.h>
 #include <u_gnss_geofence.h>
 #include <u_gnss_util.h>